@@ -27,11 +27,29 @@
 #define PIN_IIC_SCL 44
 #define PIN_IIC_SDA 43
 
+// Second sensor I2C bus (Wire1 / I2C_NUM_1) for boards wired to their own
+// connector. Those boards' PCA9546A sit directly on Wire1 (no TCA9548A) at
+// their default addresses 0x74 + board, which keeps them apart.
+// -1 = not wired: every board stays on Wire behind the TCA9548A.
+#ifndef PIN_IIC1_SDA
+#define PIN_IIC1_SDA -1
+#endif
+#ifndef PIN_IIC1_SCL
+#define PIN_IIC1_SCL -1
+#endif
+
+// Bus per sensor board (TCA channel 0, 1, ...): 0 = Wire, 1 = Wire1.
+// Boards past the end of the list (SENSOR_MAX_BOARDS > 3) are on Wire.
+// Ignored while PIN_IIC1_SDA is -1.
+#ifndef SENSOR_BOARD_BUS
+#define SENSOR_BOARD_BUS {0, 0, 1}
+#endif
+
 // Motion Play Hardware Control
 #define PIN_TCA_RESET 10      // TCA9548A reset pin
 #define PIN_SENSOR_INT_1 11   // Sensor board 1 interrupt
 #define PIN_SENSOR_INT_2 12   // Sensor board 2 interrupt
-#define PIN_SENSOR_INT_3 13   // Sensor board 3 interrupt
+#define PIN_SENSOR_INT_3 13   // Sensor board 3 interrupt (boards 4+ have no INT line)
 #define PIN_LED_STRIP_DATA 16 // WS2818B LED strip data (72 LEDs)
 
 // SD Card (Note: Some pins conflict with Motion Play hardware)
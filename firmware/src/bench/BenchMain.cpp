@@ -0,0 +1,722 @@
+/**
+ * On-device microbenchmarks (pio run -e bench -t upload)
+ *
+ * Replaces the ad hoc timing sketches in archive/ with one repeatable
+ * suite on the real target:
+ *
+ *   i2c_read        PS_DATA register read per I2C clock
+ *   mux_switch      TCA/PCA selection cost per clock (uncached, board,
+ *                   sensor, cached)
+ *   queue           Core 0 -> Core 1 frame hand-off: SPSCRing vs xQueue
+ *   detector        DirectionDetector per-sample cost (float/fixed,
+ *                   runtime/static profile) on a synthetic capture
+ *   ml              MLDetector Invoke() and classifyWindow() time
+ *   lane_kernels    LaneKernels dispatched vs scalar (see LaneKernels.h)
+ *   encode          One batch as JSON, bin9 and dvz1
+ *   mqtt_publish    Status publish throughput (needs config.json + WiFi)
+ *
+ * Every result is one line "BENCH {json}" with "bench" and "case" as the
+ * key and numeric fields as metrics, so two runs can be diffed:
+ *   pio device monitor -e bench | tee bench.log
+ *   python3 scripts/bench-compare.py old.log new.log
+ * A bench that cannot run (no sensor, no model, no network) reports
+ * "skipped" with the reason. Send 'r' on the serial port to run again.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <vector>
+#include "pin_config.h"
+#include "../components/mux/MuxController.h"
+#include "../components/vcnl4040/VCNL4040.h"
+#include "../components/memory/SPSCRing.h"
+#include "../components/memory/PSRAMAllocator.h"
+#include "../components/detection/DirectionDetector.h"
+#include "../components/detection/MLDetector.h"
+#include "../components/detection/LaneKernels.h"
+#include "../components/data/FrameCodec.h"
+#include "../components/network/NetworkManager.h"
+#include "../components/mqtt/MQTTManager.h"
+
+// Silences the detectors' text logging (as in Serial Studio mode)
+bool serialStudioEnabled = true;
+
+// Bump when a bench's method changes, so old and new logs are not compared blindly
+#define BENCH_SUITE_VERSION 1
+
+#ifndef BENCH_I2C_READS
+#define BENCH_I2C_READS 500
+#endif
+#ifndef BENCH_MUX_SWITCHES
+#define BENCH_MUX_SWITCHES 500
+#endif
+#ifndef BENCH_QUEUE_FRAMES
+#define BENCH_QUEUE_FRAMES 20000
+#endif
+#ifndef BENCH_DETECTOR_PASSES
+#define BENCH_DETECTOR_PASSES 5
+#endif
+#ifndef BENCH_ML_INVOKES
+#define BENCH_ML_INVOKES 20
+#endif
+#ifndef BENCH_KERNEL_ITERATIONS
+#define BENCH_KERNEL_ITERATIONS 200
+#endif
+#ifndef BENCH_ENCODE_FRAMES
+#define BENCH_ENCODE_FRAMES 100
+#endif
+#ifndef BENCH_ENCODE_REPEATS
+#define BENCH_ENCODE_REPEATS 20
+#endif
+#ifndef BENCH_MQTT_MESSAGES
+#define BENCH_MQTT_MESSAGES 50
+#endif
+
+static const uint32_t I2C_CLOCKS[] = {100000, 400000, 1000000};
+
+// Synthetic capture: 1 ms cycles, a transit across the boards every
+// SYNTH_TRANSIT_PERIOD frames
+static const size_t SYNTH_FRAMES = 4000;
+static const size_t SYNTH_TRANSIT_PERIOD = 2000;
+static const size_t QUEUE_SLOTS = 256;
+
+// BQ24195 input current limit (as main.cpp): WiFi browns out the v6 board without it
+#define BQ24195_I2C_ADDR 0x6B
+#define BQ24195_REG00 0x00
+#define BQ24195_REG00_VAL 0x36
+#define BQ24195_REG05 0x05
+#define BQ24195_REG05_VAL 0x8A
+
+typedef std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> FrameBuffer;
+
+static MuxController mux;
+static bool muxReady = false;
+static FrameBuffer synthetic;
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+struct Samples
+{
+    uint32_t count = 0;
+    uint32_t minUs = UINT32_MAX;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+
+    void add(uint32_t us)
+    {
+        count++;
+        totalUs += us;
+        minUs = min(minUs, us);
+        maxUs = max(maxUs, us);
+    }
+
+    void toJson(JsonDocument &doc) const
+    {
+        doc["n"] = count;
+        doc["avg_us"] = count ? (float)totalUs / count : 0.0f;
+        doc["min_us"] = count ? minUs : 0;
+        doc["max_us"] = maxUs;
+    }
+};
+
+static void beginResult(JsonDocument &doc, const char *bench, const char *caseName)
+{
+    doc.clear();
+    doc["bench"] = bench;
+    doc["case"] = caseName;
+}
+
+static void emit(const JsonDocument &doc)
+{
+    Serial.print("BENCH ");
+    serializeJson(doc, Serial);
+    Serial.println();
+}
+
+static void emitSkipped(const char *bench, const char *caseName, const char *reason)
+{
+    StaticJsonDocument<192> doc;
+    beginResult(doc, bench, caseName);
+    doc["skipped"] = reason;
+    emit(doc);
+}
+
+// ============================================================================
+// Synthetic capture
+// ============================================================================
+
+static void buildSyntheticCapture()
+{
+    synthetic.resize(SYNTH_FRAMES);
+    for (size_t i = 0; i < SYNTH_FRAMES; i++)
+    {
+        SensorFrame &frame = synthetic[i];
+        memset(&frame, 0, sizeof(frame));
+        frame.timestamp_us = i * 1000;
+        frame.valid_mask = SENSOR_MASK_ALL >> (sizeof(SensorMask) * 8 - NUM_SENSORS);
+
+        // Hand passing over boards 1-3 in turn, 40 ms apart, ~30 ms wide
+        size_t phase = i % SYNTH_TRANSIT_PERIOD;
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            int32_t value = 20 + (int32_t)((i * 7 + pos * 13) % 5);
+            int32_t center = 1000 + (pos / SENSORS_PER_BOARD) * 40 + (pos % SENSORS_PER_BOARD) * 5;
+            int32_t distance = abs((int32_t)phase - center);
+            if (pos < ML_NUM_POSITIONS && distance < 30)
+                value += (30 - distance) * 8;
+            frame.proximity[pos] = value;
+            frame.ambient[pos] = 100;
+        }
+    }
+}
+
+// Frame i of an endless replay of the synthetic capture
+static inline void syntheticFrame(size_t i, SensorFrame &frame)
+{
+    frame = synthetic[i % SYNTH_FRAMES];
+    frame.timestamp_us = i * 1000;
+}
+
+// ============================================================================
+// I2C and mux
+// ============================================================================
+
+static bool readProximityRegister()
+{
+    Wire.beginTransmission(VCNL4040_ADDR);
+    Wire.write(VCNL4040_PS_DATA);
+    if (Wire.endTransmission(false) != 0)
+        return false;
+    if (Wire.requestFrom((uint8_t)VCNL4040_ADDR, (uint8_t)2) != 2)
+        return false;
+    Wire.read();
+    Wire.read();
+    return true;
+}
+
+// First available position, optionally on another board than / the same board as `other`
+static int findPosition(int other, bool sameBoard)
+{
+    for (uint8_t pos = 0; pos < MUX_TOTAL_SENSORS; pos++)
+    {
+        if (!mux.isSensorAvailable(pos) || pos == other || &mux.getWire(pos / MUX_SENSORS_PER_BOARD) != &Wire)
+            continue;
+        if (other < 0)
+            return pos;
+        bool same = pos / MUX_SENSORS_PER_BOARD == other / MUX_SENSORS_PER_BOARD;
+        if (same == sameBoard)
+            return pos;
+    }
+    return -1;
+}
+
+static void benchMuxCase(const char *caseName, uint32_t clockHz, int first, int second, bool invalidate)
+{
+    StaticJsonDocument<384> doc;
+    char name[32];
+    snprintf(name, sizeof(name), "%s@%lu", caseName, (unsigned long)clockHz);
+    if (first < 0 || second < 0)
+    {
+        emitSkipped("mux_switch", name, "no sensor pair for this case");
+        return;
+    }
+
+    Samples samples;
+    uint32_t failures = 0;
+    uint32_t writesBefore = mux.getMuxWritesIssued();
+    mux.selectSensor(first);
+    for (uint32_t i = 0; i < BENCH_MUX_SWITCHES; i++)
+    {
+        if (invalidate)
+            mux.invalidateCache();
+        uint8_t pos = (i & 1) ? first : second;
+        uint32_t start = micros();
+        if (!mux.selectSensor(pos))
+            failures++;
+        samples.add(micros() - start);
+    }
+
+    beginResult(doc, "mux_switch", name);
+    samples.toJson(doc);
+    doc["writes_per_switch"] = (float)(mux.getMuxWritesIssued() - writesBefore) / BENCH_MUX_SWITCHES;
+    doc["failures"] = failures;
+    emit(doc);
+}
+
+static void benchI2C()
+{
+    int first = muxReady ? findPosition(-1, false) : -1;
+    if (first < 0)
+    {
+        emitSkipped("i2c_read", "all", "no sensor on Wire");
+        emitSkipped("mux_switch", "all", "no sensor on Wire");
+        return;
+    }
+    int sameBoard = findPosition(first, true);
+    int otherBoard = findPosition(first, false);
+
+    for (uint32_t clockHz : I2C_CLOCKS)
+    {
+        Wire.setClock(clockHz);
+        delay(10);
+
+        char name[16];
+        snprintf(name, sizeof(name), "%lu", (unsigned long)clockHz);
+        mux.invalidateCache();
+        mux.selectSensor(first);
+
+        Samples samples;
+        uint32_t errors = 0;
+        for (uint32_t i = 0; i < BENCH_I2C_READS; i++)
+        {
+            uint32_t start = micros();
+            if (!readProximityRegister())
+                errors++;
+            samples.add(micros() - start);
+        }
+
+        StaticJsonDocument<384> doc;
+        beginResult(doc, "i2c_read", name);
+        doc["clock_hz"] = clockHz;
+        samples.toJson(doc);
+        doc["errors"] = errors;
+        emit(doc);
+
+        benchMuxCase("uncached", clockHz, first, otherBoard >= 0 ? otherBoard : sameBoard, true);
+        benchMuxCase("board", clockHz, first, otherBoard, false);
+        benchMuxCase("sensor", clockHz, first, sameBoard, false);
+        benchMuxCase("cached", clockHz, first, first, false);
+    }
+
+    // Back to the production clock
+    Wire.setClock(400000);
+    mux.disableAll();
+}
+
+// ============================================================================
+// Core 0 -> Core 1 hand-off
+// ============================================================================
+
+static SPSCRing<SensorFrame, QUEUE_SLOTS> benchRing;
+
+struct ProducerArgs
+{
+    QueueHandle_t queue; // nullptr = benchRing
+    uint32_t frames;
+    TaskHandle_t consumer;
+};
+
+static void producerTask(void *parameter)
+{
+    ProducerArgs *args = (ProducerArgs *)parameter;
+    SensorFrame frame = synthetic[0];
+    for (uint32_t i = 0; i < args->frames; i++)
+    {
+        frame.timestamp_us = i;
+        if (args->queue)
+        {
+            xQueueSend(args->queue, &frame, portMAX_DELAY);
+            continue;
+        }
+        while (!benchRing.push(frame))
+            taskYIELD();
+    }
+    xTaskNotifyGive(args->consumer);
+    vTaskDelete(nullptr);
+}
+
+static void benchQueueCase(const char *caseName, QueueHandle_t queue)
+{
+    ProducerArgs args = {queue, BENCH_QUEUE_FRAMES, xTaskGetCurrentTaskHandle()};
+    benchRing.discardAll();
+    benchRing.resetOverflowCount();
+
+    SensorFrame batch[32];
+    uint32_t received = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t start = micros();
+    xTaskCreatePinnedToCore(producerTask, "BenchProducer", 4096, &args, uxTaskPriorityGet(nullptr), nullptr, 0);
+    while (received < BENCH_QUEUE_FRAMES)
+    {
+        size_t n;
+        if (queue)
+            n = xQueueReceive(queue, &batch[0], portMAX_DELAY) == pdTRUE ? 1 : 0;
+        else
+            n = benchRing.popBulk(batch, 32);
+        for (size_t i = 0; i < n; i++)
+        {
+            if (batch[i].timestamp_us != received + i)
+                outOfOrder++;
+        }
+        received += n;
+        if (n == 0)
+            taskYIELD();
+    }
+    uint32_t elapsedUs = micros() - start;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    StaticJsonDocument<256> doc;
+    beginResult(doc, "queue", caseName);
+    doc["frames"] = received;
+    doc["ns_per_frame"] = elapsedUs * 1000.0f / received;
+    doc["frames_per_s"] = received * 1e6f / elapsedUs;
+    doc["full_retries"] = queue ? 0 : benchRing.overflowCount();
+    doc["out_of_order"] = outOfOrder;
+    emit(doc);
+}
+
+static void benchQueues()
+{
+    benchQueueCase("spsc_ring", nullptr);
+
+    QueueHandle_t queue = xQueueCreate(64, sizeof(SensorFrame));
+    if (!queue)
+    {
+        emitSkipped("queue", "freertos_queue", "out of memory");
+        return;
+    }
+    benchQueueCase("freertos_queue", queue);
+    vQueueDelete(queue);
+}
+
+// ============================================================================
+// Detectors
+// ============================================================================
+
+template <typename Detector>
+static void benchDetector(const char *caseName)
+{
+    Detector *detector = new Detector();
+    detector->setConfig(DetectorConfig());
+
+    uint32_t frames = SYNTH_FRAMES * BENCH_DETECTOR_PASSES;
+    uint32_t detections = 0;
+    SensorFrame frame;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        syntheticFrame(i, frame);
+        detector->addFrame(frame);
+        if (detector->hasDetection())
+        {
+            detector->getResult();
+            detector->reset();
+            detections++;
+        }
+    }
+    uint32_t elapsedUs = micros() - start;
+    delete detector;
+
+    StaticJsonDocument<256> doc;
+    beginResult(doc, "detector", caseName);
+    doc["frames"] = frames;
+    doc["ns_per_frame"] = elapsedUs * 1000.0f / frames;
+    doc["detections"] = detections;
+    emit(doc);
+}
+
+static void benchDetectors()
+{
+    benchDetector<FloatDirectionDetector>("float");
+    benchDetector<FixedDirectionDetector>("fixed");
+    benchDetector<StaticFloatDirectionDetector>("float_static");
+    benchDetector<StaticFixedDirectionDetector>("fixed_static");
+}
+
+// ============================================================================
+// ML
+// ============================================================================
+
+static void benchML()
+{
+    MLDetector *ml = new MLDetector();
+    if (!ml->init())
+    {
+        delete ml;
+        emitSkipped("ml", "classify_window", "model init failed");
+        return;
+    }
+
+    // Quiet stretch: baseline plus a full input window, no trigger
+    SensorFrame frame;
+    for (uint32_t i = 0; i < 2 * ML_WINDOW_MS; i++)
+    {
+        syntheticFrame(i, frame);
+        ml->addFrame(frame);
+    }
+
+    Samples samples;
+    DetectionResult result;
+    for (uint32_t i = 0; i < BENCH_ML_INVOKES; i++)
+    {
+        uint32_t start = micros();
+        if (!ml->classifyWindow(result))
+            break;
+        samples.add(micros() - start);
+    }
+
+    StaticJsonDocument<512> doc;
+    beginResult(doc, "ml", "classify_window");
+    if (samples.count == 0)
+    {
+        doc["skipped"] = "classifyWindow did not run";
+    }
+    else
+    {
+        MLInferenceStats stats = ml->getInferenceStats();
+        samples.toJson(doc);
+        doc["invoke_avg_us"] = stats.avgUs;
+        doc["invoke_max_us"] = stats.maxUs;
+        doc["prepare_avg_us"] = stats.prepareAvgUs;
+        doc["prepare_max_us"] = stats.prepareMaxUs;
+        doc["int8"] = ml->isInt8Model();
+        doc["arena_used"] = ml->getArenaUsedBytes();
+        doc["model"] = ml->getModelVersion();
+    }
+    emit(doc);
+    delete ml;
+}
+
+static void benchLaneKernels()
+{
+    DynamicJsonDocument doc(768);
+    LaneKernels::benchmark(doc, BENCH_KERNEL_ITERATIONS);
+    doc["bench"] = "lane_kernels";
+    doc["case"] = "ml_input";
+    emit(doc);
+}
+
+// ============================================================================
+// Encoders
+// ============================================================================
+
+static void emitEncode(const char *caseName, uint32_t elapsedUs, size_t bytes, size_t readings)
+{
+    StaticJsonDocument<256> doc;
+    beginResult(doc, "encode", caseName);
+    doc["frames"] = BENCH_ENCODE_FRAMES;
+    doc["bytes"] = bytes;
+    doc["us_per_batch"] = (float)elapsedUs / BENCH_ENCODE_REPEATS;
+    doc["readings_per_s"] = (float)readings * BENCH_ENCODE_REPEATS * 1e6f / elapsedUs;
+    emit(doc);
+}
+
+static void benchEncoders()
+{
+    size_t readings = 0;
+    for (size_t f = 0; f < BENCH_ENCODE_FRAMES; f++)
+        readings += synthetic[f].validCount();
+
+    // JSON: the per-reading objects of DataTransmitter::transmitBatch
+    size_t jsonCapacity = JSON_ARRAY_SIZE(readings) + readings * JSON_OBJECT_SIZE(6) + 256;
+    DynamicJsonDocument json(jsonCapacity);
+    std::vector<char, PSRAMAllocator<char>> text(readings * 96 + 256);
+    size_t bytes = 0;
+    uint32_t start = micros();
+    for (uint32_t r = 0; r < BENCH_ENCODE_REPEATS; r++)
+    {
+        json.clear();
+        JsonArray readingsArray = json.createNestedArray("readings");
+        SensorReading reading;
+        for (size_t f = 0; f < BENCH_ENCODE_FRAMES; f++)
+        {
+            const SensorFrame &frame = synthetic[f];
+            for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+            {
+                if (!frame.isValid(pos))
+                    continue;
+                frame.toReading(pos, reading);
+                JsonObject readingObj = readingsArray.createNestedObject();
+                readingObj["ts"] = reading.timestamp_us;
+                readingObj["pos"] = reading.position;
+                readingObj["pcb"] = reading.pcb_id;
+                readingObj["side"] = reading.side;
+                readingObj["prox"] = reading.proximity;
+                readingObj["amb"] = reading.ambient;
+            }
+        }
+        bytes = serializeJson(json, text.data(), text.size());
+    }
+    emitEncode("json", micros() - start, bytes, readings);
+
+    // bin9: u32 ts, u8 pos, u16 prox, u16 amb per reading
+    std::vector<uint8_t, PSRAMAllocator<uint8_t>> binary(BENCH_ENCODE_FRAMES * FRAME_CODEC_MAX_FRAME_BYTES +
+                                                         readings * 9);
+    start = micros();
+    for (uint32_t r = 0; r < BENCH_ENCODE_REPEATS; r++)
+    {
+        uint8_t *out = binary.data();
+        for (size_t f = 0; f < BENCH_ENCODE_FRAMES; f++)
+        {
+            const SensorFrame &frame = synthetic[f];
+            for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+            {
+                if (!frame.isValid(pos))
+                    continue;
+                memcpy(out, &frame.timestamp_us, 4);
+                out[4] = pos;
+                memcpy(out + 5, &frame.proximity[pos], 2);
+                memcpy(out + 7, &frame.ambient[pos], 2);
+                out += 9;
+            }
+        }
+        bytes = out - binary.data();
+    }
+    emitEncode("bin9", micros() - start, bytes, readings);
+
+    FrameEncoder encoder;
+    start = micros();
+    for (uint32_t r = 0; r < BENCH_ENCODE_REPEATS; r++)
+    {
+        encoder.reset();
+        uint8_t *out = binary.data();
+        for (size_t f = 0; f < BENCH_ENCODE_FRAMES; f++)
+            out += encoder.encode(synthetic[f], out);
+        bytes = out - binary.data();
+    }
+    emitEncode("dvz1", micros() - start, bytes, readings);
+}
+
+// ============================================================================
+// MQTT
+// ============================================================================
+
+static NetworkManager networkManager;
+static MQTTManager *mqttManager = nullptr;
+
+static bool connectMQTT()
+{
+    if (mqttManager && mqttManager->isConnected())
+        return true;
+    if (!networkManager.loadConfig() || !networkManager.connectWiFi())
+        return false;
+    if (!mqttManager)
+    {
+        mqttManager = new MQTTManager(&networkManager);
+        if (!mqttManager->loadConfig())
+            return false;
+    }
+    return mqttManager->connect();
+}
+
+// Status messages ("bench_publish"), so nothing lands in the session data
+static void benchPublishCase(size_t padBytes)
+{
+    char name[16];
+    snprintf(name, sizeof(name), "status_%u", (unsigned)padBytes);
+
+    std::vector<char> pad(padBytes + 1, 'x');
+    pad[padBytes] = '\0';
+    DynamicJsonDocument details(padBytes + 128);
+    details["pad"] = pad.data();
+
+    Samples samples;
+    uint32_t failures = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_MQTT_MESSAGES; i++)
+    {
+        details["seq"] = i;
+        uint32_t t0 = micros();
+        if (!mqttManager->publishStatus("bench_publish", details))
+            failures++;
+        samples.add(micros() - t0);
+        mqttManager->loop();
+    }
+    uint32_t elapsedUs = micros() - start;
+
+    StaticJsonDocument<384> doc;
+    beginResult(doc, "mqtt_publish", name);
+    samples.toJson(doc);
+    doc["payload_bytes"] = measureJson(details);
+    doc["msgs_per_s"] = BENCH_MQTT_MESSAGES * 1e6f / elapsedUs;
+    doc["failures"] = failures;
+    emit(doc);
+}
+
+static void benchMQTT()
+{
+    if (!connectMQTT())
+    {
+        emitSkipped("mqtt_publish", "all", "no WiFi/MQTT (config.json, certificates)");
+        return;
+    }
+    benchPublishCase(128);
+    benchPublishCase(768);
+}
+
+// ============================================================================
+// Suite
+// ============================================================================
+
+static void configureBQ24195()
+{
+    Wire.beginTransmission(BQ24195_I2C_ADDR);
+    if (Wire.endTransmission() != 0)
+        return;
+    Wire.beginTransmission(BQ24195_I2C_ADDR);
+    Wire.write(BQ24195_REG00);
+    Wire.write(BQ24195_REG00_VAL);
+    Wire.endTransmission();
+    Wire.beginTransmission(BQ24195_I2C_ADDR);
+    Wire.write(BQ24195_REG05);
+    Wire.write(BQ24195_REG05_VAL);
+    Wire.endTransmission();
+}
+
+static void runSuite()
+{
+    StaticJsonDocument<384> meta;
+    beginResult(meta, "meta", "device");
+    meta["suite"] = BENCH_SUITE_VERSION;
+    meta["build"] = __DATE__ " " __TIME__;
+    meta["idf"] = esp_get_idf_version();
+    meta["cpu_mhz"] = getCpuFrequencyMhz();
+    meta["sensors"] = muxReady ? mux.getActiveSensorCount() : 0;
+    meta["free_heap"] = ESP.getFreeHeap();
+    meta["free_psram"] = ESP.getFreePsram();
+    emit(meta);
+
+    uint32_t start = millis();
+    benchI2C();
+    benchQueues();
+    benchDetectors();
+    benchML();
+    benchLaneKernels();
+    benchEncoders();
+    benchMQTT();
+
+    StaticJsonDocument<128> done;
+    beginResult(done, "meta", "done");
+    done["elapsed_ms"] = millis() - start;
+    emit(done);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(2000);
+    Serial.println("\n=== Motion Play microbenchmarks ===");
+
+    Wire.begin(PIN_IIC_SDA, PIN_IIC_SCL);
+    configureBQ24195();
+    muxReady = mux.begin(PIN_IIC_SDA, PIN_IIC_SCL, 400000);
+
+    buildSyntheticCapture();
+    runSuite();
+    Serial.println("Send 'r' to run again");
+}
+
+void loop()
+{
+    if (Serial.available() && Serial.read() == 'r')
+        runSuite();
+    if (mqttManager)
+        mqttManager->loop();
+    delay(10);
+}
@@ -0,0 +1,191 @@
+#include "AutoCalibrator.h"
+
+extern bool serialStudioEnabled;
+
+const DeviceCalibration *AutoCalibrator::reference(const DeviceCalibration &calibration)
+{
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        sensors[i] = {};
+        sensors[i].window.reset();
+    }
+    for (uint8_t p = 0; p < CALIBRATION_NUM_PCBS; p++)
+        thresholdOffset[p] = 0;
+
+    referenceCal = calibration;
+    adjusted = calibration;
+    publishTelemetry();
+    return adjusted.isValid() ? &adjusted : nullptr;
+}
+
+void AutoCalibrator::addFrame(const SensorFrame &frame, const DirectionDetector &detector)
+{
+    if (!enabled)
+        return;
+
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if (!frame.isValid(pos) || detector.getSensorWaveState(pos) != WaveState::IDLE)
+            continue;
+
+        SensorState &s = sensors[pos];
+        uint16_t value = frame.proximity[pos];
+
+        // Something the detector did not see as a wave still is not baseline
+        if (s.window.getCount() >= 32)
+        {
+            float limit = s.window.getMeanExact() + AUTO_CAL_OUTLIER_SIGMA * s.window.getStdDevExact() + 1;
+            if (value > limit)
+            {
+                s.rejected++;
+                continue;
+            }
+        }
+
+        s.window.addSample(value);
+        if (s.window.getCount() >= AUTO_CAL_WINDOW_SAMPLES)
+            finishWindow(pos);
+    }
+}
+
+void AutoCalibrator::finishWindow(uint8_t pos)
+{
+    SensorState &s = sensors[pos];
+    float mean = s.window.getMeanExact();
+    float stddev = s.window.getStdDevExact();
+    s.window.reset();
+
+    if (s.windows == 0)
+    {
+        s.baseline = mean;
+        s.noise = stddev;
+        s.reference = mean;
+    }
+    else
+    {
+        s.baseline += AUTO_CAL_EWMA_ALPHA * (mean - s.baseline);
+        s.noise += AUTO_CAL_EWMA_ALPHA * (stddev - s.noise);
+    }
+    s.windows++;
+
+    trackCancellation(pos);
+
+    // Both sensors of the PCB have a fresh estimate: follow its threshold
+    uint8_t pcb = pos / 2;
+    if (pcb < CALIBRATION_NUM_PCBS && sensors[pcb * 2].windows == sensors[pcb * 2 + 1].windows)
+        trackThreshold(pcb);
+
+    publishTelemetry();
+}
+
+void AutoCalibrator::trackCancellation(uint8_t pos)
+{
+    if (sensorMgr == nullptr || !(sensorMgr->getCancellationMask() & (1 << pos)))
+        return;
+
+    SensorState &s = sensors[pos];
+    int32_t error = (int32_t)lroundf(s.baseline) - AUTO_CAL_CANC_TARGET;
+    if (abs(error) <= AUTO_CAL_DEADBAND)
+        return;
+
+    int32_t step = constrain(error, -AUTO_CAL_CANC_STEP, AUTO_CAL_CANC_STEP);
+    int32_t value = constrain((int32_t)sensorMgr->getBaselineValue(pos) + step, 0, 65535);
+    if (!sensorMgr->adjustCancellation(pos, (uint16_t)value))
+        return;
+
+    // Readings move by -step from the next cycle: so does the estimate
+    s.baseline -= step;
+    s.reference -= step;
+    s.cancellationShift += step;
+    adjustments++;
+
+    if (!serialStudioEnabled)
+        Serial.printf("[AutoCal] Sensor %d PS_CANC %+ld -> %ld (idle %.1f)\n",
+                      pos, (long)step, (long)value, s.baseline + step);
+}
+
+void AutoCalibrator::trackThreshold(uint8_t pcb)
+{
+    const PCBCalibration &cal = referenceCal.pcbs[pcb];
+    if (!referenceCal.isValid() || !cal.valid)
+        return;
+
+    // The wizard measured the sum of both sensors
+    const SensorState &a = sensors[pcb * 2];
+    const SensorState &b = sensors[pcb * 2 + 1];
+    int32_t drift = (int32_t)lroundf(a.baseline + b.baseline) - cal.baseline_mean;
+
+    int32_t error = drift - thresholdOffset[pcb];
+    if (abs(error) <= AUTO_CAL_DEADBAND)
+        return;
+
+    thresholdOffset[pcb] += constrain(error, -AUTO_CAL_THRESHOLD_STEP, AUTO_CAL_THRESHOLD_STEP);
+    adjusted.pcbs[pcb].threshold = constrain((int32_t)cal.threshold + thresholdOffset[pcb], 1, 65535);
+    adjustments++;
+
+    if (!serialStudioEnabled)
+        Serial.printf("[AutoCal] PCB%d threshold %d -> %d (baseline drift %+ld)\n",
+                      pcb + 1, cal.threshold, adjusted.pcbs[pcb].threshold, (long)drift);
+}
+
+void AutoCalibrator::publishTelemetry()
+{
+    Telemetry t;
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        const SensorState &s = sensors[i];
+        t.baseline[i] = s.baseline;
+        t.noise[i] = s.noise;
+        t.drift[i] = s.windows > 0 ? s.baseline - s.reference : 0;
+        t.windows[i] = s.windows;
+        t.rejected[i] = s.rejected;
+        t.cancellationShift[i] = s.cancellationShift;
+    }
+    for (uint8_t p = 0; p < CALIBRATION_NUM_PCBS; p++)
+    {
+        t.thresholdOffset[p] = thresholdOffset[p];
+        t.threshold[p] = adjusted.pcbs[p].threshold;
+    }
+    t.calibrated = adjusted.isValid();
+
+    portENTER_CRITICAL(&telemetryLock);
+    telemetry = t;
+    portEXIT_CRITICAL(&telemetryLock);
+}
+
+void AutoCalibrator::toJson(JsonDocument &doc) const
+{
+    Telemetry t;
+    portENTER_CRITICAL(&telemetryLock);
+    t = telemetry;
+    portEXIT_CRITICAL(&telemetryLock);
+
+    doc["enabled"] = enabled;
+    doc["adjustments"] = (uint32_t)adjustments;
+
+    // Indexed by sensor position; fits StatusPublisher's details document
+    JsonArray sensorArray = doc.createNestedArray("sensors");
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        JsonObject s = sensorArray.createNestedObject();
+        s["baseline"] = t.baseline[i];
+        s["noise"] = t.noise[i];
+        s["drift"] = t.drift[i];
+        s["windows"] = t.windows[i];
+        s["rejected"] = t.rejected[i];
+        if (t.cancellationShift[i] != 0)
+            s["ps_canc_shift"] = t.cancellationShift[i];
+    }
+
+    if (t.calibrated)
+    {
+        JsonArray pcbArray = doc.createNestedArray("pcbs");
+        for (uint8_t p = 0; p < CALIBRATION_NUM_PCBS; p++)
+        {
+            JsonObject pcb = pcbArray.createNestedObject();
+            pcb["pcb_id"] = p + 1;
+            pcb["threshold"] = t.threshold[p];
+            pcb["threshold_offset"] = t.thresholdOffset[p];
+        }
+    }
+}
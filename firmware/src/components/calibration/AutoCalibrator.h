@@ -0,0 +1,147 @@
+#ifndef AUTO_CALIBRATOR_H
+#define AUTO_CALIBRATOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include "CalibrationData.h"
+#include "../sensor/SensorFrame.h"
+#include "../sensor/SensorManager.h"
+#include "../detection/DirectionDetector.h"
+
+/**
+ * AutoCalibrator - Background calibration from idle readings
+ *
+ * The wizard (CalibrationManager) takes loop() over and runs once; ambient
+ * IR and dirt on the cover windows then drift during the day and its
+ * thresholds go stale. The auto calibrator follows that drift while the
+ * detector runs, without stopping collection.
+ *
+ * - Fed by DetectionTask with every frame given to the heuristic
+ *   detector; only readings of sensors that are idle (no wave) count, and
+ *   readings far above the window's running mean (AUTO_CAL_OUTLIER_SIGMA)
+ *   are rejected as unnoticed objects
+ * - Per sensor: Welford statistics over AUTO_CAL_WINDOW_SAMPLES idle
+ *   readings, then an EWMA of window means / noise. Drift = baseline now
+ *   minus the first window
+ * - Thresholds: a calibrated PCB threshold follows its PCB baseline (sum
+ *   of both sensors, like the wizard) relative to the calibration's
+ *   baseline_mean, at most AUTO_CAL_THRESHOLD_STEP per window. The
+ *   wizard result itself is not changed: the detector uses the copy
+ *   reference() returns
+ * - PS_CANC: sensors with cancellation set are held at AUTO_CAL_CANC_TARGET
+ *   idle counts (clear of the zero clamp), at most AUTO_CAL_CANC_STEP per
+ *   window, via SensorManager::adjustCancellation()
+ * - Telemetry (toJson()) is a snapshot taken at the end of each window;
+ *   safe to read from any task. loop() posts it as "calibration_drift"
+ *   when an adjustment was made
+ *
+ * Detector-side state (feeding, reference()) is used under the
+ * DetectionTask guard.
+ */
+
+// Idle readings per sensor per window (~2 s at 1 kHz)
+#ifndef AUTO_CAL_WINDOW_SAMPLES
+#define AUTO_CAL_WINDOW_SAMPLES 2000
+#endif
+
+#ifndef AUTO_CAL_EWMA_ALPHA
+#define AUTO_CAL_EWMA_ALPHA 0.25f
+#endif
+
+#ifndef AUTO_CAL_OUTLIER_SIGMA
+#define AUTO_CAL_OUTLIER_SIGMA 4.0f
+#endif
+
+// Counts of drift ignored as noise
+#ifndef AUTO_CAL_DEADBAND
+#define AUTO_CAL_DEADBAND 2
+#endif
+
+#ifndef AUTO_CAL_THRESHOLD_STEP
+#define AUTO_CAL_THRESHOLD_STEP 4
+#endif
+
+#ifndef AUTO_CAL_CANC_TARGET
+#define AUTO_CAL_CANC_TARGET 4
+#endif
+
+// Below the detector's minRise, so a step never looks like a wave
+#ifndef AUTO_CAL_CANC_STEP
+#define AUTO_CAL_CANC_STEP 4
+#endif
+
+// "calibration_drift" status at most this often (main.cpp)
+#ifndef AUTO_CAL_REPORT_INTERVAL_MS
+#define AUTO_CAL_REPORT_INTERVAL_MS 60000
+#endif
+
+class AutoCalibrator
+{
+public:
+    void begin(SensorManager *sensors) { sensorMgr = sensors; }
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * Start over from this calibration (detector reset): drift references
+     * are taken again and threshold offsets cleared
+     * @return The calibration for DirectionDetector::setCalibration()
+     *         (nullptr if calibration is not valid)
+     */
+    const DeviceCalibration *reference(const DeviceCalibration &calibration);
+
+    // DetectionTask: one frame the heuristic detector has just processed
+    void addFrame(const SensorFrame &frame, const DirectionDetector &detector);
+
+    // Adjustments made (thresholds + PS_CANC); changes when there is news
+    uint32_t getAdjustmentCount() const { return adjustments; }
+
+    void toJson(JsonDocument &doc) const;
+
+private:
+    struct SensorState
+    {
+        StatsAccumulator window;
+        float baseline;  // EWMA of window means
+        float noise;     // EWMA of window standard deviations
+        float reference; // First window mean since reference()
+        uint32_t windows;
+        uint32_t rejected;
+        int32_t cancellationShift; // Net PS_CANC change since reference()
+    };
+
+    struct Telemetry
+    {
+        float baseline[NUM_SENSORS];
+        float noise[NUM_SENSORS];
+        float drift[NUM_SENSORS];
+        uint32_t windows[NUM_SENSORS];
+        uint32_t rejected[NUM_SENSORS];
+        int32_t cancellationShift[NUM_SENSORS];
+        int16_t thresholdOffset[CALIBRATION_NUM_PCBS];
+        uint16_t threshold[CALIBRATION_NUM_PCBS];
+        bool calibrated;
+    };
+
+    SensorManager *sensorMgr = nullptr;
+    bool enabled = true;
+
+    SensorState sensors[NUM_SENSORS] = {};
+    DeviceCalibration referenceCal = {};
+    DeviceCalibration adjusted = {}; // What the detector reads
+    int16_t thresholdOffset[CALIBRATION_NUM_PCBS] = {};
+
+    volatile uint32_t adjustments = 0;
+
+    Telemetry telemetry = {};
+    mutable portMUX_TYPE telemetryLock = portMUX_INITIALIZER_UNLOCKED;
+
+    void finishWindow(uint8_t position);
+    void trackCancellation(uint8_t position);
+    void trackThreshold(uint8_t pcb);
+    void publishTelemetry();
+};
+
+#endif
@@ -24,6 +24,58 @@
 // Number of PCBs to calibrate
 #define CALIBRATION_NUM_PCBS 3
 
+/**
+ * Running statistics for calibration samples
+ *
+ * Welford's update: mean and sum of squared deviations are kept directly,
+ * so long runs (background calibration) neither overflow nor lose the
+ * variance to cancellation, as a sum / sum-of-squares pair does. Both are
+ * double: in float, delta / count falls under the mean's rounding step
+ * within about a million samples (readings near 1000) and the mean freezes,
+ * taking m2 with it.
+ */
+class StatsAccumulator
+{
+public:
+    void reset()
+    {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+        minVal = UINT16_MAX;
+        maxVal = 0;
+    }
+
+    void addSample(uint16_t value)
+    {
+        count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        if (value < minVal)
+            minVal = value;
+        if (value > maxVal)
+            maxVal = value;
+    }
+
+    uint16_t getMin() const { return count > 0 ? minVal : 0; }
+    uint16_t getMax() const { return count > 0 ? maxVal : 0; }
+    uint16_t getMean() const { return count > 0 ? (uint16_t)mean : 0; }
+    uint16_t getStdDev() const { return (uint16_t)getStdDevExact(); }
+
+    float getMeanExact() const { return (float)mean; }
+    float getStdDevExact() const { return count < 2 ? 0 : (float)sqrt(m2 / (count - 1)); }
+
+    uint32_t getCount() const { return count; }
+
+private:
+    uint32_t count = 0;
+    double mean = 0;
+    double m2 = 0; // Sum of squared deviations from the mean
+    uint16_t minVal = UINT16_MAX;
+    uint16_t maxVal = 0;
+};
+
 /**
  * Calibration data for a single PCB
  * Aggregates both sensors on the PCB
@@ -199,9 +251,20 @@ struct DeviceCalibration
     }
 };
 
+/**
+ * Last converged detector baseline for one sensor (CalibrationStore)
+ * Used to warm-start the rolling baseline instead of rebuilding it
+ */
+struct SensorBaseline
+{
+    uint16_t mean;      // Rolling baseline average
+    uint16_t max;       // Rolling baseline maximum (noise ceiling)
+    uint16_t threshold; // Detection threshold derived from it
+};
+
 /**
  * Global calibration data instance
- * Stored in RAM for MVP, can be persisted to LittleFS later
+ * Persisted in NVS by CalibrationStore, loaded at boot
  */
 extern DeviceCalibration deviceCalibration;
 
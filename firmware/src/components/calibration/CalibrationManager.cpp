@@ -1,4 +1,5 @@
 #include "CalibrationManager.h"
+#include "CalibrationStore.h"
 
 // Global instances
 DeviceCalibration deviceCalibration;
@@ -11,6 +12,7 @@ CalibrationManager calibrationManager;
 CalibrationManager::CalibrationManager()
     : _sensorMgr(nullptr),
       _display(nullptr),
+      _store(nullptr),
       _state(CalibrationState::IDLE),
       _currentPCB(0),
       _stateStartTime(0),
@@ -21,12 +23,23 @@ CalibrationManager::CalibrationManager()
       _buttonWasPressed(false),
       _multiPulse(1),
       _integrationTime(1),
-      _ledCurrent(200)
+      _ledCurrent(200),
+      _parallel(false),
+      _sampling(false),
+      _frameRing(nullptr),
+      _pcbElevatedMask(0),
+      _pcbDoneMask(0)
 {
     _calibration.reset();
+    for (int i = 0; i < CALIBRATION_NUM_PCBS; i++)
+    {
+        _pcbElevatedStart[i] = 0;
+        _pcbReading[i] = 0;
+    }
 }
 
-bool CalibrationManager::begin(SensorManager *sensorMgr, DisplayManager *display)
+bool CalibrationManager::begin(SensorManager *sensorMgr, DisplayManager *display,
+                               CalibrationStore *store)
 {
     if (sensorMgr == nullptr)
     {
@@ -36,6 +49,7 @@ bool CalibrationManager::begin(SensorManager *sensorMgr, DisplayManager *display
 
     _sensorMgr = sensorMgr;
     _display = display;
+    _store = store;
 
     // Initialize button pins
     pinMode(CAL_BUTTON_TRIGGER, INPUT_PULLUP);
@@ -80,6 +94,14 @@ void CalibrationManager::update()
         handleApproach();
         break;
 
+    case CalibrationState::BASELINE_ALL:
+        handleBaselineAll();
+        break;
+
+    case CalibrationState::APPROACH_ALL:
+        handleApproachAll();
+        break;
+
     case CalibrationState::SUMMARY:
         handleSummary();
         break;
@@ -127,7 +149,12 @@ void CalibrationManager::handleIntro()
     if (elapsed >= CAL_INTRO_DURATION_MS)
     {
         introRendered = false; // Reset for next time
-        transitionTo(CalibrationState::BASELINE_PCB1);
+        if (_parallel && !startSampling())
+        {
+            Serial.println("[CalibrationManager] Sensor collection unavailable - calibrating PCBs one at a time");
+            _parallel = false;
+        }
+        transitionTo(getNextState());
     }
 }
 
@@ -157,7 +184,7 @@ void CalibrationManager::handleBaseline()
     // Check if baseline capture is complete
     if (elapsed >= CAL_BASELINE_DURATION_MS)
     {
-        saveBaselineStats();
+        saveBaselineStats(_currentPCB - 1, _baselineStats);
 
         Serial.printf("[CalibrationManager] PCB%d baseline: min=%d, max=%d, mean=%d, stddev=%d (n=%lu)\n",
                       _currentPCB,
@@ -229,7 +256,7 @@ void CalibrationManager::handleApproach()
         if (elevatedDuration >= CAL_APPROACH_SUSTAIN_MS)
         {
             // Success! We have enough data
-            saveSignalStats();
+            saveSignalStats(pcbIndex, _signalStats);
 
             Serial.printf("[CalibrationManager] PCB%d signal captured: min=%d, max=%d, mean=%d (n=%lu)\n",
                           _currentPCB,
@@ -305,6 +332,89 @@ void CalibrationManager::handleApproach()
     }
 }
 
+void CalibrationManager::handleBaselineAll()
+{
+    uint32_t elapsed = millis() - _stateStartTime;
+
+    drainFrames(true);
+
+    static uint32_t lastDisplayUpdate = 0;
+    if (millis() - lastDisplayUpdate >= 50)
+    {
+        lastDisplayUpdate = millis();
+        if (_display)
+        {
+            _display->showCalibrationBaseline(0, getPhaseProgress());
+        }
+    }
+
+    if (elapsed >= CAL_BASELINE_DURATION_MS)
+    {
+        for (uint8_t i = 0; i < CALIBRATION_NUM_PCBS; i++)
+        {
+            saveBaselineStats(i, _pcbBaseline[i]);
+            Serial.printf("[CalibrationManager] PCB%d baseline: min=%d, max=%d, mean=%d, stddev=%d (n=%lu)\n",
+                          i + 1,
+                          _pcbBaseline[i].getMin(),
+                          _pcbBaseline[i].getMax(),
+                          _pcbBaseline[i].getMean(),
+                          _pcbBaseline[i].getStdDev(),
+                          _pcbBaseline[i].getCount());
+        }
+
+        transitionTo(getNextState());
+    }
+}
+
+void CalibrationManager::handleApproachAll()
+{
+    uint32_t elapsed = millis() - _stateStartTime;
+
+    drainFrames(false);
+
+    const uint8_t allPCBs = (1 << CALIBRATION_NUM_PCBS) - 1;
+    if (_pcbDoneMask == allPCBs)
+    {
+        transitionTo(getNextState());
+        return;
+    }
+
+    static uint32_t lastDisplayUpdate = 0;
+    if (millis() - lastDisplayUpdate >= 100)
+    {
+        lastDisplayUpdate = millis();
+        if (_display)
+        {
+            uint16_t thresholds[CALIBRATION_NUM_PCBS];
+            uint8_t progress[CALIBRATION_NUM_PCBS];
+            for (uint8_t i = 0; i < CALIBRATION_NUM_PCBS; i++)
+            {
+                thresholds[i] = elevatedThreshold(i);
+                progress[i] = 0;
+                if (_pcbElevatedMask & (1 << i))
+                {
+                    uint32_t sustainedTime = millis() - _pcbElevatedStart[i];
+                    progress[i] = min(100, (int)(sustainedTime * 100 / CAL_APPROACH_SUSTAIN_MS));
+                }
+            }
+            _display->showCalibrationApproachAll(_pcbReading, thresholds, progress, _pcbDoneMask, getTimeRemaining());
+        }
+    }
+
+    if (elapsed >= CAL_PARALLEL_APPROACH_TIMEOUT_MS)
+    {
+        for (uint8_t i = 0; i < CALIBRATION_NUM_PCBS; i++)
+        {
+            if (!(_pcbDoneMask & (1 << i)))
+            {
+                Serial.printf("[CalibrationManager] PCB%d: Approach timeout - SKIPPING\n", i + 1);
+                _calibration.pcbs[i].valid = false;
+            }
+        }
+        transitionTo(getNextState());
+    }
+}
+
 void CalibrationManager::handleSummary()
 {
     uint32_t elapsed = millis() - _stateStartTime;
@@ -349,6 +459,12 @@ void CalibrationManager::handleComplete()
     Serial.println("[CalibrationManager] Calibration complete!");
     _calibration.debugPrint();
 
+    // Kept across resets
+    if (_store)
+    {
+        _store->saveCalibration(deviceCalibration);
+    }
+
     // Show complete message
     if (_display)
     {
@@ -403,7 +519,7 @@ void CalibrationManager::handleCancelled()
 // Public Interface
 // ============================================================================
 
-bool CalibrationManager::startCalibration()
+bool CalibrationManager::startCalibration(bool parallel)
 {
     if (_sensorMgr == nullptr)
     {
@@ -417,7 +533,9 @@ bool CalibrationManager::startCalibration()
         return false;
     }
 
-    Serial.println("[CalibrationManager] Starting calibration wizard");
+    _parallel = parallel && _frameRing != nullptr;
+    Serial.printf("[CalibrationManager] Starting calibration wizard (%s)\n",
+                  _parallel ? "all PCBs at once" : "one PCB at a time");
 
     // Reset calibration data
     _calibration.reset();
@@ -458,6 +576,10 @@ const char *CalibrationManager::getStateName() const
         return "BASELINE_PCB3";
     case CalibrationState::APPROACH_PCB3:
         return "APPROACH_PCB3";
+    case CalibrationState::BASELINE_ALL:
+        return "BASELINE_ALL";
+    case CalibrationState::APPROACH_ALL:
+        return "APPROACH_ALL";
     case CalibrationState::SUMMARY:
         return "SUMMARY";
     case CalibrationState::COMPLETE:
@@ -485,6 +607,7 @@ uint8_t CalibrationManager::getPhaseProgress() const
     case CalibrationState::BASELINE_PCB1:
     case CalibrationState::BASELINE_PCB2:
     case CalibrationState::BASELINE_PCB3:
+    case CalibrationState::BASELINE_ALL:
         duration = CAL_BASELINE_DURATION_MS;
         break;
 
@@ -521,6 +644,11 @@ uint32_t CalibrationManager::getTimeRemaining() const
             return 0;
         return CAL_APPROACH_TIMEOUT_MS - elapsed;
 
+    case CalibrationState::APPROACH_ALL:
+        if (elapsed >= CAL_PARALLEL_APPROACH_TIMEOUT_MS)
+            return 0;
+        return CAL_PARALLEL_APPROACH_TIMEOUT_MS - elapsed;
+
     default:
         return 0;
     }
@@ -605,9 +733,128 @@ void CalibrationManager::transitionTo(CalibrationState newState)
         _currentPCB = 3;
         _signalStats.reset();
         break;
+    case CalibrationState::BASELINE_ALL:
+        _currentPCB = 0;
+        for (int i = 0; i < CALIBRATION_NUM_PCBS; i++)
+            _pcbBaseline[i].reset();
+        break;
+    case CalibrationState::APPROACH_ALL:
+        _currentPCB = 0;
+        for (int i = 0; i < CALIBRATION_NUM_PCBS; i++)
+        {
+            _pcbSignal[i].reset();
+            _pcbElevatedStart[i] = 0;
+            _pcbReading[i] = 0;
+        }
+        _pcbElevatedMask = 0;
+        _pcbDoneMask = 0;
+        break;
     default:
         break;
     }
+
+    // Parallel phases over (done, cancelled or failed): release the sensors
+    if (_sampling && newState != CalibrationState::BASELINE_ALL && newState != CalibrationState::APPROACH_ALL)
+    {
+        stopSampling();
+    }
+}
+
+bool CalibrationManager::startSampling()
+{
+    if (_frameRing == nullptr || _sensorMgr == nullptr)
+        return false;
+
+    _frameRing->discardAll();
+    if (!_sensorMgr->startCollection(_frameRing))
+        return false;
+
+    _sampling = true;
+    return true;
+}
+
+void CalibrationManager::stopSampling()
+{
+    _sensorMgr->stopCollection();
+    _frameRing->discardAll();
+    _sampling = false;
+}
+
+void CalibrationManager::drainFrames(bool baseline)
+{
+    const size_t BATCH = 32;
+    SensorFrame frames[BATCH];
+    size_t n;
+    while ((n = _frameRing->popBulk(frames, BATCH)) > 0)
+    {
+        for (size_t f = 0; f < n; f++)
+        {
+            const SensorFrame &frame = frames[f];
+            for (uint8_t i = 0; i < CALIBRATION_NUM_PCBS; i++)
+            {
+                // Same aggregate as readPCB(): sum of the PCB's valid sensors
+                uint8_t pos1 = i * 2;
+                uint8_t pos2 = i * 2 + 1;
+                if (!frame.isValid(pos1) && !frame.isValid(pos2))
+                    continue;
+
+                uint16_t reading = (frame.isValid(pos1) ? frame.proximity[pos1] : 0) +
+                                   (frame.isValid(pos2) ? frame.proximity[pos2] : 0);
+                _pcbReading[i] = reading;
+                if (baseline)
+                    _pcbBaseline[i].addSample(reading);
+                else
+                    trackApproach(i, reading, frame.timestamp_us / 1000);
+            }
+        }
+    }
+}
+
+uint16_t CalibrationManager::elevatedThreshold(uint8_t pcbIndex) const
+{
+    return (uint16_t)max((float)_calibration.pcbs[pcbIndex].baseline_max * CAL_ELEVATED_MULTIPLIER,
+                         (float)CAL_MIN_ELEVATED_READING);
+}
+
+void CalibrationManager::trackApproach(uint8_t pcbIndex, uint16_t reading, uint32_t nowMs)
+{
+    uint8_t bit = 1 << pcbIndex;
+    if (_pcbDoneMask & bit)
+        return;
+
+    uint16_t baselineMax = _calibration.pcbs[pcbIndex].baseline_max;
+    if (reading > elevatedThreshold(pcbIndex))
+    {
+        if (!(_pcbElevatedMask & bit))
+        {
+            _pcbElevatedMask |= bit;
+            _pcbElevatedStart[pcbIndex] = nowMs;
+            _pcbSignal[pcbIndex].reset();
+            Serial.printf("[CalibrationManager] PCB%d: Elevated readings detected (reading=%d, threshold=%d)\n",
+                          pcbIndex + 1, reading, elevatedThreshold(pcbIndex));
+        }
+
+        _pcbSignal[pcbIndex].addSample(reading);
+        if (nowMs - _pcbElevatedStart[pcbIndex] >= CAL_APPROACH_SUSTAIN_MS)
+        {
+            PCBCalibration &pcb = _calibration.pcbs[pcbIndex];
+            saveSignalStats(pcbIndex, _pcbSignal[pcbIndex]);
+            pcb.calculateThreshold();
+            pcb.valid = true;
+            _pcbDoneMask |= bit;
+            _pcbElevatedMask &= ~bit;
+
+            Serial.printf("[CalibrationManager] PCB%d signal captured: min=%d, max=%d, mean=%d (n=%lu), threshold=%d\n",
+                          pcbIndex + 1, pcb.signal_min, pcb.signal_max, pcb.signal_mean,
+                          _pcbSignal[pcbIndex].getCount(), pcb.threshold);
+        }
+    }
+    else if ((_pcbElevatedMask & bit) && reading < baselineMax + 5)
+    {
+        // Same hysteresis as handleApproach()
+        _pcbElevatedMask &= ~bit;
+        Serial.printf("[CalibrationManager] PCB%d: Elevation lost, resetting\n", pcbIndex + 1);
+    }
 }
 
 bool CalibrationManager::readPCB(uint8_t pcbId, uint16_t &reading)
@@ -650,27 +897,25 @@ bool CalibrationManager::readPCB(uint8_t pcbId, uint16_t &reading)
     return true;
 }
 
-void CalibrationManager::saveBaselineStats()
+void CalibrationManager::saveBaselineStats(uint8_t pcbIndex, const StatsAccumulator &stats)
 {
-    uint8_t pcbIndex = _currentPCB - 1;
     if (pcbIndex >= CALIBRATION_NUM_PCBS)
         return;
 
-    _calibration.pcbs[pcbIndex].baseline_min = _baselineStats.getMin();
-    _calibration.pcbs[pcbIndex].baseline_max = _baselineStats.getMax();
-    _calibration.pcbs[pcbIndex].baseline_mean = _baselineStats.getMean();
-    _calibration.pcbs[pcbIndex].baseline_stddev = _baselineStats.getStdDev();
+    _calibration.pcbs[pcbIndex].baseline_min = stats.getMin();
+    _calibration.pcbs[pcbIndex].baseline_max = stats.getMax();
+    _calibration.pcbs[pcbIndex].baseline_mean = stats.getMean();
+    _calibration.pcbs[pcbIndex].baseline_stddev = stats.getStdDev();
 }
 
-void CalibrationManager::saveSignalStats()
+void CalibrationManager::saveSignalStats(uint8_t pcbIndex, const StatsAccumulator &stats)
 {
-    uint8_t pcbIndex = _currentPCB - 1;
     if (pcbIndex >= CALIBRATION_NUM_PCBS)
         return;
 
-    _calibration.pcbs[pcbIndex].signal_min = _signalStats.getMin();
-    _calibration.pcbs[pcbIndex].signal_max = _signalStats.getMax();
-    _calibration.pcbs[pcbIndex].signal_mean = _signalStats.getMean();
+    _calibration.pcbs[pcbIndex].signal_min = stats.getMin();
+    _calibration.pcbs[pcbIndex].signal_max = stats.getMax();
+    _calibration.pcbs[pcbIndex].signal_mean = stats.getMean();
 }
 
 bool CalibrationManager::configureSensorForCalibration(uint8_t position)
@@ -703,7 +948,11 @@ CalibrationState CalibrationManager::getNextState() const
     switch (_state)
     {
     case CalibrationState::INTRO:
-        return CalibrationState::BASELINE_PCB1;
+        return _parallel ? CalibrationState::BASELINE_ALL : CalibrationState::BASELINE_PCB1;
+    case CalibrationState::BASELINE_ALL:
+        return CalibrationState::APPROACH_ALL;
+    case CalibrationState::APPROACH_ALL:
+        return CalibrationState::SUMMARY;
     case CalibrationState::BASELINE_PCB1:
         return CalibrationState::APPROACH_PCB1;
     case CalibrationState::APPROACH_PCB1:
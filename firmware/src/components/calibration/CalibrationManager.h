@@ -6,11 +6,18 @@
  * 2. Captures signal range (object present) for each PCB
  * 3. Calculates optimal thresholds for detection
  *
- * Calibration Flow:
+ * Calibration Flow (sequential):
  *   IDLE → INTRO → BASELINE_PCB1 → APPROACH_PCB1 →
  *                  BASELINE_PCB2 → APPROACH_PCB2 →
  *                  BASELINE_PCB3 → APPROACH_PCB3 → SUMMARY → COMPLETE
  *
+ * Parallel (default when a frame ring is set):
+ *   IDLE → INTRO → BASELINE_ALL → APPROACH_ALL → SUMMARY → COMPLETE
+ *   Sensors are polled by the sensor task (startCollection(), the normal
+ *   acquisition path) instead of readSensor() per PCB. One baseline phase
+ *   covers every PCB, and approaches are accepted on any PCB in any order
+ *   without the per-PCB success pause.
+ *
  * Triggers:
  *   - Frontend: SET_MODE command with CALIBRATE mode
  *   - Physical: Hold Button 1 for 3 seconds
@@ -33,6 +40,8 @@
 #include "../sensor/SensorManager.h"
 #include "../display/DisplayManager.h"
 
+class CalibrationStore;
+
 // ============================================================================
 // Configuration Constants
 // ============================================================================
@@ -45,6 +54,13 @@
 #define CAL_SUCCESS_DISPLAY_MS 1500       // Show success before next step
 #define CAL_SUMMARY_MIN_DISPLAY_MS 2000   // Minimum summary display time
 
+#define CAL_PARALLEL_APPROACH_TIMEOUT_MS 20000 // All PCBs, parallel mode
+
+// Parallel unless the caller says otherwise (needs setFrameRing())
+#ifndef CAL_PARALLEL_DEFAULT
+#define CAL_PARALLEL_DEFAULT true
+#endif
+
 // Detection thresholds
 #define CAL_ELEVATED_MULTIPLIER 2.0f      // Reading must be 2× baseline to count as elevated
 #define CAL_MIN_ELEVATED_READING 10       // Minimum absolute reading to count as elevated
@@ -68,64 +84,14 @@ enum class CalibrationState : uint8_t
     APPROACH_PCB2,    // Waiting for approach on PCB 2
     BASELINE_PCB3,    // Capturing baseline for PCB 3
     APPROACH_PCB3,    // Waiting for approach on PCB 3
+    BASELINE_ALL,     // Parallel: capturing baseline for every PCB
+    APPROACH_ALL,     // Parallel: waiting for approaches on any PCB
     SUMMARY,          // Showing summary
     COMPLETE,         // Calibration complete
     FAILED,           // Calibration failed
     CANCELLED         // User cancelled
 };
 
-// ============================================================================
-// Statistics Accumulator
-// ============================================================================
-
-/**
- * Helper class to accumulate statistics during calibration
- */
-class StatsAccumulator
-{
-public:
-    void reset()
-    {
-        count = 0;
-        sum = 0;
-        sumSq = 0;
-        minVal = UINT16_MAX;
-        maxVal = 0;
-    }
-
-    void addSample(uint16_t value)
-    {
-        count++;
-        sum += value;
-        sumSq += (uint32_t)value * value;
-        if (value < minVal)
-            minVal = value;
-        if (value > maxVal)
-            maxVal = value;
-    }
-
-    uint16_t getMin() const { return count > 0 ? minVal : 0; }
-    uint16_t getMax() const { return count > 0 ? maxVal : 0; }
-    uint16_t getMean() const { return count > 0 ? (uint16_t)(sum / count) : 0; }
-
-    uint16_t getStdDev() const
-    {
-        if (count < 2)
-            return 0;
-        uint32_t variance = (sumSq - (sum * sum / count)) / (count - 1);
-        return (uint16_t)sqrt(variance);
-    }
-
-    uint32_t getCount() const { return count; }
-
-private:
-    uint32_t count = 0;
-    uint32_t sum = 0;
-    uint32_t sumSq = 0;
-    uint16_t minVal = UINT16_MAX;
-    uint16_t maxVal = 0;
-};
-
 // ============================================================================
 // Calibration Manager Class
 // ============================================================================
@@ -139,9 +105,11 @@ public:
      * Initialize the calibration manager
      * @param sensorMgr Pointer to SensorManager for sensor reading
      * @param display Pointer to DisplayManager for UI rendering (optional)
+     * @param store Where completed calibrations are saved (optional)
      * @return true if successful
      */
-    bool begin(SensorManager *sensorMgr, DisplayManager *display = nullptr);
+    bool begin(SensorManager *sensorMgr, DisplayManager *display = nullptr,
+               CalibrationStore *store = nullptr);
 
     /**
      * Update function - call every loop iteration
@@ -151,9 +119,17 @@ public:
 
     /**
      * Start the calibration wizard
+     * @param parallel All PCBs at once from the sensor task (falls back to
+     *        sequential without a frame ring, or if collection cannot start)
      * @return true if calibration started
      */
-    bool startCalibration();
+    bool startCalibration(bool parallel = CAL_PARALLEL_DEFAULT);
+
+    /**
+     * Frame ring for parallel calibration (the idle session ring: the
+     * sensors are not collecting while calibration runs)
+     */
+    void setFrameRing(SensorFrameRing *ring) { _frameRing = ring; }
 
     /**
      * Cancel ongoing calibration
@@ -187,7 +163,8 @@ public:
     const char *getStateName() const;
 
     /**
-     * Get current PCB being calibrated (1-3, or 0 if not calibrating a PCB)
+     * Get current PCB being calibrated (1-3, or 0 if not calibrating a PCB
+     * or calibrating all of them)
      */
     uint8_t getCurrentPCB() const { return _currentPCB; }
 
@@ -227,6 +204,7 @@ public:
 private:
     SensorManager *_sensorMgr;
     DisplayManager *_display;
+    CalibrationStore *_store;
 
     CalibrationState _state;
     uint8_t _currentPCB;        // 1-3 during calibration
@@ -246,6 +224,17 @@ private:
     // Working calibration data
     DeviceCalibration _calibration;
 
+    // Parallel mode: per-PCB stats fed from the sensor task's frames
+    bool _parallel;
+    bool _sampling; // Sensor task collecting into _frameRing
+    SensorFrameRing *_frameRing;
+    StatsAccumulator _pcbBaseline[CALIBRATION_NUM_PCBS];
+    StatsAccumulator _pcbSignal[CALIBRATION_NUM_PCBS];
+    uint32_t _pcbElevatedStart[CALIBRATION_NUM_PCBS];
+    uint16_t _pcbReading[CALIBRATION_NUM_PCBS];
+    uint8_t _pcbElevatedMask; // PCBs with a sustained approach in progress
+    uint8_t _pcbDoneMask;     // PCBs whose signal was captured
+
     // Sensor configuration
     uint8_t _multiPulse;
     uint8_t _integrationTime;
@@ -259,15 +248,22 @@ private:
     void handleComplete();
     void handleFailed();
     void handleCancelled();
+    void handleBaselineAll();
+    void handleApproachAll();
 
     // Helpers
     void transitionTo(CalibrationState newState);
     bool readPCB(uint8_t pcbId, uint16_t &reading);
-    void saveBaselineStats();
-    void saveSignalStats();
+    void saveBaselineStats(uint8_t pcbIndex, const StatsAccumulator &stats);
+    void saveSignalStats(uint8_t pcbIndex, const StatsAccumulator &stats);
     bool configureSensorForCalibration(uint8_t position);
     uint8_t getPCBForState(CalibrationState state) const;
     CalibrationState getNextState() const;
+    bool startSampling();
+    void stopSampling();
+    void drainFrames(bool baseline);
+    void trackApproach(uint8_t pcbIndex, uint16_t reading, uint32_t nowMs);
+    uint16_t elevatedThreshold(uint8_t pcbIndex) const;
 };
 
 // Global instance (optional - can also be instantiated locally)
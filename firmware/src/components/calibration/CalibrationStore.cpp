@@ -0,0 +1,164 @@
+#include "CalibrationStore.h"
+
+static const char *KEY_DEVICE = "device";
+static const char *KEY_BASELINE = "baseline";
+
+bool CalibrationStore::begin()
+{
+    if (!prefs.begin(CALIBRATION_STORE_NAMESPACE, false))
+    {
+        Serial.println("WARNING: Calibration NVS unavailable - calibration is not kept across resets");
+        return false;
+    }
+    opened = true;
+
+    DeviceCalibration stored;
+    if (prefs.getBytesLength(KEY_DEVICE) == sizeof(stored) &&
+        prefs.getBytes(KEY_DEVICE, &stored, sizeof(stored)) == sizeof(stored) &&
+        stored.isValid())
+    {
+        deviceCalibration = stored;
+        Serial.println("[CalibrationStore] Device calibration loaded from NVS");
+    }
+
+    recordValid = prefs.getBytesLength(KEY_BASELINE) == sizeof(record) &&
+                  prefs.getBytes(KEY_BASELINE, &record, sizeof(record)) == sizeof(record) &&
+                  record.magic == CALIBRATION_MAGIC &&
+                  record.version == CALIBRATION_STORE_VERSION;
+    if (recordValid)
+    {
+        Serial.printf("[CalibrationStore] Baselines for MP=%d IT=%dT LED=%dmA (sensors 0x%02X, PS_CANC 0x%02X)\n",
+                      record.settings.multi_pulse, record.settings.integration_time,
+                      record.settings.led_current, record.baselineMask, record.cancellationMask);
+    }
+    else
+    {
+        record = {};
+    }
+    return true;
+}
+
+bool CalibrationStore::saveCalibration(const DeviceCalibration &calibration)
+{
+    if (!opened || !calibration.isValid())
+        return false;
+
+    if (prefs.putBytes(KEY_DEVICE, &calibration, sizeof(calibration)) != sizeof(calibration))
+    {
+        Serial.println("WARNING: Calibration NVS write failed");
+        return false;
+    }
+    Serial.println("[CalibrationStore] Device calibration saved");
+    return true;
+}
+
+bool CalibrationStore::matches(const CalibrationSettings &settings) const
+{
+    return recordValid && record.settings == settings;
+}
+
+bool CalibrationStore::hasBaselines(const CalibrationSettings &settings) const
+{
+    return matches(settings) && record.baselineMask != 0;
+}
+
+bool CalibrationStore::restoreCancellation(SensorManager &sensors, const CalibrationSettings &settings)
+{
+    if (!matches(settings) || record.cancellationMask == 0)
+        return false;
+    return sensors.restoreProximityCancellation(record.cancellation, record.cancellationMask);
+}
+
+uint8_t CalibrationStore::warmStart(DirectionDetector &detector, const CalibrationSettings &settings) const
+{
+    if (!matches(settings))
+        return 0;
+
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        if (record.baselineMask & (1 << i))
+        {
+            detector.warmStart(i, record.baselines[i]);
+            count++;
+        }
+    }
+    return count;
+}
+
+bool CalibrationStore::driftCheckDue()
+{
+    uint32_t now = millis();
+    if (now - lastCheckMs < CAL_DRIFT_CHECK_INTERVAL_MS)
+        return false;
+    lastCheckMs = now;
+    return true;
+}
+
+static bool drifted(uint16_t a, uint16_t b)
+{
+    return (a > b ? a - b : b - a) > CAL_DRIFT_COUNTS;
+}
+
+bool CalibrationStore::checkDrift(const SensorBaseline *live, SensorMask liveMask,
+                                  const SensorManager &sensors, const CalibrationSettings &settings)
+{
+    if (!opened || liveMask == 0)
+        return false;
+
+    bool sameSettings = matches(settings);
+    uint8_t stale = 0;
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!(liveMask & (1 << i)))
+            continue;
+        const SensorBaseline &stored = record.baselines[i];
+        if (!sameSettings || !(record.baselineMask & (1 << i)) ||
+            drifted(live[i].mean, stored.mean) || drifted(live[i].max, stored.max))
+            stale |= (1 << i);
+    }
+
+    // PS_CANC values recalibrated since the record was written
+    SensorMask cancellationMask = sensors.getCancellationMask();
+    bool cancellationChanged = !sameSettings ? cancellationMask != 0 : cancellationMask != record.cancellationMask;
+    for (uint8_t i = 0; i < NUM_SENSORS && !cancellationChanged; i++)
+    {
+        if (cancellationMask & (1 << i))
+            cancellationChanged = sensors.getBaselineValue(i) != record.cancellation[i];
+    }
+
+    if (stale == 0 && !cancellationChanged)
+        return false;
+
+    uint32_t now = millis();
+    if (written && now - lastWriteMs < CAL_STORE_MIN_WRITE_INTERVAL_MS)
+        return false;
+
+    if (!sameSettings)
+        record = {};
+    record.magic = CALIBRATION_MAGIC;
+    record.version = CALIBRATION_STORE_VERSION;
+    record.settings = settings;
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        if (liveMask & (1 << i))
+            record.baselines[i] = live[i];
+        record.cancellation[i] = (cancellationMask & (1 << i)) ? sensors.getBaselineValue(i) : 0;
+    }
+    record.baselineMask |= liveMask;
+    record.cancellationMask = cancellationMask;
+    recordValid = true;
+
+    if (prefs.putBytes(KEY_BASELINE, &record, sizeof(record)) != sizeof(record))
+    {
+        Serial.println("WARNING: Baseline NVS write failed");
+        return false;
+    }
+
+    written = true;
+    lastWriteMs = now;
+    writeCount++;
+    Serial.printf("[CalibrationStore] Baselines saved (drifted 0x%02X%s)\n",
+                  stale, cancellationChanged ? ", PS_CANC changed" : "");
+    return true;
+}
@@ -0,0 +1,136 @@
+#ifndef CALIBRATION_STORE_H
+#define CALIBRATION_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "CalibrationData.h"
+#include "../sensor/SensorManager.h"
+#include "../detection/DirectionDetector.h"
+
+/**
+ * CalibrationStore - Calibration results and converged baselines in NVS
+ *
+ * Everything calibration produced used to live in RAM: the wizard result
+ * was lost at reset, PS_CANC values had to be sampled again, and the
+ * DirectionDetector rebuilt every baseline from baselineReadings idle
+ * readings after each fullReset ("establishing baseline"). The store keeps
+ * them in NVS so the device starts where it left off.
+ *
+ * - DeviceCalibration is stored as is; it loads into deviceCalibration at
+ *   begin() when its magic and version match
+ * - PS_CANC values and the last converged per-sensor baseline/threshold
+ *   are one record, stamped with CALIBRATION_MAGIC, a version and the
+ *   sensor settings they were measured with. Other settings, other
+ *   readings: a record for different settings is not used
+ * - warmStart() seeds the detector from the record, so it is READY at
+ *   once
+ * - Drift check (checkDrift(), every CAL_DRIFT_CHECK_INTERVAL_MS while
+ *   detecting): the record is rewritten only when a live baseline moved
+ *   more than CAL_DRIFT_COUNTS from it, and at most every
+ *   CAL_STORE_MIN_WRITE_INTERVAL_MS (flash wear)
+ *
+ * Called from loop() only (begin() from setup()).
+ */
+
+#ifndef CALIBRATION_STORE_NAMESPACE
+#define CALIBRATION_STORE_NAMESPACE "calibration"
+#endif
+
+// Baseline record layout; bump when BaselineRecord changes
+#define CALIBRATION_STORE_VERSION 1
+
+#ifndef CAL_DRIFT_CHECK_INTERVAL_MS
+#define CAL_DRIFT_CHECK_INTERVAL_MS 60000
+#endif
+
+// Baseline mean or max moved this far (counts): record is stale
+#ifndef CAL_DRIFT_COUNTS
+#define CAL_DRIFT_COUNTS 8
+#endif
+
+#ifndef CAL_STORE_MIN_WRITE_INTERVAL_MS
+#define CAL_STORE_MIN_WRITE_INTERVAL_MS 600000
+#endif
+
+// Sensor settings a calibration was measured with
+struct CalibrationSettings
+{
+    uint8_t multi_pulse;
+    uint8_t integration_time;
+    uint8_t led_current;
+
+    bool operator==(const CalibrationSettings &other) const
+    {
+        return multi_pulse == other.multi_pulse &&
+               integration_time == other.integration_time &&
+               led_current == other.led_current;
+    }
+};
+
+class CalibrationStore
+{
+public:
+    /**
+     * Open NVS, load the stored DeviceCalibration into deviceCalibration
+     * and read the baseline record
+     * @return false if NVS could not be opened
+     */
+    bool begin();
+
+    // Wizard result (CalibrationManager, on completion)
+    bool saveCalibration(const DeviceCalibration &calibration);
+
+    /**
+     * Write the stored PS_CANC values for these settings (no sampling)
+     * @return false if there are none or the write failed
+     */
+    bool restoreCancellation(SensorManager &sensors, const CalibrationSettings &settings);
+
+    /**
+     * Seed the detector's baselines from the record. Caller holds the
+     * DetectionTask guard, after fullReset() and setCalibration()
+     * @return number of sensors warm-started
+     */
+    uint8_t warmStart(DirectionDetector &detector, const CalibrationSettings &settings) const;
+
+    // A drift check is due (restarts the interval)
+    bool driftCheckDue();
+
+    /**
+     * Compare live baselines with the record; rewrite it if they drifted
+     * @param live One per sensor, from DirectionDetector::getBaseline()
+     * @param liveMask Sensors in live that are valid
+     * @return true if the record was written
+     */
+    bool checkDrift(const SensorBaseline *live, SensorMask liveMask,
+                    const SensorManager &sensors, const CalibrationSettings &settings);
+
+    bool hasBaselines(const CalibrationSettings &settings) const;
+    uint32_t getWriteCount() const { return writeCount; }
+
+private:
+    struct BaselineRecord
+    {
+        uint32_t magic;   // CALIBRATION_MAGIC
+        uint32_t version; // CALIBRATION_STORE_VERSION
+        CalibrationSettings settings;
+        SensorMask cancellationMask; // Sensors with a PS_CANC value
+        SensorMask baselineMask;     // Sensors with a baseline
+        uint16_t cancellation[NUM_SENSORS];
+        SensorBaseline baselines[NUM_SENSORS];
+    };
+
+    Preferences prefs;
+    bool opened = false;
+    BaselineRecord record = {};
+    bool recordValid = false;
+
+    uint32_t lastCheckMs = 0;
+    uint32_t lastWriteMs = 0;
+    bool written = false;
+    uint32_t writeCount = 0;
+
+    bool matches(const CalibrationSettings &settings) const;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef CAPTURE_RING_H
+#define CAPTURE_RING_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+#include "../sensor/SensorFrame.h"
+#include "../memory/PSRAMAllocator.h"
+
+/**
+ * CaptureRing - Fixed-size PSRAM circular buffer of whole sensor cycles
+ *
+ * Live Debug keeps the newest capacity() frames here while it waits for a
+ * detection, overwriting the oldest: pushing costs the same however long
+ * the session runs, and no data is thrown away in blocks.
+ *
+ * - Storage is reserved once (allocate()); push() never allocates
+ * - Index 0 is the oldest frame kept
+ * - linearize() rotates the storage so the frames are contiguous, oldest
+ *   first, from storage()[0] — for the upload task, which owns the ring
+ *   once it has been handed over
+ *
+ * Not thread-safe: one owner at a time (loop task while filling, upload
+ * task once submitted).
+ */
+class CaptureRing
+{
+public:
+    typedef std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> Storage;
+
+    /**
+     * Reserve room for capacity frames
+     * @return false if PSRAM is exhausted
+     */
+    bool allocate(size_t capacity)
+    {
+        frames.resize(capacity);
+        clear();
+        return frames.size() == capacity;
+    }
+
+    void push(const SensorFrame &frame)
+    {
+        size_t cap = frames.size();
+        if (cap == 0)
+            return;
+        frames[head] = frame;
+        head = (head + 1 == cap) ? 0 : head + 1;
+        if (count < cap)
+            count++;
+        pushed++;
+    }
+
+    const SensorFrame &operator[](size_t idx) const { return frames[physical(idx)]; }
+    const SensorFrame &back() const { return frames[physical(count - 1)]; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return frames.size(); }
+
+    // Frames ever pushed since clear() (cursor for readers that follow the ring)
+    uint32_t pushedCount() const { return pushed; }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+        pushed = 0;
+    }
+
+    /**
+     * Make the contents contiguous: frames [0, size()) of storage(), oldest first
+     */
+    void linearize()
+    {
+        if (frames.empty())
+            return;
+        size_t oldest = physical(0);
+        if (oldest != 0)
+            std::rotate(frames.begin(), frames.begin() + oldest, frames.end());
+        head = count % frames.size();
+    }
+
+    // Underlying storage; only meaningful as frames [0, size()) after linearize()
+    Storage &storage() { return frames; }
+
+    /**
+     * First index whose timestamp is at or after timestampUs (binary search;
+     * cycle timestamps only increase within a session)
+     */
+    size_t lowerBound(uint32_t timestampUs) const
+    {
+        size_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if ((*this)[mid].timestamp_us < timestampUs)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+private:
+    Storage frames;
+    size_t head = 0;  // Next write position
+    size_t count = 0; // Frames held (<= capacity)
+    uint32_t pushed = 0;
+
+    size_t physical(size_t idx) const
+    {
+        size_t cap = frames.size();
+        size_t pos = head + cap - count + idx; // < 2 * cap
+        return pos >= cap ? pos - cap : pos;
+    }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "CaptureUploader.h"
+
+CaptureUploader::CaptureUploader()
+{
+}
+
+bool CaptureUploader::begin(MQTTManager *mqtt)
+{
+    if (uploadTask != nullptr)
+        return true;
+
+    mqttManager = mqtt;
+    transmitter = new DataTransmitter(mqtt);
+
+    freeQueue = xQueueCreate(CAPTURE_UPLOAD_SLOTS, sizeof(CaptureJob *));
+    readyQueue = xQueueCreate(CAPTURE_UPLOAD_SLOTS, sizeof(CaptureJob *));
+    if (freeQueue == nullptr || readyQueue == nullptr)
+    {
+        Serial.println("ERROR: CaptureUploader queue creation failed");
+        return false;
+    }
+
+    // Reserve every slot once so captures never allocate in the loop
+    for (int i = 0; i < CAPTURE_UPLOAD_SLOTS; i++)
+    {
+        if (!slots[i].frames.allocate(CAPTURE_UPLOAD_SLOT_FRAMES))
+        {
+            Serial.println("ERROR: CaptureUploader slot allocation failed");
+            return false;
+        }
+        CaptureJob *job = &slots[i];
+        xQueueSend(freeQueue, &job, 0);
+    }
+
+    // Core 1 alongside loop(), same priority: TLS writes block on the
+    // socket and yield, so detection keeps its share of the core
+    BaseType_t created = xTaskCreatePinnedToCore(
+        uploadTaskFunction,
+        "UploadTask",
+        8192, // TLS + JSON header serialization
+        this,
+        1,
+        &uploadTask,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: CaptureUploader task creation failed");
+        uploadTask = nullptr;
+        return false;
+    }
+
+    Serial.printf("CaptureUploader ready: %d slots x %d frames (%d KB PSRAM)\n",
+                  CAPTURE_UPLOAD_SLOTS, CAPTURE_UPLOAD_SLOT_FRAMES,
+                  (int)(CAPTURE_UPLOAD_SLOTS * CAPTURE_UPLOAD_SLOT_FRAMES * sizeof(SensorFrame) / 1024));
+    return true;
+}
+
+CaptureJob *CaptureUploader::acquire()
+{
+    CaptureJob *job = nullptr;
+    if (freeQueue == nullptr || xQueueReceive(freeQueue, &job, 0) != pdTRUE)
+        return nullptr;
+
+    job->frames.clear();
+    job->windowStartUs = 0;
+    job->captureReason = nullptr;
+    job->detectionDirection = nullptr;
+    job->detectionConfidence = 0.0f;
+    job->successStatus = nullptr;
+    return job;
+}
+
+CaptureRing *CaptureUploader::beginLive()
+{
+    if (live == nullptr)
+        live = acquire();
+    return liveRing();
+}
+
+CaptureJob *CaptureUploader::freezeLive()
+{
+    if (live == nullptr)
+        return nullptr;
+
+    CaptureJob *next = acquire();
+    if (next == nullptr)
+        return nullptr;
+
+    CaptureJob *frozen = live;
+    live = next;
+    return frozen;
+}
+
+void CaptureUploader::endLive()
+{
+    if (live == nullptr)
+        return;
+    release(live);
+    live = nullptr;
+}
+
+void CaptureUploader::submit(CaptureJob *job)
+{
+    // Never blocks: the ready queue holds every slot
+    xQueueSend(readyQueue, &job, 0);
+}
+
+void CaptureUploader::release(CaptureJob *job)
+{
+    job->frames.clear();
+    xQueueSend(freeQueue, &job, 0);
+}
+
+size_t CaptureUploader::pending() const
+{
+    if (freeQueue == nullptr)
+        return 0;
+    return CAPTURE_UPLOAD_SLOTS - uxQueueMessagesWaiting(freeQueue);
+}
+
+void CaptureUploader::uploadTaskFunction(void *parameter)
+{
+    static_cast<CaptureUploader *>(parameter)->runUploads();
+}
+
+void CaptureUploader::runUploads()
+{
+    while (true)
+    {
+        CaptureJob *job = nullptr;
+        if (xQueueReceive(readyQueue, &job, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        // Trim to the capture window here rather than at freeze time, so the
+        // loop task's cost per capture stays constant
+        unsigned long start = millis();
+        job->frames.linearize();
+        size_t first = job->frames.lowerBound(job->windowStartUs);
+        size_t count = job->frames.size() - first;
+        String sessionId = transmitter->transmitLiveDebugCaptureBinary(
+            job->frames.storage(), first, count,
+            job->captureReason, job->detectionDirection, job->detectionConfidence,
+            job->summary, &job->config);
+
+        if (sessionId.length() > 0)
+        {
+            sentCount++;
+            Serial.printf("[UPLOAD] %s capture %s sent in %lums (%d frames)\n",
+                          job->captureReason, sessionId.c_str(), millis() - start, count);
+            if (job->successStatus != nullptr)
+                mqttManager->publishStatus(job->successStatus);
+        }
+        else
+        {
+            failedCount++;
+            Serial.printf("[UPLOAD] ERROR: %s capture upload failed\n", job->captureReason);
+            mqttManager->publishStatus("live_debug_capture_failed");
+        }
+
+        release(job);
+    }
+}
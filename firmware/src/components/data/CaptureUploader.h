@@ -0,0 +1,129 @@
+#ifndef CAPTURE_UPLOADER_H
+#define CAPTURE_UPLOADER_H
+
+#include <Arduino.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "DataTransmitter.h"
+#include "../mqtt/MQTTManager.h"
+#include "../session/SessionManager.h"
+#include "../sensor/SensorConfiguration.h"
+#include "CaptureRing.h"
+
+/**
+ * CaptureUploader - Background upload task for Live Debug captures
+ *
+ * One slot is the live capture ring: SessionManager pushes every Live
+ * Debug cycle into it. On a capture the loop task freezes it — a free
+ * slot becomes the new live ring (pointer swap, no copy) — and submits
+ * the frozen one; the upload task trims it to the capture window and
+ * streams it over MQTT while sampling and detection keep running.
+ * Nothing stops the sensor task, so there is no blind time.
+ *
+ * - Fixed pool of PSRAM slots, reserved once at begin(): with the default
+ *   of 2, one uploads while the other fills
+ * - Slots are immutable once submitted; the upload task returns them to
+ *   the free queue when done
+ * - If no slot is free, freezeLive() fails and the capture is counted as
+ *   dropped; the live ring simply keeps filling
+ * - The task has its own DataTransmitter (its stream staging buffers are
+ *   not shared with the loop task); MQTTManager serializes the client
+ */
+
+#ifndef CAPTURE_UPLOAD_SLOTS
+#define CAPTURE_UPLOAD_SLOTS 2
+#endif
+
+// Frames per slot (the live ring's depth): a 3 s missed-event window at 1 kHz
+#ifndef CAPTURE_UPLOAD_SLOT_FRAMES
+#define CAPTURE_UPLOAD_SLOT_FRAMES 3000
+#endif
+
+static_assert(CAPTURE_UPLOAD_SLOTS >= 2, "CaptureUploader needs a live slot plus one to freeze");
+
+struct CaptureJob
+{
+    CaptureRing frames;                       // Newest frames up to the freeze
+    uint32_t windowStartUs = 0;               // Frames before this are not uploaded
+    const char *captureReason = nullptr;      // String literal ("detection", "missed_event")
+    const char *detectionDirection = nullptr; // String literal, or nullptr
+    float detectionConfidence = 0.0f;
+    const char *successStatus = nullptr; // publishStatus() on success
+    SessionSummary summary;              // Snapshot taken at submit time
+    SensorConfiguration config;          // Snapshot taken at submit time
+};
+
+class CaptureUploader
+{
+public:
+    CaptureUploader();
+
+    /**
+     * Reserve slot memory and start the upload task
+     * @return false if PSRAM or task creation failed
+     */
+    bool begin(MQTTManager *mqtt);
+
+    /**
+     * Claim a free slot as the live capture ring (loop task, session start)
+     * @return nullptr if every slot is still queued or uploading
+     */
+    CaptureRing *beginLive();
+
+    // Current live ring, or nullptr outside Live Debug
+    CaptureRing *liveRing() { return live != nullptr ? &live->frames : nullptr; }
+
+    /**
+     * Freeze the live ring for upload: a free slot becomes the new live
+     * ring and the frozen job is returned for the caller to fill in and
+     * submit(). Re-point the ring's producer at liveRing() afterwards.
+     * @return nullptr if no slot is free (the live ring keeps filling)
+     */
+    CaptureJob *freezeLive();
+
+    /**
+     * Return the live slot (session end)
+     */
+    void endLive();
+
+    /**
+     * Hand a frozen slot to the upload task. The caller must not touch it after.
+     */
+    void submit(CaptureJob *job);
+
+    /**
+     * Return a frozen slot without uploading it
+     */
+    void release(CaptureJob *job);
+
+    // Capacity of one slot in frames
+    size_t slotFrames() const { return CAPTURE_UPLOAD_SLOT_FRAMES; }
+
+    // Captures waiting or in flight
+    size_t pending() const;
+
+    uint32_t getSentCount() const { return sentCount; }
+    uint32_t getFailedCount() const { return failedCount; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+    void countDropped() { droppedCount++; }
+
+private:
+    CaptureJob slots[CAPTURE_UPLOAD_SLOTS];
+    CaptureJob *live = nullptr; // Loop task only
+    QueueHandle_t freeQueue = nullptr;
+    QueueHandle_t readyQueue = nullptr;
+    TaskHandle_t uploadTask = nullptr;
+    MQTTManager *mqttManager = nullptr;
+    DataTransmitter *transmitter = nullptr;
+
+    volatile uint32_t sentCount = 0;
+    volatile uint32_t failedCount = 0;
+    volatile uint32_t droppedCount = 0;
+
+    CaptureJob *acquire();
+    static void uploadTaskFunction(void *parameter);
+    void runUploads();
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "ColumnCodec.h"
+#include "FrameCodec.h"
+
+using namespace FrameCodec;
+
+size_t ColumnCodec::encodeTimestamps(const SensorFrame *frames, size_t count, uint8_t *out)
+{
+    uint32_t prevTs = 0;
+    uint32_t prevDelta = 0;
+    size_t n = 0;
+    for (size_t f = 0; f < count; f++)
+    {
+        uint32_t delta = frames[f].timestamp_us - prevTs;
+        n += writeVarint(zigzag((int32_t)(delta - prevDelta)), out + n);
+        prevTs = frames[f].timestamp_us;
+        prevDelta = delta;
+    }
+    return n;
+}
+
+// Whether frame carries position's value in its column: valid frames do,
+// held ones only when the predictors (the last value sent) differ
+static bool carriesValue(const SensorFrame &frame, uint8_t position, uint16_t &prevProx, uint16_t &prevAmb)
+{
+    if (!frame.isValid(position) &&
+        !(frame.isHeld(position) && (frame.proximity[position] != prevProx || frame.ambient[position] != prevAmb)))
+        return false;
+    prevProx = frame.proximity[position];
+    prevAmb = frame.ambient[position];
+    return true;
+}
+
+size_t ColumnCodec::encodePosition(const SensorFrame *frames, size_t count, uint8_t position, uint8_t *out)
+{
+    size_t values = 0;
+    size_t held = 0;
+    bool ambient = false;
+    uint16_t prevProx = 0;
+    uint16_t prevAmb = 0;
+    for (size_t f = 0; f < count; f++)
+    {
+        held += frames[f].isHeld(position);
+        if (!carriesValue(frames[f], position, prevProx, prevAmb))
+            continue;
+        values++;
+        ambient |= frames[f].ambient[position] != 0;
+    }
+    if (values == 0 && held == 0)
+        return 0;
+
+    uint8_t flags = (values == count ? COLUMN_FLAG_ALL_VALID : 0) | (ambient ? COLUMN_FLAG_AMBIENT : 0) |
+                    (held ? COLUMN_FLAG_HELD : 0);
+    size_t n = 0;
+    out[n++] = flags;
+
+    size_t bitmapBytes = (count + 7) / 8;
+    if (!(flags & COLUMN_FLAG_ALL_VALID))
+    {
+        memset(out + n, 0, bitmapBytes);
+        prevProx = prevAmb = 0;
+        for (size_t f = 0; f < count; f++)
+        {
+            if (carriesValue(frames[f], position, prevProx, prevAmb))
+                out[n + f / 8] |= 1 << (f % 8);
+        }
+        n += bitmapBytes;
+    }
+
+    if (flags & COLUMN_FLAG_HELD)
+    {
+        memset(out + n, 0, bitmapBytes);
+        for (size_t f = 0; f < count; f++)
+        {
+            if (frames[f].isHeld(position))
+                out[n + f / 8] |= 1 << (f % 8);
+        }
+        n += bitmapBytes;
+    }
+
+    uint16_t prev = 0;
+    prevProx = prevAmb = 0;
+    for (size_t f = 0; f < count; f++)
+    {
+        if (!carriesValue(frames[f], position, prevProx, prevAmb))
+            continue;
+        n += writeVarint(zigzag((int16_t)(frames[f].proximity[position] - prev)), out + n);
+        prev = frames[f].proximity[position];
+    }
+
+    if (ambient)
+    {
+        prev = 0;
+        prevProx = prevAmb = 0;
+        for (size_t f = 0; f < count; f++)
+        {
+            if (!carriesValue(frames[f], position, prevProx, prevAmb))
+                continue;
+            n += writeVarint(zigzag((int16_t)(frames[f].ambient[position] - prev)), out + n);
+            prev = frames[f].ambient[position];
+        }
+    }
+
+    return n;
+}
+
+bool ColumnCodec::decodeTimestamps(const uint8_t *in, size_t length, SensorFrame *frames, size_t count)
+{
+    uint32_t prevTs = 0;
+    uint32_t prevDelta = 0;
+    size_t pos = 0;
+    for (size_t f = 0; f < count; f++)
+    {
+        uint32_t v;
+        size_t used = readVarint(in + pos, length - pos, v);
+        if (used == 0)
+            return false;
+        pos += used;
+
+        prevDelta += (uint32_t)unzigzag(v);
+        prevTs += prevDelta;
+        memset(&frames[f], 0, sizeof(SensorFrame));
+        frames[f].timestamp_us = prevTs;
+    }
+    return pos == length;
+}
+
+bool ColumnCodec::decodePosition(const uint8_t *in, size_t length, uint8_t position, SensorFrame *frames, size_t count)
+{
+    if (length == 0)
+        return true;
+    if (position >= NUM_SENSORS)
+        return false;
+
+    uint8_t flags = in[0];
+    size_t pos = 1;
+    const uint8_t *bitmap = nullptr;
+    const uint8_t *heldBitmap = nullptr;
+    if (!(flags & COLUMN_FLAG_ALL_VALID))
+    {
+        bitmap = in + pos;
+        pos += (count + 7) / 8;
+    }
+    if (flags & COLUMN_FLAG_HELD)
+    {
+        heldBitmap = in + pos;
+        pos += (count + 7) / 8;
+    }
+    if (pos > length)
+        return false;
+
+    SensorMask bit = (SensorMask)1 << position;
+    for (int pass = 0; pass < ((flags & COLUMN_FLAG_AMBIENT) ? 2 : 1); pass++)
+    {
+        uint16_t prev = 0;
+        for (size_t f = 0; f < count; f++)
+        {
+            bool value = bitmap == nullptr || (bitmap[f / 8] & (1 << (f % 8)));
+            bool held = heldBitmap != nullptr && (heldBitmap[f / 8] & (1 << (f % 8)));
+            if (!value && !held)
+                continue;
+
+            if (value)
+            {
+                uint32_t v;
+                size_t used = readVarint(in + pos, length - pos, v);
+                if (used == 0)
+                    return false;
+                pos += used;
+                prev += (uint16_t)unzigzag(v);
+            }
+
+            if (pass == 0)
+            {
+                frames[f].proximity[position] = prev;
+                if (held)
+                    frames[f].held_mask |= bit;
+                else
+                    frames[f].valid_mask |= bit;
+            }
+            else
+            {
+                frames[f].ambient[position] = prev;
+            }
+        }
+    }
+    return pos == length;
+}
+
+void ColumnCodec::packEntry(const ColumnChunkEntry &entry, uint8_t *out)
+{
+    memcpy(out, &entry.offset, 4);
+    memcpy(out + 4, &entry.firstUs, 4);
+    memcpy(out + 8, &entry.lastUs, 4);
+    memcpy(out + 12, &entry.frames, 2);
+    memcpy(out + 14, &entry.timestampBytes, 2);
+    memcpy(out + 16, entry.columnBytes, 2 * NUM_SENSORS);
+}
+
+void ColumnCodec::unpackEntry(const uint8_t *in, ColumnChunkEntry &entry)
+{
+    memcpy(&entry.offset, in, 4);
+    memcpy(&entry.firstUs, in + 4, 4);
+    memcpy(&entry.lastUs, in + 8, 4);
+    memcpy(&entry.frames, in + 12, 2);
+    memcpy(&entry.timestampBytes, in + 14, 2);
+    memcpy(entry.columnBytes, in + 16, 2 * NUM_SENSORS);
+}
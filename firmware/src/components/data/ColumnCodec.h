@@ -0,0 +1,118 @@
+/**
+ * ColumnCodec - Chunked columnar encoding of SensorFrame streams
+ *
+ * Storage / wire format "col1". dvz1 (FrameCodec.h) interleaves every
+ * position in every frame, so reading one sensor or one second means
+ * decoding everything before it. col1 cuts the stream into chunks of at
+ * most SESSION_COLUMN_CHUNK_MS and stores each chunk column by column:
+ *
+ *   timestamp column   per frame: varint zigzag(delta-of-delta), as dvz1
+ *   position column    per position, empty if it never read OK in the chunk:
+ *     u8      flags            bit0 = value in every frame (no bitmap)
+ *                              bit1 = ambient column follows
+ *                              bit2 = held bitmap follows
+ *     bitmap  ceil(frames/8)   bit f = value in frame f (unless bit0)
+ *     bitmap  ceil(frames/8)   bit f = held in frame f (if bit2)
+ *     per value frame: varint zigzag(prox - prev_prox)
+ *     per value frame: varint zigzag(amb - prev_amb)      (if bit1)
+ *
+ * Valid frames carry a value. Held frames (SensorFrame::held_mask) repeat
+ * the predictor and carry none, unless the predictor does not hold their
+ * value (first in the chunk, or the frame that sent it was dropped).
+ *
+ * Predictors start at 0 in every column of every chunk, so any column of
+ * any chunk decodes on its own: given the chunk index (byte size of each
+ * column), a time range or a subset of positions is read without touching
+ * the rest. Arithmetic wraps like dvz1 (mod 2^32 timestamps, 2^16 values).
+ *
+ * ColumnChunkEntry is the index record; SessionSpill writes the container
+ * (header, chunks, index, trailer) and DataTransmitter streams ranges of
+ * it. Decoder spec for the backend: infrastructure/WIRE_FORMATS.md.
+ */
+
+#ifndef COLUMN_CODEC_H
+#define COLUMN_CODEC_H
+
+#include <Arduino.h>
+#include "../sensor/SensorFrame.h"
+
+// Time covered by one chunk (index granularity of a range fetch)
+#ifndef SESSION_COLUMN_CHUNK_MS
+#define SESSION_COLUMN_CHUNK_MS 500
+#endif
+
+// Worst case of one column over count frames
+#define COLUMN_CODEC_MAX_TIMESTAMP_BYTES(count) ((count) * 5)
+#define COLUMN_CODEC_MAX_POSITION_BYTES(count) (1 + 2 * (((count) + 7) / 8) + (count) * 2 * 3)
+
+// Serialized ColumnChunkEntry
+#define COLUMN_CODEC_ENTRY_BYTES (16 + 2 * NUM_SENSORS)
+
+#define COLUMN_FLAG_ALL_VALID 0x01
+#define COLUMN_FLAG_AMBIENT 0x02
+#define COLUMN_FLAG_HELD 0x04
+
+/**
+ * Index record of one chunk. Columns are stored back to back from offset:
+ * timestamps, then position 0, 1, ...
+ */
+struct ColumnChunkEntry
+{
+    uint32_t offset;                   // Container offset of the timestamp column
+    uint32_t firstUs;                  // First / last frame timestamp
+    uint32_t lastUs;
+    uint16_t frames;
+    uint16_t timestampBytes;
+    uint16_t columnBytes[NUM_SENSORS]; // 0 = position absent from the chunk
+
+    // Container offset of column (0 = timestamps, 1 + position)
+    uint32_t columnOffset(uint8_t column) const
+    {
+        uint32_t at = offset + timestampBytes;
+        for (uint8_t pos = 0; pos + 1 < column; pos++)
+            at += columnBytes[pos];
+        return column == 0 ? offset : at;
+    }
+
+    uint16_t columnSize(uint8_t column) const
+    {
+        return column == 0 ? timestampBytes : columnBytes[column - 1];
+    }
+};
+
+namespace ColumnCodec
+{
+    /**
+     * Encode the timestamp column of frames[0, count)
+     * @param out At least COLUMN_CODEC_MAX_TIMESTAMP_BYTES(count)
+     * @return Bytes written
+     */
+    size_t encodeTimestamps(const SensorFrame *frames, size_t count, uint8_t *out);
+
+    /**
+     * Encode one position's column of frames[0, count)
+     * @param out At least COLUMN_CODEC_MAX_POSITION_BYTES(count)
+     * @return Bytes written, 0 if the position is valid or held in no frame
+     */
+    size_t encodePosition(const SensorFrame *frames, size_t count, uint8_t position, uint8_t *out);
+
+    /**
+     * Decode a timestamp column into frames[0, count): sets timestamp_us and
+     * clears everything else
+     * @return false if the column is truncated or has bytes left over
+     */
+    bool decodeTimestamps(const uint8_t *in, size_t length, SensorFrame *frames, size_t count);
+
+    /**
+     * Decode one position's column into frames[0, count) (after
+     * decodeTimestamps); an empty column leaves the position invalid, held
+     * frames repeat the predictor
+     */
+    bool decodePosition(const uint8_t *in, size_t length, uint8_t position, SensorFrame *frames, size_t count);
+
+    // Little-endian index record (COLUMN_CODEC_ENTRY_BYTES)
+    void packEntry(const ColumnChunkEntry &entry, uint8_t *out);
+    void unpackEntry(const uint8_t *in, ColumnChunkEntry &entry);
+}
+
+#endif
@@ -1,11 +1,59 @@
 #include "DataTransmitter.h"
 #include "../memory/PSRAMAllocator.h"
 #include "../calibration/CalibrationData.h"
+#include "FrameCodec.h"
+#include "ColumnCodec.h"
+#include "../session/SessionSpill.h"
+#include "../diagnostics/CycleProfiler.h"
+#include "../network/TimeSync.h"
 #include "mbedtls/base64.h"
 
-DataTransmitter::DataTransmitter(MQTTManager *mqtt) : mqttManager(mqtt)
+DataTransmitter::DataTransmitter(MQTTManager *mqtt) : mqttManager(mqtt), messageDoc(JSON_DOC_CAPACITY)
 {
-    // Constructor
+    if (messageDoc.capacity() == 0)
+    {
+        Serial.println("ERROR: DataTransmitter JSON document allocation failed");
+    }
+    try
+    {
+        jsonText.resize(JSON_TEXT_CAPACITY);
+    }
+    catch (const std::bad_alloc &)
+    {
+        Serial.println("ERROR: DataTransmitter JSON buffer allocation failed");
+    }
+}
+
+JsonDocument &DataTransmitter::newMessage()
+{
+    messageDoc.clear();
+    return messageDoc;
+}
+
+size_t DataTransmitter::serializeMessage(const JsonDocument &doc)
+{
+    if (jsonText.empty())
+        return 0;
+
+    size_t length;
+    {
+        PROFILE_SCOPE(ProfileSpan::JSON_BUILD);
+        length = serializeJson(doc, jsonText.data(), jsonText.size());
+    }
+
+    // serializeJson() truncates silently at size - 1
+    if (length >= jsonText.size() - 1)
+    {
+        Serial.printf("ERROR: JSON message larger than %d bytes\n", jsonText.size());
+        return 0;
+    }
+    return length;
+}
+
+bool DataTransmitter::publishMessage(const JsonDocument &doc)
+{
+    size_t length = serializeMessage(doc);
+    return length > 0 && mqttManager->publishData((const uint8_t *)jsonText.data(), length);
 }
 
 // ============================================================================
@@ -14,14 +62,130 @@ DataTransmitter::DataTransmitter(MQTTManager *mqtt) : mqttManager(mqtt)
 
 bool DataTransmitter::transmitSession(SessionManager &session, const SensorConfiguration *config)
 {
+    bool binary = (config != nullptr && config->upload_format == "binary");
+
     if (session.getSessionType() == SessionType::INTERRUPT_BASED)
     {
-        return transmitInterruptSession(session, config);
+        return binary ? transmitInterruptSessionBinary(session, config)
+                      : transmitInterruptSession(session, config);
     }
     else
     {
-        return transmitProximitySession(session, config);
+        return binary ? transmitProximitySessionBinary(session, config)
+                      : transmitProximitySession(session, config);
+    }
+}
+
+size_t DataTransmitter::framesForBatch(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                       size_t offset, size_t available, size_t maxReadings,
+                                       size_t &readingCount)
+{
+    size_t n = 0;
+    readingCount = 0;
+
+    while (n < available)
+    {
+        size_t frameReadings = frames[offset + n].validCount();
+        if (n > 0 && readingCount + frameReadings > maxReadings)
+            break;
+
+        readingCount += frameReadings;
+        n++;
     }
+
+    return n;
+}
+
+// ============================================================================
+// First-batch session metadata (shared by JSON and binary formats)
+// ============================================================================
+
+void DataTransmitter::addCalibrationMetadata(JsonDocument &doc)
+{
+    JsonObject calObj = doc.createNestedObject("calibration");
+    if (!deviceCalibration.isValid())
+    {
+        calObj["valid"] = false;
+        return;
+    }
+
+    calObj["valid"] = true;
+    calObj["timestamp"] = deviceCalibration.timestamp;
+    calObj["multi_pulse"] = deviceCalibration.multi_pulse;
+    calObj["integration_time"] = deviceCalibration.integration_time;
+
+    JsonArray thresholds = calObj.createNestedArray("thresholds");
+    for (int i = 0; i < CALIBRATION_NUM_PCBS; i++)
+    {
+        JsonObject pcbCal = thresholds.createNestedObject();
+        pcbCal["pcb"] = i + 1;
+        pcbCal["baseline_max"] = deviceCalibration.pcbs[i].baseline_max;
+        pcbCal["signal_min"] = deviceCalibration.pcbs[i].signal_min;
+        pcbCal["signal_max"] = deviceCalibration.pcbs[i].signal_max;
+        pcbCal["threshold"] = deviceCalibration.pcbs[i].threshold;
+    }
+}
+
+// start_timestamp on the clock shared by all units (TimeSync), when synced:
+// a reading's shared time is start_sync_us + (timestamp - start_timestamp) mod 2^32
+void DataTransmitter::addClockMetadata(JsonDocument &doc, int64_t startSyncUs)
+{
+    if (startSyncUs == 0)
+        return;
+    doc["start_sync_us"] = startSyncUs;
+    doc["clock"] = TimeSync::sourceName(TimeSync::source());
+}
+
+void DataTransmitter::addProximityMetadata(JsonDocument &doc,
+                                           const std::vector<SensorMetadata> &sensorMetadata,
+                                           const SensorConfiguration *config)
+{
+    // Add active sensor list
+    JsonArray sensorArray = doc.createNestedArray("active_sensors");
+
+    for (const auto &sensor : sensorMetadata)
+    {
+        JsonObject sensorObj = sensorArray.createNestedObject();
+        sensorObj["pos"] = sensor.position;
+        sensorObj["pcb"] = sensor.pcb_id;
+        sensorObj["side"] = sensor.side;
+        sensorObj["name"] = sensor.name;
+        sensorObj["active"] = sensor.active;
+    }
+
+    // Add VCNL4040 configuration parameters
+    if (config != nullptr)
+    {
+        JsonObject configObj = doc.createNestedObject("vcnl4040_config");
+        configObj["sample_rate_hz"] = config->sample_rate_hz;
+        configObj["led_current"] = config->led_current;
+        configObj["integration_time"] = config->integration_time;
+        configObj["duty_cycle"] = config->duty_cycle;
+        configObj["multi_pulse"] = config->multi_pulse;
+        configObj["high_resolution"] = config->high_resolution;
+        configObj["read_ambient"] = config->read_ambient;
+        configObj["i2c_clock_khz"] = config->i2c_clock_khz;
+        configObj["actual_sample_rate_hz"] = config->actual_sample_rate_hz;
+    }
+
+    // Add calibration metadata if available
+    addCalibrationMetadata(doc);
+}
+
+void DataTransmitter::addInterruptMetadata(JsonDocument &doc, const SensorConfiguration *config)
+{
+    JsonObject intConfig = doc.createNestedObject("interrupt_config");
+    intConfig["threshold_margin"] = config->interrupt_threshold_margin;
+    intConfig["hysteresis"] = config->interrupt_hysteresis;
+    intConfig["integration_time"] = config->interrupt_integration_time;
+    intConfig["multi_pulse"] = config->interrupt_multi_pulse;
+    intConfig["persistence"] = config->interrupt_persistence;
+    intConfig["smart_persistence"] = config->interrupt_smart_persistence;
+    intConfig["mode"] = config->interrupt_mode;
+    intConfig["led_current"] = config->led_current;
+
+    // Add calibration metadata if available
+    addCalibrationMetadata(doc);
 }
 
 // ============================================================================
@@ -32,114 +196,79 @@ bool DataTransmitter::transmitBatch(const String &sessionId,
                                     const String &deviceId,
                                     unsigned long startTime,
                                     unsigned long duration,
-                                    std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings,
-                                    size_t offset,
-                                    size_t count,
+                                    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                    size_t frameOffset,
+                                    size_t frameCount,
+                                    size_t readingOffset,
                                     const std::vector<SensorMetadata> *sensorMetadata,
                                     const SensorConfiguration *config)
 {
-    // Create JSON document
-    DynamicJsonDocument doc(8192); // 8KB for batch
+    // Wire format stays one entry per sensor reading; offsets/sizes are in readings
+    size_t count = 0;
+    for (size_t f = 0; f < frameCount; f++)
+    {
+        count += frames[frameOffset + f].validCount();
+    }
+
+    JsonDocument &doc = newMessage();
 
     doc["session_id"] = sessionId;
     doc["device_id"] = deviceId;
     doc["session_type"] = "proximity";           // Explicit session type
     doc["start_timestamp"] = startTime * 1000UL; // Convert session start from ms to us (consistent with reading timestamps)
+    addClockMetadata(doc, TimeSync::toSyncUs((int64_t)startTime * 1000));
     doc["duration_ms"] = duration;
     doc["sample_rate"] = SAMPLE_RATE_HZ;
-    doc["batch_offset"] = offset;
+    doc["batch_offset"] = readingOffset;
     doc["batch_size"] = count;
     doc["timestamp_unit"] = "us"; // Signal to Lambda that timestamps are in microseconds
 
     // Add sensor metadata AND configuration (only in first batch)
-    if (offset == 0 && sensorMetadata != nullptr)
+    if (readingOffset == 0 && sensorMetadata != nullptr)
     {
-        // Add active sensor list
-        JsonArray sensorArray = doc.createNestedArray("active_sensors");
-
-        for (const auto &sensor : *sensorMetadata)
-        {
-            JsonObject sensorObj = sensorArray.createNestedObject();
-            sensorObj["pos"] = sensor.position;
-            sensorObj["pcb"] = sensor.pcb_id;
-            sensorObj["side"] = sensor.side;
-            sensorObj["name"] = sensor.name;
-            sensorObj["active"] = sensor.active;
-        }
-
-        // Add VCNL4040 configuration parameters
-        if (config != nullptr)
-        {
-            JsonObject configObj = doc.createNestedObject("vcnl4040_config");
-            configObj["sample_rate_hz"] = config->sample_rate_hz;
-            configObj["led_current"] = config->led_current;
-            configObj["integration_time"] = config->integration_time;
-            configObj["duty_cycle"] = config->duty_cycle;
-            configObj["multi_pulse"] = config->multi_pulse;
-            configObj["high_resolution"] = config->high_resolution;
-            configObj["read_ambient"] = config->read_ambient;
-            configObj["i2c_clock_khz"] = config->i2c_clock_khz;
-            configObj["actual_sample_rate_hz"] = config->actual_sample_rate_hz;
-        }
-
-        // Add calibration metadata if available
-        if (deviceCalibration.isValid())
-        {
-            JsonObject calObj = doc.createNestedObject("calibration");
-            calObj["valid"] = true;
-            calObj["timestamp"] = deviceCalibration.timestamp;
-            calObj["multi_pulse"] = deviceCalibration.multi_pulse;
-            calObj["integration_time"] = deviceCalibration.integration_time;
-
-            JsonArray thresholds = calObj.createNestedArray("thresholds");
-            for (int i = 0; i < CALIBRATION_NUM_PCBS; i++)
-            {
-                JsonObject pcbCal = thresholds.createNestedObject();
-                pcbCal["pcb"] = i + 1;
-                pcbCal["baseline_max"] = deviceCalibration.pcbs[i].baseline_max;
-                pcbCal["signal_min"] = deviceCalibration.pcbs[i].signal_min;
-                pcbCal["signal_max"] = deviceCalibration.pcbs[i].signal_max;
-                pcbCal["threshold"] = deviceCalibration.pcbs[i].threshold;
-            }
-        }
-        else
-        {
-            JsonObject calObj = doc.createNestedObject("calibration");
-            calObj["valid"] = false;
-        }
+        addProximityMetadata(doc, *sensorMetadata, config);
     }
 
     // Add readings array
     JsonArray readingsArray = doc.createNestedArray("readings");
+    SensorReading reading;
 
-    for (size_t i = 0; i < count; i++)
+    for (size_t f = 0; f < frameCount; f++)
     {
-        SensorReading &reading = readings[offset + i];
+        const SensorFrame &frame = frames[frameOffset + f];
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (!frame.isValid(pos))
+                continue;
 
-        JsonObject readingObj = readingsArray.createNestedObject();
-        readingObj["ts"] = reading.timestamp_us;
-        readingObj["pos"] = reading.position;
-        readingObj["pcb"] = reading.pcb_id;
-        readingObj["side"] = reading.side;
-        readingObj["prox"] = reading.proximity;
-        readingObj["amb"] = reading.ambient;
-    }
+            frame.toReading(pos, reading);
 
-    // Serialize to string
-    String payload;
-    size_t payloadSize = serializeJson(doc, payload);
+            JsonObject readingObj = readingsArray.createNestedObject();
+            readingObj["ts"] = reading.timestamp_us;
+            readingObj["pos"] = reading.position;
+            readingObj["pcb"] = reading.pcb_id;
+            readingObj["side"] = reading.side;
+            readingObj["prox"] = reading.proximity;
+            readingObj["amb"] = reading.ambient;
+        }
+    }
 
     // Publish via MQTT (silent on success, only log errors)
-    bool success = mqttManager->publishData(doc);
+    bool success = publishMessage(doc);
 
     if (!success)
     {
+        size_t payloadSize = measureJson(doc);
         Serial.println("ERROR: MQTT publish failed!");
         Serial.print("  Payload size: ");
         Serial.print(payloadSize);
         Serial.println(" bytes");
-        Serial.print("  First 200 chars: ");
-        Serial.println(payload.substring(0, 200));
+        if (!jsonText.empty())
+        {
+            Serial.print("  First 200 chars: ");
+            Serial.write((const uint8_t *)jsonText.data(), payloadSize < 200 ? payloadSize : 200);
+            Serial.println();
+        }
     }
     else if (activeSummary)
     {
@@ -164,9 +293,9 @@ bool DataTransmitter::transmitProximitySession(SessionManager &session, const Se
     unsigned long startTime = session.getStartTime();
     unsigned long duration = session.getDuration();
 
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings = session.getDataBuffer();
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames = session.getDataBuffer();
     const std::vector<SensorMetadata> &sensorMetadata = session.getSensorMetadata();
-    size_t totalReadings = readings.size();
+    size_t totalReadings = session.getReadingCount();
 
     Serial.print("Transmitting proximity session ");
     Serial.print(sessionId);
@@ -174,28 +303,160 @@ bool DataTransmitter::transmitProximitySession(SessionManager &session, const Se
     Serial.print(totalReadings);
     Serial.println(" readings)");
 
-    // Send in batches
-    size_t offset = 0;
-    while (offset < totalReadings)
+    // Send in batches of whole frames; a spilled session arrives in several
+    // segments, batch offsets run on across them
+    size_t readingOffset = 0;
+    session.rewindUpload();
+    while (session.nextUploadSegment())
+    {
+        size_t totalFrames = frames.size();
+        size_t offset = 0;
+        while (offset < totalFrames)
+        {
+            size_t batchReadings = 0;
+            size_t batchFrames = framesForBatch(frames, offset, totalFrames - offset, BATCH_SIZE, batchReadings);
+
+            // Pass sensor metadata and config only for first batch
+            const std::vector<SensorMetadata> *metadataPtr = (readingOffset == 0) ? &sensorMetadata : nullptr;
+            const SensorConfiguration *configPtr = (readingOffset == 0) ? config : nullptr;
+
+            if (!transmitBatch(sessionId, deviceId, startTime, duration,
+                               frames, offset, batchFrames, readingOffset, metadataPtr, configPtr))
+            {
+                Serial.println("ERROR: Failed to transmit batch");
+                return false;
+            }
+
+            offset += batchFrames;
+            readingOffset += batchReadings;
+
+            // Small delay between batches to avoid overwhelming MQTT
+            delay(100);
+        }
+    }
+
+    Serial.println("Proximity session transmission complete!");
+    return true;
+}
+
+// ============================================================================
+// Proximity Mode Transmission (binary bin9, streamed)
+// ============================================================================
+
+bool DataTransmitter::transmitBinaryBatch(const String &sessionId,
+                                          const String &deviceId,
+                                          unsigned long startTime,
+                                          unsigned long duration,
+                                          std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                          size_t frameOffset,
+                                          size_t frameCount,
+                                          size_t readingOffset,
+                                          size_t readingCount,
+                                          bool deltaEncoded,
+                                          const std::vector<SensorMetadata> *sensorMetadata,
+                                          const SensorConfiguration *config)
+{
+    // Same header fields as transmitBatch(); readings go into readings_b64
+    JsonDocument &doc = newMessage();
+
+    doc["session_id"] = sessionId;
+    doc["device_id"] = deviceId;
+    doc["session_type"] = "proximity";
+    doc["start_timestamp"] = startTime * 1000UL; // ms -> us, consistent with reading timestamps
+    addClockMetadata(doc, TimeSync::toSyncUs((int64_t)startTime * 1000));
+    doc["duration_ms"] = duration;
+    doc["sample_rate"] = SAMPLE_RATE_HZ;
+    doc["batch_offset"] = readingOffset;
+    doc["batch_size"] = readingCount;
+    doc["timestamp_unit"] = "us";
+    doc["reading_format"] = deltaEncoded ? "dvz1" : "bin9";
+    doc["reading_count"] = readingCount;
+    if (deltaEncoded)
+    {
+        doc["frame_count"] = frameCount;
+    }
+
+    if (readingOffset == 0 && sensorMetadata != nullptr)
+    {
+        addProximityMetadata(doc, *sensorMetadata, config);
+    }
+
+    if (doc.overflowed())
+    {
+        Serial.printf("ERROR: JSON header overflow! (usage=%d/4096 bytes)\n", doc.memoryUsage());
+        return false;
+    }
+
+    size_t packedSize = packedFramesSize(frames, frameOffset, frameCount, readingCount, deltaEncoded);
+    bool success = openBinaryMessage(doc, "readings_b64", packedSize, false) &&
+                   packFrames(frames, frameOffset, frameCount, deltaEncoded);
+    success = closeBinaryMessage() && success;
+
+    if (!success)
+    {
+        Serial.printf("ERROR: Binary batch publish failed at reading offset %d\n", readingOffset);
+    }
+    else if (activeSummary)
     {
-        size_t remaining = totalReadings - offset;
-        size_t batchCount = (remaining > BATCH_SIZE) ? BATCH_SIZE : remaining;
+        activeSummary->total_readings_transmitted += readingCount;
+        activeSummary->total_batches_transmitted++;
+    }
+
+    return success;
+}
 
-        // Pass sensor metadata and config only for first batch
-        const std::vector<SensorMetadata> *metadataPtr = (offset == 0) ? &sensorMetadata : nullptr;
-        const SensorConfiguration *configPtr = (offset == 0) ? config : nullptr;
+bool DataTransmitter::transmitProximitySessionBinary(SessionManager &session, const SensorConfiguration *config)
+{
+    if (!session.hasData())
+    {
+        Serial.println("No data to transmit");
+        return false;
+    }
 
-        if (!transmitBatch(sessionId, deviceId, startTime, duration,
-                           readings, offset, batchCount, metadataPtr, configPtr))
+    String sessionId = session.getSessionId();
+    String deviceId = mqttManager->getDeviceId();
+    unsigned long startTime = session.getStartTime();
+    unsigned long duration = session.getDuration();
+
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames = session.getDataBuffer();
+    const std::vector<SensorMetadata> &sensorMetadata = session.getSensorMetadata();
+    size_t totalReadings = session.getReadingCount();
+
+    bool deltaEncoded = (config != nullptr && config->upload_format == "delta");
+
+    Serial.printf("Transmitting proximity session %s (%d readings, %s)\n",
+                  sessionId.c_str(), totalReadings, deltaEncoded ? "dvz1" : "bin9");
+
+    size_t readingOffset = 0;
+    session.rewindUpload();
+    while (session.nextUploadSegment())
+    {
+        size_t totalFrames = frames.size();
+        size_t offset = 0;
+        while (offset < totalFrames)
         {
-            Serial.println("ERROR: Failed to transmit batch");
-            return false;
-        }
+            size_t batchReadings = 0;
+            size_t batchFrames = framesForBatch(frames, offset, totalFrames - offset, BINARY_BATCH_SIZE, batchReadings);
 
-        offset += batchCount;
+            const std::vector<SensorMetadata> *metadataPtr = (readingOffset == 0) ? &sensorMetadata : nullptr;
+            const SensorConfiguration *configPtr = (readingOffset == 0) ? config : nullptr;
 
-        // Small delay between batches to avoid overwhelming MQTT
-        delay(100);
+            if (readingOffset > 0)
+            {
+                delay(BINARY_BATCH_DELAY);
+            }
+
+            if (!transmitBinaryBatch(sessionId, deviceId, startTime, duration, frames,
+                                     offset, batchFrames, readingOffset, batchReadings,
+                                     deltaEncoded, metadataPtr, configPtr))
+            {
+                Serial.println("ERROR: Failed to transmit binary batch");
+                return false;
+            }
+
+            offset += batchFrames;
+            readingOffset += batchReadings;
+        }
     }
 
     Serial.println("Proximity session transmission complete!");
@@ -210,14 +471,13 @@ bool DataTransmitter::transmitInterruptBatch(const String &sessionId,
                                              const String &deviceId,
                                              unsigned long startTime,
                                              unsigned long duration,
-                                             const std::vector<InterruptEvent> &events,
+                                             const InterruptEventBuffer &events,
                                              size_t offset,
                                              size_t count,
                                              bool isFirstBatch,
                                              const SensorConfiguration *config)
 {
-    // Create JSON document
-    DynamicJsonDocument doc(8192);
+    JsonDocument &doc = newMessage();
 
     doc["session_id"] = sessionId;
     doc["device_id"] = deviceId;
@@ -231,41 +491,7 @@ bool DataTransmitter::transmitInterruptBatch(const String &sessionId,
     // Uses calibration-based approach - thresholds are relative to auto-calibrated baseline
     if (isFirstBatch && config != nullptr)
     {
-        JsonObject intConfig = doc.createNestedObject("interrupt_config");
-        intConfig["threshold_margin"] = config->interrupt_threshold_margin;
-        intConfig["hysteresis"] = config->interrupt_hysteresis;
-        intConfig["integration_time"] = config->interrupt_integration_time;
-        intConfig["multi_pulse"] = config->interrupt_multi_pulse;
-        intConfig["persistence"] = config->interrupt_persistence;
-        intConfig["smart_persistence"] = config->interrupt_smart_persistence;
-        intConfig["mode"] = config->interrupt_mode;
-        intConfig["led_current"] = config->led_current;
-
-        // Add calibration metadata if available
-        if (deviceCalibration.isValid())
-        {
-            JsonObject calObj = doc.createNestedObject("calibration");
-            calObj["valid"] = true;
-            calObj["timestamp"] = deviceCalibration.timestamp;
-            calObj["multi_pulse"] = deviceCalibration.multi_pulse;
-            calObj["integration_time"] = deviceCalibration.integration_time;
-
-            JsonArray thresholds = calObj.createNestedArray("thresholds");
-            for (int i = 0; i < CALIBRATION_NUM_PCBS; i++)
-            {
-                JsonObject pcbCal = thresholds.createNestedObject();
-                pcbCal["pcb"] = i + 1;
-                pcbCal["baseline_max"] = deviceCalibration.pcbs[i].baseline_max;
-                pcbCal["signal_min"] = deviceCalibration.pcbs[i].signal_min;
-                pcbCal["signal_max"] = deviceCalibration.pcbs[i].signal_max;
-                pcbCal["threshold"] = deviceCalibration.pcbs[i].threshold;
-            }
-        }
-        else
-        {
-            JsonObject calObj = doc.createNestedObject("calibration");
-            calObj["valid"] = false;
-        }
+        addInterruptMetadata(doc, config);
     }
 
     // Add events array
@@ -295,20 +521,17 @@ bool DataTransmitter::transmitInterruptBatch(const String &sessionId,
         }
 
         evtObj["flags"] = evt.rawFlags;
+        evtObj["prox"] = evt.proximity;
     }
 
-    // Serialize to string for debugging
-    String payload;
-    size_t payloadSize = serializeJson(doc, payload);
-
     // Publish via MQTT
-    bool success = mqttManager->publishData(doc);
+    bool success = publishMessage(doc);
 
     if (!success)
     {
         Serial.println("ERROR: MQTT publish failed for interrupt batch!");
         Serial.print("  Payload size: ");
-        Serial.print(payloadSize);
+        Serial.print(measureJson(doc));
         Serial.println(" bytes");
     }
     else
@@ -332,7 +555,7 @@ bool DataTransmitter::transmitInterruptSession(SessionManager &session, const Se
     unsigned long startTime = session.getStartTime();
     unsigned long duration = session.getDuration();
 
-    const std::vector<InterruptEvent> &events = session.getInterruptBuffer();
+    const InterruptEventBuffer &events = session.getInterruptBuffer();
     size_t totalEvents = events.size();
 
     Serial.print("Transmitting interrupt session ");
@@ -367,12 +590,121 @@ bool DataTransmitter::transmitInterruptSession(SessionManager &session, const Se
     return true;
 }
 
+// ============================================================================
+// Interrupt Mode Transmission (binary ibin10, streamed)
+// ============================================================================
+
+bool DataTransmitter::transmitInterruptBinaryBatch(const String &sessionId,
+                                                   const String &deviceId,
+                                                   unsigned long startTime,
+                                                   unsigned long duration,
+                                                   const InterruptEventBuffer &events,
+                                                   size_t offset,
+                                                   size_t count,
+                                                   const SensorConfiguration *config)
+{
+    JsonDocument &doc = newMessage();
+
+    doc["session_id"] = sessionId;
+    doc["device_id"] = deviceId;
+    doc["session_type"] = "interrupt";
+    doc["start_timestamp"] = startTime;
+    doc["duration_ms"] = duration;
+    doc["batch_offset"] = offset;
+    doc["batch_size"] = count;
+    doc["event_format"] = "ibin10";
+    doc["event_count"] = count;
+
+    if (offset == 0 && config != nullptr)
+    {
+        addInterruptMetadata(doc, config);
+    }
+
+    if (doc.overflowed())
+    {
+        Serial.printf("ERROR: JSON header overflow! (usage=%d/4096 bytes)\n", doc.memoryUsage());
+        return false;
+    }
+
+    bool success = openBinaryMessage(doc, "events_b64", count * IBIN10_EVENT_SIZE, false);
+
+    uint8_t rec[IBIN10_EVENT_SIZE];
+    for (size_t i = 0; success && i < count; i++)
+    {
+        const InterruptEvent &evt = events[offset + i];
+        memcpy(rec, &evt.timestamp_us, 4);
+        rec[4] = evt.boardId;
+        rec[5] = evt.sensorId;
+        rec[6] = (uint8_t)evt.type;
+        rec[7] = evt.rawFlags;
+        memcpy(rec + 8, &evt.proximity, 2);
+        success = appendPacked(rec, IBIN10_EVENT_SIZE);
+    }
+
+    success = closeBinaryMessage() && success;
+
+    if (!success)
+    {
+        Serial.printf("ERROR: Binary interrupt batch publish failed at offset %d\n", offset);
+    }
+    else
+    {
+        Serial.printf("  Sent binary interrupt batch: offset=%d, count=%d\n", offset, count);
+    }
+
+    return success;
+}
+
+bool DataTransmitter::transmitInterruptSessionBinary(SessionManager &session, const SensorConfiguration *config)
+{
+    if (!session.hasData())
+    {
+        Serial.println("No interrupt events to transmit");
+        return false;
+    }
+
+    String sessionId = session.getSessionId();
+    String deviceId = mqttManager->getDeviceId();
+    unsigned long startTime = session.getStartTime();
+    unsigned long duration = session.getDuration();
+
+    const InterruptEventBuffer &events = session.getInterruptBuffer();
+    size_t totalEvents = events.size();
+
+    Serial.printf("Transmitting interrupt session %s (%d events, binary)\n",
+                  sessionId.c_str(), totalEvents);
+
+    size_t offset = 0;
+    while (offset < totalEvents)
+    {
+        size_t remaining = totalEvents - offset;
+        size_t batchCount = (remaining > INT_BINARY_BATCH_SIZE) ? INT_BINARY_BATCH_SIZE : remaining;
+
+        if (!transmitInterruptBinaryBatch(sessionId, deviceId, startTime, duration,
+                                          events, offset, batchCount, config))
+        {
+            Serial.println("ERROR: Failed to transmit binary interrupt batch");
+            return false;
+        }
+
+        offset += batchCount;
+
+        if (offset < totalEvents)
+        {
+            delay(BINARY_BATCH_DELAY);
+        }
+    }
+
+    Serial.println("Interrupt session transmission complete!");
+    return true;
+}
+
 // ============================================================================
 // Live Debug Capture Transmission
 // ============================================================================
 
 String DataTransmitter::transmitLiveDebugCapture(
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings,
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
     size_t startIdx,
     size_t count,
     const char *captureReason,
@@ -398,36 +730,45 @@ String DataTransmitter::transmitLiveDebugCapture(
     }
     String sessionId = deviceSuffix + "_" + String(millis());
 
-    // Calculate timing from the readings themselves (timestamps are in microseconds)
-    unsigned long startTime = readings[startIdx].timestamp_us;
-    unsigned long endTime = readings[startIdx + count - 1].timestamp_us;
+    // Calculate timing from the frames themselves (timestamps are in microseconds)
+    unsigned long startTime = frames[startIdx].timestamp_us;
+    unsigned long endTime = frames[startIdx + count - 1].timestamp_us;
     unsigned long durationUs = endTime - startTime;
     unsigned long durationMs = durationUs / 1000;
 
+    size_t totalReadings = 0;
+    for (size_t f = 0; f < count; f++)
+    {
+        totalReadings += frames[startIdx + f].validCount();
+    }
+
     Serial.printf("Live Debug capture: reason=%s, readings=%d, duration=%lums\n",
-                  captureReason, count, durationMs);
+                  captureReason, totalReadings, durationMs);
 
-    // Send in batches using Live Debug batch settings
+    // Send in batches of whole frames using Live Debug batch settings
     size_t offset = 0;
+    size_t readingOffset = 0;
     while (offset < count)
     {
-        size_t remaining = count - offset;
-        size_t batchCount = (remaining > LIVE_DEBUG_BATCH_SIZE) ? LIVE_DEBUG_BATCH_SIZE : remaining;
+        size_t batchCount = 0;
+        size_t batchFrames = framesForBatch(frames, startIdx + offset, count - offset,
+                                            LIVE_DEBUG_BATCH_SIZE, batchCount);
 
-        // Create JSON document — 32KB to comfortably fit 200 readings
+        // JSON_DOC_CAPACITY (32KB) comfortably fits 200 readings
         // At ~80 bytes per reading in ArduinoJson memory, 200 readings needs ~16KB+
         // Previous 16KB buffer silently truncated readings via ArduinoJson overflow
-        DynamicJsonDocument doc(32768);
+        JsonDocument &doc = newMessage();
 
         doc["session_id"] = sessionId;
         doc["device_id"] = deviceId;
         doc["session_type"] = "proximity";
         doc["mode"] = "live_debug";
         doc["start_timestamp"] = startTime; // Microseconds (first reading timestamp)
+        addClockMetadata(doc, TimeSync::microsToSyncUs(startTime));
         doc["duration_ms"] = durationMs;
         doc["timestamp_unit"] = "us"; // Signal to Lambda that timestamps are in microseconds
         doc["sample_rate"] = SAMPLE_RATE_HZ;
-        doc["batch_offset"] = offset;
+        doc["batch_offset"] = readingOffset;
         doc["batch_size"] = batchCount;
 
         // First batch: include capture metadata and config
@@ -480,17 +821,25 @@ String DataTransmitter::transmitLiveDebugCapture(
 
         // Add readings array
         JsonArray readingsArray = doc.createNestedArray("readings");
-        for (size_t i = 0; i < batchCount; i++)
+        SensorReading reading;
+        for (size_t f = 0; f < batchFrames; f++)
         {
-            SensorReading &reading = readings[startIdx + offset + i];
-
-            JsonObject readingObj = readingsArray.createNestedObject();
-            readingObj["ts"] = reading.timestamp_us;
-            readingObj["pos"] = reading.position;
-            readingObj["pcb"] = reading.pcb_id;
-            readingObj["side"] = reading.side;
-            readingObj["prox"] = reading.proximity;
-            readingObj["amb"] = reading.ambient;
+            const SensorFrame &frame = frames[startIdx + offset + f];
+            for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+            {
+                if (!frame.isValid(pos))
+                    continue;
+
+                frame.toReading(pos, reading);
+
+                JsonObject readingObj = readingsArray.createNestedObject();
+                readingObj["ts"] = reading.timestamp_us;
+                readingObj["pos"] = reading.position;
+                readingObj["pcb"] = reading.pcb_id;
+                readingObj["side"] = reading.side;
+                readingObj["prox"] = reading.proximity;
+                readingObj["amb"] = reading.ambient;
+            }
         }
 
         // Check for ArduinoJson buffer overflow (silent data truncation)
@@ -498,16 +847,14 @@ String DataTransmitter::transmitLiveDebugCapture(
         if (doc.overflowed())
         {
             Serial.printf("WARNING: ArduinoJson overflow! Wanted %d readings, only %d fit (doc: %d/%d bytes)\n",
-                          batchCount, actualReadingsInDoc, doc.memoryUsage(), 32768);
+                          batchCount, actualReadingsInDoc, doc.memoryUsage(), doc.capacity());
         }
 
         // Publish via MQTT
-        bool success = mqttManager->publishData(doc);
+        bool success = publishMessage(doc);
         if (!success)
         {
-            String payload;
-            size_t payloadSize = serializeJson(doc, payload);
-            Serial.printf("ERROR: Live Debug MQTT publish failed! Size: %d bytes\n", payloadSize);
+            Serial.printf("ERROR: Live Debug MQTT publish failed! Size: %d bytes\n", measureJson(doc));
             return "";
         }
 
@@ -518,7 +865,8 @@ String DataTransmitter::transmitLiveDebugCapture(
             activeSummary->total_batches_transmitted++;
         }
 
-        offset += batchCount;
+        offset += batchFrames;
+        readingOffset += batchCount;
 
         // Short delay between batches
         if (offset < count)
@@ -527,9 +875,9 @@ String DataTransmitter::transmitLiveDebugCapture(
         }
     }
 
-    uint32_t actualTransmitted = activeSummary ? activeSummary->total_readings_transmitted : count;
+    uint32_t actualTransmitted = activeSummary ? activeSummary->total_readings_transmitted : totalReadings;
     Serial.printf("Live Debug capture transmitted: session=%s, %d/%d readings in %d batches\n",
-                  sessionId.c_str(), actualTransmitted, count,
+                  sessionId.c_str(), actualTransmitted, totalReadings,
                   activeSummary ? activeSummary->total_batches_transmitted : 0);
     return sessionId;
 }
@@ -539,7 +887,7 @@ String DataTransmitter::transmitLiveDebugCapture(
 // ============================================================================
 
 String DataTransmitter::transmitLiveDebugCaptureBinary(
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings,
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
     size_t startIdx,
     size_t count,
     const char *captureReason,
@@ -565,57 +913,25 @@ String DataTransmitter::transmitLiveDebugCaptureBinary(
     }
     String sessionId = deviceSuffix + "_" + String(millis());
 
-    // Calculate timing from the readings themselves (timestamps are in microseconds)
-    unsigned long startTime = readings[startIdx].timestamp_us;
-    unsigned long endTime = readings[startIdx + count - 1].timestamp_us;
+    // Calculate timing from the frames themselves (timestamps are in microseconds)
+    unsigned long startTime = frames[startIdx].timestamp_us;
+    unsigned long endTime = frames[startIdx + count - 1].timestamp_us;
     unsigned long durationUs = endTime - startTime;
     unsigned long durationMs = durationUs / 1000;
 
-    Serial.printf("Live Debug Binary: reason=%s, readings=%d, duration=%lums\n",
-                  captureReason, count, durationMs);
-
-    // 1. Pack readings into binary buffer (9 bytes per reading, little-endian)
-    size_t binarySize = count * 9;
-    uint8_t *binaryBuf = (uint8_t *)ps_malloc(binarySize);
-    if (!binaryBuf)
-    {
-        Serial.printf("ERROR: Failed to allocate %d bytes in PSRAM for binary buffer\n", binarySize);
-        return "";
-    }
-
-    for (size_t i = 0; i < count; i++)
+    size_t readingCount = 0;
+    for (size_t f = 0; f < count; f++)
     {
-        SensorReading &r = readings[startIdx + i];
-        size_t off = i * 9;
-        memcpy(binaryBuf + off, &r.timestamp_us, 4);
-        binaryBuf[off + 4] = r.position;
-        memcpy(binaryBuf + off + 5, &r.proximity, 2);
-        memcpy(binaryBuf + off + 7, &r.ambient, 2);
+        readingCount += frames[startIdx + f].validCount();
     }
 
-    // 2. Base64-encode
-    size_t base64Len = 0;
-    mbedtls_base64_encode(NULL, 0, &base64Len, binaryBuf, binarySize);
-
-    unsigned char *base64Buf = (unsigned char *)ps_malloc(base64Len + 1);
-    if (!base64Buf)
-    {
-        Serial.printf("ERROR: Failed to allocate %d bytes in PSRAM for base64 buffer\n", base64Len + 1);
-        free(binaryBuf);
-        return "";
-    }
-
-    size_t written = 0;
-    mbedtls_base64_encode(base64Buf, base64Len + 1, &written, binaryBuf, binarySize);
-    base64Buf[written] = '\0';
-    free(binaryBuf);
-
-    Serial.printf("Live Debug Binary: packed %d bytes -> %d bytes base64\n", binarySize, written);
+    Serial.printf("Live Debug Binary: reason=%s, readings=%d, duration=%lums\n",
+                  captureReason, readingCount, durationMs);
 
-    // 3. Build JSON document
-    // ArduinoJson stores char* by reference (zero-copy), so the doc only needs
-    // memory for the JSON structure itself, not the base64 string content.
-    DynamicJsonDocument doc(8192);
+    // 1. Build the JSON header: everything except the packed readings.
+    // Readings are never materialized as one buffer - they are packed and
+    // (optionally) base64-encoded chunk by chunk while streaming (step 2).
+    JsonDocument &doc = newMessage();
 
     // Session metadata
     doc["session_id"] = sessionId;
@@ -623,6 +939,7 @@ String DataTransmitter::transmitLiveDebugCaptureBinary(
     doc["session_type"] = "proximity";
     doc["mode"] = "live_debug";
     doc["start_timestamp"] = startTime;
+    addClockMetadata(doc, TimeSync::microsToSyncUs(startTime));
     doc["duration_ms"] = durationMs;
     doc["timestamp_unit"] = "us";
     doc["sample_rate"] = SAMPLE_RATE_HZ;
@@ -635,10 +952,14 @@ String DataTransmitter::transmitLiveDebugCaptureBinary(
         doc["detection_confidence"] = detectionConfidence;
     }
 
-    // Binary reading payload
-    doc["reading_format"] = "bin9";
-    doc["reading_count"] = count;
-    doc["readings_b64"] = (const char *)base64Buf;
+    // Binary reading payload (readings_b64 is appended by the stream)
+    bool deltaEncoded = (config != nullptr && config->upload_format == "delta");
+    doc["reading_format"] = deltaEncoded ? "dvz1" : "bin9";
+    doc["reading_count"] = readingCount;
+    if (deltaEncoded)
+    {
+        doc["frame_count"] = count;
+    }
 
     // Sensor configuration
     if (config != nullptr)
@@ -682,7 +1003,7 @@ String DataTransmitter::transmitLiveDebugCaptureBinary(
     summaryObj["total_cycles"] = summary.total_cycles;
     summaryObj["queue_drops"] = summary.queue_drops;
     summaryObj["buffer_drops"] = summary.buffer_drops;
-    summaryObj["total_readings_transmitted"] = count;
+    summaryObj["total_readings_transmitted"] = readingCount;
     summaryObj["total_batches_transmitted"] = 1;
     summaryObj["measured_cycle_rate_hz"] = summary.measured_cycle_rate_hz;
     summaryObj["duration_ms"] = summary.duration_ms;
@@ -699,14 +1020,18 @@ String DataTransmitter::transmitLiveDebugCaptureBinary(
 
     if (doc.overflowed())
     {
-        Serial.printf("ERROR: JSON doc overflow! (usage=%d/8192 bytes)\n", doc.memoryUsage());
-        free(base64Buf);
+        Serial.printf("ERROR: JSON doc overflow! (usage=%d/%d bytes)\n", doc.memoryUsage(), doc.capacity());
         return "";
     }
 
-    // 4. Publish via streaming API (payload exceeds the 32KB PubSubClient buffer)
-    bool success = mqttManager->publishDataStreaming(doc);
-    free(base64Buf);
+    size_t binarySize = packedFramesSize(frames, startIdx, count, readingCount, deltaEncoded);
+    Serial.printf("Live Debug Binary: %d bytes packed (%s, %s)\n", binarySize,
+                  deltaEncoded ? "dvz1" : "bin9", LIVE_DEBUG_RAW_BINARY ? "raw" : "base64");
+
+    // 2. Stream header, readings and trailer straight to the socket
+    bool success = openBinaryMessage(doc, "readings_b64", binarySize, LIVE_DEBUG_RAW_BINARY) &&
+                   packFrames(frames, startIdx, count, deltaEncoded);
+    success = closeBinaryMessage() && success;
 
     if (!success)
     {
@@ -715,10 +1040,295 @@ String DataTransmitter::transmitLiveDebugCaptureBinary(
     }
 
     Serial.printf("Live Debug Binary: session=%s, %d readings in 1 message\n",
-                  sessionId.c_str(), count);
+                  sessionId.c_str(), readingCount);
     return sessionId;
 }
 
+// ============================================================================
+// Range fetch (col1 chunks from the kept spill container)
+// ============================================================================
+
+bool DataTransmitter::transmitRange(SessionSpill &spill, const String &fetchId,
+                                    uint32_t fromMs, uint32_t toMs, SensorMask positions)
+{
+    const SessionSpill::Index &index = spill.getIndex();
+    uint32_t startUs = spill.getStartMs() * 1000UL;
+    uint8_t selected = 0;
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if (positions & (1 << pos))
+            selected++;
+    }
+
+    // Whole chunks: a chunk overlapping either end is sent complete
+    size_t first = 0;
+    while (first < index.size() && (int32_t)(index[first].lastUs - startUs) < (int32_t)(fromMs * 1000))
+        first++;
+    size_t end = first;
+    while (end < index.size() && (int32_t)(index[end].firstUs - startUs) <= (int32_t)(toMs * 1000))
+        end++;
+
+    Serial.printf("Range fetch %s: chunks %d-%d of %d\n", fetchId.c_str(), first, end, index.size());
+
+    const size_t recordHeaderBytes = 4 + 2 * selected;
+    uint8_t slice[STREAM_CHUNK_SIZE];
+    size_t chunk = first;
+    uint16_t part = 0;
+    do
+    {
+        // Chunks for one message: at least one, then up to RANGE_BATCH_BYTES
+        size_t batchEnd = chunk;
+        size_t rawSize = 0;
+        uint32_t frames = 0;
+        while (batchEnd < end)
+        {
+            size_t bytes = recordHeaderBytes + index[batchEnd].timestampBytes;
+            for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+            {
+                if (positions & (1 << pos))
+                    bytes += index[batchEnd].columnBytes[pos];
+            }
+            if (batchEnd > chunk && rawSize + bytes > RANGE_BATCH_BYTES)
+                break;
+            rawSize += bytes;
+            frames += index[batchEnd].frames;
+            batchEnd++;
+        }
+
+        if (part > 0)
+        {
+            delay(BINARY_BATCH_DELAY);
+        }
+
+        JsonDocument &doc = newMessage();
+        doc["type"] = "session_range";
+        doc["session_id"] = spill.getSessionId();
+        doc["device_id"] = mqttManager->getDeviceId();
+        doc["fetch_id"] = fetchId;
+        doc["start_timestamp"] = startUs;
+        doc["timestamp_unit"] = "us";
+        doc["reading_format"] = "col1";
+        doc["positions"] = positions;
+        doc["part"] = part;
+        doc["last"] = batchEnd == end;
+        doc["chunk_count"] = batchEnd - chunk;
+        doc["frame_count"] = frames;
+
+        bool success = openBinaryMessage(doc, "readings_b64", rawSize, false);
+        for (; success && chunk < batchEnd; chunk++)
+        {
+            const ColumnChunkEntry &entry = index[chunk];
+
+            // u16 frames, u16 timestamp bytes, u16 bytes per selected position
+            uint8_t header[4 + 2 * NUM_SENSORS];
+            memcpy(header, &entry.frames, 2);
+            memcpy(header + 2, &entry.timestampBytes, 2);
+            size_t n = 4;
+            for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+            {
+                if (!(positions & (1 << pos)))
+                    continue;
+                memcpy(header + n, &entry.columnBytes[pos], 2);
+                n += 2;
+            }
+            success = appendPacked(header, n);
+
+            for (uint8_t column = 0; success && column <= NUM_SENSORS; column++)
+            {
+                if (column > 0 && !(positions & (1 << (column - 1))))
+                    continue;
+                size_t size = entry.columnSize(column);
+                for (size_t at = 0; success && at < size; at += STREAM_CHUNK_SIZE)
+                {
+                    size_t length = size - at < STREAM_CHUNK_SIZE ? size - at : STREAM_CHUNK_SIZE;
+                    success = spill.readColumn(chunk, column, at, slice, length) &&
+                              appendPacked(slice, length);
+                }
+            }
+        }
+        success = closeBinaryMessage() && success;
+
+        if (!success)
+        {
+            Serial.printf("ERROR: Range fetch %s failed at chunk %d\n", fetchId.c_str(), chunk);
+            return false;
+        }
+        part++;
+    } while (chunk < end);
+
+    return true;
+}
+
+// ============================================================================
+// Binary message streaming
+// ============================================================================
+
+bool DataTransmitter::openBinaryMessage(const JsonDocument &doc, const char *field, size_t rawSize, bool rawTopic)
+{
+    streamUsed = 0;
+    streamBase64 = !rawTopic;
+    streamOk = false;
+
+    size_t headerLength = serializeMessage(doc);
+    if (headerLength == 0)
+        return false;
+    const uint8_t *header = (const uint8_t *)jsonText.data();
+
+    char fieldOpen[40];
+    size_t fieldOpenLength = snprintf(fieldOpen, sizeof(fieldOpen), ",\"%s\":\"", field);
+    size_t payloadLength;
+    if (rawTopic)
+    {
+        // [u32 header length][header JSON][raw records]
+        payloadLength = 4 + headerLength + rawSize;
+    }
+    else
+    {
+        // header without its closing '}' + ,"<field>":"<base64>"}
+        payloadLength = (headerLength - 1) + fieldOpenLength + ((rawSize + 2) / 3) * 4 + 2;
+    }
+
+    if (!mqttManager->beginDataStream(payloadLength, rawTopic))
+        return false;
+
+    if (rawTopic)
+    {
+        uint32_t headerLength32 = headerLength;
+        streamOk = mqttManager->writeDataStream((const uint8_t *)&headerLength32, 4) &&
+                   mqttManager->writeDataStream(header, headerLength);
+    }
+    else
+    {
+        streamOk = mqttManager->writeDataStream(header, headerLength - 1) &&
+                   mqttManager->writeDataStream((const uint8_t *)fieldOpen, fieldOpenLength);
+    }
+
+    return streamOk;
+}
+
+bool DataTransmitter::appendPacked(const uint8_t *record, size_t length)
+{
+    if (!streamOk)
+        return false;
+
+    if (length > STREAM_CHUNK_SIZE)
+    {
+        Serial.printf("ERROR: %d-byte record does not fit the stream chunk\n", length);
+        streamOk = false;
+        return false;
+    }
+
+    // Variable-length (dvz1) records may not fill the chunk exactly
+    if (streamUsed + length > STREAM_CHUNK_SIZE && !flushPacked(false))
+        return false;
+
+    memcpy(streamRaw + streamUsed, record, length);
+    streamUsed += length;
+
+    if (streamUsed == STREAM_CHUNK_SIZE)
+        return flushPacked(false);
+
+    return true;
+}
+
+bool DataTransmitter::flushPacked(bool final)
+{
+    if (!streamOk)
+        return false;
+    if (streamUsed == 0)
+        return true;
+
+    if (!streamBase64)
+    {
+        streamOk = mqttManager->writeDataStream(streamRaw, streamUsed);
+        streamUsed = 0;
+        return streamOk;
+    }
+
+    // Only the final flush may emit '=' padding: mid-stream, encode whole
+    // 3-byte groups and carry the 0-2 byte remainder into the next chunk
+    size_t rawLen = final ? streamUsed : streamUsed - (streamUsed % 3);
+    if (rawLen == 0)
+        return true;
+
+    size_t encodedLen = 0;
+    if (mbedtls_base64_encode(streamB64, sizeof(streamB64), &encodedLen, streamRaw, rawLen) != 0)
+    {
+        Serial.println("ERROR: base64 encode of stream chunk failed");
+        streamOk = false;
+        return false;
+    }
+
+    streamUsed -= rawLen;
+    memmove(streamRaw, streamRaw + rawLen, streamUsed);
+
+    streamOk = mqttManager->writeDataStream(streamB64, encodedLen);
+    return streamOk;
+}
+
+bool DataTransmitter::closeBinaryMessage()
+{
+    bool ok = flushPacked(true);
+    if (ok && streamBase64)
+    {
+        ok = mqttManager->writeDataStream((const uint8_t *)"\"}", 2);
+    }
+
+    // Always end the stream so MQTTManager is ready for the next message
+    bool ended = mqttManager->endDataStream();
+    streamOk = false;
+    return ok && ended;
+}
+
+size_t DataTransmitter::packedFramesSize(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                         size_t offset, size_t count, size_t readingCount, bool deltaEncoded)
+{
+    return deltaEncoded ? FrameEncoder::encodedSize(frames, offset, count)
+                        : readingCount * BIN9_READING_SIZE;
+}
+
+bool DataTransmitter::packFrames(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                 size_t offset, size_t count, bool deltaEncoded)
+{
+    if (deltaEncoded)
+    {
+        // dvz1: one variable-length record per frame, predictor reset per message
+        FrameEncoder encoder;
+        uint8_t encoded[FRAME_CODEC_MAX_FRAME_BYTES];
+
+        for (size_t f = 0; f < count; f++)
+        {
+            size_t n = encoder.encode(frames[offset + f], encoded);
+            if (!appendPacked(encoded, n))
+                return false;
+        }
+        return true;
+    }
+
+    // bin9 record: 9 bytes per reading, little-endian
+    uint8_t rec[BIN9_READING_SIZE];
+
+    for (size_t f = 0; f < count; f++)
+    {
+        const SensorFrame &frame = frames[offset + f];
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (!frame.isValid(pos))
+                continue;
+
+            memcpy(rec, &frame.timestamp_us, 4);
+            rec[4] = pos;
+            memcpy(rec + 5, &frame.proximity[pos], 2);
+            memcpy(rec + 7, &frame.ambient[pos], 2);
+
+            if (!appendPacked(rec, BIN9_READING_SIZE))
+                return false;
+        }
+    }
+
+    return true;
+}
+
 // ============================================================================
 // Session Confirmation: Transmit pipeline integrity summary
 // ============================================================================
@@ -727,7 +1337,13 @@ bool DataTransmitter::transmitSessionSummary(const SessionSummary &summary,
                                              const String &sessionId,
                                              const String &deviceId)
 {
-    DynamicJsonDocument doc(4096);
+    // Room for a full adaptive rate timeline, the heap marks and the
+    // latency rows on top of the counters
+    static_assert(JSON_DOC_CAPACITY >= 4096 + SESSION_RATE_TIMELINE_MAX * JSON_ARRAY_SIZE(2) +
+                                           JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(HEAP_TAG_COUNT) +
+                                           JSON_ARRAY_SIZE(NUM_SENSORS) + LATENCY_JSON_CAPACITY,
+                  "messageDoc too small for a session summary");
+    JsonDocument &doc = newMessage();
 
     doc["type"] = "session_summary";
     doc["session_id"] = sessionId;
@@ -747,16 +1363,84 @@ bool DataTransmitter::transmitSessionSummary(const SessionSummary &summary,
     // Per-sensor arrays
     JsonArray collectedArr = summaryObj.createNestedArray("readings_collected");
     JsonArray errorsArr = summaryObj.createNestedArray("i2c_errors");
+    JsonArray repeatedArr = summaryObj.createNestedArray("repeated_readings");
+    JsonArray latencyAvgArr = summaryObj.createNestedArray("read_latency_us_avg");
+    JsonArray latencyMaxArr = summaryObj.createNestedArray("read_latency_us_max");
     for (int i = 0; i < NUM_SENSORS; i++)
     {
         collectedArr.add(summary.readings_collected[i]);
         errorsArr.add(summary.i2c_errors[i]);
+        repeatedArr.add(summary.repeated_readings[i]);
+        latencyAvgArr.add(summary.avgReadLatencyUs(i));
+        latencyMaxArr.add(summary.read_latency_us_max[i]);
+    }
+    uint32_t suppressed = 0;
+    for (int i = 0; i < NUM_SENSORS; i++)
+        suppressed += summary.suppressed_repeats[i];
+    if (suppressed > 0)
+    {
+        JsonArray suppressedArr = summaryObj.createNestedArray("suppressed_repeats");
+        for (int i = 0; i < NUM_SENSORS; i++)
+            suppressedArr.add(summary.suppressed_repeats[i]);
     }
+    summaryObj["cycle_i2c_us_avg"] = summary.avgCycleI2CUs();
+    summaryObj["cycle_i2c_us_max"] = summary.cycle_i2c_us_max;
+    summaryObj["cycle_period_target_us"] = summary.cycle_period_target_us;
+    summaryObj["cycle_period_us_min"] = summary.cycle_period_us_min;
+    summaryObj["cycle_period_us_avg"] = summary.avgCyclePeriodUs();
+    summaryObj["cycle_period_us_max"] = summary.cycle_period_us_max;
+    summaryObj["missed_ticks"] = summary.missed_ticks;
+    summaryObj["cycle_overruns"] = summary.cycle_overruns;
+    if (summary.bus_recoveries > 0 || summary.bus_recovery_failures > 0 || summary.sensor_quarantines > 0)
+    {
+        summaryObj["bus_recoveries"] = summary.bus_recoveries;
+        summaryObj["bus_recovery_failures"] = summary.bus_recovery_failures;
+        summaryObj["sensor_quarantines"] = summary.sensor_quarantines;
+        summaryObj["health_skipped_reads"] = summary.health_skipped_reads;
+    }
+    if (summary.hybrid_bursts > 0)
+    {
+        summaryObj["hybrid_bursts"] = summary.hybrid_bursts;
+        summaryObj["hybrid_burst_ms_total"] = summary.hybrid_burst_ms_total;
+    }
+    if (summary.light_sleeps > 0)
+    {
+        summaryObj["light_sleeps"] = summary.light_sleeps;
+        summaryObj["light_sleep_ms_total"] = summary.light_sleep_ms_total;
+        summaryObj["sleep_wakes"] = summary.sleep_wakes;
+        summaryObj["wake_to_sample_us_avg"] = summary.avgWakeToSampleUs();
+        summaryObj["wake_to_sample_us_max"] = summary.wake_to_sample_us_max;
+    }
+    if (summary.rate_timeline_count > 0)
+    {
+        summaryObj["rate_switches"] = summary.rate_switches;
+        summaryObj["idle_rate_ms_total"] = summary.idle_rate_ms_total;
+
+        // [offset_ms, rate_hz] rows
+        JsonArray timelineArr = summaryObj.createNestedArray("rate_timeline");
+        for (int i = 0; i < summary.rate_timeline_count; i++)
+        {
+            JsonArray row = timelineArr.createNestedArray();
+            row.add(summary.rate_timeline[i].offset_ms);
+            row.add(summary.rate_timeline[i].rate_hz);
+        }
+    }
+
+    JsonObject heapObj = summaryObj.createNestedObject("heap");
+    heapObj["min_free"] = summary.heap.heap_min_free;
+    heapObj["min_largest_block"] = summary.heap.heap_min_largest_block;
+    heapObj["psram_min_free"] = summary.heap.psram_min_free;
+    heapObj["psram_min_largest_block"] = summary.heap.psram_min_largest_block;
+    JsonObject tagPeaks = heapObj.createNestedObject("tag_peak");
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++)
+        tagPeaks[HeapTracker::tagName((HeapTag)i)] = summary.heap.tag_peak[i];
+
+    LatencyTracker::toJson(summaryObj.createNestedObject("detection_latency"), summary.latency);
 
     // Retry up to 3 times
     for (int attempt = 0; attempt < 3; attempt++)
     {
-        if (mqttManager->publishData(doc))
+        if (publishMessage(doc))
         {
             Serial.printf("Session summary transmitted (attempt %d)\n", attempt + 1);
             return true;
@@ -7,26 +7,93 @@
 #include "../session/SessionManager.h"
 #include "../sensor/SensorConfiguration.h"
 #include "../memory/PSRAMAllocator.h"
+#include "../memory/PSRAMJsonDocument.h"
+
+class SessionSpill;
+
+// Send Live Debug binary captures as raw bytes on <data>/bin instead of
+// base64 inside JSON. Needs the matching IoT rule (see processData Lambda).
+#ifndef LIVE_DEBUG_RAW_BINARY
+#define LIVE_DEBUG_RAW_BINARY false
+#endif
 
 class DataTransmitter
 {
 private:
     MQTTManager *mqttManager;
-    static const size_t BATCH_SIZE = 25;                    // Proximity: 25 samples per batch
+    static const size_t BATCH_SIZE = 25;                    // Proximity: up to 25 samples per batch
     static const size_t INT_BATCH_SIZE = 100;               // Interrupt: 100 events per batch
-    static const size_t LIVE_DEBUG_BATCH_SIZE = 200;        // Live Debug: larger batches for speed
+    static const size_t LIVE_DEBUG_BATCH_SIZE = 200;        // Live Debug: larger batches for speed (samples)
     static const unsigned long LIVE_DEBUG_BATCH_DELAY = 20; // ms between Live Debug batches
+    static const size_t BINARY_BATCH_SIZE = 1000;           // Binary upload: samples per streamed message
+    static const size_t INT_BINARY_BATCH_SIZE = 500;        // Binary upload: events per streamed message
+    static const unsigned long BINARY_BATCH_DELAY = 20;     // ms between binary upload messages
+    static const size_t RANGE_BATCH_BYTES = 9216;           // Range fetch: col1 bytes per message (~1000 bin9 readings)
 
     // Session Confirmation: pointer to active session summary for transmission counters
     SessionSummary *activeSummary = nullptr;
 
+    // Every message is built in messageDoc and serialized into jsonText.
+    // Both are allocated once (PSRAM) and reused, so a batch does no heap
+    // allocation. A DataTransmitter is only used from one task.
+    static const size_t JSON_DOC_CAPACITY = 32768;  // 200-reading Live Debug batch (~80 B per reading)
+    static const size_t JSON_TEXT_CAPACITY = 32768; // Serialized message (or stream header)
+    PSRAMJsonDocument messageDoc;
+    std::vector<char, PSRAMAllocator<char, HeapTag::JSON>> jsonText;
+
+    // messageDoc, cleared for the next message
+    JsonDocument &newMessage();
+    // Serialize into jsonText; 0 if it does not fit
+    size_t serializeMessage(const JsonDocument &doc);
+    bool publishMessage(const JsonDocument &doc);
+
+    // Binary streaming: records are packed into one reusable staging chunk
+    // and flushed (base64 or raw) to the MQTT stream as it fills, instead of
+    // whole-payload packed/base64/serialized copies in PSRAM.
+    // Base64 is emitted in whole 3-byte groups; only the final flush pads.
+    static const size_t BIN9_READING_SIZE = 9; // u32 ts, u8 pos, u16 prox, u16 amb
+    static const size_t IBIN10_EVENT_SIZE = 10; // u32 ts, u8 board, u8 sensor, u8 type, u8 flags, u16 prox
+    static const size_t STREAM_CHUNK_SIZE = 1152;
+    uint8_t streamRaw[STREAM_CHUNK_SIZE];
+    unsigned char streamB64[STREAM_CHUNK_SIZE / 3 * 4 + 1];
+    size_t streamUsed = 0;
+    bool streamBase64 = true;
+    bool streamOk = false;
+
+    // Open a streamed message: the serialized doc followed by field = base64
+    // of rawSize bytes, or [u32 header length][doc][raw bytes] on <data>/bin
+    bool openBinaryMessage(const JsonDocument &doc, const char *field, size_t rawSize, bool rawTopic);
+    bool appendPacked(const uint8_t *record, size_t length);
+    bool flushPacked(bool final);
+    bool closeBinaryMessage();
+
+    // Readings as bin9 records, or dvz1 delta frames (see FrameCodec.h)
+    bool packFrames(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                    size_t offset, size_t count, bool deltaEncoded);
+    static size_t packedFramesSize(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                   size_t offset, size_t count, size_t readingCount, bool deltaEncoded);
+
+    // First-batch metadata shared by the JSON and binary session formats
+    static void addCalibrationMetadata(JsonDocument &doc);
+    static void addClockMetadata(JsonDocument &doc, int64_t startSyncUs);
+    static void addProximityMetadata(JsonDocument &doc,
+                                     const std::vector<SensorMetadata> &sensorMetadata,
+                                     const SensorConfiguration *config);
+    static void addInterruptMetadata(JsonDocument &doc, const SensorConfiguration *config);
+
+    // Number of frames from offset whose samples fit in maxReadings (at least one
+    // frame). Frames never straddle batches, so a batch can hold fewer than maxReadings.
+    static size_t framesForBatch(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                 size_t offset, size_t available, size_t maxReadings,
+                                 size_t &readingCount);
+
 public:
     DataTransmitter(MQTTManager *mqtt);
 
     // Session Confirmation: set summary pointer for transmission counting
     void setSessionSummary(SessionSummary *summary) { activeSummary = summary; }
 
-    // Transmit session based on its type
+    // Transmit session based on its type and config->upload_format
     bool transmitSession(SessionManager &session, const SensorConfiguration *config = nullptr);
 
     // Proximity mode transmission
@@ -35,28 +102,56 @@ public:
                        const String &deviceId,
                        unsigned long startTime,
                        unsigned long duration,
-                       std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings,
-                       size_t offset,
-                       size_t count,
+                       std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                       size_t frameOffset,
+                       size_t frameCount,
+                       size_t readingOffset,
                        const std::vector<SensorMetadata> *sensorMetadata,
                        const SensorConfiguration *config = nullptr);
 
+    // Proximity mode transmission, binary (bin9 or dvz1 streamed in BINARY_BATCH_SIZE messages)
+    bool transmitProximitySessionBinary(SessionManager &session, const SensorConfiguration *config = nullptr);
+    bool transmitBinaryBatch(const String &sessionId,
+                             const String &deviceId,
+                             unsigned long startTime,
+                             unsigned long duration,
+                             std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                             size_t frameOffset,
+                             size_t frameCount,
+                             size_t readingOffset,
+                             size_t readingCount,
+                             bool deltaEncoded,
+                             const std::vector<SensorMetadata> *sensorMetadata,
+                             const SensorConfiguration *config = nullptr);
+
     // Interrupt mode transmission
     bool transmitInterruptSession(SessionManager &session, const SensorConfiguration *config = nullptr);
     bool transmitInterruptBatch(const String &sessionId,
                                 const String &deviceId,
                                 unsigned long startTime,
                                 unsigned long duration,
-                                const std::vector<InterruptEvent> &events,
+                                const InterruptEventBuffer &events,
                                 size_t offset,
                                 size_t count,
                                 bool isFirstBatch,
                                 const SensorConfiguration *config = nullptr);
 
+    // Interrupt mode transmission, binary (ibin10 streamed in INT_BINARY_BATCH_SIZE messages)
+    bool transmitInterruptSessionBinary(SessionManager &session, const SensorConfiguration *config = nullptr);
+    bool transmitInterruptBinaryBatch(const String &sessionId,
+                                      const String &deviceId,
+                                      unsigned long startTime,
+                                      unsigned long duration,
+                                      const InterruptEventBuffer &events,
+                                      size_t offset,
+                                      size_t count,
+                                      const SensorConfiguration *config = nullptr);
+
     // Live Debug capture transmission (JSON batches — legacy path)
+    // startIdx/count select frames; each valid position becomes one wire reading.
     // Returns the generated session_id on success, or empty String on failure
     String transmitLiveDebugCapture(
-        std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings,
+        std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
         size_t startIdx,
         size_t count,
         const char *captureReason,
@@ -65,10 +160,11 @@ public:
         const SensorConfiguration *config = nullptr);
 
     // Live Debug capture transmission (binary-packed single message)
-    // Packs all readings as 9-byte structs, base64-encodes, and merges data + summary
-    // into a single MQTT message. No separate summary message needed.
+    // Streams the JSON header (metadata + summary) followed by the readings as
+    // 9-byte structs, base64-encoded chunk by chunk (or raw with
+    // LIVE_DEBUG_RAW_BINARY). No separate summary message needed.
     String transmitLiveDebugCaptureBinary(
-        std::vector<SensorReading, PSRAMAllocator<SensorReading>> &readings,
+        std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
         size_t startIdx,
         size_t count,
         const char *captureReason,
@@ -77,6 +173,12 @@ public:
         const SessionSummary &summary,
         const SensorConfiguration *config = nullptr);
 
+    // Range fetch: the col1 chunks of a kept spill container that overlap
+    // [fromMs, toMs] (ms since session start), only the given positions,
+    // as "session_range" messages. Call spill.openContainer() first.
+    bool transmitRange(SessionSpill &spill, const String &fetchId,
+                       uint32_t fromMs, uint32_t toMs, SensorMask positions);
+
     // Session Confirmation: transmit pipeline integrity summary as separate MQTT message
     bool transmitSessionSummary(const SessionSummary &summary,
                                 const String &sessionId,
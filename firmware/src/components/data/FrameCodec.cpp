@@ -0,0 +1,136 @@
+#include "FrameCodec.h"
+
+using namespace FrameCodec;
+
+// ============================================================================
+// Encoder
+// ============================================================================
+
+void FrameEncoder::reset()
+{
+    prevTimestamp = 0;
+    prevDelta = 0;
+    memset(prevProximity, 0, sizeof(prevProximity));
+    memset(prevAmbient, 0, sizeof(prevAmbient));
+}
+
+size_t FrameEncoder::encode(const SensorFrame &frame, uint8_t *out)
+{
+    SensorMask values = valueMask(frame, prevProximity, prevAmbient);
+    size_t n = writeVarint(values | (uint32_t)frame.held_mask << FRAME_CODEC_HELD_SHIFT, out);
+
+    uint32_t delta = frame.timestamp_us - prevTimestamp;
+    n += writeVarint(zigzag((int32_t)(delta - prevDelta)), out + n);
+    prevTimestamp = frame.timestamp_us;
+    prevDelta = delta;
+
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if (!((values >> pos) & 1))
+            continue;
+
+        n += writeVarint(zigzag((int16_t)(frame.proximity[pos] - prevProximity[pos])), out + n);
+        n += writeVarint(zigzag((int16_t)(frame.ambient[pos] - prevAmbient[pos])), out + n);
+        prevProximity[pos] = frame.proximity[pos];
+        prevAmbient[pos] = frame.ambient[pos];
+    }
+
+    return n;
+}
+
+size_t FrameEncoder::encodedSize(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                                 size_t offset, size_t count)
+{
+    // Same walk as encode(), but only counting bytes
+    uint32_t prevTs = 0;
+    uint32_t prevDt = 0;
+    uint16_t prevProx[NUM_SENSORS] = {0};
+    uint16_t prevAmb[NUM_SENSORS] = {0};
+    size_t total = 0;
+
+    for (size_t f = 0; f < count; f++)
+    {
+        const SensorFrame &frame = frames[offset + f];
+
+        SensorMask values = valueMask(frame, prevProx, prevAmb);
+        uint32_t delta = frame.timestamp_us - prevTs;
+        total += varintSize(values | (uint32_t)frame.held_mask << FRAME_CODEC_HELD_SHIFT) +
+                 varintSize(zigzag((int32_t)(delta - prevDt)));
+        prevTs = frame.timestamp_us;
+        prevDt = delta;
+
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (!((values >> pos) & 1))
+                continue;
+
+            total += varintSize(zigzag((int16_t)(frame.proximity[pos] - prevProx[pos])));
+            total += varintSize(zigzag((int16_t)(frame.ambient[pos] - prevAmb[pos])));
+            prevProx[pos] = frame.proximity[pos];
+            prevAmb[pos] = frame.ambient[pos];
+        }
+    }
+
+    return total;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+void FrameDecoder::reset()
+{
+    prevTimestamp = 0;
+    prevDelta = 0;
+    memset(prevProximity, 0, sizeof(prevProximity));
+    memset(prevAmbient, 0, sizeof(prevAmbient));
+}
+
+size_t FrameDecoder::decode(const uint8_t *in, size_t length, SensorFrame &frame)
+{
+    memset(&frame, 0, sizeof(frame));
+    const uint32_t positions = (1UL << NUM_SENSORS) - 1;
+    uint32_t v;
+    size_t n = readVarint(in, length, v);
+    if (n == 0 || (v & ~(positions | positions << FRAME_CODEC_HELD_SHIFT)))
+        return 0; // Bits beyond the last position: not a dvz1 frame
+    SensorMask values = (SensorMask)(v & positions);
+    frame.held_mask = (SensorMask)(v >> FRAME_CODEC_HELD_SHIFT);
+    frame.valid_mask = values & (SensorMask)~frame.held_mask;
+
+    size_t used = readVarint(in + n, length - n, v);
+    if (used == 0)
+        return 0;
+    n += used;
+
+    prevDelta += (uint32_t)unzigzag(v);
+    prevTimestamp += prevDelta;
+    frame.timestamp_us = prevTimestamp;
+
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if ((values >> pos) & 1)
+        {
+            used = readVarint(in + n, length - n, v);
+            if (used == 0)
+                return 0;
+            n += used;
+            prevProximity[pos] += (uint16_t)unzigzag(v);
+
+            used = readVarint(in + n, length - n, v);
+            if (used == 0)
+                return 0;
+            n += used;
+            prevAmbient[pos] += (uint16_t)unzigzag(v);
+        }
+        else if (!frame.isHeld(pos))
+        {
+            continue;
+        }
+
+        frame.proximity[pos] = prevProximity[pos];
+        frame.ambient[pos] = prevAmbient[pos];
+    }
+
+    return n;
+}
@@ -0,0 +1,167 @@
+/**
+ * FrameCodec - Delta + zigzag varint compression for SensorFrame streams
+ *
+ * Wire/storage format "dvz1". Proximity moves slowly between 1 ms cycles and
+ * the cycle timestamp advances by a near-constant step, so instead of bin9's
+ * fixed 4-byte timestamp and 2-byte values per reading, each frame stores:
+ *
+ *   varint  mask                       bit n = position n carries a value
+ *                                      (one byte up to 7 positions, as the
+ *                                      original u8 valid_mask); bit 16+n =
+ *                                      position n held (SensorFrame::held_mask)
+ *   varint  zigzag(dt - prev_dt)       timestamp delta-of-delta (us)
+ *   per bit n set, ascending position:
+ *     varint zigzag(prox - prev_prox[pos])
+ *     varint zigzag(amb  - prev_amb[pos])
+ *
+ * A held position repeats its previous value, so it normally carries none
+ * (bit 16+n alone): the decoder takes the predictor. Only when the
+ * predictor does not hold that value (first in the block, or the frame
+ * that sent it was dropped) are both bits set and the value sent.
+ * Streams without held positions never set bits 16+.
+ *
+ * All predictor state (prev timestamp, prev delta, prev values) starts at 0
+ * and is reset at the start of every message/block, so blocks decode
+ * independently. A position missing from a frame keeps its previous value
+ * as predictor. Arithmetic is modulo 2^32 (timestamps) and 2^16 (values),
+ * so wraparound round-trips exactly.
+ *
+ * Typical 6-sensor frame: ~14-20 bytes vs 54 bytes as bin9 (3-4x smaller).
+ * Decoder spec for the backend: infrastructure/WIRE_FORMATS.md.
+ *
+ * Usage:
+ *   FrameEncoder enc;
+ *   uint8_t buf[FRAME_CODEC_MAX_FRAME_BYTES];
+ *   size_t n = enc.encode(frame, buf);
+ *
+ *   FrameDecoder dec;
+ *   size_t used = dec.decode(buf, n, frameOut);   // 0 = malformed
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <Arduino.h>
+#include <vector>
+#include "../sensor/SensorFrame.h"
+#include "../memory/PSRAMAllocator.h"
+
+// Worst case: mask varint + 5-byte timestamp varint + 3-byte varint per value
+#define FRAME_CODEC_MAX_FRAME_BYTES (5 + 5 + NUM_SENSORS * 2 * 3)
+
+// Mask bit of held position n: n + FRAME_CODEC_HELD_SHIFT (16 positions max)
+#define FRAME_CODEC_HELD_SHIFT 16
+
+class FrameEncoder
+{
+public:
+    FrameEncoder() { reset(); }
+
+    // Start a new independently decodable block
+    void reset();
+
+    /**
+     * Encode one frame
+     * @param frame Frame to append
+     * @param out Destination, at least FRAME_CODEC_MAX_FRAME_BYTES
+     * @return Bytes written
+     */
+    size_t encode(const SensorFrame &frame, uint8_t *out);
+
+    /**
+     * Encoded size of frames[offset, offset+count) as one block, without
+     * writing anything (streamed messages need their length up front)
+     */
+    static size_t encodedSize(const std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &frames,
+                              size_t offset, size_t count);
+
+private:
+    uint32_t prevTimestamp;
+    uint32_t prevDelta;
+    uint16_t prevProximity[NUM_SENSORS];
+    uint16_t prevAmbient[NUM_SENSORS];
+};
+
+class FrameDecoder
+{
+public:
+    FrameDecoder() { reset(); }
+
+    void reset();
+
+    /**
+     * Decode one frame
+     * @param in Encoded bytes
+     * @param length Bytes available at in
+     * @param frame Decoded frame (invalid positions are zeroed, held ones
+     *              repeat the predictor)
+     * @return Bytes consumed, or 0 if the input is truncated/malformed
+     */
+    size_t decode(const uint8_t *in, size_t length, SensorFrame &frame);
+
+private:
+    uint32_t prevTimestamp;
+    uint32_t prevDelta;
+    uint16_t prevProximity[NUM_SENSORS];
+    uint16_t prevAmbient[NUM_SENSORS];
+};
+
+// Zigzag varint primitives (shared by encoder, decoder and size estimate)
+namespace FrameCodec
+{
+    inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    /**
+     * Positions of frame that carry a value: the valid ones, plus held ones
+     * whose value the predictors (prox, amb) do not already hold
+     */
+    inline SensorMask valueMask(const SensorFrame &frame, const uint16_t *prox, const uint16_t *amb)
+    {
+        SensorMask mask = frame.valid_mask;
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (frame.isHeld(pos) && (frame.proximity[pos] != prox[pos] || frame.ambient[pos] != amb[pos]))
+                mask |= (SensorMask)1 << pos;
+        }
+        return mask;
+    }
+
+    inline size_t varintSize(uint32_t v)
+    {
+        size_t n = 1;
+        while (v >= 0x80)
+        {
+            v >>= 7;
+            n++;
+        }
+        return n;
+    }
+
+    inline size_t writeVarint(uint32_t v, uint8_t *out)
+    {
+        size_t n = 0;
+        while (v >= 0x80)
+        {
+            out[n++] = (uint8_t)(v | 0x80);
+            v >>= 7;
+        }
+        out[n++] = (uint8_t)v;
+        return n;
+    }
+
+    // @return Bytes consumed, 0 if truncated or longer than 5 bytes
+    inline size_t readVarint(const uint8_t *in, size_t length, uint32_t &v)
+    {
+        v = 0;
+        for (size_t i = 0; i < length && i < 5; i++)
+        {
+            v |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+            if ((in[i] & 0x80) == 0)
+                return i + 1;
+        }
+        return 0;
+    }
+}
+
+#endif
@@ -0,0 +1,311 @@
+#include "DetectionTask.h"
+#include "../diagnostics/CycleProfiler.h"
+#include "../calibration/AutoCalibrator.h"
+
+DetectionTask::DetectionTask()
+{
+}
+
+bool DetectionTask::begin(DirectionDetector *heuristicDetector, MLDetector *mlDetector)
+{
+    if (task != nullptr)
+        return true;
+
+    heuristic = heuristicDetector;
+    ml = mlDetector;
+
+    resultQueue = xQueueCreate(DETECTION_RESULT_QUEUE_DEPTH, sizeof(DetectionEvent));
+    detectorMutex = xSemaphoreCreateRecursiveMutex();
+    if (resultQueue == nullptr || detectorMutex == nullptr)
+    {
+        Serial.println("ERROR: DetectionTask queue/mutex creation failed");
+        return false;
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "DetectionTask",
+        8192, // Triggered ML inference runs on this stack
+        this,
+        DETECTION_TASK_PRIORITY,
+        &task,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: DetectionTask creation failed");
+        task = nullptr;
+        return false;
+    }
+
+    Serial.println("DetectionTask started (core 1)");
+    return true;
+}
+
+void DetectionTask::setActive(bool isActive, DetectorMode detectorMode)
+{
+    DetectorMode previousMode = mode.exchange(detectorMode, std::memory_order_relaxed);
+    bool wasActiveBefore = active.exchange(isActive, std::memory_order_acq_rel);
+
+    // Called every loop() pass: only a change needs the task
+    if (task != nullptr && (isActive != wasActiveBefore || detectorMode != previousMode))
+        xTaskNotifyGive(task);
+}
+
+void DetectionTask::setEnsembleThresholds(float minConfidence, uint16_t minGapMs)
+{
+    ensembleConfidence.store(minConfidence, std::memory_order_relaxed);
+    ensembleMinGapMs.store(minGapMs, std::memory_order_relaxed);
+}
+
+void DetectionTask::stage(const DetectorSetup &setup)
+{
+    portENTER_CRITICAL(&setupLock);
+    backSetup = setup;
+    setupPending = true;
+    portEXIT_CRITICAL(&setupLock);
+
+    // No task to take it: apply now
+    if (task == nullptr)
+        applySetup(mode.load(std::memory_order_relaxed));
+    else
+        xTaskNotifyGive(task);
+}
+
+// Cycle boundary: swap in staged settings, and keep the model's inference
+// mode in step with the detector mode
+void DetectionTask::applySetup(DetectorMode feedMode)
+{
+    portENTER_CRITICAL(&setupLock);
+    bool pending = setupPending;
+    if (pending)
+        frontSetup = backSetup;
+    setupPending = false;
+    portEXIT_CRITICAL(&setupLock);
+
+    if (!pending && setupApplied && feedMode == setupMode)
+        return;
+
+    Guard guard(*this);
+    if (pending)
+    {
+        bool wasMultiTransit = heuristic->isMultiTransit();
+        heuristic->setConfig(frontSetup.config);
+        // Pipelined and single waves track different state; baselines stay
+        if (heuristic->isMultiTransit() != wasMultiTransit)
+            heuristic->reset();
+    }
+
+    MLInferenceMode mlMode = feedMode == DetectorMode::ML ? frontSetup.mlMode : MLInferenceMode::ON_DEMAND;
+    if (!ml->setInferenceMode(mlMode, frontSetup.mlStrideMs) && mlMode == MLInferenceMode::SLIDING)
+    {
+        Serial.println("WARNING: Sliding ML inference unavailable, using triggered inference");
+        ml->setInferenceMode(MLInferenceMode::TRIGGERED, frontSetup.mlStrideMs);
+    }
+    setupMode = feedMode;
+    setupApplied = true;
+}
+
+EnsembleStats DetectionTask::getEnsembleStats() const
+{
+    portENTER_CRITICAL(&statsLock);
+    EnsembleStats stats = ensembleStats;
+    portEXIT_CRITICAL(&statsLock);
+    return stats;
+}
+
+bool DetectionTask::pollResult(DetectionEvent &event)
+{
+    if (resultQueue == nullptr)
+        return false;
+    return xQueueReceive(resultQueue, &event, 0) == pdTRUE;
+}
+
+void DetectionTask::resetDetectors()
+{
+    Guard guard(*this);
+    heuristic->reset();
+    ml->reset();
+
+    // Results from before the reset are stale
+    if (resultQueue != nullptr)
+        xQueueReset(resultQueue);
+}
+
+void DetectionTask::taskFunction(void *parameter)
+{
+    static_cast<DetectionTask *>(parameter)->run();
+}
+
+void DetectionTask::run()
+{
+    const size_t FEED_BATCH = 32;
+    SensorFrame frames[FEED_BATCH];
+
+    while (true)
+    {
+        // Woken by the sensor task's push, so detection latency is the
+        // hand-off alone; frames pushed meanwhile are drained below
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DETECTION_IDLE_WAIT_MS));
+
+        DetectorMode feedMode = mode.load(std::memory_order_relaxed);
+        applySetup(feedMode);
+
+        bool isActive = active.load(std::memory_order_acquire);
+        if (!isActive)
+        {
+            frameRing.discardAll();
+            wasActive = false;
+            if (rateScheduler != nullptr)
+                rateScheduler->release();
+            continue;
+        }
+        if (!wasActive)
+        {
+            // Frames queued before activation belong to no session
+            frameRing.discardAll();
+            wasActive = true;
+            continue;
+        }
+
+        if (frameRing.empty())
+            continue;
+
+        Guard guard(*this);
+        size_t n;
+        while ((n = frameRing.popBulk(frames, FEED_BATCH)) > 0)
+        {
+            feed(frames, n, feedMode);
+        }
+
+        // The ML window has no notion of "near threshold": keep the full rate
+        if (rateScheduler != nullptr)
+        {
+            if (feedMode == DetectorMode::ML)
+                rateScheduler->release();
+            else
+                rateScheduler->update(heuristic->getActivity(), millis());
+        }
+    }
+}
+
+void DetectionTask::feed(const SensorFrame *frames, size_t count, DetectorMode feedMode)
+{
+    bool useML = feedMode != DetectorMode::HEURISTIC;
+    bool useHeuristic = feedMode != DetectorMode::ML;
+    bool feedML = useML || (DETECTION_WARM_STANDBY && ml->hasModel());
+    bool feedHeuristic = useHeuristic || DETECTION_WARM_STANDBY;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const SensorFrame &frame = frames[i];
+        bool detected;
+        {
+            PROFILE_SCOPE(ProfileSpan::DETECTOR_UPDATE);
+            if (feedML)
+                ml->addFrame(frame);
+            if (feedHeuristic)
+                heuristic->addFrame(frame);
+            detected = useHeuristic ? heuristic->hasDetection() : ml->hasDetection();
+            if (!useHeuristic && feedHeuristic && heuristic->hasDetection())
+            {
+                // Standby: drop the wave, keep the baselines
+                if (heuristic->isMultiTransit())
+                    heuristic->getResult();
+                else
+                    heuristic->reset();
+            }
+        }
+        if (autoCalibrator != nullptr && useHeuristic)
+            autoCalibrator->addFrame(frame, *heuristic);
+        framesProcessed++;
+        if (eventStream != nullptr)
+            eventStream->addFrame(frame);
+
+        // One event (or ensemble decision) per detection: the heuristic's
+        // stays pending until loop() resets the detectors, unless
+        // getResult() consumes it
+        if (!reportLatch.report(detected, !useHeuristic || heuristic->isMultiTransit()))
+            continue;
+
+        DetectionEvent event;
+        if (feedMode == DetectorMode::ENSEMBLE)
+        {
+            if (!decideEnsemble(event))
+                continue;
+        }
+        else
+        {
+            event.result = useML ? ml->getResult() : heuristic->getResult();
+            event.ml = useML;
+        }
+        event.frameTimestampUs = frame.timestamp_us;
+        event.decisionUs = micros();
+        // Once per detection, like the queued event (reportLatch above)
+        if (eventStream != nullptr)
+            eventStream->sendDetection(event.result, event.ml, event.frameTimestampUs);
+        if (xQueueSend(resultQueue, &event, 0) != pdTRUE)
+            droppedResults++;
+    }
+}
+
+bool DetectionTask::decideEnsemble(DetectionEvent &event)
+{
+    DetectionResult heuristicResult = heuristic->getResult();
+    event.result = heuristicResult;
+    event.ml = false;
+
+    bool confident = heuristicResult.direction != Direction::UNKNOWN &&
+                     heuristicResult.confidence >= ensembleConfidence.load(std::memory_order_relaxed) &&
+                     heuristicResult.comGapMs >= ensembleMinGapMs.load(std::memory_order_relaxed);
+    if (confident)
+    {
+        countEnsemble(ensembleStats.heuristic);
+        return true;
+    }
+
+    // Modules disagreed, the COM gap is short or confidence is low: ask the
+    // model about the window the wave just completed in
+    DetectionResult mlResult;
+    bool ran;
+    {
+        PROFILE_SCOPE(ProfileSpan::DETECTOR_UPDATE);
+        ran = ml->classifyWindow(mlResult);
+    }
+    if (!ran)
+    {
+        countEnsemble(ensembleStats.mlUnavailable);
+        return true;
+    }
+    if (mlResult.direction == Direction::UNKNOWN)
+    {
+        // Heuristic wave without a transit the model recognises. No event
+        // reaches loop(), so the wave state is reset here.
+        countEnsemble(ensembleStats.mlRejected);
+        heuristic->reset();
+        return false;
+    }
+
+    // Fused: the model's direction, the heuristic's wave and module fields.
+    // Agreement keeps the higher confidence of the two.
+    if (mlResult.direction == heuristicResult.direction)
+    {
+        event.result.confidence = max(heuristicResult.confidence, mlResult.confidence);
+        countEnsemble(ensembleStats.mlConfirmed);
+    }
+    else
+    {
+        event.result.direction = mlResult.direction;
+        event.result.confidence = mlResult.confidence;
+        countEnsemble(ensembleStats.mlOverruled);
+    }
+    event.ml = true;
+    return true;
+}
+
+void DetectionTask::countEnsemble(uint32_t &counter)
+{
+    portENTER_CRITICAL(&statsLock);
+    counter++;
+    portEXIT_CRITICAL(&statsLock);
+}
@@ -0,0 +1,238 @@
+#ifndef DETECTION_TASK_H
+#define DETECTION_TASK_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "DirectionDetector.h"
+#include "MLDetector.h"
+#include "../sensor/SensorManager.h"
+#include "../sensor/AdaptiveRateScheduler.h"
+#include "../network/LanEventStream.h"
+
+class AutoCalibrator;
+
+/**
+ * DetectionTask - Runs the direction detectors on their own FreeRTOS task
+ *
+ * The sensor task pushes every cycle into this task's frame ring (a tap
+ * next to the session ring), so detection no longer depends on loop()
+ * draining the session buffer — and no delay() in loop() stalls it.
+ *
+ * - Feeds the heuristic or ML detector while active (Play / Live Debug);
+ *   otherwise discards frames as they arrive
+ * - ENSEMBLE feeds both: a confident heuristic result (known direction,
+ *   confidence and COM gap at or above the ensemble thresholds) goes out
+ *   at once; an ambiguous one is resolved by MLDetector::classifyWindow()
+ *   (ML in ON_DEMAND mode) and the two are fused. getEnsembleStats()
+ *   counts which path decided
+ * - Each detection is posted to a small result queue; loop() handles the
+ *   UI/network side (LEDs, display, MQTT, captures) via pollResult()
+ * - Any other detector access from another task (reset, config, ML init)
+ *   must hold a Guard; the task holds the same mutex while feeding, so
+ *   frames simply queue in the ring meanwhile
+ * - Core 1 above loop() and the upload task, so a busy loop() cannot
+ *   delay a detection. Blocks on a task notification (one per pushed
+ *   frame, setActive() change or stage()), so it never wakes while idle
+ * - With a rate scheduler attached, reports heuristic detector activity
+ *   after every batch (ML and inactive: full rate)
+ * - With an event stream attached, each detection goes out on the LAN from
+ *   this task, ahead of the result queue (and fed frames, if enabled)
+ * - With an auto calibrator attached, it sees every frame the heuristic
+ *   detector has processed (background calibration)
+ * - Detector settings are double-buffered: stage() fills the back copy
+ *   from any task and this task swaps it in between two batches, so a
+ *   batch never sees half a config and nothing is reset for it (the
+ *   heuristic keeps its baselines, the ML detector its input grid)
+ * - With DETECTION_WARM_STANDBY the detector not in use is fed as well:
+ *   the heuristic's results are dropped, the model waits in ON_DEMAND
+ *   mode. Switching detection_mode then needs no baseline or window warm-up.
+ */
+
+#ifndef DETECTION_TASK_PRIORITY
+#define DETECTION_TASK_PRIORITY 2
+#endif
+
+// The task sleeps until a frame, setActive() or stage() notifies it; this
+// bounds the wait should a notification ever be missed
+#ifndef DETECTION_IDLE_WAIT_MS
+#define DETECTION_IDLE_WAIT_MS 100
+#endif
+
+// Detections waiting for loop(); further results are dropped (and counted)
+#ifndef DETECTION_RESULT_QUEUE_DEPTH
+#define DETECTION_RESULT_QUEUE_DEPTH 4
+#endif
+
+// Ensemble thresholds (ensemble_confidence, ensemble_min_gap_ms defaults)
+#ifndef ENSEMBLE_CONFIDENCE
+#define ENSEMBLE_CONFIDENCE 0.7f
+#endif
+#ifndef ENSEMBLE_MIN_GAP_MS
+#define ENSEMBLE_MIN_GAP_MS 10
+#endif
+
+// Feed the inactive detector too (its per-frame state only), see above
+#ifndef DETECTION_WARM_STANDBY
+#define DETECTION_WARM_STANDBY 1
+#endif
+
+enum class DetectorMode : uint8_t
+{
+    HEURISTIC,
+    ML,
+    ENSEMBLE // Heuristic first, ML for ambiguous results
+};
+
+// Which path decided each ensemble detection
+struct EnsembleStats
+{
+    uint32_t heuristic;     // Confident heuristic result, ML not run
+    uint32_t mlConfirmed;   // Ambiguous; ML agreed on the direction
+    uint32_t mlOverruled;   // Ambiguous; ML picked the direction (disagreement / unknown)
+    uint32_t mlRejected;    // Ambiguous; ML saw no transit, nothing emitted
+    uint32_t mlUnavailable; // Ambiguous; ML could not run, heuristic result emitted
+};
+
+// Settings applied together at a cycle boundary (DetectionTask::stage)
+struct DetectorSetup
+{
+    DetectorConfig config;                               // Heuristic parameters
+    MLInferenceMode mlMode = MLInferenceMode::TRIGGERED; // When ML is the detector (TRIGGERED / SLIDING)
+    uint16_t mlStrideMs = ML_SLIDING_STRIDE_MS;
+};
+
+struct DetectionEvent
+{
+    DetectionResult result;
+    bool ml;                  // Which detector produced it (ensemble: ML resolved it)
+    uint32_t frameTimestampUs; // Timestamp of the frame that completed the detection
+    uint32_t decisionUs;       // micros() when the detector returned it (LatencyTracker)
+};
+
+class DetectionTask
+{
+public:
+    DetectionTask();
+
+    /**
+     * Create the result queue, mutex and task
+     * @return false if any FreeRTOS object could not be created
+     */
+    bool begin(DirectionDetector *heuristic, MLDetector *ml);
+
+    // Ring and task to notify for SensorManager::setFrameTap() (consumer: this task)
+    SensorFrameRing *getFrameRing() { return &frameRing; }
+    TaskHandle_t getTaskHandle() const { return task; }
+
+    /**
+     * Select whether frames are fed and to which detector(s).
+     * Cheap; loop() calls it every pass. On activation, frames queued while
+     * inactive are discarded first.
+     */
+    void setActive(bool active, DetectorMode mode);
+
+    /**
+     * When a heuristic result is confident enough to skip ML (ENSEMBLE)
+     * @param minConfidence Heuristic confidence at or above this...
+     * @param minGapMs ...and a COM gap at or above this
+     */
+    void setEnsembleThresholds(float minConfidence, uint16_t minGapMs);
+
+    /**
+     * Stage detector settings (any task, never blocks). Taken at the next
+     * cycle boundary, active or not; a later stage() before then replaces
+     * this one. The model's inference mode follows the detector mode:
+     * setup.mlMode while ML is the detector, ON_DEMAND otherwise.
+     */
+    void stage(const DetectorSetup &setup);
+
+    // Adaptive sample rate input (shared with SensorManager). Set before begin().
+    void setRateScheduler(AdaptiveRateScheduler *scheduler) { rateScheduler = scheduler; }
+
+    // LAN output for detections and frames. Set before begin().
+    void setEventStream(LanEventStream *stream) { eventStream = stream; }
+
+    // Background calibration from the heuristic detector's idle readings. Set before begin().
+    void setAutoCalibrator(AutoCalibrator *calibrator) { autoCalibrator = calibrator; }
+
+    /**
+     * Take the next detection, if any (non-blocking)
+     */
+    bool pollResult(DetectionEvent &event);
+
+    /**
+     * Discard queued results and reset both detectors (keeps baselines)
+     */
+    void resetDetectors();
+
+    // Exclusive detector access for the lifetime of the guard
+    class Guard
+    {
+    public:
+        explicit Guard(DetectionTask &task) : mutex(task.detectorMutex)
+        {
+            if (mutex)
+                xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        }
+        ~Guard()
+        {
+            if (mutex)
+                xSemaphoreGiveRecursive(mutex);
+        }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        SemaphoreHandle_t mutex;
+    };
+
+    uint32_t getFramesProcessed() const { return framesProcessed; }
+    uint32_t getDroppedFrames() const { return frameRing.overflowCount(); }
+    uint32_t getDroppedResults() const { return droppedResults; }
+    EnsembleStats getEnsembleStats() const;
+
+private:
+    SensorFrameRing frameRing;
+    DirectionDetector *heuristic = nullptr;
+    MLDetector *ml = nullptr;
+    AdaptiveRateScheduler *rateScheduler = nullptr;
+    LanEventStream *eventStream = nullptr;
+    AutoCalibrator *autoCalibrator = nullptr;
+
+    TaskHandle_t task = nullptr;
+    QueueHandle_t resultQueue = nullptr;
+    SemaphoreHandle_t detectorMutex = nullptr;
+
+    std::atomic<bool> active{false};
+    std::atomic<DetectorMode> mode{DetectorMode::HEURISTIC};
+    bool wasActive = false; // Task-side copy, to discard the backlog on activation
+
+    std::atomic<float> ensembleConfidence{ENSEMBLE_CONFIDENCE};
+    std::atomic<uint16_t> ensembleMinGapMs{ENSEMBLE_MIN_GAP_MS};
+    DetectionLatch reportLatch; // The pending detection was reported (task side)
+
+    // stage() -> back copy; the task swaps it into the front one
+    DetectorSetup backSetup;
+    DetectorSetup frontSetup;
+    bool setupPending = false;
+    portMUX_TYPE setupLock = portMUX_INITIALIZER_UNLOCKED;
+    DetectorMode setupMode = DetectorMode::HEURISTIC; // Mode the ML inference mode was set for
+    bool setupApplied = false;
+    EnsembleStats ensembleStats = {};
+    mutable portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+
+    volatile uint32_t framesProcessed = 0;
+    volatile uint32_t droppedResults = 0;
+
+    static void taskFunction(void *parameter);
+    void run();
+    void applySetup(DetectorMode feedMode);
+    void feed(const SensorFrame *frames, size_t count, DetectorMode feedMode);
+    bool decideEnsemble(DetectionEvent &event);
+    void countEnsemble(uint32_t &counter);
+};
+
+#endif
@@ -2,22 +2,54 @@
 
 extern bool serialStudioEnabled;
 
-DirectionDetector::DirectionDetector() : config() {}
+template <typename Math, typename Profile>
+BasicDirectionDetector<Math, Profile>::BasicDirectionDetector() : config()
+{
+    Profile::apply(config);
+    updateFactors();
+}
 
-DirectionDetector::DirectionDetector(const DetectorConfig &cfg) : config(cfg) {}
+template <typename Math, typename Profile>
+BasicDirectionDetector<Math, Profile>::BasicDirectionDetector(const DetectorConfig &cfg) : config(cfg)
+{
+    Profile::apply(config);
+    updateFactors();
+}
 
-void DirectionDetector::addReading(const SensorReading &reading)
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::updateFactors()
 {
-    uint32_t timestampMs = reading.timestamp_us / 1000;
-    uint8_t pos = reading.position;
-    if (pos >= NUM_SENSORS)
-        return;
+    riseFactor = Math::factor(config.peakMultiplier - 1.0f);
+    exitFactor = Math::factor(config.waveExitThreshold);
+}
+
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::addFrame(const SensorFrame &frame)
+{
+    uint32_t timestampMs = frame.timestamp_us / 1000;
+    _frameUs = frame.timestamp_us;
+
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if (!frame.isValid(pos))
+            continue;
+        _sampleUs = frame.sampleUs(pos);
+        processSample(pos, frame.proximity[pos], timestampMs);
+    }
 
+    if (Profile::multiTransit(config) && _haveTransit)
+        dropLateModules();
+}
+
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::processSample(uint8_t pos, uint16_t proximity, uint32_t timestampMs)
+{
     SensorTracker &sensor = sensors[pos];
-    float value = (float)reading.proximity;
+    Value value = Math::fromCount(proximity);
+    sensor.present = true;
 
     sensor.smoothBuffer.push(value);
-    float smoothed = sensor.smoothBuffer.getSmoothedAverage(config.smoothingWindow);
+    Value smoothed = smoothedOf(sensor);
 
     // Only update baseline when sensor is idle (excludes transit waves)
     if (sensor.waveState == WaveState::IDLE)
@@ -33,7 +65,7 @@ void DirectionDetector::addReading(const SensorReading &reading)
 
             if (!serialStudioEnabled)
                 Serial.printf("[Detector] Sensor %d baseline ready (threshold=%.1f)\n",
-                              pos, sensor.threshold);
+                              pos, Math::toFloat(sensor.threshold));
         }
         else if (sensor.baselineReady &&
                  sensor.baselineUpdateCount % 50 == 0)
@@ -48,33 +80,45 @@ void DirectionDetector::addReading(const SensorReading &reading)
     }
 }
 
-void DirectionDetector::flushReading()
+template <typename Math, typename Profile>
+typename Math::Value BasicDirectionDetector<Math, Profile>::smoothedOf(const SensorTracker &sensor) const
 {
-    // Per-sensor tracking processes each reading immediately in addReading().
-    // Kept for interface compatibility with callers.
+    size_t n;
+    Sum sum = sensor.smoothBuffer.getWindowSum(Profile::smoothingWindow(config), n);
+    if (n == 0)
+        return 0;
+    // Full window of a static profile: constant divisor
+    if (Profile::IS_STATIC && n == Profile::SMOOTHING_WINDOW)
+        return Math::template average<Profile::SMOOTHING_WINDOW>(sum);
+    return ringAverage(sum, n);
 }
 
-void DirectionDetector::recalculateThreshold(SensorTracker &sensor, uint8_t position)
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::recalculateThreshold(SensorTracker &sensor, uint8_t position)
 {
-    if (_calibration != nullptr && _calibration->isValid())
+    if (Profile::calibration() && _calibration != nullptr && _calibration->isValid())
     {
         uint8_t pcbIdx = position / 2;
         if (pcbIdx < CALIBRATION_NUM_PCBS)
         {
-            sensor.threshold = (float)_calibration->pcbs[pcbIdx].threshold;
+            sensor.threshold = Math::fromCount(_calibration->pcbs[pcbIdx].threshold);
             _useCalibration = true;
             return;
         }
     }
 
     _useCalibration = false;
-    float baseMax = sensor.baselineBuffer.getMax();
-    float rise = max(baseMax * (config.peakMultiplier - 1.0f), (float)config.minRise);
-    sensor.threshold = baseMax + rise;
+    Value baseMax = sensor.baselineBuffer.getMax();
+    Value rise = max(Math::scale(baseMax, riseFactor), Math::fromCount(config.minRise));
+    sensor.threshold = Math::add(baseMax, rise);
 }
 
-void DirectionDetector::updateSensorWave(SensorTracker &sensor, float smoothed, uint32_t timestamp)
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::updateSensorWave(SensorTracker &sensor, Value smoothed, uint32_t timestamp)
 {
+    // Expire stale completed waves that didn't pair into a module detection
+    sensor.expireCompleted(timestamp, config.maxPeakGapMs);
+
     switch (sensor.waveState)
     {
     case WaveState::IDLE:
@@ -82,9 +126,11 @@ void DirectionDetector::updateSensorWave(SensorTracker &sensor, float smoothed,
         {
             sensor.waveState = WaveState::IN_WAVE;
             sensor.waveStartTime = timestamp;
+            sensor.waveStartUs = _frameUs;
             sensor.peakValue = smoothed;
             sensor.peakTime = timestamp;
-            sensor.weightedSum = smoothed * timestamp;
+            sensor.weightedSum = 0; // Offset 0 from the wave start
+            sensor.weightedSumUs = Math::weight(smoothed, _sampleUs - _frameUs);
             sensor.totalWeight = smoothed;
         }
         break;
@@ -97,11 +143,13 @@ void DirectionDetector::updateSensorWave(SensorTracker &sensor, float smoothed,
             sensor.peakTime = timestamp;
         }
 
-        sensor.weightedSum += smoothed * timestamp;
+        sensor.weightedSum += Math::weight(smoothed, timestamp - sensor.waveStartTime);
+        if (Profile::skewCompensation(config))
+            sensor.weightedSumUs += Math::weight(smoothed, _sampleUs - sensor.waveStartUs);
         sensor.totalWeight += smoothed;
 
-        float exitThreshold = max(sensor.threshold,
-                                  sensor.peakValue * config.waveExitThreshold);
+        Value exitThreshold = max(sensor.threshold,
+                                  Math::scale(sensor.peakValue, exitFactor));
         bool exited = smoothed < exitThreshold;
         bool timedOut = (timestamp - sensor.waveStartTime) > config.maxWaveDurationMs;
 
@@ -109,16 +157,30 @@ void DirectionDetector::updateSensorWave(SensorTracker &sensor, float smoothed,
         {
             sensor.waveState = WaveState::COMPLETE;
             sensor.waveEndTime = timestamp;
+            sensor.waveEndUs = _frameUs;
             sensor.centerOfMass = (sensor.totalWeight > 0)
-                                      ? (uint32_t)(sensor.weightedSum / sensor.totalWeight)
+                                      ? sensor.waveStartTime + Math::quotient(sensor.weightedSum, sensor.totalWeight)
                                       : sensor.peakTime;
+            sensor.centerOfMassUs = sensor.centerOfMass * 1000;
+            if (Profile::skewCompensation(config) && sensor.totalWeight > 0)
+            {
+                sensor.centerOfMassUs = sensor.waveStartUs + Math::quotient(sensor.weightedSumUs, sensor.totalWeight);
+                sensor.centerOfMass = sensor.centerOfMassUs / 1000;
+            }
+            sensor.completeWave();
         }
         break;
     }
 
     case WaveState::COMPLETE:
-        // Expire stale completed waves that didn't pair into a module detection
-        if (timestamp - sensor.waveEndTime > config.maxPeakGapMs)
+        if (Profile::multiTransit(config))
+        {
+            // Re-arm once the tail is back under the threshold; the
+            // completed wave keeps waiting for its partner meanwhile
+            if (smoothed <= sensor.threshold || timestamp - sensor.waveEndTime > config.maxPeakGapMs)
+                sensor.waveState = WaveState::IDLE;
+        }
+        else if (timestamp - sensor.waveEndTime > config.maxPeakGapMs)
         {
             sensor.resetWave();
         }
@@ -126,33 +188,82 @@ void DirectionDetector::updateSensorWave(SensorTracker &sensor, float smoothed,
     }
 }
 
-bool DirectionDetector::isModuleDetected(int module) const
+template <typename Math, typename Profile>
+bool BasicDirectionDetector<Math, Profile>::isModuleDetected(int module) const
 {
-    int posA = module * 2;
-    int posB = module * 2 + 1;
+    uint8_t waveA, waveB;
+    return findModulePair(module, waveA, waveB);
+}
 
-    if (sensors[posA].waveState != WaveState::COMPLETE ||
-        sensors[posB].waveState != WaveState::COMPLETE)
-        return false;
+// Oldest completed wave on side A with a side B partner: both long enough,
+// peaks at most maxPeakGapMs apart (the closest partner if several qualify)
+template <typename Math, typename Profile>
+bool BasicDirectionDetector<Math, Profile>::findModulePair(int module, uint8_t &waveA, uint8_t &waveB) const
+{
+    const SensorTracker &sensorA = sensors[module * 2];
+    const SensorTracker &sensorB = sensors[module * 2 + 1];
 
-    uint32_t durA = sensors[posA].waveEndTime - sensors[posA].waveStartTime;
-    uint32_t durB = sensors[posB].waveEndTime - sensors[posB].waveStartTime;
-    if (durA < config.minWaveDurationMs || durB < config.minWaveDurationMs)
-        return false;
+    for (uint8_t i = 0; i < sensorA.completedCount; i++)
+    {
+        const auto &a = sensorA.completed[i];
+        if (a.duration() < config.minWaveDurationMs)
+            continue;
 
-    uint32_t peakGap = abs((int32_t)sensors[posA].peakTime - (int32_t)sensors[posB].peakTime);
-    if (peakGap > config.maxPeakGapMs)
-        return false;
+        uint32_t bestGap = UINT32_MAX;
+        for (uint8_t j = 0; j < sensorB.completedCount; j++)
+        {
+            const auto &b = sensorB.completed[j];
+            if (b.duration() < config.minWaveDurationMs)
+                continue;
+            uint32_t peakGap = abs((int32_t)a.peakTime - (int32_t)b.peakTime);
+            if (peakGap <= config.maxPeakGapMs && peakGap < bestGap)
+            {
+                bestGap = peakGap;
+                waveB = j;
+            }
+        }
+        if (bestGap != UINT32_MAX)
+        {
+            waveA = i;
+            return true;
+        }
+    }
+    return false;
+}
 
-    return true;
+// Earlier peak of a pair: when the transit reached the module
+template <typename Math, typename Profile>
+uint32_t BasicDirectionDetector<Math, Profile>::pairPeakTime(int module, uint8_t waveA, uint8_t waveB) const
+{
+    uint32_t peakA = sensors[module * 2].completed[waveA].peakTime;
+    uint32_t peakB = sensors[module * 2 + 1].completed[waveB].peakTime;
+    return (int32_t)(peakA - peakB) <= 0 ? peakA : peakB;
+}
+
+// multiTransit: pairs of the transit just reported, completed by slower modules
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::dropLateModules()
+{
+    for (int m = 0; m < DETECTOR_NUM_MODULES; m++)
+    {
+        uint8_t waveA, waveB;
+        while (findModulePair(m, waveA, waveB) &&
+               (uint32_t)abs((int32_t)(pairPeakTime(m, waveA, waveB) - _lastTransitPeakMs)) <= config.maxPeakGapMs)
+        {
+            sensors[m * 2].dropCompleted(waveA);
+            sensors[m * 2 + 1].dropCompleted(waveB);
+            _lateModules++;
+        }
+    }
 }
 
-bool DirectionDetector::hasDetection() const
+template <typename Math, typename Profile>
+bool BasicDirectionDetector<Math, Profile>::hasDetection() const
 {
     if (!isReady())
         return false;
 
-    for (int m = 0; m < 3; m++)
+    for (int m = 0; m < DETECTOR_NUM_MODULES; m++)
     {
         if (isModuleDetected(m))
             return true;
@@ -160,7 +271,8 @@ bool DirectionDetector::hasDetection() const
     return false;
 }
 
-DetectionResult DirectionDetector::getResult()
+template <typename Math, typename Profile>
+DetectionResult BasicDirectionDetector<Math, Profile>::getResult()
 {
     DetectionResult result;
     result.direction = Direction::UNKNOWN;
@@ -168,6 +280,7 @@ DetectionResult DirectionDetector::getResult()
     result.centerOfMassA = 0;
     result.centerOfMassB = 0;
     result.comGapMs = 0;
+    result.comGapUs = 0;
     result.maxSignalA = 0;
     result.maxSignalB = 0;
     result.waveDurationA = 0;
@@ -178,35 +291,67 @@ DetectionResult DirectionDetector::getResult()
     result.thresholdB = 0;
     result.detectedModule = 0;
     result.modulesDetected = 0;
+    result.firstCrossingUs = 0;
+    result.waveCompleteUs = 0;
 
     if (!hasDetection())
         return result;
 
-    // Find all modules with valid detections
+    // Each module's oldest pair; the earliest of them is the transit reported
+    struct ModulePair
+    {
+        bool found;
+        uint8_t waveA;
+        uint8_t waveB;
+        uint32_t peakMs;
+    };
+    ModulePair pairs[DETECTOR_NUM_MODULES];
+    int reference = -1;
+    for (int m = 0; m < DETECTOR_NUM_MODULES; m++)
+    {
+        ModulePair &pair = pairs[m];
+        pair.found = findModulePair(m, pair.waveA, pair.waveB);
+        if (!pair.found)
+            continue;
+        pair.peakMs = pairPeakTime(m, pair.waveA, pair.waveB);
+        if (reference < 0 || (int32_t)(pair.peakMs - pairs[reference].peakMs) < 0)
+            reference = m;
+    }
+
+    // Find all modules with valid detections (multiTransit: of that transit;
+    // later pairs belong to the next one)
     int bestModule = -1;
-    float bestSignal = 0;
+    Sum bestSignal = 0;
     uint8_t modulesDetected = 0;
     Direction consensusDir = Direction::UNKNOWN;
     bool directionConsistent = true;
 
-    for (int m = 0; m < 3; m++)
+    for (int m = 0; m < DETECTOR_NUM_MODULES; m++)
     {
-        if (!isModuleDetected(m))
+        ModulePair &pair = pairs[m];
+        if (!pair.found)
+            continue;
+        if (Profile::multiTransit(config) &&
+            (uint32_t)abs((int32_t)(pair.peakMs - pairs[reference].peakMs)) > config.maxPeakGapMs)
+        {
+            pair.found = false;
             continue;
+        }
 
-        int posA = m * 2;
-        int posB = m * 2 + 1;
+        const auto &waveA = sensors[m * 2].completed[pair.waveA];
+        const auto &waveB = sensors[m * 2 + 1].completed[pair.waveB];
 
         modulesDetected++;
 
         // Direction for this module: Side A (S1) saw it first → A_TO_B
         Direction dir;
-        if (sensors[posA].centerOfMass < sensors[posB].centerOfMass)
+        int32_t comDeltaUs = (int32_t)(waveB.centerOfMassUs - waveA.centerOfMassUs);
+        if (comDeltaUs > 0)
             dir = Direction::A_TO_B;
-        else if (sensors[posB].centerOfMass < sensors[posA].centerOfMass)
+        else if (comDeltaUs < 0)
             dir = Direction::B_TO_A;
         else
-            dir = (sensors[posA].peakTime < sensors[posB].peakTime)
+            dir = (waveA.peakTime < waveB.peakTime)
                       ? Direction::A_TO_B
                       : Direction::B_TO_A;
 
@@ -216,7 +361,7 @@ DetectionResult DirectionDetector::getResult()
             directionConsistent = false;
 
         // Best module = strongest combined signal
-        float signal = sensors[posA].peakValue + sensors[posB].peakValue;
+        Sum signal = (Sum)waveA.peakValue + waveB.peakValue;
         if (signal > bestSignal)
         {
             bestSignal = signal;
@@ -229,37 +374,37 @@ DetectionResult DirectionDetector::getResult()
 
     int posA = bestModule * 2;
     int posB = bestModule * 2 + 1;
+    const auto &waveA = sensors[posA].completed[pairs[bestModule].waveA];
+    const auto &waveB = sensors[posB].completed[pairs[bestModule].waveB];
 
     result.direction = directionConsistent ? consensusDir : Direction::UNKNOWN;
-    result.centerOfMassA = sensors[posA].centerOfMass;
-    result.centerOfMassB = sensors[posB].centerOfMass;
-    result.comGapMs = abs((int32_t)sensors[posA].centerOfMass -
-                          (int32_t)sensors[posB].centerOfMass);
-    result.maxSignalA = (uint16_t)sensors[posA].peakValue;
-    result.maxSignalB = (uint16_t)sensors[posB].peakValue;
-    result.waveDurationA = sensors[posA].waveEndTime - sensors[posA].waveStartTime;
-    result.waveDurationB = sensors[posB].waveEndTime - sensors[posB].waveStartTime;
-    result.thresholdA = sensors[posA].threshold;
-    result.thresholdB = sensors[posB].threshold;
+    result.centerOfMassA = waveA.centerOfMass;
+    result.centerOfMassB = waveB.centerOfMass;
+    result.comGapUs = abs((int32_t)(waveA.centerOfMassUs - waveB.centerOfMassUs));
+    result.comGapMs = result.comGapUs / 1000;
+    result.maxSignalA = Math::toCount(waveA.peakValue);
+    result.maxSignalB = Math::toCount(waveB.peakValue);
+    result.waveDurationA = waveA.duration();
+    result.waveDurationB = waveB.duration();
+    result.thresholdA = Math::toFloat(sensors[posA].threshold);
+    result.thresholdB = Math::toFloat(sensors[posB].threshold);
     result.detectedModule = bestModule + 1; // 1-indexed
     result.modulesDetected = modulesDetected;
+    // Earlier crossing / later exit of the pair (micros() wraps)
+    bool aFirst = (int32_t)(waveA.startUs - waveB.startUs) <= 0;
+    bool aLast = (int32_t)(waveA.endUs - waveB.endUs) >= 0;
+    result.firstCrossingUs = aFirst ? waveA.startUs : waveB.startUs;
+    result.waveCompleteUs = aLast ? waveA.endUs : waveB.endUs;
 
     // Baseline from rolling buffer mean
-    float sumA = 0, sumB = 0;
-    for (size_t i = 0; i < sensors[posA].baselineBuffer.size(); i++)
-        sumA += sensors[posA].baselineBuffer[i];
-    for (size_t i = 0; i < sensors[posB].baselineBuffer.size(); i++)
-        sumB += sensors[posB].baselineBuffer[i];
-    result.baselineA = sensors[posA].baselineBuffer.size() > 0
-                           ? sumA / sensors[posA].baselineBuffer.size()
-                           : 0;
-    result.baselineB = sensors[posB].baselineBuffer.size() > 0
-                           ? sumB / sensors[posB].baselineBuffer.size()
-                           : 0;
+    result.baselineA = Math::toFloat(sensors[posA].baselineBuffer.getAverage());
+    result.baselineB = Math::toFloat(sensors[posB].baselineBuffer.getAverage());
 
     // Confidence scoring
-    float gapConfidence = min(1.0f, (float)result.comGapMs / 50.0f);
-    float signalStrength = (sensors[posA].peakValue + sensors[posB].peakValue) / 2.0f;
+    float gapMs = Profile::skewCompensation(config) ? result.comGapUs / 1000.0f : (float)result.comGapMs;
+    float gapConfidence = min(1.0f, gapMs / 50.0f);
+    float signalStrength = (Math::toFloat(waveA.peakValue) +
+                            Math::toFloat(waveB.peakValue)) / 2.0f;
     float signalConfidence = min(1.0f, signalStrength / 100.0f);
     float baseConfidence = (gapConfidence * 0.6f) + (signalConfidence * 0.4f);
 
@@ -272,6 +417,21 @@ DetectionResult DirectionDetector::getResult()
     result.confidence = baseConfidence;
     _detectedModule = bestModule;
 
+    if (Profile::multiTransit(config))
+    {
+        // Consumed: the sensors have re-armed already, so the next transit
+        // needs no reset
+        _haveTransit = true;
+        _lastTransitPeakMs = pairs[reference].peakMs;
+        for (int m = 0; m < DETECTOR_NUM_MODULES; m++)
+        {
+            if (!pairs[m].found)
+                continue;
+            sensors[m * 2].dropCompleted(pairs[m].waveA);
+            sensors[m * 2 + 1].dropCompleted(pairs[m].waveB);
+        }
+    }
+
     if (!serialStudioEnabled)
         Serial.printf("[Detector] Detection on M%d (%d modules agree): %s conf=%.2f\n",
                       bestModule + 1, modulesDetected,
@@ -280,7 +440,8 @@ DetectionResult DirectionDetector::getResult()
     return result;
 }
 
-void DirectionDetector::reset()
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::reset()
 {
     for (int i = 0; i < NUM_SENSORS; i++)
     {
@@ -288,29 +449,39 @@ void DirectionDetector::reset()
         sensors[i].smoothBuffer.clear();
     }
     _detectedModule = -1;
+    _haveTransit = false;
 }
 
-void DirectionDetector::fullReset()
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::fullReset()
 {
     for (int i = 0; i < NUM_SENSORS; i++)
     {
         sensors[i].fullReset();
     }
     _detectedModule = -1;
+    _haveTransit = false;
     _useCalibration = false;
 }
 
-bool DirectionDetector::isReady() const
+template <typename Math, typename Profile>
+bool BasicDirectionDetector<Math, Profile>::isReady() const
 {
+    // Positions on absent boards never report and must not hold detection back
+    bool anyPresent = false;
     for (int i = 0; i < NUM_SENSORS; i++)
     {
+        if (!sensors[i].present)
+            continue;
         if (!sensors[i].baselineReady)
             return false;
+        anyPresent = true;
     }
-    return true;
+    return anyPresent;
 }
 
-DetectorState DirectionDetector::getState() const
+template <typename Math, typename Profile>
+DetectorState BasicDirectionDetector<Math, Profile>::getState() const
 {
     if (!isReady())
         return DetectorState::ESTABLISHING_BASELINE;
@@ -322,9 +493,44 @@ DetectorState DirectionDetector::getState() const
     return DetectorState::READY;
 }
 
-void DirectionDetector::setConfig(const DetectorConfig &cfg)
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getActivity() const
+{
+    float activity = 0.0f;
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        const SensorTracker &sensor = sensors[i];
+        if (!sensor.baselineReady || sensor.waveState != WaveState::IDLE)
+            return 1.0f;
+
+        float baseMax = Math::toFloat(sensor.baselineBuffer.getMax());
+        float threshold = Math::toFloat(sensor.threshold);
+        float smoothed = Math::toFloat(smoothedOf(sensor));
+
+        // A calibrated threshold can sit at or below the rolling baseline
+        float span = threshold - baseMax;
+        if (span < config.minRise)
+            span = config.minRise > 0 ? config.minRise : 1.0f;
+
+        float a = (smoothed - (threshold - span)) / span;
+        if (a > activity)
+            activity = a;
+    }
+    return activity;
+}
+
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::setConfig(const DetectorConfig &cfg)
 {
     config = cfg;
+    Profile::apply(config);
+    if (!serialStudioEnabled && (config.smoothingWindow != cfg.smoothingWindow ||
+                                 config.multiTransit != cfg.multiTransit ||
+                                 config.skewCompensation != cfg.skewCompensation))
+        Serial.printf("[Detector] %s profile: smoothing=%d, multi-transit %s, skew compensation %s (config ignored)\n",
+                      Profile::name(), config.smoothingWindow, config.multiTransit ? "on" : "off",
+                      config.skewCompensation ? "on" : "off");
+    updateFactors();
     for (int i = 0; i < NUM_SENSORS; i++)
     {
         if (sensors[i].baselineReady)
@@ -332,7 +538,8 @@ void DirectionDetector::setConfig(const DetectorConfig &cfg)
     }
 }
 
-void DirectionDetector::setCalibration(const DeviceCalibration *cal)
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::setCalibration(const DeviceCalibration *cal)
 {
     _calibration = cal;
 
@@ -353,22 +560,64 @@ void DirectionDetector::setCalibration(const DeviceCalibration *cal)
     }
 }
 
+template <typename Math, typename Profile>
+bool BasicDirectionDetector<Math, Profile>::getBaseline(uint8_t position, SensorBaseline &out) const
+{
+    if (position >= NUM_SENSORS || !sensors[position].baselineReady)
+        return false;
+
+    const SensorTracker &sensor = sensors[position];
+    out.mean = Math::toCount(sensor.baselineBuffer.getAverage());
+    out.max = Math::toCount(sensor.baselineBuffer.getMax());
+    out.threshold = Math::toCount(sensor.threshold);
+    return true;
+}
+
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::warmStart(uint8_t position, const SensorBaseline &baseline)
+{
+    if (position >= NUM_SENSORS)
+        return;
+
+    SensorTracker &sensor = sensors[position];
+    sensor.fullReset();
+
+    // Seed a full baseline window: the noise ceiling once (so getMax()
+    // matches), the mean for the rest. The oldest entries go first, so the
+    // seed is gone after BASELINE_SIZE idle readings.
+    size_t seed = max((size_t)config.baselineReadings, (size_t)1);
+    sensor.baselineBuffer.push(Math::fromCount(baseline.max));
+    for (size_t i = 1; i < seed; i++)
+        sensor.baselineBuffer.push(Math::fromCount(baseline.mean));
+    sensor.baselineReady = true;
+
+    // The stored threshold holds until the next periodic recalculation
+    // (calibrated thresholds always come from the calibration)
+    if (Profile::calibration() && _calibration != nullptr && _calibration->isValid())
+        recalculateThreshold(sensor, position);
+    else
+        sensor.threshold = Math::fromCount(baseline.threshold);
+}
+
 // Per-sensor telemetry accessors
-float DirectionDetector::getSensorThreshold(uint8_t position) const
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getSensorThreshold(uint8_t position) const
 {
     if (position >= NUM_SENSORS)
         return 0;
-    return sensors[position].threshold;
+    return Math::toFloat(sensors[position].threshold);
 }
 
-float DirectionDetector::getSensorSmoothed(uint8_t position) const
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getSensorSmoothed(uint8_t position) const
 {
     if (position >= NUM_SENSORS)
         return 0;
-    return sensors[position].smoothBuffer.getSmoothedAverage(config.smoothingWindow);
+    return Math::toFloat(smoothedOf(sensors[position]));
 }
 
-WaveState DirectionDetector::getSensorWaveState(uint8_t position) const
+template <typename Math, typename Profile>
+WaveState BasicDirectionDetector<Math, Profile>::getSensorWaveState(uint8_t position) const
 {
     if (position >= NUM_SENSORS)
         return WaveState::IDLE;
@@ -376,43 +625,50 @@ WaveState DirectionDetector::getSensorWaveState(uint8_t position) const
 }
 
 // Legacy telemetry — returns data from best detected module, falling back to module 0
-float DirectionDetector::getSmoothedA() const
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getSmoothedA() const
 {
     int m = (_detectedModule >= 0) ? _detectedModule : 0;
-    return sensors[m * 2].smoothBuffer.getSmoothedAverage(config.smoothingWindow);
+    return Math::toFloat(smoothedOf(sensors[m * 2]));
 }
 
-float DirectionDetector::getSmoothedB() const
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getSmoothedB() const
 {
     int m = (_detectedModule >= 0) ? _detectedModule : 0;
-    return sensors[m * 2 + 1].smoothBuffer.getSmoothedAverage(config.smoothingWindow);
+    return Math::toFloat(smoothedOf(sensors[m * 2 + 1]));
 }
 
-float DirectionDetector::getThresholdA() const
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getThresholdA() const
 {
     int m = (_detectedModule >= 0) ? _detectedModule : 0;
-    return sensors[m * 2].threshold;
+    return Math::toFloat(sensors[m * 2].threshold);
 }
 
-float DirectionDetector::getThresholdB() const
+template <typename Math, typename Profile>
+float BasicDirectionDetector<Math, Profile>::getThresholdB() const
 {
     int m = (_detectedModule >= 0) ? _detectedModule : 0;
-    return sensors[m * 2 + 1].threshold;
+    return Math::toFloat(sensors[m * 2 + 1].threshold);
 }
 
-WaveState DirectionDetector::getWaveStateA() const
+template <typename Math, typename Profile>
+WaveState BasicDirectionDetector<Math, Profile>::getWaveStateA() const
 {
     int m = (_detectedModule >= 0) ? _detectedModule : 0;
     return sensors[m * 2].waveState;
 }
 
-WaveState DirectionDetector::getWaveStateB() const
+template <typename Math, typename Profile>
+WaveState BasicDirectionDetector<Math, Profile>::getWaveStateB() const
 {
     int m = (_detectedModule >= 0) ? _detectedModule : 0;
     return sensors[m * 2 + 1].waveState;
 }
 
-const char *DirectionDetector::directionToString(Direction dir)
+template <typename Math, typename Profile>
+const char *BasicDirectionDetector<Math, Profile>::directionToString(Direction dir)
 {
     switch (dir)
     {
@@ -425,9 +681,10 @@ const char *DirectionDetector::directionToString(Direction dir)
     }
 }
 
-void DirectionDetector::debugPrint() const
+template <typename Math, typename Profile>
+void BasicDirectionDetector<Math, Profile>::debugPrint() const
 {
-    Serial.println("=== DirectionDetector State (Per-Sensor) ===");
+    Serial.printf("=== DirectionDetector State (Per-Sensor, %s) ===\n", Math::name());
     Serial.printf("Overall state: %s\n",
                   getState() == DetectorState::ESTABLISHING_BASELINE ? "ESTABLISHING_BASELINE"
                   : getState() == DetectorState::READY               ? "READY"
@@ -443,9 +700,16 @@ void DirectionDetector::debugPrint() const
         Serial.printf("  M%d-%s [pos %d]: baseline=%s thresh=%.1f wave=%s\n",
                       module, side, i,
                       s.baselineReady ? "OK" : "building",
-                      s.threshold,
+                      Math::toFloat(s.threshold),
                       s.waveState == WaveState::IDLE     ? "IDLE"
                       : s.waveState == WaveState::IN_WAVE ? "IN_WAVE"
                                                           : "COMPLETE");
     }
 }
+
+// Both arithmetic variants with both profiles (the firmware links the one
+// DirectionDetector names)
+template class BasicDirectionDetector<FloatDetectorMath>;
+template class BasicDirectionDetector<FixedDetectorMath>;
+template class BasicDirectionDetector<FloatDetectorMath, ProductionDetectorProfile>;
+template class BasicDirectionDetector<FixedDetectorMath, ProductionDetectorProfile>;
@@ -3,27 +3,41 @@
 
 #include <Arduino.h>
 #include <vector>
-#include "../sensor/SensorManager.h"
+#include "../sensor/SensorFrame.h"
 #include "../calibration/CalibrationData.h"
+#include "../memory/PowerOfTwoRing.h"
 
 /**
  * Direction Detection - Version 4: Per-Sensor Adaptive Thresholds
  *
- * Each of the 6 sensors tracks independently with its own rolling baseline
- * and adaptive threshold. Detection works in three layers:
+ * Each sensor tracks independently with its own rolling baseline and
+ * adaptive threshold. Detection works in three layers:
  *
  * Layer 1 - Per-Sensor: Each sensor maintains a rolling baseline (only updated
  *   during IDLE — transit waves are excluded), computes its own adaptive
  *   threshold, and runs an independent wave state machine.
  *
- * Layer 2 - Per-Module: When both sensors on a module complete waves within
+ * Layer 2 - Per-Module (DETECTOR_NUM_MODULES, one per sensor board; a
+ *   board that never delivers a reading takes no part): When both sensors
+ *   on a module complete waves within
  *   a valid time window, that module produces a detection with direction
  *   from center-of-mass comparison.
  *
  * Layer 3 - Consensus: Multiple modules detecting the same direction boosts
  *   confidence. Disagreement lowers it.
+ *
+ * Completed waves queue per sensor until they pair up. By default a sensor
+ * holds its completed wave until the caller resets the detector after a
+ * detection. With multiTransit, a sensor re-arms as soon as its signal
+ * falls back under the threshold, so the next wave can start while earlier
+ * ones are still waiting for their partner; getResult() then consumes the
+ * pairs it reports and the caller neither resets nor blacks out detection.
+ * Pairs that arrive within maxPeakGapMs of a reported transit are treated
+ * as late modules of that transit, not as a new one.
  */
 
+#define DETECTOR_NUM_MODULES (NUM_SENSORS / SENSORS_PER_BOARD)
+
 enum class Direction
 {
     UNKNOWN,
@@ -52,6 +66,7 @@ struct DetectionResult
     uint32_t centerOfMassA;
     uint32_t centerOfMassB;
     uint32_t comGapMs;
+    uint32_t comGapUs; // Same gap at us resolution (ms x 1000 without skewCompensation)
     uint16_t maxSignalA;
     uint16_t maxSignalB;
     uint32_t waveDurationA;
@@ -60,8 +75,12 @@ struct DetectionResult
     float baselineB;
     float thresholdA;
     float thresholdB;
-    uint8_t detectedModule;  // 1-3 for which module triggered, 0 for none
+    uint8_t detectedModule;  // 1.. for which module triggered, 0 for none
     uint8_t modulesDetected; // how many modules corroborated
+
+    // Frame timestamps (us) for LatencyTracker; 0 = unknown
+    uint32_t firstCrossingUs; // First sensor of the module above its threshold
+    uint32_t waveCompleteUs;  // Last wave of the module completed
 };
 
 struct DetectorConfig
@@ -78,111 +97,490 @@ struct DetectorConfig
 
     uint32_t minGapForConfidence = 5;
     float minSignalForConfidence = 20;
+
+    bool multiTransit = false; // Pipelined waves, results consumed (multi_transit)
+
+    // Center of mass from each sample's own instant (SensorFrame::sampleUs)
+    // at us resolution, instead of the frame's ms (skew_compensation)
+    bool skewCompensation = false;
+};
+
+/**
+ * One report per detection. Without multiTransit, hasDetection() stays true
+ * until the caller resets the detector, so a caller polling every frame
+ * (DetectionTask) would see the same pair again on each one.
+ */
+class DetectionLatch
+{
+public:
+    // pending: hasDetection(); consumed: reading the result clears it
+    // (multiTransit, MLDetector). True when the detection is to be reported.
+    bool report(bool pending, bool consumed)
+    {
+        if (!pending || consumed)
+        {
+            reported = false;
+            return pending;
+        }
+        if (reported)
+            return false;
+        reported = true;
+        return true;
+    }
+
+private:
+    bool reported = false;
+};
+
+/**
+ * Arithmetic policies for the detector pipeline (template parameter of
+ * BasicDirectionDetector)
+ *
+ * FloatDetectorMath is the original float pipeline. FixedDetectorMath runs
+ * the same pipeline on integers: no FPU work per sample, and bit-identical
+ * results on every platform (replay testing).
+ *
+ * Fixed-point scale: values are counts x 5040 rather than a binary Q16.16.
+ * 5040 is divisible by every smoothing length 1..10 (and 5040/n is even),
+ * so smoothed averages of the uint16 readings and the common 0.5 exit
+ * factor are exact. A binary fraction would round those averages, and
+ * rounding breaks the exact ties (e.g. smoothed == peak / 2) that the float
+ * path resolves consistently — decisions would drift from the float path.
+ * With exact values the two differ only where float rounding itself
+ * decides a comparison. Raw range 65535 x 5040 fits in 32 bits; sums are
+ * 64-bit.
+ *
+ * Build-wide choice: -DDIRECTION_DETECTOR_FIXED_POINT=1 (see below).
+ */
+struct FloatDetectorMath
+{
+    typedef float Value;  // Smoothed / baseline / threshold value, in counts
+    typedef float Sum;    // Window sums and center-of-mass accumulators
+    typedef float Factor; // Config multiplier (peakMultiplier, waveExitThreshold)
+
+    static const char *name() { return "float"; }
+
+    static Value fromCount(uint16_t count) { return (float)count; }
+    static Factor factor(float f) { return f; }
+    static Value scale(Value v, Factor f) { return v * f; }
+    static Value add(Value a, Value b) { return a + b; }
+    static Sum weight(Value v, uint32_t offset) { return v * offset; }
+    static uint32_t quotient(Sum weighted, Sum total) { return (uint32_t)(weighted / total); }
+    template <size_t N>
+    static Value average(Sum sum) { return sum / N; }
+    static float toFloat(Value v) { return v; }
+    static uint16_t toCount(Value v) { return (uint16_t)v; }
+};
+
+struct FixedDetectorMath
+{
+    static const uint32_t ONE = 5040; // One count
+
+    typedef uint32_t Value; // Counts x ONE
+    typedef uint64_t Sum;
+    typedef uint32_t Factor; // Multiplier x FACTOR_ONE
+
+    static const char *name() { return "fixed x5040"; }
+
+    static Value fromCount(uint16_t count) { return (Value)count * ONE; }
+    static Factor factor(float f) { return f <= 0.0f ? 0 : (Factor)lrintf(f * FACTOR_ONE); }
+    static Value scale(Value v, Factor f) { return saturate(((uint64_t)v * f + (FACTOR_ONE / 2)) >> FACTOR_BITS); }
+    static Value add(Value a, Value b) { return saturate((uint64_t)a + b); }
+    static Sum weight(Value v, uint32_t offset) { return (Sum)v * offset; }
+    static uint32_t quotient(Sum weighted, Sum total) { return (uint32_t)(weighted / total); }
+    // Mean of N raw readings, rounded (ringAverage with a constant divisor).
+    // N readings of at most 65535 x ONE fit 32 bits: no 64-bit division.
+    template <size_t N>
+    static Value average(Sum sum)
+    {
+        static_assert(N * 65535ULL * ONE + N / 2 <= UINT32_MAX, "sum of N readings exceeds 32 bits");
+        return ((uint32_t)sum + N / 2) / N;
+    }
+    static float toFloat(Value v) { return (float)v / ONE; }
+    static uint16_t toCount(Value v) { return (uint16_t)(v / ONE); }
+
+private:
+    // Config multipliers are Q16.16; 0.5 and other short binary fractions stay exact
+    static const int FACTOR_BITS = 16;
+    static const uint32_t FACTOR_ONE = 1UL << FACTOR_BITS;
+
+    static Value saturate(uint64_t v) { return v > UINT32_MAX ? UINT32_MAX : (Value)v; }
 };
 
+/**
+ * Detector profiles (second template parameter of BasicDirectionDetector):
+ * where the parameters read on every sample come from.
+ *
+ * RuntimeDetectorProfile reads them from DetectorConfig, so any setConfig()
+ * applies; this is what the firmware runs by default. A
+ * StaticDetectorProfile fixes them at compile time: the smoothing average
+ * divides by a constant (a multiply; 32-bit for FixedDetectorMath), and the
+ * multiTransit, skewCompensation and calibration branches fold away.
+ * setConfig() still takes every other field; the fixed ones are overwritten
+ * with the profile's values. The sensor count is compile-time either way
+ * (SENSOR_MAX_BOARDS).
+ *
+ * Both profiles make the same decisions for the same effective config; the
+ * replay harness runs them side by side (--detector float-static).
+ */
+struct RuntimeDetectorProfile
+{
+    static const bool IS_STATIC = false;
+    static const uint8_t SMOOTHING_WINDOW = 1; // Unused: the window comes from DetectorConfig
+
+    static const char *name() { return "runtime"; }
+
+    static uint8_t smoothingWindow(const DetectorConfig &config) { return config.smoothingWindow; }
+    static bool multiTransit(const DetectorConfig &config) { return config.multiTransit; }
+    static bool skewCompensation(const DetectorConfig &config) { return config.skewCompensation; }
+    static bool calibration() { return true; }
+    static void apply(DetectorConfig &) {}
+};
+
+template <uint8_t WINDOW, bool MULTI_TRANSIT, bool SKEW_COMPENSATION, bool CALIBRATION>
+struct StaticDetectorProfile
+{
+    static_assert(WINDOW >= 1 && WINDOW <= 10, "smoothing window is 1..SMOOTH_SIZE");
+
+    static const bool IS_STATIC = true;
+    static const uint8_t SMOOTHING_WINDOW = WINDOW;
+
+    static const char *name() { return "static"; }
+
+    static uint8_t smoothingWindow(const DetectorConfig &) { return WINDOW; }
+    static bool multiTransit(const DetectorConfig &) { return MULTI_TRANSIT; }
+    static bool skewCompensation(const DetectorConfig &) { return SKEW_COMPENSATION; }
+    static bool calibration() { return CALIBRATION; }
+    static void apply(DetectorConfig &config)
+    {
+        config.smoothingWindow = WINDOW;
+        config.multiTransit = MULTI_TRANSIT;
+        config.skewCompensation = SKEW_COMPENSATION;
+    }
+};
+
+// The shipped defaults: smoothing 5, single transit, frame timing, wizard
+// calibration used when present
+typedef StaticDetectorProfile<5, false, false, true> ProductionDetectorProfile;
+
+// Average of n items: float division, or round-to-nearest for integer sums
+// (exact for FixedDetectorMath smoothing windows)
+inline float ringAverage(float sum, size_t n) { return sum / n; }
+inline uint32_t ringAverage(uint64_t sum, size_t n) { return (uint32_t)((sum + n / 2) / n); }
+
 /**
  * Ring buffer for smoothing and baseline tracking
+ *
+ * Storage is a PowerOfTwoRing (mask indexing, two-span iteration) holding
+ * exactly the newest SIZE items. Statistics are maintained incrementally
+ * so the per-sample cost stays amortized O(1) regardless of SIZE:
+ * - A running sum over the most recent `window` items (getSmoothedAverage).
+ *   Changing the window size re-sums once; the sum is also re-derived every
+ *   CAPACITY pushes so float add/subtract error cannot build up.
+ * - With TRACK_EXTREMES, monotonic deques (value + push sequence number)
+ *   give the max/min over the whole buffer (getMax/getMin) without scanning.
+ * - ACC is the sum type (uint64_t for fixed-point items, so sums cannot overflow).
  */
-template <typename T, size_t SIZE>
+template <typename T, size_t SIZE, bool TRACK_EXTREMES = false, typename ACC = T>
 class RingBuffer
 {
 private:
-    T buffer[SIZE];
-    size_t head = 0;
-    size_t count = 0;
+    static constexpr size_t CAPACITY = ringCapacityFor(SIZE);
+    typedef PowerOfTwoRing<T, CAPACITY, SIZE> Storage;
 
-public:
-    void push(const T &item)
+    Storage items;
+    uint32_t pushed = 0; // Push sequence number (free-running, only compared by difference)
+
+    // Running sum of the last `window` items (0 = not tracking yet)
+    mutable size_t window = 0;
+    mutable ACC windowSum = 0;
+
+    // Monotonic deques (front = current max/min of the buffer)
+    struct Extreme
     {
-        buffer[head] = item;
-        head = (head + 1) % SIZE;
-        if (count < SIZE)
-            count++;
+        T value;
+        uint32_t seq;
+    };
+    struct ExtremeDeque
+    {
+        static constexpr size_t DEQUE_CAPACITY = TRACK_EXTREMES ? CAPACITY : 1;
+        static constexpr size_t DEQUE_MASK = DEQUE_CAPACITY - 1;
+        Extreme entries[DEQUE_CAPACITY];
+        size_t front = 0;
+        size_t length = 0;
+
+        const Extreme &first() const { return entries[front]; }
+        const Extreme &last() const { return entries[(front + length - 1) & DEQUE_MASK]; }
+        void popFront()
+        {
+            front = (front + 1) & DEQUE_MASK;
+            length--;
+        }
+        void popBack() { length--; }
+        void pushBack(const T &value, uint32_t seq)
+        {
+            entries[(front + length) & DEQUE_MASK] = {value, seq};
+            length++;
+        }
+        void clear()
+        {
+            front = 0;
+            length = 0;
+        }
+    };
+    ExtremeDeque maxDeque;
+    ExtremeDeque minDeque;
+
+    static ACC sumSpan(const typename Storage::Span &span)
+    {
+        ACC sum = 0;
+        for (size_t i = 0; i < span.length; i++)
+            sum += span.data[i];
+        return sum;
     }
 
-    T &operator[](size_t idx)
+    ACC sumLast(size_t n) const
     {
-        size_t actualIdx = (head - count + idx + SIZE) % SIZE;
-        return buffer[actualIdx];
+        typename Storage::Segments seg = items.newest(n);
+        return sumSpan(seg.first) + sumSpan(seg.second);
     }
 
-    const T &operator[](size_t idx) const
+    void pushExtremes(const T &item)
     {
-        size_t actualIdx = (head - count + idx + SIZE) % SIZE;
-        return buffer[actualIdx];
+        uint32_t seq = pushed - 1;
+        uint32_t oldest = pushed - items.size();
+
+        // Drop entries that fell out of the buffer
+        while (maxDeque.length > 0 && (int32_t)(maxDeque.first().seq - oldest) < 0)
+            maxDeque.popFront();
+        while (minDeque.length > 0 && (int32_t)(minDeque.first().seq - oldest) < 0)
+            minDeque.popFront();
+
+        // Anything the new item dominates can never be the max/min again
+        while (maxDeque.length > 0 && maxDeque.last().value <= item)
+            maxDeque.popBack();
+        maxDeque.pushBack(item, seq);
+
+        while (minDeque.length > 0 && minDeque.last().value >= item)
+            minDeque.popBack();
+        minDeque.pushBack(item, seq);
     }
 
-    size_t size() const { return count; }
-    void clear()
+    template <typename Better>
+    T scanExtreme(Better better) const
     {
-        count = 0;
-        head = 0;
+        typename Storage::Segments seg = items.segments();
+        T best = seg.first.data[0];
+        for (size_t i = 1; i < seg.first.length; i++)
+            if (better(seg.first.data[i], best))
+                best = seg.first.data[i];
+        for (size_t i = 0; i < seg.second.length; i++)
+            if (better(seg.second.data[i], best))
+                best = seg.second.data[i];
+        return best;
     }
-    bool isFull() const { return count == SIZE; }
 
-    float getSmoothedAverage(size_t windowSize) const
+public:
+    void push(const T &item)
     {
-        if (count == 0)
-            return 0;
-        size_t n = min(windowSize, count);
-        float sum = 0;
-        for (size_t i = count - n; i < count; i++)
+        size_t count = items.size();
+
+        // Item leaving the smoothing window (read before it can be overwritten)
+        if (window > 0 && count >= window)
+            windowSum -= items[count - window];
+
+        items.push(item);
+        pushed++;
+
+        if (window > 0)
         {
-            sum += buffer[(head - count + i + SIZE) % SIZE];
+            if ((pushed & (CAPACITY - 1)) == 0)
+                windowSum = sumLast(window);
+            else
+                windowSum += item;
         }
-        return sum / n;
+
+        if (TRACK_EXTREMES)
+            pushExtremes(item);
     }
 
-    float getMax() const
+    T &operator[](size_t idx) { return items[idx]; }
+    const T &operator[](size_t idx) const { return items[idx]; }
+
+    size_t size() const { return items.size(); }
+    void clear()
     {
-        if (count == 0)
+        items.clear();
+        pushed = 0;
+        windowSum = 0;
+        maxDeque.clear();
+        minDeque.clear();
+    }
+    bool isFull() const { return items.isFull(); }
+
+    // Contiguous views of the contents, oldest first
+    typename Storage::Segments segments() const { return items.segments(); }
+
+    // Sum of the newest windowSize items; n = how many (fewer while filling)
+    ACC getWindowSum(size_t windowSize, size_t &n) const
+    {
+        size_t count = items.size();
+        if (count == 0 || windowSize == 0)
+        {
+            n = 0;
             return 0;
-        float maxVal = buffer[(head - count + SIZE) % SIZE];
-        for (size_t i = 1; i < count; i++)
+        }
+
+        if (windowSize > SIZE)
+            windowSize = SIZE;
+        if (windowSize != window)
         {
-            float val = buffer[(head - count + i + SIZE) % SIZE];
-            if (val > maxVal)
-                maxVal = val;
+            // Window changed (config update): re-sum once, then track incrementally
+            window = windowSize;
+            windowSum = sumLast(window);
         }
-        return maxVal;
+
+        n = min(window, count);
+        return windowSum;
+    }
+
+    T getSmoothedAverage(size_t windowSize) const
+    {
+        size_t n;
+        ACC sum = getWindowSum(windowSize, n);
+        return n > 0 ? ringAverage(sum, n) : 0;
+    }
+
+    T getMax() const
+    {
+        if (items.empty())
+            return 0;
+        if (TRACK_EXTREMES)
+            return maxDeque.first().value;
+        return scanExtreme([](T a, T b) { return a > b; });
+    }
+
+    T getMin() const
+    {
+        if (items.empty())
+            return 0;
+        if (TRACK_EXTREMES)
+            return minDeque.first().value;
+        return scanExtreme([](T a, T b) { return a < b; });
+    }
+
+    // Mean of the whole buffer (two-span walk)
+    T getAverage() const
+    {
+        if (items.empty())
+            return 0;
+        typename Storage::Segments seg = items.segments();
+        return ringAverage(sumSpan(seg.first) + sumSpan(seg.second), seg.size());
     }
 };
 
 /**
  * Independent tracker for a single sensor.
  * Maintains its own baseline, threshold, and wave state.
+ *
+ * waveState is the wave in progress: IN_WAVE while above the threshold;
+ * COMPLETE after the exit, until reset (single transit) or until the signal
+ * is back under the threshold (multiTransit). Finished waves wait in
+ * `completed` for their module partner, oldest first.
  */
-struct SensorTracker
+template <typename Math>
+struct BasicSensorTracker
 {
+    typedef typename Math::Value Value;
+    typedef typename Math::Sum Sum;
+
     static const size_t SMOOTH_SIZE = 10;
     static const size_t BASELINE_SIZE = 200;
+    static const uint8_t MAX_COMPLETED_WAVES = 4; // Transits in flight per sensor
 
-    RingBuffer<float, SMOOTH_SIZE> smoothBuffer;
-    RingBuffer<float, BASELINE_SIZE> baselineBuffer;
+    struct CompletedWave
+    {
+        uint32_t startTime;
+        uint32_t endTime;
+        uint32_t peakTime;
+        uint32_t centerOfMass;
+        uint32_t centerOfMassUs;
+        uint32_t startUs;
+        uint32_t endUs;
+        Value peakValue;
+
+        uint32_t duration() const { return endTime - startTime; }
+    };
+
+    RingBuffer<Value, SMOOTH_SIZE, false, Sum> smoothBuffer;
+    RingBuffer<Value, BASELINE_SIZE, true, Sum> baselineBuffer; // O(1) getMax for thresholds
     uint32_t baselineUpdateCount = 0;
     bool baselineReady = false;
+    bool present = false; // Has delivered a reading since fullReset()
 
-    float threshold = 0;
+    Value threshold = 0;
 
     WaveState waveState = WaveState::IDLE;
     uint32_t waveStartTime = 0;
     uint32_t waveEndTime = 0;
     uint32_t peakTime = 0;
-    float peakValue = 0;
-    float weightedSum = 0;
-    float totalWeight = 0;
+    Value peakValue = 0;
+    Sum weightedSum = 0; // Sum of smoothed * (t - waveStartTime), so it stays small
+    Sum totalWeight = 0;
     uint32_t centerOfMass = 0;
+    uint32_t waveStartUs = 0; // Frame timestamps of the crossing / exit
+    uint32_t waveEndUs = 0;
+    Sum weightedSumUs = 0; // Sum of smoothed * (sample us - waveStartUs) (skewCompensation)
+    uint32_t centerOfMassUs = 0;
+
+    CompletedWave completed[MAX_COMPLETED_WAVES];
+    uint8_t completedCount = 0;
+
+    // Wave in progress -> completed queue (the oldest is dropped when full)
+    void completeWave()
+    {
+        if (completedCount == MAX_COMPLETED_WAVES)
+            dropCompleted(0);
+        CompletedWave &wave = completed[completedCount++];
+        wave.startTime = waveStartTime;
+        wave.endTime = waveEndTime;
+        wave.peakTime = peakTime;
+        wave.centerOfMass = centerOfMass;
+        wave.centerOfMassUs = centerOfMassUs;
+        wave.startUs = waveStartUs;
+        wave.endUs = waveEndUs;
+        wave.peakValue = peakValue;
+    }
+
+    void dropCompleted(uint8_t index)
+    {
+        for (uint8_t i = index + 1; i < completedCount; i++)
+            completed[i - 1] = completed[i];
+        completedCount--;
+    }
+
+    // Drop waves that ended more than maxAgeMs ago without pairing
+    void expireCompleted(uint32_t timestamp, uint32_t maxAgeMs)
+    {
+        while (completedCount > 0 && timestamp - completed[0].endTime > maxAgeMs)
+            dropCompleted(0);
+    }
 
     void resetWave()
     {
         waveState = WaveState::IDLE;
         waveStartTime = 0;
         waveEndTime = 0;
+        waveStartUs = 0;
+        waveEndUs = 0;
         peakTime = 0;
         peakValue = 0;
         weightedSum = 0;
         totalWeight = 0;
         centerOfMass = 0;
+        weightedSumUs = 0;
+        centerOfMassUs = 0;
+        completedCount = 0;
     }
 
     void fullReset()
@@ -191,45 +589,98 @@ struct SensorTracker
         baselineBuffer.clear();
         baselineUpdateCount = 0;
         baselineReady = false;
+        present = false;
         threshold = 0;
         resetWave();
     }
 };
 
-class DirectionDetector
+template <typename Math, typename Profile = RuntimeDetectorProfile>
+class BasicDirectionDetector
 {
 private:
+    typedef typename Math::Value Value;
+    typedef typename Math::Sum Sum;
+    typedef BasicSensorTracker<Math> SensorTracker;
+
     DetectorConfig config;
     SensorTracker sensors[NUM_SENSORS];
 
+    // Config multipliers converted once per setConfig()
+    typename Math::Factor riseFactor;
+    typename Math::Factor exitFactor;
+
     const DeviceCalibration *_calibration = nullptr;
     bool _useCalibration = false;
 
     // Tracks which module last produced a detection (for telemetry)
     int _detectedModule = -1;
 
-    void updateSensorWave(SensorTracker &sensor, float smoothed, uint32_t timestamp);
+    // multiTransit: peak time (ms) of the last reported transit, so its late
+    // modules are not reported again
+    bool _haveTransit = false;
+    uint32_t _lastTransitPeakMs = 0;
+    uint32_t _lateModules = 0;
+
+    // Timestamp of the frame being processed (wave start / end stamps)
+    uint32_t _frameUs = 0;
+    // ...and the sample instant of the position being processed
+    uint32_t _sampleUs = 0;
+
+    void processSample(uint8_t position, uint16_t proximity, uint32_t timestampMs);
+    Value smoothedOf(const SensorTracker &sensor) const;
+    void updateSensorWave(SensorTracker &sensor, Value smoothed, uint32_t timestamp);
     void recalculateThreshold(SensorTracker &sensor, uint8_t position);
+    void updateFactors();
     bool isModuleDetected(int module) const;
+    bool findModulePair(int module, uint8_t &waveA, uint8_t &waveB) const;
+    uint32_t pairPeakTime(int module, uint8_t waveA, uint8_t waveB) const;
+    void dropLateModules();
 
 public:
-    DirectionDetector();
-    DirectionDetector(const DetectorConfig &cfg);
+    BasicDirectionDetector();
+    BasicDirectionDetector(const DetectorConfig &cfg);
 
-    void addReading(const SensorReading &reading);
-    void flushReading();
+    // Feed one polling cycle; every valid position is tracked independently
+    void addFrame(const SensorFrame &frame);
 
     bool hasDetection() const;
+    // With multiTransit, also consumes the reported pairs
     DetectionResult getResult();
+    bool isMultiTransit() const { return Profile::multiTransit(config); }
+    // multiTransit: module pairs folded into an already reported transit
+    uint32_t getLateModuleCount() const { return _lateModules; }
 
     void reset();
     void fullReset();
 
+    // Every sensor that has delivered a reading has its baseline
     bool isReady() const;
     DetectorState getState() const;
 
+    /**
+     * How close the most active sensor is to triggering: 0 at its baseline
+     * max, 1 at its threshold. 1 while any sensor is in (or just finished)
+     * a wave, or while baselines are still being established.
+     * Drives the adaptive sample rate (AdaptiveRateScheduler).
+     */
+    float getActivity() const;
+
     void setConfig(const DetectorConfig &cfg);
     void setCalibration(const DeviceCalibration *cal);
+
+    /**
+     * Last converged baseline of one sensor
+     * @return false while its baseline is still being established
+     */
+    bool getBaseline(uint8_t position, SensorBaseline &out) const;
+
+    /**
+     * Start one sensor from a stored baseline: it is ready at once, and the
+     * rolling baseline replaces the seeded values as readings arrive.
+     * Call after fullReset() (and setCalibration()).
+     */
+    void warmStart(uint8_t position, const SensorBaseline &baseline);
     bool isUsingCalibration() const { return _useCalibration; }
 
     // Per-sensor telemetry accessors
@@ -249,4 +700,30 @@ public:
     void debugPrint() const;
 };
 
+// All variants are instantiated in DirectionDetector.cpp; the firmware
+// uses the one selected here. DIRECTION_DETECTOR_STATIC_PROFILE pins the
+// ProductionDetectorProfile: smoothing_window, multi_transit and
+// skew_compensation from sensor_config are then ignored.
+#ifndef DIRECTION_DETECTOR_FIXED_POINT
+#define DIRECTION_DETECTOR_FIXED_POINT 0
+#endif
+#ifndef DIRECTION_DETECTOR_STATIC_PROFILE
+#define DIRECTION_DETECTOR_STATIC_PROFILE 0
+#endif
+
+typedef BasicDirectionDetector<FloatDetectorMath> FloatDirectionDetector;
+typedef BasicDirectionDetector<FixedDetectorMath> FixedDirectionDetector;
+typedef BasicDirectionDetector<FloatDetectorMath, ProductionDetectorProfile> StaticFloatDirectionDetector;
+typedef BasicDirectionDetector<FixedDetectorMath, ProductionDetectorProfile> StaticFixedDirectionDetector;
+
+#if DIRECTION_DETECTOR_FIXED_POINT && DIRECTION_DETECTOR_STATIC_PROFILE
+typedef StaticFixedDirectionDetector DirectionDetector;
+#elif DIRECTION_DETECTOR_FIXED_POINT
+typedef FixedDirectionDetector DirectionDetector;
+#elif DIRECTION_DETECTOR_STATIC_PROFILE
+typedef StaticFloatDirectionDetector DirectionDetector;
+#else
+typedef FloatDirectionDetector DirectionDetector;
+#endif
+
 #endif
@@ -0,0 +1,134 @@
+#include "LaneKernels.h"
+
+#if LANE_KERNELS_SIMD
+#include "dsps_mulc.h"
+#endif
+
+// Scratch for the vector multiply ahead of the scalar rounding (stack)
+static const size_t QUANTIZE_CHUNK = 64;
+
+static inline int8_t saturateInt8(int32_t q)
+{
+    return q < -128 ? -128 : (q > 127 ? 127 : (int8_t)q);
+}
+
+void LaneKernels::Scalar::scaleU16(const uint16_t *in, float *out, size_t n, float scale)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = (float)in[i] * scale;
+}
+
+void LaneKernels::Scalar::quantizeInt8(const float *in, int8_t *out, size_t n, float invScale, int32_t zeroPoint)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = saturateInt8((int32_t)lrintf(in[i] * invScale) + zeroPoint);
+}
+
+void LaneKernels::scaleU16(const uint16_t *in, float *out, size_t n, float scale)
+{
+#if LANE_KERNELS_SIMD
+    if (n >= LANE_KERNELS_SIMD_MIN)
+    {
+        for (size_t i = 0; i < n; i++)
+            out[i] = (float)in[i];
+        dsps_mulc_f32(out, out, (int)n, scale, 1, 1);
+        return;
+    }
+#endif
+    Scalar::scaleU16(in, out, n, scale);
+}
+
+void LaneKernels::quantizeInt8(const float *in, int8_t *out, size_t n, float invScale, int32_t zeroPoint)
+{
+#if LANE_KERNELS_SIMD
+    if (n >= LANE_KERNELS_SIMD_MIN)
+    {
+        float scaled[QUANTIZE_CHUNK];
+        for (size_t i = 0; i < n; i += QUANTIZE_CHUNK)
+        {
+            size_t len = min(n - i, QUANTIZE_CHUNK);
+            dsps_mulc_f32(in + i, scaled, (int)len, invScale, 1, 1);
+            for (size_t k = 0; k < len; k++)
+                out[i + k] = saturateInt8((int32_t)lrintf(scaled[k]) + zeroPoint);
+        }
+        return;
+    }
+#endif
+    Scalar::quantizeInt8(in, out, n, invScale, zeroPoint);
+}
+
+// ============================================================================
+// Microbenchmark
+// ============================================================================
+
+// One frame's readings, and MLDetector's input window (ML_WINDOW_MS x ML_NUM_POSITIONS)
+static const size_t BENCH_FRAME = 6;
+static const size_t BENCH_WINDOW = 300 * 6;
+
+template <typename Kernel>
+static float nsPerCall(Kernel kernel, uint32_t iterations)
+{
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < iterations; i++)
+        kernel();
+    return (micros() - start) * 1000.0f / iterations;
+}
+
+void LaneKernels::benchmark(JsonDocument &doc, uint32_t iterations)
+{
+    if (iterations == 0)
+        iterations = 1;
+
+    uint16_t *readings = (uint16_t *)malloc(BENCH_WINDOW * sizeof(uint16_t));
+    float *values = (float *)malloc(BENCH_WINDOW * sizeof(float));
+    float *reference = (float *)malloc(BENCH_WINDOW * sizeof(float));
+    int8_t *quantized = (int8_t *)malloc(BENCH_WINDOW);
+    int8_t *quantizedRef = (int8_t *)malloc(BENCH_WINDOW);
+    if (!readings || !values || !reference || !quantized || !quantizedRef)
+    {
+        doc["error"] = "out of memory";
+        free(readings);
+        free(values);
+        free(reference);
+        free(quantized);
+        free(quantizedRef);
+        return;
+    }
+
+    // Readings across the sensor range, normalized like the ML input
+    const float scale = 1.0f / 490.0f;
+    for (size_t i = 0; i < BENCH_WINDOW; i++)
+        readings[i] = (uint16_t)((i * 37) % 1024);
+
+    doc["vectorized"] = isVectorized();
+    doc["simd_min"] = LANE_KERNELS_SIMD_MIN;
+    doc["iterations"] = iterations;
+
+    const size_t sizes[2] = {BENCH_FRAME, BENCH_WINDOW};
+    const char *names[2] = {"frame", "window"};
+    for (int s = 0; s < 2; s++)
+    {
+        size_t n = sizes[s];
+        JsonObject row = doc.createNestedObject(names[s]);
+        row["n"] = n;
+
+        row["scale_scalar_ns"] = nsPerCall([&]() { Scalar::scaleU16(readings, reference, n, scale); }, iterations);
+        row["scale_ns"] = nsPerCall([&]() { scaleU16(readings, values, n, scale); }, iterations);
+        bool scaleMatch = memcmp(values, reference, n * sizeof(float)) == 0;
+
+        // Quantize the normalized values (typical int8 input scale)
+        const float invScale = 255.0f / 2.0f;
+        const int32_t zeroPoint = -128;
+        row["quantize_scalar_ns"] =
+            nsPerCall([&]() { Scalar::quantizeInt8(reference, quantizedRef, n, invScale, zeroPoint); }, iterations);
+        row["quantize_ns"] =
+            nsPerCall([&]() { quantizeInt8(reference, quantized, n, invScale, zeroPoint); }, iterations);
+        row["match"] = scaleMatch && memcmp(quantized, quantizedRef, n) == 0;
+    }
+
+    free(readings);
+    free(values);
+    free(reference);
+    free(quantized);
+    free(quantizedRef);
+}
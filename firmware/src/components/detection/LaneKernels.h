@@ -0,0 +1,68 @@
+#ifndef LANE_KERNELS_H
+#define LANE_KERNELS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * LaneKernels - Element-parallel kernels for the detectors' array work
+ *
+ * The per-sample heuristic path keeps O(1) state per sensor (running
+ * sums, monotonic deques, incremental center of mass) and has no array
+ * loop left to vectorize. The array work is on the ML side: normalizing
+ * each frame's readings and quantizing the 300 x 6 input window for an
+ * int8 model on every inference.
+ *
+ * - scaleU16(): readings x scale (a multiply by the reciprocal instead
+ *   of a float division per element)
+ * - quantizeInt8(): round(x x invScale) + zero point, saturated to int8
+ *
+ * With LANE_KERNELS_SIMD the float multiply goes through esp-dsp
+ * (dsps_mulc_f32, part of the Arduino-ESP32 SDK), whose ESP32-S3 build
+ * uses the vector/pipelined assembly kernels. Below LANE_KERNELS_SIMD_MIN
+ * elements the call costs more than it saves, so short arrays (one
+ * frame's six readings) always take the scalar loop. The Scalar variants
+ * are the reference and the fallback (host replay, other targets); both
+ * are IEEE single-precision multiplies and should give the same values,
+ * which benchmark() checks.
+ *
+ * benchmark() times both on the device ("bench_kernels" ->
+ * "kernel_bench" status).
+ */
+
+#ifndef LANE_KERNELS_SIMD
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && __has_include("dsps_mulc.h")
+#define LANE_KERNELS_SIMD 1
+#else
+#define LANE_KERNELS_SIMD 0
+#endif
+#endif
+
+// Shortest array worth an esp-dsp call
+#ifndef LANE_KERNELS_SIMD_MIN
+#define LANE_KERNELS_SIMD_MIN 32
+#endif
+
+class LaneKernels
+{
+public:
+    static void scaleU16(const uint16_t *in, float *out, size_t n, float scale);
+    static void quantizeInt8(const float *in, int8_t *out, size_t n, float invScale, int32_t zeroPoint);
+
+    // Reference implementations (and the fallback)
+    struct Scalar
+    {
+        static void scaleU16(const uint16_t *in, float *out, size_t n, float scale);
+        static void quantizeInt8(const float *in, int8_t *out, size_t n, float invScale, int32_t zeroPoint);
+    };
+
+    static bool isVectorized() { return LANE_KERNELS_SIMD; }
+
+    /**
+     * Time the dispatched kernels against Scalar at frame (6) and window
+     * (ML input) sizes; ns per call and whether the outputs matched
+     */
+    static void benchmark(JsonDocument &doc, uint32_t iterations);
+};
+
+#endif
@@ -1,5 +1,15 @@
 #include "MLDetector.h"
 #include "model_data.h"
+#include "LaneKernels.h"
+
+// model_data.h from before the model flags: forward-filled training windows
+#ifndef ML_MODEL_FLAGS
+#define ML_MODEL_FLAGS 0
+#endif
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include "../diagnostics/CycleProfiler.h"
+#include "../diagnostics/HeapTracker.h"
 
 // ============================================================================
 // Construction / Destruction
@@ -18,7 +28,13 @@ MLDetector::~MLDetector()
 
 void MLDetector::deinit()
 {
+    // Let an in-flight sliding window finish before tearing down the interpreter
+    while (inferenceBusy_)
+        vTaskDelay(1);
+
     modelReady_ = false;
+    int8Model_ = false;
+    maskInput_ = false;
     inputTensor_ = nullptr;
     outputTensor_ = nullptr;
 
@@ -34,10 +50,118 @@ void MLDetector::deinit()
     }
     if (tensorArena_)
     {
-        free(tensorArena_);
+        heap_caps_free(tensorArena_);
         tensorArena_ = nullptr;
     }
+    arenaInternal_ = false;
     model_ = nullptr;
+    if (modelMmap_)
+    {
+        spi_flash_munmap(modelMmap_);
+        modelMmap_ = 0;
+    }
+    modelSize_ = 0;
+    modelVersion_[0] = '\0';
+    modelFlags_ = 0;
+}
+
+// ============================================================================
+// Model source / arena placement
+// ============================================================================
+
+bool MLDetector::mapModelPartition()
+{
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ML_MODEL_PARTITION);
+    if (part == nullptr)
+        return false;
+
+    const void *mapped = nullptr;
+    spi_flash_mmap_handle_t handle;
+    if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &mapped, &handle) != ESP_OK)
+    {
+        Serial.printf("[MLDetector] WARNING: Cannot map partition '%s'\n", ML_MODEL_PARTITION);
+        return false;
+    }
+
+    // Erased or foreign contents fall back to the built-in model
+    const MLModelImageHeader *hdr = (const MLModelImageHeader *)mapped;
+    const uint8_t *data = (const uint8_t *)mapped + sizeof(MLModelImageHeader);
+    if (memcmp(hdr->magic, "MPML", 4) != 0 ||
+        hdr->length == 0 || hdr->length > part->size - sizeof(MLModelImageHeader))
+    {
+        Serial.printf("[MLDetector] Partition '%s' holds no model image\n", ML_MODEL_PARTITION);
+        spi_flash_munmap(handle);
+        return false;
+    }
+    if (esp_rom_crc32_le(0, data, hdr->length) != hdr->crc32)
+    {
+        Serial.printf("[MLDetector] WARNING: Model image in '%s' failed CRC check\n", ML_MODEL_PARTITION);
+        spi_flash_munmap(handle);
+        return false;
+    }
+
+    model_ = tflite::GetModel(data);
+    modelMmap_ = handle;
+    modelSize_ = hdr->length;
+    modelFlags_ = hdr->flags;
+    strlcpy(modelVersion_, hdr->version, sizeof(modelVersion_));
+    Serial.printf("[MLDetector] Model mapped from partition '%s' at 0x%lx\n",
+                  ML_MODEL_PARTITION, (unsigned long)part->address);
+    return true;
+}
+
+bool MLDetector::loadModel()
+{
+    if (!mapModelPartition())
+    {
+        // Built-in model from model_data.h (linked into flash, read in place)
+        model_ = tflite::GetModel(direction_model_tflite);
+        modelSize_ = direction_model_tflite_len;
+        modelFlags_ = ML_MODEL_FLAGS;
+#ifdef ML_MODEL_VERSION
+        strlcpy(modelVersion_, ML_MODEL_VERSION, sizeof(modelVersion_));
+#endif
+    }
+    return model_ != nullptr;
+}
+
+bool MLDetector::allocateArena()
+{
+    const uint32_t internalCaps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const uint32_t psramCaps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+#if ML_ARENA_PLACEMENT == 0
+    if (heap_caps_get_free_size(internalCaps) >= ML_TENSOR_ARENA_SIZE + ML_ARENA_INTERNAL_RESERVE &&
+        heap_caps_get_largest_free_block(internalCaps) >= ML_TENSOR_ARENA_SIZE)
+    {
+        tensorArena_ = (uint8_t *)HeapTracker::alloc(HeapTag::ML, ML_TENSOR_ARENA_SIZE, internalCaps);
+    }
+    arenaInternal_ = tensorArena_ != nullptr;
+    if (tensorArena_ == nullptr)
+        tensorArena_ = (uint8_t *)HeapTracker::alloc(HeapTag::ML, ML_TENSOR_ARENA_SIZE, psramCaps);
+#elif ML_ARENA_PLACEMENT == 1
+    tensorArena_ = (uint8_t *)HeapTracker::alloc(HeapTag::ML, ML_TENSOR_ARENA_SIZE, psramCaps);
+    if (tensorArena_ == nullptr)
+    {
+        Serial.println("[MLDetector] WARNING: PSRAM unavailable for tensor arena, trying SRAM");
+        tensorArena_ = (uint8_t *)HeapTracker::alloc(HeapTag::ML, ML_TENSOR_ARENA_SIZE, internalCaps);
+        arenaInternal_ = tensorArena_ != nullptr;
+    }
+#else
+    tensorArena_ = (uint8_t *)HeapTracker::alloc(HeapTag::ML, ML_TENSOR_ARENA_SIZE, internalCaps);
+    arenaInternal_ = tensorArena_ != nullptr;
+#endif
+
+    if (tensorArena_ == nullptr)
+    {
+        Serial.printf("[MLDetector] ERROR: Failed to allocate %u byte tensor arena\n", ML_TENSOR_ARENA_SIZE);
+        return false;
+    }
+
+    Serial.printf("[MLDetector] Tensor arena: %u bytes in %s\n",
+                  ML_TENSOR_ARENA_SIZE, arenaInternal_ ? "internal SRAM" : "PSRAM");
+    return true;
 }
 
 // ============================================================================
@@ -51,11 +175,11 @@ bool MLDetector::init()
 
     Serial.println("[MLDetector] Initializing TFLite Micro...");
 
-    // Load model from flash
-    model_ = tflite::GetModel(direction_model_tflite);
-    if (model_ == nullptr)
+    // Load model (model partition if flashed, else built-in)
+    if (!loadModel())
     {
         Serial.println("[MLDetector] ERROR: Failed to load model");
+        deinit();
         return false;
     }
 
@@ -63,28 +187,16 @@ bool MLDetector::init()
     {
         Serial.printf("[MLDetector] ERROR: Model schema version %lu != expected %d\n",
                       model_->version(), TFLITE_SCHEMA_VERSION);
+        deinit();
         return false;
     }
     Serial.printf("[MLDetector] Model loaded (%u bytes, schema v%lu)\n",
-                  direction_model_tflite_len, model_->version());
+                  modelSize_, model_->version());
 
-    // Allocate tensor arena in PSRAM
-    tensorArena_ = (uint8_t *)ps_malloc(ML_TENSOR_ARENA_SIZE);
-    if (tensorArena_ == nullptr)
-    {
-        Serial.println("[MLDetector] ERROR: Failed to allocate tensor arena in PSRAM");
-        // Fallback to regular malloc
-        tensorArena_ = (uint8_t *)malloc(ML_TENSOR_ARENA_SIZE);
-        if (tensorArena_ == nullptr)
-        {
-            Serial.println("[MLDetector] ERROR: Failed to allocate tensor arena");
-            return false;
-        }
-        Serial.println("[MLDetector] WARNING: Tensor arena allocated in SRAM (PSRAM unavailable)");
-    }
-    else
+    if (!allocateArena())
     {
-        Serial.printf("[MLDetector] Tensor arena: %u bytes in PSRAM\n", ML_TENSOR_ARENA_SIZE);
+        deinit();
+        return false;
     }
 
     // Register required ops (heap-allocated so init() is safely re-callable)
@@ -129,119 +241,133 @@ bool MLDetector::init()
     }
     Serial.printf("), type=%d\n", outputTensor_->type);
 
+    // Float32 or full-int8 I/O; hybrid or mixed types are not supported
+    const bool floatIO = inputTensor_->type == kTfLiteFloat32 && outputTensor_->type == kTfLiteFloat32;
+    int8Model_ = inputTensor_->type == kTfLiteInt8 && outputTensor_->type == kTfLiteInt8;
+    if (!floatIO && !int8Model_)
+    {
+        Serial.printf("[MLDetector] ERROR: Unsupported tensor types (input=%d, output=%d)\n",
+                      inputTensor_->type, outputTensor_->type);
+        deinit();
+        return false;
+    }
+
+    // (1, window, 6) proximity only, or (1, window, 12) with the mask channels
+    int channels = inputTensor_->dims->data[inputTensor_->dims->size - 1];
+    if (channels != ML_NUM_POSITIONS && channels != 2 * ML_NUM_POSITIONS)
+    {
+        Serial.printf("[MLDetector] ERROR: Unsupported input channels %d\n", channels);
+        deinit();
+        return false;
+    }
+    maskInput_ = channels == 2 * ML_NUM_POSITIONS;
+
+    if (int8Model_)
+    {
+        if (inputTensor_->params.scale <= 0.0f || outputTensor_->params.scale <= 0.0f)
+        {
+            Serial.println("[MLDetector] ERROR: int8 model is missing quantization parameters");
+            deinit();
+            return false;
+        }
+        inputInvScale_ = 1.0f / inputTensor_->params.scale;
+        inputZeroPoint_ = inputTensor_->params.zero_point;
+        outputScale_ = outputTensor_->params.scale;
+        outputZeroPoint_ = outputTensor_->params.zero_point;
+        const float maskValues[2] = {0.0f, 1.0f};
+        LaneKernels::quantizeInt8(maskValues, maskQuantized_, 2, inputInvScale_, inputZeroPoint_);
+        Serial.printf("[MLDetector] int8 model: input scale=%.6f zp=%ld, output scale=%.6f zp=%ld\n",
+                      inputTensor_->params.scale, (long)inputZeroPoint_,
+                      outputScale_, (long)outputZeroPoint_);
+    }
+
     Serial.printf("[MLDetector] Arena used: %u / %u bytes\n",
                   interpreter_->arena_used_bytes(), ML_TENSOR_ARENA_SIZE);
 
+    MLResampling resampling = (modelFlags_ & ML_MODEL_FLAG_LINEAR) ? MLResampling::LINEAR : MLResampling::HOLD;
+    if (resampling != resampling_)
+        setResampling(resampling);
+
     modelReady_ = true;
-#ifdef ML_MODEL_VERSION
-    Serial.printf("[MLDetector] Model version: %s\n", ML_MODEL_VERSION);
-#endif
+    if (modelVersion_[0] != '\0')
+        Serial.printf("[MLDetector] Model version: %s\n", modelVersion_);
+    Serial.printf("[MLDetector] Input: %s resampling%s\n", resamplingName(resampling_),
+                  maskInput_ ? ", validity mask channels" : "");
     Serial.println("[MLDetector] Initialization complete");
     return true;
 }
 
-// ============================================================================
-// Ring buffer
-// ============================================================================
-
-void MLDetector::pushFrame(const MLSensorFrame &frame)
-{
-    ringBuffer_[ringHead_] = frame;
-    ringHead_ = (ringHead_ + 1) % RING_BUFFER_SIZE;
-    if (ringCount_ < RING_BUFFER_SIZE)
-        ringCount_++;
-}
-
 // ============================================================================
 // Smoothing
 // ============================================================================
 
 void MLDetector::pushSmooth(float a, float b)
 {
-    smoothBufferA_[smoothHead_] = a;
-    smoothBufferB_[smoothHead_] = b;
-    smoothHead_ = (smoothHead_ + 1) % SMOOTH_BUFFER_SIZE;
-    if (smoothCount_ < SMOOTH_BUFFER_SIZE)
-        smoothCount_++;
+    smoothA_.push(a);
+    smoothB_.push(b);
 }
 
 float MLDetector::getSmoothedA() const
 {
-    if (smoothCount_ == 0)
+    if (smoothA_.empty())
         return 0;
-    size_t n = min((size_t)3, smoothCount_); // window of 3
     float sum = 0;
-    for (size_t i = 0; i < n; i++)
-    {
-        size_t idx = (smoothHead_ - 1 - i + SMOOTH_BUFFER_SIZE) % SMOOTH_BUFFER_SIZE;
-        sum += smoothBufferA_[idx];
-    }
-    return sum / n;
+    for (size_t i = 0; i < smoothA_.size(); i++)
+        sum += smoothA_[i];
+    return sum / smoothA_.size();
 }
 
 float MLDetector::getSmoothedB() const
 {
-    if (smoothCount_ == 0)
+    if (smoothB_.empty())
         return 0;
-    size_t n = min((size_t)3, smoothCount_);
     float sum = 0;
-    for (size_t i = 0; i < n; i++)
-    {
-        size_t idx = (smoothHead_ - 1 - i + SMOOTH_BUFFER_SIZE) % SMOOTH_BUFFER_SIZE;
-        sum += smoothBufferB_[idx];
-    }
-    return sum / n;
+    for (size_t i = 0; i < smoothB_.size(); i++)
+        sum += smoothB_[i];
+    return sum / smoothB_.size();
 }
 
 // ============================================================================
-// Sensor reading ingestion (same pattern as DirectionDetector)
+// Frame ingestion (same pattern as DirectionDetector)
 // ============================================================================
 
-void MLDetector::addReading(const SensorReading &reading)
+void MLDetector::addFrame(const SensorFrame &sensorFrame)
 {
-    uint32_t timestampMs = reading.timestamp_us / 1000;
-
-    // New timestamp? Flush the previous aggregated reading.
-    if (hasCurrentReading_ && timestampMs != currentTimestamp_)
-    {
-        flushReading();
-    }
-
-    currentTimestamp_ = timestampMs;
+    currentTimestamp_ = sensorFrame.timestamp_us / 1000;
+    currentTimestampUs_ = sensorFrame.timestamp_us;
 
-    // Store per-position proximity
-    if (reading.position < ML_NUM_POSITIONS)
-    {
-        currentProximity_[reading.position] = reading.proximity;
-    }
-
-    hasCurrentReading_ = true;
-}
-
-void MLDetector::flushReading()
-{
-    if (!hasCurrentReading_)
-        return;
-
-    // Build frame
+    // Frame layout already matches the model input - no regrouping needed
     MLSensorFrame frame;
     frame.timestamp_ms = currentTimestamp_;
-    for (uint8_t i = 0; i < ML_NUM_POSITIONS; i++)
+    frame.timestamp_us = currentTimestampUs_;
+    memcpy(frame.proximity, sensorFrame.proximity, sizeof(frame.proximity));
+    for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
+        frame.offset_us[p] = sensorFrame.offsetUs(p);
+
+    // duplicate_mode "suppress": a held position read its last value again,
+    // so the input (and the side sums below) stay what they were unsuppressed
+    for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
     {
-        frame.proximity[i] = currentProximity_[i];
+        if (sensorFrame.held_mask & (1 << p))
+            frame.proximity[p] = heldProximity_[p];
+        else if (sensorFrame.isValid(p))
+            heldProximity_[p] = frame.proximity[p];
     }
     pushFrame(frame);
 
     // Compute side aggregates for baseline/threshold (same convention as DirectionDetector)
     // Side A (side==2): positions 1, 3, 5 (S2 sensors)
     // Side B (side==1): positions 0, 2, 4 (S1 sensors)
-    float sideA = (float)(currentProximity_[1] + currentProximity_[3] + currentProximity_[5]);
-    float sideB = (float)(currentProximity_[0] + currentProximity_[2] + currentProximity_[4]);
+    float sideA = (float)(frame.proximity[1] + frame.proximity[3] + frame.proximity[5]);
+    float sideB = (float)(frame.proximity[0] + frame.proximity[2] + frame.proximity[4]);
 
     pushSmooth(sideA, sideB);
     float smoothedA = getSmoothedA();
     float smoothedB = getSmoothedB();
 
+    if (state_ != State::ESTABLISHING_BASELINE)
+        trackOnset(smoothedA, smoothedB);
+
     // State machine
     switch (state_)
     {
@@ -250,6 +376,13 @@ void MLDetector::flushReading()
         break;
 
     case State::READY:
+        if (mode_ == MLInferenceMode::SLIDING)
+        {
+            serviceSlidingWindow();
+            break;
+        }
+        if (mode_ == MLInferenceMode::ON_DEMAND)
+            break;
         if (checkTrigger(smoothedA, smoothedB))
         {
             state_ = State::TRIGGERED;
@@ -268,7 +401,7 @@ void MLDetector::flushReading()
             {
                 waitingPostTrigger_ = false;
                 // Run inference
-                if (modelReady_ && ringCount_ >= 100) // need at least ~100 frames
+                if (modelReady_ && getFrameCount() >= 100) // need at least ~100 frames
                 {
                     unsigned long t0 = micros();
                     bool detected = runInference();
@@ -278,12 +411,13 @@ void MLDetector::flushReading()
                     if (detected)
                     {
                         lastDetectionTime_ = currentTimestamp_;
+                        stampResult(currentTimestampUs_);
                     }
                 }
                 else
                 {
                     Serial.printf("[MLDetector] Skipping inference: modelReady=%d, frames=%u\n",
-                                  modelReady_, ringCount_);
+                                  modelReady_, getFrameCount());
                 }
                 // Return to READY (cooldown enforced in checkTrigger)
                 state_ = State::READY;
@@ -291,13 +425,150 @@ void MLDetector::flushReading()
         }
         break;
     }
+}
 
-    // Reset current reading accumulators
-    for (uint8_t i = 0; i < ML_NUM_POSITIONS; i++)
+// ============================================================================
+// Input grid
+// ============================================================================
+
+void MLDetector::pushFrame(const MLSensorFrame &frame)
+{
+    // Resample onto the 1ms grid as frames arrive; row m describes the
+    // instant m ms and a zero reading is missing. A ms without a frame first
+    // repeats the previous row, and a later frame in the same ms updates its
+    // row. Then each reading is placed:
+    // - HOLD (matching forward-filled training windows): the position keeps
+    //   the reading until the next one. A reading with a sample offset
+    //   (skew_compensation) is interpolated back to the frame instant from
+    //   the position's previous reading.
+    // - LINEAR: the rows since the position's previous reading are rewritten
+    //   by interpolating between the two sample instants, so a slow or
+    //   skipped cycle gives a ramp instead of a step. Readings more than
+    //   ML_RESAMPLE_MAX_GAP_MS apart are not bridged.
+    // maskGrid_ marks the values backed by a reading at most
+    // ML_RESAMPLE_MAX_GAP_MS away (the model's mask channels, if it has them).
+    if (!inputGrid_.empty() && frame.timestamp_ms < lastRowTime_)
     {
-        currentProximity_[i] = 0;
+        // Timestamps went backwards (new session): start the grid over
+        clearGrid();
     }
-    hasCurrentReading_ = false;
+
+    if (inputGrid_.empty() || frame.timestamp_ms != lastRowTime_)
+    {
+        if (!inputGrid_.empty())
+        {
+            // Only the newest ML_WINDOW_MS rows matter, so long gaps are capped
+            uint32_t gap = frame.timestamp_ms - lastRowTime_ - 1;
+            if (gap > ML_WINDOW_MS)
+                gap = ML_WINDOW_MS;
+            for (uint32_t i = gap; i > 0; i--)
+                pushHeldRow(frame.timestamp_ms - i);
+        }
+        pushHeldRow(frame.timestamp_ms);
+        lastRowTime_ = frame.timestamp_ms;
+    }
+
+    float normalized[ML_NUM_POSITIONS];
+    LaneKernels::scaleU16(frame.proximity, normalized, ML_NUM_POSITIONS, ML_NORMALIZATION_SCALE);
+
+    const uint32_t maxGapUs = ML_RESAMPLE_MAX_GAP_MS * 1000;
+    GridRow &row = inputGrid_.back();
+    uint8_t &mask = maskGrid_.back();
+    for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
+    {
+        if (frame.proximity[p] == 0)
+            continue;
+
+        float value = normalized[p];
+        uint32_t sampleUs = frame.timestamp_us + frame.offset_us[p];
+        PositionSample &last = lastSample_[p];
+        bool bridged = last.seen && (int32_t)(sampleUs - last.us) > 0 && sampleUs - last.us <= maxGapUs;
+
+        if (resampling_ == MLResampling::LINEAR)
+        {
+            if (bridged)
+                interpolateBack(p, last, sampleUs, value);
+            else
+                row.values[p] = value;
+            lastRow_.values[p] = value;
+        }
+        else
+        {
+            if (frame.offset_us[p] != 0 && last.seen && (int32_t)(frame.timestamp_us - last.us) > 0)
+            {
+                float t = (float)(frame.timestamp_us - last.us) / (float)(sampleUs - last.us);
+                lastRow_.values[p] = last.value + (value - last.value) * t;
+            }
+            else
+            {
+                lastRow_.values[p] = value;
+            }
+            row.values[p] = lastRow_.values[p];
+        }
+        mask |= 1 << p;
+
+        last.seen = true;
+        last.us = sampleUs;
+        last.value = value;
+    }
+
+    if (frameCount_ < UINT32_MAX)
+        frameCount_++;
+}
+
+void MLDetector::pushHeldRow(uint32_t rowMs)
+{
+    // Held values; a position counts as valid while its reading is fresh
+    const uint32_t rowUs = rowMs * 1000;
+    uint8_t mask = 0;
+    for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
+    {
+        const PositionSample &last = lastSample_[p];
+        if (last.seen && (int32_t)(rowUs - last.us) <= (int32_t)(ML_RESAMPLE_MAX_GAP_MS * 1000))
+            mask |= 1 << p;
+    }
+    inputGrid_.push(lastRow_);
+    maskGrid_.push(mask);
+}
+
+void MLDetector::interpolateBack(uint8_t pos, const PositionSample &from, uint32_t toUs, float toValue)
+{
+    // Newest row first, back to the first row after the previous reading
+    // (at most ML_RESAMPLE_MAX_GAP_MS + 1 rows). The newest row's instant is
+    // never after toUs: sample offsets are >= 0.
+    const float span = (float)(toUs - from.us);
+    for (size_t k = 0; k < inputGrid_.size(); k++)
+    {
+        uint32_t rowUs = (lastRowTime_ - k) * 1000;
+        int32_t sinceFrom = (int32_t)(rowUs - from.us);
+        if (sinceFrom <= 0)
+            break;
+        size_t idx = inputGrid_.size() - 1 - k;
+        inputGrid_[idx].values[pos] = from.value + (toValue - from.value) * (sinceFrom / span);
+        maskGrid_[idx] |= 1 << pos;
+    }
+}
+
+void MLDetector::clearGrid()
+{
+    inputGrid_.clear();
+    maskGrid_.clear();
+    lastRow_ = GridRow();
+    lastRowTime_ = 0;
+    memset(lastSample_, 0, sizeof(lastSample_));
+    memset(heldProximity_, 0, sizeof(heldProximity_));
+}
+
+void MLDetector::setResampling(MLResampling resampling)
+{
+    resampling_ = resampling;
+    clearGrid();
+    frameCount_ = 0;
+}
+
+const char *MLDetector::resamplingName(MLResampling resampling)
+{
+    return resampling == MLResampling::LINEAR ? "linear" : "hold";
 }
 
 // ============================================================================
@@ -350,107 +621,179 @@ bool MLDetector::checkTrigger(float sideA, float sideB)
     return (sideA > thresholdA_ || sideB > thresholdB_);
 }
 
+void MLDetector::trackOnset(float sideA, float sideB)
+{
+    if (sideA > thresholdA_ || sideB > thresholdB_)
+    {
+        if (onsetUs_ == 0)
+            onsetUs_ = currentTimestampUs_;
+    }
+    else if (onsetUs_ != 0 && currentTimestampUs_ - onsetUs_ > ML_WINDOW_MS * 1000UL)
+    {
+        // The crossing has left the input window without a detection
+        onsetUs_ = 0;
+    }
+}
+
+void MLDetector::stampResult(uint32_t windowEndUs)
+{
+    lastResult_.firstCrossingUs = onsetUs_;
+    lastResult_.waveCompleteUs = windowEndUs;
+    onsetUs_ = 0;
+}
+
 // ============================================================================
 // Inference
 // ============================================================================
 
 void MLDetector::prepareInput()
 {
-    // Build a (ML_WINDOW_MS, ML_NUM_POSITIONS) matrix from the ring buffer.
-    // Strategy: take the most recent ML_WINDOW_MS worth of data,
-    // resample to 1ms grid with forward-fill (matching training preprocessing).
+    uint32_t start = micros();
+    if (maskInput_)
+        prepareInputMasked();
+    else if (int8Model_)
+        prepareInputInt8();
+    else
+        prepareInputFloat();
+
+    uint32_t elapsedUs = micros() - start;
+    prepareCount_++;
+    prepareTotalUs_ += elapsedUs;
+    if (elapsedUs > prepareMaxUs_)
+        prepareMaxUs_ = elapsedUs;
+}
 
+void MLDetector::prepareInputFloat()
+{
+    // The grid already holds the newest ML_WINDOW_MS rows in input layout;
+    // copy them out oldest first. Rows before the first frame since reset
+    // stay zero (same as the window start before a full window exists).
     float *input = inputTensor_->data.f;
-    const size_t totalElements = ML_WINDOW_MS * ML_NUM_POSITIONS;
-    memset(input, 0, totalElements * sizeof(float));
+    const size_t rowBytes = sizeof(GridRow);
+    size_t missing = ML_WINDOW_MS - inputGrid_.size();
 
-    if (ringCount_ == 0)
-        return;
+    memset(input, 0, missing * rowBytes);
+    input += missing * ML_NUM_POSITIONS;
 
-    // Find the start frame: we want up to ML_WINDOW_MS of data ending at the latest frame.
-    // Walk backwards from the newest frame to find the time range.
-    size_t newest = (ringHead_ - 1 + RING_BUFFER_SIZE) % RING_BUFFER_SIZE;
-    uint32_t endTime = ringBuffer_[newest].timestamp_ms;
-    uint32_t startTime = (endTime >= ML_WINDOW_MS) ? endTime - ML_WINDOW_MS + 1 : 0;
+    InputGrid::Segments seg = inputGrid_.segments();
+    memcpy(input, seg.first.data, seg.first.length * rowBytes);
+    input += seg.first.length * ML_NUM_POSITIONS;
+    memcpy(input, seg.second.data, seg.second.length * rowBytes);
+}
 
-    // Forward-fill: iterate through ring buffer frames in order, place into the 1ms grid.
-    // We need to iterate from oldest to newest.
-    size_t oldest = (ringCount_ < RING_BUFFER_SIZE)
-                        ? 0
-                        : ringHead_;
+void MLDetector::prepareInputInt8()
+{
+    // Same layout as prepareInputFloat(), quantized on the way out:
+    // q = round(x / scale) + zero_point, saturated to int8
+    int8_t *input = inputTensor_->data.int8;
+    size_t missing = ML_WINDOW_MS - inputGrid_.size();
 
-    float lastVal[ML_NUM_POSITIONS] = {0};
+    memset(input, (int8_t)inputZeroPoint_, missing * ML_NUM_POSITIONS); // quantized 0.0
+    input += missing * ML_NUM_POSITIONS;
 
-    for (size_t i = 0; i < ringCount_; i++)
-    {
-        size_t idx = (oldest + i) % RING_BUFFER_SIZE;
-        const MLSensorFrame &frame = ringBuffer_[idx];
+    InputGrid::Segments seg = inputGrid_.segments();
+    const InputGrid::Span spans[2] = {seg.first, seg.second};
 
-        if (frame.timestamp_ms < startTime)
-        {
-            // Before our window, but update lastVal for forward-fill
-            for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
-            {
-                if (frame.proximity[p] > 0)
-                    lastVal[p] = (float)frame.proximity[p];
-            }
+    for (const InputGrid::Span &span : spans)
+    {
+        if (span.length == 0)
             continue;
-        }
-        if (frame.timestamp_ms > endTime)
-            break;
+        size_t n = span.length * ML_NUM_POSITIONS;
+        LaneKernels::quantizeInt8(span.data[0].values, input, n, inputInvScale_, inputZeroPoint_);
+        input += n;
+    }
+}
 
-        uint32_t t = frame.timestamp_ms - startTime;
-        if (t < ML_WINDOW_MS)
+void MLDetector::prepareInputMasked()
+{
+    // Per timestep: the 6 values, then the 6 mask bits as 0.0 / 1.0.
+    // Rows before the first frame are all zero (values and mask).
+    const size_t channels = 2 * ML_NUM_POSITIONS;
+    size_t missing = ML_WINDOW_MS - inputGrid_.size();
+
+    if (int8Model_)
+    {
+        int8_t *input = inputTensor_->data.int8;
+        memset(input, (int8_t)inputZeroPoint_, missing * channels);
+        input += missing * channels;
+        for (size_t i = 0; i < inputGrid_.size(); i++)
         {
+            LaneKernels::quantizeInt8(inputGrid_[i].values, input, ML_NUM_POSITIONS, inputInvScale_, inputZeroPoint_);
+            input += ML_NUM_POSITIONS;
+            uint8_t mask = maskGrid_[i];
             for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
-            {
-                float val = (float)frame.proximity[p];
-                if (val > 0)
-                    lastVal[p] = val;
-                input[t * ML_NUM_POSITIONS + p] = lastVal[p] / ML_NORMALIZATION_MAX;
-            }
+                *input++ = maskQuantized_[(mask >> p) & 1];
         }
+        return;
     }
 
-    // Forward-fill gaps: for each ms without a frame, propagate from previous ms.
-    for (uint32_t t = 1; t < ML_WINDOW_MS; t++)
+    float *input = inputTensor_->data.f;
+    memset(input, 0, missing * channels * sizeof(float));
+    input += missing * channels;
+    for (size_t i = 0; i < inputGrid_.size(); i++)
     {
+        memcpy(input, inputGrid_[i].values, sizeof(GridRow));
+        input += ML_NUM_POSITIONS;
+        uint8_t mask = maskGrid_[i];
         for (uint8_t p = 0; p < ML_NUM_POSITIONS; p++)
-        {
-            size_t curIdx = t * ML_NUM_POSITIONS + p;
-            if (input[curIdx] == 0.0f)
-            {
-                size_t prevIdx = (t - 1) * ML_NUM_POSITIONS + p;
-                input[curIdx] = input[prevIdx];
-            }
-        }
+            *input++ = (mask >> p) & 1 ? 1.0f : 0.0f;
     }
 }
 
+float MLDetector::readOutput(int index) const
+{
+    if (int8Model_)
+        return (outputTensor_->data.int8[index] - outputZeroPoint_) * outputScale_;
+    return outputTensor_->data.f[index];
+}
+
+bool MLDetector::invokeModel(float probs[3])
+{
+    TfLiteStatus status;
+    {
+        PROFILE_SCOPE(ProfileSpan::ML_INFERENCE);
+        status = interpreter_->Invoke();
+    }
+    if (status != kTfLiteOk)
+    {
+        Serial.println("[MLDetector] ERROR: Inference failed");
+        return false;
+    }
+
+    // Softmax [a_to_b, b_to_a, no_transit]
+    for (int i = 0; i < 3; i++)
+        probs[i] = readOutput(i);
+    return true;
+}
+
 bool MLDetector::runInference()
 {
-    if (!modelReady_ || interpreter_ == nullptr)
+    // inferenceBusy_: a sliding window is still running on the inference task
+    if (!modelReady_ || interpreter_ == nullptr || inferenceBusy_)
         return false;
 
     // Prepare input tensor
     prepareInput();
 
     // Run inference
-    TfLiteStatus status = interpreter_->Invoke();
-    if (status != kTfLiteOk)
-    {
-        Serial.println("[MLDetector] ERROR: Inference failed");
+    float probs[3];
+    unsigned long t0 = micros();
+    bool ok = invokeModel(probs);
+    recordInferenceTime(micros() - t0);
+    if (!ok)
         return false;
-    }
-
-    // Parse output: softmax [a_to_b, b_to_a, no_transit]
-    float *output = outputTensor_->data.f;
-    float confA2B = output[0];
-    float confB2A = output[1];
-    float confNoTransit = output[2];
 
     Serial.printf("[MLDetector] Output: A_TO_B=%.3f, B_TO_A=%.3f, NO_TRANSIT=%.3f\n",
-                  confA2B, confB2A, confNoTransit);
+                  probs[0], probs[1], probs[2]);
+
+    return classify(probs, true);
+}
+
+bool MLDetector::classify(const float probs[3], bool verbose)
+{
+    float confA2B = probs[0];
+    float confB2A = probs[1];
+    float confNoTransit = probs[2];
 
     // Find the winning class
     float maxConf = confNoTransit;
@@ -470,14 +813,16 @@ bool MLDetector::runInference()
     // Only report transit detections above confidence threshold
     if (bestClass == MLClass::NO_TRANSIT)
     {
-        Serial.println("[MLDetector] Classification: NO_TRANSIT");
+        if (verbose)
+            Serial.println("[MLDetector] Classification: NO_TRANSIT");
         return false;
     }
 
     if (maxConf < ML_CONFIDENCE_THRESHOLD)
     {
-        Serial.printf("[MLDetector] Confidence %.3f below threshold %.3f\n",
-                      maxConf, ML_CONFIDENCE_THRESHOLD);
+        if (verbose)
+            Serial.printf("[MLDetector] Confidence %.3f below threshold %.3f\n",
+                          maxConf, ML_CONFIDENCE_THRESHOLD);
         return false;
     }
 
@@ -499,6 +844,195 @@ bool MLDetector::runInference()
     return true;
 }
 
+void MLDetector::recordInferenceTime(uint32_t elapsedUs)
+{
+    inferenceCount_++;
+    inferenceLastUs_ = elapsedUs;
+    inferenceTotalUs_ += elapsedUs;
+    if (elapsedUs > inferenceMaxUs_)
+        inferenceMaxUs_ = elapsedUs;
+}
+
+MLInferenceStats MLDetector::getInferenceStats() const
+{
+    MLInferenceStats stats;
+    stats.count = inferenceCount_;
+    stats.skippedWindows = skippedWindows_;
+    stats.lastUs = inferenceLastUs_;
+    stats.maxUs = inferenceMaxUs_;
+    stats.avgUs = inferenceCount_ ? (uint32_t)(inferenceTotalUs_ / inferenceCount_) : 0;
+    stats.prepareAvgUs = prepareCount_ ? (uint32_t)(prepareTotalUs_ / prepareCount_) : 0;
+    stats.prepareMaxUs = prepareMaxUs_;
+    return stats;
+}
+
+// ============================================================================
+// Sliding-window inference
+// ============================================================================
+
+bool MLDetector::setInferenceMode(MLInferenceMode mode, uint16_t strideMs)
+{
+    if (strideMs < ML_SLIDING_MIN_STRIDE_MS)
+        strideMs = ML_SLIDING_MIN_STRIDE_MS;
+    strideMs_ = strideMs;
+
+    if (mode == MLInferenceMode::SLIDING && inferenceTask_ == nullptr)
+    {
+        inferenceResults_ = xQueueCreate(2, sizeof(MLWindowOutput));
+        if (inferenceResults_ == nullptr)
+        {
+            Serial.println("[MLDetector] ERROR: Inference result queue creation failed");
+            return false;
+        }
+
+        // Core 0 below the sensor task (priority 2): inference fills the
+        // gaps between sampling cycles and never delays a read
+        BaseType_t created = xTaskCreatePinnedToCore(
+            inferenceTaskFunction,
+            "MLInference",
+            4096,
+            this,
+            1,
+            &inferenceTask_,
+            0);
+        if (created != pdPASS)
+        {
+            Serial.println("[MLDetector] ERROR: Inference task creation failed");
+            vQueueDelete(inferenceResults_);
+            inferenceResults_ = nullptr;
+            inferenceTask_ = nullptr;
+            return false;
+        }
+    }
+
+    if (mode != mode_)
+    {
+        mode_ = mode;
+        slidingWindows_.clear();
+        nextWindowMs_ = 0;
+        generation_++;
+        Serial.printf("[MLDetector] Inference mode: %s (stride %u ms)\n",
+                      inferenceModeName(mode_), strideMs_);
+    }
+    return true;
+}
+
+const char *MLDetector::inferenceModeName(MLInferenceMode mode)
+{
+    switch (mode)
+    {
+    case MLInferenceMode::SLIDING:
+        return "sliding";
+    case MLInferenceMode::ON_DEMAND:
+        return "on_demand";
+    default:
+        return "triggered";
+    }
+}
+
+void MLDetector::inferenceTaskFunction(void *parameter)
+{
+    static_cast<MLDetector *>(parameter)->runInferenceTask();
+}
+
+void MLDetector::runInferenceTask()
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // The loop task filled the input tensor before notifying and leaves
+        // the interpreter alone until inferenceBusy_ clears
+        MLWindowOutput out;
+        out.generation = windowGeneration_;
+        out.endUs = windowEndUs_;
+        unsigned long t0 = micros();
+        out.ok = invokeModel(out.probs);
+        out.elapsedUs = micros() - t0;
+
+        xQueueSend(inferenceResults_, &out, 0);
+        inferenceBusy_ = false;
+    }
+}
+
+void MLDetector::serviceSlidingWindow()
+{
+    // Collect finished windows (results from before a reset are stale)
+    MLWindowOutput out;
+    while (xQueueReceive(inferenceResults_, &out, 0) == pdTRUE)
+    {
+        recordInferenceTime(out.elapsedUs);
+        if (out.ok && out.generation == generation_)
+            aggregateWindow(out);
+    }
+
+    if (!modelReady_ || !inputGrid_.isFull())
+        return;
+    if ((int32_t)(currentTimestamp_ - nextWindowMs_) < 0)
+        return;
+    nextWindowMs_ = currentTimestamp_ + strideMs_;
+
+    if (inferenceBusy_)
+    {
+        // Previous window still running: the stride is shorter than inference
+        skippedWindows_++;
+        return;
+    }
+
+    prepareInput();
+    windowGeneration_ = generation_;
+    windowEndUs_ = currentTimestampUs_;
+    inferenceBusy_ = true;
+    xTaskNotifyGive(inferenceTask_);
+}
+
+void MLDetector::aggregateWindow(const MLWindowOutput &out)
+{
+    // Cooldown after a detection: the same transit stays in the window
+    if (lastDetectionTime_ > 0 &&
+        (currentTimestamp_ - lastDetectionTime_) < ML_DETECTION_COOLDOWN_MS)
+    {
+        slidingWindows_.clear();
+        return;
+    }
+
+    slidingWindows_.push(out);
+    if (!slidingWindows_.isFull())
+        return;
+
+    // Mean probabilities over the last ML_SLIDING_AGG_WINDOWS windows, and
+    // how many of those windows individually voted for the winning class
+    float mean[3] = {0, 0, 0};
+    for (size_t w = 0; w < slidingWindows_.size(); w++)
+    {
+        for (int c = 0; c < 3; c++)
+            mean[c] += slidingWindows_[w].probs[c];
+    }
+    for (int c = 0; c < 3; c++)
+        mean[c] /= slidingWindows_.size();
+
+    int best = (mean[0] > mean[1]) ? 0 : 1;
+    if (mean[(int)MLClass::NO_TRANSIT] >= mean[best])
+        return;
+
+    uint8_t agree = 0;
+    for (size_t w = 0; w < slidingWindows_.size(); w++)
+    {
+        const float *p = slidingWindows_[w].probs;
+        if (p[best] > p[1 - best] && p[best] > p[(int)MLClass::NO_TRANSIT])
+            agree++;
+    }
+    if (agree < ML_SLIDING_MIN_AGREE)
+        return;
+
+    if (classify(mean, false))
+    {
+        lastDetectionTime_ = currentTimestamp_;
+        stampResult(out.endUs);
+        slidingWindows_.clear();
+    }
+}
+
 // ============================================================================
 // Public API
 // ============================================================================
@@ -514,25 +1048,48 @@ DetectionResult MLDetector::getResult()
     return lastResult_;
 }
 
+bool MLDetector::classifyWindow(DetectionResult &out)
+{
+    out = DetectionResult();
+    out.direction = Direction::UNKNOWN;
+    if (!isReady() || getFrameCount() < 100 || inferenceBusy_)
+        return false;
+
+    uint32_t before = inferenceCount_;
+    bool detected = runInference();
+    if (inferenceCount_ == before)
+        return false; // Invoke never ran
+
+    if (detected)
+    {
+        lastDetectionTime_ = currentTimestamp_;
+        stampResult(currentTimestampUs_);
+        out = lastResult_;
+        detectionReady_ = false; // Handed over here, not via getResult()
+    }
+    return true;
+}
+
 void MLDetector::reset()
 {
-    // Clear ring buffer and detection state, keep baseline and model
-    ringHead_ = 0;
-    ringCount_ = 0;
-    smoothHead_ = 0;
-    smoothCount_ = 0;
-    memset(smoothBufferA_, 0, sizeof(smoothBufferA_));
-    memset(smoothBufferB_, 0, sizeof(smoothBufferB_));
-
-    for (uint8_t i = 0; i < ML_NUM_POSITIONS; i++)
-        currentProximity_[i] = 0;
-    hasCurrentReading_ = false;
+    // Clear input grid and detection state, keep baseline and model
+    clearGrid();
+    frameCount_ = 0;
+    smoothA_.clear();
+    smoothB_.clear();
+
     currentTimestamp_ = 0;
+    currentTimestampUs_ = 0;
+    onsetUs_ = 0;
 
     detectionReady_ = false;
     waitingPostTrigger_ = false;
     triggerTimestamp_ = 0;
 
+    slidingWindows_.clear();
+    nextWindowMs_ = 0;
+    generation_++; // Drop any window already in flight
+
     if (state_ != State::ESTABLISHING_BASELINE)
     {
         state_ = State::READY;
@@ -553,6 +1110,11 @@ void MLDetector::fullReset()
     state_ = State::ESTABLISHING_BASELINE;
 }
 
+size_t MLDetector::getArenaUsedBytes() const
+{
+    return interpreter_ ? interpreter_->arena_used_bytes() : 0;
+}
+
 bool MLDetector::isReady() const
 {
     return modelReady_ && state_ != State::ESTABLISHING_BASELINE;
@@ -562,17 +1124,26 @@ void MLDetector::debugPrint() const
 {
     Serial.println("=== MLDetector State ===");
     Serial.printf("Model ready: %s\n", modelReady_ ? "YES" : "NO");
+    Serial.printf("Model I/O: %s\n", int8Model_ ? "int8" : "float32");
     Serial.printf("State: %s\n",
                   state_ == State::ESTABLISHING_BASELINE ? "ESTABLISHING_BASELINE"
                   : state_ == State::READY               ? "READY"
                                                          : "TRIGGERED");
     Serial.printf("Baseline count: %lu / %u\n", baselineCount_, ML_BASELINE_READINGS);
     Serial.printf("Threshold A: %.1f, B: %.1f\n", thresholdA_, thresholdB_);
-    Serial.printf("Ring buffer: %u / %u frames\n", ringCount_, RING_BUFFER_SIZE);
+    Serial.printf("Input grid: %u / %u ms (%lu frames)\n",
+                  inputGrid_.size(), ML_WINDOW_MS, frameCount_);
     Serial.printf("Detection ready: %s\n", detectionReady_ ? "YES" : "NO");
+    MLInferenceStats stats = getInferenceStats();
+    Serial.printf("Inference: %s, %lu runs, avg %lu us, max %lu us, %lu windows skipped\n",
+                  inferenceModeName(mode_),
+                  stats.count, stats.avgUs, stats.maxUs, stats.skippedWindows);
+    Serial.printf("Model source: %s (%u bytes)\n",
+                  isModelFromPartition() ? "partition" : "built-in", modelSize_);
     if (interpreter_)
     {
-        Serial.printf("Arena used: %u / %u bytes\n",
-                      interpreter_->arena_used_bytes(), ML_TENSOR_ARENA_SIZE);
+        Serial.printf("Arena used: %u / %u bytes (%s)\n",
+                      interpreter_->arena_used_bytes(), ML_TENSOR_ARENA_SIZE,
+                      arenaInternal_ ? "internal SRAM" : "PSRAM");
     }
 }
@@ -2,7 +2,12 @@
 #define ML_DETECTOR_H
 
 #include <Arduino.h>
-#include "DirectionDetector.h" // Reuse Direction, DetectionResult, SensorReading
+#include "DirectionDetector.h" // Reuse Direction, DetectionResult, SensorFrame
+#include "../memory/PowerOfTwoRing.h"
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -14,23 +19,82 @@
  * that classifies transit direction from raw proximity sensor data.
  *
  * Architecture:
- *   - Maintains a sliding ring buffer of per-position proximity readings
+ *   - Maintains the model input as a 1ms forward-filled grid, updated per frame
  *   - Uses simplified threshold logic to detect "something happened"
  *   - On trigger: extracts 300ms window, runs TFLite inference
+ *   - Or, in sliding mode: runs on every stride on a background task and
+ *     aggregates consecutive windows (see MLInferenceMode)
  *   - Output: A_TO_B, B_TO_A, or NO_TRANSIT with confidence
  *
  * The model expects input shape (1, 300, 6) — 300ms at 1ms resolution,
  * 6 sensor positions. Values normalized by dividing by NORMALIZATION_MAX.
+ *
+ * Float32 and fully int8-quantized models (train.py --int8) are both
+ * supported: the input/output type is read at init, and for int8 the
+ * normalized grid is quantized (and the softmax dequantized) with the
+ * tensors' scale and zero point. Int8 Conv/FullyConnected/pooling are the
+ * layers the ESP-NN optimized kernels cover when the TFLM build provides them.
  */
 
 // Model input parameters (must match training pipeline)
 static constexpr uint16_t ML_WINDOW_MS = 300;
-static constexpr uint8_t ML_NUM_POSITIONS = 6;
+static constexpr uint8_t ML_NUM_POSITIONS = 6; // Boards 1-3; extra boards are not model input
+static_assert(NUM_SENSORS >= ML_NUM_POSITIONS, "the model reads positions 0-5");
 static constexpr float ML_NORMALIZATION_MAX = 490.0f;
+static constexpr float ML_NORMALIZATION_SCALE = 1.0f / ML_NORMALIZATION_MAX; // Multiply instead of divide
 static constexpr float ML_CONFIDENCE_THRESHOLD = 0.55f;
 
-// Tensor arena size — allocated in PSRAM for the dynamic-range quantized model
-static constexpr size_t ML_TENSOR_ARENA_SIZE = 150 * 1024; // 150KB
+// Tensor arena size (override with -DML_TENSOR_ARENA_KB=... once the
+// reported arena_used_bytes shows how much the current model needs)
+#ifndef ML_TENSOR_ARENA_KB
+#define ML_TENSOR_ARENA_KB 150
+#endif
+static constexpr size_t ML_TENSOR_ARENA_SIZE = ML_TENSOR_ARENA_KB * 1024;
+
+// Tensor arena placement. Conv layers are activation-bound, and PSRAM is
+// several times slower than internal SRAM for them.
+//   0 = internal SRAM when it fits (leaving ML_ARENA_INTERNAL_RESERVE free), else PSRAM
+//   1 = PSRAM only (falls back to internal if PSRAM is unavailable)
+//   2 = internal SRAM only
+#ifndef ML_ARENA_PLACEMENT
+#define ML_ARENA_PLACEMENT 0
+#endif
+
+// Internal heap kept free for WiFi/TLS when the arena goes to SRAM
+#ifndef ML_ARENA_INTERNAL_RESERVE
+#define ML_ARENA_INTERNAL_RESERVE (64 * 1024)
+#endif
+
+// Data partition holding a model image (see tools/ml-training/README.md).
+// If absent or invalid, the model compiled into model_data.h is used.
+#ifndef ML_MODEL_PARTITION
+#define ML_MODEL_PARTITION "model"
+#endif
+
+/**
+ * Header of a model image in the ML_MODEL_PARTITION partition.
+ * The .tflite flatbuffer follows at offset sizeof(MLModelImageHeader).
+ */
+struct MLModelImageHeader
+{
+    char magic[4];     // "MPML"
+    uint32_t length;   // Flatbuffer bytes
+    uint32_t crc32;    // esp_rom_crc32_le(0, flatbuffer, length)
+    uint32_t flags;    // ML_MODEL_FLAG_* (0 in images from before the flags)
+    char version[48];  // NUL-terminated model version string
+};
+static_assert(sizeof(MLModelImageHeader) % 8 == 0, "Model must stay 8-byte aligned after the header");
+
+// Model flags (MLModelImageHeader::flags, ML_MODEL_FLAGS in model_data.h):
+// how the training windows were resampled, which the input must match
+static constexpr uint32_t ML_MODEL_FLAG_LINEAR = 1u << 0; // Linear interpolation (else forward fill)
+
+// Readings further apart than this are not interpolated across; the rows
+// in between hold the older reading and, once it is this stale, count as
+// missing (mask channel 0)
+#ifndef ML_RESAMPLE_MAX_GAP_MS
+#define ML_RESAMPLE_MAX_GAP_MS 20
+#endif
 
 // Baseline parameters
 static constexpr uint16_t ML_BASELINE_READINGS = 50;
@@ -43,13 +107,64 @@ static constexpr uint32_t ML_DETECTION_COOLDOWN_MS = 500;
 // Post-trigger delay to capture the full wave
 static constexpr uint32_t ML_POST_TRIGGER_DELAY_MS = 150;
 
+// Sliding-window mode: inference every stride over the newest window, with
+// the decision taken on the mean of the last ML_SLIDING_AGG_WINDOWS outputs
+#ifndef ML_SLIDING_STRIDE_MS
+#define ML_SLIDING_STRIDE_MS 40
+#endif
+static constexpr uint16_t ML_SLIDING_MIN_STRIDE_MS = 10;
+static constexpr uint8_t ML_SLIDING_AGG_WINDOWS = 3;
+static constexpr uint8_t ML_SLIDING_MIN_AGREE = 2; // Windows whose own argmax matches the mean's
+
+/**
+ * When inference runs.
+ * - TRIGGERED: once per threshold trigger, ML_POST_TRIGGER_DELAY_MS later, on loop()
+ * - SLIDING: every stride on the MLInference task, no threshold gate
+ * - ON_DEMAND: only through classifyWindow() (ensemble detection); frames
+ *   just keep the input grid and baseline current
+ */
+enum class MLInferenceMode : uint8_t
+{
+    TRIGGERED,
+    SLIDING,
+    ON_DEMAND
+};
+
+/**
+ * How readings become 1 ms input rows (see MLDetector::pushFrame)
+ * - HOLD: forward fill, each position keeps its last reading
+ * - LINEAR: interpolated between the real sample instants of consecutive
+ *   readings; only rows after a position's newest reading hold it
+ */
+enum class MLResampling : uint8_t
+{
+    HOLD,
+    LINEAR
+};
+
+/**
+ * Inference timing since boot (both modes)
+ */
+struct MLInferenceStats
+{
+    uint32_t count;
+    uint32_t skippedWindows; // Sliding windows dropped because the previous one was still running
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint32_t avgUs;
+    uint32_t prepareAvgUs; // Input tensor fill (prepareInput), part of every inference
+    uint32_t prepareMaxUs;
+};
+
 /**
  * One timestep of sensor data: proximity values for all 6 positions.
  */
 struct MLSensorFrame
 {
     uint32_t timestamp_ms;
+    uint32_t timestamp_us;
     uint16_t proximity[ML_NUM_POSITIONS]; // position 0-5
+    uint16_t offset_us[ML_NUM_POSITIONS]; // Sample instant - timestamp_us (SensorFrame::offset_us)
 };
 
 /**
@@ -75,14 +190,17 @@ public:
     bool init();
 
     /**
-     * Add a new sensor reading (same interface as DirectionDetector).
+     * Release the interpreter, arena and model mapping (safe to call
+     * multiple times). The model partition may then be rewritten; init()
+     * loads it again. Hold detector access (DetectionTask::Guard).
      */
-    void addReading(const SensorReading &reading);
+    void deinit();
 
     /**
-     * Flush current aggregated reading and process it.
+     * Process one polling cycle (same interface as DirectionDetector).
+     * Positions that failed to read this cycle contribute 0.
      */
-    void flushReading();
+    void addFrame(const SensorFrame &frame);
 
     /**
      * Check if a detection result is ready.
@@ -109,11 +227,62 @@ public:
      */
     bool isReady() const;
 
+    /**
+     * Check if a trigger fired and its window is still being collected/classified.
+     */
+    bool isTriggered() const { return state_ == State::TRIGGERED; }
+
+    /**
+     * Classify the newest ML_WINDOW_MS now, on the caller's task, whatever
+     * the trigger state (ensemble arbitration). A transit goes to out and
+     * is not reported again through hasDetection(); otherwise out.direction
+     * is UNKNOWN.
+     * @return false if no inference ran (model or baseline not ready, window
+     *         not yet filled, or a sliding window still running)
+     */
+    bool classifyWindow(DetectionResult &out);
+
     /**
      * Debug print current state.
      */
     void debugPrint() const;
 
+    // --- Model / arena info (valid after a successful init) ---
+    bool hasModel() const { return modelReady_; } // init() succeeded (baseline may still be forming)
+    size_t getArenaUsedBytes() const;
+    size_t getArenaSize() const { return ML_TENSOR_ARENA_SIZE; }
+    bool isArenaInternal() const { return arenaInternal_; }
+    bool isModelFromPartition() const { return modelMmap_ != 0; }
+    size_t getModelSize() const { return modelSize_; }
+    const char *getModelVersion() const { return modelVersion_; }
+    bool isInt8Model() const { return int8Model_; }
+    // Model takes a validity mask per position after the 6 proximity channels
+    bool hasMaskInput() const { return maskInput_; }
+
+    // --- Resampling (set from the model flags by init) ---
+
+    /**
+     * Override the resampling the model was trained with (replay A/B).
+     * Restarts the input grid.
+     */
+    void setResampling(MLResampling resampling);
+    MLResampling getResampling() const { return resampling_; }
+    static const char *resamplingName(MLResampling resampling);
+
+    // --- Inference scheduling ---
+
+    /**
+     * Select triggered or sliding-window inference. SLIDING starts the
+     * MLInference task on first use. Call with detector access held
+     * (DetectionTask::Guard) while DetectionTask may be feeding.
+     * @return false if the task could not be created (mode unchanged)
+     */
+    bool setInferenceMode(MLInferenceMode mode, uint16_t strideMs = ML_SLIDING_STRIDE_MS);
+    MLInferenceMode getInferenceMode() const { return mode_; }
+    static const char *inferenceModeName(MLInferenceMode mode);
+    uint16_t getStrideMs() const { return strideMs_; }
+    MLInferenceStats getInferenceStats() const;
+
 private:
     // --- TFLite members ---
     const tflite::Model *model_ = nullptr;
@@ -124,22 +293,64 @@ private:
     TfLiteTensor *outputTensor_ = nullptr;
     bool modelReady_ = false;
 
-    /** Clean up all TFLite resources (safe to call multiple times). */
-    void deinit();
-
-    // --- Ring buffer for sensor frames ---
-    static constexpr size_t RING_BUFFER_SIZE = 512; // ~1.3s at ~2.7ms per frame
-    MLSensorFrame ringBuffer_[RING_BUFFER_SIZE];
-    size_t ringHead_ = 0;
-    size_t ringCount_ = 0;
+    // Model source and arena placement
+    spi_flash_mmap_handle_t modelMmap_ = 0; // Non-zero when mapped from ML_MODEL_PARTITION
+    size_t modelSize_ = 0;
+    char modelVersion_[48] = "";
+    uint32_t modelFlags_ = 0;
+    bool arenaInternal_ = false;
+
+    bool loadModel();
+    bool mapModelPartition();
+    bool allocateArena();
+
+    // Quantization parameters (int8 models only)
+    bool int8Model_ = false;
+    float inputInvScale_ = 1.0f;
+    int32_t inputZeroPoint_ = 0;
+    float outputScale_ = 1.0f;
+    int32_t outputZeroPoint_ = 0;
+    bool maskInput_ = false;
+    int8_t maskQuantized_[2] = {0, 0}; // Mask channel 0.0 / 1.0 in the int8 input
+
+    // --- Input grid: normalized, resampled 1ms rows, kept up to date per frame ---
+    // Row layout matches one timestep of the input tensor, so inference is a
+    // two-part copy of the newest ML_WINDOW_MS rows instead of a rebuild.
+    struct GridRow
+    {
+        float values[ML_NUM_POSITIONS];
+    };
+    static_assert(sizeof(GridRow) == ML_NUM_POSITIONS * sizeof(float), "rows are flat float runs");
+    static_assert(ML_NUM_POSITIONS <= 8, "mask rows are one byte");
+    typedef PowerOfTwoRing<GridRow, ringCapacityFor(ML_WINDOW_MS), ML_WINDOW_MS> InputGrid;
+    InputGrid inputGrid_;
+    // Bit p = position p of the same row is backed by a reading (mask channels)
+    PowerOfTwoRing<uint8_t, ringCapacityFor(ML_WINDOW_MS), ML_WINDOW_MS> maskGrid_;
+    GridRow lastRow_ = {};      // Held values (last non-zero reading per position)
+    uint32_t lastRowTime_ = 0;  // Timestamp (ms) of inputGrid_.back()
+    MLResampling resampling_ = MLResampling::HOLD;
+
+    // Each position's newest reading: interpolation start (LINEAR, and the
+    // skew_compensation correction in HOLD) and staleness for the mask
+    struct PositionSample
+    {
+        bool seen;
+        uint32_t us; // Sample instant
+        float value;
+    };
+    PositionSample lastSample_[ML_NUM_POSITIONS] = {};
+    uint16_t heldProximity_[ML_NUM_POSITIONS] = {}; // Last reading, for held positions (SensorFrame::held_mask)
+    uint32_t frameCount_ = 0;   // Frames since reset (saturating)
 
     void pushFrame(const MLSensorFrame &frame);
-    size_t getFrameCount() const { return ringCount_; }
+    void pushHeldRow(uint32_t rowMs);
+    void interpolateBack(uint8_t pos, const PositionSample &from, uint32_t toUs, float toValue);
+    void clearGrid();
+    size_t getFrameCount() const { return frameCount_; }
 
-    // --- Current reading aggregation ---
+    // --- Timestamp of the frame being processed ---
     uint32_t currentTimestamp_ = 0;
-    uint16_t currentProximity_[ML_NUM_POSITIONS] = {0};
-    bool hasCurrentReading_ = false;
+    uint32_t currentTimestampUs_ = 0; // Same frame, us (latency stamps)
 
     // --- Baseline / threshold tracking ---
     enum class State
@@ -167,21 +378,68 @@ private:
 
     bool checkTrigger(float sideA, float sideB);
 
+    // First threshold crossing not yet part of a detection (us, 0 = none);
+    // tracked in both modes for DetectionResult::firstCrossingUs
+    uint32_t onsetUs_ = 0;
+    void trackOnset(float sideA, float sideB);
+    void stampResult(uint32_t windowEndUs);
+
     // --- Inference ---
     bool runInference();
+    bool invokeModel(float probs[3]);
+    bool classify(const float probs[3], bool verbose);
     void prepareInput();
+    void prepareInputFloat();
+    void prepareInputInt8();
+    void prepareInputMasked();
+    float readOutput(int index) const;
+
+    uint32_t inferenceCount_ = 0;
+    uint32_t inferenceLastUs_ = 0;
+    uint32_t inferenceMaxUs_ = 0;
+    uint64_t inferenceTotalUs_ = 0;
+    uint32_t prepareCount_ = 0;
+    uint32_t prepareMaxUs_ = 0;
+    uint64_t prepareTotalUs_ = 0;
+    uint32_t skippedWindows_ = 0;
+    void recordInferenceTime(uint32_t elapsedUs);
+
+    // --- Sliding-window mode ---
+    // The feeding task fills the input tensor and notifies the inference
+    // task, which owns the interpreter until it clears inferenceBusy_.
+    struct MLWindowOutput
+    {
+        float probs[3];
+        uint32_t elapsedUs;
+        uint32_t generation;
+        uint32_t endUs; // Newest frame of the window
+        bool ok;
+    };
+    MLInferenceMode mode_ = MLInferenceMode::TRIGGERED;
+    uint16_t strideMs_ = ML_SLIDING_STRIDE_MS;
+    uint32_t nextWindowMs_ = 0;
+    uint32_t generation_ = 0;                // Bumped by reset(): drops windows in flight
+    volatile uint32_t windowGeneration_ = 0; // generation_ of the window handed to the task
+    volatile uint32_t windowEndUs_ = 0;      // Its newest frame
+    volatile bool inferenceBusy_ = false;
+    TaskHandle_t inferenceTask_ = nullptr;
+    QueueHandle_t inferenceResults_ = nullptr;
+    PowerOfTwoRing<MLWindowOutput, ringCapacityFor(ML_SLIDING_AGG_WINDOWS), ML_SLIDING_AGG_WINDOWS> slidingWindows_;
+
+    static void inferenceTaskFunction(void *parameter);
+    void runInferenceTask();
+    void serviceSlidingWindow();
+    void aggregateWindow(const MLWindowOutput &out);
 
     // --- Detection result ---
     bool detectionReady_ = false;
     DetectionResult lastResult_;
     uint32_t lastDetectionTime_ = 0;
 
-    // --- Smoothing ---
-    static constexpr size_t SMOOTH_BUFFER_SIZE = 10;
-    float smoothBufferA_[SMOOTH_BUFFER_SIZE] = {0};
-    float smoothBufferB_[SMOOTH_BUFFER_SIZE] = {0};
-    size_t smoothHead_ = 0;
-    size_t smoothCount_ = 0;
+    // --- Smoothing (moving average of the last SMOOTH_WINDOW side sums) ---
+    static constexpr size_t SMOOTH_WINDOW = 3;
+    PowerOfTwoRing<float, ringCapacityFor(SMOOTH_WINDOW), SMOOTH_WINDOW> smoothA_;
+    PowerOfTwoRing<float, ringCapacityFor(SMOOTH_WINDOW), SMOOTH_WINDOW> smoothB_;
 
     void pushSmooth(float a, float b);
     float getSmoothedA() const;
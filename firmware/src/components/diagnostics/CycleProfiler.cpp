@@ -0,0 +1,213 @@
+#include "CycleProfiler.h"
+
+#if CYCLE_PROFILER
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static_assert((CYCLE_PROFILER_RING_SIZE & (CYCLE_PROFILER_RING_SIZE - 1)) == 0,
+              "CYCLE_PROFILER_RING_SIZE must be a power of two");
+static_assert((size_t)ProfileSpan::COUNT <= 128, "span id must fit in 7 bits");
+
+static const uint32_t RING_MASK = CYCLE_PROFILER_RING_SIZE - 1;
+static const uint32_t MAX_EVENT_CYCLES = 0xFFFFFF;
+
+// Shared by both cores; the critical section is a handful of stores
+static portMUX_TYPE profilerLock = portMUX_INITIALIZER_UNLOCKED;
+static ProfileEvent events[CYCLE_PROFILER_RING_SIZE];
+static uint32_t eventHead = 0; // Free-running; newest event is at (eventHead - 1) & RING_MASK
+static ProfileSpanStats spanStats[(size_t)ProfileSpan::COUNT];
+
+volatile bool CycleProfiler::enabled = false;
+
+static uint8_t bucketFor(uint32_t cycles)
+{
+    // floor(log2(cycles)); 0 and 1 cycle share bucket 0
+    return cycles < 2 ? 0 : 31 - __builtin_clz(cycles);
+}
+
+void CycleProfiler::setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+void CycleProfiler::reset()
+{
+    portENTER_CRITICAL(&profilerLock);
+    eventHead = 0;
+    memset(spanStats, 0, sizeof(spanStats));
+    portEXIT_CRITICAL(&profilerLock);
+}
+
+void CycleProfiler::record(ProfileSpan span, uint32_t startCycles, uint32_t cycles)
+{
+    size_t idx = (size_t)span;
+    if (idx >= (size_t)ProfileSpan::COUNT)
+        return;
+
+    ProfileEvent event;
+    event.startCycles = startCycles;
+    event.packed = (cycles > MAX_EVENT_CYCLES ? MAX_EVENT_CYCLES : cycles) |
+                   ((uint32_t)idx << 24) |
+                   ((uint32_t)(xPortGetCoreID() & 1) << 31);
+    uint8_t bucket = bucketFor(cycles);
+
+    portENTER_CRITICAL(&profilerLock);
+    events[eventHead & RING_MASK] = event;
+    eventHead++;
+
+    ProfileSpanStats &stats = spanStats[idx];
+    if (stats.count == 0 || cycles < stats.minCycles)
+        stats.minCycles = cycles;
+    if (cycles > stats.maxCycles)
+        stats.maxCycles = cycles;
+    stats.count++;
+    stats.totalCycles += cycles;
+    stats.histogram[bucket]++;
+    portEXIT_CRITICAL(&profilerLock);
+}
+
+void CycleProfiler::getStats(ProfileSpan span, ProfileSpanStats &out)
+{
+    portENTER_CRITICAL(&profilerLock);
+    out = spanStats[(size_t)span];
+    portEXIT_CRITICAL(&profilerLock);
+}
+
+// Upper bound (in cycles) of the bucket holding the given fraction of samples
+static uint32_t percentileCycles(const ProfileSpanStats &stats, float fraction)
+{
+    uint32_t target = (uint32_t)(stats.count * fraction + 0.5f);
+    if (target == 0)
+        target = 1;
+
+    uint32_t seen = 0;
+    for (int b = 0; b < CYCLE_PROFILER_BUCKETS; b++)
+    {
+        seen += stats.histogram[b];
+        if (seen >= target)
+        {
+            uint32_t upper = b >= 31 ? UINT32_MAX : (2u << b) - 1;
+            return upper < stats.maxCycles ? upper : stats.maxCycles;
+        }
+    }
+    return stats.maxCycles;
+}
+
+size_t CycleProfiler::jsonCapacity(size_t maxEvents)
+{
+    if (maxEvents > CYCLE_PROFILER_RING_SIZE)
+        maxEvents = CYCLE_PROFILER_RING_SIZE;
+    return 512 +
+           (size_t)ProfileSpan::COUNT * (JSON_OBJECT_SIZE(9) + JSON_ARRAY_SIZE(CYCLE_PROFILER_BUCKETS)) +
+           JSON_ARRAY_SIZE(maxEvents) + maxEvents * JSON_ARRAY_SIZE(4);
+}
+
+void CycleProfiler::toJson(JsonDocument &doc, size_t maxEvents)
+{
+    uint32_t mhz = getCpuFrequencyMhz();
+    doc["profiling"] = (bool)enabled;
+    doc["cpu_mhz"] = mhz;
+
+    JsonObject spans = doc.createNestedObject("spans");
+    for (size_t i = 0; i < (size_t)ProfileSpan::COUNT; i++)
+    {
+        ProfileSpanStats stats;
+        getStats((ProfileSpan)i, stats);
+        if (stats.count == 0)
+            continue;
+
+        JsonObject s = spans.createNestedObject(spanName((ProfileSpan)i));
+        s["count"] = stats.count;
+        s["avg_cycles"] = (uint32_t)(stats.totalCycles / stats.count);
+        s["min_cycles"] = stats.minCycles;
+        s["max_cycles"] = stats.maxCycles;
+        s["avg_us"] = (float)stats.totalCycles / stats.count / mhz;
+        s["p50_us"] = (float)percentileCycles(stats, 0.50f) / mhz;
+        s["p99_us"] = (float)percentileCycles(stats, 0.99f) / mhz;
+
+        // Trailing empty buckets are omitted
+        int last = CYCLE_PROFILER_BUCKETS - 1;
+        while (last > 0 && stats.histogram[last] == 0)
+            last--;
+        JsonArray hist = s.createNestedArray("hist_log2");
+        for (int b = 0; b <= last; b++)
+            hist.add(stats.histogram[b]);
+    }
+
+    if (maxEvents == 0)
+        return;
+
+    // Copy under the lock, serialise outside it
+    static ProfileEvent snapshot[CYCLE_PROFILER_RING_SIZE];
+    portENTER_CRITICAL(&profilerLock);
+    uint32_t head = eventHead;
+    size_t available = head < CYCLE_PROFILER_RING_SIZE ? head : CYCLE_PROFILER_RING_SIZE;
+    size_t n = maxEvents < available ? maxEvents : available;
+    for (size_t k = 0; k < n; k++)
+        snapshot[k] = events[(head - n + k) & RING_MASK];
+    portEXIT_CRITICAL(&profilerLock);
+
+    doc["events_recorded"] = head;
+    JsonArray rows = doc.createNestedArray("events");
+    for (size_t k = 0; k < n; k++)
+    {
+        JsonArray row = rows.createNestedArray();
+        row.add((uint8_t)snapshot[k].span());
+        row.add(snapshot[k].core());
+        row.add(snapshot[k].startCycles);
+        row.add(snapshot[k].cycles());
+    }
+}
+
+void CycleProfiler::printReport()
+{
+    uint32_t mhz = getCpuFrequencyMhz();
+    Serial.printf("\n=== CYCLE PROFILE (%s, %lu MHz) ===\n", enabled ? "recording" : "stopped", mhz);
+    Serial.println("  span             count     avg_us     p50_us     p99_us     max_us");
+
+    for (size_t i = 0; i < (size_t)ProfileSpan::COUNT; i++)
+    {
+        ProfileSpanStats stats;
+        getStats((ProfileSpan)i, stats);
+        if (stats.count == 0)
+            continue;
+
+        Serial.printf("  %-15s %6lu %10.2f %10.2f %10.2f %10.2f\n",
+                      spanName((ProfileSpan)i), stats.count,
+                      (float)stats.totalCycles / stats.count / mhz,
+                      (float)percentileCycles(stats, 0.50f) / mhz,
+                      (float)percentileCycles(stats, 0.99f) / mhz,
+                      (float)stats.maxCycles / mhz);
+    }
+    Serial.println("==================================\n");
+}
+
+const char *CycleProfiler::spanName(ProfileSpan span)
+{
+    switch (span)
+    {
+    case ProfileSpan::MUX_SELECT:
+        return "mux_select";
+    case ProfileSpan::PS_ALS_READ:
+        return "ps_als_read";
+    case ProfileSpan::I2C_CYCLE:
+        return "i2c_cycle";
+    case ProfileSpan::QUEUE_PUSH:
+        return "queue_push";
+    case ProfileSpan::PROCESS_QUEUE:
+        return "process_queue";
+    case ProfileSpan::DETECTOR_UPDATE:
+        return "detector_update";
+    case ProfileSpan::ML_INFERENCE:
+        return "ml_inference";
+    case ProfileSpan::JSON_BUILD:
+        return "json_build";
+    case ProfileSpan::MQTT_WRITE:
+        return "mqtt_write";
+    default:
+        return "unknown";
+    }
+}
+
+#endif // CYCLE_PROFILER
@@ -0,0 +1,159 @@
+#ifndef CYCLE_PROFILER_H
+#define CYCLE_PROFILER_H
+
+#include <Arduino.h>
+
+/**
+ * CycleProfiler - Cycle-accurate timing of named hot-path spans
+ *
+ * Each span is timed with the CPU cycle counter (1 cycle = 1/240 us) and
+ * recorded twice:
+ * - into a fixed ring of the newest CYCLE_PROFILER_RING_SIZE events
+ *   (start, duration, span, core), for looking at individual cycles
+ * - into per-span statistics: count, total, min/max and a log2 histogram
+ *   (bucket i counts durations of [2^i, 2^(i+1)) cycles)
+ *
+ * Compiled in by default but disabled at runtime, so an idle scope costs
+ * one flag load. Enable with the "set_profiling" command, read back with
+ * "get_profile" (MQTT status message, optionally printed to Serial).
+ *
+ * Cycle counters are per core and not synchronised; every task that
+ * records is pinned, so start/end always come from the same counter.
+ * Event start values are only comparable between events of the same core.
+ *
+ * Build with -DCYCLE_PROFILER=0 to compile every PROFILE_SCOPE out
+ * (the host replay build does this).
+ */
+
+#ifndef CYCLE_PROFILER
+#define CYCLE_PROFILER 1
+#endif
+
+// Events kept for get_profile (power of two; 8 bytes each)
+#ifndef CYCLE_PROFILER_RING_SIZE
+#define CYCLE_PROFILER_RING_SIZE 1024
+#endif
+
+#define CYCLE_PROFILER_BUCKETS 32
+
+enum class ProfileSpan : uint8_t
+{
+    MUX_SELECT,      // TCA + PCA channel select (Wire fallback path)
+    PS_ALS_READ,     // Fused PS/ALS register read (Wire fallback path)
+    I2C_CYCLE,       // Whole queued I2C cycle (I2CTransactionEngine)
+    QUEUE_PUSH,      // Frame hand-off to the detection tap and session ring
+    PROCESS_QUEUE,   // SessionManager::processQueue() drain
+    DETECTOR_UPDATE, // One frame through the active detector
+    ML_INFERENCE,    // TFLite Invoke()
+    JSON_BUILD,      // serializeJson of an outgoing message
+    MQTT_WRITE,      // PubSubClient publish / stream chunk write
+    COUNT
+};
+
+#if CYCLE_PROFILER
+
+#include <ArduinoJson.h>
+#include <esp_cpu.h>
+
+struct ProfileEvent
+{
+    uint32_t startCycles;
+    uint32_t packed; // [31] core, [30:24] span, [23:0] duration (saturated)
+
+    uint32_t cycles() const { return packed & 0xFFFFFF; }
+    ProfileSpan span() const { return (ProfileSpan)((packed >> 24) & 0x7F); }
+    uint8_t core() const { return packed >> 31; }
+};
+
+struct ProfileSpanStats
+{
+    uint32_t count;
+    uint64_t totalCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t histogram[CYCLE_PROFILER_BUCKETS];
+};
+
+class CycleProfiler
+{
+public:
+    static inline bool isEnabled() { return enabled; }
+
+    /**
+     * Start or stop recording. Statistics are kept until reset().
+     */
+    static void setEnabled(bool enable);
+
+    /**
+     * Clear the event ring and all span statistics
+     */
+    static void reset();
+
+    static inline uint32_t now() { return esp_cpu_get_ccount(); }
+
+    /**
+     * Record one finished span. Safe from any task on either core.
+     */
+    static void record(ProfileSpan span, uint32_t startCycles, uint32_t cycles);
+
+    /**
+     * Consistent copy of one span's statistics
+     */
+    static void getStats(ProfileSpan span, ProfileSpanStats &out);
+
+    /**
+     * Fill doc with per-span statistics and histograms, plus the newest
+     * maxEvents events as [span, core, start, cycles] rows.
+     * Size doc with jsonCapacity(maxEvents).
+     */
+    static void toJson(JsonDocument &doc, size_t maxEvents = 0);
+    static size_t jsonCapacity(size_t maxEvents);
+
+    /**
+     * Plain-text table of all spans that recorded anything. Contains no
+     * frame delimiters, so it is safe to print while Serial Studio runs
+     * (it shows up in the console pane).
+     */
+    static void printReport();
+
+    static const char *spanName(ProfileSpan span);
+
+private:
+    static volatile bool enabled;
+};
+
+/**
+ * Times the enclosing scope as one span (no-op while disabled)
+ */
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfileSpan span)
+        : span(span), armed(CycleProfiler::isEnabled()), start(armed ? CycleProfiler::now() : 0)
+    {
+    }
+    ~ProfileScope()
+    {
+        if (armed)
+            CycleProfiler::record(span, start, CycleProfiler::now() - start);
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    ProfileSpan span;
+    bool armed;
+    uint32_t start;
+};
+
+#define PROFILE_SCOPE_NAME_(line) profileScope_##line
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_NAME_(line)
+#define PROFILE_SCOPE(span) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(span)
+
+#else
+
+#define PROFILE_SCOPE(span) ((void)0)
+
+#endif // CYCLE_PROFILER
+
+#endif
@@ -0,0 +1,122 @@
+#include "HeapTracker.h"
+
+#include <freertos/FreeRTOS.h>
+
+static const uint32_t INTERNAL_CAPS = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+static const uint32_t PSRAM_CAPS = MALLOC_CAP_SPIRAM;
+
+// Written by sample() (loop()), read by getSnapshot() (StatusPublisher task)
+static portMUX_TYPE snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+static HeapSnapshot snapshot = {0, 0, 0, 0, 0, 0, {}, 0, {UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, {}}};
+
+// sample() state (loop() only)
+static uint32_t lastSampleMs = 0;
+static uint32_t trendStartMs = 0;
+static uint32_t trendMin = UINT32_MAX;
+static bool sampled = false;
+
+static void takeSample(uint32_t now);
+
+static void lowerTo(uint32_t &mark, uint32_t value)
+{
+    if (value < mark)
+        mark = value;
+}
+
+void HeapTracker::sample()
+{
+    uint32_t now = millis();
+    if (sampled && now - lastSampleMs < HEAP_SAMPLE_INTERVAL_MS)
+        return;
+    takeSample(now);
+}
+
+static void takeSample(uint32_t now)
+{
+    lastSampleMs = now;
+
+    uint32_t heapFree = heap_caps_get_free_size(INTERNAL_CAPS);
+    uint32_t heapLargest = heap_caps_get_largest_free_block(INTERNAL_CAPS);
+    uint32_t heapMinEver = heap_caps_get_minimum_free_size(INTERNAL_CAPS);
+    uint32_t psramFree = heap_caps_get_free_size(PSRAM_CAPS);
+    uint32_t psramLargest = heap_caps_get_largest_free_block(PSRAM_CAPS);
+    uint32_t psramMinEver = heap_caps_get_minimum_free_size(PSRAM_CAPS);
+
+    if (!sampled)
+    {
+        trendStartMs = now;
+        sampled = true;
+    }
+    lowerTo(trendMin, heapLargest);
+    bool trendPoint = now - trendStartMs >= HEAP_TREND_INTERVAL_MS;
+
+    portENTER_CRITICAL(&snapshotLock);
+    snapshot.heapFree = heapFree;
+    snapshot.heapLargest = heapLargest;
+    snapshot.heapMinEver = heapMinEver;
+    snapshot.psramFree = psramFree;
+    snapshot.psramLargest = psramLargest;
+    snapshot.psramMinEver = psramMinEver;
+    lowerTo(snapshot.session.heap_min_free, heapFree);
+    lowerTo(snapshot.session.heap_min_largest_block, heapLargest);
+    lowerTo(snapshot.session.psram_min_free, psramFree);
+    lowerTo(snapshot.session.psram_min_largest_block, psramLargest);
+    if (trendPoint)
+    {
+        if (snapshot.trendCount == HEAP_TREND_SLOTS)
+        {
+            memmove(snapshot.trend, snapshot.trend + 1, (HEAP_TREND_SLOTS - 1) * sizeof(snapshot.trend[0]));
+            snapshot.trendCount--;
+        }
+        snapshot.trend[snapshot.trendCount++] = trendMin;
+    }
+    portEXIT_CRITICAL(&snapshotLock);
+
+    if (trendPoint)
+    {
+        trendStartMs = now;
+        trendMin = UINT32_MAX;
+    }
+}
+
+void HeapTracker::resetSessionMarks()
+{
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++)
+    {
+        Counters &c = counters((HeapTag)i);
+        c.sessionPeak.store(c.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    portENTER_CRITICAL(&snapshotLock);
+    snapshot.session.heap_min_free = UINT32_MAX;
+    snapshot.session.heap_min_largest_block = UINT32_MAX;
+    snapshot.session.psram_min_free = UINT32_MAX;
+    snapshot.session.psram_min_largest_block = UINT32_MAX;
+    portEXIT_CRITICAL(&snapshotLock);
+
+    // First sample of the session now, not up to an interval later
+    takeSample(millis());
+}
+
+HeapSessionMarks HeapTracker::getSessionMarks()
+{
+    // Include the state at session end
+    takeSample(millis());
+
+    HeapSessionMarks marks;
+    portENTER_CRITICAL(&snapshotLock);
+    marks = snapshot.session;
+    portEXIT_CRITICAL(&snapshotLock);
+
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++)
+        marks.tag_peak[i] = counters((HeapTag)i).sessionPeak.load(std::memory_order_relaxed);
+    return marks;
+}
+
+HeapSnapshot HeapTracker::getSnapshot()
+{
+    portENTER_CRITICAL(&snapshotLock);
+    HeapSnapshot s = snapshot;
+    portEXIT_CRITICAL(&snapshotLock);
+    return s;
+}
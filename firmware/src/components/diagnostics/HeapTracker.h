@@ -0,0 +1,194 @@
+#ifndef HEAP_TRACKER_H
+#define HEAP_TRACKER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_heap_caps.h>
+
+/**
+ * HeapTracker - Per-subsystem heap accounting and fragmentation trend
+ *
+ * MemoryMonitor prints free totals; it cannot say who holds the memory or
+ * whether the heap is breaking up over a long PLAY session. The tracker
+ * counts the allocations that matter by tag, and samples the largest free
+ * block so fragmentation shows before an allocation fails.
+ *
+ * - Tagged allocations: PSRAMAllocator (tag is a template argument, frame
+ *   buffers by default), PSRAMJsonDocument, the ML tensor arena, the
+ *   command queue and the MQTT outbox. Counting is a few relaxed atomics
+ *   per allocation; none of these are on a per-sample path
+ * - Per tag: bytes held, high-water mark (since boot and since the session
+ *   started), allocations and failures
+ * - sample() (loop(), every HEAP_SAMPLE_INTERVAL_MS): free size and largest
+ *   free block of internal RAM and PSRAM, session minimums, and every
+ *   HEAP_TREND_INTERVAL_MS the smallest internal largest-block of the
+ *   interval into a short trend history
+ * - Reported as "heap_stats" (getSnapshot() / tagCounts(), every
+ *   HEAP_REPORT_INTERVAL_MS, see main.cpp) and in SessionSummary
+ *
+ * Counting is header-only so the host replay build (which has no
+ * HeapTracker.cpp) can use the tagged allocators. The header has no
+ * ArduinoJson dependency, as everything that uses PSRAMAllocator.h
+ * includes it.
+ */
+
+// Sampling of free / largest block (loop())
+#ifndef HEAP_SAMPLE_INTERVAL_MS
+#define HEAP_SAMPLE_INTERVAL_MS 1000
+#endif
+
+// One trend point per interval (minimum of the samples in it)
+#ifndef HEAP_TREND_INTERVAL_MS
+#define HEAP_TREND_INTERVAL_MS 60000
+#endif
+
+#ifndef HEAP_TREND_SLOTS
+#define HEAP_TREND_SLOTS 8
+#endif
+
+// "heap_stats" status (main.cpp)
+#ifndef HEAP_REPORT_INTERVAL_MS
+#define HEAP_REPORT_INTERVAL_MS 300000
+#endif
+
+enum class HeapTag : uint8_t
+{
+    SESSION, // Frame / event buffers (PSRAMAllocator default)
+    ML,      // Tensor arena
+    JSON,    // MQTT message documents and text
+    MQTT,    // Outbox ring, command queue
+    OTHER
+};
+
+#define HEAP_TAG_COUNT 5
+
+// Minimums since the session started (SessionSummary)
+struct HeapSessionMarks
+{
+    uint32_t heap_min_free;
+    uint32_t heap_min_largest_block;
+    uint32_t psram_min_free;
+    uint32_t psram_min_largest_block;
+    uint32_t tag_peak[HEAP_TAG_COUNT]; // Bytes held, high-water
+};
+
+// Last sample() (getSnapshot())
+struct HeapSnapshot
+{
+    uint32_t heapFree;
+    uint32_t heapLargest;
+    uint32_t heapMinEver;
+    uint32_t psramFree;
+    uint32_t psramLargest;
+    uint32_t psramMinEver;
+    uint32_t trend[HEAP_TREND_SLOTS]; // Internal largest block, oldest first
+    uint8_t trendCount;
+    HeapSessionMarks session;
+};
+
+struct HeapTagCounts
+{
+    uint32_t bytes;
+    uint32_t peak;
+    uint32_t allocs;
+    uint32_t failures;
+};
+
+class HeapTracker
+{
+public:
+    static void *alloc(HeapTag tag, size_t size, uint32_t caps)
+    {
+        void *p = heap_caps_malloc(size, caps);
+        if (p)
+            recordAlloc(tag, size);
+        else
+            recordFailure(tag);
+        return p;
+    }
+
+    static void release(HeapTag tag, void *p, size_t size)
+    {
+        if (p == nullptr)
+            return;
+        heap_caps_free(p);
+        recordFree(tag, size);
+    }
+
+    // For allocators that call heap_caps themselves
+    static void recordAlloc(HeapTag tag, size_t size)
+    {
+        Counters &c = counters(tag);
+        uint32_t held = c.bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        c.allocs.fetch_add(1, std::memory_order_relaxed);
+        raise(c.peak, held);
+        raise(c.sessionPeak, held);
+    }
+
+    static void recordFree(HeapTag tag, size_t size)
+    {
+        counters(tag).bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    static void recordFailure(HeapTag tag)
+    {
+        counters(tag).failures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static uint32_t bytes(HeapTag tag) { return counters(tag).bytes.load(std::memory_order_relaxed); }
+    static uint32_t peak(HeapTag tag) { return counters(tag).peak.load(std::memory_order_relaxed); }
+
+    static HeapTagCounts tagCounts(HeapTag tag)
+    {
+        const Counters &c = counters(tag);
+        return {c.bytes.load(std::memory_order_relaxed), c.peak.load(std::memory_order_relaxed),
+                c.allocs.load(std::memory_order_relaxed), c.failures.load(std::memory_order_relaxed)};
+    }
+
+    static const char *tagName(HeapTag tag)
+    {
+        static const char *const names[HEAP_TAG_COUNT] = {"session", "ml", "json", "mqtt", "other"};
+        return names[(uint8_t)tag];
+    }
+
+    // ------------------------------------------------------------------
+    // Device only (HeapTracker.cpp)
+    // ------------------------------------------------------------------
+
+    // loop(): sample free / largest block when HEAP_SAMPLE_INTERVAL_MS passed
+    static void sample();
+
+    // Session start: minimums and per-tag peaks restart from now
+    static void resetSessionMarks();
+    static HeapSessionMarks getSessionMarks();
+
+    // Free sizes, largest blocks and trend as of the last sample(); safe from any task
+    static HeapSnapshot getSnapshot();
+
+private:
+    struct Counters
+    {
+        std::atomic<uint32_t> bytes;
+        std::atomic<uint32_t> peak;
+        std::atomic<uint32_t> sessionPeak;
+        std::atomic<uint32_t> allocs;
+        std::atomic<uint32_t> failures;
+    };
+
+    static Counters &counters(HeapTag tag)
+    {
+        static Counters all[HEAP_TAG_COUNT];
+        return all[(uint8_t)tag];
+    }
+
+    static void raise(std::atomic<uint32_t> &mark, uint32_t value)
+    {
+        uint32_t current = mark.load(std::memory_order_relaxed);
+        while (value > current &&
+               !mark.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+};
+
+#endif // HEAP_TRACKER_H
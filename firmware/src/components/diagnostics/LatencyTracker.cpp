@@ -0,0 +1,148 @@
+#include "LatencyTracker.h"
+
+#include <algorithm>
+#include <freertos/FreeRTOS.h>
+
+struct LatencyWindow
+{
+    uint32_t samples[LATENCY_WINDOW];
+    uint16_t head;
+    uint16_t size;
+    uint32_t count;
+    uint32_t max;
+};
+
+static portMUX_TYPE windowLock = portMUX_INITIALIZER_UNLOCKED;
+static LatencyWindow windows[LATENCY_DETECTOR_COUNT][LATENCY_STAGE_COUNT];
+
+volatile bool LatencyTracker::lastML = false;
+volatile uint32_t LatencyTracker::lastTotal = 0;
+
+void LatencyTracker::record(bool ml, LatencyStage stage, uint32_t fromUs, uint32_t toUs)
+{
+    if (fromUs == 0 || stage >= LatencyStage::COUNT)
+        return;
+    uint32_t us = toUs - fromUs;
+    // A stamp after its successor (clock mix-up, replayed frames): no sample
+    if ((int32_t)us < 0)
+        return;
+
+    LatencyWindow &w = windows[ml ? 1 : 0][(uint8_t)stage];
+    portENTER_CRITICAL(&windowLock);
+    w.samples[w.head] = us;
+    w.head = (w.head + 1) % LATENCY_WINDOW;
+    if (w.size < LATENCY_WINDOW)
+        w.size++;
+    w.count++;
+    if (us > w.max)
+        w.max = us;
+    portEXIT_CRITICAL(&windowLock);
+
+    if (stage == LatencyStage::TOTAL)
+    {
+        lastML = ml;
+        lastTotal = us;
+    }
+}
+
+void LatencyTracker::reset()
+{
+    portENTER_CRITICAL(&windowLock);
+    memset(windows, 0, sizeof(windows));
+    portEXIT_CRITICAL(&windowLock);
+    lastTotal = 0;
+}
+
+// Nearest rank over a sorted window
+static uint32_t percentile(const uint32_t *sorted, uint16_t size, uint8_t pct)
+{
+    uint16_t rank = (uint16_t)(((uint32_t)size * pct + 99) / 100);
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+LatencyPercentiles LatencyTracker::get(bool ml, LatencyStage stage)
+{
+    LatencyPercentiles out = {};
+    if (stage >= LatencyStage::COUNT)
+        return out;
+
+    uint32_t sorted[LATENCY_WINDOW];
+    const LatencyWindow &w = windows[ml ? 1 : 0][(uint8_t)stage];
+    portENTER_CRITICAL(&windowLock);
+    uint16_t size = w.size;
+    memcpy(sorted, w.samples, size * sizeof(sorted[0]));
+    out.count = w.count;
+    out.max = w.max;
+    portEXIT_CRITICAL(&windowLock);
+
+    if (size == 0)
+        return out;
+    std::sort(sorted, sorted + size);
+    out.p50 = percentile(sorted, size, 50);
+    out.p95 = percentile(sorted, size, 95);
+    out.p99 = percentile(sorted, size, 99);
+    return out;
+}
+
+LatencySessionStats LatencyTracker::getAll()
+{
+    LatencySessionStats stats;
+    for (uint8_t d = 0; d < LATENCY_DETECTOR_COUNT; d++)
+    {
+        for (uint8_t s = 0; s < LATENCY_STAGE_COUNT; s++)
+            stats.stage[d][s] = get(d == 1, (LatencyStage)s);
+    }
+    return stats;
+}
+
+void LatencyTracker::toJson(JsonObject obj, const LatencySessionStats &stats)
+{
+    static const char *const detectors[LATENCY_DETECTOR_COUNT] = {"heuristic", "ml"};
+
+    JsonArray fields = obj.createNestedArray("fields");
+    fields.add("count");
+    fields.add("p50_us");
+    fields.add("p95_us");
+    fields.add("p99_us");
+    fields.add("max_us");
+
+    for (uint8_t d = 0; d < LATENCY_DETECTOR_COUNT; d++)
+    {
+        bool any = false;
+        for (uint8_t s = 0; s < LATENCY_STAGE_COUNT; s++)
+            any = any || stats.stage[d][s].count > 0;
+        if (!any)
+            continue;
+
+        JsonObject detector = obj.createNestedObject(detectors[d]);
+        for (uint8_t s = 0; s < LATENCY_STAGE_COUNT; s++)
+        {
+            const LatencyPercentiles &p = stats.stage[d][s];
+            JsonArray row = detector.createNestedArray(stageName((LatencyStage)s));
+            row.add(p.count);
+            row.add(p.p50);
+            row.add(p.p95);
+            row.add(p.p99);
+            row.add(p.max);
+        }
+    }
+}
+
+const char *LatencyTracker::stageName(LatencyStage stage)
+{
+    switch (stage)
+    {
+    case LatencyStage::WAVE:
+        return "wave";
+    case LatencyStage::DECISION:
+        return "decision";
+    case LatencyStage::LED:
+        return "led";
+    case LatencyStage::PUBLISH:
+        return "publish";
+    case LatencyStage::TOTAL:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * LatencyTracker - End-to-end detection latency, per stage and detector
+ *
+ * CycleProfiler times single spans of one task; the time a player waits
+ * between the ball crossing the sensors and the LEDs (or the app) reacting
+ * spans four tasks. Each detection carries micros() stamps along that path:
+ *
+ *   first crossing  first sensor above its threshold (detector, frame time)
+ *   wave complete   last wave of the detection ended / ML window closed
+ *   decision        detector returned the result (DetectionTask)
+ *   LED             showDirection() issued (loop())
+ *   published       detection status handed to MQTT (StatusPublisher task)
+ *
+ * - Stages: wave (crossing -> complete), decision (complete -> decision),
+ *   led (decision -> LED), publish (decision -> published) and total
+ *   (crossing -> published)
+ * - Per detector (heuristic / ML) and stage: the newest LATENCY_WINDOW
+ *   samples, from which p50/p95/p99 are exact (nearest rank); count and max
+ *   cover everything since reset()
+ * - Reset at session start; reported in SessionSummary and in the Serial
+ *   Studio telemetry columns
+ *
+ * record() and the queries are safe from any task.
+ */
+
+// Samples kept per detector and stage (percentile window)
+#ifndef LATENCY_WINDOW
+#define LATENCY_WINDOW 64
+#endif
+
+enum class LatencyStage : uint8_t
+{
+    WAVE,     // First crossing -> wave complete
+    DECISION, // Wave complete -> detector decision
+    LED,      // Decision -> showDirection()
+    PUBLISH,  // Decision -> MQTT publish done
+    TOTAL,    // First crossing -> MQTT publish done
+    COUNT
+};
+
+#define LATENCY_STAGE_COUNT 5
+#define LATENCY_DETECTOR_COUNT 2 // Heuristic, ML
+
+#define LATENCY_JSON_CAPACITY                                                  \
+    (JSON_OBJECT_SIZE(LATENCY_DETECTOR_COUNT + 1) + JSON_ARRAY_SIZE(5) +       \
+     LATENCY_DETECTOR_COUNT * (JSON_OBJECT_SIZE(LATENCY_STAGE_COUNT) +          \
+                               LATENCY_STAGE_COUNT * JSON_ARRAY_SIZE(5)))
+
+// One detector's stage, in us (0 when nothing was recorded)
+struct LatencyPercentiles
+{
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;
+};
+
+// All stages of both detectors (SessionSummary)
+struct LatencySessionStats
+{
+    LatencyPercentiles stage[LATENCY_DETECTOR_COUNT][LATENCY_STAGE_COUNT];
+};
+
+class LatencyTracker
+{
+public:
+    /**
+     * One stage of one detection; from/to are micros() stamps. Skipped if
+     * fromUs is 0 (stamp unknown, e.g. the detector did not set it)
+     */
+    static void record(bool ml, LatencyStage stage, uint32_t fromUs, uint32_t toUs);
+
+    // Session start: clear every window
+    static void reset();
+
+    static LatencyPercentiles get(bool ml, LatencyStage stage);
+    static LatencySessionStats getAll();
+
+    // Detector of the newest TOTAL sample, and that sample (us, 0 = none)
+    static bool lastWasML() { return lastML; }
+    static uint32_t lastTotalUs() { return lastTotal; }
+
+    // One [count, p50, p95, p99, max] row per stage, per detector that
+    // recorded anything; at most LATENCY_JSON_CAPACITY
+    static void toJson(JsonObject obj, const LatencySessionStats &stats);
+
+    static const char *stageName(LatencyStage stage);
+
+private:
+    static volatile bool lastML;
+    static volatile uint32_t lastTotal;
+};
+
+#endif // LATENCY_TRACKER_H
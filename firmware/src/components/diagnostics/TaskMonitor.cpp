@@ -0,0 +1,167 @@
+#include "TaskMonitor.h"
+
+extern bool serialStudioEnabled;
+
+TaskMonitorEntry TaskMonitor::entries[TASK_MONITOR_MAX_TASKS];
+uint8_t TaskMonitor::entryCount = 0;
+int8_t TaskMonitor::load[2] = {-1, -1};
+uint32_t TaskMonitor::lastSampleMs = 0;
+uint32_t TaskMonitor::lastTotalRuntime = 0;
+uint32_t TaskMonitor::intervalMs = 0;
+
+#if configUSE_TRACE_FACILITY
+
+// Sampling buffers (loop() only); too large for the loop stack together
+static TaskStatus_t status[TASK_MONITOR_MAX_TASKS];
+static TaskMonitorEntry next[TASK_MONITOR_MAX_TASKS];
+
+static const TaskMonitorEntry *findEntry(const TaskMonitorEntry *list, uint8_t count, TaskHandle_t handle)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (list[i].handle == handle)
+            return &list[i];
+    }
+    return nullptr;
+}
+
+bool TaskMonitor::sample()
+{
+    uint32_t now = millis();
+    if (lastSampleMs != 0 && now - lastSampleMs < TASK_MONITOR_INTERVAL_MS)
+        return false;
+
+    uint32_t totalRuntime = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, TASK_MONITOR_MAX_TASKS, &totalRuntime);
+    if (count == 0)
+    {
+        // More tasks than TASK_MONITOR_MAX_TASKS: FreeRTOS fills nothing
+        static bool warned = false;
+        if (!warned && !serialStudioEnabled)
+            Serial.printf("WARNING: TaskMonitor: more than %d tasks\n", TASK_MONITOR_MAX_TASKS);
+        warned = true;
+        return false;
+    }
+
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t totalDelta = totalRuntime - lastTotalRuntime;
+    bool haveDelta = lastSampleMs != 0 && totalDelta > 0;
+#endif
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        const TaskStatus_t &s = status[i];
+        const TaskMonitorEntry *prev = findEntry(entries, entryCount, s.xHandle);
+        TaskMonitorEntry &e = next[i];
+
+        e.handle = s.xHandle;
+        strlcpy(e.name, s.pcTaskName, sizeof(e.name));
+        BaseType_t affinity = xTaskGetAffinity(s.xHandle);
+        e.core = affinity == tskNO_AFFINITY ? -1 : (int8_t)affinity;
+        e.priority = (uint8_t)s.uxCurrentPriority;
+        e.stackFree = s.usStackHighWaterMark; // Bytes on ESP-IDF (8-bit stack type)
+        e.stackWarned = prev != nullptr && prev->stackWarned;
+#if configGENERATE_RUN_TIME_STATS
+        e.runtime = s.ulRunTimeCounter;
+        e.cpuPermille = -1;
+        if (haveDelta && prev != nullptr)
+        {
+            uint64_t permille = (uint64_t)(e.runtime - prev->runtime) * 1000 / totalDelta;
+            e.cpuPermille = permille > 1000 ? 1000 : (int16_t)permille;
+        }
+#else
+        e.runtime = 0;
+        e.cpuPermille = -1;
+#endif
+
+        if (!e.stackWarned && e.stackFree < TASK_MONITOR_STACK_WARN_BYTES)
+        {
+            e.stackWarned = true;
+            if (!serialStudioEnabled)
+                Serial.printf("WARNING: Task %s has %lu bytes of stack left\n", e.name, (unsigned long)e.stackFree);
+        }
+    }
+
+    memcpy(entries, next, count * sizeof(TaskMonitorEntry));
+    entryCount = count;
+    intervalMs = lastSampleMs != 0 ? now - lastSampleMs : 0;
+    lastSampleMs = now;
+    lastTotalRuntime = totalRuntime;
+
+    for (uint8_t core = 0; core < 2; core++)
+    {
+        const TaskMonitorEntry *idle = findEntry(entries, entryCount, xTaskGetIdleTaskHandleForCPU(core));
+        load[core] = (idle != nullptr && idle->cpuPermille >= 0) ? (int8_t)(100 - idle->cpuPermille / 10) : -1;
+    }
+    return true;
+}
+
+#else
+
+bool TaskMonitor::sample()
+{
+    return false;
+}
+
+#endif
+
+size_t TaskMonitor::jsonCapacity()
+{
+    return JSON_OBJECT_SIZE(5) + JSON_ARRAY_SIZE(2) + JSON_ARRAY_SIZE(5) +
+           JSON_ARRAY_SIZE(entryCount) + entryCount * JSON_ARRAY_SIZE(5) + 64;
+}
+
+void TaskMonitor::toJson(JsonDocument &doc)
+{
+    doc["interval_ms"] = intervalMs;
+    doc["runtime_stats"] = configGENERATE_RUN_TIME_STATS ? true : false;
+
+    JsonArray cores = doc.createNestedArray("core_load");
+    cores.add(load[0]);
+    cores.add(load[1]);
+
+    // One row per task; cpu_pct is of one core, stack_free in bytes
+    JsonArray fields = doc.createNestedArray("fields");
+    fields.add("name");
+    fields.add("core");
+    fields.add("priority");
+    fields.add("cpu_pct");
+    fields.add("stack_free");
+
+    JsonArray tasks = doc.createNestedArray("tasks");
+    for (uint8_t i = 0; i < entryCount; i++)
+    {
+        const TaskMonitorEntry &e = entries[i];
+        JsonArray row = tasks.createNestedArray();
+        row.add((const char *)e.name);
+        row.add(e.core);
+        row.add(e.priority);
+        if (e.cpuPermille >= 0)
+            row.add(e.cpuPermille / 10.0f);
+        else
+            row.add(-1);
+        row.add(e.stackFree);
+    }
+}
+
+void TaskMonitor::printReport()
+{
+    if (serialStudioEnabled)
+        return;
+
+    Serial.printf("\n=== TASKS (%lu ms) === core 0: %d%%, core 1: %d%%\n",
+                  (unsigned long)intervalMs, load[0], load[1]);
+    Serial.println("  Name             Core  Prio   CPU%  Stack free");
+    for (uint8_t i = 0; i < entryCount; i++)
+    {
+        const TaskMonitorEntry &e = entries[i];
+        char core[4];
+        if (e.core < 0)
+            strlcpy(core, "-", sizeof(core));
+        else
+            snprintf(core, sizeof(core), "%d", e.core);
+        Serial.printf("  %-16s %4s  %4u  %5.1f  %10lu\n", e.name, core, e.priority,
+                      e.cpuPermille >= 0 ? e.cpuPermille / 10.0f : -1.0f, (unsigned long)e.stackFree);
+    }
+    Serial.println("=====================\n");
+}
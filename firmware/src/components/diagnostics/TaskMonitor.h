@@ -0,0 +1,84 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * TaskMonitor - Per-task CPU share, per-core load and stack headroom
+ *
+ * Every thread in the firmware (sensor task, detection, interrupt
+ * processing, ML inference, UI, status/command/MQTT work) was tuned
+ * blind: nothing said how busy each core is or how close a task is to
+ * overflowing its stack. The monitor samples FreeRTOS' own bookkeeping.
+ *
+ * - sample() (loop(), every TASK_MONITOR_INTERVAL_MS): uxTaskGetSystemState()
+ *   runtime counters. A task's CPU share is its runtime delta over the
+ *   interval, as a percentage of one core; a core's load is 100 minus its
+ *   idle task's share
+ * - Stack: uxTaskGetSystemState()'s high-water mark (bytes never used),
+ *   worst since boot. Tasks under TASK_MONITOR_STACK_WARN_BYTES are logged
+ *   once
+ * - Reported on demand ("get_task_stats" -> "task_stats" status) as one
+ *   row per task; core loads feed the CPU gauge in the display header
+ * - Sensor task time includes both its I2C transfers and its wait for the
+ *   next tick; the I2C_CYCLE span of CycleProfiler splits the two
+ *
+ * Without configGENERATE_RUN_TIME_STATS there are no runtime counters:
+ * stacks are still reported, CPU figures are -1.
+ *
+ * Called from loop() and command handlers (state lock); not thread safe
+ * otherwise.
+ */
+
+#ifndef TASK_MONITOR_INTERVAL_MS
+#define TASK_MONITOR_INTERVAL_MS 2000
+#endif
+
+#ifndef TASK_MONITOR_MAX_TASKS
+#define TASK_MONITOR_MAX_TASKS 32
+#endif
+
+#ifndef TASK_MONITOR_STACK_WARN_BYTES
+#define TASK_MONITOR_STACK_WARN_BYTES 512
+#endif
+
+#define TASK_MONITOR_NAME_LEN 16
+
+struct TaskMonitorEntry
+{
+    TaskHandle_t handle;
+    char name[TASK_MONITOR_NAME_LEN];
+    int8_t core;           // -1 = not pinned
+    uint8_t priority;
+    int16_t cpuPermille;   // Of one core, last interval (-1 = unknown)
+    uint32_t stackFree;    // Bytes, worst since boot
+    uint32_t runtime;      // Counter at the last sample
+    bool stackWarned;
+};
+
+class TaskMonitor
+{
+public:
+    // Sample when TASK_MONITOR_INTERVAL_MS has passed; true if it did
+    static bool sample();
+
+    // Last interval; -1 if unknown (no sample yet or no runtime stats)
+    static int8_t coreLoad(uint8_t core) { return core < 2 ? load[core] : -1; }
+
+    static size_t jsonCapacity();
+    static void toJson(JsonDocument &doc);
+    static void printReport();
+
+private:
+    static TaskMonitorEntry entries[TASK_MONITOR_MAX_TASKS];
+    static uint8_t entryCount;
+    static int8_t load[2];
+    static uint32_t lastSampleMs;
+    static uint32_t lastTotalRuntime;
+    static uint32_t intervalMs;
+};
+
+#endif // TASK_MONITOR_H
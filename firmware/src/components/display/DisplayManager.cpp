@@ -16,7 +16,90 @@ void DisplayManager::init()
     tft.init();
     tft.setRotation(1); // Landscape (320x170)
     tft.fillScreen(TFT_BLACK);
-    tft.setTextDatum(TL_DATUM); // Top-left alignment
+
+    // Frame buffer in PSRAM (TFT_eSprite uses PSRAM when it is present)
+    canvas.setColorDepth(16);
+    canvasReady = canvas.createSprite(SCREEN_WIDTH, SCREEN_HEIGHT) != nullptr;
+    if (canvasReady)
+    {
+        canvas.fillSprite(TFT_BLACK);
+        gfx = &canvas;
+    }
+    else
+    {
+        Serial.println("WARNING: Display frame buffer allocation failed - drawing directly");
+    }
+    gfx->setTextDatum(TL_DATUM); // Top-left alignment
+}
+
+void DisplayManager::markDirty(int x, int y, int w, int h)
+{
+    if (!canvasReady)
+        return;
+
+    // Clip to the screen
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if (x + w > SCREEN_WIDTH)
+        w = SCREEN_WIDTH - x;
+    if (y + h > SCREEN_HEIGHT)
+        h = SCREEN_HEIGHT - y;
+    if (w <= 0 || h <= 0)
+        return;
+
+    // Merge into an overlapping rectangle, or into the last one when full
+    DirtyRect *target = nullptr;
+    for (uint8_t i = 0; i < dirtyCount; i++)
+    {
+        DirtyRect &d = dirty[i];
+        if (x <= d.x + d.w && d.x <= x + w && y <= d.y + d.h && d.y <= y + h)
+        {
+            target = &d;
+            break;
+        }
+    }
+    if (target == nullptr && dirtyCount < DISPLAY_DIRTY_RECTS)
+    {
+        dirty[dirtyCount++] = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+        return;
+    }
+    if (target == nullptr)
+        target = &dirty[dirtyCount - 1];
+
+    int right = max(target->x + target->w, x + w);
+    int bottom = max(target->y + target->h, y + h);
+    target->x = min((int)target->x, x);
+    target->y = min((int)target->y, y);
+    target->w = right - target->x;
+    target->h = bottom - target->y;
+}
+
+void DisplayManager::flush()
+{
+    if (!canvasReady || dirtyCount == 0)
+        return;
+
+    for (uint8_t i = 0; i < dirtyCount; i++)
+    {
+        const DirtyRect &d = dirty[i];
+        canvas.pushSprite(d.x, d.y, d.x, d.y, d.w, d.h);
+    }
+    dirtyCount = 0;
+    lastPushMs = millis();
+}
+
+void DisplayManager::update()
+{
+    if (dirtyCount > 0 && millis() - lastPushMs >= DISPLAY_REFRESH_MS)
+        flush();
 }
 
 // ============================================================================
@@ -29,11 +112,12 @@ void DisplayManager::showInitScreen()
     currentInitStage = INIT_BOOT;
 
     // Title
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    tft.drawString("MOTION PLAY", 10, 5);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->drawString("MOTION PLAY", 10, 5);
 
     drawProgressBar();
+    flush();
 }
 
 void DisplayManager::updateInitStage(InitStage stage, const String &message)
@@ -44,23 +128,27 @@ void DisplayManager::updateInitStage(InitStage stage, const String &message)
     // Show message below progress bar
     if (message.length() > 0)
     {
-        tft.fillRect(0, 65, SCREEN_WIDTH, 20, TFT_BLACK);
-        tft.setTextSize(1);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString(message, 10, 65);
+        gfx->fillRect(0, 65, SCREEN_WIDTH, 20, TFT_BLACK);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+        gfx->drawString(message, 10, 65);
+        markDirty(0, 65, SCREEN_WIDTH, 20);
     }
+    flush();
 }
 
 void DisplayManager::setInitError(const String &error)
 {
     errorMessage = error;
-    tft.fillRect(0, 90, SCREEN_WIDTH, 80, TFT_BLACK);
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_RED, TFT_BLACK);
-    tft.drawString("ERROR", 10, 95);
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString(error, 10, 120);
+    gfx->fillRect(0, 90, SCREEN_WIDTH, 80, TFT_BLACK);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_RED, TFT_BLACK);
+    gfx->drawString("ERROR", 10, 95);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString(error, 10, 120);
+    markDirty(0, 90, SCREEN_WIDTH, 80);
+    flush();
 }
 
 void DisplayManager::drawProgressBar()
@@ -73,7 +161,8 @@ void DisplayManager::drawProgressBar()
     const int segmentWidth = barWidth / numStages;
 
     // Clear progress bar area
-    tft.fillRect(barX, barY, barWidth, barHeight, TFT_BLACK);
+    gfx->fillRect(barX, barY, barWidth, barHeight, TFT_BLACK);
+    markDirty(barX, barY, barWidth, barHeight);
 
     // Draw progress segments
     for (int i = 0; i < numStages; i++)
@@ -129,10 +218,10 @@ void DisplayManager::drawProgressBar()
         }
 
         // Fill segment
-        tft.fillRect(x + 2, barY + 2, segmentWidth - 4, barHeight - 4, boxColor);
+        gfx->fillRect(x + 2, barY + 2, segmentWidth - 4, barHeight - 4, boxColor);
 
         // Draw segment border
-        tft.drawRect(x, barY, segmentWidth, barHeight, TFT_WHITE);
+        gfx->drawRect(x, barY, segmentWidth, barHeight, TFT_WHITE);
 
         // Draw checkmark if completed
         if (completed)
@@ -141,20 +230,20 @@ void DisplayManager::drawProgressBar()
         }
 
         // Draw label
-        tft.setTextSize(1);
-        tft.setTextColor(completed ? TFT_BLACK : TFT_WHITE, boxColor);
+        gfx->setTextSize(1);
+        gfx->setTextColor(completed ? TFT_BLACK : TFT_WHITE, boxColor);
         int textX = x + (segmentWidth - (label.length() * 6)) / 2;
-        tft.drawString(label, textX, barY + barHeight - 12);
+        gfx->drawString(label, textX, barY + barHeight - 12);
     }
 }
 
 void DisplayManager::drawCheckmark(int x, int y, uint16_t color)
 {
     // Draw a simple checkmark
-    tft.drawLine(x, y + 5, x + 3, y + 8, color);
-    tft.drawLine(x + 3, y + 8, x + 8, y, color);
-    tft.drawLine(x, y + 6, x + 3, y + 9, color);
-    tft.drawLine(x + 3, y + 9, x + 8, y + 1, color);
+    gfx->drawLine(x, y + 5, x + 3, y + 8, color);
+    gfx->drawLine(x + 3, y + 8, x + 8, y, color);
+    gfx->drawLine(x, y + 6, x + 3, y + 9, color);
+    gfx->drawLine(x + 3, y + 9, x + 8, y + 1, color);
 }
 
 void DisplayManager::drawModeBadge()
@@ -196,13 +285,14 @@ void DisplayManager::drawModeBadge()
     }
 
     // Draw badge background with rounded corners effect
-    tft.fillRoundRect(badgeX, badgeY, badgeW, badgeH, 4, bgColor);
+    gfx->fillRoundRect(badgeX, badgeY, badgeW, badgeH, 4, bgColor);
+    markDirty(badgeX, badgeY, badgeW, badgeH);
 
     // Draw badge text centered
-    tft.setTextSize(1);
-    tft.setTextColor(textColor, bgColor);
+    gfx->setTextSize(1);
+    gfx->setTextColor(textColor, bgColor);
     int textWidth = modeText.length() * 6;
-    tft.drawString(modeText, badgeX + (badgeW - textWidth) / 2, badgeY + 6);
+    gfx->drawString(modeText, badgeX + (badgeW - textWidth) / 2, badgeY + 6);
 }
 
 void DisplayManager::drawStatusBadge()
@@ -243,18 +333,19 @@ void DisplayManager::drawStatusBadge()
     }
 
     // Draw badge background
-    tft.fillRoundRect(STATUS_BADGE_X, STATUS_BADGE_Y, STATUS_BADGE_W, STATUS_BADGE_H, 4, bgColor);
+    gfx->fillRoundRect(STATUS_BADGE_X, STATUS_BADGE_Y, STATUS_BADGE_W, STATUS_BADGE_H, 4, bgColor);
+    markDirty(STATUS_BADGE_X, STATUS_BADGE_Y, STATUS_BADGE_W, STATUS_BADGE_H);
 
     // Draw badge text centered
-    tft.setTextSize(1);
-    tft.setTextColor(textColor, bgColor);
+    gfx->setTextSize(1);
+    gfx->setTextColor(textColor, bgColor);
     int textWidth = statusText.length() * 6;
-    tft.drawString(statusText, STATUS_BADGE_X + (STATUS_BADGE_W - textWidth) / 2, STATUS_BADGE_Y + 6);
+    gfx->drawString(statusText, STATUS_BADGE_X + (STATUS_BADGE_W - textWidth) / 2, STATUS_BADGE_Y + 6);
 
     // Add pulsing dot for recording
     if (currentDisplayState == DISPLAY_RECORDING)
     {
-        tft.fillCircle(STATUS_BADGE_X + 8, STATUS_BADGE_Y + STATUS_BADGE_H / 2, 4, TFT_WHITE);
+        gfx->fillCircle(STATUS_BADGE_X + 8, STATUS_BADGE_Y + STATUS_BADGE_H / 2, 4, TFT_WHITE);
     }
 }
 
@@ -267,18 +358,19 @@ void DisplayManager::drawConfigPanel()
     const int panelH = CONFIG_AREA_HEIGHT;
 
     // Clear config area
-    tft.fillRect(panelX, panelY, panelW, panelH, TFT_BLACK);
+    gfx->fillRect(panelX, panelY, panelW, panelH, TFT_BLACK);
+    markDirty(panelX, panelY, panelW, panelH);
 
     // Draw subtle border
-    tft.drawRoundRect(panelX, panelY, panelW, panelH, 4, 0x3186); // Dark gray border
+    gfx->drawRoundRect(panelX, panelY, panelW, panelH, 4, 0x3186); // Dark gray border
 
     // Config title
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    tft.drawString("SENSOR CONFIG", panelX + 6, panelY + 4);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->drawString("SENSOR CONFIG", panelX + 6, panelY + 4);
 
     // Horizontal line under title
-    tft.drawFastHLine(panelX + 4, panelY + 15, panelW - 8, 0x3186);
+    gfx->drawFastHLine(panelX + 4, panelY + 15, panelW - 8, 0x3186);
 
     // Layout: 3 columns for main settings
     const int col1X = panelX + 8;
@@ -290,87 +382,87 @@ void DisplayManager::drawConfigPanel()
     const int row4Y = panelY + 82;
 
     // Row 1: Rate, LED Current, Integration Time
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Rate:", col1X, row1Y);
-    tft.drawString("LED:", col2X, row1Y);
-    tft.drawString("IT:", col3X, row1Y);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Rate:", col1X, row1Y);
+    gfx->drawString("LED:", col2X, row1Y);
+    gfx->drawString("IT:", col3X, row1Y);
 
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString(String(cachedSampleRate) + "Hz", col1X + 35, row1Y);
-    tft.drawString(cachedLedCurrent, col2X + 30, row1Y);
-    tft.drawString(cachedIntegrationTime, col3X + 20, row1Y);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString(String(cachedSampleRate) + "Hz", col1X + 35, row1Y);
+    gfx->drawString(cachedLedCurrent, col2X + 30, row1Y);
+    gfx->drawString(cachedIntegrationTime, col3X + 20, row1Y);
 
     // Row 2: Duty Cycle, I2C Clock
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Duty:", col1X, row2Y);
-    tft.drawString("I2C:", col2X, row2Y);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Duty:", col1X, row2Y);
+    gfx->drawString("I2C:", col2X, row2Y);
 
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString(cachedDutyCycle, col1X + 35, row2Y);
-    tft.drawString(String(cachedI2cClock) + "kHz", col2X + 30, row2Y);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString(cachedDutyCycle, col1X + 35, row2Y);
+    gfx->drawString(String(cachedI2cClock) + "kHz", col2X + 30, row2Y);
 
     // Row 3: Boolean flags with colored indicators
     // Hi-Res indicator
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Hi-Res:", col1X, row3Y);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Hi-Res:", col1X, row3Y);
     if (cachedHighRes)
     {
-        tft.fillCircle(col1X + 50, row3Y + 3, 4, TFT_GREEN);
-        tft.setTextColor(TFT_GREEN, TFT_BLACK);
-        tft.drawString("ON", col1X + 58, row3Y);
+        gfx->fillCircle(col1X + 50, row3Y + 3, 4, TFT_GREEN);
+        gfx->setTextColor(TFT_GREEN, TFT_BLACK);
+        gfx->drawString("ON", col1X + 58, row3Y);
     }
     else
     {
-        tft.fillCircle(col1X + 50, row3Y + 3, 4, TFT_DARKGREY);
-        tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-        tft.drawString("OFF", col1X + 58, row3Y);
+        gfx->fillCircle(col1X + 50, row3Y + 3, 4, TFT_DARKGREY);
+        gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+        gfx->drawString("OFF", col1X + 58, row3Y);
     }
 
     // Ambient indicator
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Ambient:", col2X, row3Y);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Ambient:", col2X, row3Y);
     if (cachedReadAmbient)
     {
-        tft.fillCircle(col2X + 55, row3Y + 3, 4, TFT_GREEN);
-        tft.setTextColor(TFT_GREEN, TFT_BLACK);
-        tft.drawString("ON", col2X + 63, row3Y);
+        gfx->fillCircle(col2X + 55, row3Y + 3, 4, TFT_GREEN);
+        gfx->setTextColor(TFT_GREEN, TFT_BLACK);
+        gfx->drawString("ON", col2X + 63, row3Y);
     }
     else
     {
-        tft.fillCircle(col2X + 55, row3Y + 3, 4, TFT_DARKGREY);
-        tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-        tft.drawString("OFF", col2X + 63, row3Y);
+        gfx->fillCircle(col2X + 55, row3Y + 3, 4, TFT_DARKGREY);
+        gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+        gfx->drawString("OFF", col2X + 63, row3Y);
     }
 
     // Row 4: Detection config or sample count
     if (currentDisplayState == DISPLAY_RECORDING)
     {
-        tft.setTextColor(TFT_CYAN, TFT_BLACK);
-        tft.drawString("Samples:", col1X, row4Y);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString(String(sampleCount), col1X + 55, row4Y);
+        gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+        gfx->drawString("Samples:", col1X, row4Y);
+        gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+        gfx->drawString(String(sampleCount), col1X + 55, row4Y);
     }
     else
     {
-        tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-        tft.drawString("Pk:", col1X, row4Y);
-        tft.drawString("Rise:", col2X, row4Y);
-
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString(String(cachedPeakMultiplier, 1) + "x", col1X + 22, row4Y);
-        tft.drawString(String(cachedMinRise), col2X + 35, row4Y);
-
-        tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-        tft.drawString("Wave:", col3X, row4Y);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString(String(cachedMinWaveDurationMs) + "ms", col3X + 35, row4Y);
+        gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+        gfx->drawString("Pk:", col1X, row4Y);
+        gfx->drawString("Rise:", col2X, row4Y);
+
+        gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+        gfx->drawString(String(cachedPeakMultiplier, 1) + "x", col1X + 22, row4Y);
+        gfx->drawString(String(cachedMinRise), col2X + 35, row4Y);
+
+        gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+        gfx->drawString("Wave:", col3X, row4Y);
+        gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+        gfx->drawString(String(cachedMinWaveDurationMs) + "ms", col3X + 35, row4Y);
     }
 
     // Smoothing window on row 3 col3 (always visible)
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Sm:", col3X, row3Y);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString(String(cachedSmoothingWindow), col3X + 22, row3Y);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Sm:", col3X, row3Y);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString(String(cachedSmoothingWindow), col3X + 22, row3Y);
 }
 
 void DisplayManager::setMode(DisplayMode mode)
@@ -378,6 +470,7 @@ void DisplayManager::setMode(DisplayMode mode)
     currentMode = mode;
     // Redraw the badge immediately
     drawModeBadge();
+    flush();
 }
 
 void DisplayManager::setSensorConfig(const SensorConfiguration *config)
@@ -398,6 +491,7 @@ void DisplayManager::setSensorConfig(const SensorConfiguration *config)
     if (currentDisplayState != DISPLAY_ERROR)
     {
         drawConfigPanel();
+        flush();
     }
 }
 
@@ -411,6 +505,7 @@ void DisplayManager::setDetectionConfig(float peakMult, uint16_t minRise, uint32
     if (currentDisplayState != DISPLAY_ERROR)
     {
         drawConfigPanel();
+        flush();
     }
 }
 
@@ -423,12 +518,14 @@ void DisplayManager::showSessionScreen()
     clear();
     currentDisplayState = DISPLAY_IDLE;
     drawSessionStatus();
+    flush();
 }
 
 void DisplayManager::setDisplayState(DisplayState state)
 {
     currentDisplayState = state;
     drawSessionStatus();
+    flush();
 }
 
 void DisplayManager::updateSampleCount(int count)
@@ -442,34 +539,44 @@ void DisplayManager::updateSampleCount(int count)
         const int panelX = 8;
         const int row4Y = CONFIG_AREA_Y + 82;
 
-        tft.fillRect(panelX + 8 + 55, row4Y, 80, 12, TFT_BLACK);
-        tft.setTextSize(1);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString(String(count), panelX + 8 + 55, row4Y);
+        gfx->fillRect(panelX + 8 + 55, row4Y, 80, 12, TFT_BLACK);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+        gfx->drawString(String(count), panelX + 8 + 55, row4Y);
+        markDirty(panelX + 8 + 55, row4Y, 80, 12);
     }
+    // Pushed by update()
 }
 
 void DisplayManager::showMessage(const String &message, uint16_t color)
+{
+    drawMessage(message, color);
+    flush();
+}
+
+void DisplayManager::drawMessage(const String &message, uint16_t color)
 {
     // Clear message area
-    tft.fillRect(0, MESSAGE_Y, SCREEN_WIDTH, 25, TFT_BLACK);
+    gfx->fillRect(0, MESSAGE_Y, SCREEN_WIDTH, 25, TFT_BLACK);
+    markDirty(0, MESSAGE_Y, SCREEN_WIDTH, 25);
 
     // Draw message centered
-    tft.setTextSize(1);
-    tft.setTextColor(color, TFT_BLACK);
+    gfx->setTextSize(1);
+    gfx->setTextColor(color, TFT_BLACK);
     int textWidth = message.length() * 6;
-    tft.drawString(message, SCREEN_WIDTH / 2 - textWidth / 2, MESSAGE_Y);
+    gfx->drawString(message, SCREEN_WIDTH / 2 - textWidth / 2, MESSAGE_Y);
 }
 
 void DisplayManager::drawSessionStatus()
 {
     // Clear header area
-    tft.fillRect(0, 0, SCREEN_WIDTH, HEADER_HEIGHT, TFT_BLACK);
+    gfx->fillRect(0, 0, SCREEN_WIDTH, HEADER_HEIGHT, TFT_BLACK);
+    markDirty(0, 0, SCREEN_WIDTH, HEADER_HEIGHT);
 
     // Title
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    tft.drawString("MOTION", 8, 5);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->drawString("MOTION", 8, 5);
 
     // Status badge (next to title)
     drawStatusBadge();
@@ -477,6 +584,9 @@ void DisplayManager::drawSessionStatus()
     // Mode badge (top-right corner)
     drawModeBadge();
 
+    // CPU gauge (between status and mode badges)
+    drawCpuGauge();
+
     // Draw config panel in center area
     drawConfigPanel();
 
@@ -484,23 +594,23 @@ void DisplayManager::drawSessionStatus()
     switch (currentDisplayState)
     {
     case DISPLAY_IDLE:
-        showMessage("Ready to record", TFT_LIGHTGREY);
+        drawMessage("Ready to record", TFT_LIGHTGREY);
         break;
 
     case DISPLAY_RECORDING:
-        showMessage("Recording in progress...", TFT_RED);
+        drawMessage("Recording in progress...", TFT_RED);
         break;
 
     case DISPLAY_UPLOADING:
-        showMessage("Uploading to cloud...", TFT_YELLOW);
+        drawMessage("Uploading to cloud...", TFT_YELLOW);
         break;
 
     case DISPLAY_SUCCESS:
-        showMessage("Upload complete!", TFT_GREEN);
+        drawMessage("Upload complete!", TFT_GREEN);
         break;
 
     case DISPLAY_ERROR:
-        showMessage(errorMessage.isEmpty() ? "Error occurred" : errorMessage, TFT_RED);
+        drawMessage(errorMessage.isEmpty() ? "Error occurred" : errorMessage, TFT_RED);
         break;
     }
 }
@@ -531,7 +641,7 @@ void DisplayManager::updatePowerStatus(float vsysVoltage, float currentMA)
     if (!powerMonitorActive || voltChanged || currChanged)
     {
         powerMonitorActive = true;
-        drawPowerStatus();
+        drawPowerStatus(); // Pushed by update()
     }
 }
 
@@ -539,10 +649,11 @@ void DisplayManager::drawPowerStatus()
 {
     // Draw power readout in the message area (bottom 25px) using big text
     const int y = MESSAGE_Y;
-    tft.fillRect(0, y, SCREEN_WIDTH, 25, TFT_BLACK);
+    gfx->fillRect(0, y, SCREEN_WIDTH, 25, TFT_BLACK);
+    markDirty(0, y, SCREEN_WIDTH, 25);
 
     // Format: "3.82V  1240mA" in large text, centered
-    tft.setTextSize(2);
+    gfx->setTextSize(2);
 
     // Voltage in green/yellow/red depending on level
     uint16_t vColor = TFT_GREEN;
@@ -565,11 +676,61 @@ void DisplayManager::drawPowerStatus()
     snprintf(iBuf, sizeof(iBuf), "%dmA", ma);
 
     // Voltage on left, current on right — both big
-    tft.setTextColor(vColor, TFT_BLACK);
-    tft.drawString(vBuf, 30, y + 3);
+    gfx->setTextColor(vColor, TFT_BLACK);
+    gfx->drawString(vBuf, 30, y + 3);
 
-    tft.setTextColor(iColor, TFT_BLACK);
-    tft.drawString(iBuf, 180, y + 3);
+    gfx->setTextColor(iColor, TFT_BLACK);
+    gfx->drawString(iBuf, 180, y + 3);
+}
+
+void DisplayManager::setBrightness(uint8_t level)
+{
+    analogWrite(PIN_LCD_BL, level);
+}
+
+void DisplayManager::updateCpuLoad(int8_t core0, int8_t core1)
+{
+    if (core0 == cachedCpuLoad[0] && core1 == cachedCpuLoad[1])
+        return;
+
+    cachedCpuLoad[0] = core0;
+    cachedCpuLoad[1] = core1;
+    drawCpuGauge(); // Pushed by update()
+}
+
+void DisplayManager::drawCpuGauge()
+{
+    // Two thin bars, one per core, between the status and mode badges
+    const int x = STATUS_BADGE_X + STATUS_BADGE_W + 8;
+    const int y = STATUS_BADGE_Y;
+    const int w = SCREEN_WIDTH - 60 - 6 - x;
+    const int barX = x + 14;
+    const int barW = w - 14;
+    const int barH = 7;
+
+    gfx->fillRect(x, y, w, STATUS_BADGE_H, TFT_BLACK);
+    markDirty(x, y, w, STATUS_BADGE_H);
+    if (cachedCpuLoad[0] < 0 && cachedCpuLoad[1] < 0)
+        return;
+
+    gfx->setTextSize(1);
+    for (int core = 0; core < 2; core++)
+    {
+        int rowY = y + 1 + core * 11;
+        int load = constrain((int)cachedCpuLoad[core], 0, 100);
+
+        uint16_t color = TFT_GREEN;
+        if (load > 90)
+            color = TFT_RED;
+        else if (load > 70)
+            color = TFT_YELLOW;
+
+        gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+        gfx->drawString(core == 0 ? "C0" : "C1", x, rowY);
+        gfx->drawRect(barX, rowY, barW, barH, TFT_DARKGREY);
+        if (cachedCpuLoad[core] >= 0)
+            gfx->fillRect(barX + 1, rowY + 1, (barW - 2) * load / 100, barH - 2, color);
+    }
 }
 
 void DisplayManager::setConfigString(const String &config)
@@ -580,6 +741,7 @@ void DisplayManager::setConfigString(const String &config)
     if (currentDisplayState == DISPLAY_RECORDING)
     {
         drawSessionStatus();
+        flush();
     }
 }
 
@@ -602,7 +764,8 @@ void DisplayManager::showMQTTStatus(bool connected)
 
 void DisplayManager::clear()
 {
-    tft.fillScreen(TFT_BLACK);
+    gfx->fillScreen(TFT_BLACK);
+    markDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 }
 
 // ============================================================================
@@ -614,53 +777,57 @@ void DisplayManager::showCalibrationIntro()
     clear();
 
     // Title - centered, large
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_MAGENTA, TFT_BLACK);
-    tft.drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 20);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_MAGENTA, TFT_BLACK);
+    gfx->drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 20);
 
     // Subtitle
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString("Sensor calibration wizard", SCREEN_WIDTH / 2 - 72, 50);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString("Sensor calibration wizard", SCREEN_WIDTH / 2 - 72, 50);
 
     // Instructions
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("This will calibrate all 3 sensor boards.", SCREEN_WIDTH / 2 - 114, 80);
-    tft.drawString("For each PCB you will:", SCREEN_WIDTH / 2 - 63, 100);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("This will calibrate all 3 sensor boards.", SCREEN_WIDTH / 2 - 114, 80);
+    gfx->drawString("For each PCB you will:", SCREEN_WIDTH / 2 - 63, 100);
 
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    tft.drawString("1. Wait for baseline (keep clear)", SCREEN_WIDTH / 2 - 99, 118);
-    tft.drawString("2. Approach & hold near sensors", SCREEN_WIDTH / 2 - 93, 132);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->drawString("1. Wait for baseline (keep clear)", SCREEN_WIDTH / 2 - 99, 118);
+    gfx->drawString("2. Approach & hold near sensors", SCREEN_WIDTH / 2 - 93, 132);
 
     // Starting message
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.drawString("Starting in 3 seconds...", SCREEN_WIDTH / 2 - 72, 155);
+    gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx->drawString("Starting in 3 seconds...", SCREEN_WIDTH / 2 - 72, 155);
+
+    flush();
 }
 
 void DisplayManager::showCalibrationBaseline(uint8_t pcbId, uint8_t progress)
 {
     clear();
 
-    // PCB indicator
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    String pcbText = "PCB " + String(pcbId);
-    tft.drawString(pcbText, SCREEN_WIDTH / 2 - 30, 10);
+    // PCB indicator (0: all PCBs at once)
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    if (pcbId == 0)
+        gfx->drawString("All PCBs", SCREEN_WIDTH / 2 - 48, 10);
+    else
+        gfx->drawString("PCB " + String(pcbId), SCREEN_WIDTH / 2 - 30, 10);
 
     // Step indicator
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Step 1/2: Baseline", SCREEN_WIDTH / 2 - 54, 35);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Step 1/2: Baseline", SCREEN_WIDTH / 2 - 54, 35);
 
     // Icon area - hand with "away" gesture
-    tft.setTextSize(3);
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.drawString("[ ]", SCREEN_WIDTH / 2 - 27, 55); // Simple "empty" icon
+    gfx->setTextSize(3);
+    gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx->drawString("[ ]", SCREEN_WIDTH / 2 - 27, 55); // Simple "empty" icon
 
     // Instruction
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString("Keep area clear of objects", SCREEN_WIDTH / 2 - 78, 95);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString("Keep area clear of objects", SCREEN_WIDTH / 2 - 78, 95);
 
     // Progress bar
     const int barX = 40;
@@ -669,22 +836,24 @@ void DisplayManager::showCalibrationBaseline(uint8_t pcbId, uint8_t progress)
     const int barH = 20;
 
     // Background
-    tft.drawRoundRect(barX, barY, barW, barH, 4, TFT_DARKGREY);
+    gfx->drawRoundRect(barX, barY, barW, barH, 4, TFT_DARKGREY);
 
     // Fill based on progress
     int fillW = (barW - 4) * progress / 100;
     if (fillW > 0)
     {
-        tft.fillRoundRect(barX + 2, barY + 2, fillW, barH - 4, 2, TFT_GREEN);
+        gfx->fillRoundRect(barX + 2, barY + 2, fillW, barH - 4, 2, TFT_GREEN);
     }
 
     // Percentage
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString(String(progress) + "%", SCREEN_WIDTH / 2 - 12, barY + 5);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString(String(progress) + "%", SCREEN_WIDTH / 2 - 12, barY + 5);
 
     // Footer
-    tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    tft.drawString("Capturing noise floor...", SCREEN_WIDTH / 2 - 69, 150);
+    gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    gfx->drawString("Capturing noise floor...", SCREEN_WIDTH / 2 - 69, 150);
+
+    flush();
 }
 
 void DisplayManager::showCalibrationApproach(uint8_t pcbId, uint16_t currentReading, uint16_t threshold, uint8_t progress, uint32_t timeRemaining)
@@ -692,21 +861,21 @@ void DisplayManager::showCalibrationApproach(uint8_t pcbId, uint16_t currentRead
     clear();
 
     // PCB indicator
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
     String pcbText = "PCB " + String(pcbId);
-    tft.drawString(pcbText, SCREEN_WIDTH / 2 - 30, 5);
+    gfx->drawString(pcbText, SCREEN_WIDTH / 2 - 30, 5);
 
     // Step indicator
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Step 2/2: Approach & Hold", SCREEN_WIDTH / 2 - 66, 28);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Step 2/2: Approach & Hold", SCREEN_WIDTH / 2 - 66, 28);
 
     // Large reading display - main focus
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Reading:", 20, 50);
-    tft.drawString("Need:", 20, 70);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Reading:", 20, 50);
+    gfx->drawString("Need:", 20, 70);
 
     // Current reading - LARGE
     uint16_t readingColor = TFT_LIGHTGREY;
@@ -717,31 +886,31 @@ void DisplayManager::showCalibrationApproach(uint8_t pcbId, uint16_t currentRead
     else if (currentReading > 0)
         readingColor = TFT_ORANGE;
 
-    tft.setTextSize(3);
-    tft.setTextColor(readingColor, TFT_BLACK);
-    tft.drawString(String(currentReading), 80, 42);
+    gfx->setTextSize(3);
+    gfx->setTextColor(readingColor, TFT_BLACK);
+    gfx->drawString(String(currentReading), 80, 42);
 
     // Threshold needed
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    tft.drawString("> " + String(threshold), 80, 65);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->drawString("> " + String(threshold), 80, 65);
 
     // Status indicator
-    tft.setTextSize(1);
+    gfx->setTextSize(1);
     if (currentReading >= threshold)
     {
-        tft.setTextColor(TFT_GREEN, TFT_BLACK);
-        tft.drawString("DETECTED! Hold steady...", SCREEN_WIDTH / 2 - 66, 92);
+        gfx->setTextColor(TFT_GREEN, TFT_BLACK);
+        gfx->drawString("DETECTED! Hold steady...", SCREEN_WIDTH / 2 - 66, 92);
     }
     else if (currentReading > 0)
     {
-        tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-        tft.drawString("Move CLOSER to sensors", SCREEN_WIDTH / 2 - 63, 92);
+        gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+        gfx->drawString("Move CLOSER to sensors", SCREEN_WIDTH / 2 - 63, 92);
     }
     else
     {
-        tft.setTextColor(TFT_RED, TFT_BLACK);
-        tft.drawString("No reading - check sensor connection", SCREEN_WIDTH / 2 - 102, 92);
+        gfx->setTextColor(TFT_RED, TFT_BLACK);
+        gfx->drawString("No reading - check sensor connection", SCREEN_WIDTH / 2 - 102, 92);
     }
 
     // Progress bar (fill when holding)
@@ -750,34 +919,96 @@ void DisplayManager::showCalibrationApproach(uint8_t pcbId, uint16_t currentRead
     const int barW = SCREEN_WIDTH - 40;
     const int barH = 16;
 
-    tft.drawRoundRect(barX, barY, barW, barH, 4, TFT_DARKGREY);
+    gfx->drawRoundRect(barX, barY, barW, barH, 4, TFT_DARKGREY);
 
     if (progress > 0)
     {
         int fillW = (barW - 4) * progress / 100;
         if (fillW > 0)
         {
-            tft.fillRoundRect(barX + 2, barY + 2, fillW, barH - 4, 2, TFT_GREEN);
+            gfx->fillRoundRect(barX + 2, barY + 2, fillW, barH - 4, 2, TFT_GREEN);
         }
-        tft.setTextSize(1);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawString("Hold: " + String(progress) + "%", barX + barW / 2 - 24, barY + 3);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+        gfx->drawString("Hold: " + String(progress) + "%", barX + barW / 2 - 24, barY + 3);
     }
     else
     {
-        tft.setTextSize(1);
-        tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-        tft.drawString("Waiting for detection...", barX + barW / 2 - 60, barY + 3);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+        gfx->drawString("Waiting for detection...", barX + barW / 2 - 60, barY + 3);
     }
 
     // Time remaining
     uint32_t secs = timeRemaining / 1000;
-    tft.setTextColor(secs < 3 ? TFT_RED : TFT_YELLOW, TFT_BLACK);
-    tft.drawString("Timeout: " + String(secs) + "s", 20, 130);
+    gfx->setTextColor(secs < 3 ? TFT_RED : TFT_YELLOW, TFT_BLACK);
+    gfx->drawString("Timeout: " + String(secs) + "s", 20, 130);
 
     // Footer - cancel hint
-    tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    tft.drawString("Press RIGHT button to cancel", 20, 155);
+    gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    gfx->drawString("Press RIGHT button to cancel", 20, 155);
+
+    flush();
+}
+
+void DisplayManager::showCalibrationApproachAll(const uint16_t *readings, const uint16_t *thresholds,
+                                                const uint8_t *progress, uint8_t doneMask, uint32_t timeRemaining)
+{
+    clear();
+
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx->drawString("All PCBs", SCREEN_WIDTH / 2 - 48, 5);
+
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Step 2/2: Approach each PCB, any order", SCREEN_WIDTH / 2 - 114, 28);
+
+    // One row per PCB: reading / needed, hold bar or OK
+    const int barX = 150;
+    const int barW = SCREEN_WIDTH - barX - 20;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        int y = 48 + i * 28;
+        bool done = doneMask & (1 << i);
+
+        gfx->setTextSize(1);
+        gfx->setTextColor(done ? TFT_GREEN : TFT_CYAN, TFT_BLACK);
+        gfx->drawString("PCB " + String(i + 1), 20, y + 4);
+
+        if (done)
+        {
+            gfx->setTextSize(2);
+            gfx->setTextColor(TFT_GREEN, TFT_BLACK);
+            gfx->drawString("OK", barX, y);
+            continue;
+        }
+
+        uint16_t readingColor = readings[i] >= thresholds[i] ? TFT_GREEN
+                                : readings[i] > thresholds[i] / 2 ? TFT_YELLOW
+                                                                  : TFT_LIGHTGREY;
+        gfx->setTextSize(2);
+        gfx->setTextColor(readingColor, TFT_BLACK);
+        gfx->drawString(String(readings[i]), 65, y);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+        gfx->drawString("> " + String(thresholds[i]), 115, y + 4);
+
+        gfx->drawRoundRect(barX, y, barW, 16, 4, TFT_DARKGREY);
+        int fillW = (barW - 4) * progress[i] / 100;
+        if (fillW > 0)
+            gfx->fillRoundRect(barX + 2, y + 2, fillW, 12, 2, TFT_GREEN);
+    }
+
+    uint32_t secs = timeRemaining / 1000;
+    gfx->setTextSize(1);
+    gfx->setTextColor(secs < 3 ? TFT_RED : TFT_YELLOW, TFT_BLACK);
+    gfx->drawString("Timeout: " + String(secs) + "s", 20, 135);
+
+    gfx->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    gfx->drawString("Press RIGHT button to cancel", 20, 155);
+
+    flush();
 }
 
 void DisplayManager::showCalibrationSuccess(uint8_t pcbId)
@@ -785,32 +1016,34 @@ void DisplayManager::showCalibrationSuccess(uint8_t pcbId)
     clear();
 
     // Large checkmark
-    tft.setTextSize(4);
-    tft.setTextColor(TFT_GREEN, TFT_BLACK);
-    tft.drawString("OK", SCREEN_WIDTH / 2 - 24, 40);
+    gfx->setTextSize(4);
+    gfx->setTextColor(TFT_GREEN, TFT_BLACK);
+    gfx->drawString("OK", SCREEN_WIDTH / 2 - 24, 40);
 
     // Draw actual checkmark
     int cx = SCREEN_WIDTH / 2;
     int cy = 65;
     for (int i = 0; i < 4; i++)
     {
-        tft.drawLine(cx - 30 + i, cy + 10, cx - 10, cy + 30 + i, TFT_GREEN);
-        tft.drawLine(cx - 10, cy + 30 + i, cx + 30 - i, cy - 10, TFT_GREEN);
+        gfx->drawLine(cx - 30 + i, cy + 10, cx - 10, cy + 30 + i, TFT_GREEN);
+        gfx->drawLine(cx - 10, cy + 30 + i, cx + 30 - i, cy - 10, TFT_GREEN);
     }
 
     // Text
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
     String msg = "PCB " + String(pcbId) + " complete!";
-    tft.drawString(msg, SCREEN_WIDTH / 2 - 84, 100);
+    gfx->drawString(msg, SCREEN_WIDTH / 2 - 84, 100);
 
     // Next PCB hint (if not last)
     if (pcbId < 3)
     {
-        tft.setTextSize(1);
-        tft.setTextColor(TFT_CYAN, TFT_BLACK);
-        tft.drawString("Next: PCB " + String(pcbId + 1), SCREEN_WIDTH / 2 - 36, 135);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TFT_CYAN, TFT_BLACK);
+        gfx->drawString("Next: PCB " + String(pcbId + 1), SCREEN_WIDTH / 2 - 36, 135);
     }
+
+    flush();
 }
 
 void DisplayManager::showCalibrationFailed(uint8_t pcbId, const String &reason)
@@ -818,24 +1051,26 @@ void DisplayManager::showCalibrationFailed(uint8_t pcbId, const String &reason)
     clear();
 
     // Large X
-    tft.setTextSize(4);
-    tft.setTextColor(TFT_RED, TFT_BLACK);
-    tft.drawString("X", SCREEN_WIDTH / 2 - 12, 30);
+    gfx->setTextSize(4);
+    gfx->setTextColor(TFT_RED, TFT_BLACK);
+    gfx->drawString("X", SCREEN_WIDTH / 2 - 12, 30);
 
     // Error message
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
     String msg = "PCB " + String(pcbId) + " failed";
-    tft.drawString(msg, SCREEN_WIDTH / 2 - 72, 80);
+    gfx->drawString(msg, SCREEN_WIDTH / 2 - 72, 80);
 
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.drawString(reason, SCREEN_WIDTH / 2 - (reason.length() * 3), 110);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx->drawString(reason, SCREEN_WIDTH / 2 - (reason.length() * 3), 110);
 
     // Instructions
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Calibration aborted.", SCREEN_WIDTH / 2 - 60, 135);
-    tft.drawString("Press any button to exit", SCREEN_WIDTH / 2 - 72, 150);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Calibration aborted.", SCREEN_WIDTH / 2 - 60, 135);
+    gfx->drawString("Press any button to exit", SCREEN_WIDTH / 2 - 72, 150);
+
+    flush();
 }
 
 void DisplayManager::showCalibrationSummary(uint16_t threshold1, uint16_t threshold2, uint16_t threshold3, bool valid1, bool valid2, bool valid3)
@@ -846,30 +1081,30 @@ void DisplayManager::showCalibrationSummary(uint16_t threshold1, uint16_t thresh
     int validCount = (valid1 ? 1 : 0) + (valid2 ? 1 : 0) + (valid3 ? 1 : 0);
 
     // Title - color based on success
-    tft.setTextSize(2);
+    gfx->setTextSize(2);
     if (validCount == 3)
     {
-        tft.setTextColor(TFT_GREEN, TFT_BLACK);
-        tft.drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 10);
-        tft.drawString("COMPLETE", SCREEN_WIDTH / 2 - 48, 30);
+        gfx->setTextColor(TFT_GREEN, TFT_BLACK);
+        gfx->drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 10);
+        gfx->drawString("COMPLETE", SCREEN_WIDTH / 2 - 48, 30);
     }
     else if (validCount > 0)
     {
-        tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-        tft.drawString("PARTIAL", SCREEN_WIDTH / 2 - 42, 10);
-        tft.drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 30);
+        gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+        gfx->drawString("PARTIAL", SCREEN_WIDTH / 2 - 42, 10);
+        gfx->drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 30);
     }
     else
     {
-        tft.setTextColor(TFT_RED, TFT_BLACK);
-        tft.drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 10);
-        tft.drawString("FAILED", SCREEN_WIDTH / 2 - 36, 30);
+        gfx->setTextColor(TFT_RED, TFT_BLACK);
+        gfx->drawString("CALIBRATION", SCREEN_WIDTH / 2 - 66, 10);
+        gfx->drawString("FAILED", SCREEN_WIDTH / 2 - 36, 30);
     }
 
     // Subtitle
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString("Results (" + String(validCount) + "/3 PCBs):", SCREEN_WIDTH / 2 - 54, 55);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx->drawString("Results (" + String(validCount) + "/3 PCBs):", SCREEN_WIDTH / 2 - 54, 55);
 
     // Thresholds in a nice grid
     const int colX = 30;
@@ -877,32 +1112,34 @@ void DisplayManager::showCalibrationSummary(uint16_t threshold1, uint16_t thresh
     const int col3X = 180;
 
     // PCB 1
-    tft.setTextColor(valid1 ? TFT_CYAN : TFT_DARKGREY, TFT_BLACK);
-    tft.drawString("PCB 1:", colX, 75);
-    tft.setTextSize(2);
-    tft.setTextColor(valid1 ? TFT_GREEN : TFT_RED, TFT_BLACK);
-    tft.drawString(valid1 ? String(threshold1) : "FAIL", col2X, 70);
+    gfx->setTextColor(valid1 ? TFT_CYAN : TFT_DARKGREY, TFT_BLACK);
+    gfx->drawString("PCB 1:", colX, 75);
+    gfx->setTextSize(2);
+    gfx->setTextColor(valid1 ? TFT_GREEN : TFT_RED, TFT_BLACK);
+    gfx->drawString(valid1 ? String(threshold1) : "FAIL", col2X, 70);
 
     // PCB 2
-    tft.setTextSize(1);
-    tft.setTextColor(valid2 ? TFT_CYAN : TFT_DARKGREY, TFT_BLACK);
-    tft.drawString("PCB 2:", colX, 95);
-    tft.setTextSize(2);
-    tft.setTextColor(valid2 ? TFT_GREEN : TFT_RED, TFT_BLACK);
-    tft.drawString(valid2 ? String(threshold2) : "FAIL", col2X, 90);
+    gfx->setTextSize(1);
+    gfx->setTextColor(valid2 ? TFT_CYAN : TFT_DARKGREY, TFT_BLACK);
+    gfx->drawString("PCB 2:", colX, 95);
+    gfx->setTextSize(2);
+    gfx->setTextColor(valid2 ? TFT_GREEN : TFT_RED, TFT_BLACK);
+    gfx->drawString(valid2 ? String(threshold2) : "FAIL", col2X, 90);
 
     // PCB 3
-    tft.setTextSize(1);
-    tft.setTextColor(valid3 ? TFT_CYAN : TFT_DARKGREY, TFT_BLACK);
-    tft.drawString("PCB 3:", colX, 115);
-    tft.setTextSize(2);
-    tft.setTextColor(valid3 ? TFT_GREEN : TFT_RED, TFT_BLACK);
-    tft.drawString(valid3 ? String(threshold3) : "FAIL", col2X, 110);
+    gfx->setTextSize(1);
+    gfx->setTextColor(valid3 ? TFT_CYAN : TFT_DARKGREY, TFT_BLACK);
+    gfx->drawString("PCB 3:", colX, 115);
+    gfx->setTextSize(2);
+    gfx->setTextColor(valid3 ? TFT_GREEN : TFT_RED, TFT_BLACK);
+    gfx->drawString(valid3 ? String(threshold3) : "FAIL", col2X, 110);
 
     // Footer
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.drawString("Press any button to continue", SCREEN_WIDTH / 2 - 84, 145);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx->drawString("Press any button to continue", SCREEN_WIDTH / 2 - 84, 145);
+
+    flush();
 }
 
 void DisplayManager::showCalibrationComplete()
@@ -917,12 +1154,14 @@ void DisplayManager::showCalibrationCancelled()
 {
     clear();
 
-    tft.setTextSize(2);
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.drawString("CANCELLED", SCREEN_WIDTH / 2 - 54, 60);
+    gfx->setTextSize(2);
+    gfx->setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx->drawString("CANCELLED", SCREEN_WIDTH / 2 - 54, 60);
 
-    tft.setTextSize(1);
-    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    tft.drawString("Calibration was cancelled", SCREEN_WIDTH / 2 - 75, 100);
-    tft.drawString("Previous settings unchanged", SCREEN_WIDTH / 2 - 81, 120);
-}
\ No newline at end of file
+    gfx->setTextSize(1);
+    gfx->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    gfx->drawString("Calibration was cancelled", SCREEN_WIDTH / 2 - 75, 100);
+    gfx->drawString("Previous settings unchanged", SCREEN_WIDTH / 2 - 81, 120);
+
+    flush();
+}
@@ -3,6 +3,17 @@
 
 #include <TFT_eSPI.h>
 
+// Minimum interval between pushes of live values (sample count, power
+// readout) to the panel. Screen changes and messages are pushed at once.
+#ifndef DISPLAY_REFRESH_MS
+#define DISPLAY_REFRESH_MS 100
+#endif
+
+// Dirty rectangles tracked between pushes; more are merged
+#ifndef DISPLAY_DIRTY_RECTS
+#define DISPLAY_DIRTY_RECTS 4
+#endif
+
 // Forward declarations
 struct SensorConfiguration;
 enum class CalibrationState : uint8_t;
@@ -38,10 +49,37 @@ enum DisplayMode
     MODE_LIVE_DEBUG
 };
 
+/**
+ * DisplayManager - Status screens on the T-Display-S3 panel
+ *
+ * Everything is drawn into a full-screen sprite in PSRAM (gfx), not onto
+ * the panel: each fillRect/drawString on the panel is a blocking parallel
+ * bus write. Drawing marks the touched area dirty; a push copies only the
+ * dirty rectangles to the panel.
+ *
+ * - Screen changes, state changes and messages push immediately (callers
+ *   often delay() right after them)
+ * - Live values (updateSampleCount, updatePowerStatus, updateCpuLoad) are pushed by
+ *   update(), at most every DISPLAY_REFRESH_MS
+ * - If the sprite cannot be allocated, gfx is the panel itself and drawing
+ *   is direct, as before
+ */
 class DisplayManager
 {
 private:
     TFT_eSPI tft = TFT_eSPI();
+    TFT_eSprite canvas = TFT_eSprite(&tft);
+    TFT_eSPI *gfx = &tft; // Drawing target: canvas, or tft without PSRAM
+    bool canvasReady = false;
+
+    struct DirtyRect
+    {
+        int16_t x, y, w, h;
+    };
+    DirtyRect dirty[DISPLAY_DIRTY_RECTS];
+    uint8_t dirtyCount = 0;
+    unsigned long lastPushMs = 0;
+
     InitStage currentInitStage = INIT_BOOT;
     DisplayState currentDisplayState = DISPLAY_IDLE;
     DisplayMode currentMode = MODE_DEBUG; // Default to debug mode
@@ -89,18 +127,33 @@ private:
     float cachedPowerCurrentMA = 0.0f;
     bool powerMonitorActive = false;
 
+    // CPU gauge (TaskMonitor core loads, -1 = unknown)
+    int8_t cachedCpuLoad[2] = {-1, -1};
+
+    // Frame buffer
+    void markDirty(int x, int y, int w, int h);
+    void flush(); // Push dirty rectangles to the panel now
+
     // Drawing helpers
+    void drawMessage(const String &message, uint16_t color);
     void drawProgressBar();
     void drawSessionStatus();
     void drawStatusBadge(); // New: compact status in header
     void drawConfigPanel(); // New: config display in center
     void drawPowerStatus(); // Power monitor readout
+    void drawCpuGauge();    // Per-core load bars in the header
     void drawCheckmark(int x, int y, uint16_t color);
     void drawModeBadge();
 
 public:
     void init();
 
+    /**
+     * Push pending live-value updates, rate limited to DISPLAY_REFRESH_MS.
+     * Call once per loop iteration.
+     */
+    void update();
+
     // Initialization flow
     void showInitScreen();
     void updateInitStage(InitStage stage, const String &message = "");
@@ -119,6 +172,12 @@ public:
     // Power monitoring display
     void updatePowerStatus(float vsysVoltage, float currentMA);
 
+    // CPU gauge in the header, percent per core (-1 = unknown, hidden)
+    void updateCpuLoad(int8_t core0, int8_t core1);
+
+    // Backlight level (PWM on PIN_LCD_BL), 255 = full
+    void setBrightness(uint8_t level);
+
     // Legacy compatibility (for gradual migration)
     void showBootScreen();
     void updateStatus(const String &status, uint16_t color = TFT_WHITE);
@@ -130,6 +189,9 @@ public:
     void showCalibrationIntro();
     void showCalibrationBaseline(uint8_t pcbId, uint8_t progress);
     void showCalibrationApproach(uint8_t pcbId, uint16_t currentReading, uint16_t threshold, uint8_t progress, uint32_t timeRemaining);
+    // Parallel calibration: every PCB at once (per-PCB arrays, doneMask bit = PCB captured)
+    void showCalibrationApproachAll(const uint16_t *readings, const uint16_t *thresholds, const uint8_t *progress,
+                                    uint8_t doneMask, uint32_t timeRemaining);
     void showCalibrationSuccess(uint8_t pcbId);
     void showCalibrationFailed(uint8_t pcbId, const String &reason = "Timeout");
     void showCalibrationSummary(uint16_t threshold1, uint16_t threshold2, uint16_t threshold3, bool valid1 = true, bool valid2 = true, bool valid3 = true);
@@ -0,0 +1,326 @@
+#include "UITask.h"
+
+bool UITask::begin(DisplayManager *displayManager, LEDController *ledController)
+{
+    display = displayManager;
+    leds = ledController;
+    if (task != nullptr)
+        return true;
+
+    mutex = xSemaphoreCreateRecursiveMutex();
+    displayQueue = xQueueCreate(UI_QUEUE_DEPTH, sizeof(Command));
+    ledQueue = xQueueCreate(UI_QUEUE_DEPTH, sizeof(Command));
+    if (mutex == nullptr || displayQueue == nullptr || ledQueue == nullptr)
+    {
+        Serial.println("ERROR: UITask queue creation failed");
+        return false;
+    }
+
+    // Below loop() (priority 1) on the same core: rendering only gets the
+    // time loop() leaves
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "UITask",
+        6144,
+        this,
+        0,
+        &task,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: UITask creation failed - rendering inline");
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void UITask::post(QueueHandle_t queue, const Command &command)
+{
+    if (task == nullptr)
+    {
+        // No task: apply inline, as before
+        if (display == nullptr || leds == nullptr)
+            return;
+        lock();
+        apply(command);
+        unlock();
+        if (command.type == CommandType::HOLD)
+            delay(command.value);
+        return;
+    }
+
+    if (xQueueSend(queue, &command, 0) != pdTRUE)
+    {
+        droppedCount++;
+        return;
+    }
+    xTaskNotifyGive(task);
+}
+
+void UITask::showMessage(const char *text, uint16_t color)
+{
+    Command command = {};
+    command.type = CommandType::MESSAGE;
+    command.color = color;
+    strlcpy(command.text, text, sizeof(command.text));
+    post(displayQueue, command);
+}
+
+void UITask::setDisplayState(DisplayState state)
+{
+    Command command = {};
+    command.type = CommandType::DISPLAY_STATE;
+    command.value = state;
+    post(displayQueue, command);
+}
+
+void UITask::setMode(DisplayMode mode)
+{
+    Command command = {};
+    command.type = CommandType::MODE;
+    command.value = mode;
+    post(displayQueue, command);
+}
+
+void UITask::showSessionScreen()
+{
+    Command command = {};
+    command.type = CommandType::SESSION_SCREEN;
+    post(displayQueue, command);
+}
+
+void UITask::setSensorConfig(const SensorConfiguration *config)
+{
+    if (config == nullptr)
+        return;
+
+    lock();
+    configCopy = *config;
+    unlock();
+
+    Command command = {};
+    command.type = CommandType::SENSOR_CONFIG;
+    post(displayQueue, command);
+}
+
+void UITask::setBrightness(uint8_t level)
+{
+    Command command = {};
+    command.type = CommandType::BRIGHTNESS;
+    command.value = level;
+    post(displayQueue, command);
+}
+
+void UITask::setDetectionConfig(float peakMult, uint16_t minRise, uint32_t minWaveDurMs, uint8_t smoothWin)
+{
+    Command command = {};
+    command.type = CommandType::DETECTION_CONFIG;
+    command.peakMultiplier = peakMult;
+    command.minRise = minRise;
+    command.minWaveDurationMs = minWaveDurMs;
+    command.smoothingWindow = smoothWin;
+    post(displayQueue, command);
+}
+
+void UITask::hold(uint32_t ms)
+{
+    Command command = {};
+    command.type = CommandType::HOLD;
+    command.value = ms;
+    post(displayQueue, command);
+}
+
+void UITask::updateSampleCount(int count)
+{
+    if (task == nullptr)
+    {
+        lock();
+        display->updateSampleCount(count);
+        display->update();
+        unlock();
+        return;
+    }
+    pendingSampleCount.store(count, std::memory_order_relaxed);
+}
+
+void UITask::updatePowerStatus(float vsysVoltage, float currentMA)
+{
+    if (task == nullptr)
+    {
+        lock();
+        display->updatePowerStatus(vsysVoltage, currentMA);
+        display->update();
+        unlock();
+        return;
+    }
+    pendingVoltage.store(vsysVoltage, std::memory_order_relaxed);
+    pendingCurrentMA.store(currentMA, std::memory_order_relaxed);
+    powerPending.store(true, std::memory_order_release);
+}
+
+void UITask::updateCpuLoad(int8_t core0, int8_t core1)
+{
+    if (task == nullptr)
+    {
+        lock();
+        display->updateCpuLoad(core0, core1);
+        display->update();
+        unlock();
+        return;
+    }
+    pendingCpuLoad.store((uint8_t)core0 | ((uint8_t)core1 << 8), std::memory_order_relaxed);
+}
+
+void UITask::initLeds()
+{
+    Command command = {};
+    command.type = CommandType::LED_INIT;
+    post(ledQueue, command);
+}
+
+void UITask::showDirection(Direction direction, uint32_t durationMs)
+{
+    Command command = {};
+    command.type = CommandType::LED_DIRECTION;
+    command.value = (uint32_t)direction;
+    command.durationMs = durationMs;
+    post(ledQueue, command);
+}
+
+void UITask::setLedReady(bool ready)
+{
+    // Called every loop() pass: only changes are posted
+    if (ready == ledReadyPosted)
+        return;
+    ledReadyPosted = ready;
+
+    Command command = {};
+    command.type = CommandType::LED_READY;
+    command.value = ready ? 1 : 0;
+    post(ledQueue, command);
+}
+
+void UITask::ledsOff()
+{
+    ledReadyPosted = false;
+
+    Command command = {};
+    command.type = CommandType::LED_OFF;
+    post(ledQueue, command);
+}
+
+void UITask::lock()
+{
+    if (mutex != nullptr)
+        xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+}
+
+void UITask::unlock()
+{
+    if (mutex != nullptr)
+        xSemaphoreGiveRecursive(mutex);
+}
+
+void UITask::apply(const Command &command)
+{
+    switch (command.type)
+    {
+    case CommandType::MESSAGE:
+        display->showMessage(command.text, command.color);
+        break;
+    case CommandType::DISPLAY_STATE:
+        display->setDisplayState((DisplayState)command.value);
+        break;
+    case CommandType::MODE:
+        display->setMode((DisplayMode)command.value);
+        break;
+    case CommandType::SESSION_SCREEN:
+        display->showSessionScreen();
+        break;
+    case CommandType::SENSOR_CONFIG:
+        display->setSensorConfig(&configCopy);
+        break;
+    case CommandType::DETECTION_CONFIG:
+        display->setDetectionConfig(command.peakMultiplier, command.minRise,
+                                    command.minWaveDurationMs, command.smoothingWindow);
+        break;
+    case CommandType::BRIGHTNESS:
+        display->setBrightness((uint8_t)command.value);
+        break;
+    case CommandType::HOLD:
+        holdStart = millis();
+        holdMs = command.value;
+        break;
+    case CommandType::LED_INIT:
+        if (!leds->init())
+            Serial.println("WARNING: LED controller init failed");
+        break;
+    case CommandType::LED_DIRECTION:
+        leds->showDirection((Direction)command.value, command.durationMs);
+        break;
+    case CommandType::LED_READY:
+        ledReady = command.value != 0;
+        if (ledReady && !leds->isAnimating())
+            leds->showReady();
+        break;
+    case CommandType::LED_OFF:
+        ledReady = false;
+        leds->off();
+        break;
+    }
+}
+
+void UITask::tick()
+{
+    Command command;
+
+    // LEDs first: a detection's color is never behind the display
+    while (xQueueReceive(ledQueue, &command, 0) == pdTRUE)
+        apply(command);
+
+    bool animating = leds->update();
+    if (!animating && ledReady)
+        leds->showReady();
+
+    // Display commands, in order, up to the next hold
+    while (holdMs == 0 || millis() - holdStart >= holdMs)
+    {
+        holdMs = 0;
+        if (xQueueReceive(displayQueue, &command, 0) != pdTRUE)
+            break;
+        apply(command);
+    }
+
+    if (holdMs == 0)
+    {
+        int count = pendingSampleCount.exchange(-1, std::memory_order_relaxed);
+        if (count >= 0)
+            display->updateSampleCount(count);
+        if (powerPending.exchange(false, std::memory_order_acquire))
+            display->updatePowerStatus(pendingVoltage.load(std::memory_order_relaxed),
+                                       pendingCurrentMA.load(std::memory_order_relaxed));
+        int cpu = pendingCpuLoad.exchange(-1, std::memory_order_relaxed);
+        if (cpu >= 0)
+            display->updateCpuLoad((int8_t)(cpu & 0xFF), (int8_t)((cpu >> 8) & 0xFF));
+    }
+
+    display->update();
+}
+
+void UITask::taskFunction(void *parameter)
+{
+    static_cast<UITask *>(parameter)->run();
+}
+
+void UITask::run()
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UI_TICK_MS));
+        lock();
+        tick();
+        unlock();
+    }
+}
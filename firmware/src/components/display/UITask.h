@@ -0,0 +1,150 @@
+#ifndef UI_TASK_H
+#define UI_TASK_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "DisplayManager.h"
+#include "../led/LEDController.h"
+#include "../sensor/SensorConfiguration.h"
+
+/**
+ * UITask - Owns the display and the LED strip, rendering from a task
+ *
+ * A FastLED.show() on the strip takes ~2.7 ms and display pushes block on
+ * the parallel bus; both used to run inline in loop(), along with the
+ * delay()s that kept a message on screen. loop() now only posts commands;
+ * the UI task (core 1, priority 0 - below loop()) renders them.
+ *
+ * - Two queues: LED commands are applied at the next tick, never behind a
+ *   held display message
+ * - hold(ms) replaces a delay() that only kept something on screen: later
+ *   display commands wait until it runs out, loop() does not
+ * - Live values (sample count, power readout, CPU gauge) are latest-value slots, not
+ *   queued, so they never fill the queue during a hold
+ * - The ready pulse and the direction fade-out are animated by the task
+ * - lock()/unlock(): exclusive use of display and strip from another task
+ *   for flows that draw directly (calibration, LED strip test)
+ *
+ * setup() draws on the DisplayManager directly until begin().
+ */
+
+#ifndef UI_QUEUE_DEPTH
+#define UI_QUEUE_DEPTH 16
+#endif
+
+// Task period when idle (ready pulse frame rate)
+#ifndef UI_TICK_MS
+#define UI_TICK_MS 10
+#endif
+
+#define UI_TEXT_MAX 48
+
+class UITask
+{
+public:
+    /**
+     * Start the UI task (core 1, priority 0). From here on the display and
+     * strip belong to the task.
+     * @return false on failure; commands are then applied inline (holds
+     *         become delays, as before)
+     */
+    bool begin(DisplayManager *display, LEDController *leds);
+
+    // === Display (queued, in order) ===
+    void showMessage(const char *text, uint16_t color = TFT_WHITE);
+    void setDisplayState(DisplayState state);
+    void setMode(DisplayMode mode);
+    void showSessionScreen();
+    void setSensorConfig(const SensorConfiguration *config);
+    void setDetectionConfig(float peakMult, uint16_t minRise, uint32_t minWaveDurMs, uint8_t smoothWin);
+    void setBrightness(uint8_t level); // Backlight, 255 = full
+
+    /**
+     * Keep the display as it is for ms before applying later display
+     * commands (timed messages without delay())
+     */
+    void hold(uint32_t ms);
+
+    // === Live values (latest wins) ===
+    void updateSampleCount(int count);
+    void updatePowerStatus(float vsysVoltage, float currentMA);
+    void updateCpuLoad(int8_t core0, int8_t core1); // Percent, -1 = unknown
+
+    // === LEDs ===
+    void initLeds();
+    void showDirection(Direction direction, uint32_t durationMs = 3000);
+    // Ready pulse while set and no direction is showing
+    void setLedReady(bool ready);
+    void ledsOff();
+
+    void lock();
+    void unlock();
+
+    uint32_t getDroppedCount() const { return droppedCount; }
+
+private:
+    enum class CommandType : uint8_t
+    {
+        MESSAGE,
+        DISPLAY_STATE,
+        MODE,
+        SESSION_SCREEN,
+        SENSOR_CONFIG,
+        DETECTION_CONFIG,
+        BRIGHTNESS,
+        HOLD,
+        LED_INIT,
+        LED_DIRECTION,
+        LED_READY,
+        LED_OFF
+    };
+
+    struct Command
+    {
+        CommandType type;
+        uint16_t color;
+        uint32_t value; // State, mode, direction, hold ms, ready flag or brightness
+        uint32_t durationMs;
+        float peakMultiplier;
+        uint16_t minRise;
+        uint32_t minWaveDurationMs;
+        uint8_t smoothingWindow;
+        char text[UI_TEXT_MAX];
+    };
+
+    DisplayManager *display = nullptr;
+    LEDController *leds = nullptr;
+    QueueHandle_t displayQueue = nullptr;
+    QueueHandle_t ledQueue = nullptr;
+    SemaphoreHandle_t mutex = nullptr;
+    TaskHandle_t task = nullptr;
+    volatile uint32_t droppedCount = 0;
+
+    // Copy of the sensor config for the display (taken under the mutex)
+    SensorConfiguration configCopy;
+
+    // Task state
+    unsigned long holdStart = 0;
+    uint32_t holdMs = 0;
+    bool ledReady = false;
+    bool ledReadyPosted = false; // Last setLedReady() value (caller side)
+
+    // Live value slots (-1 / false: nothing new)
+    std::atomic<int> pendingSampleCount{-1};
+    std::atomic<bool> powerPending{false};
+    std::atomic<float> pendingVoltage{0.0f};
+    std::atomic<float> pendingCurrentMA{0.0f};
+    std::atomic<int> pendingCpuLoad{-1}; // (uint8_t)core0 | (uint8_t)core1 << 8
+
+    void post(QueueHandle_t queue, const Command &command);
+    void apply(const Command &command);
+    void tick();
+
+    static void taskFunction(void *parameter);
+    void run();
+};
+
+#endif
@@ -0,0 +1,225 @@
+/**
+ * I2CBusHealth - Implementation
+ *
+ * See I2CBusHealth.h for documentation.
+ */
+
+#include "I2CBusHealth.h"
+
+void I2CBusHealth::reset()
+{
+    memset(failures, 0, sizeof(failures));
+    quarantined = 0;
+    cycleOk = 0;
+    cycleFailed = 0;
+    busOk = 0;
+    busFailed = 0;
+    for (int bus = 0; bus < I2C_HEALTH_BUSES; bus++)
+    {
+        busFaultCycles[bus] = 0;
+        recoveryAtMs[bus] = 0;
+        recoveryIntervalMs[bus] = 0;
+    }
+}
+
+void I2CBusHealth::recordRead(uint8_t sensor, uint8_t bus, bool ok)
+{
+    if (sensor >= NUM_SENSORS || bus >= I2C_HEALTH_BUSES)
+        return;
+
+    sensorBus[sensor] = bus;
+    if (ok)
+    {
+        cycleOk |= 1 << sensor;
+        busOk |= 1 << bus;
+    }
+    else
+    {
+        cycleFailed |= 1 << sensor;
+        busFailed |= 1 << bus;
+    }
+}
+
+uint8_t I2CBusHealth::endCycle(uint32_t nowMs, SensorMask &restored)
+{
+    restored = 0;
+    uint8_t recoveryDue = 0;
+
+    for (uint8_t bus = 0; bus < I2C_HEALTH_BUSES; bus++)
+    {
+        uint8_t bit = 1 << bus;
+        if (busOk & bit)
+        {
+            busFaultCycles[bus] = 0;
+            recoveryIntervalMs[bus] = 0;
+        }
+        else
+        {
+            // A down bus is not read at all: its count holds until recovery
+            if ((busFailed & bit) && busFaultCycles[bus] < UINT8_MAX)
+                busFaultCycles[bus]++;
+            if (busFaultCycles[bus] >= I2C_BUS_FAULT_CYCLES && (int32_t)(nowMs - recoveryAtMs[bus]) >= 0)
+                recoveryDue |= bit;
+        }
+    }
+
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        SensorMask bit = 1 << i;
+        if (cycleOk & bit)
+        {
+            failures[i] = 0;
+            if (quarantined & bit)
+            {
+                quarantined &= ~bit;
+                restored |= bit;
+                stats.restores++;
+                post(I2CHealthEventType::SENSOR_RESTORED, sensorBus[i], i, nowMs);
+            }
+        }
+        else if (cycleFailed & bit)
+        {
+            if (quarantined & bit)
+            {
+                probeIntervalMs[i] = backoff(probeIntervalMs[i]);
+                probeAtMs[i] = nowMs + probeIntervalMs[i];
+            }
+            // Only a failure while others on the bus answer is the
+            // sensor's own; a dead bus is recovered instead
+            else if ((busOk & (1 << sensorBus[i])) && ++failures[i] >= I2C_QUARANTINE_FAILURES)
+            {
+                failures[i] = 0;
+                quarantined |= bit;
+                probeIntervalMs[i] = I2C_QUARANTINE_PROBE_MS;
+                probeAtMs[i] = nowMs + probeIntervalMs[i];
+                stats.quarantines++;
+                post(I2CHealthEventType::SENSOR_QUARANTINED, sensorBus[i], i, nowMs);
+            }
+        }
+    }
+
+    cycleOk = 0;
+    cycleFailed = 0;
+    busOk = 0;
+    busFailed = 0;
+    return recoveryDue;
+}
+
+uint8_t I2CBusHealth::getBusesDown() const
+{
+    uint8_t down = 0;
+    for (uint8_t bus = 0; bus < I2C_HEALTH_BUSES; bus++)
+    {
+        if (busFaultCycles[bus] >= I2C_BUS_FAULT_CYCLES)
+            down |= 1 << bus;
+    }
+    return down;
+}
+
+SensorMask I2CBusHealth::probesDue(uint32_t nowMs) const
+{
+    SensorMask due = 0;
+    SensorMask q = quarantined;
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        if ((q & (1 << i)) && (int32_t)(nowMs - probeAtMs[i]) >= 0)
+            due |= 1 << i;
+    }
+    return due;
+}
+
+I2CRecoveryResult I2CBusHealth::clearBus(int sda, int scl)
+{
+    I2CRecoveryResult result;
+    uint32_t start = micros();
+
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, INPUT_PULLUP);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    result.sclStuck = digitalRead(scl) == LOW;
+    result.sdaStuck = digitalRead(sda) == LOW;
+
+    // A slave interrupted mid-byte holds SDA until it has clocked out the
+    // rest of the byte: clock SCL until it lets go, then STOP. A held SCL
+    // cannot be cleared from the master side.
+    if (result.sdaStuck && !result.sclStuck)
+    {
+        digitalWrite(scl, HIGH);
+        pinMode(scl, OUTPUT_OPEN_DRAIN);
+        while (result.pulses < I2C_RECOVERY_PULSES && digitalRead(sda) == LOW)
+        {
+            digitalWrite(scl, LOW);
+            delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+            digitalWrite(scl, HIGH);
+            delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+            result.pulses++;
+        }
+
+        // STOP: SDA rises while SCL is high
+        digitalWrite(scl, LOW);
+        digitalWrite(sda, LOW);
+        pinMode(sda, OUTPUT_OPEN_DRAIN);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+        digitalWrite(scl, HIGH);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+        digitalWrite(sda, HIGH);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+
+        pinMode(sda, INPUT_PULLUP);
+        pinMode(scl, INPUT_PULLUP);
+    }
+
+    result.released = digitalRead(sda) == HIGH && digitalRead(scl) == HIGH;
+    result.durationUs = micros() - start;
+    return result;
+}
+
+void I2CBusHealth::recordRecovery(uint8_t bus, const I2CRecoveryResult &result, bool ok,
+                                  uint32_t durationUs, uint32_t nowMs)
+{
+    if (bus >= I2C_HEALTH_BUSES)
+        return;
+
+    if (result.sdaStuck)
+        stats.sdaStuck++;
+    if (result.sclStuck)
+        stats.sclStuck++;
+
+    // Whether it worked shows in the next cycles' reads; until then the
+    // fault count starts over and the next attempt waits
+    busFaultCycles[bus] = 0;
+    recoveryIntervalMs[bus] = recoveryIntervalMs[bus] == 0 ? I2C_RECOVERY_RETRY_MS
+                                                           : backoff(recoveryIntervalMs[bus]);
+    recoveryAtMs[bus] = nowMs + recoveryIntervalMs[bus];
+
+    if (ok)
+        stats.recoveries++;
+    else
+        stats.recoveryFailures++;
+    post(ok ? I2CHealthEventType::BUS_RECOVERED : I2CHealthEventType::BUS_RECOVERY_FAILED,
+         bus, 255, nowMs, &result, durationUs);
+}
+
+void I2CBusHealth::post(I2CHealthEventType type, uint8_t bus, uint8_t sensor, uint32_t nowMs,
+                        const I2CRecoveryResult *result, uint32_t durationUs)
+{
+    I2CHealthEvent event = {};
+    event.type = type;
+    event.bus = bus;
+    event.sensor = sensor;
+    if (result != nullptr)
+    {
+        event.sdaStuck = result->sdaStuck;
+        event.sclStuck = result->sclStuck;
+        event.pulses = result->pulses;
+    }
+    event.durationUs = durationUs;
+    event.timestampMs = nowMs;
+    events.push(event);
+}
+
+uint16_t I2CBusHealth::backoff(uint16_t intervalMs)
+{
+    uint32_t next = (uint32_t)intervalMs * 2;
+    return next > I2C_HEALTH_BACKOFF_MAX_MS ? I2C_HEALTH_BACKOFF_MAX_MS : (uint16_t)next;
+}
@@ -0,0 +1,192 @@
+/**
+ * I2CBusHealth - Sensor bus fault detection, quarantine and recovery
+ *
+ * Read failures used to be counted (SessionSummary::i2c_errors) and
+ * logged, nothing more: a bus held low after ESD or a board hot-plug
+ * failed every read at full rate until a restart. The sensor task now
+ * reports each read here and acts on the verdicts between cycles:
+ *
+ * - Sensor fault: I2C_QUARANTINE_FAILURES consecutive failed reads of one
+ *   sensor while others on its bus still answer. The sensor is left out of
+ *   the cycle, so the rest keep full rate, and is re-probed after
+ *   I2C_QUARANTINE_PROBE_MS (doubling per failed probe, up to
+ *   I2C_HEALTH_BACKOFF_MAX_MS). A good probe restores it.
+ * - Bus fault: every read on a bus failed for I2C_BUS_FAULT_CYCLES cycles
+ *   in a row. The controller is released, SDA/SCL are sampled, SCL is
+ *   clocked until the slave holding SDA lets go (at most
+ *   I2C_RECOVERY_PULSES) and a STOP is sent (clearBus()); the caller then
+ *   restarts the controller and re-verifies the mux state. Attempts back
+ *   off like probes while the bus stays down.
+ *
+ * Verdicts are I2CHealthEvents in a small SPSC ring: the sensor task
+ * produces them, loop() turns them into statuses.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "../memory/SPSCRing.h"
+#include "../sensor/SensorFrame.h"
+
+// Consecutive failed reads of one sensor (bus otherwise working) before it
+// is quarantined
+#ifndef I2C_QUARANTINE_FAILURES
+#define I2C_QUARANTINE_FAILURES 8
+#endif
+
+// First re-probe of a quarantined sensor
+#ifndef I2C_QUARANTINE_PROBE_MS
+#define I2C_QUARANTINE_PROBE_MS 250
+#endif
+
+// Cycles in which every read on a bus failed before it is recovered
+#ifndef I2C_BUS_FAULT_CYCLES
+#define I2C_BUS_FAULT_CYCLES 3
+#endif
+
+// First retry of a recovery that did not bring the bus back
+#ifndef I2C_RECOVERY_RETRY_MS
+#define I2C_RECOVERY_RETRY_MS 100
+#endif
+
+// Probe / recovery back-off cap
+#ifndef I2C_HEALTH_BACKOFF_MAX_MS
+#define I2C_HEALTH_BACKOFF_MAX_MS 8000
+#endif
+
+// SCL pulses sent to free SDA (a slave mid-byte needs at most 9)
+#define I2C_RECOVERY_PULSES 9
+
+// Half period of the recovery clock (~100 kHz)
+#define I2C_RECOVERY_HALF_PERIOD_US 5
+
+#define I2C_HEALTH_BUSES 2
+
+enum class I2CHealthEventType : uint8_t
+{
+    BUS_RECOVERED,
+    BUS_RECOVERY_FAILED,
+    SENSOR_QUARANTINED,
+    SENSOR_RESTORED
+};
+
+/**
+ * Outcome of clearBus()
+ */
+struct I2CRecoveryResult
+{
+    bool sdaStuck = false; // SDA low with the bus released
+    bool sclStuck = false; // SCL low with the bus released (cannot be cleared here)
+    bool released = false; // Both lines high afterwards
+    uint8_t pulses = 0;    // SCL pulses sent
+    uint32_t durationUs = 0;
+};
+
+struct I2CHealthEvent
+{
+    I2CHealthEventType type;
+    uint8_t bus;    // I2C controller (0 = Wire, 1 = Wire1)
+    uint8_t sensor; // Position (sensor events), 255 for bus events
+    bool sdaStuck;
+    bool sclStuck;
+    uint8_t pulses;
+    uint32_t durationUs; // Recovery: clear + restart + mux verify
+    uint32_t timestampMs;
+};
+
+struct I2CHealthStats
+{
+    uint32_t recoveries = 0;       // Recoveries that brought a bus back
+    uint32_t recoveryFailures = 0; // Recoveries after which the bus still failed
+    uint32_t sdaStuck = 0;         // Recoveries that found SDA held low
+    uint32_t sclStuck = 0;         // Recoveries that found SCL held low
+    uint32_t quarantines = 0;
+    uint32_t restores = 0;
+    uint32_t droppedEvents = 0;    // Events lost to a full ring
+};
+
+class I2CBusHealth
+{
+public:
+    /**
+     * Start of a collection: nothing quarantined, no fault counts
+     * (cumulative stats are kept)
+     */
+    void reset();
+
+    /**
+     * Outcome of one read this cycle (sensor task). A read of a
+     * quarantined sensor is its probe.
+     */
+    void recordRead(uint8_t sensor, uint8_t bus, bool ok);
+
+    /**
+     * End of a cycle: quarantine / restore sensors, count bus faults
+     * @param restored Output: sensors taken out of quarantine this cycle
+     * @return Buses (bit per bus) whose recovery is due now
+     */
+    uint8_t endCycle(uint32_t nowMs, SensorMask &restored);
+
+    SensorMask getQuarantined() const { return quarantined; }
+
+    /**
+     * Buses (bit per bus) in fault: not read until their recovery
+     */
+    uint8_t getBusesDown() const;
+
+    /**
+     * Quarantined sensors whose re-probe is due
+     */
+    SensorMask probesDue(uint32_t nowMs) const;
+
+    /**
+     * Free a stuck bus by bit-banging its pins. The controller must be
+     * released first (TwoWire::end()) and restarted afterwards.
+     */
+    static I2CRecoveryResult clearBus(int sda, int scl);
+
+    /**
+     * Report a recovery attempt
+     * @param ok Lines released, controller restarted and mux state verified
+     */
+    void recordRecovery(uint8_t bus, const I2CRecoveryResult &result, bool ok,
+                        uint32_t durationUs, uint32_t nowMs);
+
+    /**
+     * Next event (loop() only)
+     */
+    bool popEvent(I2CHealthEvent &event) { return events.pop(event); }
+
+    I2CHealthStats getStats() const
+    {
+        I2CHealthStats copy = stats;
+        copy.droppedEvents = events.overflowCount();
+        return copy;
+    }
+
+private:
+    // Per sensor
+    uint8_t failures[NUM_SENSORS] = {0}; // Consecutive, while not quarantined
+    uint8_t sensorBus[NUM_SENSORS] = {0};
+    uint32_t probeAtMs[NUM_SENSORS] = {0};
+    uint16_t probeIntervalMs[NUM_SENSORS] = {0};
+    volatile SensorMask quarantined = 0;
+
+    // This cycle
+    SensorMask cycleOk = 0;
+    SensorMask cycleFailed = 0;
+    uint8_t busOk = 0;
+    uint8_t busFailed = 0;
+
+    // Per bus
+    uint8_t busFaultCycles[I2C_HEALTH_BUSES] = {0};
+    uint32_t recoveryAtMs[I2C_HEALTH_BUSES] = {0};
+    uint16_t recoveryIntervalMs[I2C_HEALTH_BUSES] = {0};
+
+    I2CHealthStats stats;
+    SPSCRing<I2CHealthEvent, 16> events;
+
+    void post(I2CHealthEventType type, uint8_t bus, uint8_t sensor, uint32_t nowMs,
+              const I2CRecoveryResult *result = nullptr, uint32_t durationUs = 0);
+    static uint16_t backoff(uint16_t intervalMs);
+};
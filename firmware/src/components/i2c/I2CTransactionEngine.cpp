@@ -0,0 +1,195 @@
+/**
+ * I2CTransactionEngine - Implementation
+ *
+ * See I2CTransactionEngine.h for documentation.
+ */
+
+#include "I2CTransactionEngine.h"
+
+I2CTransactionEngine::I2CTransactionEngine(i2c_port_t port)
+    : _port(port)
+    , _cmd(nullptr)
+    , _opCount(0)
+    , _building(false)
+    , _ready(false)
+    , _lastDurationUs(0)
+{
+}
+
+I2CTransactionEngine::~I2CTransactionEngine()
+{
+    if (_cmd != nullptr) {
+        i2c_cmd_link_delete_static(_cmd);
+        _cmd = nullptr;
+    }
+}
+
+void I2CTransactionEngine::beginPlan()
+{
+    if (_cmd != nullptr) {
+        i2c_cmd_link_delete_static(_cmd);
+    }
+
+    _cmd = i2c_cmd_link_create_static(_linkBuffer, sizeof(_linkBuffer));
+    _opCount = 0;
+    _ready = false;
+    _building = (_cmd != nullptr);
+}
+
+bool I2CTransactionEngine::addWrite(uint8_t address, uint8_t value)
+{
+    if (!_building || _opCount >= I2C_ENGINE_MAX_OPS) {
+        abortPlan();
+        return false;
+    }
+
+    bool ok = i2c_master_start(_cmd) == ESP_OK &&
+              i2c_master_write_byte(_cmd, (address << 1) | I2C_MASTER_WRITE, true) == ESP_OK &&
+              i2c_master_write_byte(_cmd, value, true) == ESP_OK &&
+              i2c_master_stop(_cmd) == ESP_OK;
+
+    if (!ok) {
+        abortPlan();
+        return false;
+    }
+
+    _opCount++;
+    return true;
+}
+
+bool I2CTransactionEngine::addRegisterWrite(uint8_t address, uint8_t reg, uint8_t low, uint8_t high)
+{
+    if (!_building || _opCount >= I2C_ENGINE_MAX_OPS) {
+        abortPlan();
+        return false;
+    }
+
+    bool ok = i2c_master_start(_cmd) == ESP_OK &&
+              i2c_master_write_byte(_cmd, (address << 1) | I2C_MASTER_WRITE, true) == ESP_OK &&
+              i2c_master_write_byte(_cmd, reg, true) == ESP_OK &&
+              i2c_master_write_byte(_cmd, low, true) == ESP_OK &&
+              i2c_master_write_byte(_cmd, high, true) == ESP_OK &&
+              i2c_master_stop(_cmd) == ESP_OK;
+
+    if (!ok) {
+        abortPlan();
+        return false;
+    }
+
+    _opCount++;
+    return true;
+}
+
+bool I2CTransactionEngine::addRegisterRead(uint8_t address, uint8_t reg, uint8_t *dest, size_t len)
+{
+    if (!_building || dest == nullptr || len == 0 || _opCount >= I2C_ENGINE_MAX_OPS) {
+        abortPlan();
+        return false;
+    }
+
+    if (!queueRead(_cmd, address, reg, dest, len) || i2c_master_stop(_cmd) != ESP_OK) {
+        abortPlan();
+        return false;
+    }
+
+    _opCount++;
+    return true;
+}
+
+bool I2CTransactionEngine::addRegisterReadPair(uint8_t address, uint8_t regA, uint8_t *destA,
+                                               uint8_t regB, uint8_t *destB, size_t len)
+{
+    if (!_building || destA == nullptr || destB == nullptr || len == 0 ||
+        _opCount >= I2C_ENGINE_MAX_OPS) {
+        abortPlan();
+        return false;
+    }
+
+    // Second read starts with a repeated START - no STOP between the two
+    bool ok = queueRead(_cmd, address, regA, destA, len) &&
+              queueRead(_cmd, address, regB, destB, len) &&
+              i2c_master_stop(_cmd) == ESP_OK;
+
+    if (!ok) {
+        abortPlan();
+        return false;
+    }
+
+    _opCount++;
+    return true;
+}
+
+bool I2CTransactionEngine::commitPlan()
+{
+    if (!_building || _opCount == 0) {
+        abortPlan();
+        return false;
+    }
+
+    _building = false;
+    _ready = true;
+    return true;
+}
+
+esp_err_t I2CTransactionEngine::execute(uint32_t timeoutMs)
+{
+    if (!_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t start = micros();
+    esp_err_t err = i2c_master_cmd_begin(_port, _cmd, pdMS_TO_TICKS(timeoutMs));
+    _lastDurationUs = micros() - start;
+
+    return err;
+}
+
+esp_err_t I2CTransactionEngine::readRegisters(i2c_port_t port, uint8_t address,
+                                              uint8_t regA, uint8_t *destA,
+                                              uint8_t regB, uint8_t *destB,
+                                              size_t len, uint32_t timeoutMs)
+{
+    if (destA == nullptr || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t linkBuffer[I2C_LINK_RECOMMENDED_SIZE(2)];
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(linkBuffer, sizeof(linkBuffer));
+    if (cmd == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    bool ok = queueRead(cmd, address, regA, destA, len);
+    if (ok && destB != nullptr) {
+        ok = queueRead(cmd, address, regB, destB, len);
+    }
+    ok = ok && i2c_master_stop(cmd) == ESP_OK;
+
+    esp_err_t err = ok ? i2c_master_cmd_begin(port, cmd, pdMS_TO_TICKS(timeoutMs)) : ESP_ERR_NO_MEM;
+    i2c_cmd_link_delete_static(cmd);
+    return err;
+}
+
+bool I2CTransactionEngine::queueRead(i2c_cmd_handle_t cmd, uint8_t address, uint8_t reg,
+                                     uint8_t *dest, size_t len)
+{
+    // Same sequence as Wire's endTransmission(false) + requestFrom():
+    // START, addr+W, reg, RESTART, addr+R, data..., NACK on last
+    return i2c_master_start(cmd) == ESP_OK &&
+           i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true) == ESP_OK &&
+           i2c_master_write_byte(cmd, reg, true) == ESP_OK &&
+           i2c_master_start(cmd) == ESP_OK &&
+           i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true) == ESP_OK &&
+           i2c_master_read(cmd, dest, len, I2C_MASTER_LAST_NACK) == ESP_OK;
+}
+
+void I2CTransactionEngine::abortPlan()
+{
+    if (_cmd != nullptr) {
+        i2c_cmd_link_delete_static(_cmd);
+        _cmd = nullptr;
+    }
+    _opCount = 0;
+    _building = false;
+    _ready = false;
+}
@@ -0,0 +1,178 @@
+/**
+ * I2CTransactionEngine - Pre-built ESP-IDF command-link execution
+ *
+ * Wraps the ESP-IDF i2c_master command-link API so that a whole sequence of
+ * bus operations (mux channel writes + sensor register reads) can be built
+ * ONCE into a static command list and then replayed every sampling cycle.
+ *
+ * Why:
+ *   The Wire path pays a full driver round-trip (link build, mutex, ISR
+ *   setup) for every beginTransmission/requestFrom pair. For a 6-sensor
+ *   cycle that is ~20 separate driver calls. Replaying one pre-built list
+ *   is a single driver call, and the calling task blocks on the driver's
+ *   ISR completion event instead of spinning, so Core 0 is free until the
+ *   hardware finishes the whole cycle.
+ *
+ * Notes:
+ *   - arduino-esp32 2.0.x implements Wire on top of the same IDF driver, so
+ *     the port must already be initialized via Wire.begin(). The IDF driver
+ *     serializes access per port, so Wire and the engine can share the bus.
+ *   - Every operation ends with a STOP. TCA9548A/PCA9546A only latch a new
+ *     channel mask on STOP, so mux writes cannot be chained with repeated
+ *     starts. Register reads of one device can (addRegisterReadPair).
+ *   - Read destinations are raw pointers captured at plan time - the
+ *     buffers must outlive the plan.
+ *
+ * Usage:
+ *   I2CTransactionEngine engine;
+ *   engine.beginPlan();
+ *   engine.addWrite(0x70, 1 << 0);                 // TCA channel 0
+ *   engine.addRegisterRead(0x60, 0x08, buf, 2);    // PS_DATA
+ *   engine.commitPlan();
+ *   if (engine.execute() == ESP_OK) { ... use buf ... }
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <driver/i2c.h>
+
+// Maximum number of operations (writes or register reads) in one plan
+#define I2C_ENGINE_MAX_OPS 32
+
+// Static command-link storage for a full plan
+#define I2C_ENGINE_LINK_BUFFER_SIZE I2C_LINK_RECOMMENDED_SIZE(I2C_ENGINE_MAX_OPS)
+
+// Default execution timeout for one plan
+#define I2C_ENGINE_DEFAULT_TIMEOUT_MS 20
+
+class I2CTransactionEngine {
+public:
+    /**
+     * Constructor
+     * @param port IDF I2C port (Wire = I2C_NUM_0)
+     */
+    I2CTransactionEngine(i2c_port_t port = I2C_NUM_0);
+
+    ~I2CTransactionEngine();
+
+    /**
+     * Discard any existing plan and start building a new one
+     */
+    void beginPlan();
+
+    /**
+     * Append a single-byte write (e.g. a mux channel mask)
+     * @param address 7-bit device address
+     * @param value Byte to write
+     * @return true if the operation fit in the command buffer
+     */
+    bool addWrite(uint8_t address, uint8_t value);
+
+    /**
+     * Append a 16-bit register write: register, low byte, high byte
+     * (VCNL4040 command-code layout)
+     * @param address 7-bit device address
+     * @param reg Register (command code) to write
+     * @param low Low data byte
+     * @param high High data byte
+     * @return true if the operation fit in the command buffer
+     */
+    bool addRegisterWrite(uint8_t address, uint8_t reg, uint8_t low, uint8_t high);
+
+    /**
+     * Append a register read: write register pointer, repeated start, read
+     * @param address 7-bit device address
+     * @param reg Register (command code) to read from
+     * @param dest Destination buffer (must stay valid for the plan's lifetime)
+     * @param len Number of bytes to read (>= 1)
+     * @return true if the operation fit in the command buffer
+     */
+    bool addRegisterRead(uint8_t address, uint8_t reg, uint8_t *dest, size_t len);
+
+    /**
+     * Append two register reads fused into ONE bus transaction:
+     * START, reg A read, RESTART, reg B read, STOP. Parts like the VCNL4040
+     * have no register auto-increment, so this is the cheapest way to get
+     * two registers - it saves a STOP/START and the driver round-trip.
+     * @param address 7-bit device address
+     * @param regA First register
+     * @param destA Destination for regA (len bytes)
+     * @param regB Second register
+     * @param destB Destination for regB (len bytes)
+     * @param len Bytes per register (default 2)
+     * @return true if the operation fit in the command buffer
+     */
+    bool addRegisterReadPair(uint8_t address, uint8_t regA, uint8_t *destA,
+                             uint8_t regB, uint8_t *destB, size_t len = 2);
+
+    /**
+     * Finish the plan. Must be called before execute().
+     * @return true if the plan is valid and ready to run
+     */
+    bool commitPlan();
+
+    /**
+     * Run the committed plan. Blocks the calling task (without spinning)
+     * until the hardware completes the whole list or the timeout expires.
+     * @param timeoutMs Maximum time to wait for the bus
+     * @return ESP_OK on success, IDF error code otherwise
+     */
+    esp_err_t execute(uint32_t timeoutMs = I2C_ENGINE_DEFAULT_TIMEOUT_MS);
+
+    /**
+     * One-shot fused read of one or two registers (no plan needed).
+     * Uses a small stack-allocated command link.
+     * @param port IDF I2C port
+     * @param address 7-bit device address
+     * @param regA First register
+     * @param destA Destination for regA (len bytes)
+     * @param regB Second register (ignored if destB is nullptr)
+     * @param destB Destination for regB, or nullptr for a single read
+     * @param len Bytes per register
+     * @param timeoutMs Maximum time to wait for the bus
+     * @return ESP_OK on success, IDF error code otherwise
+     */
+    static esp_err_t readRegisters(i2c_port_t port, uint8_t address,
+                                   uint8_t regA, uint8_t *destA,
+                                   uint8_t regB, uint8_t *destB,
+                                   size_t len = 2,
+                                   uint32_t timeoutMs = I2C_ENGINE_DEFAULT_TIMEOUT_MS);
+
+    /**
+     * @return true if a committed plan is available
+     */
+    bool isReady() const { return _ready; }
+
+    /**
+     * @return Number of operations in the current plan
+     */
+    uint8_t getOperationCount() const { return _opCount; }
+
+    /**
+     * @return Wall-clock duration of the last execute() in microseconds
+     */
+    uint32_t getLastDurationUs() const { return _lastDurationUs; }
+
+private:
+    i2c_port_t _port;
+    i2c_cmd_handle_t _cmd;
+    uint8_t _opCount;
+    bool _building;
+    bool _ready;
+    uint32_t _lastDurationUs;
+
+    // Backing storage for the static command link (no heap in the hot path)
+    uint8_t _linkBuffer[I2C_ENGINE_LINK_BUFFER_SIZE];
+
+    /**
+     * Abort the plan being built after a command-buffer overflow
+     */
+    void abortPlan();
+
+    /**
+     * Queue START, addr+W, reg, RESTART, addr+R, data (no STOP)
+     * @return true if all commands fit
+     */
+    static bool queueRead(i2c_cmd_handle_t cmd, uint8_t address, uint8_t reg, uint8_t *dest, size_t len);
+};
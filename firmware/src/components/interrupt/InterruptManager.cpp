@@ -26,7 +26,6 @@ InterruptManager::InterruptManager()
     for (int i = 0; i < MUX_NUM_BOARDS; i++)
     {
         _lastIsrTime[i] = 0;
-        _isrPending[i] = false;
     }
 
     // Set singleton instance
@@ -123,7 +122,7 @@ int InterruptManager::calibrateSensors()
         VCNL4040 &sensor = _sensors[pos];
 
         // Initialize sensor with current settings (need it running to read baseline)
-        if (!sensor.begin())
+        if (!sensor.begin(_mux.getWire(pos / MUX_SENSORS_PER_BOARD)))
         {
             Serial.printf("  Sensor %d: begin() failed\n", pos);
             _baselines[pos] = 0;
@@ -279,7 +278,7 @@ bool InterruptManager::configureSensor(uint8_t position)
 
     // Initialize sensor using our enhanced library
     VCNL4040 &sensor = _sensors[position];
-    if (!sensor.begin())
+    if (!sensor.begin(_mux.getWire(position / MUX_SENSORS_PER_BOARD)))
     {
         Serial.printf("    Sensor %d: begin() failed\n", position);
         return false;
@@ -411,13 +410,14 @@ bool InterruptManager::startMonitoring()
     _stats.sessionStartTime = millis();
     _sessionStartUs = micros();
 
-    // Clear ISR pending flags
     for (int i = 0; i < MUX_NUM_BOARDS; i++)
     {
-        _isrPending[i] = false;
         _lastIsrTime[i] = 0;
     }
 
+    // Board plans are rebuilt on first use (topology may have been rescanned)
+    _planBoard[0] = _planBoard[1] = 0xFF;
+
     // Clear event queue
     clearEvents();
 
@@ -480,10 +480,12 @@ void InterruptManager::stopMonitoring()
     detachInterrupt(digitalPinToInterrupt(PIN_SENSOR_INT_2));
     detachInterrupt(digitalPinToInterrupt(PIN_SENSOR_INT_3));
 
-    // Wait for the processing task to exit on its own
-    // The task will self-delete when it sees _monitoring = false
+    // Wake the processing task with the stop bit and wait for it to exit
+    // (it self-deletes after clearing _processingTask)
     if (_processingTask != nullptr)
     {
+        xTaskNotify(_processingTask, INT_NOTIFY_STOP, eSetBits);
+
         // Give task time to notice the flag and clean up
         int timeout = 50; // 500ms max wait
         while (_processingTask != nullptr && timeout > 0)
@@ -603,11 +605,33 @@ void IRAM_ATTR InterruptManager::handleIsr(uint8_t board)
         return;
     }
 
-    // Record timestamp and set pending flag
-    // Keep ISR minimal - just record that something happened
+    // Record timestamp and wake the processing task with this board's bit.
+    // Keep ISR minimal - the I2C work happens in the task.
     _instance->_lastIsrTime[board] = micros();
-    _instance->_isrPending[board] = true;
     _instance->_stats.isrCount++;
+
+    TaskHandle_t task = _instance->_processingTask;
+    if (task != nullptr)
+    {
+        BaseType_t higherPriorityWoken = pdFALSE;
+        xTaskNotifyFromISR(task, 1UL << board, eSetBits, &higherPriorityWoken);
+        if (higherPriorityWoken == pdTRUE)
+            portYIELD_FROM_ISR();
+    }
+}
+
+void InterruptManager::wakeBoards(uint8_t boards)
+{
+    if (!_monitoring || _processingTask == nullptr || boards == 0)
+        return;
+
+    uint32_t now = micros();
+    for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++)
+    {
+        if (boards & (1 << board))
+            _lastIsrTime[board] = now;
+    }
+    xTaskNotify(_processingTask, boards, eSetBits);
 }
 
 // ============================================================================
@@ -620,65 +644,37 @@ void InterruptManager::processingTaskFunc(void *param)
 
     Serial.println("InterruptManager: Processing task started");
 
-    uint32_t lastDebugPoll = 0;
-    const uint32_t DEBUG_POLL_INTERVAL = 2000; // Poll every 2 seconds for debug
+    uint32_t lastDebugPoll = millis();
 
-    while (mgr->_monitoring)
+    // Blocks until an ISR (board bits) or stopMonitoring() (INT_NOTIFY_STOP)
+    // notifies it; it only exits on the stop bit, so stopMonitoring() never
+    // notifies a deleted task
+    while (true)
     {
-        bool anyPending = false;
-
-        // Check each board for pending interrupts
-        for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++)
+        uint32_t pollInterval = mgr->_debugPollIntervalMs;
+        TickType_t wait = portMAX_DELAY;
+        if (pollInterval > 0)
         {
-            if (mgr->_isrPending[board])
-            {
-                anyPending = true;
+            uint32_t elapsed = millis() - lastDebugPoll;
+            wait = elapsed >= pollInterval ? 0 : pdMS_TO_TICKS(pollInterval - elapsed);
+        }
 
-                // Clear pending flag (atomic on ESP32)
-                mgr->_isrPending[board] = false;
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, ULONG_MAX, &bits, wait);
 
-                // Process this board's interrupt
-                mgr->processBoard(board);
-            }
-        }
+        if (bits & INT_NOTIFY_STOP)
+            break;
 
-        // DEBUG: Periodically poll sensors to check if they're detecting anything
-        uint32_t now = millis();
-        if (now - lastDebugPoll > DEBUG_POLL_INTERVAL)
+        for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++)
         {
-            lastDebugPoll = now;
-
-            // Read GPIO states
-            Serial.printf("[DEBUG] GPIO: INT1=%d, INT2=%d, INT3=%d | ",
-                          digitalRead(PIN_SENSOR_INT_1),
-                          digitalRead(PIN_SENSOR_INT_2),
-                          digitalRead(PIN_SENSOR_INT_3));
-
-            // Find the first available sensor to poll
-            // NOTE: We only read proximity, NOT interrupt flags (reading flags clears them!)
-            bool polledSensor = false;
-            for (uint8_t pos = 0; pos < MUX_TOTAL_SENSORS && !polledSensor; pos++)
-            {
-                if (mgr->_mux.isSensorAvailable(pos) && mgr->_mux.selectSensor(pos))
-                {
-                    delayMicroseconds(200);
-                    uint16_t prox = mgr->_sensors[pos].readProximity();
-                    Serial.printf("S%d: prox=%d\n", pos, prox);
-                    polledSensor = true;
-                }
-            }
-            if (!polledSensor)
-            {
-                Serial.println("No sensors available to poll");
-            }
+            if (bits & (1UL << board))
+                mgr->processBoard(board);
         }
 
-        // If nothing pending, yield briefly
-        // Use minimal delay to maximize responsiveness for direction detection
-        if (!anyPending)
+        if (pollInterval > 0 && millis() - lastDebugPoll >= pollInterval)
         {
-            // Yield without delay - just let other tasks run briefly
-            taskYIELD();
+            lastDebugPoll = millis();
+            mgr->debugPoll();
         }
     }
 
@@ -692,51 +688,44 @@ void InterruptManager::processingTaskFunc(void *param)
     vTaskDelete(NULL);
 }
 
-void InterruptManager::processBoard(uint8_t board)
+void InterruptManager::debugPoll()
 {
-    // Calculate timestamp relative to session start
-    uint32_t timestamp_us = _lastIsrTime[board] - _sessionStartUs;
-
-    // Get positions of sensors on this board
-    uint8_t sensor1 = board * 2;     // S1
-    uint8_t sensor2 = board * 2 + 1; // S2
-
-    // OPTIMIZED APPROACH for direction detection:
-    // Check S1 first. If it has a flag, process it and RETURN IMMEDIATELY.
-    // This clears the flag and allows GPIO to go HIGH, so if S2 triggers
-    // shortly after, we'll get a NEW interrupt with a NEW timestamp.
-    // This maximizes our chance of distinguishing S1 vs S2 timing.
-
-    // Check sensor 1 first
-    if (_mux.isSensorAvailable(sensor1))
+    // Read GPIO states
+    Serial.printf("[DEBUG] GPIO: INT1=%d, INT2=%d, INT3=%d | ",
+                  digitalRead(PIN_SENSOR_INT_1),
+                  digitalRead(PIN_SENSOR_INT_2),
+                  digitalRead(PIN_SENSOR_INT_3));
+
+    // Find the first available sensor to poll
+    // NOTE: We only read proximity, NOT interrupt flags (reading flags clears them!)
+    for (uint8_t pos = 0; pos < MUX_TOTAL_SENSORS; pos++)
     {
-        if (_mux.selectSensor(sensor1))
+        if (_mux.isSensorAvailable(pos) && _mux.selectSensor(pos))
         {
-            delayMicroseconds(50); // Minimal settle time
-            if (processSensor(sensor1, timestamp_us))
-            {
-                // S1 had a flag - we've cleared it
-                // Return immediately to allow GPIO to reset for S2
-                _mux.disableCurrentPCA();
-                return;
-            }
+            delayMicroseconds(200);
+            uint16_t prox = _sensors[pos].readProximity();
+            Serial.printf("S%d: prox=%d\n", pos, prox);
+            return;
         }
     }
+    Serial.println("No sensors available to poll");
+}
 
-    // S1 didn't have a flag, check sensor 2
-    if (_mux.isSensorAvailable(sensor2))
+void InterruptManager::processBoard(uint8_t board)
+{
+    // Calculate timestamp relative to session start
+    uint32_t timestamp_us = _lastIsrTime[board] - _sessionStartUs;
+
+    // Batched: both sensors' flags are read and cleared within one replay,
+    // so the INT line is released for the next edge either way
+    uint8_t events = 0;
+    if (!readBoardBatched(board, timestamp_us, events))
     {
-        if (_mux.selectSensor(sensor2))
-        {
-            delayMicroseconds(50); // Minimal settle time
-            if (processSensor(sensor2, timestamp_us))
-            {
-                // S2 had a flag - we've cleared it
-                _mux.disableCurrentPCA();
-                return;
-            }
-        }
+        _stats.wireFallbacks++;
+        events = readBoardWire(board, timestamp_us) ? 1 : 0;
     }
+    if (events > 0)
+        return;
 
     // Neither sensor had flags set - create an "unknown" event
     // This can happen if the interrupt was very brief or already cleared
@@ -746,13 +735,111 @@ void InterruptManager::processBoard(uint8_t board)
     evt.sensorId = 255; // Unknown which sensor
     evt.type = InterruptEventType::UNKNOWN;
     evt.rawFlags = 0;
+    evt.proximity = 0;
 
     queueEvent(evt);
     _stats.unknownEvents++;
     _stats.totalEvents++;
+}
+
+bool InterruptManager::buildBoardPlan(uint8_t board)
+{
+    uint8_t bus = _mux.getBoardBus(board);
+    if (_planBoard[bus] == board && _boardPlans[bus].isReady())
+        return true;
+    _planBoard[bus] = 0xFF;
+
+    uint8_t pca = _mux.getBoardInfo(board).pcaAddress;
+    if (pca == 0)
+        return false;
+
+    I2CTransactionEngine &plan = _boardPlans[bus];
+    plan.beginPlan();
+    bool ok = true;
+    if (bus == 0)
+    {
+        ok = plan.addWrite(_mux.getTCAAddress(), 1 << board);
+    }
+    else
+    {
+        // Wire1 has no TCA: close the other Wire1 boards' PCAs so only this
+        // board answers at 0x60
+        for (uint8_t other = 0; ok && other < MUX_NUM_BOARDS; other++)
+        {
+            uint8_t otherPca = _mux.getBoardInfo(other).pcaAddress;
+            if (other != board && _mux.getBoardBus(other) == 1 && otherPca != 0)
+                ok = plan.addWrite(otherPca, 0x00);
+        }
+    }
+
+    for (uint8_t s = 0; ok && s < MUX_SENSORS_PER_BOARD; s++)
+    {
+        if (!_mux.isSensorAvailable(board * MUX_SENSORS_PER_BOARD + s))
+            continue;
+        ok = plan.addWrite(pca, 1 << s) &&
+             plan.addRegisterReadPair(VCNL4040_ADDR, VCNL4040_INT_FLAG, &_boardRx[bus][s][0],
+                                      VCNL4040_PS_DATA, &_boardRx[bus][s][2]);
+    }
+
+    // Same end state as the Wire path: this board's PCA closed
+    ok = ok && plan.addWrite(pca, 0x00) && plan.commitPlan();
+    if (ok)
+        _planBoard[bus] = board;
+    return ok;
+}
+
+bool InterruptManager::readBoardBatched(uint8_t board, uint32_t timestamp_us, uint8_t &events)
+{
+    events = 0;
+    if (!buildBoardPlan(board))
+        return false;
+
+    uint8_t bus = _mux.getBoardBus(board);
+    esp_err_t err = _boardPlans[bus].execute();
+    // The plan drove the muxes behind the controller's cache
+    _mux.invalidateCache();
+    if (err != ESP_OK)
+        return false;
+
+    for (uint8_t s = 0; s < MUX_SENSORS_PER_BOARD; s++)
+    {
+        uint8_t position = board * MUX_SENSORS_PER_BOARD + s;
+        if (!_mux.isSensorAvailable(position))
+            continue;
+        const uint8_t *rx = _boardRx[bus][s];
+        // INT_FLAG is the high byte; PS_DATA is little-endian
+        if (queueSensorEvent(position, rx[1], rx[2] | (rx[3] << 8), timestamp_us))
+            events++;
+    }
+    return true;
+}
+
+bool InterruptManager::readBoardWire(uint8_t board, uint32_t timestamp_us)
+{
+    // Get positions of sensors on this board
+    uint8_t sensor1 = board * 2;     // S1
+    uint8_t sensor2 = board * 2 + 1; // S2
+
+    // Check S1 first. If it has a flag, process it and RETURN IMMEDIATELY.
+    // This clears the flag and allows GPIO to go HIGH, so if S2 triggers
+    // shortly after, we'll get a NEW interrupt with a NEW timestamp.
+    bool found = false;
+    if (_mux.isSensorAvailable(sensor1) && _mux.selectSensor(sensor1))
+    {
+        delayMicroseconds(50); // Minimal settle time
+        found = processSensor(sensor1, timestamp_us);
+    }
+
+    // S1 didn't have a flag, check sensor 2
+    if (!found && _mux.isSensorAvailable(sensor2) && _mux.selectSensor(sensor2))
+    {
+        delayMicroseconds(50); // Minimal settle time
+        found = processSensor(sensor2, timestamp_us);
+    }
 
     // Clean up MUX state
     _mux.disableCurrentPCA();
+    return found;
 }
 
 bool InterruptManager::processSensor(uint8_t position, uint32_t timestamp_us)
@@ -768,15 +855,28 @@ bool InterruptManager::processSensor(uint8_t position, uint32_t timestamp_us)
         return false; // No interrupt from this sensor
     }
 
+    return queueSensorEvent(position, flags.raw, sensor.readProximity(), timestamp_us);
+}
+
+bool InterruptManager::queueSensorEvent(uint8_t position, uint8_t flagByte, uint16_t proximity, uint32_t timestamp_us)
+{
+    bool psClose = (flagByte & VCNL4040_INT_FLAG_PS_IF_CLOSE) != 0;
+    bool psAway = (flagByte & VCNL4040_INT_FLAG_PS_IF_AWAY) != 0;
+    if (!psClose && !psAway)
+    {
+        return false; // No interrupt from this sensor
+    }
+
     // Create event
     InterruptEvent evt;
     evt.timestamp_us = timestamp_us;
     evt.boardId = (position / 2) + 1;
     evt.sensorId = position;
-    evt.rawFlags = flags.raw;
+    evt.rawFlags = flagByte;
+    evt.proximity = proximity;
 
     // Determine event type
-    if (flags.psClose)
+    if (psClose)
     {
         evt.type = InterruptEventType::CLOSE;
         _stats.closeEvents++;
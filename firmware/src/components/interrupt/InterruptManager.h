@@ -9,10 +9,17 @@
  *   - GPIO 11 (PIN_SENSOR_INT_1): Sensor board 1 (TCA channel 0) - P1S1 & P1S2
  *   - GPIO 12 (PIN_SENSOR_INT_2): Sensor board 2 (TCA channel 1) - P2S1 & P2S2
  *   - GPIO 13 (PIN_SENSOR_INT_3): Sensor board 3 (TCA channel 2) - P3S1 & P3S2
+ *   - Boards past the third (SENSOR_MAX_BOARDS > 3) have no INT line and
+ *     are not monitored here
  *
  * Note: Each GPIO receives combined interrupts from 2 sensors on the same board
  * (via Schottky diode OR-ing on the sensor PCB). When an interrupt fires, we
  * must scan both sensors on that board to determine which one(s) triggered.
+ * That scan is one pre-built I2CTransactionEngine command list per board:
+ * mux selects plus a fused INT_FLAG + PS_DATA read for each sensor, so
+ * every event carries the proximity value at its edge for about the bus
+ * cost of the flag reads alone. If the list fails the sensors are read one
+ * at a time over Wire instead.
  *
  * Operation Modes:
  *   1. Normal Interrupt Mode: INT fires on threshold crossing, must read flag to clear
@@ -37,6 +44,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/task.h>
+#include "../i2c/I2CTransactionEngine.h"
 #include "../mux/MuxController.h"
 #include "../vcnl4040/VCNL4040.h"
 #include "../calibration/CalibrationData.h"
@@ -52,6 +60,17 @@
 // Maximum time to wait for event processing (ms)
 #define INT_PROCESSING_TIMEOUT_MS 10
 
+// Board bits 0..MUX_NUM_BOARDS-1 of the processing task's notification
+// value come from the ISRs; this bit asks the task to exit
+#define INT_NOTIFY_STOP (1UL << 31)
+
+// Opt-in diagnostic: every N ms the processing task prints the INT pin
+// states and one sensor's proximity (an I2C read). 0 = off, so an idle
+// room costs no CPU and no bus traffic. See setDebugPollInterval().
+#ifndef INT_DEBUG_POLL_INTERVAL_MS
+#define INT_DEBUG_POLL_INTERVAL_MS 0
+#endif
+
 // Default detection threshold (margin above/below calibrated baseline)
 // Based on actual measurements: objects at 250mm produce only 8-25 counts above baseline
 #define INT_DEFAULT_THRESHOLD_MARGIN 10 // Trigger when proximity increases by 10+ (very sensitive)
@@ -83,14 +102,15 @@ struct InterruptEvent
 {
     uint32_t timestamp_us;   // Microseconds since start of session
     uint8_t boardId;         // Which board triggered (1-3)
-    uint8_t sensorId;        // Which sensor triggered (0-5 position, or 255 if unknown)
+    uint8_t sensorId;        // Which sensor triggered (position, or 255 if unknown)
     InterruptEventType type; // CLOSE or AWAY
     uint8_t rawFlags;        // Raw INT_FLAG register value for debugging
+    uint16_t proximity;      // PS_DATA read with the flags (0 if unknown)
 
     // Helper to get sensor name
     String getSensorName() const
     {
-        if (sensorId < 6)
+        if (sensorId < MUX_TOTAL_SENSORS)
         {
             uint8_t pcb = (sensorId / 2) + 1;
             uint8_t side = (sensorId % 2) + 1;
@@ -152,6 +172,7 @@ struct InterruptSessionStats
     uint32_t unknownEvents;
     uint32_t droppedEvents;    // Events lost due to full buffer
     uint32_t isrCount;         // Total ISR invocations
+    uint32_t wireFallbacks;    // Board reads that fell back to per-sensor Wire reads
     uint32_t sessionStartTime; // millis() when session started
 };
 
@@ -204,6 +225,12 @@ public:
      */
     bool isMonitoring() const { return _monitoring; }
 
+    /**
+     * A light sleep ended with these boards' INT lines low (bit = board
+     * index): process them as if their ISRs had fired
+     */
+    void wakeBoards(uint8_t boards);
+
     /**
      * Check if there are events waiting
      * @return true if events available
@@ -240,6 +267,12 @@ public:
      */
     void resetStats();
 
+    /**
+     * Periodic debug poll of the INT pins and one sensor (0 = off).
+     * Takes effect at the processing task's next wake.
+     */
+    void setDebugPollInterval(uint32_t intervalMs) { _debugPollIntervalMs = intervalMs; }
+
     /**
      * Get reference to MuxController (for advanced use)
      */
@@ -298,13 +331,22 @@ private:
     QueueHandle_t _eventQueue;
     TaskHandle_t _processingTask;
 
-    // ISR tracking - volatile because accessed from ISR
+    // ISR tracking - volatile because accessed from ISR; pending boards
+    // travel as bits of the processing task's notification value
     volatile uint32_t _lastIsrTime[MUX_NUM_BOARDS];
-    volatile bool _isrPending[MUX_NUM_BOARDS];
+
+    volatile uint32_t _debugPollIntervalMs = INT_DEBUG_POLL_INTERVAL_MS;
 
     // Session timing
     uint32_t _sessionStartUs;
 
+    // Batched board reads, one plan per bus (Wire, Wire1) kept for the
+    // board it was last built for. Destinations: INT_FLAG then PS_DATA
+    // (2 bytes each) per sensor on the board.
+    I2CTransactionEngine _boardPlans[2] = {{I2C_NUM_0}, {I2C_NUM_1}};
+    uint8_t _planBoard[2] = {0xFF, 0xFF};
+    uint8_t _boardRx[2][MUX_SENSORS_PER_BOARD][4];
+
     /**
      * Configure a single sensor for interrupt mode
      * @param position Sensor position (0-5)
@@ -319,6 +361,26 @@ private:
      */
     void processBoard(uint8_t board);
 
+    /**
+     * (Re)build the batched read plan for a board on its bus
+     * @return true if the plan is ready
+     */
+    bool buildBoardPlan(uint8_t board);
+
+    /**
+     * Read INT_FLAG and PS_DATA of both sensors on a board in one plan
+     * replay and queue an event per flagged sensor
+     * @param events Output: number of events queued
+     * @return false if the plan could not be built or run
+     */
+    bool readBoardBatched(uint8_t board, uint32_t timestamp_us, uint8_t &events);
+
+    /**
+     * Per-sensor Wire path: stops at the first flagged sensor
+     * @return true if an event was queued
+     */
+    bool readBoardWire(uint8_t board, uint32_t timestamp_us);
+
     /**
      * Read and process interrupt flags from a sensor
      * @param position Sensor position (0-5)
@@ -327,6 +389,12 @@ private:
      */
     bool processSensor(uint8_t position, uint32_t timestamp_us);
 
+    /**
+     * Queue the event for a sensor's INT_FLAG byte
+     * @return true if it had a PS interrupt flag set
+     */
+    bool queueSensorEvent(uint8_t position, uint8_t flagByte, uint16_t proximity, uint32_t timestamp_us);
+
     /**
      * Add event to queue
      * @param event Event to add
@@ -334,8 +402,14 @@ private:
      */
     bool queueEvent(const InterruptEvent &event);
 
+    /**
+     * Diagnostic print of INT pin states and one sensor's proximity
+     */
+    void debugPoll();
+
     /**
      * Processing task function (static for FreeRTOS)
+     * Blocks on its task notification until an ISR or stopMonitoring()
      */
     static void processingTaskFunc(void *param);
 
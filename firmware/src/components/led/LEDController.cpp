@@ -18,25 +18,69 @@ bool LEDController::init()
     if (!serialStudioEnabled)
         Serial.println("Initializing LED strip...");
 
-    // Initialize FastLED
-    FastLED.addLeds<LED_TYPE, LED_PIN, COLOR_ORDER>(leds, NUM_LEDS);
-    FastLED.setBrightness(DEFAULT_BRIGHTNESS);
-
-    // Soft power limit: keep LED strip draw under ~1A at 5V so the BQ24195
-    // (IINLIM=2A on VSYS) has headroom for ESP32 + display (~300mA at 5V).
-    FastLED.setMaxPowerInVoltsAndMilliamps(5, 1000);
+    if (!strip.begin(LED_PIN, NUM_LEDS))
+        return false;
 
     // Clear all LEDs
-    FastLED.clear();
-    FastLED.show();
+    fill_solid(leds, NUM_LEDS, COLOR_OFF);
+    strip.show(leds, 0);
 
     initialized = true;
     if (!serialStudioEnabled)
-        Serial.printf("LED strip initialized: %d LEDs on GPIO %d\n", NUM_LEDS, LED_PIN);
+        Serial.printf("LED strip initialized: %d LEDs on GPIO %d (RMT)\n", NUM_LEDS, LED_PIN);
 
     return true;
 }
 
+void LEDController::render(const CRGB &color, uint8_t frameBrightness)
+{
+    fill_solid(leds, NUM_LEDS, color);
+
+    uint8_t scaled = scale8_video(frameBrightness, brightness);
+    strip.show(leds, calculate_max_brightness_for_power_mW(leds, NUM_LEDS, scaled, LED_MAX_POWER_MW));
+}
+
+void LEDController::present(uint8_t frameBrightness)
+{
+    strip.show(leds, calculate_max_brightness_for_power_mW(leds, NUM_LEDS, frameBrightness, LED_MAX_POWER_MW));
+    strip.waitDone();
+}
+
+void LEDController::play(const LedKeyframe *keyframes, uint8_t count, bool loop)
+{
+    if (!initialized || count < 2)
+        return;
+
+    // Sample the keyframes every LED_FRAME_MS, once, here
+    uint32_t lastMs = keyframes[count - 1].timeMs;
+    uint32_t total = lastMs / LED_FRAME_MS + 1;
+    frameCount = total > LED_MAX_FRAMES ? LED_MAX_FRAMES : (uint16_t)total;
+
+    uint8_t segment = 0;
+    for (uint16_t f = 0; f < frameCount; f++)
+    {
+        uint32_t t = (uint32_t)f * LED_FRAME_MS;
+        while (segment < count - 2 && t >= keyframes[segment + 1].timeMs)
+            segment++;
+
+        const LedKeyframe &from = keyframes[segment];
+        const LedKeyframe &to = keyframes[segment + 1];
+        uint32_t span = to.timeMs - from.timeMs;
+        uint8_t amount = 255;
+        if (span > 0 && t < to.timeMs)
+            amount = (uint8_t)(((t - from.timeMs) * 255) / span);
+
+        frames[f].color = blend(from.color, to.color, amount);
+        frames[f].brightness = lerp8by8(from.brightness, to.brightness, amount);
+    }
+
+    animationStartTime = millis();
+    animationLoops = loop;
+    animationActive = !loop;
+    shownFrame = -1;
+    update();
+}
+
 void LEDController::showDirection(Direction direction, uint32_t duration)
 {
     if (!initialized)
@@ -64,45 +108,28 @@ void LEDController::showDirection(Direction direction, uint32_t duration)
     if (!serialStudioEnabled)
         Serial.printf("LED: Showing %s for %dms\n", dirName, duration);
 
-    // Reset brightness to full (may have been dimmed by previous fade)
-    FastLED.setBrightness(DEFAULT_BRIGHTNESS);
-
-    // Set all LEDs to the color
-    fill_solid(leds, NUM_LEDS, color);
-    FastLED.show();
-
-    // Start animation timer
-    animationStartTime = millis();
-    animationDuration = duration;
-    animationActive = true;
-    currentColor = color;
+    // Full color, then fade out over the last 500ms
+    uint16_t fadeStart = duration > 500 ? (uint16_t)(duration - 500) : 0;
+    const LedKeyframe keyframes[3] = {
+        {0, color, 255},
+        {fadeStart, color, 255},
+        {(uint16_t)duration, color, 0},
+    };
+    play(keyframes, 3, false);
 }
 
 void LEDController::showReady()
 {
-    if (!initialized)
+    if (!initialized || animationActive || (animationLoops && frameCount > 0))
         return;
 
     // Subtle pulsing green to indicate ready state
-    static uint8_t pulseValue = 0;
-    static bool increasing = true;
-
-    if (increasing)
-    {
-        pulseValue += 2;
-        if (pulseValue >= 50)
-            increasing = false;
-    }
-    else
-    {
-        pulseValue -= 2;
-        if (pulseValue <= 10)
-            increasing = true;
-    }
-
-    CRGB color = CRGB(0, pulseValue, 0);
-    fill_solid(leds, NUM_LEDS, color);
-    FastLED.show();
+    const LedKeyframe keyframes[3] = {
+        {0, CRGB(0, 10, 0), 255},
+        {220, COLOR_READY, 255},
+        {440, CRGB(0, 10, 0), 255},
+    };
+    play(keyframes, 3, true);
 }
 
 void LEDController::off()
@@ -110,9 +137,10 @@ void LEDController::off()
     if (!initialized)
         return;
 
-    FastLED.clear();
-    FastLED.show();
+    frameCount = 0;
     animationActive = false;
+    animationLoops = false;
+    render(COLOR_OFF, 0);
 }
 
 void LEDController::setColor(CRGB color)
@@ -120,43 +148,48 @@ void LEDController::setColor(CRGB color)
     if (!initialized)
         return;
 
-    fill_solid(leds, NUM_LEDS, color);
-    FastLED.show();
+    frameCount = 0;
+    animationActive = false;
+    animationLoops = false;
+    render(color, 255);
 }
 
-void LEDController::setBrightness(uint8_t brightness)
+void LEDController::setBrightness(uint8_t value)
 {
-    FastLED.setBrightness(brightness);
-    if (initialized)
-    {
-        FastLED.show();
-    }
+    brightness = value;
+    shownFrame = -1; // Re-show the current frame at the new brightness
 }
 
 bool LEDController::update()
 {
-    if (!initialized || !animationActive)
+    if (!initialized)
         return false;
 
-    unsigned long elapsed = millis() - animationStartTime;
+    // Start a frame that was waiting for the previous one to go out
+    strip.poll();
 
-    if (elapsed >= animationDuration)
-    {
-        // Animation complete - turn off
-        off();
+    if (frameCount == 0)
         return false;
+
+    uint32_t index = (millis() - animationStartTime) / LED_FRAME_MS;
+    if (index >= frameCount)
+    {
+        if (!animationLoops)
+        {
+            // Animation complete - turn off
+            off();
+            return false;
+        }
+        index %= frameCount;
     }
 
-    // Optional: Add fade-out effect in last 500ms
-    if (elapsed > animationDuration - 500)
+    if ((int32_t)index != shownFrame)
     {
-        float fadeProgress = (animationDuration - elapsed) / 500.0f;
-        uint8_t brightness = (uint8_t)(DEFAULT_BRIGHTNESS * fadeProgress);
-        FastLED.setBrightness(brightness);
-        FastLED.show();
+        shownFrame = index;
+        render(frames[index].color, frames[index].brightness);
     }
 
-    return true;
+    return animationActive;
 }
 
 bool LEDController::isAnimating() const
@@ -179,13 +212,15 @@ void LEDController::runStripTest(uint16_t count)
 
     Serial.printf("[LEDTest] Starting strip test on %u LEDs\n", count);
 
-    // Cancel any in-progress direction animation and start from full brightness.
+    // Cancel any in-progress animation; frames below go out at full brightness.
+    frameCount = 0;
     animationActive = false;
-    FastLED.setBrightness(255);
-    FastLED.clear(true);
+    animationLoops = false;
+    fill_solid(leds, NUM_LEDS, COLOR_OFF);
+    present(255);
 
     // Brightness levels — conservative to stay within BQ24195 IINLIM budget.
-    // FastLED soft power limit (1A) provides a backstop, but keep test values
+    // The soft power limit (LED_MAX_POWER_MW) provides a backstop, but keep test values
     // modest so the readout on screen shows realistic current draw.
     const uint8_t LEVEL_20 = 51;  // ~20% of 255 (used for white / combined RGB)
     const uint8_t LEVEL_30 = 77;  // ~30% of 255 (used for single-channel phases)
@@ -209,11 +244,11 @@ void LEDController::runStripTest(uint16_t count)
     for (int c = 0; c < 4; ++c)
     {
         fillRange(phase1Colors[c]);
-        FastLED.show();
+        present(255);
         delay(500);
     }
     fillRange(CRGB::Black);
-    FastLED.show();
+    present(255);
     delay(100);
 
     // ---- Phase 2: per-channel ramp 0 -> 30% over ~1s each ----
@@ -231,11 +266,11 @@ void LEDController::runStripTest(uint16_t count)
                        (uint8_t)(channels[ch][1] * v),
                        (uint8_t)(channels[ch][2] * v));
             fillRange(color);
-            FastLED.show();
+            present(255);
             delay(30);
         }
         fillRange(CRGB::Black);
-        FastLED.show();
+        present(255);
         delay(80);
     }
 
@@ -244,12 +279,12 @@ void LEDController::runStripTest(uint16_t count)
     for (int v = 0; v <= LEVEL_20; v += 2)
     {
         fillRange(CRGB((uint8_t)v, (uint8_t)v, (uint8_t)v));
-        FastLED.show();
+        present(255);
         delay(30);
     }
     delay(600); // hold at peak — watch INA219 readout on display
     fillRange(CRGB::Black);
-    FastLED.show();
+    present(255);
     delay(150);
 
     // ---- Phase 4: sequential per-pixel sweep ----
@@ -258,13 +293,13 @@ void LEDController::runStripTest(uint16_t count)
     {
         fillRange(CRGB::Black);
         leds[i] = CRGB(LEVEL_20, LEVEL_20, LEVEL_20);
-        FastLED.show();
+        present(255);
         delay(20);
     }
 
     // ---- Phase 5: cleanup ----
     Serial.println("[LEDTest] Phase 5: cleanup");
-    FastLED.clear(true);
-    FastLED.setBrightness(DEFAULT_BRIGHTNESS);
+    fill_solid(leds, NUM_LEDS, COLOR_OFF);
+    present(255);
     Serial.println("[LEDTest] Strip test complete");
 }
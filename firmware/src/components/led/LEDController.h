@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include "../detection/DirectionDetector.h"
+#include "RmtLedStrip.h"
 
 /**
  * LED Controller for Motion Play
@@ -13,6 +14,11 @@
  * - Orange: B→A direction  
  * - Green: Detection active/ready
  * - Off: Idle
+ *
+ * Animations are keyframes (time, color, brightness). play() turns them
+ * into a table of LED_FRAME_MS frames up front; update() only looks up
+ * the frame for the current time and hands it to the RMT strip when it
+ * changed - no per-frame math, no waiting on the strip.
  */
 
 // LED Configuration
@@ -24,16 +30,46 @@
 #define COLOR_ORDER GRB
 #define DEFAULT_BRIGHTNESS 128
 
+// Animation frame period and the longest animation (frames) play() holds
+#ifndef LED_FRAME_MS
+#define LED_FRAME_MS 20
+#endif
+#ifndef LED_MAX_FRAMES
+#define LED_MAX_FRAMES 256
+#endif
+
+// Soft power limit for the strip: keep draw under ~1A at 5V so the BQ24195
+// (IINLIM=2A on VSYS) has headroom for ESP32 + display (~300mA at 5V)
+#ifndef LED_MAX_POWER_MW
+#define LED_MAX_POWER_MW 5000
+#endif
+
+struct LedKeyframe
+{
+    uint16_t timeMs;    // From animation start
+    CRGB color;         // All LEDs
+    uint8_t brightness; // 255 = the controller's brightness
+};
+
 class LEDController {
 private:
     CRGB leds[NUM_LEDS];
+    RmtLedStrip strip;
     bool initialized = false;
-    
-    // Animation state
+    uint8_t brightness = DEFAULT_BRIGHTNESS;
+
+    // Animation state: precomputed frames
+    struct Frame
+    {
+        CRGB color;
+        uint8_t brightness;
+    };
+    Frame frames[LED_MAX_FRAMES];
+    uint16_t frameCount = 0;
+    int32_t shownFrame = -1;
     unsigned long animationStartTime = 0;
-    unsigned long animationDuration = 0;
-    bool animationActive = false;
-    CRGB currentColor;
+    bool animationLoops = false;
+    bool animationActive = false; // One-shot (direction) animation running
     
     // Colors for directions
     static const CRGB COLOR_A_TO_B;  // Blue
@@ -57,9 +93,17 @@ public:
     void showDirection(Direction direction, uint32_t duration = 3000);
     
     /**
-     * Show ready/waiting state (subtle green pulse)
+     * Show ready/waiting state (subtle green pulse, looping until
+     * something else is shown)
      */
     void showReady();
+
+    /**
+     * Play a keyframe animation on all LEDs (linear between keyframes,
+     * at least 2 keyframes, ascending times). A one-shot animation turns
+     * the strip off at its end; a looping one repeats until replaced.
+     */
+    void play(const LedKeyframe *keyframes, uint8_t count, bool loop);
     
     /**
      * Turn off all LEDs
@@ -77,8 +121,9 @@ public:
     void setBrightness(uint8_t brightness);
     
     /**
-     * Update animation state (call in loop)
-     * Returns true if animation is still active
+     * Advance the animation (call every few ms; shows a frame only when it
+     * changes, never waits on the strip)
+     * Returns true while a one-shot animation is active
      */
     bool update();
     
@@ -88,13 +133,18 @@ public:
     bool isAnimating() const;
 
     /**
-     * Run a blocking diagnostic test on the LED strip.
+     * Run a blocking diagnostic test on the LED strip (frames are sent
+     * synchronously here).
      * Lights `count` LEDs through five phases (solid colors, per-channel ramps,
      * combined RGB peak at ~40%, sequential per-pixel sweep, cleanup) so a new
      * strip can be validated for both addressing and current draw.
      * @param count Number of LEDs to test, clamped to [1, NUM_LEDS].
      */
     void runStripTest(uint16_t count);
+
+private:
+    void render(const CRGB &color, uint8_t frameBrightness);
+    void present(uint8_t frameBrightness); // leds[] as they are, blocking
 };
 
 #endif
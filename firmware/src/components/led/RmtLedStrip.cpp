@@ -0,0 +1,116 @@
+#include "RmtLedStrip.h"
+#include <esp_heap_caps.h>
+
+// RMT clock: 80 MHz APB / 2 = 25 ns per tick
+static const uint8_t RMT_CLOCK_DIV = 2;
+
+// WS2812B bit timings in ticks (T0H 0.4 us, T0L 0.85 us, T1H 0.8 us, T1L 0.45 us)
+static const uint16_t T0H_TICKS = 16;
+static const uint16_t T0L_TICKS = 34;
+static const uint16_t T1H_TICKS = 32;
+static const uint16_t T1L_TICKS = 18;
+
+bool RmtLedStrip::begin(uint8_t pin, uint16_t count)
+{
+    if (ready)
+        return true;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, channel);
+    config.clk_div = RMT_CLOCK_DIV;
+    config.mem_block_num = LED_RMT_MEM_BLOCKS;
+
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(channel, 0, 0) != ESP_OK)
+    {
+        Serial.println("ERROR: LED RMT channel setup failed");
+        return false;
+    }
+
+    size_t bytes = (size_t)count * 24 * sizeof(rmt_item32_t);
+    for (int i = 0; i < 2; i++)
+    {
+        buffers[i] = (rmt_item32_t *)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (buffers[i] == nullptr)
+        {
+            Serial.println("ERROR: LED frame buffer allocation failed");
+            heap_caps_free(buffers[0]);
+            buffers[0] = nullptr;
+            rmt_driver_uninstall(channel);
+            return false;
+        }
+    }
+
+    bit0.level0 = 1;
+    bit0.duration0 = T0H_TICKS;
+    bit0.level1 = 0;
+    bit0.duration1 = T0L_TICKS;
+    bit1.level0 = 1;
+    bit1.duration0 = T1H_TICKS;
+    bit1.level1 = 0;
+    bit1.duration1 = T1L_TICKS;
+
+    ledCount = count;
+    ready = true;
+    return true;
+}
+
+bool RmtLedStrip::isBusy() const
+{
+    return sending && rmt_wait_tx_done(channel, 0) != ESP_OK;
+}
+
+void RmtLedStrip::waitDone()
+{
+    while (poll() || sending)
+    {
+        rmt_wait_tx_done(channel, portMAX_DELAY);
+        sending = false;
+    }
+}
+
+void RmtLedStrip::show(const CRGB *pixels, uint8_t brightness)
+{
+    if (!ready)
+        return;
+
+    // The driver only ever reads the front buffer; a frame not yet started
+    // is simply replaced
+    encode(buffers[backBuffer], pixels, brightness);
+    pending = true;
+    poll();
+}
+
+bool RmtLedStrip::poll()
+{
+    if (!pending)
+        return false;
+    if (isBusy())
+        return true;
+
+    pending = false;
+    if (rmt_write_items(channel, buffers[backBuffer], ledCount * 24, false) != ESP_OK)
+        return false; // Frame dropped
+
+    sending = true;
+    backBuffer ^= 1;
+    return false;
+}
+
+void RmtLedStrip::encode(rmt_item32_t *out, const CRGB *pixels, uint8_t brightness)
+{
+    uint16_t scale = (uint16_t)brightness + 1;
+    for (uint16_t i = 0; i < ledCount; i++)
+    {
+        // Wire order GRB, MSB first
+        uint8_t bytes[3] = {
+            (uint8_t)((pixels[i].g * scale) >> 8),
+            (uint8_t)((pixels[i].r * scale) >> 8),
+            (uint8_t)((pixels[i].b * scale) >> 8)};
+
+        for (int b = 0; b < 3; b++)
+        {
+            uint8_t value = bytes[b];
+            for (int bit = 7; bit >= 0; bit--)
+                *out++ = (value & (1 << bit)) ? bit1 : bit0;
+        }
+    }
+}
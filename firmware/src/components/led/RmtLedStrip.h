@@ -0,0 +1,78 @@
+#ifndef RMT_LED_STRIP_H
+#define RMT_LED_STRIP_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <driver/rmt.h>
+
+/**
+ * WS2812B output through the RMT peripheral, without blocking
+ *
+ * FastLED.show() sends a frame and waits for it (~2.7 ms for 90 LEDs).
+ * Here a frame is encoded into RMT items up front and handed to the RMT
+ * driver, which streams it out from its own interrupt: show() returns
+ * immediately.
+ *
+ * - Two item buffers: the next frame is encoded into one while the other
+ *   is on the wire (the driver reads the buffer until it is done)
+ * - show() never waits: if a frame is still on the wire, the new one is
+ *   started by the next poll() (a newer show() replaces it)
+ * - LED_RMT_MEM_BLOCKS of RMT memory per channel: fewer refill interrupts
+ *   per frame, so the interrupt/timestamp path is barely touched
+ * - Buffers are in internal RAM (24 items x 4 bytes per LED, twice): the
+ *   refill interrupt must not depend on PSRAM cache
+ *
+ * The IDF 4.4 RMT driver in this Arduino core has no DMA mode for RMT;
+ * the refill interrupt copies pre-encoded items only.
+ */
+
+#ifndef LED_RMT_CHANNEL
+#define LED_RMT_CHANNEL RMT_CHANNEL_0
+#endif
+
+#ifndef LED_RMT_MEM_BLOCKS
+#define LED_RMT_MEM_BLOCKS 2
+#endif
+
+class RmtLedStrip
+{
+public:
+    /**
+     * Configure the RMT channel and allocate both frame buffers
+     * @return false if the driver or buffers could not be set up
+     */
+    bool begin(uint8_t pin, uint16_t count);
+
+    /**
+     * Encode pixels (GRB, scaled by brightness) and send them as soon as
+     * the frame on the wire is out
+     */
+    void show(const CRGB *pixels, uint8_t brightness);
+
+    /**
+     * Start the encoded frame if the previous one is out
+     * @return true while a frame is still waiting to be sent
+     */
+    bool poll();
+
+    bool isBusy() const;
+
+    // Block until every frame shown is out (for blocking callers only)
+    void waitDone();
+
+private:
+    rmt_channel_t channel = LED_RMT_CHANNEL;
+    uint16_t ledCount = 0;
+    rmt_item32_t *buffers[2] = {nullptr, nullptr};
+    uint8_t backBuffer = 0;
+    bool ready = false;
+    bool sending = false;
+    bool pending = false; // Back buffer holds a frame not yet started
+
+    rmt_item32_t bit0;
+    rmt_item32_t bit1;
+
+    void encode(rmt_item32_t *out, const CRGB *pixels, uint8_t brightness);
+};
+
+#endif
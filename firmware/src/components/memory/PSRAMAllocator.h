@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <cstddef>
 #include <esp_heap_caps.h>
+#include "../diagnostics/HeapTracker.h"
 
 /**
  * Custom allocator for std::vector that uses PSRAM instead of regular heap
@@ -11,8 +12,18 @@
  *
  * ESP32-S3 has ~400KB internal RAM but 8MB PSRAM
  * Using PSRAM prevents heap exhaustion during data collection
+ *
+ * Session buffers reserve their maximum once at boot and are only ever
+ * clear()ed, so this allocator is not on any per-sample path. Failures are
+ * always logged; successful allocate/free only with -DPSRAM_ALLOCATOR_LOG=1.
+ *
+ * Bytes are counted by HeapTracker under TAG (frame buffers by default).
  */
-template <typename T>
+
+#ifndef PSRAM_ALLOCATOR_LOG
+#define PSRAM_ALLOCATOR_LOG 0
+#endif
+template <typename T, HeapTag TAG = HeapTag::SESSION>
 class PSRAMAllocator
 {
 public:
@@ -27,13 +38,13 @@ public:
     template <typename U>
     struct rebind
     {
-        using other = PSRAMAllocator<U>;
+        using other = PSRAMAllocator<U, TAG>;
     };
 
     PSRAMAllocator() noexcept {}
 
     template <typename U>
-    PSRAMAllocator(const PSRAMAllocator<U> &) noexcept {}
+    PSRAMAllocator(const PSRAMAllocator<U, TAG> &) noexcept {}
 
     ~PSRAMAllocator() noexcept {}
 
@@ -44,7 +55,7 @@ public:
 
         // Allocate from PSRAM using ESP-IDF heap caps
         pointer p = static_cast<pointer>(
-            heap_caps_malloc(n * sizeof(T), MALLOC_CAP_SPIRAM));
+            HeapTracker::alloc(TAG, n * sizeof(T), MALLOC_CAP_SPIRAM));
 
         if (!p)
         {
@@ -53,8 +64,10 @@ public:
             throw std::bad_alloc();
         }
 
+#if PSRAM_ALLOCATOR_LOG
         Serial.printf("PSRAM allocated: %u bytes (%u items)\n",
                       n * sizeof(T), n);
+#endif
 
         return p;
     }
@@ -63,9 +76,11 @@ public:
     {
         if (p)
         {
-            heap_caps_free(p);
+            HeapTracker::release(TAG, p, n * sizeof(T));
+#if PSRAM_ALLOCATOR_LOG
             Serial.printf("PSRAM freed: %u bytes (%u items)\n",
                           n * sizeof(T), n);
+#endif
         }
     }
 
@@ -83,14 +98,14 @@ public:
 };
 
 // Comparison operators
-template <typename T1, typename T2>
-bool operator==(const PSRAMAllocator<T1> &, const PSRAMAllocator<T2> &) noexcept
+template <typename T1, typename T2, HeapTag TAG>
+bool operator==(const PSRAMAllocator<T1, TAG> &, const PSRAMAllocator<T2, TAG> &) noexcept
 {
     return true;
 }
 
-template <typename T1, typename T2>
-bool operator!=(const PSRAMAllocator<T1> &, const PSRAMAllocator<T2> &) noexcept
+template <typename T1, typename T2, HeapTag TAG>
+bool operator!=(const PSRAMAllocator<T1, TAG> &, const PSRAMAllocator<T2, TAG> &) noexcept
 {
     return false;
 }
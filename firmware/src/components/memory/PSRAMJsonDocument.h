@@ -0,0 +1,54 @@
+#ifndef PSRAM_JSON_DOCUMENT_H
+#define PSRAM_JSON_DOCUMENT_H
+
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include "../diagnostics/HeapTracker.h"
+
+/**
+ * ArduinoJson document whose memory pool lives in PSRAM
+ *
+ * For long-lived documents that are built over and over (one per MQTT
+ * batch): construct once with the largest capacity needed, then clear()
+ * before each use. clear() keeps the pool, so building a message does no
+ * heap allocation at all - unlike a DynamicJsonDocument per message, which
+ * fragments the internal heap over a long upload.
+ *
+ * The pool is counted by HeapTracker as HeapTag::JSON. A document has one
+ * pool, so the allocator (one per document) remembers its size.
+ */
+
+struct PSRAMJsonAllocator
+{
+    size_t allocated = 0;
+
+    void *allocate(size_t size)
+    {
+        void *pointer = HeapTracker::alloc(HeapTag::JSON, size, MALLOC_CAP_SPIRAM);
+        if (pointer)
+            allocated = size;
+        return pointer;
+    }
+
+    void deallocate(void *pointer)
+    {
+        HeapTracker::release(HeapTag::JSON, pointer, allocated);
+        allocated = 0;
+    }
+
+    void *reallocate(void *pointer, size_t newSize)
+    {
+        void *moved = heap_caps_realloc(pointer, newSize, MALLOC_CAP_SPIRAM);
+        if (moved)
+        {
+            HeapTracker::recordFree(HeapTag::JSON, allocated);
+            HeapTracker::recordAlloc(HeapTag::JSON, newSize);
+            allocated = newSize;
+        }
+        return moved;
+    }
+};
+
+typedef BasicJsonDocument<PSRAMJsonAllocator> PSRAMJsonDocument;
+
+#endif // PSRAM_JSON_DOCUMENT_H
@@ -0,0 +1,123 @@
+#ifndef POWER_OF_TWO_RING_H
+#define POWER_OF_TWO_RING_H
+
+#include <Arduino.h>
+#include <cstddef>
+
+/**
+ * Single-task ring buffer with power-of-two storage and mask indexing
+ *
+ * For the detector inner loops, which touch every element of a window on
+ * each sample: a non-power-of-two `% SIZE` is a real division on Xtensa,
+ * a mask is one AND.
+ *
+ * - CAPACITY (storage) must be a power of two
+ * - WINDOW (<= CAPACITY) is how many of the newest items are kept, so a
+ *   logical size like 200 keeps its exact semantics in 256 slots
+ * - head is a free-running counter; item with sequence s lives at s & MASK
+ * - segments() returns the logical range as at most two contiguous spans
+ *   (first/second), so callers can walk plain arrays instead of indexing
+ *
+ * Not thread-safe — see SPSCRing for the cross-core hand-off.
+ */
+
+// Smallest power of two >= n (compile-time)
+constexpr size_t ringCapacityFor(size_t n)
+{
+    size_t c = 1;
+    while (c < n)
+        c <<= 1;
+    return c;
+}
+
+template <typename T, size_t CAPACITY, size_t WINDOW = CAPACITY>
+class PowerOfTwoRing
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "PowerOfTwoRing CAPACITY must be a power of two");
+    static_assert(WINDOW >= 1 && WINDOW <= CAPACITY, "PowerOfTwoRing WINDOW must be 1..CAPACITY");
+
+public:
+    // Contiguous view of part of the ring
+    struct Span
+    {
+        const T *data;
+        size_t length;
+    };
+
+    // A logical range split at the storage wrap point
+    struct Segments
+    {
+        Span first;
+        Span second; // length 0 if the range does not wrap
+        size_t size() const { return first.length + second.length; }
+    };
+
+    void push(const T &item)
+    {
+        slots[head & MASK] = item;
+        head++;
+        if (count < WINDOW)
+            count++;
+    }
+
+    // Logical index: 0 = oldest kept item
+    T &operator[](size_t idx) { return slots[(head - count + idx) & MASK]; }
+    const T &operator[](size_t idx) const { return slots[(head - count + idx) & MASK]; }
+
+    // Newest item (ring must not be empty)
+    T &back() { return slots[(head - 1) & MASK]; }
+    const T &back() const { return slots[(head - 1) & MASK]; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool isFull() const { return count == WINDOW; }
+    static constexpr size_t capacity() { return WINDOW; }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    /**
+     * Logical items [start, start + n) as two contiguous spans
+     * (clamped to the items actually present)
+     */
+    Segments segments(size_t start, size_t n) const
+    {
+        Segments seg = {{slots, 0}, {slots, 0}};
+        if (start >= count)
+            return seg;
+        if (n > count - start)
+            n = count - start;
+
+        size_t begin = (head - count + start) & MASK;
+        size_t firstLen = CAPACITY - begin;
+        if (firstLen > n)
+            firstLen = n;
+
+        seg.first = {slots + begin, firstLen};
+        seg.second = {slots, n - firstLen};
+        return seg;
+    }
+
+    // All items, oldest first
+    Segments segments() const { return segments(0, count); }
+
+    // The newest n items, oldest first
+    Segments newest(size_t n) const
+    {
+        if (n > count)
+            n = count;
+        return segments(count - n, n);
+    }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    T slots[CAPACITY];
+    uint32_t head = 0; // Sequence number of the next push
+    size_t count = 0;
+};
+
+#endif // POWER_OF_TWO_RING_H
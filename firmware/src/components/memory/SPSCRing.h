@@ -0,0 +1,148 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Lock-free single-producer / single-consumer ring buffer
+ *
+ * Replaces a FreeRTOS queue for the Core 0 → Core 1 sensor hand-off:
+ * no critical sections, no kernel calls per item, bulk drain on the
+ * consumer side. Exactly one task may call the producer methods (push)
+ * and exactly one task may call the consumer methods (pop/popBulk/discardAll).
+ *
+ * - CAPACITY must be a power of two (index wrap is a mask, not a modulo)
+ * - head (producer) and tail (consumer) indices live on separate cache lines
+ *   so the two cores don't thrash one line on every push/pop
+ * - Indices are free-running 32-bit counters; size = head - tail
+ * - Full ring rejects the new item and bumps an exact overflow counter
+ *
+ * Storage is inline, so place the ring in a long-lived object (e.g. a
+ * global manager) — it ends up in internal RAM .bss, which both cores can
+ * access without PSRAM cache misses.
+ */
+
+// ESP32-S3 data cache line size
+#define SPSC_CACHE_LINE 32
+
+template <typename T, size_t CAPACITY>
+class SPSCRing
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SPSCRing CAPACITY must be a power of two");
+    static_assert(CAPACITY >= 2, "SPSCRing CAPACITY must be at least 2");
+
+public:
+    SPSCRing() : head(0), tail(0), overflows(0) {}
+
+    // ========================================================================
+    // Producer side
+    // ========================================================================
+
+    /**
+     * Append one item (producer only)
+     * @return false if the ring was full (item dropped, overflow counted)
+     */
+    bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+
+        if (h - t >= CAPACITY)
+        {
+            overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ========================================================================
+    // Consumer side
+    // ========================================================================
+
+    /**
+     * Remove one item (consumer only)
+     * @return false if the ring was empty
+     */
+    bool pop(T &out)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+
+        if (h == t)
+            return false;
+
+        out = slots[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove up to maxItems in one go (consumer only)
+     * One acquire + one release for the whole batch.
+     * @return Number of items copied into out
+     */
+    size_t popBulk(T *out, size_t maxItems)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+
+        size_t n = h - t;
+        if (n > maxItems)
+            n = maxItems;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            out[i] = slots[(t + i) & MASK];
+        }
+
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Drop everything currently queued (consumer only)
+     * @return Number of items discarded
+     */
+    size_t discardAll()
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        tail.store(h, std::memory_order_release);
+        return h - t;
+    }
+
+    // ========================================================================
+    // Either side
+    // ========================================================================
+
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return CAPACITY; }
+
+    /**
+     * Items rejected because the ring was full (since last resetOverflowCount)
+     */
+    uint32_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+    void resetOverflowCount() { overflows.store(0, std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> head; // Written by producer only
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> tail; // Written by consumer only
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> overflows;
+    alignas(SPSC_CACHE_LINE) T slots[CAPACITY];
+};
+
+#endif // SPSC_RING_H
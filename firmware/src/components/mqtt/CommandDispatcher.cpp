@@ -0,0 +1,235 @@
+#include "CommandDispatcher.h"
+#include <esp_heap_caps.h>
+#include "../diagnostics/HeapTracker.h"
+
+uint32_t CommandDispatcher::hashName(const char *name)
+{
+    // FNV-1a, 32 bit
+    uint32_t hash = 2166136261u;
+    while (*name)
+    {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool CommandDispatcher::add(const char *name, CommandHandler handler)
+{
+    if (entryCount >= COMMAND_MAX_HANDLERS)
+    {
+        Serial.printf("ERROR: Command table full - '%s' not registered\n", name);
+        return false;
+    }
+
+    uint32_t hash = hashName(name);
+    for (size_t j = 0; j < entryCount; j++)
+    {
+        if (entries[j].hash == hash)
+        {
+            Serial.printf("ERROR: Command '%s' clashes with '%s'\n", name, entries[j].name);
+            return false;
+        }
+    }
+
+    // Insert sorted by hash
+    size_t i = entryCount;
+    while (i > 0 && entries[i - 1].hash > hash)
+    {
+        entries[i] = entries[i - 1];
+        i--;
+    }
+
+    entries[i] = {};
+    entries[i].hash = hash;
+    entries[i].name = name;
+    entries[i].handler = handler;
+    entryCount++;
+    return true;
+}
+
+CommandDispatcher::Entry *CommandDispatcher::find(const char *name)
+{
+    uint32_t hash = hashName(name);
+    size_t low = 0;
+    size_t high = entryCount;
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (entries[mid].hash < hash)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low < entryCount && entries[low].hash == hash && strcmp(entries[low].name, name) == 0)
+        return &entries[low];
+    return nullptr;
+}
+
+bool CommandDispatcher::begin()
+{
+    if (task != nullptr)
+        return true;
+
+    stateMutex = xSemaphoreCreateMutex();
+    submitMutex = xSemaphoreCreateMutex();
+
+    // Items are 2 KB each: queue storage goes to PSRAM
+    uint8_t *storage = (uint8_t *)HeapTracker::alloc(HeapTag::MQTT, COMMAND_QUEUE_DEPTH * sizeof(Item), MALLOC_CAP_SPIRAM);
+    if (storage != nullptr)
+        queue = xQueueCreateStatic(COMMAND_QUEUE_DEPTH, sizeof(Item), storage, &queueControl);
+    if (stateMutex == nullptr || submitMutex == nullptr || queue == nullptr)
+    {
+        Serial.println("ERROR: CommandDispatcher queue creation failed");
+        HeapTracker::release(HeapTag::MQTT, storage, COMMAND_QUEUE_DEPTH * sizeof(Item));
+        queue = nullptr;
+        return false;
+    }
+
+    // Same priority as loop(): the two take turns, loop() keeps servicing
+    // MQTT while a long command runs. Handlers do what loop() used to do
+    // for them, so they get a loop()-sized stack.
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "CommandTask",
+        8192,
+        this,
+        1,
+        &task,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: CommandDispatcher task creation failed - commands run inline");
+        queue = nullptr;
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool CommandDispatcher::submit(const uint8_t *payload, unsigned int length)
+{
+    if (length >= COMMAND_PAYLOAD_MAX)
+    {
+        Serial.printf("WARNING: Command payload too large (%u bytes) - ignored\n", length);
+        droppedCount++;
+        return false;
+    }
+
+    if (task == nullptr)
+    {
+        // No task: run inline, as before
+        current.receivedUs = micros();
+        current.length = length;
+        memcpy(current.payload, payload, length);
+        current.payload[length] = '\0';
+        execute(current);
+        return true;
+    }
+
+    xSemaphoreTake(submitMutex, portMAX_DELAY);
+    staging.receivedUs = micros();
+    staging.length = length;
+    memcpy(staging.payload, payload, length);
+    staging.payload[length] = '\0';
+    bool queued = xQueueSend(queue, &staging, 0) == pdTRUE;
+    xSemaphoreGive(submitMutex);
+
+    if (!queued)
+    {
+        droppedCount++;
+        Serial.println("WARNING: Command queue full - command dropped");
+    }
+    return queued;
+}
+
+bool CommandDispatcher::tryLockState()
+{
+    return stateMutex == nullptr || xSemaphoreTake(stateMutex, 0) == pdTRUE;
+}
+
+void CommandDispatcher::unlockState()
+{
+    if (stateMutex != nullptr)
+        xSemaphoreGive(stateMutex);
+}
+
+void CommandDispatcher::execute(Item &item)
+{
+    // Zero-copy parse: strings in doc point into item.payload
+    DeserializationError error = deserializeJson(doc, item.payload, item.length);
+    if (error)
+    {
+        Serial.printf("WARNING: Command not parsed: %s\n", error.c_str());
+        return;
+    }
+
+    const char *name = doc["command"] | "";
+    Serial.print("Received command: ");
+    Serial.println(name);
+
+    Entry *entry = find(name);
+    if (entry == nullptr)
+    {
+        unknownCount++;
+        Serial.printf("Unknown command: %s\n", name);
+        return;
+    }
+
+    if (stateMutex != nullptr)
+        xSemaphoreTake(stateMutex, portMAX_DELAY);
+
+    uint32_t startUs = micros();
+    entry->handler(&doc);
+    uint32_t runUs = micros() - startUs;
+
+    if (stateMutex != nullptr)
+        xSemaphoreGive(stateMutex);
+
+    uint32_t ackUs = startUs - item.receivedUs;
+    entry->count++;
+    entry->lastAckUs = ackUs;
+    entry->lastRunUs = runUs;
+    if (ackUs > entry->maxAckUs)
+        entry->maxAckUs = ackUs;
+    if (runUs > entry->maxRunUs)
+        entry->maxRunUs = runUs;
+
+    Serial.printf("Command %s: ack %lu us, ran %lu ms\n", entry->name,
+                  (unsigned long)ackUs, (unsigned long)(runUs / 1000));
+}
+
+void CommandDispatcher::toJson(JsonDocument &out) const
+{
+    out["dropped"] = (uint32_t)droppedCount;
+    out["unknown"] = unknownCount;
+    JsonObject commands = out.createNestedObject("commands");
+    for (size_t i = 0; i < entryCount; i++)
+    {
+        const Entry &entry = entries[i];
+        if (entry.count == 0)
+            continue;
+        JsonObject stats = commands.createNestedObject(entry.name);
+        stats["count"] = entry.count;
+        stats["ack_us"] = entry.lastAckUs;
+        stats["ack_max_us"] = entry.maxAckUs;
+        stats["run_us"] = entry.lastRunUs;
+        stats["run_max_us"] = entry.maxRunUs;
+    }
+}
+
+void CommandDispatcher::taskFunction(void *parameter)
+{
+    static_cast<CommandDispatcher *>(parameter)->run();
+}
+
+void CommandDispatcher::run()
+{
+    for (;;)
+    {
+        if (xQueueReceive(queue, &current, portMAX_DELAY) == pdTRUE)
+            execute(current);
+    }
+}
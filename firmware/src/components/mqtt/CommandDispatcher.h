@@ -0,0 +1,129 @@
+#ifndef COMMAND_DISPATCHER_H
+#define COMMAND_DISPATCHER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+/**
+ * CommandDispatcher - MQTT commands looked up by hash, run on their own task
+ *
+ * Commands used to run inside the MQTT callback, i.e. inside
+ * mqttClient.loop() on loop(): a sensor reconfiguration or a session
+ * upload stalled both the MQTT client and everything else in loop(), and
+ * every command walked a chain of String compares. The callback now only
+ * copies the payload into a queue (submit()); the command task parses it
+ * and calls the handler registered for its name.
+ *
+ * - Handlers are found by FNV-1a hash of the name (binary search on a
+ *   sorted table, the name is compared once to confirm)
+ * - Handlers run with the state lock held; loop() takes it with
+ *   tryLockState() around everything that touches device state, so a
+ *   handler and loop() never interleave. MQTT is serviced outside it and
+ *   keeps going during a long command
+ * - Per command: count, ack latency (received -> handler start) and run
+ *   time, last and max; see toJson()
+ * - submit() never blocks: a full queue drops the command and counts it.
+ *   Any task may submit (the config refresh does)
+ * - Queue storage (COMMAND_PAYLOAD_MAX per slot) is in PSRAM
+ *
+ * Register every handler with add() before begin().
+ */
+
+#ifndef COMMAND_QUEUE_DEPTH
+#define COMMAND_QUEUE_DEPTH 4
+#endif
+
+// Largest command payload text (a full configure_sensors is ~1.4 KB)
+#ifndef COMMAND_PAYLOAD_MAX
+#define COMMAND_PAYLOAD_MAX 2048
+#endif
+
+// Parsed command (the callback used a 1 KB document before)
+#ifndef COMMAND_DOC_CAPACITY
+#define COMMAND_DOC_CAPACITY 1024
+#endif
+
+#ifndef COMMAND_MAX_HANDLERS
+#define COMMAND_MAX_HANDLERS 24
+#endif
+
+typedef void (*CommandHandler)(JsonDocument *doc);
+
+class CommandDispatcher
+{
+public:
+    /**
+     * Register a handler for a command name (a string literal: the name is
+     * not copied)
+     * @return false if the table is full or the name (or its hash) is taken
+     */
+    bool add(const char *name, CommandHandler handler);
+
+    /**
+     * Create the state lock, the queue and the command task (core 1,
+     * priority 1, next to loop())
+     * @return false on failure; submit() then runs commands inline
+     */
+    bool begin();
+
+    // From the MQTT callback (or any task): copy the payload and queue it
+    bool submit(const uint8_t *payload, unsigned int length);
+
+    // loop(): device state is ours until unlockState() (never waits)
+    bool tryLockState();
+    void unlockState();
+
+    // Per-command counters and latencies (command task or loop())
+    void toJson(JsonDocument &doc) const;
+
+    uint32_t getDroppedCount() const { return droppedCount; }
+    uint32_t getUnknownCount() const { return unknownCount; }
+
+private:
+    struct Entry
+    {
+        uint32_t hash;
+        const char *name;
+        CommandHandler handler;
+        uint32_t count;
+        uint32_t lastAckUs;
+        uint32_t maxAckUs;
+        uint32_t lastRunUs;
+        uint32_t maxRunUs;
+    };
+
+    struct Item
+    {
+        uint32_t receivedUs;
+        uint16_t length;
+        char payload[COMMAND_PAYLOAD_MAX];
+    };
+
+    Entry entries[COMMAND_MAX_HANDLERS];
+    size_t entryCount = 0;
+
+    QueueHandle_t queue = nullptr;
+    StaticQueue_t queueControl;
+    SemaphoreHandle_t stateMutex = nullptr;
+    SemaphoreHandle_t submitMutex = nullptr; // Guards the staging item
+    TaskHandle_t task = nullptr;
+    volatile uint32_t droppedCount = 0;
+    uint32_t unknownCount = 0;
+
+    // Too large for a stack: the command being run, and the one being queued
+    Item current;
+    Item staging;
+    StaticJsonDocument<COMMAND_DOC_CAPACITY> doc;
+
+    static uint32_t hashName(const char *name);
+    Entry *find(const char *name);
+    void execute(Item &item);
+
+    static void taskFunction(void *parameter);
+    void run();
+};
+
+#endif
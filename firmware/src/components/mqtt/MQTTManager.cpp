@@ -1,8 +1,56 @@
 #include "MQTTManager.h"
+#include "../diagnostics/CycleProfiler.h"
 
 MQTTManager::MQTTManager(NetworkManager *netManager) : networkManager(netManager)
 {
     mqttClient.setClient(networkManager->getClient());
+    clientMutex = xSemaphoreCreateRecursiveMutex();
+    outboxMutex = xSemaphoreCreateMutex();
+}
+
+MQTTManager::~MQTTManager()
+{
+    if (clientMutex != nullptr)
+    {
+        vSemaphoreDelete(clientMutex);
+        clientMutex = nullptr;
+    }
+    if (outboxMutex != nullptr)
+    {
+        vSemaphoreDelete(outboxMutex);
+        outboxMutex = nullptr;
+    }
+}
+
+bool MQTTManager::lockClient(TickType_t timeout)
+{
+    return xSemaphoreTakeRecursive(clientMutex, timeout) == pdTRUE;
+}
+
+void MQTTManager::unlockClient()
+{
+    xSemaphoreGiveRecursive(clientMutex);
+}
+
+bool MQTTManager::lockClientForData()
+{
+    for (;;)
+    {
+        if (lockClient(pdMS_TO_TICKS(10)))
+            return true;
+        if (connecting && outbox != nullptr)
+            return false;
+    }
+}
+
+void MQTTManager::lockOutbox()
+{
+    xSemaphoreTake(outboxMutex, portMAX_DELAY);
+}
+
+void MQTTManager::unlockOutbox()
+{
+    xSemaphoreGive(outboxMutex);
 }
 
 bool MQTTManager::loadConfig()
@@ -26,6 +74,7 @@ bool MQTTManager::loadConfig()
     // Set up topics
     statusTopic = "motionplay/" + deviceId + "/status";
     dataTopic = "motionplay/" + deviceId + "/data";
+    dataBinTopic = dataTopic + "/bin";
     commandTopic = "motionplay/" + deviceId + "/commands";
 
     // Load certificates
@@ -38,11 +87,30 @@ bool MQTTManager::loadConfig()
     mqttClient.setServer(broker.c_str(), port);
     mqttClient.setCallback(messageCallback);
 
+    uint16_t keepAlive = doc["mqtt"]["keepalive_s"] | MQTT_KEEPALIVE_S;
+    uint16_t socketTimeout = doc["mqtt"]["socket_timeout_s"] | MQTT_SOCKET_TIMEOUT_S;
+    unsigned long handshakeTimeout = doc["mqtt"]["handshake_timeout_s"] | MQTT_TLS_HANDSHAKE_TIMEOUT_S;
+    mqttClient.setKeepAlive(keepAlive);
+    mqttClient.setSocketTimeout(socketTimeout);
+    networkManager->getClient().setHandshakeTimeout(handshakeTimeout);
+
+    writeChunkBytes = doc["mqtt"]["write_chunk_bytes"] | MQTT_WRITE_CHUNK_BYTES;
+    if (writeChunkBytes < 256)
+        writeChunkBytes = 256;
+
     // Set buffer size for data payloads (default is 256 bytes)
     // 32KB covers the largest JSON batch (200 readings at ~80 bytes each).
-    // Binary-packed captures (~56KB) use the streaming publishData overload instead.
-    mqttClient.setBufferSize(32768);
-    Serial.println("MQTT buffer size set to 32KB");
+    // Binary-packed captures (~56KB) are streamed with beginDataStream() instead.
+    uint32_t bufferBytes = doc["mqtt"]["buffer_bytes"] | MQTT_BUFFER_BYTES;
+    if (bufferBytes > UINT16_MAX)
+        bufferBytes = UINT16_MAX; // PubSubClient limit
+    if (!mqttClient.setBufferSize(bufferBytes))
+    {
+        Serial.printf("WARNING: MQTT buffer of %lu bytes unavailable\n", (unsigned long)bufferBytes);
+    }
+    Serial.printf("MQTT buffer %lu KB, keepalive %u s, socket timeout %u s, handshake timeout %lu s, write chunk %u bytes\n",
+                  (unsigned long)(bufferBytes / 1024), keepAlive, socketTimeout, handshakeTimeout,
+                  (unsigned)writeChunkBytes);
 
     return true;
 }
@@ -95,43 +163,66 @@ bool MQTTManager::connect()
         return false;
     }
 
-    Serial.print("Connecting to MQTT broker: ");
-    Serial.println(broker);
+    for (int attempts = 0; attempts < 5; attempts++)
+    {
+        if (connectOnce())
+            return true;
 
-    int attempts = 0;
-    while (!mqttClient.connected() && attempts < 5)
+        Serial.println("Retrying in 5 seconds");
+        delay(5000);
+    }
+    return false;
+}
+
+bool MQTTManager::connectOnce()
+{
+    if (!networkManager->isConnected())
+        return false;
+
+    lockClient(portMAX_DELAY);
+    if (mqttClient.connected())
     {
-        if (mqttClient.connect(clientId.c_str()))
-        {
-            Serial.println("MQTT connected!");
+        unlockClient();
+        return true;
+    }
+    connecting = true;
 
-            // Subscribe to command topic
-            if (mqttClient.subscribe(commandTopic.c_str()))
-            {
-                Serial.print("Subscribed to: ");
-                Serial.println(commandTopic);
-            }
+    Serial.print("Connecting to MQTT broker: ");
+    Serial.println(broker);
 
-            // Publish initial status
-            publishStatus("online");
+    unsigned long start = millis();
+    bool success = mqttClient.connect(clientId.c_str());
+    if (success)
+    {
+        lastConnectMs = millis() - start;
+        Serial.printf("MQTT connected! (%lu ms)\n", (unsigned long)lastConnectMs);
 
-            return true;
+        // Subscribe to command topic
+        if (mqttClient.subscribe(commandTopic.c_str()))
+        {
+            Serial.print("Subscribed to: ");
+            Serial.println(commandTopic);
         }
 
+        // Publish initial status
+        publishStatus("online");
+    }
+    else
+    {
         Serial.print("MQTT connection failed, rc=");
-        Serial.print(mqttClient.state());
-        Serial.println(" retrying in 5 seconds");
-
-        attempts++;
-        delay(5000);
+        Serial.println(mqttClient.state());
     }
 
-    return false;
+    connecting = false;
+    unlockClient();
+    return success;
 }
 
 void MQTTManager::disconnect()
 {
+    lockClient(portMAX_DELAY);
     mqttClient.disconnect();
+    unlockClient();
 }
 
 bool MQTTManager::isConnected()
@@ -141,124 +232,345 @@ bool MQTTManager::isConnected()
 
 void MQTTManager::loop()
 {
-    if (!mqttClient.connected())
+    // Another task is mid-publish: skip this pass rather than stall the
+    // caller (its writes keep the connection alive meanwhile)
+    if (!lockClient(0))
+        return;
+
+    if (!mqttClient.connected() && !supervised)
     {
         connect();
     }
     mqttClient.loop();
+    if (outbox != nullptr && mqttClient.connected())
+        drainOutbox();
+    unlockClient();
+}
+
+void MQTTManager::drainOutbox()
+{
+    if (outbox->empty() || millis() - lastOutboxDrain < MQTT_OUTBOX_DRAIN_INTERVAL_MS)
+        return;
+    lastOutboxDrain = millis();
+
+    // A stream is still filling an outbox record: try again next pass
+    if (xSemaphoreTake(outboxMutex, 0) != pdTRUE)
+        return;
+
+    static uint8_t staging[1024];
+    for (int i = 0; i < MQTT_OUTBOX_DRAIN_BATCH; i++)
+    {
+        OutboxTopic topic;
+        size_t length;
+        if (!outbox->peek(topic, length))
+            break;
+
+        const String &topicName = (topic == OutboxTopic::DATA_BIN) ? dataBinTopic : dataTopic;
+        if (!mqttClient.beginPublish(topicName.c_str(), length, false))
+            break;
+
+        bool ok = true;
+        size_t sent = 0;
+        while (ok && sent < length)
+        {
+            size_t n = outbox->readFront(staging, sizeof(staging));
+            ok = n > 0 && writeChunked(staging, n);
+            sent += n;
+        }
+        if (!mqttClient.endPublish() || !ok)
+        {
+            // Stays queued; retried on the next pass
+            Serial.printf("WARNING: Outbox drain failed (%lu messages pending)\n",
+                          (unsigned long)outbox->pending());
+            break;
+        }
+
+        outbox->pop();
+        if (outbox->empty())
+            Serial.println("Outbox drained");
+    }
+    unlockOutbox();
 }
 
 bool MQTTManager::publishStatus(const char *status)
 {
-    DynamicJsonDocument doc(256);
-    doc["device_id"] = deviceId;
+    StaticJsonDocument<1> none;
+    return publishStatus(status, none);
+}
+
+bool MQTTManager::publishStatus(const char *status, const JsonDocument &details)
+{
+    if (!lockClient(pdMS_TO_TICKS(MQTT_STATUS_LOCK_TIMEOUT_MS)))
+    {
+        Serial.printf("WARNING: status '%s' dropped (MQTT client busy)\n", status);
+        return false;
+    }
+
+    bool success;
+    if (details.memoryUsage() + 256 <= statusDoc.capacity())
+    {
+        statusDoc.clear();
+        fillStatus(statusDoc, status, details);
+        success = sendStatus(statusDoc);
+    }
+    else
+    {
+        DynamicJsonDocument doc(256 + details.memoryUsage());
+        fillStatus(doc, status, details);
+        success = sendStatus(doc);
+    }
+    unlockClient();
+    return success;
+}
+
+void MQTTManager::fillStatus(JsonDocument &doc, const char *status, const JsonDocument &details)
+{
+    doc["device_id"] = deviceId.c_str();
     doc["status"] = status;
     doc["timestamp"] = millis();
     doc["wifi_rssi"] = WiFi.RSSI();
     doc["free_heap"] = ESP.getFreeHeap();
     doc["uptime_ms"] = millis();
+    if (outbox != nullptr)
+        doc["outbox_pending"] = outbox->pending();
+    doc["mqtt_connect_ms"] = lastConnectMs;
+    for (JsonPairConst field : details.as<JsonObjectConst>())
+        doc[field.key().c_str()] = field.value();
+}
+
+bool MQTTManager::sendStatus(const JsonDocument &doc)
+{
+    size_t length;
+    {
+        PROFILE_SCOPE(ProfileSpan::JSON_BUILD);
+        length = serializeJson(doc, statusPayload, sizeof(statusPayload));
+    }
 
+    PROFILE_SCOPE(ProfileSpan::MQTT_WRITE);
+    if (length < sizeof(statusPayload) - 1)
+        return mqttClient.publish(statusTopic.c_str(), (const uint8_t *)statusPayload, length);
+
+    // Larger than the static buffer (profile reports): rare, allocate
     String payload;
     serializeJson(doc, payload);
-
     return mqttClient.publish(statusTopic.c_str(), payload.c_str());
 }
 
-bool MQTTManager::publishData(const JsonDocument &data)
+bool MQTTManager::publishData(const uint8_t *payload, size_t length)
 {
-    String payload;
-    size_t payloadSize = serializeJson(data, payload);
+    bool locked = lockClientForData();
+    if (outbox != nullptr)
+        lockOutbox();
 
-    // Warn if payload approaches MQTT buffer limit
-    if (payloadSize > 24576)
+    bool success = false;
+    bool queue = outbox != nullptr && (!locked || !mqttClient.connected() || !outbox->empty());
+    if (!queue)
     {
-        Serial.printf("WARNING: Large MQTT payload: %d bytes (buffer: 32KB)\n", payloadSize);
+        // Straight from the caller's buffer, no copy into the client buffer
+        success = mqttClient.beginPublish(dataTopic.c_str(), length, false) &&
+                  writeChunked(payload, length) &&
+                  mqttClient.endPublish();
     }
 
-    bool success = mqttClient.publish(dataTopic.c_str(), payload.c_str());
-
-    if (!success)
+    if (!success && !queue)
     {
-        Serial.println("ERROR: mqttClient.publish() failed!");
+        Serial.println("ERROR: MQTT data publish failed!");
         Serial.printf("  MQTT state: %d, connected: %s, payload: %d bytes\n",
                       mqttClient.state(),
                       mqttClient.connected() ? "YES" : "NO",
-                      payloadSize);
+                      length);
+    }
+
+    if (!success && outbox != nullptr)
+    {
+        success = outbox->store(OutboxTopic::DATA, payload, length);
+        if (success)
+            Serial.printf("Data message queued in outbox (%d bytes, %lu pending)\n",
+                          length, (unsigned long)outbox->pending());
     }
 
+    if (outbox != nullptr)
+        unlockOutbox();
+    if (locked)
+        unlockClient();
+
     return success;
 }
 
-bool MQTTManager::publishDataStreaming(const JsonDocument &data)
+bool MQTTManager::beginDataStream(size_t payloadLength, bool rawBinaryTopic)
 {
-    size_t payloadSize = measureJson(data);
+    // Waits for any other task's stream to finish (the client lock, or
+    // the outbox lock for a stream queued during a reconnect)
+    bool locked = lockClientForData();
+    if (outbox != nullptr)
+        lockOutbox();
+
+    if (streamOpen)
+    {
+        Serial.println("ERROR: beginDataStream while another stream is open");
+        if (outbox != nullptr)
+            unlockOutbox();
+        if (locked)
+            unlockClient();
+        return false;
+    }
+
+    const String &topic = rawBinaryTopic ? dataBinTopic : dataTopic;
+    OutboxTopic outboxTopic = rawBinaryTopic ? OutboxTopic::DATA_BIN : OutboxTopic::DATA;
+
+    // Straight to the outbox while offline or behind older queued messages.
+    // Otherwise publish directly and keep a PSRAM copy (if it fits) so a
+    // connection lost mid-stream still delivers the message later.
+    bool queue = outbox != nullptr && (!locked || !mqttClient.connected() || !outbox->empty());
+    streamDirect = false;
+    if (!queue)
+    {
+        Serial.printf("MQTT streaming publish: %d bytes to %s\n", payloadLength, topic.c_str());
+        streamDirect = mqttClient.beginPublish(topic.c_str(), payloadLength, false);
+        if (!streamDirect)
+        {
+            Serial.printf("ERROR: beginPublish failed (payload: %d bytes, connected: %s)\n",
+                          payloadLength, mqttClient.connected() ? "YES" : "NO");
+        }
+    }
+    streamQueued = outbox != nullptr && outbox->beginMessage(outboxTopic, payloadLength, !streamDirect);
+
+    if (!streamDirect && !streamQueued)
+    {
+        if (outbox != nullptr)
+            unlockOutbox();
+        if (locked)
+            unlockClient();
+        return false;
+    }
+
+    streamLocked = locked;
+    streamOutboxLocked = outbox != nullptr;
+    streamLength = payloadLength;
+    streamSent = 0;
+    streamOpen = true;
+    return true;
+}
 
-    Serial.printf("MQTT streaming publish: %d bytes\n", payloadSize);
+bool MQTTManager::writeDataStream(const uint8_t *data, size_t length)
+{
+    if (!streamOpen)
+        return false;
 
-    // Serialize into a PSRAM buffer first, then send in small chunks.
-    // Writing the full ~56KB base64 string directly to the TLS socket in one
-    // call can hang on ESP32 — chunked writes let the TCP stack flow-control.
-    char *buf = (char *)ps_malloc(payloadSize + 1);
-    if (!buf)
+    if (streamSent + length > streamLength)
     {
-        Serial.printf("ERROR: ps_malloc(%d) failed for streaming publish\n", payloadSize + 1);
+        Serial.printf("ERROR: stream overrun (%d + %d > %d bytes)\n", streamSent, length, streamLength);
+        streamOpen = false;
         return false;
     }
 
-    size_t serialized = serializeJson(data, buf, payloadSize + 1);
-    if (serialized != payloadSize)
+    if (streamQueued && !outbox->append(data, length))
+        streamQueued = false;
+
+    if (streamDirect && !writeChunked(data, length))
     {
-        Serial.printf("WARNING: measureJson=%d but serializeJson=%d\n", payloadSize, serialized);
-        payloadSize = serialized;
+        Serial.printf("ERROR: streaming publish aborted due to write failure at offset %d\n", streamSent);
+        streamDirect = false;
+        if (streamQueued)
+            Serial.println("  Message continues into the outbox");
     }
 
-    if (!mqttClient.beginPublish(dataTopic.c_str(), payloadSize, false))
+    if (!streamDirect && !streamQueued)
     {
-        Serial.printf("ERROR: beginPublish failed (payload: %d bytes, connected: %s)\n",
-                      payloadSize, mqttClient.connected() ? "YES" : "NO");
-        free(buf);
+        streamOpen = false;
         return false;
     }
 
-    // Send in 4KB chunks
-    static const size_t CHUNK_SIZE = 4096;
-    size_t sent = 0;
-    bool writeOk = true;
+    streamSent += length;
+    return true;
+}
+
+bool MQTTManager::writeChunked(const uint8_t *data, size_t length)
+{
+    // Send in chunks (4KB by default). Writing a large block to the TLS socket
+    // in one call can hang on ESP32 - chunked writes let TCP flow-control.
+    size_t offset = 0;
 
-    while (sent < payloadSize)
+    while (offset < length)
     {
-        size_t chunkLen = payloadSize - sent;
-        if (chunkLen > CHUNK_SIZE)
-            chunkLen = CHUNK_SIZE;
+        size_t chunkLen = length - offset;
+        if (chunkLen > writeChunkBytes)
+            chunkLen = writeChunkBytes;
 
-        size_t written = mqttClient.write((const uint8_t *)(buf + sent), chunkLen);
+        size_t written;
+        {
+            PROFILE_SCOPE(ProfileSpan::MQTT_WRITE);
+            written = mqttClient.write(data + offset, chunkLen);
+        }
         if (written != chunkLen)
         {
             Serial.printf("ERROR: chunk write failed at offset %d (wanted %d, wrote %d)\n",
-                          sent, chunkLen, written);
-            writeOk = false;
-            break;
+                          offset, chunkLen, written);
+            return false;
         }
-        sent += written;
+        offset += written;
     }
+    return true;
+}
+
+bool MQTTManager::endDataStream()
+{
+    // A failed write closes the stream early; the lock is still ours to release
+    bool wasOpen = streamOpen;
+    streamOpen = false;
 
-    free(buf);
+    bool success = false;
+    if (!wasOpen)
+    {
+        // Nothing to finish
+    }
+    else if (streamSent != streamLength)
+    {
+        Serial.printf("ERROR: stream ended after %d of %d bytes\n", streamSent, streamLength);
+    }
+    else if (streamDirect)
+    {
+        success = mqttClient.endPublish();
+        if (!success)
+        {
+            Serial.printf("ERROR: endPublish failed after sending %d bytes\n", streamSent);
+        }
+        else
+        {
+            Serial.printf("MQTT streaming publish complete: %d bytes\n", streamSent);
+        }
+    }
 
-    if (!writeOk)
+    // Delivered: drop the copy. Not delivered: the copy is the message.
+    if (streamQueued)
     {
-        Serial.println("ERROR: streaming publish aborted due to write failure");
-        return false;
+        if (success)
+        {
+            outbox->abortMessage();
+        }
+        else if (wasOpen && streamSent == streamLength && outbox->commitMessage())
+        {
+            success = true;
+            Serial.printf("Data message queued in outbox (%d bytes, %lu pending)\n",
+                          streamSent, (unsigned long)outbox->pending());
+        }
+        else
+        {
+            outbox->abortMessage();
+        }
     }
+    streamDirect = false;
+    streamQueued = false;
 
-    bool success = mqttClient.endPublish();
-    if (!success)
+    if (streamOutboxLocked)
     {
-        Serial.printf("ERROR: endPublish failed after sending %d bytes\n", sent);
+        streamOutboxLocked = false;
+        unlockOutbox();
     }
-    else
+    if (streamLocked)
     {
-        Serial.printf("MQTT streaming publish complete: %d bytes in %d chunks\n",
-                      payloadSize, (payloadSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        streamLocked = false;
+        unlockClient();
     }
 
     return success;
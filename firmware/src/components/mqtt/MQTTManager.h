@@ -5,6 +5,58 @@
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 #include "../network/NetworkManager.h"
+#include "MessageOutbox.h"
+#include <freertos/semphr.h>
+
+// How long publishStatus() waits for the client while another task
+// (e.g. the capture upload task) is streaming a message
+#ifndef MQTT_STATUS_LOCK_TIMEOUT_MS
+#define MQTT_STATUS_LOCK_TIMEOUT_MS 100
+#endif
+
+// Connection tuning; each can be overridden in the "mqtt" section of
+// config.json (keepalive_s, socket_timeout_s, handshake_timeout_s,
+// buffer_bytes, write_chunk_bytes).
+// Keepalive: AWS IoT accepts 30-1200 s. Longer means fewer pings, but a
+// dead link is noticed later.
+#ifndef MQTT_KEEPALIVE_S
+#define MQTT_KEEPALIVE_S 60
+#endif
+// Longest a single socket read/write may block
+#ifndef MQTT_SOCKET_TIMEOUT_S
+#define MQTT_SOCKET_TIMEOUT_S 15
+#endif
+// Cap on one TLS handshake (WiFiClientSecure defaults to 120 s, holding
+// the client lock the whole time on a half-dead link)
+#ifndef MQTT_TLS_HANDSHAKE_TIMEOUT_S
+#define MQTT_TLS_HANDSHAKE_TIMEOUT_S 20
+#endif
+// PubSubClient buffer: the largest message publish() can send in one go
+#ifndef MQTT_BUFFER_BYTES
+#define MQTT_BUFFER_BYTES 32768
+#endif
+// Streamed payloads are written to the TLS socket in pieces this size
+#ifndef MQTT_WRITE_CHUNK_BYTES
+#define MQTT_WRITE_CHUNK_BYTES 4096
+#endif
+
+// Status messages are built in a preallocated document and buffer; only
+// details too large for them (profile reports) use a temporary document
+#ifndef MQTT_STATUS_DOC_BYTES
+#define MQTT_STATUS_DOC_BYTES 1536
+#endif
+#ifndef MQTT_STATUS_PAYLOAD_BYTES
+#define MQTT_STATUS_PAYLOAD_BYTES 1024
+#endif
+
+// Outbox drain: at most this many queued messages per loop() pass, passes
+// at least this far apart (live traffic and commands keep their share)
+#ifndef MQTT_OUTBOX_DRAIN_BATCH
+#define MQTT_OUTBOX_DRAIN_BATCH 4
+#endif
+#ifndef MQTT_OUTBOX_DRAIN_INTERVAL_MS
+#define MQTT_OUTBOX_DRAIN_INTERVAL_MS 100
+#endif
 
 class MQTTManager
 {
@@ -15,12 +67,61 @@ private:
     int port;
     String clientId;
     String deviceId;
+    size_t writeChunkBytes = MQTT_WRITE_CHUNK_BYTES;
+    uint32_t lastConnectMs = 0; // Duration of the last successful connect (TCP + TLS + MQTT)
 
     // Topics
     String statusTopic;
     String dataTopic;
+    String dataBinTopic; // Raw binary captures (no base64, no JSON framing)
     String commandTopic;
 
+    // Streaming publish state (one stream at a time)
+    size_t streamLength = 0;
+    size_t streamSent = 0;
+    bool streamOpen = false;
+    bool streamLocked = false; // Client lock held from beginDataStream to endDataStream
+    bool streamDirect = false; // Bytes are going to the broker
+    bool streamQueued = false; // Bytes are going into an outbox record
+
+    bool streamOutboxLocked = false; // Outbox lock held for the stream
+
+    // Undeliverable data messages wait here (nullptr = no store-and-forward)
+    MessageOutbox *outbox = nullptr;
+    unsigned long lastOutboxDrain = 0;
+    void drainOutbox();
+
+    // Reconnects: loop() retries itself unless a ConnectionSupervisor does.
+    // connecting is set while connectOnce() holds the client lock for a
+    // handshake; data publishes then go to the outbox instead of waiting.
+    bool supervised = false;
+    volatile bool connecting = false;
+
+    // Socket write in chunks the TLS stack can flow-control
+    bool writeChunked(const uint8_t *data, size_t length);
+
+    // PubSubClient is not thread-safe: every client call goes through this
+    // recursive mutex so the loop task and the upload task can share it.
+    // Recursive because command callbacks run inside loop() and publish.
+    SemaphoreHandle_t clientMutex;
+    bool lockClient(TickType_t timeout);
+    void unlockClient();
+    // Client lock for a data message; false = a connect attempt holds it
+    // and the message should only be queued (outbox set)
+    bool lockClientForData();
+
+    // The outbox has its own lock so messages can be queued while a
+    // handshake holds the client. Order: client lock, then outbox lock.
+    SemaphoreHandle_t outboxMutex;
+    void lockOutbox();
+    void unlockOutbox();
+
+    // Built and sent under the client lock
+    StaticJsonDocument<MQTT_STATUS_DOC_BYTES> statusDoc;
+    char statusPayload[MQTT_STATUS_PAYLOAD_BYTES];
+    void fillStatus(JsonDocument &doc, const char *status, const JsonDocument &details);
+    bool sendStatus(const JsonDocument &doc);
+
     // Certificates
     String caCert;
     String clientCert;
@@ -31,15 +132,35 @@ private:
 
 public:
     MQTTManager(NetworkManager *netManager);
+    ~MQTTManager();
     bool loadConfig();
+    // Blocking connect with retries (boot, unsupervised loop())
     bool connect();
+    // One connect attempt: subscribe and announce "online" on success
+    bool connectOnce();
+    void setSupervised(bool enabled) { supervised = enabled; }
     void disconnect();
     bool isConnected();
     void loop();
     const String &getDeviceId() const { return deviceId; }
+    uint32_t getLastConnectMs() const { return lastConnectMs; }
     bool publishStatus(const char *status);
-    bool publishData(const JsonDocument &data);
-    bool publishDataStreaming(const JsonDocument &data);
+    // Status with extra top-level fields (the keys of a JSON object)
+    bool publishStatus(const char *status, const JsonDocument &details);
+    // Data message already serialized by the caller (into its own reusable
+    // buffer). Queued in the outbox (if set) while the broker is unreachable
+    // or older messages are still waiting, and returns true once queued.
+    // Queued messages drain in order from loop().
+    bool publishData(const uint8_t *payload, size_t length);
+    void setOutbox(MessageOutbox *messageOutbox) { outbox = messageOutbox; }
+
+    // Streaming publish for payloads larger than the PubSubClient buffer.
+    // The total length must be known up front; the caller then writes the
+    // payload in pieces from its own (small) staging buffer.
+    // The client stays locked to the calling task until endDataStream().
+    bool beginDataStream(size_t payloadLength, bool rawBinaryTopic = false);
+    bool writeDataStream(const uint8_t *data, size_t length);
+    bool endDataStream();
     void setCallback(std::function<void(char *, byte *, unsigned int)> callback);
 };
 
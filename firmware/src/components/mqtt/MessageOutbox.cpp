@@ -0,0 +1,274 @@
+#include "MessageOutbox.h"
+
+static const char *OUTBOX_PENDING_PATH = OUTBOX_DIR "/pending.tmp";
+
+String MessageOutbox::flashPath(uint32_t sequence)
+{
+    char path[32];
+    snprintf(path, sizeof(path), OUTBOX_DIR "/%08lu", (unsigned long)sequence);
+    return String(path);
+}
+
+bool MessageOutbox::begin()
+{
+    if (!ring.empty())
+        return true;
+
+    try
+    {
+        ring.resize(OUTBOX_RAM_BYTES);
+    }
+    catch (const std::bad_alloc &)
+    {
+        Serial.println("ERROR: Outbox ring allocation failed");
+        return false;
+    }
+
+    // Messages queued in flash before the last reboot are still pending
+    if (!LittleFS.exists(OUTBOX_DIR))
+        LittleFS.mkdir(OUTBOX_DIR);
+    if (LittleFS.exists(OUTBOX_PENDING_PATH))
+        LittleFS.remove(OUTBOX_PENDING_PATH); // Interrupted write
+
+    File dir = LittleFS.open(OUTBOX_DIR);
+    bool found = false;
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+    {
+        char *end;
+        uint32_t sequence = strtoul(entry.name(), &end, 10);
+        if (*end != '\0')
+            continue;
+
+        flashBytes += entry.size();
+        if (!found || sequence < flashTail)
+            flashTail = sequence;
+        if (!found || sequence >= flashHead)
+            flashHead = sequence + 1;
+        found = true;
+    }
+    dir.close();
+
+    Serial.printf("Outbox ready: %d KB PSRAM, %lu messages (%u KB) pending in flash\n",
+                  OUTBOX_RAM_BYTES / 1024, (unsigned long)(flashHead - flashTail),
+                  (unsigned)(flashBytes / 1024));
+    return true;
+}
+
+void MessageOutbox::putBytes(size_t pos, const uint8_t *data, size_t length)
+{
+    size_t first = ring.size() - pos;
+    if (first > length)
+        first = length;
+    memcpy(ring.data() + pos, data, first);
+    memcpy(ring.data(), data + first, length - first);
+}
+
+void MessageOutbox::getBytes(size_t pos, uint8_t *out, size_t length) const
+{
+    size_t first = ring.size() - pos;
+    if (first > length)
+        first = length;
+    memcpy(out, ring.data() + pos, first);
+    memcpy(out + first, ring.data(), length - first);
+}
+
+bool MessageOutbox::beginMessage(OutboxTopic topic, size_t length, bool allowFlash)
+{
+    if (ring.empty() || writing != Target::NONE)
+        return false;
+
+    writeTopic = topic;
+    writeLength = length;
+    written = 0;
+
+    // RAM while nothing is waiting in flash (keeps the order)
+    if (flashTail == flashHead && RECORD_HEADER + length <= ring.size() - ramUsed)
+    {
+        writing = Target::RAM;
+        return true;
+    }
+
+    if (!allowFlash)
+        return false;
+
+    size_t freeBytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+    if (flashBytes + length + 1 > OUTBOX_FLASH_MAX_BYTES ||
+        length + 1 + OUTBOX_FLASH_RESERVE_BYTES > freeBytes)
+    {
+        droppedCount++;
+        Serial.printf("WARNING: Outbox full, %u byte message dropped\n", (unsigned)length);
+        return false;
+    }
+
+    writeFile = LittleFS.open(OUTBOX_PENDING_PATH, "w");
+    if (!writeFile)
+    {
+        droppedCount++;
+        Serial.println("ERROR: Outbox file create failed");
+        return false;
+    }
+    uint8_t topicByte = (uint8_t)topic;
+    writeFile.write(&topicByte, 1);
+    writing = Target::FLASH;
+    return true;
+}
+
+bool MessageOutbox::append(const uint8_t *data, size_t length)
+{
+    if (writing == Target::NONE || written + length > writeLength)
+        return false;
+
+    if (writing == Target::RAM)
+    {
+        size_t recordStart = wrap(ramTail + ramUsed);
+        putBytes(wrap(recordStart + RECORD_HEADER + written), data, length);
+    }
+    else if (writeFile.write(data, length) != length)
+    {
+        Serial.println("ERROR: Outbox file write failed");
+        abortMessage();
+        droppedCount++;
+        return false;
+    }
+
+    written += length;
+    return true;
+}
+
+bool MessageOutbox::commitMessage()
+{
+    if (writing == Target::NONE)
+        return false;
+    if (written != writeLength)
+    {
+        abortMessage();
+        droppedCount++;
+        return false;
+    }
+
+    if (writing == Target::RAM)
+    {
+        uint8_t header[RECORD_HEADER];
+        uint32_t length = writeLength;
+        memcpy(header, &length, 4);
+        header[4] = (uint8_t)writeTopic;
+        putBytes(wrap(ramTail + ramUsed), header, RECORD_HEADER);
+        ramUsed += RECORD_HEADER + writeLength;
+        ramMessages++;
+    }
+    else
+    {
+        writeFile.close();
+        if (!LittleFS.rename(OUTBOX_PENDING_PATH, flashPath(flashHead).c_str()))
+        {
+            Serial.println("ERROR: Outbox file commit failed");
+            LittleFS.remove(OUTBOX_PENDING_PATH);
+            writing = Target::NONE;
+            droppedCount++;
+            return false;
+        }
+        flashHead++;
+        flashBytes += writeLength + 1;
+    }
+
+    writing = Target::NONE;
+    return true;
+}
+
+void MessageOutbox::abortMessage()
+{
+    if (writing == Target::FLASH)
+    {
+        writeFile.close();
+        LittleFS.remove(OUTBOX_PENDING_PATH);
+    }
+    writing = Target::NONE;
+}
+
+bool MessageOutbox::store(OutboxTopic topic, const uint8_t *data, size_t length)
+{
+    return beginMessage(topic, length) && append(data, length) && commitMessage();
+}
+
+bool MessageOutbox::peek(OutboxTopic &topic, size_t &length)
+{
+    if (readFile)
+        readFile.close();
+    reading = Target::NONE;
+    frontRead = 0;
+
+    if (ramMessages > 0)
+    {
+        uint8_t header[RECORD_HEADER];
+        getBytes(ramTail, header, RECORD_HEADER);
+        uint32_t recordLength;
+        memcpy(&recordLength, header, 4);
+        topic = (OutboxTopic)header[4];
+        length = frontLength = recordLength;
+        reading = Target::RAM;
+        return true;
+    }
+
+    while (flashTail != flashHead)
+    {
+        readFile = LittleFS.open(flashPath(flashTail).c_str(), "r");
+        uint8_t topicByte;
+        if (readFile && readFile.size() > 0 && readFile.read(&topicByte, 1) == 1)
+        {
+            topic = (OutboxTopic)topicByte;
+            length = frontLength = readFile.size() - 1;
+            reading = Target::FLASH;
+            return true;
+        }
+
+        // Missing or empty file: skip it
+        if (readFile)
+            readFile.close();
+        LittleFS.remove(flashPath(flashTail).c_str());
+        flashTail++;
+    }
+    return false;
+}
+
+size_t MessageOutbox::readFront(uint8_t *out, size_t length)
+{
+    if (length > frontLength - frontRead)
+        length = frontLength - frontRead;
+
+    if (reading == Target::RAM)
+    {
+        getBytes(wrap(ramTail + RECORD_HEADER + frontRead), out, length);
+    }
+    else if (reading == Target::FLASH)
+    {
+        int n = readFile.read(out, length);
+        length = n > 0 ? n : 0;
+    }
+    else
+    {
+        return 0;
+    }
+
+    frontRead += length;
+    return length;
+}
+
+void MessageOutbox::pop()
+{
+    if (reading == Target::RAM)
+    {
+        ramTail = wrap(ramTail + RECORD_HEADER + frontLength);
+        ramUsed -= RECORD_HEADER + frontLength;
+        ramMessages--;
+        if (ramMessages == 0)
+            ramTail = ramUsed = 0;
+    }
+    else if (reading == Target::FLASH)
+    {
+        readFile.close();
+        LittleFS.remove(flashPath(flashTail).c_str());
+        flashBytes = flashBytes > frontLength + 1 ? flashBytes - (frontLength + 1) : 0;
+        flashTail++;
+    }
+    reading = Target::NONE;
+}
@@ -0,0 +1,129 @@
+#ifndef MESSAGE_OUTBOX_H
+#define MESSAGE_OUTBOX_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+#include "../memory/PSRAMAllocator.h"
+
+/**
+ * MessageOutbox - Store-and-forward queue for data messages
+ *
+ * MQTTManager parks every data message it cannot deliver (session batches,
+ * Live Debug captures, session summaries) here, fully encoded, and
+ * publishes them again in order once the broker is back. Status messages
+ * are not queued.
+ *
+ * - A PSRAM byte ring (OUTBOX_RAM_BYTES, reserved once at begin()) holds
+ *   [u32 length][u8 topic][payload] records
+ * - When the ring is full, messages overflow to one LittleFS file each in
+ *   OUTBOX_DIR (bounded by OUTBOX_FLASH_MAX_BYTES); these survive a reboot
+ *   and are drained after the next connect
+ * - Once anything is in flash, new messages go to flash too, so delivery
+ *   stays first-in first-out
+ * - One message is written at a time: beginMessage() / append() /
+ *   commitMessage() or abortMessage()
+ *
+ * Not thread-safe: MQTTManager only touches it with its outbox lock held.
+ */
+
+#ifndef OUTBOX_RAM_BYTES
+#define OUTBOX_RAM_BYTES (512 * 1024)
+#endif
+
+#ifndef OUTBOX_FLASH_MAX_BYTES
+#define OUTBOX_FLASH_MAX_BYTES (1024 * 1024)
+#endif
+
+// Filesystem space left free for config.json and certificates
+#ifndef OUTBOX_FLASH_RESERVE_BYTES
+#define OUTBOX_FLASH_RESERVE_BYTES (64 * 1024)
+#endif
+
+#define OUTBOX_DIR "/outbox"
+
+enum class OutboxTopic : uint8_t
+{
+    DATA,    // <device>/data (JSON)
+    DATA_BIN // <device>/data/bin (raw binary captures)
+};
+
+class MessageOutbox
+{
+public:
+    /**
+     * Reserve the PSRAM ring and index any messages left in flash
+     * (LittleFS must be mounted)
+     * @return false if the ring could not be allocated
+     */
+    bool begin();
+
+    bool isReady() const { return !ring.empty(); }
+
+    /**
+     * Open a record of exactly length payload bytes
+     * @param allowFlash false = PSRAM only (e.g. a copy kept while the
+     *        message is also being published directly)
+     * @return false if there is no room
+     */
+    bool beginMessage(OutboxTopic topic, size_t length, bool allowFlash = true);
+    bool append(const uint8_t *data, size_t length);
+    bool commitMessage();
+    void abortMessage();
+
+    // Store a whole message in one call
+    bool store(OutboxTopic topic, const uint8_t *data, size_t length);
+
+    /**
+     * Oldest message, and rewind readFront() to its first payload byte
+     * @return false if the outbox is empty
+     */
+    bool peek(OutboxTopic &topic, size_t &length);
+    size_t readFront(uint8_t *out, size_t length);
+    void pop();
+
+    bool empty() const { return ramMessages == 0 && flashTail == flashHead; }
+    uint32_t pending() const { return ramMessages + (flashHead - flashTail); }
+    size_t pendingBytes() const { return ramUsed + flashBytes; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+
+private:
+    static const size_t RECORD_HEADER = 5;
+
+    std::vector<uint8_t, PSRAMAllocator<uint8_t, HeapTag::MQTT>> ring;
+    size_t ramTail = 0; // Oldest record
+    size_t ramUsed = 0; // Committed bytes, headers included
+    uint32_t ramMessages = 0;
+
+    uint32_t flashTail = 0; // Oldest file sequence number
+    uint32_t flashHead = 0; // Next file sequence number
+    size_t flashBytes = 0;
+
+    // Open record
+    enum class Target
+    {
+        NONE,
+        RAM,
+        FLASH
+    };
+    Target writing = Target::NONE;
+    OutboxTopic writeTopic = OutboxTopic::DATA;
+    size_t writeLength = 0;
+    size_t written = 0;
+    File writeFile;
+
+    // Front record being read
+    Target reading = Target::NONE;
+    size_t frontLength = 0;
+    size_t frontRead = 0;
+    File readFile;
+
+    uint32_t droppedCount = 0;
+
+    void putBytes(size_t pos, const uint8_t *data, size_t length);
+    void getBytes(size_t pos, uint8_t *out, size_t length) const;
+    size_t wrap(size_t pos) const { return pos >= ring.size() ? pos - ring.size() : pos; }
+    static String flashPath(uint32_t sequence);
+};
+
+#endif
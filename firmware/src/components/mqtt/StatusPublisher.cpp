@@ -0,0 +1,218 @@
+#include "StatusPublisher.h"
+#include "../diagnostics/LatencyTracker.h"
+#include "../network/TimeSync.h"
+
+bool StatusPublisher::begin(MQTTManager *mqttManager)
+{
+    mqtt = mqttManager;
+    if (task != nullptr)
+        return true;
+
+    queue = xQueueCreate(STATUS_QUEUE_DEPTH, sizeof(Item));
+    if (queue == nullptr)
+    {
+        Serial.println("ERROR: StatusPublisher queue creation failed");
+        return false;
+    }
+
+    // Same core and priority as the capture upload task: both only wait
+    // on the MQTT client
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "StatusTask",
+        6144,
+        this,
+        1,
+        &task,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: StatusPublisher task creation failed");
+        vQueueDelete(queue);
+        queue = nullptr;
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool StatusPublisher::post(const char *status, StatusDetailsFn detailsFn)
+{
+    Item item;
+    strlcpy(item.status, status, sizeof(item.status));
+    item.details = detailsFn;
+    item.confidence = 0.0f;
+    item.timestampMs = millis();
+    item.firstCrossingUs = 0;
+    item.decisionUs = 0;
+    item.syncUs = 0;
+    item.detection = false;
+    item.ml = false;
+    return enqueue(item);
+}
+
+bool StatusPublisher::postDetection(const char *direction, float confidence,
+                                    bool ml, uint32_t firstCrossingUs, uint32_t decisionUs)
+{
+    Item item;
+    strlcpy(item.status, direction, sizeof(item.status));
+    item.details = nullptr;
+    item.confidence = confidence;
+    item.timestampMs = millis();
+    item.firstCrossingUs = firstCrossingUs;
+    item.decisionUs = decisionUs;
+    item.syncUs = TimeSync::microsToSyncUs(firstCrossingUs != 0 ? firstCrossingUs : decisionUs);
+    item.detection = true;
+    item.ml = ml;
+    return enqueue(item);
+}
+
+bool StatusPublisher::enqueue(const Item &item)
+{
+    if (task == nullptr)
+    {
+        // No task: publish inline, as before
+        if (mqtt == nullptr)
+            return false;
+        add(item);
+        flush();
+        return true;
+    }
+
+    if (xQueueSend(queue, &item, 0) != pdTRUE)
+    {
+        droppedCount++;
+        return false;
+    }
+    return true;
+}
+
+bool StatusPublisher::add(const Item &item)
+{
+    if (item.detection)
+    {
+        if (detectionCount >= STATUS_DETECTION_BATCH)
+            return false;
+        detections[detectionCount++] = item;
+        return true;
+    }
+
+    for (size_t i = 0; i < statusCount; i++)
+    {
+        Entry &entry = statuses[i];
+        if (entry.item.details == item.details && strcmp(entry.item.status, item.status) == 0)
+        {
+            entry.count++;
+            return true;
+        }
+    }
+
+    if (statusCount >= STATUS_QUEUE_DEPTH)
+        return false;
+    statuses[statusCount].item = item;
+    statuses[statusCount].count = 1;
+    statusCount++;
+    return true;
+}
+
+void StatusPublisher::flush()
+{
+    for (size_t i = 0; i < statusCount; i++)
+        publish(statuses[i]);
+    statusCount = 0;
+
+    if (detectionCount > 0)
+        publishDetections();
+    detectionCount = 0;
+}
+
+void StatusPublisher::publish(const Entry &entry)
+{
+    details.clear();
+    if (entry.item.details != nullptr)
+        entry.item.details(details);
+    if (entry.count > 1)
+        details["repeat_count"] = entry.count;
+
+    mqtt->publishStatus(entry.item.status, details);
+}
+
+void StatusPublisher::publishDetections()
+{
+    details.clear();
+    char status[STATUS_TEXT_MAX + 10];
+
+    if (detectionCount == 1)
+    {
+        const Item &item = detections[0];
+        snprintf(status, sizeof(status), "detection_%s", item.status);
+        details["confidence"] = item.confidence;
+        details["detected_ms"] = item.timestampMs;
+        if (item.syncUs != 0)
+            details["sync_us"] = item.syncUs;
+        if (mqtt->publishStatus(status, details))
+            recordLatency(micros());
+        return;
+    }
+
+    JsonArray list = details.createNestedArray("detections");
+    for (size_t i = 0; i < detectionCount; i++)
+    {
+        JsonObject entry = list.createNestedObject();
+        entry["direction"] = (const char *)detections[i].status;
+        entry["confidence"] = detections[i].confidence;
+        entry["detected_ms"] = detections[i].timestampMs;
+        if (detections[i].syncUs != 0)
+            entry["sync_us"] = detections[i].syncUs;
+    }
+    if (mqtt->publishStatus("detections", details))
+        recordLatency(micros());
+}
+
+void StatusPublisher::recordLatency(uint32_t publishedUs)
+{
+    for (size_t i = 0; i < detectionCount; i++)
+    {
+        const Item &item = detections[i];
+        LatencyTracker::record(item.ml, LatencyStage::PUBLISH, item.decisionUs, publishedUs);
+        LatencyTracker::record(item.ml, LatencyStage::TOTAL, item.firstCrossingUs, publishedUs);
+    }
+}
+
+void StatusPublisher::taskFunction(void *parameter)
+{
+    static_cast<StatusPublisher *>(parameter)->run();
+}
+
+void StatusPublisher::run()
+{
+    for (;;)
+    {
+        Item item;
+        if (xQueueReceive(queue, &item, portMAX_DELAY) != pdTRUE)
+            continue;
+        sending = true;
+        add(item);
+
+        // Collect whatever else arrives within the window
+        TickType_t windowEnd = xTaskGetTickCount() + pdMS_TO_TICKS(STATUS_COALESCE_MS);
+        for (;;)
+        {
+            TickType_t now = xTaskGetTickCount();
+            if ((int32_t)(windowEnd - now) <= 0)
+                break;
+            if (xQueueReceive(queue, &item, windowEnd - now) != pdTRUE)
+                break;
+            if (!add(item))
+            {
+                // Window full: send it and start a new one with this item
+                flush();
+                add(item);
+            }
+        }
+
+        flush();
+        sending = false;
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef STATUS_PUBLISHER_H
+#define STATUS_PUBLISHER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "MQTTManager.h"
+
+/**
+ * StatusPublisher - Status messages published from a background task
+ *
+ * publishStatus() builds JSON and writes to the TLS socket, which used to
+ * happen inline wherever a status was reported - including loop()'s
+ * detection path, where it delayed the next LED update. post() only
+ * copies the status into a queue; the publisher task sends it.
+ *
+ * - The first item starts a STATUS_COALESCE_MS window; everything that
+ *   arrives within it is sent together at the end
+ * - Repeats of one status in a window become one message with
+ *   "repeat_count"
+ * - Detections in a window become one "detections" message (a single
+ *   detection is still sent as "detection_<direction>")
+ * - Each detection carries sync_us, its first crossing on the clock
+ *   shared by all units (TimeSync), once that clock is synced
+ * - Statuses go out in the order first posted, detections after them
+ * - A details callback fills extra fields on the publisher task, at send
+ *   time (it must only read state that is safe to read from there)
+ * - post() never blocks: a full queue drops the status and counts it
+ *
+ * Status messages with large details (profile reports) still call
+ * MQTTManager::publishStatus() directly.
+ */
+
+#ifndef STATUS_QUEUE_DEPTH
+#define STATUS_QUEUE_DEPTH 16
+#endif
+
+#ifndef STATUS_COALESCE_MS
+#define STATUS_COALESCE_MS 50
+#endif
+
+// Detections batched into one message; more start a new window
+#ifndef STATUS_DETECTION_BATCH
+#define STATUS_DETECTION_BATCH 8
+#endif
+
+#define STATUS_TEXT_MAX 40
+
+typedef void (*StatusDetailsFn)(JsonDocument &details);
+
+class StatusPublisher
+{
+public:
+    /**
+     * Create the queue and the publisher task (core 1, priority 1)
+     * @return false on failure; post() then publishes synchronously
+     */
+    bool begin(MQTTManager *mqtt);
+
+    bool post(const char *status, StatusDetailsFn details = nullptr);
+    // Detection result; direction is DirectionDetector::directionToString().
+    // The stamps (micros(), 0 = unknown) feed LatencyTracker once published
+    bool postDetection(const char *direction, float confidence,
+                       bool ml = false, uint32_t firstCrossingUs = 0, uint32_t decisionUs = 0);
+
+    uint32_t getDroppedCount() const { return droppedCount; }
+
+    // Nothing queued and no window being collected or sent (light sleep waits for this)
+    bool isIdle() const
+    {
+        return !sending && (queue == nullptr || uxQueueMessagesWaiting(queue) == 0);
+    }
+
+private:
+    struct Item
+    {
+        char status[STATUS_TEXT_MAX]; // Or the direction, for a detection
+        StatusDetailsFn details;
+        float confidence;
+        uint32_t timestampMs;
+        uint32_t firstCrossingUs; // Detection only
+        uint32_t decisionUs;
+        int64_t syncUs;           // Shared clock (TimeSync), 0 if not synced
+        bool detection;
+        bool ml;
+    };
+
+    // One window's worth of items, merged
+    struct Entry
+    {
+        Item item;
+        uint16_t count;
+    };
+
+    MQTTManager *mqtt = nullptr;
+    QueueHandle_t queue = nullptr;
+    TaskHandle_t task = nullptr;
+    volatile uint32_t droppedCount = 0;
+    volatile bool sending = false; // From the first item of a window until it is flushed
+
+    Entry statuses[STATUS_QUEUE_DEPTH];
+    size_t statusCount = 0;
+    Item detections[STATUS_DETECTION_BATCH];
+    size_t detectionCount = 0;
+    StaticJsonDocument<1024> details;
+
+    bool enqueue(const Item &item);
+    bool add(const Item &item);
+    void flush();
+    void publish(const Entry &entry);
+    void publishDetections();
+    void recordLatency(uint32_t publishedUs);
+
+    static void taskFunction(void *parameter);
+    void run();
+};
+
+#endif
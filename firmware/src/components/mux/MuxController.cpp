@@ -6,21 +6,13 @@
 
 #include "MuxController.h"
 
-// Static sensor position mapping
-// Position -> (tcaChannel, pcaChannel, pcbId, side)
-const SensorPosition MuxController::_sensorMap[MUX_TOTAL_SENSORS] = {
-    {0, 0, 0, 1, 1},  // Position 0: P1S1 (TCA0, PCA0)
-    {1, 0, 1, 1, 2},  // Position 1: P1S2 (TCA0, PCA1)
-    {2, 1, 0, 2, 1},  // Position 2: P2S1 (TCA1, PCA0)
-    {3, 1, 1, 2, 2},  // Position 3: P2S2 (TCA1, PCA1)
-    {4, 2, 0, 3, 1},  // Position 4: P3S1 (TCA2, PCA0)
-    {5, 2, 1, 3, 2}   // Position 5: P3S2 (TCA2, PCA1)
-};
-
 MuxController::MuxController(uint8_t tcaAddress) 
     : _tcaAddress(tcaAddress)
     , _currentTCAChannel(255)
     , _currentPCAChannel(255)
+    , _tcaMask(MUX_MASK_UNKNOWN)
+    , _muxWritesIssued(0)
+    , _muxWritesSkipped(0)
     , _activeSensorCount(0)
 {
     // Initialize boards array
@@ -29,7 +21,17 @@ MuxController::MuxController(uint8_t tcaAddress)
         _boards[i].pcaAddress = 0;
         _boards[i].sensor1Present = false;
         _boards[i].sensor2Present = false;
+        _pcaMask[i] = MUX_MASK_UNKNOWN;
+        _boardBus[i] = 0;
+    }
+    
+#if PIN_IIC1_SDA >= 0
+    // Boards past the end of SENSOR_BOARD_BUS stay on Wire behind the TCA
+    const uint8_t busMap[] = SENSOR_BOARD_BUS;
+    for (size_t i = 0; i < sizeof(busMap) && i < MUX_NUM_BOARDS; i++) {
+        _boardBus[i] = busMap[i] ? 1 : 0;
     }
+#endif
     
     // Initialize sensors as inactive
     for (int i = 0; i < MUX_TOTAL_SENSORS; i++) {
@@ -46,25 +48,56 @@ bool MuxController::begin(int sda, int scl, uint32_t clockHz)
         Wire.begin(sda, scl);
         Wire.setClock(clockHz);
         Serial.printf("  I2C initialized: SDA=%d, SCL=%d, Clock=%luHz\n", sda, scl, clockHz);
+        
+        bool anyOnBus1 = false;
+        for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++) {
+            anyOnBus1 |= _boardBus[board] != 0;
+        }
+        if (anyOnBus1) {
+            Wire1.begin(PIN_IIC1_SDA, PIN_IIC1_SCL);
+            Wire1.setClock(clockHz);
+            Serial.printf("  I2C bus 1 initialized: SDA=%d, SCL=%d\n", PIN_IIC1_SDA, PIN_IIC1_SCL);
+        }
     }
     
-    // Check if TCA9548A is present
+    // Check if TCA9548A is present (only boards on Wire sit behind it)
+    bool needTCA = false;
+    for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++) {
+        needTCA |= _boardBus[board] == 0;
+    }
     Wire.beginTransmission(_tcaAddress);
     if (Wire.endTransmission() != 0) {
-        Serial.printf("  ERROR: TCA9548A not found at 0x%02X\n", _tcaAddress);
-        return false;
+        if (needTCA) {
+            Serial.printf("  ERROR: TCA9548A not found at 0x%02X\n", _tcaAddress);
+            return false;
+        }
+        Serial.println("  No TCA9548A (all boards on bus 1)");
+    } else {
+        Serial.printf("  TCA9548A found at 0x%02X\n", _tcaAddress);
     }
-    Serial.printf("  TCA9548A found at 0x%02X\n", _tcaAddress);
     
     // Disable all TCA channels initially
-    writeTCA(0x00);
+    invalidateCache();
+    setTCAMask(0x00);
     delay(10);
     
+    // Bus 1 boards are not isolated by a TCA: close every PCA there before
+    // probing, or a board left selected would answer for the one being probed
+    for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++) {
+        if (_boardBus[board]) {
+            writePCA(Wire1, 0x74 + board % 4, 0x00);
+        }
+    }
+    
     // Scan each TCA channel for PCA9546A and sensors
     _activeSensorCount = 0;
     
     for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++) {
-        Serial.printf("  Scanning TCA channel %d...\n", board);
+        if (_boardBus[board]) {
+            Serial.printf("  Probing bus 1 for board %d...\n", board);
+        } else {
+            Serial.printf("  Scanning TCA channel %d...\n", board);
+        }
         
         // Select TCA channel
         if (!selectTCAChannel(board)) {
@@ -87,13 +120,13 @@ bool MuxController::begin(int sda, int scl, uint32_t clockHz)
         // Check each sensor on this board
         for (uint8_t sensor = 0; sensor < MUX_SENSORS_PER_BOARD; sensor++) {
             // Select PCA channel
-            if (!writePCA(pcaAddr, 1 << sensor)) {
+            if (!setPCAMask(board, 1 << sensor)) {
                 continue;
             }
             delay(10);
             
             // Check for VCNL4040
-            bool present = checkVCNL4040Present();
+            bool present = checkVCNL4040Present(getWire(board));
             uint8_t position = board * MUX_SENSORS_PER_BOARD + sensor;
             
             _sensorsActive[position] = present;
@@ -112,7 +145,7 @@ bool MuxController::begin(int sda, int scl, uint32_t clockHz)
         }
         
         // Disable PCA channels on this board
-        writePCA(pcaAddr, 0x00);
+        setPCAMask(board, 0x00);
     }
     
     // Disable all channels
@@ -128,8 +161,7 @@ bool MuxController::selectSensor(uint8_t position)
         return false;
     }
     
-    const SensorPosition& pos = _sensorMap[position];
-    return selectSensor(pos.tcaChannel, pos.pcaChannel);
+    return selectSensor(position / MUX_SENSORS_PER_BOARD, position % MUX_SENSORS_PER_BOARD);
 }
 
 bool MuxController::selectSensor(uint8_t board, uint8_t sensor)
@@ -143,15 +175,10 @@ bool MuxController::selectSensor(uint8_t board, uint8_t sensor)
         return false;
     }
     
-    // If switching TCA channels, disable current PCA first
-    if (_currentTCAChannel != 255 && _currentTCAChannel != board) {
-        if (_boards[_currentTCAChannel].pcaAddress != 0) {
-            // Need to select old TCA channel to disable its PCA
-            writeTCA(1 << _currentTCAChannel);
-            delayMicroseconds(100);
-            writePCA(_boards[_currentTCAChannel].pcaAddress, 0x00);
-        }
-    }
+    // No need to disable the previous board's PCA when switching: the TCA
+    // only enables one downstream channel, which isolates every other board's
+    // 0x60. Leaving PCAs selected lets the cache skip the re-select when we
+    // come back to the same sensor (sticky per-board access).
     
     // Select TCA channel
     if (!selectTCAChannel(board)) {
@@ -172,12 +199,35 @@ bool MuxController::selectTCAChannel(uint8_t channel)
         return false;
     }
     
-    if (!writeTCA(1 << channel)) {
+    if (channel < MUX_NUM_BOARDS && _boardBus[channel]) {
+        // Wire1 has no TCA: close the other Wire1 boards' PCAs instead so
+        // only this board answers at 0x60 (cached, usually no writes)
+        for (uint8_t other = 0; other < MUX_NUM_BOARDS; other++) {
+            if (other != channel && _boardBus[other] && _boards[other].pcaAddress != 0 &&
+                !setPCAMask(other, 0x00)) {
+                _currentTCAChannel = 255;
+                _currentPCAChannel = 255;
+                return false;
+            }
+        }
+    } else if (!setTCAMask(1 << channel)) {
+        _currentTCAChannel = 255;
+        _currentPCAChannel = 255;
         return false;
     }
     
     _currentTCAChannel = channel;
-    _currentPCAChannel = 255; // Reset PCA selection when TCA changes
+    
+    // PCA selection on this board is whatever we last left it at
+    _currentPCAChannel = 255;
+    if (channel < MUX_NUM_BOARDS) {
+        uint8_t mask = _pcaMask[channel];
+        for (uint8_t ch = 0; ch < 4 && mask != MUX_MASK_UNKNOWN; ch++) {
+            if (mask == (1 << ch)) {
+                _currentPCAChannel = ch;
+            }
+        }
+    }
     return true;
 }
 
@@ -192,12 +242,12 @@ bool MuxController::selectPCAChannel(uint8_t channel)
         return false;
     }
     
-    uint8_t pcaAddr = _boards[_currentTCAChannel].pcaAddress;
-    if (pcaAddr == 0) {
+    if (_boards[_currentTCAChannel].pcaAddress == 0) {
         return false;
     }
     
-    if (!writePCA(pcaAddr, 1 << channel)) {
+    if (!setPCAMask(_currentTCAChannel, 1 << channel)) {
+        _currentPCAChannel = 255;
         return false;
     }
     
@@ -209,16 +259,29 @@ void MuxController::disableAll()
 {
     // IMPORTANT: Must select each TCA channel before disabling its PCA
     // This is required because PCA is only accessible through its TCA channel
+    invalidateCache();
     for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++) {
         if (_boards[board].pcaAddress != 0) {
-            writeTCA(1 << board);
-            delayMicroseconds(100);
-            writePCA(_boards[board].pcaAddress, 0x00);
+            if (!_boardBus[board]) {
+                setTCAMask(1 << board);
+                delayMicroseconds(100);
+            }
+            setPCAMask(board, 0x00);
         }
     }
     
     // Disable all TCA channels
-    writeTCA(0x00);
+    setTCAMask(0x00);
+    _currentTCAChannel = 255;
+    _currentPCAChannel = 255;
+}
+
+void MuxController::invalidateCache()
+{
+    _tcaMask = MUX_MASK_UNKNOWN;
+    for (uint8_t board = 0; board < MUX_NUM_BOARDS; board++) {
+        _pcaMask[board] = MUX_MASK_UNKNOWN;
+    }
     _currentTCAChannel = 255;
     _currentPCAChannel = 255;
 }
@@ -226,9 +289,8 @@ void MuxController::disableAll()
 void MuxController::disableCurrentPCA()
 {
     if (_currentTCAChannel < MUX_NUM_BOARDS) {
-        uint8_t pcaAddr = _boards[_currentTCAChannel].pcaAddress;
-        if (pcaAddr != 0) {
-            writePCA(pcaAddr, 0x00);
+        if (_boards[_currentTCAChannel].pcaAddress != 0) {
+            setPCAMask(_currentTCAChannel, 0x00);
         }
     }
     _currentPCAChannel = 255;
@@ -240,7 +302,9 @@ SensorPosition MuxController::getSensorPosition(uint8_t position) const
         // Return invalid position
         return {255, 255, 255, 255, 255};
     }
-    return _sensorMap[position];
+    uint8_t board = position / MUX_SENSORS_PER_BOARD;
+    uint8_t sensor = position % MUX_SENSORS_PER_BOARD;
+    return {position, board, sensor, (uint8_t)(board + 1), (uint8_t)(sensor + 1)};
 }
 
 bool MuxController::isSensorAvailable(uint8_t position) const
@@ -264,12 +328,25 @@ uint8_t MuxController::getActiveSensorCount() const
     return _activeSensorCount;
 }
 
+TwoWire &MuxController::getWire(uint8_t board) const
+{
+    return (board < MUX_NUM_BOARDS && _boardBus[board]) ? Wire1 : Wire;
+}
+
 // ============================================================================
 // Private Methods
 // ============================================================================
 
 uint8_t MuxController::scanForPCA(uint8_t tcaChannel)
 {
+    if (tcaChannel < MUX_NUM_BOARDS && _boardBus[tcaChannel]) {
+        // Shared bus: a scan would also find the other boards' PCAs, so only
+        // this board's own address counts
+        uint8_t address = 0x74 + tcaChannel % 4;
+        Wire1.beginTransmission(address);
+        return (Wire1.endTransmission() == 0) ? address : 0;
+    }
+    
     // Common PCA9546A addresses to try
     const uint8_t addresses[] = {0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77};
     
@@ -288,22 +365,22 @@ uint8_t MuxController::scanForPCA(uint8_t tcaChannel)
     return 0; // Not found
 }
 
-bool MuxController::checkVCNL4040Present()
+bool MuxController::checkVCNL4040Present(TwoWire &wire)
 {
     // Try to read device ID register (0x0C)
-    Wire.beginTransmission(VCNL4040_ADDR);
-    Wire.write(0x0C);
-    if (Wire.endTransmission(false) != 0) {
+    wire.beginTransmission(VCNL4040_ADDR);
+    wire.write(0x0C);
+    if (wire.endTransmission(false) != 0) {
         return false;
     }
     
-    Wire.requestFrom((uint8_t)VCNL4040_ADDR, (uint8_t)2);
-    if (Wire.available() < 2) {
+    wire.requestFrom((uint8_t)VCNL4040_ADDR, (uint8_t)2);
+    if (wire.available() < 2) {
         return false;
     }
     
-    uint8_t idLow = Wire.read();
-    uint8_t idHigh = Wire.read();
+    uint8_t idLow = wire.read();
+    uint8_t idHigh = wire.read();
     uint16_t deviceId = ((uint16_t)idHigh << 8) | idLow;
     
     return (deviceId == 0x0186);
@@ -316,10 +393,47 @@ bool MuxController::writeTCA(uint8_t channelMask)
     return (Wire.endTransmission() == 0);
 }
 
-bool MuxController::writePCA(uint8_t address, uint8_t channelMask)
+bool MuxController::writePCA(TwoWire &wire, uint8_t address, uint8_t channelMask)
 {
-    Wire.beginTransmission(address);
-    Wire.write(channelMask);
-    return (Wire.endTransmission() == 0);
+    wire.beginTransmission(address);
+    wire.write(channelMask);
+    return (wire.endTransmission() == 0);
+}
+
+bool MuxController::setTCAMask(uint8_t channelMask)
+{
+    if (_tcaMask == channelMask) {
+        _muxWritesSkipped++;
+        return true;
+    }
+    
+    _muxWritesIssued++;
+    if (!writeTCA(channelMask)) {
+        _tcaMask = MUX_MASK_UNKNOWN;
+        return false;
+    }
+    
+    _tcaMask = channelMask;
+    return true;
 }
 
+bool MuxController::setPCAMask(uint8_t board, uint8_t channelMask)
+{
+    if (board >= MUX_NUM_BOARDS || _boards[board].pcaAddress == 0) {
+        return false;
+    }
+    
+    if (_pcaMask[board] == channelMask) {
+        _muxWritesSkipped++;
+        return true;
+    }
+    
+    _muxWritesIssued++;
+    if (!writePCA(getWire(board), _boards[board].pcaAddress, channelMask)) {
+        _pcaMask[board] = MUX_MASK_UNKNOWN;
+        return false;
+    }
+    
+    _pcaMask[board] = channelMask;
+    return true;
+}
\ No newline at end of file
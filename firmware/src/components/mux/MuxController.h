@@ -2,13 +2,19 @@
  * MuxController - Shared TCA9548A + PCA9546A Multiplexer Handling
  * 
  * This component manages the dual-multiplexer architecture used in Motion Play:
- *   - TCA9548A on main board: Selects which sensor board (0, 1, 2)
+ *   - TCA9548A on main board: Selects which sensor board (0..SENSOR_MAX_BOARDS-1)
  *   - PCA9546A on each sensor board: Selects which sensor (0 = S1, 1 = S2)
  * 
  * Architecture:
  *   MCU I2C → TCA9548A → [Sensor Board 0] → PCA9546A → VCNL4040 S1/S2
  *                      → [Sensor Board 1] → PCA9546A → VCNL4040 S1/S2
  *                      → [Sensor Board 2] → PCA9546A → VCNL4040 S1/S2
+ *                      → ... (up to SENSOR_MAX_BOARDS, see SensorFrame.h)
+ * 
+ *   Boards assigned to the second bus (SENSOR_BOARD_BUS in pin_config.h)
+ *   hang off Wire1 directly, without a TCA; their PCAs at 0x74 + board
+ *   keep them apart:
+ *   MCU I2C1 → PCA9546A (0x74 + board) → VCNL4040 S1/S2
  * 
  * Usage:
  *   MuxController mux;
@@ -22,25 +28,32 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "pin_config.h"
+#include "../sensor/SensorFrame.h"
 
-// Number of sensor boards and sensors per board
-#define MUX_NUM_BOARDS 3
-#define MUX_SENSORS_PER_BOARD 2
+// Number of sensor boards and sensors per board (the topology capacity;
+// begin() finds which boards are actually there)
+#define MUX_NUM_BOARDS SENSOR_MAX_BOARDS
+#define MUX_SENSORS_PER_BOARD SENSORS_PER_BOARD
 #define MUX_TOTAL_SENSORS (MUX_NUM_BOARDS * MUX_SENSORS_PER_BOARD)
 
 // Default I2C addresses
 #define TCA9548A_DEFAULT_ADDR 0x70
 #define VCNL4040_ADDR 0x60
 
+// Cached mux mask value meaning "hardware state not known"
+#define MUX_MASK_UNKNOWN 0xFF
+
 /**
  * Sensor position mapping
- * Position 0-5 maps to specific TCA channel (board) and PCA channel (sensor)
+ * Position maps to specific TCA channel (board) and PCA channel (sensor):
+ * position = board * MUX_SENSORS_PER_BOARD + sensor
  */
 struct SensorPosition {
-    uint8_t position;     // 0-5 (overall sensor index)
-    uint8_t tcaChannel;   // 0-2 (which sensor board)
+    uint8_t position;     // Overall sensor index
+    uint8_t tcaChannel;   // Which sensor board
     uint8_t pcaChannel;   // 0-1 (which sensor on board: S1=0, S2=1)
-    uint8_t pcbId;        // 1-3 (human-readable board number)
+    uint8_t pcbId;        // 1.. (human-readable board number)
     uint8_t side;         // 1-2 (human-readable sensor side)
     
     String getName() const {
@@ -76,7 +89,7 @@ public:
     bool begin(int sda = -1, int scl = -1, uint32_t clockHz = 400000);
     
     /**
-     * Select a specific sensor by position (0-5)
+     * Select a specific sensor by position (0..MUX_TOTAL_SENSORS-1)
      * This sets up both TCA and PCA channels so the sensor at 0x60 is accessible
      * @param position Sensor position (0=P1S1, 1=P1S2, 2=P2S1, 3=P2S2, 4=P3S1, 5=P3S2)
      * @return true if successful
@@ -85,7 +98,7 @@ public:
     
     /**
      * Select a specific sensor by board and sensor index
-     * @param board Board index (0-2)
+     * @param board Board index (0..MUX_NUM_BOARDS-1)
      * @param sensor Sensor index (0-1)
      * @return true if successful
      */
@@ -107,10 +120,17 @@ public:
     
     /**
      * Disable all channels on both TCA and all PCAs
-     * This releases the I2C bus
+     * This releases the I2C bus. Always writes (ignores the cache), so it is
+     * also the resync point after other code has touched the muxes.
      */
     void disableAll();
     
+    /**
+     * Forget cached TCA/PCA state so the next select always writes.
+     * Call after anything outside this controller has driven the muxes.
+     */
+    void invalidateCache();
+    
     /**
      * Disable all PCA channels on currently selected TCA channel
      */
@@ -118,21 +138,21 @@ public:
     
     /**
      * Get sensor position info
-     * @param position Sensor position (0-5)
+     * @param position Sensor position (0..MUX_TOTAL_SENSORS-1)
      * @return SensorPosition struct with mapping info
      */
     SensorPosition getSensorPosition(uint8_t position) const;
     
     /**
      * Check if a sensor is available
-     * @param position Sensor position (0-5)
+     * @param position Sensor position (0..MUX_TOTAL_SENSORS-1)
      * @return true if sensor was found during initialization
      */
     bool isSensorAvailable(uint8_t position) const;
     
     /**
      * Get board info
-     * @param board Board index (0-2)
+     * @param board Board index (0..MUX_NUM_BOARDS-1)
      * @return BoardInfo struct
      */
     BoardInfo getBoardInfo(uint8_t board) const;
@@ -154,20 +174,49 @@ public:
      * @return Current PCA channel (0-3) or 255 if none selected
      */
     uint8_t getCurrentPCAChannel() const { return _currentPCAChannel; }
+    
+    /**
+     * Mux write statistics (since begin)
+     * @return Number of TCA/PCA writes actually sent / skipped by the cache
+     */
+    uint32_t getMuxWritesIssued() const { return _muxWritesIssued; }
+    uint32_t getMuxWritesSkipped() const { return _muxWritesSkipped; }
+    
+    /**
+     * I2C bus a board's sensors are reached on (Wire or Wire1)
+     * @param board Board index (0..MUX_NUM_BOARDS-1)
+     */
+    TwoWire &getWire(uint8_t board) const;
+    
+    /**
+     * Bus index a board is on (0 = Wire behind the TCA, 1 = Wire1 without
+     * TCA), for callers building their own command lists
+     * @param board Board index (0..MUX_NUM_BOARDS-1)
+     */
+    uint8_t getBoardBus(uint8_t board) const { return board < MUX_NUM_BOARDS ? _boardBus[board] : 0; }
+    
+    uint8_t getTCAAddress() const { return _tcaAddress; }
 
 private:
     uint8_t _tcaAddress;
     uint8_t _currentTCAChannel;
     uint8_t _currentPCAChannel;
     
+    // Last mask written to the TCA and to each board's PCA (MUX_MASK_UNKNOWN
+    // until written). Selects that match the cached mask skip the bus write.
+    uint8_t _tcaMask;
+    uint8_t _pcaMask[MUX_NUM_BOARDS];
+    
+    // Bus per board (0 = Wire behind the TCA, 1 = Wire1 without TCA)
+    uint8_t _boardBus[MUX_NUM_BOARDS];
+    uint32_t _muxWritesIssued;
+    uint32_t _muxWritesSkipped;
+    
     // Board discovery results
     BoardInfo _boards[MUX_NUM_BOARDS];
     bool _sensorsActive[MUX_TOTAL_SENSORS];
     uint8_t _activeSensorCount;
     
-    // Sensor position mapping (constant)
-    static const SensorPosition _sensorMap[MUX_TOTAL_SENSORS];
-    
     /**
      * Scan for PCA9546A on a specific TCA channel
      * @param tcaChannel TCA channel to scan
@@ -177,9 +226,10 @@ private:
     
     /**
      * Check if a VCNL4040 is present at 0x60
+     * @param wire Bus the selected board is on
      * @return true if sensor responds
      */
-    bool checkVCNL4040Present();
+    bool checkVCNL4040Present(TwoWire &wire);
     
     /**
      * Send channel selection to TCA9548A
@@ -190,10 +240,26 @@ private:
     
     /**
      * Send channel selection to PCA9546A
+     * @param wire Bus the PCA is on
      * @param address PCA9546A address
      * @param channelMask Bitmask of channels to enable
      * @return true if successful
      */
-    bool writePCA(uint8_t address, uint8_t channelMask);
+    bool writePCA(TwoWire &wire, uint8_t address, uint8_t channelMask);
+    
+    /**
+     * Cached TCA write - skips the bus if the mask is already set
+     * @param channelMask Bitmask of channels to enable
+     * @return true if successful (or already set)
+     */
+    bool setTCAMask(uint8_t channelMask);
+    
+    /**
+     * Cached PCA write for a known board - skips the bus if already set
+     * @param board Board index (its TCA channel must be selected, if on Wire)
+     * @param channelMask Bitmask of channels to enable
+     * @return true if successful (or already set)
+     */
+    bool setPCAMask(uint8_t board, uint8_t channelMask);
 };
 
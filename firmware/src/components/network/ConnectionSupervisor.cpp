@@ -0,0 +1,187 @@
+#include "ConnectionSupervisor.h"
+
+bool ConnectionSupervisor::begin(NetworkManager *networkManager, MQTTManager *mqttManager)
+{
+    if (task != nullptr)
+        return true;
+
+    network = networkManager;
+    mqtt = mqttManager;
+
+    unsigned long now = millis();
+    if (mqtt->isConnected())
+        state = ConnectionState::ONLINE;
+    else if (network->isConnected())
+        state = ConnectionState::MQTT_CONNECTING;
+    else
+        state = ConnectionState::WIFI_DOWN;
+    if (state != ConnectionState::ONLINE)
+        offlineSinceMs = now;
+    nextAttemptMs = now;
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "ConnSupervisor",
+        8192, // TLS handshake
+        this,
+        1,
+        &task,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: ConnectionSupervisor task creation failed");
+        task = nullptr;
+        return false;
+    }
+
+    mqtt->setSupervised(true);
+    Serial.printf("ConnectionSupervisor started (%s)\n", stateName(state));
+    return true;
+}
+
+bool ConnectionSupervisor::subscribe(ConnectionListener listener, void *context)
+{
+    if (listenerCount >= CONNECTION_SUPERVISOR_MAX_LISTENERS)
+        return false;
+
+    listeners[listenerCount].callback = listener;
+    listeners[listenerCount].context = context;
+    listenerCount++;
+    return true;
+}
+
+const char *ConnectionSupervisor::stateName(ConnectionState state)
+{
+    switch (state)
+    {
+    case ConnectionState::WIFI_DOWN:
+        return "wifi_down";
+    case ConnectionState::WIFI_CONNECTING:
+        return "wifi_connecting";
+    case ConnectionState::MQTT_CONNECTING:
+        return "mqtt_connecting";
+    case ConnectionState::ONLINE:
+        return "online";
+    default:
+        return "unknown";
+    }
+}
+
+void ConnectionSupervisor::taskFunction(void *parameter)
+{
+    static_cast<ConnectionSupervisor *>(parameter)->run();
+}
+
+void ConnectionSupervisor::run()
+{
+    for (;;)
+    {
+        step(millis());
+        vTaskDelay(pdMS_TO_TICKS(CONNECTION_SUPERVISOR_POLL_MS));
+    }
+}
+
+void ConnectionSupervisor::step(unsigned long now)
+{
+    bool wifiUp = network->isConnected();
+
+    switch (state)
+    {
+    case ConnectionState::WIFI_DOWN:
+        if (wifiUp)
+        {
+            setState(ConnectionState::MQTT_CONNECTING, now);
+        }
+        else if ((long)(now - nextAttemptMs) >= 0)
+        {
+            network->beginWiFi();
+            wifiStartMs = now;
+            setState(ConnectionState::WIFI_CONNECTING, now);
+        }
+        break;
+
+    case ConnectionState::WIFI_CONNECTING:
+        if (wifiUp)
+        {
+            Serial.println("WiFi reconnected");
+            setState(ConnectionState::MQTT_CONNECTING, now);
+        }
+        else if (now - wifiStartMs >= CONNECTION_WIFI_TIMEOUT_MS)
+        {
+            scheduleRetry(now);
+            setState(ConnectionState::WIFI_DOWN, now);
+        }
+        break;
+
+    case ConnectionState::MQTT_CONNECTING:
+        if (!wifiUp)
+        {
+            setState(ConnectionState::WIFI_DOWN, now);
+        }
+        else if ((long)(now - nextAttemptMs) >= 0)
+        {
+            // Blocks this task for the TLS handshake only
+            if (mqtt->connectOnce())
+            {
+                backoffMs = CONNECTION_BACKOFF_MIN_MS;
+                setState(ConnectionState::ONLINE, millis());
+            }
+            else
+            {
+                scheduleRetry(millis());
+            }
+        }
+        break;
+
+    case ConnectionState::ONLINE:
+        if (!wifiUp)
+        {
+            Serial.println("WiFi connection lost");
+            backoffMs = CONNECTION_BACKOFF_MIN_MS;
+            nextAttemptMs = now;
+            setState(ConnectionState::WIFI_DOWN, now);
+        }
+        else if (!mqtt->isConnected())
+        {
+            Serial.println("MQTT connection lost");
+            backoffMs = CONNECTION_BACKOFF_MIN_MS;
+            nextAttemptMs = now;
+            setState(ConnectionState::MQTT_CONNECTING, now);
+        }
+        break;
+    }
+}
+
+void ConnectionSupervisor::scheduleRetry(unsigned long now)
+{
+    // Up to +25% jitter so several devices do not retry in lockstep
+    uint32_t delayMs = backoffMs + esp_random() % (backoffMs / 4 + 1);
+    nextAttemptMs = now + delayMs;
+    Serial.printf("Connection retry (%s) in %lu ms\n", stateName(state), (unsigned long)delayMs);
+
+    backoffMs *= 2;
+    if (backoffMs > CONNECTION_BACKOFF_MAX_MS)
+        backoffMs = CONNECTION_BACKOFF_MAX_MS;
+}
+
+void ConnectionSupervisor::setState(ConnectionState next, unsigned long now)
+{
+    if (next == state)
+        return;
+
+    if (next == ConnectionState::ONLINE)
+    {
+        reconnects++;
+        lastOutageMs = now - offlineSinceMs;
+        Serial.printf("Connection restored after %lu ms\n", (unsigned long)lastOutageMs);
+    }
+    else if (state == ConnectionState::ONLINE)
+    {
+        offlineSinceMs = now;
+    }
+
+    state = next;
+    for (uint8_t i = 0; i < listenerCount; i++)
+        listeners[i].callback(next, listeners[i].context);
+}
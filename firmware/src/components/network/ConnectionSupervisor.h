@@ -0,0 +1,114 @@
+#ifndef CONNECTION_SUPERVISOR_H
+#define CONNECTION_SUPERVISOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "NetworkManager.h"
+#include "../mqtt/MQTTManager.h"
+
+/**
+ * ConnectionSupervisor - Keeps WiFi and MQTT up from its own task
+ *
+ * Reconnects used to run inline in loop(): a WiFi drop or broker hiccup
+ * blocked it for the whole WiFi wait (up to 30 s) or the MQTT retries
+ * (5 x 5 s), and every TLS handshake cost seconds of loop time, so the
+ * frame ring overflowed. Now loop() only services an established
+ * connection (MQTTManager::loop()), and this task owns reconnection:
+ *
+ *   WIFI_DOWN -> WIFI_CONNECTING -> MQTT_CONNECTING -> ONLINE
+ *
+ * - WiFi.begin() is started without waiting; the association is polled
+ * - One MQTT attempt per step (MQTTManager::connectOnce()); while the
+ *   handshake runs, data messages go straight to the outbox
+ * - Failed attempts back off exponentially (BACKOFF_MIN_MS doubling to
+ *   BACKOFF_MAX_MS, with jitter); a successful connect resets it
+ * - Listeners are told about every state change. They run on this task
+ *   and must only record the change (set a flag, post to a queue).
+ *
+ * Core 1 at loop() priority, below DetectionTask: the handshake takes
+ * its share of the core without delaying detection.
+ */
+
+#ifndef CONNECTION_SUPERVISOR_POLL_MS
+#define CONNECTION_SUPERVISOR_POLL_MS 100
+#endif
+
+#ifndef CONNECTION_BACKOFF_MIN_MS
+#define CONNECTION_BACKOFF_MIN_MS 1000
+#endif
+
+#ifndef CONNECTION_BACKOFF_MAX_MS
+#define CONNECTION_BACKOFF_MAX_MS 60000
+#endif
+
+// Give up on one WiFi association after this long and back off
+#ifndef CONNECTION_WIFI_TIMEOUT_MS
+#define CONNECTION_WIFI_TIMEOUT_MS 15000
+#endif
+
+#define CONNECTION_SUPERVISOR_MAX_LISTENERS 4
+
+enum class ConnectionState : uint8_t
+{
+    WIFI_DOWN,       // No WiFi; waiting for the next attempt
+    WIFI_CONNECTING, // Association in progress
+    MQTT_CONNECTING, // WiFi up, broker not connected (attempt or backoff)
+    ONLINE           // MQTT connected
+};
+
+typedef void (*ConnectionListener)(ConnectionState state, void *context);
+
+class ConnectionSupervisor
+{
+public:
+    /**
+     * Start supervising; at boot this makes the first connection too.
+     * MQTTManager stops reconnecting from its own loop().
+     * @return false if the task could not be created
+     */
+    bool begin(NetworkManager *network, MQTTManager *mqtt);
+
+    /**
+     * Register a state change listener (call before or after begin())
+     * @return false if all listener slots are taken
+     */
+    bool subscribe(ConnectionListener listener, void *context = nullptr);
+
+    ConnectionState getState() const { return state; }
+    bool isOnline() const { return state == ConnectionState::ONLINE; }
+
+    uint32_t getReconnectCount() const { return reconnects; }
+    uint32_t getLastOutageMs() const { return lastOutageMs; }
+
+    static const char *stateName(ConnectionState state);
+
+private:
+    NetworkManager *network = nullptr;
+    MQTTManager *mqtt = nullptr;
+    TaskHandle_t task = nullptr;
+
+    volatile ConnectionState state = ConnectionState::WIFI_DOWN;
+    uint32_t backoffMs = CONNECTION_BACKOFF_MIN_MS;
+    unsigned long nextAttemptMs = 0;
+    unsigned long wifiStartMs = 0;
+    unsigned long offlineSinceMs = 0;
+    volatile uint32_t reconnects = 0;
+    volatile uint32_t lastOutageMs = 0;
+
+    struct Listener
+    {
+        ConnectionListener callback;
+        void *context;
+    };
+    Listener listeners[CONNECTION_SUPERVISOR_MAX_LISTENERS] = {};
+    volatile uint8_t listenerCount = 0;
+
+    static void taskFunction(void *parameter);
+    void run();
+    void step(unsigned long now);
+    void setState(ConnectionState next, unsigned long now);
+    void scheduleRetry(unsigned long now);
+};
+
+#endif
@@ -0,0 +1,415 @@
+#include "HoopArray.h"
+
+#include <WiFi.h>
+#include <esp_timer.h>
+
+// Socket receive timeout: bounds how late a beacon or release can be
+static const int RECEIVE_TIMEOUT_MS = 20;
+
+// Largest datagram parsed (a full frames packet is skipped unread)
+static const size_t RECEIVE_BUFFER = 64;
+
+bool HoopArray::begin(LanEventStream *lanStream)
+{
+    if (task != nullptr)
+        return true;
+
+    stream = lanStream;
+
+    sock = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+    {
+        Serial.println("ERROR: Hoop array socket creation failed");
+        return false;
+    }
+
+    int reuse = 1;
+    lwip_setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct timeval timeout = {0, RECEIVE_TIMEOUT_MS * 1000};
+    lwip_setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(LAN_STREAM_PORT);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (lwip_bind(sock, (struct sockaddr *)&local, sizeof(local)) < 0)
+    {
+        Serial.println("ERROR: Hoop array socket bind failed");
+        lwip_close(sock);
+        sock = -1;
+        return false;
+    }
+
+    queue = xQueueCreate(HOOP_ARRAY_QUEUE_DEPTH, sizeof(ArrayDetection));
+    if (queue == nullptr)
+    {
+        Serial.println("ERROR: Hoop array queue creation failed");
+        lwip_close(sock);
+        sock = -1;
+        return false;
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "HoopArray",
+        4096,
+        this,
+        1,
+        &task,
+        0);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: Hoop array task creation failed");
+        vQueueDelete(queue);
+        queue = nullptr;
+        lwip_close(sock);
+        sock = -1;
+        task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void HoopArray::setRole(ArrayRole next)
+{
+    ArrayRole previous = role.exchange(next, std::memory_order_relaxed);
+    TimeSync::setCoordinator(next == ArrayRole::COORDINATOR);
+    if (stream != nullptr)
+        stream->setLoopback(next == ArrayRole::COORDINATOR);
+    if (previous != next)
+        Serial.printf("Hoop array: %s\n", roleName(next));
+}
+
+bool HoopArray::pollDetection(ArrayDetection &detection)
+{
+    if (queue == nullptr)
+        return false;
+    return xQueueReceive(queue, &detection, 0) == pdTRUE;
+}
+
+void HoopArray::taskFunction(void *parameter)
+{
+    static_cast<HoopArray *>(parameter)->run();
+}
+
+void HoopArray::run()
+{
+    ArrayRole current = ArrayRole::OFF;
+    uint8_t packet[RECEIVE_BUFFER];
+
+    for (;;)
+    {
+        ArrayRole next = role.load(std::memory_order_relaxed);
+        if (next != current)
+        {
+            reset();
+            current = next;
+        }
+        if (current == ArrayRole::OFF)
+        {
+            vTaskDelay(pdMS_TO_TICKS(200));
+            continue;
+        }
+
+        // Group membership is per association; join again after a reconnect
+        if (!WiFi.isConnected())
+            joined = false;
+        else if (!joined)
+            joinGroup();
+
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        int length = lwip_recvfrom(sock, packet, sizeof(packet), 0, (struct sockaddr *)&from, &fromLength);
+        int64_t receivedUs = esp_timer_get_time();
+        if (length > 0)
+            receive(packet, length, from.sin_addr.s_addr, receivedUs);
+
+        if (current == ArrayRole::COORDINATOR)
+        {
+            uint32_t now = millis();
+            if (now - lastBeaconMs >= TIME_SYNC_BEACON_MS)
+            {
+                lastBeaconMs = now;
+                stream->sendBeacon();
+            }
+            releaseDue(TimeSync::nowSyncUs());
+        }
+    }
+}
+
+void HoopArray::joinGroup()
+{
+    joined = true;
+    struct ip_mreq membership;
+    membership.imr_multiaddr.s_addr = inet_addr(LAN_STREAM_GROUP);
+    if (!IN_MULTICAST(ntohl(membership.imr_multiaddr.s_addr)))
+        return; // Unicast: addressed to us directly
+
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    lwip_setsockopt(sock, IPPROTO_IP, IP_DROP_MEMBERSHIP, &membership, sizeof(membership));
+    if (lwip_setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0)
+    {
+        Serial.println("WARNING: Hoop array could not join the LAN stream group");
+        joined = false;
+    }
+}
+
+void HoopArray::receive(const uint8_t *packet, int length, uint32_t from, int64_t receivedUs)
+{
+    LanEventStream::PacketHeader header;
+    if (length < (int)sizeof(header))
+        return;
+    memcpy(&header, packet, sizeof(header));
+    if (header.magic[0] != 'M' || header.magic[1] != 'P' || header.version != LanEventStream::VERSION)
+        return;
+    const uint8_t *body = packet + sizeof(header);
+    int bodyLength = length - (int)sizeof(header);
+
+    if (header.type == LanEventStream::TYPE_BEACON)
+    {
+        // A coordinator hears its own beacons (loopback); only peers follow them
+        LanEventStream::BeaconRecord beacon;
+        if (role.load(std::memory_order_relaxed) != ArrayRole::PEER || bodyLength < (int)sizeof(beacon))
+            return;
+        memcpy(&beacon, body, sizeof(beacon));
+        TimeSync::onBeacon(beacon.syncUs, receivedUs);
+        return;
+    }
+
+    if (header.type != LanEventStream::TYPE_DETECTION || role.load(std::memory_order_relaxed) != ArrayRole::COORDINATOR)
+        return;
+
+    LanEventStream::DetectionRecord record;
+    if (bodyLength < (int)sizeof(record))
+        return;
+    memcpy(&record, body, sizeof(record));
+
+    int unit = findUnit(from, header.clock);
+    if (unit < 0)
+    {
+        dropped++;
+        return;
+    }
+    if (record.frameSyncUs == 0)
+    {
+        unsynced++;
+        return;
+    }
+    addDetection((uint8_t)unit, record.frameSyncUs, (Direction)record.direction, record.confidence);
+}
+
+int HoopArray::findUnit(uint32_t address, uint8_t clock)
+{
+    portENTER_CRITICAL(&unitLock);
+    int found = -1;
+    for (uint8_t i = 0; i < unitCount; i++)
+    {
+        if (units[i].address == address)
+        {
+            found = i;
+            break;
+        }
+    }
+    if (found < 0 && unitCount < HOOP_ARRAY_MAX_UNITS)
+    {
+        found = unitCount++;
+        units[found].address = address;
+        units[found].detections = 0;
+    }
+    if (found >= 0)
+    {
+        units[found].lastSeenMs = millis();
+        units[found].detections++;
+        units[found].clock = clock;
+    }
+    portEXIT_CRITICAL(&unitLock);
+    return found;
+}
+
+void HoopArray::addDetection(uint8_t unit, int64_t syncUs, Direction direction, float confidence)
+{
+    // Belongs to (or precedes) a transit that is out already
+    if (releasedUs != 0 && syncUs - releasedUs < HOOP_ARRAY_MERGE_US)
+    {
+        late++;
+        return;
+    }
+
+    // Closest transit this unit is not part of yet, without stretching it past the window
+    int best = -1;
+    int64_t bestDistance = 0;
+    for (uint8_t g = 0; g < pendingCount; g++)
+    {
+        Group &group = pending[g];
+        int64_t first = syncUs < group.firstUs ? syncUs : group.firstUs;
+        int64_t last = syncUs > group.lastUs ? syncUs : group.lastUs;
+        if (last - first > HOOP_ARRAY_MERGE_US)
+            continue;
+
+        bool member = false;
+        for (uint8_t m = 0; m < group.count; m++)
+            member |= group.members[m].unit == unit;
+        if (member)
+            continue;
+
+        int64_t distance = syncUs > group.firstUs ? syncUs - group.firstUs : group.firstUs - syncUs;
+        if (best < 0 || distance < bestDistance)
+        {
+            best = g;
+            bestDistance = distance;
+        }
+    }
+
+    if (best < 0)
+    {
+        if (pendingCount == HOOP_ARRAY_PENDING)
+        {
+            // Make room: the earliest transit goes out now
+            uint8_t earliest = 0;
+            for (uint8_t g = 1; g < pendingCount; g++)
+            {
+                if (pending[g].firstUs < pending[earliest].firstUs)
+                    earliest = g;
+            }
+            release(earliest);
+        }
+        best = pendingCount++;
+        pending[best].firstUs = syncUs;
+        pending[best].lastUs = syncUs;
+        pending[best].count = 0;
+    }
+
+    Group &group = pending[best];
+    if (syncUs < group.firstUs)
+        group.firstUs = syncUs;
+    if (syncUs > group.lastUs)
+        group.lastUs = syncUs;
+    group.members[group.count].unit = unit;
+    group.members[group.count].direction = direction;
+    group.members[group.count].confidence = confidence;
+    group.count++;
+}
+
+void HoopArray::releaseDue(int64_t nowUs)
+{
+    for (;;)
+    {
+        int earliest = -1;
+        for (uint8_t g = 0; g < pendingCount; g++)
+        {
+            if (earliest < 0 || pending[g].firstUs < pending[earliest].firstUs)
+                earliest = g;
+        }
+        if (earliest < 0 || nowUs - pending[earliest].firstUs < HOOP_ARRAY_HOLD_US)
+            return;
+        release((uint8_t)earliest);
+    }
+}
+
+void HoopArray::release(uint8_t index)
+{
+    const Group &group = pending[index];
+
+    // Confidence-weighted vote; unknown only when no unit saw a direction
+    float weight[3] = {0.0f, 0.0f, 0.0f};
+    for (uint8_t m = 0; m < group.count; m++)
+        weight[(uint8_t)group.members[m].direction % 3] += group.members[m].confidence;
+    Direction direction = Direction::UNKNOWN;
+    if (weight[(uint8_t)Direction::A_TO_B] > 0.0f || weight[(uint8_t)Direction::B_TO_A] > 0.0f)
+        direction = weight[(uint8_t)Direction::A_TO_B] >= weight[(uint8_t)Direction::B_TO_A] ? Direction::A_TO_B : Direction::B_TO_A;
+
+    ArrayDetection detection;
+    detection.syncUs = group.firstUs;
+    detection.spreadUs = (uint32_t)(group.lastUs - group.firstUs);
+    detection.direction = direction;
+    detection.units = group.count;
+    detection.agreeing = 0;
+    float confidence = 0.0f;
+    for (uint8_t m = 0; m < group.count; m++)
+    {
+        if (group.members[m].direction != direction)
+            continue;
+        detection.agreeing++;
+        confidence += group.members[m].confidence;
+    }
+    detection.confidence = detection.agreeing > 0 ? confidence / detection.agreeing : 0.0f;
+
+    releasedUs = group.firstUs;
+    pending[index] = pending[--pendingCount];
+    merged++;
+
+    stream->sendArrayDetection(detection.syncUs, detection.spreadUs, detection.confidence,
+                               detection.direction, detection.units, detection.agreeing);
+    if (xQueueSend(queue, &detection, 0) != pdTRUE)
+        dropped++;
+    released.store(true, std::memory_order_relaxed);
+}
+
+void HoopArray::reset()
+{
+    pendingCount = 0;
+    releasedUs = 0;
+    portENTER_CRITICAL(&unitLock);
+    unitCount = 0;
+    portEXIT_CRITICAL(&unitLock);
+    xQueueReset(queue);
+}
+
+void HoopArray::toJson(JsonDocument &doc)
+{
+    ArrayRole current = role.load(std::memory_order_relaxed);
+    doc["role"] = roleName(current);
+    TimeSync::toJson(doc.createNestedObject("clock"));
+    if (current != ArrayRole::COORDINATOR)
+        return;
+
+    doc["merged"] = merged;
+    doc["late"] = late;
+    doc["unsynced"] = unsynced;
+    doc["dropped"] = dropped;
+
+    Unit snapshot[HOOP_ARRAY_MAX_UNITS];
+    portENTER_CRITICAL(&unitLock);
+    uint8_t count = unitCount;
+    memcpy(snapshot, units, sizeof(Unit) * count);
+    portEXIT_CRITICAL(&unitLock);
+
+    uint32_t now = millis();
+    JsonArray list = doc.createNestedArray("units");
+    for (uint8_t i = 0; i < count; i++)
+    {
+        JsonObject entry = list.createNestedObject();
+        struct in_addr address;
+        address.s_addr = snapshot[i].address;
+        char text[16];
+        inet_ntoa_r(address, text, sizeof(text));
+        entry["ip"] = (char *)text; // Copied
+        entry["detections"] = snapshot[i].detections;
+        entry["clock"] = TimeSync::sourceName((ClockSource)snapshot[i].clock);
+        entry["age_ms"] = now - snapshot[i].lastSeenMs;
+    }
+}
+
+ArrayRole HoopArray::parseRole(const String &name)
+{
+    if (name == "peer")
+        return ArrayRole::PEER;
+    if (name == "coordinator")
+        return ArrayRole::COORDINATOR;
+    return ArrayRole::OFF;
+}
+
+const char *HoopArray::roleName(ArrayRole role)
+{
+    switch (role)
+    {
+    case ArrayRole::PEER:
+        return "peer";
+    case ArrayRole::COORDINATOR:
+        return "coordinator";
+    default:
+        return "off";
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef HOOP_ARRAY_H
+#define HOOP_ARRAY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "LanEventStream.h"
+#include "TimeSync.h"
+
+/**
+ * HoopArray - Several units on one hoop / goal, merged on the LAN
+ *
+ * Larger installations put more than one Motion Play unit on a hoop; each
+ * reports its own detections on its own clock. With array_role set, the
+ * units share a clock (TimeSync) and one of them merges the rest:
+ *
+ *   peer         sends its detections on the LAN stream as usual (each
+ *                now carries frame_sync_us) and follows the coordinator's
+ *                beacons for the clock
+ *   coordinator  sends a beacon every TIME_SYNC_BEACON_MS and merges every
+ *                unit's detections - its own included, received through
+ *                multicast loopback - into array detections
+ *
+ * Merging (coordinator): detections within HOOP_ARRAY_MERGE_US of each
+ * other on the shared clock, one per unit, are one transit. A group is
+ * released HOOP_ARRAY_HOLD_US after its earliest detection (time for the
+ * slowest peer's datagram to arrive), so releases are in order of transit
+ * time however the datagrams arrived. A detection that belongs to (or
+ * precedes) a released transit is counted late and dropped; one without
+ * shared time is counted unsynced. The direction is the units'
+ * confidence-weighted vote.
+ *
+ * - Array detections go out on the LAN stream (type 4) and, through
+ *   pollDetection(), in an array_detections status
+ * - Needs lan_stream on every unit; units are told apart by IPv4 address.
+ *   With a unicast LAN_STREAM_GROUP it must be the coordinator's address.
+ * - Own task (core 0, below the sensor task): blocks on the socket, so
+ *   beacon receive times are taken as soon as lwIP hands them over
+ */
+
+#ifndef HOOP_ARRAY_MAX_UNITS
+#define HOOP_ARRAY_MAX_UNITS 8
+#endif
+
+// Detections of one transit on different units lie within this of each other
+#ifndef HOOP_ARRAY_MERGE_US
+#define HOOP_ARRAY_MERGE_US 100000
+#endif
+
+// Wait this long after a transit for late datagrams (WiFi power save
+// delays multicast to the next DTIM beacon)
+#ifndef HOOP_ARRAY_HOLD_US
+#define HOOP_ARRAY_HOLD_US 400000
+#endif
+
+// Transits being merged at once
+#ifndef HOOP_ARRAY_PENDING
+#define HOOP_ARRAY_PENDING 8
+#endif
+
+// Array detections waiting to be published (all of them fit one status
+// message); further ones are dropped (and counted)
+#ifndef HOOP_ARRAY_QUEUE_DEPTH
+#define HOOP_ARRAY_QUEUE_DEPTH 6
+#endif
+
+#define HOOP_ARRAY_JSON_CAPACITY                                              \
+    (JSON_OBJECT_SIZE(8) + TIME_SYNC_JSON_CAPACITY +                          \
+     JSON_ARRAY_SIZE(HOOP_ARRAY_MAX_UNITS) +                                  \
+     HOOP_ARRAY_MAX_UNITS * (JSON_OBJECT_SIZE(4) + 16))
+
+enum class ArrayRole : uint8_t
+{
+    OFF,
+    PEER,
+    COORDINATOR
+};
+
+// One transit, merged across the array
+struct ArrayDetection
+{
+    int64_t syncUs;      // Earliest unit's frame time on the shared clock
+    uint32_t spreadUs;   // Earliest to latest unit
+    float confidence;    // Mean of the units that agree with the direction
+    Direction direction;
+    uint8_t units;       // Units that detected it
+    uint8_t agreeing;    // Units that reported direction
+};
+
+class HoopArray
+{
+public:
+    /**
+     * Open the receive socket and start the task (idle while OFF)
+     * @return false if the socket or a FreeRTOS object could not be created
+     */
+    bool begin(LanEventStream *stream);
+
+    void setRole(ArrayRole role);
+    ArrayRole getRole() const { return role.load(std::memory_order_relaxed); }
+
+    // Take the next array detection, if any (non-blocking)
+    bool pollDetection(ArrayDetection &detection);
+
+    // True once after each release: time to post the queued detections
+    bool takeNewDetections() { return released.exchange(false, std::memory_order_relaxed); }
+
+    // Role, clock, merge counters and the units heard from (coordinator)
+    void toJson(JsonDocument &doc);
+
+    static ArrayRole parseRole(const String &name);
+    static const char *roleName(ArrayRole role);
+
+private:
+    struct Unit
+    {
+        uint32_t address;
+        uint32_t lastSeenMs;
+        uint32_t detections;
+        uint8_t clock;
+    };
+
+    struct Member
+    {
+        uint8_t unit;
+        Direction direction;
+        float confidence;
+    };
+
+    struct Group
+    {
+        int64_t firstUs;
+        int64_t lastUs;
+        uint8_t count;
+        Member members[HOOP_ARRAY_MAX_UNITS];
+    };
+
+    LanEventStream *stream = nullptr;
+    int sock = -1;
+    TaskHandle_t task = nullptr;
+    QueueHandle_t queue = nullptr;
+    std::atomic<ArrayRole> role{ArrayRole::OFF};
+    std::atomic<bool> released{false};
+    bool joined = false;
+
+    portMUX_TYPE unitLock = portMUX_INITIALIZER_UNLOCKED;
+    Unit units[HOOP_ARRAY_MAX_UNITS];
+    uint8_t unitCount = 0;
+
+    // Merge state (task only)
+    Group pending[HOOP_ARRAY_PENDING];
+    uint8_t pendingCount = 0;
+    int64_t releasedUs = 0;
+    uint32_t lastBeaconMs = 0;
+
+    volatile uint32_t merged = 0;
+    volatile uint32_t late = 0;
+    volatile uint32_t unsynced = 0;
+    volatile uint32_t dropped = 0; // Queue full, or more units than HOOP_ARRAY_MAX_UNITS
+
+    static void taskFunction(void *parameter);
+    void run();
+    void joinGroup();
+    void receive(const uint8_t *packet, int length, uint32_t from, int64_t receivedUs);
+    int findUnit(uint32_t address, uint8_t clock);
+    void addDetection(uint8_t unit, int64_t syncUs, Direction direction, float confidence);
+    void releaseDue(int64_t nowUs);
+    void release(uint8_t index);
+    void reset();
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "LanEventStream.h"
+
+bool LanEventStream::begin()
+{
+    if (sock >= 0)
+        return true;
+
+    sock = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+    {
+        Serial.println("ERROR: LAN stream socket creation failed");
+        return false;
+    }
+
+    // Stay on the local network segment
+    uint8_t ttl = 1;
+    lwip_setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    memset(&destination, 0, sizeof(destination));
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(LAN_STREAM_PORT);
+    destination.sin_addr.s_addr = inet_addr(LAN_STREAM_GROUP);
+
+    Serial.printf("LAN stream ready: %s:%d (off until lan_stream is set)\n", LAN_STREAM_GROUP, LAN_STREAM_PORT);
+    return true;
+}
+
+void LanEventStream::setEnabled(bool detections, bool frames)
+{
+    detectionsEnabled.store(detections && sock >= 0, std::memory_order_relaxed);
+    framesEnabled.store(detections && frames && sock >= 0, std::memory_order_relaxed);
+}
+
+void LanEventStream::fillHeader(uint8_t *packet, uint8_t type)
+{
+    PacketHeader header;
+    header.magic[0] = 'M';
+    header.magic[1] = 'P';
+    header.version = VERSION;
+    header.type = type;
+    header.sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+    header.clock = (uint8_t)TimeSync::source();
+    header.reserved = 0;
+    header.sentUs = micros();
+    memcpy(packet, &header, sizeof(header));
+}
+
+void LanEventStream::send(const uint8_t *packet, size_t length)
+{
+    int sent = lwip_sendto(sock, packet, length, MSG_DONTWAIT,
+                           (const struct sockaddr *)&destination, sizeof(destination));
+    if (sent == (int)length)
+        packetsSent++;
+    else
+        sendErrors++;
+}
+
+void LanEventStream::sendDetection(const DetectionResult &result, bool ml, uint32_t frameTimestampUs)
+{
+    if (!detectionsEnabled.load(std::memory_order_relaxed))
+        return;
+
+    DetectionRecord record;
+    record.frameTimestampUs = frameTimestampUs;
+    record.direction = (uint8_t)result.direction;
+    record.detector = ml ? 1 : 0;
+    record.detectedModule = result.detectedModule;
+    record.modulesDetected = result.modulesDetected;
+    record.confidence = result.confidence;
+    record.comGapMs = result.comGapMs;
+    record.maxSignalA = result.maxSignalA;
+    record.maxSignalB = result.maxSignalB;
+    record.frameSyncUs = TimeSync::microsToSyncUs(frameTimestampUs);
+
+    uint8_t packet[sizeof(PacketHeader) + sizeof(DetectionRecord)];
+    memcpy(packet + sizeof(PacketHeader), &record, sizeof(record));
+    fillHeader(packet, TYPE_DETECTION);
+    send(packet, sizeof(packet));
+}
+
+void LanEventStream::sendBeacon()
+{
+    if (!detectionsEnabled.load(std::memory_order_relaxed))
+        return;
+
+    uint8_t packet[sizeof(PacketHeader) + sizeof(BeaconRecord)];
+    fillHeader(packet, TYPE_BEACON);
+    // Last thing before sending: peers measure the delay from here
+    BeaconRecord record;
+    record.syncUs = TimeSync::nowSyncUs();
+    memcpy(packet + sizeof(PacketHeader), &record, sizeof(record));
+    send(packet, sizeof(packet));
+}
+
+void LanEventStream::sendArrayDetection(int64_t syncUs, uint32_t spreadUs, float confidence,
+                                        Direction direction, uint8_t units, uint8_t agreeing)
+{
+    if (!detectionsEnabled.load(std::memory_order_relaxed))
+        return;
+
+    ArrayDetectionRecord record;
+    record.syncUs = syncUs;
+    record.spreadUs = spreadUs;
+    record.confidence = confidence;
+    record.direction = (uint8_t)direction;
+    record.units = units;
+    record.agreeing = agreeing;
+    record.reserved = 0;
+
+    uint8_t packet[sizeof(PacketHeader) + sizeof(ArrayDetectionRecord)];
+    memcpy(packet + sizeof(PacketHeader), &record, sizeof(record));
+    fillHeader(packet, TYPE_ARRAY_DETECTION);
+    send(packet, sizeof(packet));
+}
+
+void LanEventStream::setLoopback(bool enabled)
+{
+    if (sock < 0)
+        return;
+    uint8_t loop = enabled ? 1 : 0;
+    lwip_setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+}
+
+void LanEventStream::addFrame(const SensorFrame &frame)
+{
+    if (!framesEnabled.load(std::memory_order_relaxed))
+    {
+        frameCount = 0;
+        return;
+    }
+
+    if (frameCount > 0 && frame.timestamp_us - batchStartUs >= LAN_STREAM_FRAME_WINDOW_US)
+        flushFrames();
+    if (frameCount == 0)
+        batchStartUs = frame.timestamp_us;
+
+    FrameRecord record;
+    record.timestampUs = frame.timestamp_us;
+    record.validMask = frame.valid_mask;
+    memcpy(record.proximity, frame.proximity, sizeof(record.proximity));
+    memcpy(framePacket + sizeof(PacketHeader) + 1 + frameCount * sizeof(FrameRecord), &record, sizeof(record));
+    frameCount++;
+
+    if (frameCount == LAN_STREAM_FRAMES_PER_PACKET)
+        flushFrames();
+}
+
+void LanEventStream::flushFrames()
+{
+    fillHeader(framePacket, TYPE_FRAMES);
+    framePacket[sizeof(PacketHeader)] = frameCount;
+    send(framePacket, sizeof(PacketHeader) + 1 + frameCount * sizeof(FrameRecord));
+    frameCount = 0;
+}
@@ -0,0 +1,174 @@
+#ifndef LAN_EVENT_STREAM_H
+#define LAN_EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <lwip/sockets.h>
+#include "../detection/DirectionDetector.h"
+#include "../sensor/SensorFrame.h"
+#include "TimeSync.h"
+
+/**
+ * LanEventStream - Detections (and optionally live frames) as UDP datagrams
+ *
+ * The cloud path (MQTT -> AWS IoT -> consumer) takes hundreds of ms; a
+ * scoreboard next to the hoop needs the result within a frame. With
+ * lan_stream on, DetectionTask sends each detection the moment the
+ * detector reports it, before loop() even sees it, to LAN_STREAM_GROUP
+ * (a multicast group by default; a unicast host address works too).
+ * One datagram per detection: the send sits behind the task's
+ * DetectionLatch, like the result queue, so a detection left pending until
+ * loop() resets the detector (cooldown, Live Debug capture) is not re-sent
+ * with every frame.
+ *
+ * Datagrams: little-endian, packed
+ *   header (12 B): 'M' 'P', u8 version (2), u8 type, u16 sequence,
+ *                  u8 clock (TimeSync source: 0 none, 1 sntp, 2 beacon,
+ *                  3 local), u8 reserved, u32 sent_us (micros(), same
+ *                  clock as frame timestamps)
+ *   type 1, detection (28 B): u32 frame_ts_us, u8 direction (0 unknown,
+ *                  1 A->B, 2 B->A), u8 detector (0 heuristic, 1 ml),
+ *                  u8 detected_module, u8 modules_detected, f32 confidence,
+ *                  u32 com_gap_ms, u16 max_signal_a, u16 max_signal_b,
+ *                  i64 frame_sync_us (frame_ts_us on the shared clock,
+ *                  0 while not synced)
+ *   type 2, frames: u8 count, then count x (u32 ts_us, u8 valid_mask,
+ *                  u16 proximity[6]) - only with lan_stream_frames; builds
+ *                  with SENSOR_MAX_BOARDS > 3 send NUM_SENSORS values (and
+ *                  a u16 mask above 4 boards)
+ *   type 3, beacon (8 B): i64 sync_us - hoop array coordinator's shared
+ *                  time, taken just before sending (HoopArray, TimeSync)
+ *   type 4, array detection (20 B): i64 sync_us (earliest unit), u32
+ *                  spread_us (earliest to latest unit), f32 confidence,
+ *                  u8 direction, u8 units, u8 agreeing, u8 reserved -
+ *                  one transit merged across the array by the coordinator
+ *
+ * Version 1 had a u16 reserved field for clock + reserved and no
+ * frame_sync_us; types 3 and 4 are new in version 2.
+ *
+ * - Raw lwIP socket with non-blocking sendto(): safe from any task, never
+ *   waits; a datagram that cannot be sent is counted and dropped
+ * - Frames are batched (LAN_STREAM_FRAMES_PER_PACKET, or
+ *   LAN_STREAM_FRAME_WINDOW_US of frames) since WiFi sends multicast at
+ *   the basic rate; addFrame() is for the detection task only
+ * - Only runs while detection does (Play / Live Debug); beacons and
+ *   array detections go out whenever the stream is enabled
+ */
+
+#ifndef LAN_STREAM_GROUP
+#define LAN_STREAM_GROUP "239.77.80.1"
+#endif
+
+#ifndef LAN_STREAM_PORT
+#define LAN_STREAM_PORT 5077
+#endif
+
+#ifndef LAN_STREAM_FRAMES_PER_PACKET
+#define LAN_STREAM_FRAMES_PER_PACKET 10
+#endif
+
+#ifndef LAN_STREAM_FRAME_WINDOW_US
+#define LAN_STREAM_FRAME_WINDOW_US 10000
+#endif
+
+class LanEventStream
+{
+public:
+    /**
+     * Create the socket (sending starts once WiFi has an address)
+     * @return false if the socket could not be created
+     */
+    bool begin();
+
+    void setEnabled(bool detections, bool frames);
+    bool isEnabled() const { return detectionsEnabled.load(std::memory_order_relaxed); }
+
+    void sendDetection(const DetectionResult &result, bool ml, uint32_t frameTimestampUs);
+    void addFrame(const SensorFrame &frame);
+
+    // Hoop array (HoopArray task)
+    void sendBeacon();
+    void sendArrayDetection(int64_t syncUs, uint32_t spreadUs, float confidence,
+                            Direction direction, uint8_t units, uint8_t agreeing);
+
+    // Receive this device's own multicast datagrams (array coordinator)
+    void setLoopback(bool enabled);
+
+    uint32_t getPacketsSent() const { return packetsSent; }
+    uint32_t getSendErrors() const { return sendErrors; }
+
+    struct __attribute__((packed)) PacketHeader
+    {
+        uint8_t magic[2];
+        uint8_t version;
+        uint8_t type;
+        uint16_t sequence;
+        uint8_t clock;
+        uint8_t reserved;
+        uint32_t sentUs;
+    };
+
+    struct __attribute__((packed)) DetectionRecord
+    {
+        uint32_t frameTimestampUs;
+        uint8_t direction;
+        uint8_t detector;
+        uint8_t detectedModule;
+        uint8_t modulesDetected;
+        float confidence;
+        uint32_t comGapMs;
+        uint16_t maxSignalA;
+        uint16_t maxSignalB;
+        int64_t frameSyncUs;
+    };
+
+    struct __attribute__((packed)) BeaconRecord
+    {
+        int64_t syncUs;
+    };
+
+    struct __attribute__((packed)) ArrayDetectionRecord
+    {
+        int64_t syncUs;
+        uint32_t spreadUs;
+        float confidence;
+        uint8_t direction;
+        uint8_t units;
+        uint8_t agreeing;
+        uint8_t reserved;
+    };
+
+    static const uint8_t VERSION = 2;
+    static const uint8_t TYPE_DETECTION = 1;
+    static const uint8_t TYPE_FRAMES = 2;
+    static const uint8_t TYPE_BEACON = 3;
+    static const uint8_t TYPE_ARRAY_DETECTION = 4;
+
+private:
+    struct __attribute__((packed)) FrameRecord
+    {
+        uint32_t timestampUs;
+        SensorMask validMask;
+        uint16_t proximity[NUM_SENSORS];
+    };
+
+    int sock = -1;
+    struct sockaddr_in destination;
+
+    std::atomic<bool> detectionsEnabled{false};
+    std::atomic<bool> framesEnabled{false};
+    std::atomic<uint16_t> sequence{0};
+    volatile uint32_t packetsSent = 0;
+    volatile uint32_t sendErrors = 0;
+
+    // Frame batch (detection task only)
+    uint8_t framePacket[sizeof(PacketHeader) + 1 + LAN_STREAM_FRAMES_PER_PACKET * sizeof(FrameRecord)];
+    uint8_t frameCount = 0;
+    uint32_t batchStartUs = 0;
+
+    void fillHeader(uint8_t *packet, uint8_t type);
+    void send(const uint8_t *packet, size_t length);
+    void flushFrames();
+};
+
+#endif
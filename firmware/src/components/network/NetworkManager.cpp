@@ -94,11 +94,24 @@ bool NetworkManager::connectWiFi() {
     return false;
 }
 
+void NetworkManager::beginWiFi() {
+    Serial.print("Reconnecting to WiFi: ");
+    Serial.println(ssid);
+
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+    WiFi.begin(ssid.c_str(), password.c_str());
+}
+
 void NetworkManager::disconnect() {
     WiFi.disconnect(true);
     connected = false;
 }
 
+void NetworkManager::setPowerSave(wifi_ps_type_t mode) {
+    WiFi.setSleep(mode);
+}
+
 bool NetworkManager::isConnected() {
     return WiFi.status() == WL_CONNECTED;
 }
@@ -19,7 +19,11 @@ public:
     NetworkManager();
     bool loadConfig();
     bool connectWiFi();
+    // Start an association without waiting (ConnectionSupervisor polls it)
+    void beginWiFi();
     void disconnect();
+    // Modem sleep: WIFI_PS_NONE (lowest latency), _MIN_MODEM (default) or _MAX_MODEM
+    void setPowerSave(wifi_ps_type_t mode);
     bool isConnected();
     WiFiClientSecure& getClient();
     void checkConnection();
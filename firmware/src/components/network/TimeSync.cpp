@@ -0,0 +1,260 @@
+#include "TimeSync.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <sys/time.h>
+
+// Earlier wall clock readings are the boot default, not SNTP time
+static const time_t SNTP_VALID_AFTER = 1600000000;
+
+// Re-read the SNTP adjusted wall clock this often
+static const unsigned long SNTP_POLL_MS = 1000;
+
+// Drift is measured over at least / re-anchored after this much local time
+static const int64_t DRIFT_MIN_SPAN_US = 10000000;
+static const int64_t DRIFT_MAX_SPAN_US = 60000000;
+
+// A window estimate this far off the model is a clock step (coordinator
+// rebooted or got SNTP), not drift
+static const int64_t STEP_US = 5000;
+
+// A window estimate below the model moves it by 1/ENVELOPE_DECAY
+static const int64_t ENVELOPE_DECAY = 8;
+
+// shared = local + offset + (local - anchor) * drift
+struct ClockModel
+{
+    int64_t offsetUs;
+    int64_t anchorUs;
+    float driftPpm;
+    bool valid;
+};
+
+static portMUX_TYPE clockLock = portMUX_INITIALIZER_UNLOCKED;
+static ClockModel sntpClock;
+static ClockModel beaconClock;
+static int64_t lastBeaconUs = 0;
+static bool coordinatorRole = false;
+
+static unsigned long lastPollMs = 0;
+
+// Beacon window and drift reference (HoopArray task only)
+static uint8_t windowCount = 0;
+static int64_t windowBest = 0;
+static int64_t windowBestAt = 0;
+static int64_t windowWorst = 0;
+static bool referenceValid = false;
+static int64_t referenceOffset = 0;
+static int64_t referenceAt = 0;
+
+static volatile uint32_t beaconCount = 0;
+static volatile uint32_t windowJitterUs = 0;
+static volatile uint32_t stepCount = 0;
+
+static int64_t apply(const ClockModel &clock, int64_t localUs)
+{
+    return localUs + clock.offsetUs + (int64_t)((float)(localUs - clock.anchorUs) * clock.driftPpm * 1e-6f);
+}
+
+// Caller holds clockLock
+static ClockSource currentSource(int64_t nowUs)
+{
+    if (!coordinatorRole && beaconClock.valid &&
+        (nowUs - lastBeaconUs < (int64_t)TIME_SYNC_BEACON_TIMEOUT_MS * 1000 || !sntpClock.valid))
+        return ClockSource::BEACON;
+    if (sntpClock.valid)
+        return ClockSource::SNTP;
+    if (coordinatorRole)
+        return ClockSource::LOCAL;
+    return ClockSource::NONE;
+}
+
+void TimeSync::begin()
+{
+    configTime(0, 0, TIME_SYNC_NTP_SERVER);
+    Serial.printf("TimeSync: SNTP from %s\n", TIME_SYNC_NTP_SERVER);
+}
+
+void TimeSync::poll()
+{
+    unsigned long now = millis();
+    if (now - lastPollMs < SNTP_POLL_MS)
+        return;
+    lastPollMs = now;
+
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    int64_t localUs = esp_timer_get_time();
+    if (tv.tv_sec < SNTP_VALID_AFTER)
+        return;
+
+    bool first = !sntpClock.valid;
+    int64_t wallUs = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    portENTER_CRITICAL(&clockLock);
+    sntpClock.offsetUs = wallUs - localUs;
+    sntpClock.anchorUs = localUs;
+    sntpClock.driftPpm = 0.0f; // SNTP slews the wall clock itself; re-read every poll
+    sntpClock.valid = true;
+    portEXIT_CRITICAL(&clockLock);
+
+    if (first)
+        Serial.printf("TimeSync: SNTP time acquired (%ld)\n", (long)tv.tv_sec);
+}
+
+void TimeSync::setCoordinator(bool coordinator)
+{
+    portENTER_CRITICAL(&clockLock);
+    coordinatorRole = coordinator;
+    portEXIT_CRITICAL(&clockLock);
+}
+
+void TimeSync::onBeacon(int64_t coordinatorUs, int64_t receivedUs)
+{
+    // coordinator - local = offset - delay: the largest estimate is the least delayed
+    int64_t estimate = coordinatorUs - receivedUs;
+    if (windowCount == 0 || estimate > windowBest)
+    {
+        windowBest = estimate;
+        windowBestAt = receivedUs;
+    }
+    if (windowCount == 0 || estimate < windowWorst)
+        windowWorst = estimate;
+    windowCount++;
+    beaconCount++;
+
+    portENTER_CRITICAL(&clockLock);
+    lastBeaconUs = receivedUs;
+    ClockModel current = beaconClock;
+    portEXIT_CRITICAL(&clockLock);
+
+    if (windowCount < TIME_SYNC_WINDOW)
+        return;
+    windowCount = 0;
+    windowJitterUs = (uint32_t)(windowBest - windowWorst);
+
+    // Each estimate is a lower bound on the offset: follow a higher one at
+    // once, a lower one (more delay than usual) only slowly
+    int64_t predicted = current.valid ? apply(current, windowBestAt) - windowBestAt : windowBest;
+    int64_t error = windowBest - predicted;
+
+    ClockModel next;
+    next.anchorUs = windowBestAt;
+    next.driftPpm = current.valid ? current.driftPpm : 0.0f;
+    next.valid = true;
+
+    if (current.valid && (error > STEP_US || error < -STEP_US))
+    {
+        // Start over: the old offset and drift describe another clock
+        next.offsetUs = windowBest;
+        next.driftPpm = 0.0f;
+        referenceValid = false;
+        stepCount++;
+    }
+    else
+    {
+        next.offsetUs = predicted + (error > 0 ? error : error / ENVELOPE_DECAY);
+    }
+
+    // Drift: slope of the tracked offset over DRIFT_MIN_SPAN_US or more
+    if (!referenceValid)
+    {
+        referenceOffset = next.offsetUs;
+        referenceAt = windowBestAt;
+        referenceValid = true;
+    }
+    else if (windowBestAt - referenceAt >= DRIFT_MIN_SPAN_US)
+    {
+        float measured = (float)(next.offsetUs - referenceOffset) * 1e6f / (float)(windowBestAt - referenceAt);
+        if (measured <= TIME_SYNC_MAX_DRIFT_PPM && measured >= -TIME_SYNC_MAX_DRIFT_PPM)
+            next.driftPpm += (measured - next.driftPpm) * 0.25f;
+        if (windowBestAt - referenceAt >= DRIFT_MAX_SPAN_US)
+        {
+            referenceOffset = next.offsetUs;
+            referenceAt = windowBestAt;
+        }
+    }
+
+    portENTER_CRITICAL(&clockLock);
+    beaconClock = next;
+    portEXIT_CRITICAL(&clockLock);
+}
+
+ClockSource TimeSync::source()
+{
+    int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&clockLock);
+    ClockSource source = currentSource(nowUs);
+    portEXIT_CRITICAL(&clockLock);
+    return source;
+}
+
+int64_t TimeSync::toSyncUs(int64_t localUs)
+{
+    int64_t nowUs = esp_timer_get_time();
+    int64_t syncUs = 0;
+    portENTER_CRITICAL(&clockLock);
+    switch (currentSource(nowUs))
+    {
+    case ClockSource::BEACON:
+        syncUs = apply(beaconClock, localUs);
+        break;
+    case ClockSource::SNTP:
+        syncUs = apply(sntpClock, localUs);
+        break;
+    case ClockSource::LOCAL:
+        syncUs = localUs;
+        break;
+    case ClockSource::NONE:
+        break;
+    }
+    portEXIT_CRITICAL(&clockLock);
+    return syncUs;
+}
+
+int64_t TimeSync::microsToSyncUs(uint32_t stampUs)
+{
+    // micros() is the low 32 bits of esp_timer; extend the stamp backwards from now
+    int64_t nowUs = esp_timer_get_time();
+    return toSyncUs(nowUs - (int64_t)(uint32_t)((uint32_t)nowUs - stampUs));
+}
+
+int64_t TimeSync::nowSyncUs()
+{
+    return toSyncUs(esp_timer_get_time());
+}
+
+void TimeSync::toJson(JsonObject obj)
+{
+    int64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&clockLock);
+    ClockSource source = currentSource(nowUs);
+    ClockModel clock = source == ClockSource::BEACON ? beaconClock : sntpClock;
+    portEXIT_CRITICAL(&clockLock);
+
+    obj["source"] = sourceName(source);
+    if (source == ClockSource::SNTP || source == ClockSource::BEACON)
+        obj["offset_us"] = apply(clock, nowUs) - nowUs;
+    if (source == ClockSource::BEACON)
+        obj["drift_ppm"] = clock.driftPpm;
+    if (beaconCount > 0)
+    {
+        obj["beacons"] = beaconCount;
+        obj["beacon_jitter_us"] = windowJitterUs;
+        obj["clock_steps"] = stepCount;
+    }
+}
+
+const char *TimeSync::sourceName(ClockSource source)
+{
+    switch (source)
+    {
+    case ClockSource::SNTP:
+        return "sntp";
+    case ClockSource::BEACON:
+        return "beacon";
+    case ClockSource::LOCAL:
+        return "local";
+    default:
+        return "none";
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * TimeSync - A clock shared by every Motion Play unit on the network
+ *
+ * Frames and detections are stamped with micros(), which starts at boot on
+ * each device, so two units on one hoop cannot be lined up. TimeSync keeps
+ * an offset from the local clock (esp_timer, the 64-bit clock behind
+ * micros()) to a shared one, in us since the Unix epoch:
+ *
+ *   SNTP    wall clock from TIME_SYNC_NTP_SERVER; good to a few ms, the
+ *           same for every unit that reaches the server
+ *   beacon  peers of a hoop array (HoopArray) refine it against the
+ *           coordinator's beacons on the LAN: each beacon carries the
+ *           coordinator's shared time when sent, so coordinator time -
+ *           local receive time = offset - one-way delay. The largest
+ *           estimate of each TIME_SYNC_WINDOW beacons (least delayed) is
+ *           taken; the offset follows a higher one at once and a lower one
+ *           slowly, and drift is extrapolated between windows. What is
+ *           left is the minimum one-way delay (a few hundred us), about
+ *           the same for every peer on one access point
+ *   local   a coordinator without SNTP serves its own uptime: peers still
+ *           share one clock, it just is not wall time
+ *
+ * - Beacon sync falls back to SNTP if beacons stop for
+ *   TIME_SYNC_BEACON_TIMEOUT_MS
+ * - The shared time of a micros() stamp is only computed when needed
+ *   (detections, uploads); nothing is restamped
+ * - poll() from loop() picks up SNTP; onBeacon() from the HoopArray task.
+ *   Conversions are safe from any task.
+ */
+
+#ifndef TIME_SYNC_NTP_SERVER
+#define TIME_SYNC_NTP_SERVER "pool.ntp.org"
+#endif
+
+// Coordinator beacon interval (HoopArray)
+#ifndef TIME_SYNC_BEACON_MS
+#define TIME_SYNC_BEACON_MS 250
+#endif
+
+// Beacons per offset estimate (least delayed one wins)
+#ifndef TIME_SYNC_WINDOW
+#define TIME_SYNC_WINDOW 8
+#endif
+
+#ifndef TIME_SYNC_BEACON_TIMEOUT_MS
+#define TIME_SYNC_BEACON_TIMEOUT_MS 10000
+#endif
+
+// Drift estimates beyond this are treated as a clock step, not drift
+#ifndef TIME_SYNC_MAX_DRIFT_PPM
+#define TIME_SYNC_MAX_DRIFT_PPM 200.0f
+#endif
+
+enum class ClockSource : uint8_t
+{
+    NONE = 0,   // No shared time yet
+    SNTP = 1,
+    BEACON = 2, // Coordinator beacons (peer)
+    LOCAL = 3   // Coordinator uptime (coordinator without SNTP)
+};
+
+#define TIME_SYNC_JSON_CAPACITY JSON_OBJECT_SIZE(6)
+
+class TimeSync
+{
+public:
+    // Start SNTP (runs in the background once WiFi is up)
+    static void begin();
+
+    // Pick up the SNTP time; cheap, call from loop()
+    static void poll();
+
+    // Coordinators serve LOCAL time until SNTP arrives
+    static void setCoordinator(bool coordinator);
+
+    /**
+     * One coordinator beacon (peers only)
+     * @param coordinatorUs Coordinator's shared time when sent
+     * @param receivedUs esp_timer_get_time() when it arrived
+     */
+    static void onBeacon(int64_t coordinatorUs, int64_t receivedUs);
+
+    static ClockSource source();
+    static bool isSynced() { return source() != ClockSource::NONE; }
+
+    /**
+     * Shared time of a local esp_timer_get_time() value
+     * @return us since the epoch (uptime for LOCAL), 0 if not synced
+     */
+    static int64_t toSyncUs(int64_t localUs);
+
+    // Shared time of a micros() stamp from the last ~71 minutes (frame timestamps)
+    static int64_t microsToSyncUs(uint32_t stampUs);
+
+    static int64_t nowSyncUs();
+
+    // Source, offset, drift and beacon statistics; at most TIME_SYNC_JSON_CAPACITY
+    static void toJson(JsonObject obj);
+
+    static const char *sourceName(ClockSource source);
+};
+
+#endif // TIME_SYNC_H
@@ -0,0 +1,720 @@
+#include "OtaUpdater.h"
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <mbedtls/sha256.h>
+#include "../detection/MLDetector.h"
+#include "../diagnostics/HeapTracker.h"
+
+#define OTA_NAMESPACE "ota"
+
+// NVS keys (probation state survives the restarts it counts)
+static const char *KEY_PENDING = "pending";   // bool: new firmware not yet confirmed
+static const char *KEY_TARGET = "target";     // label of the partition it was written to
+static const char *KEY_PREVIOUS = "previous"; // label of the partition to go back to
+static const char *KEY_BOOTS = "boots";       // boots on probation so far
+static const char *KEY_VERSION = "version";   // version string from the command
+static const char *KEY_ROLLED_BACK = "rolled_back";
+
+static const uint32_t PSRAM_CAPS = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+// ============================================================================
+// Destinations for the downloaded bytes
+// ============================================================================
+
+class OtaSink
+{
+public:
+    virtual ~OtaSink() {}
+    virtual bool begin(size_t total) = 0;
+    virtual bool write(const uint8_t *data, size_t length) = 0;
+    virtual bool finish() = 0; // All bytes in and the hash matched
+    virtual void abort() = 0;
+    const char *error = nullptr;
+};
+
+// Inactive app partition, through esp_ota (erases as it goes)
+class FirmwareSink : public OtaSink
+{
+public:
+    const esp_partition_t *partition = nullptr;
+
+    bool begin(size_t total) override
+    {
+        partition = esp_ota_get_next_update_partition(nullptr);
+        if (partition == nullptr)
+        {
+            error = "no ota partition";
+            return false;
+        }
+        if (total > partition->size)
+        {
+            error = "image too large";
+            return false;
+        }
+        if (esp_ota_begin(partition, total, &handle) != ESP_OK)
+        {
+            error = "ota begin failed";
+            return false;
+        }
+        open = true;
+        return true;
+    }
+
+    bool write(const uint8_t *data, size_t length) override
+    {
+        if (esp_ota_write(handle, data, length) == ESP_OK)
+            return true;
+        error = "flash write failed";
+        return false;
+    }
+
+    bool finish() override
+    {
+        open = false;
+        // Checks the app image (header, segments, checksum) before use
+        if (esp_ota_end(handle) == ESP_OK)
+            return true;
+        error = "image invalid";
+        return false;
+    }
+
+    void abort() override
+    {
+        if (open)
+            esp_ota_abort(handle);
+        open = false;
+    }
+
+private:
+    esp_ota_handle_t handle = 0;
+    bool open = false;
+};
+
+// Whole model image in PSRAM; the partition is only touched once it checks out
+class ModelSink : public OtaSink
+{
+public:
+    uint8_t *image = nullptr;
+    size_t size = 0;
+
+    ~ModelSink() override { abort(); }
+
+    bool begin(size_t total) override
+    {
+        const esp_partition_t *part = esp_partition_find_first(
+            ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ML_MODEL_PARTITION);
+        if (part == nullptr)
+        {
+            error = "no model partition";
+            return false;
+        }
+        if (total <= sizeof(MLModelImageHeader) || total > part->size)
+        {
+            error = "image size invalid";
+            return false;
+        }
+        image = (uint8_t *)HeapTracker::alloc(HeapTag::ML, total, PSRAM_CAPS);
+        if (image == nullptr)
+        {
+            error = "out of memory";
+            return false;
+        }
+        capacity = total;
+        return true;
+    }
+
+    bool write(const uint8_t *data, size_t length) override
+    {
+        if (size + length > capacity)
+        {
+            error = "image too large";
+            return false;
+        }
+        memcpy(image + size, data, length);
+        size += length;
+        return true;
+    }
+
+    bool finish() override
+    {
+        const MLModelImageHeader *hdr = (const MLModelImageHeader *)image;
+        if (memcmp(hdr->magic, "MPML", 4) != 0 || hdr->length != size - sizeof(MLModelImageHeader))
+        {
+            error = "not a model image";
+            return false;
+        }
+        if (esp_rom_crc32_le(0, image + sizeof(MLModelImageHeader), hdr->length) != hdr->crc32)
+        {
+            error = "model crc mismatch";
+            return false;
+        }
+        return true;
+    }
+
+    void abort() override
+    {
+        HeapTracker::release(HeapTag::ML, image, capacity);
+        image = nullptr;
+        size = 0;
+        capacity = 0;
+    }
+
+    // Hand the buffer over (the sink no longer frees it)
+    void detach()
+    {
+        image = nullptr;
+        size = 0;
+        capacity = 0;
+    }
+
+private:
+    size_t capacity = 0;
+};
+
+// ============================================================================
+// Setup and probation
+// ============================================================================
+
+bool OtaUpdater::begin(MQTTManager *mqtt)
+{
+    if (task != nullptr)
+        return true;
+
+    mqttManager = mqtt;
+    checkProbation();
+
+    jobQueue = xQueueCreate(1, sizeof(OtaJob));
+    if (jobQueue == nullptr)
+    {
+        Serial.println("ERROR: OtaUpdater queue creation failed");
+        return false;
+    }
+
+    // Core 1 at loop() priority like the upload task: the download blocks
+    // on the socket and yields, so detection keeps its share of the core
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskFunction,
+        "OtaTask",
+        8192, // TLS + HTTP client
+        this,
+        1,
+        &task,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: OtaUpdater task creation failed");
+        task = nullptr;
+        return false;
+    }
+
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    Serial.printf("OtaUpdater ready: running '%s' (%s)%s\n", running ? running->label : "?",
+                  esp_ota_get_app_description()->version, onProbation ? ", on probation" : "");
+    return true;
+}
+
+void OtaUpdater::setModelSwap(OtaModelSwapFn swap, void *context)
+{
+    modelSwap = swap;
+    modelSwapContext = context;
+}
+
+void OtaUpdater::checkProbation()
+{
+    prefsOpen = prefs.begin(OTA_NAMESPACE, false);
+    if (!prefsOpen)
+    {
+        Serial.println("WARNING: OTA NVS unavailable - no automatic rollback");
+        return;
+    }
+
+    strlcpy(rolledBackVersion, prefs.getString(KEY_ROLLED_BACK, "").c_str(), sizeof(rolledBackVersion));
+    if (!prefs.getBool(KEY_PENDING, false))
+        return;
+
+    // Booted something other than the new image (USB flash, bootloader
+    // fallback): nothing to supervise
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (running == nullptr || prefs.getString(KEY_TARGET, "") != running->label)
+    {
+        prefs.remove(KEY_PENDING);
+        return;
+    }
+
+    uint8_t boots = prefs.getUChar(KEY_BOOTS, 0) + 1;
+    prefs.putUChar(KEY_BOOTS, boots);
+    Serial.printf("[OTA] New firmware on probation, boot %d of %d\n", boots, OTA_ROLLBACK_BOOTS);
+    onProbation = true;
+    if (boots > OTA_ROLLBACK_BOOTS)
+        rollback("boot loop");
+}
+
+void OtaUpdater::rollback(const char *reason)
+{
+    String previous = prefs.getString(KEY_PREVIOUS, "");
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, previous.c_str());
+
+    prefs.remove(KEY_PENDING);
+    onProbation = false;
+    if (part == nullptr || esp_ota_set_boot_partition(part) != ESP_OK)
+    {
+        Serial.printf("[OTA] ERROR: Cannot roll back (%s) - staying on this firmware\n", reason);
+        return;
+    }
+
+    prefs.putString(KEY_ROLLED_BACK, prefs.getString(KEY_VERSION, "unknown"));
+    Serial.printf("[OTA] Rolling back to '%s' (%s), restarting\n", part->label, reason);
+    delay(100);
+    ESP.restart();
+}
+
+void OtaUpdater::confirmBoot()
+{
+    confirmPending = true;
+}
+
+void OtaUpdater::confirm()
+{
+    if (onProbation)
+    {
+        onProbation = false;
+        prefs.remove(KEY_PENDING);
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+        esp_ota_mark_app_valid_cancel_rollback();
+#endif
+        Serial.println("[OTA] New firmware confirmed");
+
+        DynamicJsonDocument details(384);
+        toJson(details);
+        mqttManager->publishStatus("ota_confirmed", details);
+    }
+
+    if (rolledBackVersion[0] != '\0')
+    {
+        DynamicJsonDocument details(384);
+        details["version"] = rolledBackVersion;
+        toJson(details);
+        mqttManager->publishStatus("ota_rolled_back", details);
+        prefs.remove(KEY_ROLLED_BACK);
+        rolledBackVersion[0] = '\0';
+    }
+}
+
+bool OtaUpdater::rollbackFirmware(const char *&error)
+{
+    const esp_partition_t *other = esp_ota_get_next_update_partition(nullptr);
+    esp_app_desc_t desc;
+    if (other == nullptr || esp_ota_get_partition_description(other, &desc) != ESP_OK)
+    {
+        error = "no previous firmware";
+        return false;
+    }
+    if (busy)
+    {
+        error = "update in progress";
+        return false;
+    }
+    if (esp_ota_set_boot_partition(other) != ESP_OK)
+    {
+        error = "previous firmware invalid";
+        return false;
+    }
+    if (prefsOpen)
+        prefs.remove(KEY_PENDING);
+    Serial.printf("[OTA] Rolling back to '%s' (%s), restarting\n", other->label, desc.version);
+    delay(500);
+    ESP.restart();
+    return true;
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+const char *OtaUpdater::parseJob(const JsonDocument &doc, OtaJob &job)
+{
+    const char *target = doc["target"] | "firmware";
+    if (strcmp(target, "firmware") == 0)
+        job.target = OtaTarget::FIRMWARE;
+    else if (strcmp(target, "model") == 0)
+        job.target = OtaTarget::MODEL;
+    else
+        return "unknown target";
+
+    const char *url = doc["url"] | "";
+    if (strncmp(url, "http://", 7) != 0 && strncmp(url, "https://", 8) != 0)
+        return "url must be http(s)";
+    if (strlen(url) >= sizeof(job.url))
+        return "url too long";
+    strlcpy(job.url, url, sizeof(job.url));
+
+    const char *hash = doc["sha256"] | "";
+    if (strlen(hash) != 64)
+        return "sha256 must be 64 hex digits";
+    for (int i = 0; i < 32; i++)
+    {
+        int hi = hexDigit(hash[2 * i]);
+        int lo = hexDigit(hash[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return "sha256 must be 64 hex digits";
+        job.sha256[i] = (uint8_t)(hi << 4 | lo);
+    }
+
+    job.size = doc["size"] | 0;
+    strlcpy(job.version, doc["version"] | "", sizeof(job.version));
+    return nullptr;
+}
+
+bool OtaUpdater::submit(const OtaJob &job)
+{
+    if (jobQueue == nullptr || busy)
+        return false;
+    busy = true;
+    if (xQueueSend(jobQueue, &job, 0) != pdTRUE)
+    {
+        busy = false;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// OTA task
+// ============================================================================
+
+void OtaUpdater::taskFunction(void *parameter)
+{
+    static_cast<OtaUpdater *>(parameter)->run();
+}
+
+void OtaUpdater::run()
+{
+    static OtaJob job; // Off the stack (URL)
+    while (true)
+    {
+        if (xQueueReceive(jobQueue, &job, pdMS_TO_TICKS(1000)) == pdTRUE)
+        {
+            runJob(job);
+            busy = false;
+        }
+
+        if (confirmPending)
+        {
+            confirmPending = false;
+            confirm();
+        }
+        else if (onProbation && millis() > OTA_CONFIRM_TIMEOUT_MS)
+        {
+            rollback("not confirmed");
+        }
+    }
+}
+
+void OtaUpdater::runJob(const OtaJob &job)
+{
+    const bool firmware = job.target == OtaTarget::FIRMWARE;
+    Serial.printf("[OTA] %s update %s from %s\n", firmware ? "Firmware" : "Model", job.version, job.url);
+    publish("ota_started", &job);
+
+    unsigned long start = millis();
+    FirmwareSink firmwareSink;
+    ModelSink modelSink;
+    OtaSink &sink = firmware ? (OtaSink &)firmwareSink : (OtaSink &)modelSink;
+    const char *error = download(job, sink);
+    lastDurationMs = millis() - start;
+    if (error != nullptr)
+    {
+        Serial.printf("[OTA] ERROR: %s\n", error);
+        publish("ota_failed", &job, error);
+        return;
+    }
+
+    if (firmware)
+    {
+        const esp_partition_t *running = esp_ota_get_running_partition();
+        if (esp_ota_set_boot_partition(firmwareSink.partition) != ESP_OK)
+        {
+            publish("ota_failed", &job, "cannot set boot partition");
+            return;
+        }
+        if (prefsOpen)
+        {
+            prefs.putString(KEY_TARGET, firmwareSink.partition->label);
+            prefs.putString(KEY_PREVIOUS, running ? running->label : "");
+            prefs.putString(KEY_VERSION, job.version);
+            prefs.putUChar(KEY_BOOTS, 0);
+            prefs.putBool(KEY_PENDING, true);
+        }
+        Serial.printf("[OTA] Firmware written to '%s' in %lu ms, restarting\n",
+                      firmwareSink.partition->label, (unsigned long)lastDurationMs);
+        publish("ota_firmware_installed", &job);
+        delay(1000); // Let the status go out
+        ESP.restart();
+        return;
+    }
+
+    // Model: swap it in with the detector released
+    staged = modelSink.image;
+    stagedSize = modelSink.size;
+    modelSink.detach();
+
+    bool installed = modelSwap != nullptr ? modelSwap(*this, modelSwapContext) : writeStagedModel();
+
+    HeapTracker::release(HeapTag::ML, staged, stagedSize);
+    HeapTracker::release(HeapTag::ML, backup, backupSize);
+    staged = nullptr;
+    backup = nullptr;
+    stagedSize = 0;
+    backupSize = 0;
+
+    if (installed)
+    {
+        Serial.printf("[OTA] Model %s installed in %lu ms\n", job.version, (unsigned long)lastDurationMs);
+        publish("ota_model_installed", &job);
+    }
+    else
+    {
+        publish("ota_failed", &job, "model rejected - previous model kept");
+    }
+}
+
+const char *OtaUpdater::download(const OtaJob &job, OtaSink &sink)
+{
+    static char httpError[32];
+
+    bool secure = strncmp(job.url, "https://", 8) == 0;
+    WiFiClient plainClient;
+    WiFiClientSecure secureClient;
+    if (secure)
+        secureClient.setInsecure(); // Integrity from the SHA-256, see header
+    WiFiClient &client = secure ? (WiFiClient &)secureClient : plainClient;
+
+    HTTPClient http;
+    if (!http.begin(client, job.url))
+        return "bad url";
+    http.setTimeout(OTA_STALL_TIMEOUT_MS);
+
+    int code = http.GET();
+    if (code != HTTP_CODE_OK)
+    {
+        snprintf(httpError, sizeof(httpError), "http %d", code);
+        http.end();
+        return httpError;
+    }
+
+    int contentLength = http.getSize();
+    size_t total = job.size > 0 ? job.size : (contentLength > 0 ? (size_t)contentLength : 0);
+    if (total == 0 || (contentLength > 0 && (size_t)contentLength != total))
+    {
+        http.end();
+        return total == 0 ? "unknown size" : "size mismatch";
+    }
+
+    if (!sink.begin(total))
+    {
+        http.end();
+        return sink.error;
+    }
+
+    uint8_t *chunk = (uint8_t *)malloc(OTA_CHUNK_BYTES);
+    if (chunk == nullptr)
+    {
+        sink.abort();
+        http.end();
+        return "out of memory";
+    }
+
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+
+    const char *error = nullptr;
+    WiFiClient *stream = http.getStreamPtr();
+    size_t received = 0;
+    unsigned long lastData = millis();
+    int nextProgress = 25;
+
+    // Whole chunks (a flash sector each) except the last
+    while (received < total && error == nullptr)
+    {
+        size_t want = min(total - received, (size_t)OTA_CHUNK_BYTES);
+        size_t got = 0;
+        while (got < want)
+        {
+            int available = stream->available();
+            if (available <= 0)
+            {
+                if (!http.connected() || millis() - lastData > OTA_STALL_TIMEOUT_MS)
+                    break;
+                delay(2);
+                continue;
+            }
+            int n = stream->read(chunk + got, min((size_t)available, want - got));
+            if (n > 0)
+            {
+                got += n;
+                lastData = millis();
+            }
+        }
+        if (got < want)
+        {
+            error = "download interrupted";
+            break;
+        }
+
+        mbedtls_sha256_update_ret(&sha, chunk, got);
+        if (!sink.write(chunk, got))
+            error = sink.error;
+        received += got;
+
+        int percent = (int)(received * 100 / total);
+        if (percent >= nextProgress && received < total)
+        {
+            DynamicJsonDocument details(128);
+            details["percent"] = percent;
+            details["bytes"] = (uint32_t)received;
+            mqttManager->publishStatus("ota_progress", details);
+            nextProgress += 25;
+        }
+    }
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    free(chunk);
+    http.end();
+    lastBytes = received;
+
+    if (error == nullptr && memcmp(digest, job.sha256, sizeof(digest)) != 0)
+        error = "sha256 mismatch";
+    if (error == nullptr && !sink.finish())
+        error = sink.error;
+    if (error != nullptr)
+        sink.abort();
+    return error;
+}
+
+// ============================================================================
+// Model partition
+// ============================================================================
+
+bool OtaUpdater::writeStagedModel()
+{
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ML_MODEL_PARTITION);
+    if (part == nullptr || staged == nullptr)
+        return false;
+
+    // Keep the current image (if any) until the new one has loaded
+    MLModelImageHeader current;
+    if (backup == nullptr && esp_partition_read(part, 0, &current, sizeof(current)) == ESP_OK &&
+        memcmp(current.magic, "MPML", 4) == 0 && current.length <= part->size - sizeof(current))
+    {
+        size_t size = sizeof(current) + current.length;
+        backup = (uint8_t *)HeapTracker::alloc(HeapTag::ML, size, PSRAM_CAPS);
+        if (backup != nullptr && esp_partition_read(part, 0, backup, size) == ESP_OK)
+        {
+            backupSize = size;
+        }
+        else
+        {
+            HeapTracker::release(HeapTag::ML, backup, size);
+            backup = nullptr;
+            Serial.println("[OTA] WARNING: Current model not backed up");
+        }
+    }
+
+    return writeModelImage(staged, stagedSize);
+}
+
+bool OtaUpdater::restoreModel()
+{
+    if (backup != nullptr)
+    {
+        Serial.println("[OTA] Restoring the previous model");
+        return writeModelImage(backup, backupSize);
+    }
+
+    // There was none: erase the header so the built-in model is used
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ML_MODEL_PARTITION);
+    Serial.println("[OTA] Clearing the model partition (built-in model)");
+    return part != nullptr && esp_partition_erase_range(part, 0, SPI_FLASH_SEC_SIZE) == ESP_OK;
+}
+
+bool OtaUpdater::writeModelImage(const uint8_t *image, size_t size)
+{
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ML_MODEL_PARTITION);
+    if (part == nullptr || size > part->size)
+        return false;
+
+    size_t eraseSize = (size + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE;
+    if (esp_partition_erase_range(part, 0, eraseSize) != ESP_OK ||
+        esp_partition_write(part, 0, image, size) != ESP_OK)
+    {
+        Serial.println("[OTA] ERROR: Model partition write failed");
+        return false;
+    }
+
+    // Read back and compare before anyone maps it
+    uint8_t *check = (uint8_t *)malloc(OTA_CHUNK_BYTES);
+    bool same = check != nullptr;
+    for (size_t offset = 0; same && offset < size; offset += OTA_CHUNK_BYTES)
+    {
+        size_t length = min(size - offset, (size_t)OTA_CHUNK_BYTES);
+        same = esp_partition_read(part, offset, check, length) == ESP_OK &&
+               memcmp(check, image + offset, length) == 0;
+    }
+    free(check);
+    if (!same)
+        Serial.println("[OTA] ERROR: Model partition verify failed");
+    return same;
+}
+
+// ============================================================================
+// Status
+// ============================================================================
+
+void OtaUpdater::toJson(JsonDocument &doc) const
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    doc["running"] = running ? running->label : "";
+    doc["app_version"] = esp_ota_get_app_description()->version;
+    doc["probation"] = onProbation;
+    doc["busy"] = (bool)busy;
+}
+
+void OtaUpdater::publish(const char *status, const OtaJob *job, const char *error)
+{
+    DynamicJsonDocument details(384);
+    if (job != nullptr)
+    {
+        details["target"] = job->target == OtaTarget::FIRMWARE ? "firmware" : "model";
+        details["version"] = job->version;
+    }
+    if (error != nullptr)
+        details["error"] = error;
+    if (strcmp(status, "ota_started") != 0)
+    {
+        details["bytes"] = lastBytes;
+        details["duration_ms"] = lastDurationMs;
+    }
+    mqttManager->publishStatus(status, details);
+}
@@ -0,0 +1,170 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "../mqtt/MQTTManager.h"
+
+/**
+ * OtaUpdater - Firmware and model updates streamed over the network
+ *
+ * A new model used to mean regenerating model_data.h and reflashing the
+ * whole firmware over USB. An "ota_update" command now names an image URL
+ * and its SHA-256; this task downloads it in OTA_CHUNK_BYTES pieces while
+ * sampling and detection keep running:
+ *
+ * - Firmware is written straight into the inactive app partition
+ *   (esp_ota_*), checked against the SHA-256, made the boot partition and
+ *   the device restarts. Nothing is switched if the hash does not match.
+ * - A model image (train.py's direction_model.bin) is staged in PSRAM,
+ *   checked (SHA-256, then the MLModelImageHeader CRC), and only then
+ *   written to ML_MODEL_PARTITION through the model swap hook, which
+ *   releases the detector's mapping around the write and reloads it.
+ *   The previous image is kept until the new one has loaded; if it does
+ *   not, restoreModel() puts the old one back.
+ *
+ * Rollback: a new firmware is on probation until confirmBoot() (the
+ * first MQTT connection). Each boot on probation is counted in NVS; more
+ * than OTA_ROLLBACK_BOOTS, or no confirmation within
+ * OTA_CONFIRM_TIMEOUT_MS, switches back to the previous app partition
+ * and restarts. This does not need the bootloader's rollback support.
+ *
+ * Integrity comes from the SHA-256 in the command, which arrives over the
+ * authenticated MQTT connection: the download itself may be plain HTTP or
+ * HTTPS without certificate checks (pre-signed bucket URLs).
+ *
+ * Statuses: ota_started, ota_progress, ota_failed, ota_model_installed,
+ * ota_firmware_installed (then restart), ota_confirmed, ota_rolled_back.
+ */
+
+#ifndef OTA_CHUNK_BYTES
+#define OTA_CHUNK_BYTES 4096
+#endif
+
+// Boots on probation before falling back to the previous firmware
+#ifndef OTA_ROLLBACK_BOOTS
+#define OTA_ROLLBACK_BOOTS 3
+#endif
+
+// A new firmware that has not reached MQTT by then is rolled back
+#ifndef OTA_CONFIRM_TIMEOUT_MS
+#define OTA_CONFIRM_TIMEOUT_MS (5UL * 60 * 1000)
+#endif
+
+// No data for this long aborts a download
+#ifndef OTA_STALL_TIMEOUT_MS
+#define OTA_STALL_TIMEOUT_MS 15000
+#endif
+
+#define OTA_URL_MAX 384
+
+enum class OtaTarget : uint8_t
+{
+    FIRMWARE,
+    MODEL
+};
+
+struct OtaJob
+{
+    OtaTarget target = OtaTarget::FIRMWARE;
+    char url[OTA_URL_MAX] = "";
+    uint8_t sha256[32] = {};
+    uint32_t size = 0;    // Expected bytes (0 = take the Content-Length)
+    char version[48] = ""; // Reported in the statuses only
+};
+
+class OtaUpdater;
+class OtaSink;
+
+/**
+ * Replaces the model partition contents: release the detector's model,
+ * call ota.writeStagedModel(), reload (and ota.restoreModel() if the new
+ * model does not load). Runs on the OTA task.
+ * @return true if the new model is in use
+ */
+typedef bool (*OtaModelSwapFn)(OtaUpdater &ota, void *context);
+
+class OtaUpdater
+{
+public:
+    /**
+     * Check the probation state (may roll back and restart) and start the
+     * OTA task. Call early in setup, before anything that could crash.
+     * @return false if the task could not be created
+     */
+    bool begin(MQTTManager *mqtt);
+
+    void setModelSwap(OtaModelSwapFn swap, void *context = nullptr);
+
+    /**
+     * Parse an ota_update command (target, url, sha256, size, version)
+     * @return nullptr on success, else the reason
+     */
+    static const char *parseJob(const JsonDocument &doc, OtaJob &job);
+
+    /**
+     * Queue a download (never blocks)
+     * @return false if an update is already running
+     */
+    bool submit(const OtaJob &job);
+
+    bool isBusy() const { return busy; }
+
+    /**
+     * The running firmware works (connection listener: records only)
+     */
+    void confirmBoot();
+
+    /**
+     * Boot the other app partition if it holds a valid image (restarts)
+     * @return false (with the reason) if there is nothing to go back to
+     */
+    bool rollbackFirmware(const char *&error);
+
+    // --- For the model swap hook (detector released) ---
+    bool writeStagedModel();
+    bool restoreModel();
+
+    void toJson(JsonDocument &doc) const;
+
+private:
+    MQTTManager *mqttManager = nullptr;
+    QueueHandle_t jobQueue = nullptr;
+    TaskHandle_t task = nullptr;
+    Preferences prefs;
+    bool prefsOpen = false;
+
+    OtaModelSwapFn modelSwap = nullptr;
+    void *modelSwapContext = nullptr;
+
+    volatile bool busy = false;
+    volatile bool confirmPending = false; // Set by confirmBoot()
+    bool onProbation = false;             // Running firmware not yet confirmed
+    char rolledBackVersion[48] = "";      // Reported once online
+
+    // Model images in PSRAM: the download, and the image it replaces
+    uint8_t *staged = nullptr;
+    size_t stagedSize = 0;
+    uint8_t *backup = nullptr;
+    size_t backupSize = 0;
+
+    uint32_t lastBytes = 0;
+    uint32_t lastDurationMs = 0;
+
+    void checkProbation();
+    void rollback(const char *reason);
+    void confirm();
+
+    static void taskFunction(void *parameter);
+    void run();
+    void runJob(const OtaJob &job);
+    const char *download(const OtaJob &job, OtaSink &sink);
+    bool writeModelImage(const uint8_t *image, size_t size);
+    void publish(const char *status, const OtaJob *job, const char *error = nullptr);
+};
+
+#endif
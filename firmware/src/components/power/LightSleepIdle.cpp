@@ -0,0 +1,72 @@
+#include "LightSleepIdle.h"
+
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+// Board INT lines (same wiring as SensorManager's HYBRID_INT_PINS)
+static const struct
+{
+    uint8_t pin;
+    uint8_t board; // TCA channel
+} INT_LINES[3] = {
+    {PIN_SENSOR_INT_3, 0},
+    {PIN_SENSOR_INT_2, 1},
+    {PIN_SENSOR_INT_1, 2},
+};
+
+void LightSleepIdle::configure(bool enable, uint16_t sleepMs)
+{
+    enabled = enable;
+    maxSleepMs = sleepMs > 0 ? sleepMs : LIGHT_SLEEP_MAX_MS;
+}
+
+uint8_t LightSleepIdle::lowBoards()
+{
+    uint8_t low = 0;
+    for (const auto &line : INT_LINES)
+    {
+        if (digitalRead(line.pin) == LOW)
+            low |= 1 << line.board;
+    }
+    return low;
+}
+
+LightSleepWake LightSleepIdle::sleep()
+{
+    LightSleepWake wake = {};
+    wake.lowBoards = lowBoards();
+    if (!enabled || wake.lowBoards != 0)
+        return wake;
+
+    for (const auto &line : INT_LINES)
+        gpio_wakeup_enable((gpio_num_t)line.pin, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)maxSleepMs * 1000ULL);
+
+    uint32_t startUs = micros();
+    esp_err_t err = esp_light_sleep_start();
+    wake.wakeUs = micros();
+
+    // gpio_wakeup_enable() left the lines level triggered: back to the edge
+    // the ISRs were attached with
+    for (const auto &line : INT_LINES)
+    {
+        gpio_wakeup_disable((gpio_num_t)line.pin);
+        gpio_set_intr_type((gpio_num_t)line.pin, GPIO_INTR_NEGEDGE);
+    }
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+
+    if (err != ESP_OK)
+        return wake;
+
+    wake.slept = true;
+    wake.sleptUs = wake.wakeUs - startUs;
+    wake.gpio = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+    wake.lowBoards = lowBoards();
+    sleeps++;
+    sleptUsTotal += wake.sleptUs;
+    if (wake.gpio)
+        gpioWakes++;
+    return wake;
+}
@@ -0,0 +1,65 @@
+#ifndef LIGHT_SLEEP_IDLE_H
+#define LIGHT_SLEEP_IDLE_H
+
+#include <Arduino.h>
+#include "pin_config.h"
+
+/**
+ * LightSleepIdle - Light sleep while the sensors wait for an INT line
+ *
+ * In hybrid INT idle (and interrupt sessions) the sensors raise
+ * PIN_SENSOR_INT_1..3 themselves, yet both cores kept spinning through
+ * loop() and the task switches of an idle system. With light_sleep_idle,
+ * loop() puts the chip to light sleep instead:
+ *
+ * - Wake sources: any INT line low (GPIO level wake) or light_sleep_max_ms
+ *   (timer, so MQTT, commands and the display keep being serviced)
+ * - Not entered while a line is already low
+ * - After a GPIO wake the caller hands the low boards to whoever waits on
+ *   the lines (SensorManager::wakeFromSleep(), InterruptManager::wakeBoards());
+ *   the edge ISRs are not guaranteed to see an edge that woke the chip
+ *
+ * The GPIO wake reprograms the pins' interrupt type; sleep() puts the
+ * FALLING edge back that SensorManager and InterruptManager attach.
+ */
+
+// Longest sleep before the timer wakes loop() (light_sleep_max_ms default)
+#ifndef LIGHT_SLEEP_MAX_MS
+#define LIGHT_SLEEP_MAX_MS 200
+#endif
+
+struct LightSleepWake
+{
+    bool slept;        // esp_light_sleep_start() ran
+    bool gpio;         // ...and an INT line ended it
+    uint8_t lowBoards; // INT lines low afterwards (bit = TCA channel)
+    uint32_t wakeUs;   // micros() right after waking
+    uint32_t sleptUs;
+};
+
+class LightSleepIdle
+{
+public:
+    void configure(bool enable, uint16_t maxSleepMs);
+    bool isEnabled() const { return enabled; }
+
+    // Sleep until an INT line is low or maxSleepMs has passed (loop())
+    LightSleepWake sleep();
+
+    // INT lines low right now (bit = TCA channel)
+    static uint8_t lowBoards();
+
+    uint32_t getSleepCount() const { return sleeps; }
+    uint32_t getGpioWakeCount() const { return gpioWakes; }
+    uint32_t getSleptMs() const { return (uint32_t)(sleptUsTotal / 1000); }
+
+private:
+    bool enabled = false;
+    uint16_t maxSleepMs = LIGHT_SLEEP_MAX_MS;
+
+    uint32_t sleeps = 0;
+    uint32_t gpioWakes = 0;
+    uint64_t sleptUsTotal = 0;
+};
+
+#endif
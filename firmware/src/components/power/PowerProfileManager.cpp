@@ -0,0 +1,228 @@
+#include "PowerProfileManager.h"
+
+// Smoothing of the ~2 Hz readings (LED flashes and Wi-Fi bursts sag VSYS)
+static const float READING_ALPHA = 0.1f;
+
+static const PowerProfileLimits PROFILE_LIMITS[] = {
+    // rate, LED mA, duty 1/N, CPU MHz, Wi-Fi PS, backlight
+    {0, 0, 0, 240, 0, 255},        // PERFORMANCE: no modem sleep (detection latency)
+    {500, 120, 80, 160, 1, 128},   // BALANCED
+    {200, 75, 160, 80, 2, 40},     // SAVER
+};
+
+// While unmanaged: the firmware defaults (Arduino keeps min modem sleep)
+static const PowerProfileLimits UNMANAGED_LIMITS = {0, 0, 0, 240, 1, 255};
+
+void PowerProfileManager::configure(const SensorConfiguration &config)
+{
+    Mode newMode = Mode::AUTO;
+    PowerProfile newFixed = PowerProfile::PERFORMANCE;
+    if (config.power_profile == "off")
+        newMode = Mode::OFF;
+    else if (config.power_profile == "performance")
+        newMode = Mode::FIXED;
+    else if (config.power_profile == "balanced")
+    {
+        newMode = Mode::FIXED;
+        newFixed = PowerProfile::BALANCED;
+    }
+    else if (config.power_profile == "saver")
+    {
+        newMode = Mode::FIXED;
+        newFixed = PowerProfile::SAVER;
+    }
+
+    balancedBelowV = config.power_balanced_below_v;
+    saverBelowV = min(config.power_saver_below_v, config.power_balanced_below_v);
+    currentBudgetMA = config.power_current_budget_ma;
+
+    if (newMode != mode || newFixed != fixedProfile)
+    {
+        mode = newMode;
+        fixedProfile = newFixed;
+        // Re-decided (and re-applied) at the next reading, without dwell
+        lastSwitchMs = millis() - POWER_PROFILE_MIN_DWELL_MS;
+        overBudget = false;
+    }
+}
+
+bool PowerProfileManager::update(float vsysVoltage, float currentMA, bool externalPower, uint32_t nowMs)
+{
+    portENTER_CRITICAL(&lock);
+    uint32_t dt = primed ? nowMs - lastUpdateMs : 0;
+    if (!primed)
+    {
+        voltage = vsysVoltage;
+        current = currentMA;
+        primed = true;
+    }
+    else
+    {
+        voltage += READING_ALPHA * (vsysVoltage - voltage);
+        current += READING_ALPHA * (currentMA - current);
+    }
+    if (externalPower)
+    {
+        chargeMah = 0.0f;
+        onBatteryMs = 0;
+    }
+    else
+    {
+        chargeMah += max(currentMA, 0.0f) * dt / 3600000.0f;
+        onBatteryMs += dt;
+    }
+    external = externalPower;
+    lastUpdateMs = nowMs;
+    portEXIT_CRITICAL(&lock);
+
+    if (mode == Mode::OFF)
+    {
+        if (!managed)
+            return false;
+        // Hand the defaults back once
+        managed = false;
+        profile = PowerProfile::PERFORMANCE;
+        reason = "off";
+        switches = switches + 1;
+        return true;
+    }
+
+    const char *why = reason;
+    PowerProfile next = select(nowMs, why);
+    if (managed && next == profile)
+        return false;
+
+    bool toExternal = externalPower && next == PowerProfile::PERFORMANCE;
+    if (managed && nowMs - lastSwitchMs < POWER_PROFILE_MIN_DWELL_MS && !toExternal)
+        return false;
+
+    if (managed || next != PowerProfile::PERFORMANCE)
+        switches = switches + 1;
+    managed = true;
+    profile = next;
+    reason = why;
+    lastSwitchMs = nowMs;
+    return true;
+}
+
+PowerProfile PowerProfileManager::select(uint32_t nowMs, const char *&why)
+{
+    if (mode == Mode::FIXED)
+    {
+        why = "fixed";
+        return fixedProfile;
+    }
+    if (external)
+    {
+        why = "external_power";
+        overBudget = false;
+        voltageProfile = PowerProfile::PERFORMANCE;
+        return PowerProfile::PERFORMANCE;
+    }
+
+    // Voltage level, stepping back up only POWER_PROFILE_HYSTERESIS_V above a limit
+    PowerProfile byVoltage;
+    if (voltage < saverBelowV)
+        byVoltage = PowerProfile::SAVER;
+    else if (voltage < balancedBelowV)
+        byVoltage = (voltageProfile == PowerProfile::SAVER && voltage < saverBelowV + POWER_PROFILE_HYSTERESIS_V)
+                        ? PowerProfile::SAVER
+                        : PowerProfile::BALANCED;
+    else
+        byVoltage = (voltageProfile != PowerProfile::PERFORMANCE && voltage < balancedBelowV + POWER_PROFILE_HYSTERESIS_V)
+                        ? PowerProfile::BALANCED
+                        : PowerProfile::PERFORMANCE;
+    voltageProfile = byVoltage;
+    why = byVoltage == PowerProfile::PERFORMANCE ? "battery" : "vsys_low";
+
+    // Over budget: one step lower until it has stayed under for the hold
+    if (currentBudgetMA > 0 && current > currentBudgetMA)
+    {
+        overBudget = true;
+        overBudgetSinceMs = nowMs;
+    }
+    else if (overBudget && nowMs - overBudgetSinceMs >= POWER_PROFILE_BUDGET_HOLD_MS)
+    {
+        overBudget = false;
+    }
+
+    if (overBudget && byVoltage != PowerProfile::SAVER)
+    {
+        why = "current_budget";
+        return (PowerProfile)((uint8_t)byVoltage + 1);
+    }
+    return byVoltage;
+}
+
+const PowerProfileLimits &PowerProfileManager::getLimits() const
+{
+    return managed ? limitsFor(profile) : UNMANAGED_LIMITS;
+}
+
+void PowerProfileManager::limit(SensorConfiguration &config) const
+{
+    if (!managed)
+        return;
+    const PowerProfileLimits &limits = limitsFor(profile);
+
+    if (limits.maxSampleRateHz > 0 && config.sample_rate_hz > limits.maxSampleRateHz)
+        config.sample_rate_hz = limits.maxSampleRateHz;
+
+    // "200mA" -> 200; the VCNL4040 steps (50/75/100/120/...) cover every cap
+    if (limits.maxLedCurrentMA > 0 && config.led_current.toInt() > limits.maxLedCurrentMA)
+        config.led_current = String(limits.maxLedCurrentMA) + "mA";
+
+    // "1/40" -> 40: a larger divisor is a slower (lower power) duty
+    int slash = config.duty_cycle.indexOf('/');
+    long divisor = slash >= 0 ? config.duty_cycle.substring(slash + 1).toInt() : 40;
+    if (limits.minDutyDivisor > 0 && divisor < limits.minDutyDivisor)
+        config.duty_cycle = "1/" + String(limits.minDutyDivisor);
+}
+
+void PowerProfileManager::toJson(JsonDocument &doc) const
+{
+    portENTER_CRITICAL(&lock);
+    float v = voltage;
+    float c = current;
+    float mah = chargeMah;
+    uint32_t batteryMs = onBatteryMs;
+    bool ext = external;
+    portEXIT_CRITICAL(&lock);
+
+    const PowerProfileLimits &limits = getLimits();
+    doc["profile"] = managed ? profileName(profile) : "off";
+    doc["reason"] = reason;
+    doc["switches"] = (uint32_t)switches;
+    doc["vsys_v"] = v;
+    doc["current_ma"] = c;
+    doc["external_power"] = ext;
+    doc["battery_mah_used"] = mah;
+    doc["on_battery_s"] = batteryMs / 1000;
+    doc["cpu_mhz"] = limits.cpuFrequencyMhz;
+    doc["wifi_ps"] = limits.wifiPowerSave;
+    doc["backlight"] = limits.displayBrightness;
+    if (limits.maxSampleRateHz > 0)
+        doc["max_sample_rate_hz"] = limits.maxSampleRateHz;
+    if (limits.maxLedCurrentMA > 0)
+        doc["max_led_current_ma"] = limits.maxLedCurrentMA;
+}
+
+const PowerProfileLimits &PowerProfileManager::limitsFor(PowerProfile profile)
+{
+    return PROFILE_LIMITS[(uint8_t)profile];
+}
+
+const char *PowerProfileManager::profileName(PowerProfile profile)
+{
+    switch (profile)
+    {
+    case PowerProfile::PERFORMANCE:
+        return "performance";
+    case PowerProfile::BALANCED:
+        return "balanced";
+    case PowerProfile::SAVER:
+        return "saver";
+    default:
+        return "unknown";
+    }
+}
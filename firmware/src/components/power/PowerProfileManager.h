@@ -0,0 +1,133 @@
+#ifndef POWER_PROFILE_MANAGER_H
+#define POWER_PROFILE_MANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include "../sensor/SensorConfiguration.h"
+
+/**
+ * PowerProfileManager - Picks an operating profile from PowerMonitor readings
+ *
+ * On battery the device trades responsiveness for runtime. Each profile
+ * caps what draws current: sensor sample rate, VCNL4040 LED current and
+ * duty cycle, CPU frequency, Wi-Fi modem sleep and display brightness.
+ *
+ * - power_profile "auto": PERFORMANCE on external power (BQ24195 power
+ *   good), otherwise by smoothed VSYS: BALANCED below
+ *   power_balanced_below_v, SAVER below power_saver_below_v (each with
+ *   POWER_PROFILE_HYSTERESIS_V before stepping back up). A smoothed
+ *   current above power_current_budget_ma (0 = none) steps down one more
+ *   profile for POWER_PROFILE_BUDGET_HOLD_MS
+ * - A fixed profile name pins it; "off" leaves every setting alone (as
+ *   does "auto" without an INA219)
+ * - Switches are at least POWER_PROFILE_MIN_DWELL_MS apart, except to
+ *   PERFORMANCE when external power appears
+ * - Charge drawn and time since external power was last present are
+ *   integrated, so runtime per charge can be compared between profiles
+ *
+ * update() runs on loop(), which applies the limits on a switch;
+ * toJson() may run on the status task.
+ */
+
+#ifndef POWER_PROFILE_MIN_DWELL_MS
+#define POWER_PROFILE_MIN_DWELL_MS 30000
+#endif
+
+#ifndef POWER_PROFILE_BUDGET_HOLD_MS
+#define POWER_PROFILE_BUDGET_HOLD_MS 300000
+#endif
+
+#define POWER_PROFILE_HYSTERESIS_V 0.05f
+
+enum class PowerProfile : uint8_t
+{
+    PERFORMANCE,
+    BALANCED,
+    SAVER
+};
+
+// What a profile allows (0 = no cap)
+struct PowerProfileLimits
+{
+    uint16_t maxSampleRateHz;
+    uint16_t maxLedCurrentMA;  // VCNL4040 LED current (led_current)
+    uint16_t minDutyDivisor;   // Slowest duty cycle as 1/N (duty_cycle)
+    uint16_t cpuFrequencyMhz;  // setCpuFrequencyMhz()
+    uint8_t wifiPowerSave;     // wifi_ps_type_t: 0 none, 1 min modem, 2 max modem
+    uint8_t displayBrightness; // Backlight, 255 = full
+};
+
+class PowerProfileManager
+{
+public:
+    /**
+     * From sensor_config (power_profile, power_*); the profile is
+     * re-evaluated at the next update()
+     */
+    void configure(const SensorConfiguration &config);
+
+    /**
+     * Feed one PowerMonitor reading (~2 Hz)
+     * @param externalPower Input source present (charging / USB)
+     * @return true if the profile changed: apply getLimits()
+     */
+    bool update(float vsysVoltage, float currentMA, bool externalPower, uint32_t nowMs);
+
+    // False while "off" (and before the first reading)
+    bool isManaged() const { return managed; }
+    PowerProfile getProfile() const { return profile; }
+    // Limits to apply (firmware defaults while unmanaged)
+    const PowerProfileLimits &getLimits() const;
+    const char *getReason() const { return reason; }
+    uint32_t getSwitchCount() const { return switches; }
+
+    /**
+     * config within the current profile's limits (sample rate, LED
+     * current, duty cycle); unchanged while unmanaged
+     */
+    void limit(SensorConfiguration &config) const;
+
+    // Profile, reason, smoothed readings and charge drawn since external power
+    void toJson(JsonDocument &doc) const;
+
+    static const PowerProfileLimits &limitsFor(PowerProfile profile);
+    static const char *profileName(PowerProfile profile);
+
+private:
+    enum class Mode : uint8_t
+    {
+        OFF,
+        AUTO,
+        FIXED
+    };
+
+    Mode mode = Mode::AUTO;
+    PowerProfile fixedProfile = PowerProfile::PERFORMANCE;
+    float balancedBelowV = 3.7f;
+    float saverBelowV = 3.5f;
+    uint16_t currentBudgetMA = 0;
+
+    volatile bool managed = false;
+    volatile PowerProfile profile = PowerProfile::PERFORMANCE;
+    const char *volatile reason = "boot";
+    volatile uint32_t switches = 0;
+    uint32_t lastSwitchMs = 0;
+    PowerProfile voltageProfile = PowerProfile::PERFORMANCE; // Level from VSYS alone
+    bool overBudget = false;
+    uint32_t overBudgetSinceMs = 0;
+
+    // Smoothed readings and charge accounting (under lock)
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    bool primed = false;
+    bool external = false;
+    float voltage = 0.0f;
+    float current = 0.0f;
+    float chargeMah = 0.0f;     // Drawn since external power was last present
+    uint32_t onBatteryMs = 0;   // Time since then
+    uint32_t lastUpdateMs = 0;
+
+    PowerProfile select(uint32_t nowMs, const char *&why);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "AdaptiveRateScheduler.h"
+
+void AdaptiveRateScheduler::configure(bool enable, float approachFraction, uint32_t hold)
+{
+    approach = approachFraction;
+    holdMs = hold;
+    holding = false;
+    idle = false;
+    enabled = enable;
+}
+
+void AdaptiveRateScheduler::update(float activity, uint32_t nowMs)
+{
+    if (!enabled)
+        return;
+
+    if (activity >= approach || !holding)
+    {
+        // The hold also starts from the first report, so a session always
+        // opens with holdMs at the full rate
+        lastActiveMs = nowMs;
+        holding = true;
+        idle = false;
+        return;
+    }
+
+    if (nowMs - lastActiveMs >= holdMs)
+        idle = true;
+}
+
+void AdaptiveRateScheduler::release()
+{
+    holding = false;
+    idle = false;
+}
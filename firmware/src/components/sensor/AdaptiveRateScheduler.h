@@ -0,0 +1,55 @@
+#ifndef ADAPTIVE_RATE_SCHEDULER_H
+#define ADAPTIVE_RATE_SCHEDULER_H
+
+#include <Arduino.h>
+
+/**
+ * AdaptiveRateScheduler - Picks the sample rate from detector activity
+ *
+ * While every baseline is stable and no smoothed signal is near its
+ * threshold, the sensor task can run at adaptive_idle_rate_hz instead of
+ * sample_rate_hz (less CPU, I2C traffic and emitter power). As soon as
+ * the detector reports activity at or above the approach fraction — or
+ * a sensor is in a wave — the full rate is requested again, and kept for
+ * adaptive_hold_ms after activity drops.
+ *
+ * - Producer: DetectionTask, once per fed batch (update / release)
+ * - Consumer: the sensor task, once per cycle (wantsIdleRate); it owns the
+ *   timer and applies the change
+ * - The decision is a single flag, so no locking is needed
+ */
+class AdaptiveRateScheduler
+{
+public:
+    /**
+     * Set by SensorManager::startCollection(); starts at the full rate
+     * @param approachFraction Activity (0 = baseline max, 1 = threshold) that requests the full rate
+     */
+    void configure(bool enable, float approachFraction, uint32_t holdMs);
+
+    /**
+     * Report the detector's current activity (BasicDirectionDetector::getActivity())
+     */
+    void update(float activity, uint32_t nowMs);
+
+    /**
+     * Full rate until the next update (detector not running, ML detector,
+     * or baselines being re-established)
+     */
+    void release();
+
+    bool isEnabled() const { return enabled; }
+    bool wantsIdleRate() const { return idle; }
+
+private:
+    volatile bool enabled = false;
+    volatile bool idle = false;
+    float approach = 0.5f;
+    uint32_t holdMs = 500;
+
+    // Detection task side
+    bool holding = false; // lastActiveMs is valid
+    uint32_t lastActiveMs = 0;
+};
+
+#endif
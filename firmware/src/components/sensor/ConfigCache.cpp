@@ -0,0 +1,57 @@
+#include "ConfigCache.h"
+
+static const char *CONFIG_CACHE_TEMP_PATH = CONFIG_CACHE_PATH ".tmp";
+
+bool ConfigCache::load(JsonDocument &doc)
+{
+    File file = LittleFS.open(CONFIG_CACHE_PATH, "r");
+    if (!file)
+        return false;
+
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error || !doc.is<JsonObject>())
+    {
+        Serial.printf("WARNING: Cached config unreadable (%s)\n", error.c_str());
+        return false;
+    }
+
+    cachedText = "";
+    serializeJson(doc, cachedText);
+    return true;
+}
+
+bool ConfigCache::save(JsonObjectConst config)
+{
+    String text;
+    serializeJson(config, text);
+
+    File file = LittleFS.open(CONFIG_CACHE_TEMP_PATH, "w");
+    if (!file)
+    {
+        Serial.println("WARNING: Config cache not writable");
+        return false;
+    }
+    size_t written = file.print(text);
+    file.close();
+
+    if (written != text.length() || !LittleFS.rename(CONFIG_CACHE_TEMP_PATH, CONFIG_CACHE_PATH))
+    {
+        Serial.println("WARNING: Config cache write failed");
+        LittleFS.remove(CONFIG_CACHE_TEMP_PATH);
+        return false;
+    }
+
+    cachedText = text;
+    return true;
+}
+
+bool ConfigCache::isCurrent(JsonObjectConst config) const
+{
+    if (cachedText.isEmpty())
+        return false;
+
+    String text;
+    serializeJson(config, text);
+    return text == cachedText;
+}
@@ -0,0 +1,46 @@
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+/**
+ * ConfigCache - Last good cloud sensor_config, kept on LittleFS
+ *
+ * Boot used to wait for WiFi, the MQTT handshake and the config GET before
+ * the sensors were initialized. The config now comes from this cache, as
+ * the cloud last sent it, and the GET refreshes it in the background.
+ *
+ * - Stored as the sensor_config JSON object, parsed by the same code as a
+ *   fresh one
+ * - save() writes a temporary file and renames it: a reset mid-write
+ *   leaves the previous config
+ * - isCurrent() compares against what was last loaded or saved, so an
+ *   unchanged cloud config is neither rewritten nor reapplied
+ *
+ * LittleFS must be mounted (NetworkManager::loadConfig()).
+ */
+
+#ifndef CONFIG_CACHE_PATH
+#define CONFIG_CACHE_PATH "/sensor_config.json"
+#endif
+
+class ConfigCache
+{
+public:
+    /**
+     * Read the cached sensor_config into doc
+     * @return false if there is none or it does not parse
+     */
+    bool load(JsonDocument &doc);
+
+    bool save(JsonObjectConst config);
+
+    bool isCurrent(JsonObjectConst config) const;
+
+private:
+    String cachedText; // Serialized form last loaded or saved
+};
+
+#endif
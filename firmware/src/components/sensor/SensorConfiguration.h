@@ -6,8 +6,9 @@
 // Sensor mode determines how we read sensors
 enum class SensorMode
 {
-    POLLING_MODE,  // Traditional high-frequency polling (read sensors at sample_rate_hz)
-    INTERRUPT_MODE // Interrupt-based detection (sensors signal when thresholds crossed)
+    POLLING_MODE,   // Traditional high-frequency polling (read sensors at sample_rate_hz)
+    INTERRUPT_MODE, // Interrupt-based detection (sensors signal when thresholds crossed)
+    HYBRID_MODE     // Interrupt idle; any INT line starts a polling burst at sample_rate_hz
 };
 
 // Sensor configuration structure
@@ -25,9 +26,16 @@ struct SensorConfiguration
     String multi_pulse = "1";   // Multi-pulse mode: "1", "2", "4", "8" pulses per measurement (more = stronger signal)
     bool high_resolution = true;
     bool read_ambient = true;           // If false, only proximity is read (faster)
+    bool active_force = false;          // Trigger all sensors together each cycle (PS_AF) instead of free-running
+    bool skew_compensation = false;     // us center of mass; sample instants need SENSOR_SKEW_OFFSETS
     uint32_t i2c_clock_khz = 400;       // I2C clock speed in kHz (400 or 1000)
     uint16_t actual_sample_rate_hz = 0; // Measured actual sample rate (populated during session)
 
+    // Reads faster than the sensors convert return the same conversion again:
+    // "off", "match" (sample period stretched to the conversion period) or
+    // "suppress" (unchanged repeats sent without a value, see SensorFrame::held_mask)
+    String duplicate_mode = "off";
+
     // === Physical Geometry (for transit speed estimation) ===
     uint16_t ball_diameter_mm = 190;         // Soccer ball size 3 (~190mm). Sizes: 2=165, 3=190, 4=206, 5=220
     uint16_t hoop_inner_diameter_mm = 450;   // Hoop inner diameter in mm
@@ -42,8 +50,81 @@ struct SensorConfiguration
     bool interrupt_smart_persistence = true;  // Enable fast response mode
     String interrupt_mode = "normal";         // "normal" or "logic" (logic = INT stays LOW while close)
 
+    // === Hybrid Mode Settings ===
+    // Idle thresholds reuse interrupt_threshold_margin / _hysteresis / _persistence,
+    // relative to the proximity level measured when collection starts.
+    String hybrid_idle_duty_cycle = "1/160"; // Sensor duty while waiting for INT (lower = less LED power, slower INT)
+    uint16_t hybrid_burst_window_ms = 1500;  // Burst ends this long after the last reading above threshold
+    uint16_t hybrid_burst_max_ms = 10000;    // Hard cap on one burst (e.g. an object parked in the hoop)
+    bool hybrid_burst_all_boards = true;     // false = poll only the boards whose INT fired
+    bool light_sleep_idle = false;           // Light sleep while waiting for an INT line (hybrid / interrupt sessions)
+    uint16_t light_sleep_max_ms = 200;       // Longest sleep before loop() runs again (MQTT, commands)
+
+    // === Adaptive Rate Settings ===
+    // Polling (not hybrid) sessions with the heuristic detector running (Play / Live Debug)
+    bool adaptive_rate = false;              // Drop to the idle rate while the detector sees nothing
+    uint16_t adaptive_idle_rate_hz = 100;    // Idle sample rate (must be below sample_rate_hz)
+    float adaptive_approach_fraction = 0.5f; // Full rate once a signal is this far from baseline max to threshold
+    uint16_t adaptive_hold_ms = 500;         // Stay at the full rate this long after activity drops
+
+    // === Auto Calibration ===
+    // Calibrated thresholds and PS_CANC follow idle baseline drift while
+    // the heuristic detector runs (AutoCalibrator)
+    bool auto_calibration = true;
+
+    // === Power Profiles ===
+    // Battery installs: sample rate, LED current / duty, CPU, Wi-Fi sleep and
+    // backlight follow VSYS and current draw (PowerProfileManager)
+    String power_profile = "auto";         // "auto", "performance", "balanced", "saver" or "off"
+    float power_balanced_below_v = 3.7f;   // Smoothed VSYS on battery below which BALANCED applies
+    float power_saver_below_v = 3.5f;      // ...and SAVER
+    uint16_t power_current_budget_ma = 0;  // One profile lower while drawing more (0 = no budget)
+
+    // === Upload Settings ===
+    String upload_format = "json"; // Session upload wire format: "json" (readable batches), "binary" (streamed bin9/ibin10)
+                                   // or "delta" (dvz1 delta+varint readings, ibin10 events)
+
+    // Debug sessions stream to a LittleFS file instead of staying in memory,
+    // lifting the 30 s limit to SESSION_SPILL_MAX_MS / free flash
+    bool spill_to_flash = false;
+
+    // === LAN Output ===
+    // Detections as UDP datagrams on the local network (LanEventStream),
+    // optionally with the live frames fed to the detector
+    bool lan_stream = false;
+    bool lan_stream_frames = false;
+    // Hoop array (HoopArray): "off", "peer" (follow the coordinator's clock)
+    // or "coordinator" (send clock beacons, merge every unit's detections)
+    String array_role = "off";
+
+    // === Live Debug Capture Settings ===
+    // Window uploaded around each detection (pre + post must fit CAPTURE_UPLOAD_SLOT_FRAMES cycles)
+    uint16_t capture_pre_trigger_ms = 500;  // Data kept from before the detecting frame
+    uint16_t capture_post_trigger_ms = 250; // Data collected after it before the capture is cut
+
     // Note: Configuration is applied during sensor initialization.
     // Dynamic reconfiguration requires sensor reinitialization.
+
+    // Free-running PS conversion period: integration time (1T = 125 us, from
+    // the Vishay design guide) x duty cycle denominator. Active force converts
+    // once per trigger instead.
+    uint32_t conversionPeriodUs() const
+    {
+        uint32_t itUs = 125;
+        if (integration_time == "1.5T") itUs = 188;
+        else if (integration_time == "2T") itUs = 250;
+        else if (integration_time == "2.5T") itUs = 313;
+        else if (integration_time == "3T") itUs = 375;
+        else if (integration_time == "3.5T") itUs = 438;
+        else if (integration_time == "4T") itUs = 500;
+        else if (integration_time == "8T") itUs = 1000;
+
+        int slash = duty_cycle.indexOf('/');
+        uint32_t dutyDenom = slash >= 0 ? duty_cycle.substring(slash + 1).toInt() : 0;
+        if (dutyDenom == 0)
+            dutyDenom = 40;
+        return itUs * dutyDenom;
+    }
 };
 
 #endif
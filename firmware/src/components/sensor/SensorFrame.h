@@ -0,0 +1,121 @@
+#ifndef SENSOR_FRAME_H
+#define SENSOR_FRAME_H
+
+#include <Arduino.h>
+
+/**
+ * Sensor data types shared by the sensor task and every consumer
+ *
+ * No hardware dependencies, so the detectors and codecs that only need
+ * frames also build for the host (firmware/src/replay).
+ */
+
+// Sensor topology capacity. Boards hang off TCA9548A channels 0..N-1 (one
+// PCA9546A each, two VCNL4040s per board) and are discovered at init();
+// positions are channel-indexed (board * SENSORS_PER_BOARD + side), so a
+// position keeps its meaning whichever boards answer. Buffers, frames and
+// detector trackers are sized for the capacity; absent boards' positions
+// simply never become valid. The TCA9548A has 8 channels; at least 3 boards
+// are provisioned because the ML model and Serial Studio layout use 6.
+#ifndef SENSOR_MAX_BOARDS
+#define SENSOR_MAX_BOARDS 3
+#endif
+#define SENSORS_PER_BOARD 2
+#define NUM_SENSORS (SENSOR_MAX_BOARDS * SENSORS_PER_BOARD)
+
+static_assert(SENSOR_MAX_BOARDS >= 3 && SENSOR_MAX_BOARDS <= 8, "SENSOR_MAX_BOARDS must be 3..8");
+
+// Bit n = position n (valid_mask and the sensor manager's per-sensor masks)
+#if NUM_SENSORS <= 8
+typedef uint8_t SensorMask;
+#else
+typedef uint16_t SensorMask;
+#endif
+#define SENSOR_MASK_ALL ((SensorMask) ~(SensorMask)0)
+
+// Per-position sample offsets in SensorFrame (skew_compensation). Off by
+// default: they grow every frame in the rings, the session buffer and the
+// spill file from 32 to 44 bytes (3 boards). Without them skew_compensation
+// still runs the detector's center of mass at us resolution, from the
+// cycle timestamp.
+#ifndef SENSOR_SKEW_OFFSETS
+#define SENSOR_SKEW_OFFSETS 0
+#endif
+
+// Sensor reading structure
+struct SensorReading
+{
+    uint32_t timestamp_us; // Microsecond timestamp (was timestamp_ms prior to microsecond-timestamps initiative)
+    uint8_t position;      // 0..NUM_SENSORS-1 (sensor array index)
+    uint8_t pcb_id;        // 1..SENSOR_MAX_BOARDS (which sensor board: P1, P2, ...)
+    uint8_t side;          // 1-2 (which sensor on board: S1, S2)
+    uint16_t proximity;
+    uint16_t ambient;
+};
+
+// One complete polling cycle: every position shares the cycle timestamp.
+// This is the slot type of the Core 0 → Core 1 frame ring (32 bytes, one
+// cache line, with the default 3 boards; 44 with SENSOR_SKEW_OFFSETS), so the
+// sensor task publishes a whole cycle per push, and
+// the native element of the session buffer and every consumer downstream
+// (detectors, Serial Studio, transmitter). Invalid positions read as 0;
+// held positions carry the repeated value, like valid ones.
+//
+// The reads of one cycle happen hundreds of microseconds apart. With
+// skew_compensation the sensor task records when each position was actually
+// sampled as an offset from timestamp_us (offset_us, SENSOR_SKEW_OFFSETS
+// builds only); without it, and in frames decoded from the wire formats,
+// every offset is 0.
+struct SensorFrame
+{
+    uint32_t timestamp_us;             // Cycle timestamp (same for all positions)
+    uint16_t proximity[NUM_SENSORS];   // Indexed by position
+    uint16_t ambient[NUM_SENSORS];     // 0 if ambient reads are disabled
+#if SENSOR_SKEW_OFFSETS
+    uint16_t offset_us[NUM_SENSORS];   // Sample instant - timestamp_us (skew_compensation)
+#endif
+    SensorMask valid_mask;             // Bit n set = position n read OK this cycle
+    SensorMask held_mask;              // Bit n set = position n read its previous value again
+                                       // (duplicate_mode "suppress"); not valid, value repeated
+#if NUM_SENSORS <= 8
+    uint8_t reserved[2];
+#endif
+
+    bool isValid(uint8_t position) const { return (valid_mask >> position) & 1; }
+    bool isHeld(uint8_t position) const { return (held_mask >> position) & 1; }
+
+    // Nothing read OK this cycle: not published
+    bool isEmpty() const { return (valid_mask | held_mask) == 0; }
+
+#if SENSOR_SKEW_OFFSETS
+    uint16_t offsetUs(uint8_t position) const { return offset_us[position]; }
+    void setOffsetUs(uint8_t position, uint16_t us) { offset_us[position] = us; }
+#else
+    uint16_t offsetUs(uint8_t) const { return 0; }
+    void setOffsetUs(uint8_t, uint16_t) {}
+#endif
+
+    // When this position was sampled (timestamp_us without skew_compensation)
+    uint32_t sampleUs(uint8_t position) const { return timestamp_us + offsetUs(position); }
+
+    uint8_t validCount() const { return __builtin_popcount(valid_mask); }
+
+    // Expand one position back into the per-reading format
+    void toReading(uint8_t position, SensorReading &reading) const
+    {
+        reading.timestamp_us = timestamp_us;
+        reading.position = position;
+        reading.pcb_id = (position / 2) + 1;
+        reading.side = (position % 2) + 1;
+        reading.proximity = proximity[position];
+        reading.ambient = ambient[position];
+    }
+};
+
+#if SENSOR_SKEW_OFFSETS
+static_assert(SENSOR_MAX_BOARDS != 3 || sizeof(SensorFrame) == 44, "SensorFrame layout changed");
+#else
+static_assert(SENSOR_MAX_BOARDS != 3 || sizeof(SensorFrame) == 32, "SensorFrame is one cache line");
+#endif
+
+#endif
@@ -1,18 +1,47 @@
 #include "SensorManager.h"
 #include "../session/SessionManager.h" // For SessionSummary full definition
+#include "../diagnostics/CycleProfiler.h"
+#include "pin_config.h"
 
 extern bool serialStudioEnabled;
 
+// PS_CONF3 bits for active force mode
+static const uint8_t PS_CONF3_AF = 0x08;   // Convert only on trigger
+static const uint8_t PS_CONF3_TRIG = 0x04; // Trigger one conversion (self-clearing)
+
+// A Wire1 plan that outlived its cycle gets this long to finish before
+// cycleRxBuffer, the plans or Wire1 are used again (every op has its own
+// driver timeout, so it does finish)
+static const uint32_t BUS_WORKER_JOIN_MS = 1000;
+
 SensorManager::SensorManager() : mux(0x70)
 {
-    // Constructor
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+        sensorMapping[i] = {(uint8_t)(i / SENSORS_PER_BOARD), (uint8_t)(i % SENSORS_PER_BOARD)};
+
+#if PIN_IIC1_SDA >= 0
+    // Boards past the end of SENSOR_BOARD_BUS stay on Wire behind the TCA
+    const uint8_t busMap[] = SENSOR_BOARD_BUS;
+    for (size_t board = 0; board < sizeof(busMap) && board < SENSOR_MAX_BOARDS; board++)
+    {
+        boardBus[board] = busMap[board] ? 1 : 0;
+        dualBus |= boardBus[board] != 0;
+    }
+#endif
+
+    // Strapped addresses 0x74.. (what a Wire1 board must use; boards behind
+    // the TCA are rescanned by initializePCA())
+    for (uint8_t board = 0; board < SENSOR_MAX_BOARDS; board++)
+        pca_instances[board] = PCA9546A(0x74 + board % 4, &wireFor(board));
 }
 
 void SensorManager::cleanupI2CBus()
 {
     // Disable all multiplexer channels to release the I2C bus
     // IMPORTANT: Must select each TCA channel before disabling its PCA!
-    for (int i = 0; i < 3; i++)
+    // Cache is dropped first so every write really goes out on the bus.
+    invalidateMuxCache();
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
     {
         mux.selectChannel(i);
         delay(2);
@@ -43,8 +72,10 @@ bool SensorManager::calibrateSensorBaseline(uint8_t sensorIndex)
     uint8_t tca_ch = sensorMapping[sensorIndex].tca_channel;
     uint8_t pca_ch = sensorMapping[sensorIndex].pca_channel;
 
+    TwoWire &bus = wireFor(tca_ch);
+
     // Select TCA channel for this sensor board
-    if (!mux.selectChannel(tca_ch))
+    if (!selectBoard(tca_ch))
     {
         Serial.printf("  Calibration: Failed to select TCA channel %d\n", tca_ch);
         return false;
@@ -68,16 +99,16 @@ bool SensorManager::calibrateSensorBaseline(uint8_t sensorIndex)
     for (int i = 0; i < NUM_SAMPLES; i++)
     {
         // Read proximity directly via I2C
-        Wire.beginTransmission(0x60);
-        Wire.write(0x08); // PS_DATA register
-        if (Wire.endTransmission(false) != 0)
+        bus.beginTransmission(0x60);
+        bus.write(0x08); // PS_DATA register
+        if (bus.endTransmission(false) != 0)
             continue;
 
-        Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-        if (Wire.available() >= 2)
+        bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+        if (bus.available() >= 2)
         {
-            uint8_t prox_low = Wire.read();
-            uint8_t prox_high = Wire.read();
+            uint8_t prox_low = bus.read();
+            uint8_t prox_high = bus.read();
             uint16_t proximity = (prox_high << 8) | prox_low;
             sum += proximity;
             validSamples++;
@@ -95,38 +126,130 @@ bool SensorManager::calibrateSensorBaseline(uint8_t sensorIndex)
     uint16_t baseline = sum / validSamples;
     baselineValues[sensorIndex] = baseline;
 
+    if (!writeCancellation(bus, baseline))
+        return false;
+
+    cancellationMask |= (1 << sensorIndex);
+    return true;
+}
+
+bool SensorManager::writeCancellation(TwoWire &bus, uint16_t value, bool verify)
+{
     // Write to PS_CANC register (0x05) - this value is subtracted from all readings
-    Wire.beginTransmission(0x60);
-    Wire.write(0x05);                   // PS_CANC register
-    Wire.write(baseline & 0xFF);        // Low byte
-    Wire.write((baseline >> 8) & 0xFF); // High byte
-    uint8_t err = Wire.endTransmission();
+    bus.beginTransmission(0x60);
+    bus.write(0x05);                // PS_CANC register
+    bus.write(value & 0xFF);        // Low byte
+    bus.write((value >> 8) & 0xFF); // High byte
+    uint8_t err = bus.endTransmission();
 
     if (err != 0)
     {
         Serial.printf("  Calibration: Failed to write PS_CANC (I2C error %d)\n", err);
         return false;
     }
+    if (!verify)
+        return true;
 
     // Verify by reading back
     delay(5);
-    Wire.beginTransmission(0x60);
-    Wire.write(0x05);
-    Wire.endTransmission(false);
-    Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-    uint8_t verify_low = Wire.available() ? Wire.read() : 0xFF;
-    uint8_t verify_high = Wire.available() ? Wire.read() : 0xFF;
+    bus.beginTransmission(0x60);
+    bus.write(0x05);
+    bus.endTransmission(false);
+    bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+    uint8_t verify_low = bus.available() ? bus.read() : 0xFF;
+    uint8_t verify_high = bus.available() ? bus.read() : 0xFF;
     uint16_t verify_value = (verify_high << 8) | verify_low;
 
-    if (verify_value != baseline)
+    if (verify_value != value)
     {
-        Serial.printf("  Calibration: PS_CANC verify failed (wrote %d, read %d)\n", baseline, verify_value);
+        Serial.printf("  Calibration: PS_CANC verify failed (wrote %d, read %d)\n", value, verify_value);
         return false;
     }
 
     return true;
 }
 
+bool SensorManager::adjustCancellation(uint8_t sensorIndex, uint16_t value)
+{
+    if (sensorIndex >= NUM_SENSORS || !sensorsActive[sensorIndex])
+        return false;
+
+    if (isCollecting())
+    {
+        // Value first: the mask publishes it to the sensor task
+        pendingCancellation[sensorIndex] = value;
+        __atomic_fetch_or(&cancellationPending, (SensorMask)(1 << sensorIndex), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    uint8_t tca_ch = sensorMapping[sensorIndex].tca_channel;
+    bool ok = selectBoard(tca_ch) && pca_instances[tca_ch].selectChannel(sensorMapping[sensorIndex].pca_channel) &&
+              writeCancellation(wireFor(tca_ch), value);
+    invalidateMuxCache();
+    if (ok)
+    {
+        baselineValues[sensorIndex] = value;
+        cancellationMask |= (1 << sensorIndex);
+    }
+    return ok;
+}
+
+void SensorManager::applyPendingCancellation()
+{
+    // Sensor task, between cycles: the bus is ours. No read-back: its
+    // settle delay would stall the next cycle.
+    SensorMask pending = __atomic_exchange_n(&cancellationPending, (SensorMask)0, __ATOMIC_ACQUIRE);
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!(pending & (1 << i)))
+            continue;
+        uint8_t tca_ch = sensorMapping[i].tca_channel;
+        if (selectBoard(tca_ch) && pca_instances[tca_ch].selectChannel(sensorMapping[i].pca_channel) &&
+            writeCancellation(wireFor(tca_ch), pendingCancellation[i], false))
+        {
+            baselineValues[i] = pendingCancellation[i];
+            cancellationMask |= (1 << i);
+        }
+    }
+    invalidateMuxCache();
+}
+
+bool SensorManager::restoreProximityCancellation(const uint16_t *values, SensorMask mask)
+{
+    if (isCollecting())
+        return false;
+
+    int restored = 0;
+    int failed = 0;
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!(mask & (1 << i)) || !sensorsActive[i])
+            continue;
+
+        uint8_t tca_ch = sensorMapping[i].tca_channel;
+        if (!selectBoard(tca_ch) || !pca_instances[tca_ch].selectChannel(sensorMapping[i].pca_channel) ||
+            !writeCancellation(wireFor(tca_ch), values[i]))
+        {
+            failed++;
+            continue;
+        }
+
+        baselineValues[i] = values[i];
+        cancellationMask |= (1 << i);
+        restored++;
+    }
+
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
+    {
+        mux.selectChannel(i);
+        pca_instances[i].disableAllChannels();
+    }
+    mux.disableAllChannels();
+
+    Serial.printf("PS_CANC restored for %d sensors (%d failed)\n", restored, failed);
+    return failed == 0;
+}
+
 bool SensorManager::calibrateProximityCancellation()
 {
     Serial.println("\n");
@@ -173,7 +296,7 @@ bool SensorManager::calibrateProximityCancellation()
     }
 
     // Clean up multiplexer channels
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
     {
         mux.selectChannel(i);
         delay(2);
@@ -191,7 +314,7 @@ bool SensorManager::calibrateProximityCancellation()
     return (failedCount == 0 && calibratedCount > 0);
 }
 
-uint16_t SensorManager::getBaselineValue(uint8_t sensorIndex)
+uint16_t SensorManager::getBaselineValue(uint8_t sensorIndex) const
 {
     if (sensorIndex >= NUM_SENSORS)
         return 0;
@@ -273,6 +396,8 @@ bool SensorManager::applySensorConfig(uint8_t sensorIndex)
     if (sensorIndex >= NUM_SENSORS || activeConfig == nullptr)
         return false;
 
+    TwoWire &bus = wireFor(sensorMapping[sensorIndex].tca_channel);
+
     // Parse configuration values
     VCNL4040_LEDCurrent led = parseLEDCurrent(activeConfig->led_current);
     VCNL4040_ProximityIntegration integration = parseIntegrationTime(activeConfig->integration_time);
@@ -289,33 +414,29 @@ bool SensorManager::applySensorConfig(uint8_t sensorIndex)
     // Using SparkFun-style approach: write full register values directly
     // ========================================================================
 
+    ProximityRegisters regs = registersFor(*activeConfig);
+
     // Step 1: Configure PS_CONF1/2 register (0x03)
-    // PS_CONF1 (low byte): bits 7:6 = PS_Duty, bits 3:1 = PS_IT, bit 0 = PS_SD
-    // PS_CONF2 (high byte): bit 3 = PS_HD
-    uint8_t ps_conf1 = ((duty & 0x03) << 6) |        // PS_Duty in bits 7:6
-                       ((integration & 0x07) << 1) | // PS_IT in bits 3:1
-                       0x00;                         // PS_SD = 0 (proximity enabled)
-    uint8_t ps_conf2 = (highRes ? 0x08 : 0x00);      // PS_HD in bit 3
+    uint8_t ps_conf1 = regs.conf1;
+    uint8_t ps_conf2 = regs.conf2;
 
-    Wire.beginTransmission(0x60);
-    Wire.write(0x03);
-    Wire.write(ps_conf1);
-    Wire.write(ps_conf2);
-    uint8_t err1 = Wire.endTransmission();
+    bus.beginTransmission(0x60);
+    bus.write(0x03);
+    bus.write(ps_conf1);
+    bus.write(ps_conf2);
+    uint8_t err1 = bus.endTransmission();
 
     delayMicroseconds(500); // Allow register to settle
 
     // Step 2: Configure PS_CONF3/PS_MS register (0x04)
-    // PS_CONF3 (low byte): bits 6:5 = PS_MPS (multi-pulse), other bits default off
-    // PS_MS (high byte): bits 2:0 = LED_I
-    uint8_t ps_conf3 = (multiPulse & 0x03) << 5; // PS_MPS in bits 6:5 (1, 2, 4, or 8 pulses)
-    uint8_t ps_ms = (led & 0x07);                // LED_I in bits 2:0, White channel enabled (bit 7 = 0)
+    uint8_t ps_conf3 = regs.conf3;
+    uint8_t ps_ms = regs.ms;
 
-    Wire.beginTransmission(0x60);
-    Wire.write(0x04);
-    Wire.write(ps_conf3);
-    Wire.write(ps_ms);
-    uint8_t err2 = Wire.endTransmission();
+    bus.beginTransmission(0x60);
+    bus.write(0x04);
+    bus.write(ps_conf3);
+    bus.write(ps_ms);
+    uint8_t err2 = bus.endTransmission();
 
     Serial.printf("  Write: PS_CONF1/2=0x%02X%02X (err:%d), PS_CONF3/MS=0x%02X%02X (err:%d)\n",
                   ps_conf2, ps_conf1, err1, ps_ms, ps_conf3, err2);
@@ -324,12 +445,12 @@ bool SensorManager::applySensorConfig(uint8_t sensorIndex)
     delay(10);
 
     // Read PS_CONF3/PS_MS (0x04)
-    Wire.beginTransmission(0x60);
-    Wire.write(0x04);
-    Wire.endTransmission(false);
-    Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-    uint8_t verify_low = Wire.available() ? Wire.read() : 0xFF;
-    uint8_t verify_high = Wire.available() ? Wire.read() : 0xFF;
+    bus.beginTransmission(0x60);
+    bus.write(0x04);
+    bus.endTransmission(false);
+    bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+    uint8_t verify_low = bus.available() ? bus.read() : 0xFF;
+    uint8_t verify_high = bus.available() ? bus.read() : 0xFF;
 
     uint8_t actual_led = verify_high & 0x07;
     const char *led_ma[] = {"50mA", "75mA", "100mA", "120mA", "140mA", "160mA", "180mA", "200mA"};
@@ -346,21 +467,21 @@ bool SensorManager::applySensorConfig(uint8_t sensorIndex)
         Serial.println("  Retrying LED current write...");
         delay(50);
 
-        Wire.beginTransmission(0x60);
-        Wire.write(0x04);
-        Wire.write(ps_conf3);
-        Wire.write(ps_ms);
-        uint8_t err_retry = Wire.endTransmission();
+        bus.beginTransmission(0x60);
+        bus.write(0x04);
+        bus.write(ps_conf3);
+        bus.write(ps_ms);
+        uint8_t err_retry = bus.endTransmission();
 
         delay(20);
 
         // Verify again
-        Wire.beginTransmission(0x60);
-        Wire.write(0x04);
-        Wire.endTransmission(false);
-        Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-        verify_low = Wire.available() ? Wire.read() : 0xFF;
-        verify_high = Wire.available() ? Wire.read() : 0xFF;
+        bus.beginTransmission(0x60);
+        bus.write(0x04);
+        bus.endTransmission(false);
+        bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+        verify_low = bus.available() ? bus.read() : 0xFF;
+        verify_high = bus.available() ? bus.read() : 0xFF;
         actual_led = verify_high & 0x07;
 
         Serial.printf("  Retry result: err=%d, LED_I=%d (%s)\n",
@@ -371,7 +492,37 @@ bool SensorManager::applySensorConfig(uint8_t sensorIndex)
         Serial.printf("  ✓ LED verified: %s\n", led_ma[actual_led]);
     }
 
-    return (err1 == 0 && err2 == 0);
+    // reconfigure() diffs against this
+    bool ok = (err1 == 0 && err2 == 0);
+    if (ok)
+    {
+        appliedRegisters = regs;
+        registersKnownMask |= 1 << sensorIndex;
+    }
+    else
+    {
+        registersKnownMask &= ~(1 << sensorIndex);
+    }
+    return ok;
+}
+
+SensorManager::ProximityRegisters SensorManager::registersFor(const SensorConfiguration &config)
+{
+    VCNL4040_LEDCurrent led = parseLEDCurrent(config.led_current);
+    VCNL4040_ProximityIntegration integration = parseIntegrationTime(config.integration_time);
+    VCNL4040_LEDDutyCycle duty = parseDutyCycle(config.duty_cycle);
+    uint8_t multiPulse = parseMultiPulse(config.multi_pulse);
+
+    ProximityRegisters regs;
+    // PS_CONF1 (low byte): bits 7:6 = PS_Duty, bits 3:1 = PS_IT, bit 0 = PS_SD (0 = proximity enabled)
+    // PS_CONF2 (high byte): bit 3 = PS_HD
+    regs.conf1 = ((duty & 0x03) << 6) | ((integration & 0x07) << 1);
+    regs.conf2 = config.high_resolution ? 0x08 : 0x00;
+    // PS_CONF3 (low byte): bits 6:5 = PS_MPS (1, 2, 4, or 8 pulses), other bits default off
+    // PS_MS (high byte): bits 2:0 = LED_I, White channel enabled (bit 7 = 0)
+    regs.conf3 = (multiPulse & 0x03) << 5;
+    regs.ms = led & 0x07;
+    return regs;
 }
 
 void SensorManager::debugI2CScan()
@@ -559,32 +710,47 @@ bool SensorManager::initializePCA()
     Serial.println("Scanning for PCA9546A multiplexers on TCA channels...");
 
     int pca_found_count = 0;
+    boardMask = 0;
 
-    // Scan all 3 TCA channels for sensor boards
-    for (int tca_ch = 0; tca_ch < 3; tca_ch++)
+    // Scan every TCA channel the capacity allows: the boards that answer
+    // are the topology (sensor table, scan order and cycle plan follow it)
+    for (int tca_ch = 0; tca_ch < SENSOR_MAX_BOARDS; tca_ch++)
     {
-        Serial.print("  Scanning TCA channel ");
-        Serial.println(tca_ch);
+        // Try common PCA9546A addresses
+        uint8_t test_addresses[] = {0x74, 0x75, 0x76, 0x72, 0x71, 0x73, 0x77};
+        int test_count = 7;
 
-        // Select TCA channel
-        if (!mux.selectChannel(tca_ch))
+        if (boardBus[tca_ch] == 1)
         {
-            Serial.println("    ERROR: Failed to select TCA channel");
-            continue;
+            // Boards share Wire1 directly, so a scan would find the other
+            // boards' PCAs too - only this board's strapped address counts
+            Serial.printf("  Probing bus 1 for board %d\n", tca_ch + 1);
+            test_addresses[0] = 0x74 + tca_ch % 4;
+            test_count = 1;
         }
+        else
+        {
+            Serial.print("  Scanning TCA channel ");
+            Serial.println(tca_ch);
 
-        delay(10);
+            // Select TCA channel
+            if (!mux.selectChannel(tca_ch))
+            {
+                Serial.println("    ERROR: Failed to select TCA channel");
+                continue;
+            }
+
+            delay(10);
+        }
 
-        // Try common PCA9546A addresses
-        uint8_t test_addresses[] = {0x74, 0x75, 0x76, 0x72, 0x71, 0x73, 0x77};
         bool pca_found = false;
         uint8_t working_address = 0;
 
-        for (int i = 0; i < 7; i++)
+        for (int i = 0; i < test_count; i++)
         {
             uint8_t test_addr = test_addresses[i];
 
-            PCA9546A test_pca(test_addr);
+            PCA9546A test_pca(test_addr, &wireFor(tca_ch));
             if (test_pca.begin())
             {
                 Serial.print("    PCA9546A found at 0x");
@@ -600,8 +766,9 @@ bool SensorManager::initializePCA()
         {
             // Update PCA instance for this TCA channel
             pca_addresses[tca_ch] = working_address;
-            pca_instances[tca_ch] = PCA9546A(working_address);
+            pca_instances[tca_ch] = PCA9546A(working_address, &wireFor(tca_ch));
             pca_instances[tca_ch].disableAllChannels();
+            boardMask |= 1 << tca_ch;
             pca_found_count++;
         }
         else
@@ -612,9 +779,8 @@ bool SensorManager::initializePCA()
 
     mux.disableAllChannels();
 
-    Serial.print("Found ");
-    Serial.print(pca_found_count);
-    Serial.println(" sensor board(s)");
+    Serial.printf("Found %d sensor board(s) (mask 0x%02X, capacity %d)\n", pca_found_count, boardMask,
+                  SENSOR_MAX_BOARDS);
 
     if (pca_found_count == 0)
     {
@@ -637,6 +803,19 @@ bool SensorManager::init(SensorConfiguration *config)
     Wire.setClock(400000); // 400 kHz (Fast Mode) - set BEFORE sensor initialization
     Serial.println("I2C clock set to 400 kHz");
 
+    if (dualBus)
+    {
+        Wire1.begin(PIN_IIC1_SDA, PIN_IIC1_SCL);
+        Wire1.setClock(400000);
+        Serial.printf("I2C bus 1 on SDA=%d SCL=%d (boards:", PIN_IIC1_SDA, PIN_IIC1_SCL);
+        for (int board = 0; board < SENSOR_MAX_BOARDS; board++)
+        {
+            if (boardBus[board])
+                Serial.printf(" P%d", board + 1);
+        }
+        Serial.println(")");
+    }
+
     if (activeConfig != nullptr)
     {
         Serial.println("Configuration:");
@@ -647,13 +826,23 @@ bool SensorManager::init(SensorConfiguration *config)
         Serial.printf("  Read Ambient: %s\n", activeConfig->read_ambient ? "enabled" : "disabled");
     }
 
-    // Initialize TCA9548A multiplexer
+    // Initialize TCA9548A multiplexer (only boards on Wire sit behind it)
+    bool anyBoardOnMux = false;
+    for (int board = 0; board < SENSOR_MAX_BOARDS; board++)
+        anyBoardOnMux |= boardBus[board] == 0;
     if (!mux.begin())
     {
-        Serial.println("ERROR: Failed to initialize TCA9548A");
-        return false;
+        if (anyBoardOnMux)
+        {
+            Serial.println("ERROR: Failed to initialize TCA9548A");
+            return false;
+        }
+        Serial.println("TCA9548A not found (all boards on bus 1)");
+    }
+    else
+    {
+        Serial.println("TCA9548A initialized");
     }
-    Serial.println("TCA9548A initialized");
 
 #if STARTUP_I2C_SCAN
     debugI2CScan();
@@ -692,8 +881,10 @@ bool SensorManager::init(SensorConfiguration *config)
             continue;
         }
 
+        TwoWire &bus = wireFor(tca_ch);
+
         // Select TCA channel for this sensor board
-        if (!mux.selectChannel(tca_ch))
+        if (!selectBoard(tca_ch))
         {
             Serial.println("  ERROR: Failed to select TCA channel");
             sensorsActive[i] = false;
@@ -713,8 +904,8 @@ bool SensorManager::init(SensorConfiguration *config)
         delay(5);
 
         // Check if VCNL4040 responds at standard address 0x60
-        Wire.beginTransmission(0x60);
-        byte error = Wire.endTransmission();
+        bus.beginTransmission(0x60);
+        byte error = bus.endTransmission();
         if (error != 0)
         {
             Serial.print("  ERROR: No VCNL4040 at 0x60 (I2C error: ");
@@ -728,15 +919,15 @@ bool SensorManager::init(SensorConfiguration *config)
         // The Adafruit library's begin() and subsequent calls were resetting our config!
 
         // Read device ID to verify sensor is present
-        Wire.beginTransmission(0x60);
-        Wire.write(0x0C); // Device ID register
-        Wire.endTransmission(false);
-        Wire.requestFrom(0x60, 2);
+        bus.beginTransmission(0x60);
+        bus.write(0x0C); // Device ID register
+        bus.endTransmission(false);
+        bus.requestFrom(0x60, 2);
 
-        if (Wire.available() >= 2)
+        if (bus.available() >= 2)
         {
-            uint8_t id_low = Wire.read();
-            uint8_t id_high = Wire.read();
+            uint8_t id_low = bus.read();
+            uint8_t id_high = bus.read();
             uint16_t device_id = (id_high << 8) | id_low;
 
             if (device_id != 0x0186)
@@ -763,18 +954,18 @@ bool SensorManager::init(SensorConfiguration *config)
         {
             // Default configuration - direct I2C write
             // PS_CONF1/2: Enable proximity, 1T integration, 1/40 duty, high res
-            Wire.beginTransmission(0x60);
-            Wire.write(0x03);
-            Wire.write(0x00); // PS_CONF1: PS_IT=0 (1T), PS_Duty=0 (1/40), PS_SD=0 (enabled)
-            Wire.write(0x08); // PS_CONF2: PS_HD=1 (high res)
-            Wire.endTransmission();
+            bus.beginTransmission(0x60);
+            bus.write(0x03);
+            bus.write(0x00); // PS_CONF1: PS_IT=0 (1T), PS_Duty=0 (1/40), PS_SD=0 (enabled)
+            bus.write(0x08); // PS_CONF2: PS_HD=1 (high res)
+            bus.endTransmission();
 
             // PS_MS: 200mA LED current
-            Wire.beginTransmission(0x60);
-            Wire.write(0x04);
-            Wire.write(0x00); // PS_MS low
-            Wire.write(0x07); // PS_MS high: LED_I=7 (200mA)
-            Wire.endTransmission();
+            bus.beginTransmission(0x60);
+            bus.write(0x04);
+            bus.write(0x00); // PS_MS low
+            bus.write(0x07); // PS_MS high: LED_I=7 (200mA)
+            bus.endTransmission();
 
             Serial.println("  Applied default config (200mA, 1T, 1/40, HighRes)");
         }
@@ -786,7 +977,7 @@ bool SensorManager::init(SensorConfiguration *config)
 
     // Clean up - disable all channels
     // IMPORTANT: Must select each TCA channel before disabling its PCA!
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
     {
         mux.selectChannel(i);
         delay(2);
@@ -820,6 +1011,31 @@ bool SensorManager::init(SensorConfiguration *config)
     return true;
 }
 
+bool SensorManager::selectSensor(uint8_t sensorIndex)
+{
+    uint8_t tca_ch = sensorMapping[sensorIndex].tca_channel;
+    uint8_t pca_ch = sensorMapping[sensorIndex].pca_channel;
+
+    // Select TCA channel for this sensor board, then the PCA channel on it
+    return selectBoard(tca_ch) && pca_instances[tca_ch].selectChannel(pca_ch);
+}
+
+bool SensorManager::selectBoard(uint8_t board)
+{
+    if (boardBus[board] == 0)
+        return mux.selectChannel(board);
+
+    // Wire1 has no TCA: every other board's PCA on it must be closed so
+    // only this board's sensors answer at 0x60 (cached, usually no writes)
+    bool ok = true;
+    for (uint8_t other = 0; other < SENSOR_MAX_BOARDS; other++)
+    {
+        if (other != board && boardBus[other] == 1 && pca_addresses[other] != 0)
+            ok &= pca_instances[other].disableAllChannels();
+    }
+    return ok;
+}
+
 bool SensorManager::readSensor(uint8_t sensorIndex, SensorReading &reading)
 {
     if (sensorIndex >= NUM_SENSORS)
@@ -829,16 +1045,11 @@ bool SensorManager::readSensor(uint8_t sensorIndex, SensorReading &reading)
     if (!sensorsActive[sensorIndex])
         return false;
 
-    uint8_t tca_ch = sensorMapping[sensorIndex].tca_channel;
-    uint8_t pca_ch = sensorMapping[sensorIndex].pca_channel;
-
-    // Select TCA channel for this sensor board
-    if (!mux.selectChannel(tca_ch))
-        return false;
-
-    // Select PCA channel on the sensor board
-    if (!pca_instances[tca_ch].selectChannel(pca_ch))
-        return false;
+    {
+        PROFILE_SCOPE(ProfileSpan::MUX_SELECT);
+        if (!selectSensor(sensorIndex))
+            return false;
+    }
 
     reading.timestamp_us = micros();
     reading.position = sensorIndex;
@@ -850,218 +1061,959 @@ bool SensorManager::readSensor(uint8_t sensorIndex, SensorReading &reading)
     // Position 0,2,4 -> Side 1 (S1); Position 1,3,5 -> Side 2 (S2)
     reading.side = (sensorIndex % 2) + 1; // 0,2,4->1  1,3,5->2
 
-    // Read proximity directly via I2C (bypass Adafruit library to avoid config conflicts)
-    Wire.beginTransmission(0x60);
-    Wire.write(0x08); // PS_DATA register
-    Wire.endTransmission(false);
-    Wire.requestFrom(0x60, 2);
-
-    if (Wire.available() >= 2)
+    // Read proximity (and ambient unless disabled for speed) directly via I2C,
+    // bypassing the Adafruit library to avoid config conflicts.
+    // VCNL4040 has no register auto-increment, so PS_DATA (0x08) and ALS_DATA
+    // (0x09) are fused into ONE transaction: the second read follows a
+    // repeated START instead of STOP + new START, and both share one driver
+    // call and one error path.
+    bool readAmbient = (activeConfig == nullptr || activeConfig->read_ambient);
+    uint8_t raw[4] = {0};
+
+    uint32_t readStart = micros();
+    esp_err_t err;
     {
-        uint8_t prox_low = Wire.read();
-        uint8_t prox_high = Wire.read();
-        reading.proximity = (prox_high << 8) | prox_low;
+        PROFILE_SCOPE(ProfileSpan::PS_ALS_READ);
+        err = I2CTransactionEngine::readRegisters(portFor(sensorMapping[sensorIndex].tca_channel), 0x60,
+                                                  0x08, &raw[0],
+                                                  0x09, readAmbient ? &raw[2] : nullptr);
     }
-    else
+    lastReadLatencyUs = micros() - readStart;
+
+    if (err != ESP_OK)
     {
+        // Bus state unknown after an aborted transaction - force re-select
+        invalidateMuxCache();
         reading.proximity = 0;
+        reading.ambient = 0;
+        return false;
+    }
+
+    reading.proximity = (raw[1] << 8) | raw[0];
+    reading.ambient = readAmbient ? ((raw[3] << 8) | raw[2]) : 0; // 0 = not read
+
+    return true;
+}
+
+// ============================================================================
+// Bus Health
+// The sensor task reports every read to busHealth (I2CBusHealth.h) and acts
+// on its verdicts between cycles: quarantined sensors and buses in fault
+// leave the queued plans, a bus that stopped answering is cleared and
+// restarted here, and sensors coming back get their registers rewritten
+// (an outage is often a board that lost power).
+// ============================================================================
+
+// Write a mux control register and read it back
+static bool writeVerifyMask(TwoWire &wire, uint8_t address, uint8_t mask)
+{
+    wire.beginTransmission(address);
+    wire.write(mask);
+    if (wire.endTransmission() != 0)
+        return false;
+    return wire.requestFrom(address, (uint8_t)1) == 1 && wire.read() == mask;
+}
+
+bool SensorManager::recoverBus(uint8_t bus)
+{
+    TwoWire &wire = bus == 0 ? Wire : Wire1;
+    int sda = bus == 0 ? PIN_IIC_SDA : PIN_IIC1_SDA;
+    int scl = bus == 0 ? PIN_IIC_SCL : PIN_IIC1_SCL;
+    if (sda < 0 || scl < 0)
+        return false;
+
+    uint32_t start = micros();
+    wire.end();
+    I2CRecoveryResult result = I2CBusHealth::clearBus(sda, scl);
+    wire.begin(sda, scl);
+    wire.setClock(400000);
+    bool ok = result.released && verifyMuxState(bus);
+    uint32_t durationUs = micros() - start;
+
+    busHealth.recordRecovery(bus, result, ok, durationUs, millis());
+    if (activeSummary)
+    {
+        if (ok)
+            activeSummary->bus_recoveries++;
+        else
+            activeSummary->bus_recovery_failures++;
     }
+    if (!serialStudioEnabled)
+        Serial.printf("I2C bus %d recovery %s in %lu us (SDA %s, SCL %s, %d pulses)\n", bus,
+                      ok ? "succeeded" : "failed", (unsigned long)durationUs, result.sdaStuck ? "stuck" : "ok",
+                      result.sclStuck ? "stuck" : "ok", result.pulses);
+
+    if (ok)
+        restoreSensors(busSensors[bus]);
+    return ok;
+}
 
-    // Conditionally read ambient light (skip if disabled for speed)
-    if (activeConfig != nullptr && !activeConfig->read_ambient)
+bool SensorManager::verifyMuxState(uint8_t bus)
+{
+    const uint8_t TCA_ADDR = 0x70;
+
+    // Nothing the caches remember survives a bus clear: close every PCA
+    // (through its TCA channel on Wire) and check what the chip holds
+    invalidateMuxCache();
+    TwoWire &wire = bus == 0 ? Wire : Wire1;
+    bool ok = true;
+    bool anyBoard = false;
+    for (uint8_t board = 0; board < SENSOR_MAX_BOARDS; board++)
     {
-        reading.ambient = 0; // Mark as not read
+        if (boardBus[board] != bus || pca_addresses[board] == 0)
+            continue;
+        anyBoard = true;
+        if (bus == 0)
+            ok &= writeVerifyMask(wire, TCA_ADDR, 1 << board);
+        ok &= writeVerifyMask(wire, pca_addresses[board], 0x00);
     }
-    else
+    if (bus == 0 && anyBoard)
+        ok &= writeVerifyMask(wire, TCA_ADDR, 0x00);
+    invalidateMuxCache();
+    return ok;
+}
+
+void SensorManager::restoreSensors(SensorMask sensors)
+{
+    // Sensor task, between cycles. Hybrid collections rewrite PS_CONF1/2 at
+    // the next idle / burst switch; their registers are left alone here.
+    if (registersKnownMask != 0 && !hybridMode)
     {
-        // Read ambient light directly via I2C
-        Wire.beginTransmission(0x60);
-        Wire.write(0x09); // ALS_DATA register
-        Wire.endTransmission(false);
-        Wire.requestFrom(0x60, 2);
+        registersKnownMask &= ~sensors;
+        writeRegisterDelta(appliedRegisters);
+    }
 
-        if (Wire.available() >= 2)
-        {
-            uint8_t als_low = Wire.read();
-            uint8_t als_high = Wire.read();
-            reading.ambient = (als_high << 8) | als_low;
-        }
-        else
+    for (uint8_t i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!(sensors & (1 << i)) || !sensorsActive[i] || !selectSensor(i))
+            continue;
+        TwoWire &bus = wireFor(sensorMapping[i].tca_channel);
+        if (activeForce)
         {
-            reading.ambient = 0;
+            bus.beginTransmission(0x60);
+            bus.write(0x04);
+            bus.write(afConf3);
+            bus.write(afPsMs);
+            bus.endTransmission();
         }
+        if (cancellationMask & (1 << i))
+            writeCancellation(bus, baselineValues[i], false);
     }
-
-    return true;
+    invalidateMuxCache();
 }
 
-void SensorManager::sensorTaskFunction(void *parameter)
-{
-    SensorManager *manager = (SensorManager *)parameter;
+// ============================================================================
+// I2C Cycle Engine
+// The whole polling cycle (TCA selects, PCA selects, PS/ALS reads) is
+// built once into a static IDF command list and replayed each sample. One
+// driver call per cycle instead of ~20, and the sensor task sleeps on the
+// driver's completion event rather than spinning in Wire/delayMicroseconds.
+// ============================================================================
 
-    if (!serialStudioEnabled)
-        Serial.println("Sensor task started on Core 0");
+bool SensorManager::buildCyclePlan()
+{
+    // The worker may still be replaying the old Wire1 plan
+    if (!joinBusWorker(pdMS_TO_TICKS(BUS_WORKER_JOIN_MS)))
+        return false;
 
-    unsigned long lastSampleTime = micros();
-    unsigned long lastErrorLog = 0;
-    int consecutiveFailures = 0;
-    SensorReading reading;
-    unsigned long lastYield = micros();
+    cycleReadsAmbient = (activeConfig == nullptr || activeConfig->read_ambient);
 
-    while (!manager->stopRequested) // Check stop flag instead of infinite loop
-    {
-        unsigned long currentTime = micros();
+    if (!buildPlan(cycleEngines, false))
+        return false;
 
-        // Check if it's time for next sample
-        if (currentTime - lastSampleTime >= SAMPLE_INTERVAL_US)
-        {
-            lastSampleTime = currentTime;
+    // Active force: the trigger round is a second plan with the same selects.
+    // Without it the triggers go out per sensor over Wire.
+    if (activeForce && !buildPlan(triggerEngines, true))
+        Serial.println("WARNING: Active force trigger plan unavailable, triggering per sensor");
 
-            // Capture timestamp ONCE for all sensors in this cycle
-            // This ensures all sensors from the same sample have the same timestamp
-            // ⚠️ IMPORTANT: This synchronized timestamping requires the backend to use
-            // a composite key. See: infrastructure/DATABASE_SCHEMA.md for details.
-            unsigned long cycleTimestamp = micros();
+    return true;
+}
 
-            int successfulReads = 0;
-            int failedReads = 0;
+bool SensorManager::buildPlan(I2CTransactionEngine *plans, bool trigger)
+{
+    const uint8_t VCNL4040_ADDR = 0x60;
+    const uint8_t TCA_ADDR = 0x70;
 
-            // Session Confirmation: count this cycle
-            if (manager->activeSummary)
+    bool anyBoard = false;
+    for (int bus = 0; bus < SENSOR_I2C_BUSES; bus++)
+    {
+        I2CTransactionEngine &engine = plans[bus];
+        engine.beginPlan();
+        cycleBusUsed[bus] = false;
+        planSlotCount[bus] = 0;
+
+        // Boards with no active sensors are never selected. Quarantined
+        // sensors and down buses (planExcluded) are left out.
+        bool boardUsed[SENSOR_MAX_BOARDS] = {false};
+        int boardsOnBus = 0;
+        for (int board = 0; board < SENSOR_MAX_BOARDS; board++)
+        {
+            if (boardBus[board] != bus || pca_addresses[board] == 0)
+                continue;
+            for (int i = 0; i < NUM_SENSORS; i++)
             {
-                manager->activeSummary->total_cycles++;
+                if (sensorMapping[i].tca_channel == board && sensorsActive[i] && !(planExcluded & (1 << i)))
+                    boardUsed[board] = true;
             }
+            if (boardUsed[board])
+                boardsOnBus++;
+        }
+
+        for (int board = 0; board < SENSOR_MAX_BOARDS; board++)
+        {
+            if (!boardUsed[board])
+                continue;
+
+            if (bus == 0 && !engine.addWrite(TCA_ADDR, 1 << board))
+                return false;
 
-            // Read all active sensors (REVERSED for timing test - normally 0 to NUM_SENSORS)
+            // Same reverse order as the Wire path (S2 before S1)
             for (int i = NUM_SENSORS - 1; i >= 0; i--)
             {
-                // Check stop flag between sensor reads for faster response
-                if (manager->stopRequested)
-                    break;
-
-                // Skip inactive sensors
-                if (!manager->sensorsActive[i])
+                if (sensorMapping[i].tca_channel != board || !sensorsActive[i] || (planExcluded & (1 << i)))
                     continue;
 
-                if (manager->readSensor(i, reading))
-                {
-                    // Override timestamp with cycle timestamp for synchronization
-                    reading.timestamp_us = cycleTimestamp;
-
-                    // Send to queue (non-blocking)
-                    if (xQueueSend(manager->dataQueue, &reading, 0) == pdTRUE)
-                    {
-                        successfulReads++;
-                        // Session Confirmation: count successful read + queue
-                        if (manager->activeSummary)
-                        {
-                            manager->activeSummary->readings_collected[i]++;
-                        }
-                    }
-                    else
-                    {
-                        // Queue full - data lost
-                        if (manager->activeSummary)
-                        {
-                            manager->activeSummary->queue_drops++;
-                        }
-                    }
-                }
+                if (!engine.addWrite(pca_addresses[board], 1 << sensorMapping[i].pca_channel))
+                    return false;
+                bool added;
+                if (trigger)
+                    added = engine.addRegisterWrite(VCNL4040_ADDR, 0x04, afConf3 | PS_CONF3_TRIG, afPsMs);
+                else if (cycleReadsAmbient)
+                    added = engine.addRegisterReadPair(VCNL4040_ADDR, 0x08, &cycleRxBuffer[i][0],
+                                                       0x09, &cycleRxBuffer[i][2]);
                 else
-                {
-                    failedReads++;
-                    // Session Confirmation: count I2C error
-                    if (manager->activeSummary)
-                    {
-                        manager->activeSummary->i2c_errors[i]++;
-                    }
-                }
+                    added = engine.addRegisterRead(VCNL4040_ADDR, 0x08, &cycleRxBuffer[i][0], 2);
+                if (!added)
+                    return false;
+                planSlot[i] = planSlotCount[bus]++;
             }
 
-            // Track consecutive failures and log errors
-            if (failedReads > 0)
-            {
-                consecutiveFailures++;
-                // Log every 100 failures or first 3 failures
-                if (consecutiveFailures <= 3 || (millis() - lastErrorLog > 5000))
-                {
-                    if (!serialStudioEnabled)
-                    {
-                        Serial.print("WARNING: Sensor read failures: ");
-                        Serial.print(failedReads);
-                        Serial.print(" failed, ");
-                        Serial.print(successfulReads);
-                        Serial.println(" succeeded");
-                    }
-                    lastErrorLog = millis();
-                }
-            }
-            else
-            {
-                consecutiveFailures = 0;
-            }
+            // Wire1 has no TCA: close this board's PCA before the next
+            // board's sensors (also at 0x60) are selected
+            if (bus == 1 && boardsOnBus > 1 && !engine.addWrite(pca_addresses[board], 0x00))
+                return false;
 
-            // Clean up - disable all channels after reading cycle
-            // IMPORTANT: Must select each TCA channel before disabling its PCA!
-            for (int j = 0; j < 3; j++)
-            {
-                manager->mux.selectChannel(j);
-                delayMicroseconds(100);
-                manager->pca_instances[j].disableAllChannels();
-            }
-            manager->mux.disableAllChannels();
+            cycleBusUsed[bus] = true;
         }
 
-        // CRITICAL: Yield periodically to prevent watchdog timer reset
-        // Yield every 100ms to keep watchdog happy without impacting sample rate
-        unsigned long currentYieldTime = micros();
-        if (currentYieldTime - lastYield >= 100000) // 100ms
+        if (cycleBusUsed[bus])
         {
-            taskYIELD();
-            lastYield = currentYieldTime;
+            if (!engine.commitPlan())
+                return false;
+            anyBoard = true;
         }
     }
 
-    // ===== GRACEFUL CLEANUP BEFORE EXIT =====
-    // This ensures the I2C bus is in a clean state before task ends
-    Serial.println("Sensor task stopping gracefully...");
+    // No per-cycle teardown: the TCA isolates every board except the selected
+    // one, and the buses are cleaned up once when collection stops. After each
+    // replay the mux caches are invalidated (see sensorTaskFunction) so the
+    // Wire fallback path never trusts a stale selection.
+    return anyBoard;
+}
 
-    // Clean up I2C bus state
-    manager->cleanupI2CBus();
+bool SensorManager::cyclePlanReady(const I2CTransactionEngine *plans) const
+{
+    bool any = false;
+    for (int bus = 0; bus < SENSOR_I2C_BUSES; bus++)
+    {
+        if (!cycleBusUsed[bus])
+            continue;
+        if (!plans[bus].isReady())
+            return false;
+        any = true;
+    }
+    return any;
+}
 
-    // Clear summary pointer (collection is over)
-    manager->activeSummary = nullptr;
+esp_err_t SensorManager::executeCycle(I2CTransactionEngine *plans)
+{
+    uint32_t start = micros();
+    bool parallel = cycleBusUsed[1] && busWorkerTask != NULL;
 
-    Serial.println("Sensor task cleanup complete, exiting.");
+    // A timed-out cycle's Wire1 plan that is still running owns Wire1 and
+    // its rows of cycleRxBuffer: no cycle until it is done
+    if (!joinBusWorker(0))
+        return ESP_ERR_TIMEOUT;
 
-    // Mark task as NULL before deleting (atomic-ish on ESP32)
-    manager->sensorTask = NULL;
+    if (parallel)
+    {
+        busWorkerPlan = &plans[1];
+        busWorkerRunning = true;
+        xTaskNotifyGive(busWorkerTask);
+    }
 
-    // Delete ourselves - this is the proper way to end a FreeRTOS task
-    vTaskDelete(NULL);
-}
+    esp_err_t err = ESP_OK;
+    if (cycleBusUsed[0])
+        err = plans[0].execute();
 
-bool SensorManager::startCollection(QueueHandle_t queue, SessionSummary *summary)
-{
-    if (!initialized)
+    if (parallel)
     {
-        Serial.println("ERROR: Sensors not initialized");
-        return false;
+        // Both buses must finish before the frame is decoded
+        if (!joinBusWorker(pdMS_TO_TICKS(2 * I2C_ENGINE_DEFAULT_TIMEOUT_MS)))
+        {
+            // The cycle has failed, but the caller's Wire fallback and the
+            // next cycle must not race the worker on Wire1 / cycleRxBuffer
+            err = ESP_ERR_TIMEOUT;
+            joinBusWorker(pdMS_TO_TICKS(BUS_WORKER_JOIN_MS));
+        }
+        else if (err == ESP_OK)
+        {
+            err = busWorkerResult;
+        }
     }
-
-    if (sensorTask != NULL)
+    else if (cycleBusUsed[1] && err == ESP_OK)
     {
-        Serial.println("Collection already running");
-        return false;
+        err = plans[1].execute();
     }
 
-    dataQueue = queue;
-    activeSummary = summary;
+    lastCycleDurationUs = micros() - start;
+    lastCycleStartUs = start;
+    lastCycleParallel = parallel;
+    return err;
+}
 
-    // Reset stop flag before starting new task
-    stopRequested = false;
+uint32_t SensorManager::planSlotUs(uint8_t sensorIndex) const
+{
+    uint8_t bus = boardBus[sensorMapping[sensorIndex].tca_channel];
+    uint32_t start = lastCycleStartUs;
+    uint32_t span = lastCycleDurationUs;
 
-    // Create sensor task on Core 0
+    // Without the bus worker Wire1's plan ran after Wire's: split the time
+    // between them by op count
+    if (!lastCycleParallel && cycleBusUsed[0] && cycleBusUsed[1])
+    {
+        uint32_t total = planSlotCount[0] + planSlotCount[1];
+        span = (uint32_t)((uint64_t)lastCycleDurationUs * planSlotCount[bus] / total);
+        if (bus == 1)
+            start += lastCycleDurationUs - span;
+    }
+
+    uint32_t slots = planSlotCount[bus] > 0 ? planSlotCount[bus] : 1;
+    return start + (uint32_t)((uint64_t)span * (2 * planSlot[sensorIndex] + 1) / (2 * slots));
+}
+
+bool SensorManager::joinBusWorker(TickType_t wait)
+{
+    if (!busWorkerRunning)
+        return true;
+    if (xSemaphoreTake(busWorkerDone, wait) != pdTRUE)
+        return false;
+    busWorkerRunning = false;
+    return true;
+}
+
+void SensorManager::busWorkerFunction(void *parameter)
+{
+    SensorManager *manager = (SensorManager *)parameter;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (manager->busWorkerStop)
+            break;
+        // Blocks on the I2C_NUM_1 driver while the sensor task waits on I2C_NUM_0
+        manager->busWorkerResult = manager->busWorkerPlan->execute();
+        xSemaphoreGive(manager->busWorkerDone);
+    }
+
+    manager->busWorkerTask = NULL;
+    vTaskDelete(NULL);
+}
+
+bool SensorManager::startBusWorker()
+{
+    // A second task only pays off when both buses carry part of the cycle
+    if (!cycleBusUsed[0] || !cycleBusUsed[1] || busWorkerTask != NULL)
+        return busWorkerTask != NULL;
+
+    if (busWorkerDone == NULL)
+        busWorkerDone = xSemaphoreCreateBinary();
+    if (busWorkerDone == NULL)
+        return false;
+
+    busWorkerStop = false;
+    busWorkerRunning = false;
+    xSemaphoreTake(busWorkerDone, 0); // From a worker stopped mid-plan
+    // Same core and priority as the sensor task: both mostly sleep on their
+    // driver's completion event, so the two transfers overlap on the wire
+    return xTaskCreatePinnedToCore(busWorkerFunction, "I2CBus1", 3072, this, 2, &busWorkerTask, 0) == pdPASS;
+}
+
+void SensorManager::stopBusWorker()
+{
+    TaskHandle_t task = busWorkerTask;
+    if (task == NULL)
+        return;
+
+    joinBusWorker(pdMS_TO_TICKS(BUS_WORKER_JOIN_MS));
+    busWorkerStop = true;
+    xTaskNotifyGive(task);
+    for (int i = 0; i < 50 && busWorkerTask != NULL; i++)
+        vTaskDelay(pdMS_TO_TICKS(1));
+}
+
+void SensorManager::buildScanOrder()
+{
+    // Board-grouped, S2 before S1, board 3 first (same order as the Wire
+    // loop always used). Inactive sensors are left out entirely.
+    scanCount = 0;
+    for (int i = NUM_SENSORS - 1; i >= 0; i--)
+    {
+        if (sensorsActive[i])
+            scanOrder[scanCount++] = i;
+    }
+}
+
+void SensorManager::invalidateMuxCache()
+{
+    mux.invalidateCache();
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
+        pca_instances[i].invalidateCache();
+}
+
+// Sample instant relative to the frame timestamp (SensorFrame::offset_us)
+static uint16_t skewOffsetUs(uint32_t us)
+{
+    return us > UINT16_MAX ? UINT16_MAX : (uint16_t)us;
+}
+
+void SensorManager::decodeCycleReading(uint8_t sensorIndex, SensorReading &reading)
+{
+    reading.timestamp_us = planSlotUs(sensorIndex);
+    reading.position = sensorIndex;
+    reading.pcb_id = (sensorIndex / 2) + 1;
+    reading.side = (sensorIndex % 2) + 1;
+    reading.proximity = (cycleRxBuffer[sensorIndex][1] << 8) | cycleRxBuffer[sensorIndex][0];
+    reading.ambient = cycleReadsAmbient
+                          ? ((cycleRxBuffer[sensorIndex][3] << 8) | cycleRxBuffer[sensorIndex][2])
+                          : 0;
+}
+
+void SensorManager::sensorTaskFunction(void *parameter)
+{
+    SensorManager *manager = (SensorManager *)parameter;
+
+    if (!serialStudioEnabled)
+        Serial.println("Sensor task started on Core 0");
+
+    unsigned long lastCycleStart = 0;
+    bool havePreviousCycle = false;
+    unsigned long lastErrorLog = 0;
+    int consecutiveFailures = 0;
+    SensorReading reading;
+    bool reverseScan = true;
+
+    // The timeout only bounds how long a stop request can go unnoticed;
+    // normally the sample timer wakes us every samplePeriodUs.
+    const TickType_t TICK_WAIT = pdMS_TO_TICKS(100);
+
+    SensorMask activeMask = 0;
+    for (int k = 0; k < manager->scanCount; k++)
+        activeMask |= 1 << manager->scanOrder[k];
+
+    // Hybrid: start in INT idle; the first burst starts the timer
+    if (manager->hybridMode)
+        manager->enterHybridIdle();
+
+    // Active force: the first cycle reads this round's conversions
+    if (manager->activeForce)
+        manager->triggerConversions();
+    manager->lastProximityMask = 0;
+
+    while (!manager->stopRequested) // Check stop flag instead of infinite loop
+    {
+        // Block (no busy-wait) until the sample timer fires. Blocking also
+        // lets the idle task run, so no explicit watchdog yield is needed.
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, TICK_WAIT);
+        if (ticks == 0 || manager->stopRequested)
+            continue;
+
+        // Hybrid idle: the timer is stopped, so this wake is an INT line
+        if (manager->hybridMode && !manager->burstActive)
+        {
+            manager->startBurst();
+            havePreviousCycle = false; // The idle gap is not a timer period
+            continue;
+        }
+
+        // Capture timestamp ONCE for all sensors in this cycle
+        // This ensures all sensors from the same sample have the same timestamp
+        // ⚠️ IMPORTANT: This synchronized timestamping requires the backend to use
+        // a composite key. See: infrastructure/DATABASE_SCHEMA.md for details.
+        unsigned long cycleTimestamp = micros();
+
+        // First frame after a light sleep wake: how long acquisition took to resume
+        if (manager->sleepWakeUs != 0)
+        {
+            uint32_t wakeToSample = cycleTimestamp - manager->sleepWakeUs;
+            manager->sleepWakeUs = 0;
+            if (manager->activeSummary)
+            {
+                SessionSummary *summary = manager->activeSummary;
+                summary->sleep_wakes++;
+                summary->wake_to_sample_us_total += wakeToSample;
+                if (wakeToSample > summary->wake_to_sample_us_max)
+                    summary->wake_to_sample_us_max = wakeToSample;
+            }
+        }
+
+        // Timer pacing statistics. Several pending notifications mean ticks
+        // fired while the previous cycle was still running (overrun).
+        if (manager->activeSummary)
+        {
+            SessionSummary *summary = manager->activeSummary;
+            if (ticks > 1)
+                summary->missed_ticks += ticks - 1;
+
+            if (havePreviousCycle)
+            {
+                uint32_t period = cycleTimestamp - lastCycleStart;
+                if (summary->cycle_period_samples == 0 || period < summary->cycle_period_us_min)
+                    summary->cycle_period_us_min = period;
+                if (period > summary->cycle_period_us_max)
+                    summary->cycle_period_us_max = period;
+                summary->cycle_period_us_total += period;
+                summary->cycle_period_samples++;
+            }
+        }
+        lastCycleStart = cycleTimestamp;
+        havePreviousCycle = true;
+
+        int successfulReads = 0;
+        int failedReads = 0;
+
+        // The whole cycle is published as one frame (one ring slot)
+        SensorFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.timestamp_us = cycleTimestamp;
+
+        // Active force: the readings were sampled when the last round was
+        // triggered; normally that conversion finished long ago
+        if (manager->activeForce)
+        {
+            manager->waitForConversion();
+            frame.timestamp_us = manager->afTriggerStartUs;
+        }
+
+        // Session Confirmation: count this cycle
+        if (manager->activeSummary)
+        {
+            manager->activeSummary->total_cycles++;
+        }
+
+        // Bus health: quarantined sensors and buses in fault sit the cycle
+        // out; a quarantined sensor whose probe is due is read over Wire.
+        // The queued plans are rebuilt whenever the excluded set changes.
+        SensorMask quarantinedBefore = manager->busHealth.getQuarantined();
+        uint8_t busesDown = manager->busHealth.getBusesDown();
+        SensorMask downSensors = 0;
+        for (int bus = 0; bus < SENSOR_I2C_BUSES; bus++)
+        {
+            if (busesDown & (1 << bus))
+                downSensors |= manager->busSensors[bus];
+        }
+        SensorMask excluded = (quarantinedBefore | downSensors) & activeMask;
+        SensorMask probes = manager->busHealth.probesDue(millis()) & ~downSensors;
+        if (excluded != manager->planExcluded)
+        {
+            manager->planExcluded = excluded;
+#if SENSOR_I2C_ENGINE
+            manager->buildCyclePlan();
+#endif
+        }
+        SensorMask readMask = activeMask & ~excluded;
+
+        // Run the whole cycle as one queued transaction. On any bus error
+        // fall back to per-sensor Wire reads so failures are attributed
+        // to the right sensor in i2c_errors[].
+        bool cycleDone = false;
+#if SENSOR_I2C_ENGINE
+        // The queued cycle covers every sensor not excluded; a partial burst
+        // (hybrid, some boards still idle) reads its sensors one by one
+        if (readMask != 0 && manager->cyclePlanReady(manager->cycleEngines) &&
+            (manager->burstSensorMask & readMask) == readMask)
+        {
+            {
+                PROFILE_SCOPE(ProfileSpan::I2C_CYCLE);
+                cycleDone = (manager->executeCycle(manager->cycleEngines) == ESP_OK);
+            }
+            manager->invalidateMuxCache();
+
+            if (cycleDone && manager->activeSummary)
+            {
+                uint32_t us = manager->lastCycleDurationUs;
+                manager->activeSummary->cycle_i2c_us_total += us;
+                manager->activeSummary->cycle_i2c_samples++;
+                if (us > manager->activeSummary->cycle_i2c_us_max)
+                    manager->activeSummary->cycle_i2c_us_max = us;
+            }
+        }
+#endif
+
+        // Serpentine walk over the sticky scan order: alternate direction
+        // each cycle so the sensor selected last is read first next time
+        // (saves one TCA + one PCA write per cycle).
+        reverseScan = !reverseScan;
+
+        // Read all active sensors in sticky board order
+        for (int k = 0; k < manager->scanCount; k++)
+        {
+            // Check stop flag between sensor reads for faster response
+            if (manager->stopRequested)
+                break;
+
+            int i = reverseScan ? manager->scanOrder[manager->scanCount - 1 - k]
+                                : manager->scanOrder[k];
+            if (!(manager->burstSensorMask & (1 << i)))
+                continue;
+
+            bool probe = (excluded & (1 << i)) != 0;
+            if (probe && !(probes & (1 << i)))
+            {
+                if (manager->activeSummary)
+                    manager->activeSummary->health_skipped_reads++;
+                continue;
+            }
+
+            bool readOk;
+            if (cycleDone && !probe)
+            {
+                manager->decodeCycleReading(i, reading);
+                readOk = true;
+            }
+            else
+            {
+                readOk = manager->readSensor(i, reading);
+
+                if (readOk && manager->activeSummary)
+                {
+                    uint32_t us = manager->lastReadLatencyUs;
+                    manager->activeSummary->read_latency_us_total[i] += us;
+                    manager->activeSummary->read_latency_samples[i]++;
+                    if (us > manager->activeSummary->read_latency_us_max[i])
+                        manager->activeSummary->read_latency_us_max[i] = us;
+                }
+            }
+
+            manager->busHealth.recordRead(i, manager->boardBus[manager->sensorMapping[i].tca_channel], readOk);
+
+            if (readOk)
+            {
+                successfulReads++;
+
+                // Same value as last time: a stale or duplicate conversion
+                // (or, rarely, a genuinely unchanged reading)
+                bool repeated = (manager->lastProximityMask & (1 << i)) &&
+                                manager->lastProximity[i] == reading.proximity;
+                if (repeated && manager->activeSummary)
+                {
+                    manager->activeSummary->repeated_readings[i]++;
+                }
+                manager->lastProximity[i] = reading.proximity;
+                manager->lastProximityMask |= 1 << i;
+
+                frame.proximity[i] = reading.proximity;
+                frame.ambient[i] = reading.ambient;
+
+                // duplicate_mode "suppress": a repeat carries nothing new, so
+                // it is only marked held (the codecs send no value for it) -
+                // until the last value sent is SENSOR_DUPLICATE_HOLD_MAX_MS old
+                if (repeated && manager->suppressDuplicates && manager->lastAmbient[i] == reading.ambient &&
+                    (uint32_t)(frame.timestamp_us - manager->lastSentUs[i]) < SENSOR_DUPLICATE_HOLD_MAX_MS * 1000UL)
+                {
+                    frame.held_mask |= 1 << i;
+                    if (manager->activeSummary)
+                        manager->activeSummary->suppressed_repeats[i]++;
+                    continue;
+                }
+                manager->lastAmbient[i] = reading.ambient;
+                manager->lastSentUs[i] = frame.timestamp_us;
+
+                frame.valid_mask |= (1 << i);
+                if (manager->skewCompensation)
+                    frame.setOffsetUs(i, manager->activeForce
+                                               ? manager->afTriggerOffsetUs[i]
+                                               : skewOffsetUs(reading.timestamp_us - cycleTimestamp));
+            }
+            else
+            {
+                failedReads++;
+                // Session Confirmation: count I2C error
+                if (manager->activeSummary)
+                {
+                    manager->activeSummary->i2c_errors[i]++;
+                }
+            }
+        }
+
+        // Next cycle's samples convert while this one is published and the
+        // task waits for the timer
+        if (manager->activeForce && !manager->stopRequested)
+            manager->triggerConversions();
+
+        // Publish the whole cycle as one ring slot (non-blocking); an
+        // all-held cycle too, so a gap in the stream always means no reading
+        if (!frame.isEmpty())
+        {
+            PROFILE_SCOPE(ProfileSpan::QUEUE_PUSH);
+
+            // Detection tap first: it has its own ring and overflow count,
+            // independent of whether the session ring has room
+            if (manager->frameTap && manager->frameTap->push(frame) && manager->frameTapTask)
+                xTaskNotifyGive(manager->frameTapTask);
+
+            if (manager->frameRing->push(frame))
+            {
+                // Session Confirmation: count successful read + hand-off
+                if (manager->activeSummary)
+                {
+                    for (int i = 0; i < NUM_SENSORS; i++)
+                    {
+                        if (frame.isValid(i))
+                            manager->activeSummary->readings_collected[i]++;
+                    }
+                }
+            }
+            else
+            {
+                // Ring full - the whole cycle is lost
+                if (manager->activeSummary)
+                {
+                    manager->activeSummary->queue_drops += frame.validCount();
+                }
+            }
+        }
+
+        // Track consecutive failures and log errors
+        if (failedReads > 0)
+        {
+            consecutiveFailures++;
+            // Log every 100 failures or first 3 failures
+            if (consecutiveFailures <= 3 || (millis() - lastErrorLog > 5000))
+            {
+                if (!serialStudioEnabled)
+                {
+                    Serial.print("WARNING: Sensor read failures: ");
+                    Serial.print(failedReads);
+                    Serial.print(" failed, ");
+                    Serial.print(successfulReads);
+                    Serial.println(" succeeded");
+                }
+                lastErrorLog = millis();
+            }
+        }
+        else
+        {
+            consecutiveFailures = 0;
+        }
+
+        // No per-cycle mux teardown: channels stay selected between cycles
+        // so the cached TCA/PCA state can skip redundant writes. The bus
+        // is released once in cleanupI2CBus() when the task exits.
+
+        // Bus health verdicts: restore sensors that answered their probe,
+        // clear and restart buses on which nothing answers any more
+        if (!manager->stopRequested)
+        {
+            SensorMask restored;
+            uint8_t recoveryDue = manager->busHealth.endCycle(millis(), restored);
+            if (restored != 0)
+                manager->restoreSensors(restored);
+            for (int bus = 0; bus < SENSOR_I2C_BUSES; bus++)
+            {
+                if (recoveryDue & (1 << bus))
+                    manager->recoverBus(bus);
+            }
+            if (manager->activeSummary)
+                manager->activeSummary->sensor_quarantines +=
+                    __builtin_popcount(manager->busHealth.getQuarantined() & ~quarantinedBefore);
+        }
+
+        // Session Confirmation: cycle took longer than one timer period
+        if (manager->activeSummary && (uint32_t)(micros() - cycleTimestamp) > manager->samplePeriodUs)
+        {
+            manager->activeSummary->cycle_overruns++;
+        }
+
+        // Hybrid: back to INT idle once nothing has been above threshold
+        // for the burst window
+        if (manager->burstActive && !manager->updateBurst(frame))
+            manager->enterHybridIdle();
+
+        // Adaptive rate: follow the detector between cycles
+        if (manager->adaptiveRate && manager->applyAdaptiveRate())
+            havePreviousCycle = false; // The next period straddles the change
+
+        // Config change while collecting (reconfigure())
+        if (__atomic_load_n(&manager->registerUpdatePending, __ATOMIC_ACQUIRE))
+            manager->applyPendingRegisters();
+
+        // PS_CANC moved by the background calibrator
+        if (__atomic_load_n(&manager->cancellationPending, __ATOMIC_ACQUIRE))
+            manager->applyPendingCancellation();
+    }
+
+    // ===== GRACEFUL CLEANUP BEFORE EXIT =====
+    // This ensures the I2C bus is in a clean state before task ends
+    Serial.println("Sensor task stopping gracefully...");
+
+    // No more ticks - the callback must not notify a task that is going away
+    esp_timer_stop(manager->sampleTimer);
+
+    if (manager->hybridMode)
+        manager->releaseHybrid();
+
+    manager->finishAdaptiveRate();
+
+    // Back to free-running conversions (interrupt mode and calibration expect them)
+    if (manager->activeForce)
+        manager->setActiveForce(false);
+
+    manager->stopBusWorker();
+
+    // Clean up I2C bus state
+    manager->cleanupI2CBus();
+
+    // Clear summary pointer (collection is over)
+    manager->activeSummary = nullptr;
+
+    Serial.println("Sensor task cleanup complete, exiting.");
+
+    // Mark task as NULL before deleting (atomic-ish on ESP32)
+    manager->sensorTask = NULL;
+
+    // Delete ourselves - this is the proper way to end a FreeRTOS task
+    vTaskDelete(NULL);
+}
+
+bool SensorManager::startCollection(SensorFrameRing *ring, SessionSummary *summary)
+{
+    if (!initialized)
+    {
+        Serial.println("ERROR: Sensors not initialized");
+        return false;
+    }
+
+    if (sensorTask != NULL)
+    {
+        Serial.println("Collection already running");
+        return false;
+    }
+
+    if (ring == nullptr)
+    {
+        Serial.println("ERROR: No frame ring for sensor collection");
+        return false;
+    }
+
+    frameRing = ring;
+    activeSummary = summary;
+
+    // Other components (InterruptManager, calibration) may have driven the
+    // muxes since our last session - start from a known-unknown state.
+    invalidateMuxCache();
+    buildScanOrder();
+
+    // Every sensor back in the cycle; a bus or sensor that still fails is
+    // found again within a few cycles
+    busHealth.reset();
+    planExcluded = 0;
+    memset(busSensors, 0, sizeof(busSensors));
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (sensorsActive[i])
+            busSensors[boardBus[sensorMapping[i].tca_channel]] |= 1 << i;
+    }
+
+    burstActive = false;
+    burstSensorMask = SENSOR_MASK_ALL;
+    hybridMode = (activeConfig != nullptr && activeConfig->sensor_mode == SensorMode::HYBRID_MODE);
+    if (hybridMode && !prepareHybrid())
+    {
+        Serial.println("WARNING: Hybrid mode unavailable, polling continuously");
+        hybridMode = false;
+    }
+
+    skewCompensation = SENSOR_SKEW_OFFSETS && activeConfig != nullptr && activeConfig->skew_compensation;
+    memset(afTriggerOffsetUs, 0, sizeof(afTriggerOffsetUs));
+
+    // Hybrid idle needs free-running conversions for its INT thresholds
+    activeForce = (activeConfig != nullptr && activeConfig->active_force && !hybridMode);
+    if (activeForce && !setActiveForce(true))
+    {
+        Serial.println("WARNING: Active force mode unavailable, sensors free-running");
+        setActiveForce(false);
+        activeForce = false;
+    }
+
+    // Triggered conversions are fresh every cycle: nothing to suppress
+    suppressDuplicates = (activeConfig != nullptr && activeConfig->duplicate_mode == "suppress" && !activeForce);
+
+#if SENSOR_I2C_ENGINE
+    // Build the queued cycle for the current sensor set / read_ambient setting
+    if (buildCyclePlan())
+    {
+        bool parallel = startBusWorker();
+        if (!serialStudioEnabled)
+            Serial.printf("I2C cycle engine ready (%d + %d ops per cycle%s)\n",
+                          cycleEngines[0].getOperationCount(), cycleEngines[1].getOperationCount(),
+                          parallel ? ", buses in parallel" : "");
+    }
+    else
+    {
+        Serial.println("WARNING: I2C cycle plan unavailable, using Wire path");
+    }
+#endif
+
+    // Sample timer: created once, restarted with the configured period
+    // for every collection (sample_rate_hz may change between sessions)
+    if (sampleTimer == nullptr)
+    {
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = &SensorManager::sampleTimerCallback;
+        timerArgs.arg = this;
+        timerArgs.dispatch_method = ESP_TIMER_TASK;
+        timerArgs.name = "sensor_sample";
+
+        if (esp_timer_create(&timerArgs, &sampleTimer) != ESP_OK)
+        {
+            Serial.println("ERROR: Failed to create sensor sample timer");
+            sampleTimer = nullptr;
+            return false;
+        }
+    }
+
+    samplePeriodUs = resolveSamplePeriodUs();
+    if (activeSummary)
+    {
+        activeSummary->cycle_period_target_us = samplePeriodUs;
+    }
+
+    // Adaptive rate: only between the detector and the timer, so not in
+    // hybrid mode (its idle already stops the timer)
+    fullPeriodUs = samplePeriodUs;
+    idlePeriodUs = samplePeriodUs;
+    adaptiveRate = false;
+    if (rateScheduler != nullptr && activeConfig != nullptr && activeConfig->adaptive_rate && !hybridMode &&
+        activeConfig->adaptive_idle_rate_hz > 0 && 1000000UL / activeConfig->adaptive_idle_rate_hz > fullPeriodUs)
+    {
+        idlePeriodUs = 1000000UL / activeConfig->adaptive_idle_rate_hz;
+        adaptiveRate = true;
+    }
+    if (rateScheduler != nullptr)
+    {
+        rateScheduler->configure(adaptiveRate,
+                                 activeConfig != nullptr ? activeConfig->adaptive_approach_fraction : 0.5f,
+                                 activeConfig != nullptr ? activeConfig->adaptive_hold_ms : 500);
+    }
+    collectionStartMs = millis();
+    if (adaptiveRate)
+        recordRate(collectionStartMs);
+
+    // Reset stop flag before starting new task
+    stopRequested = false;
+
+    // Create sensor task on Core 0
     // Stack size increased to 8192 to handle I2C operations and error logging
     xTaskCreatePinnedToCore(
         sensorTaskFunction,
@@ -1073,11 +2025,495 @@ bool SensorManager::startCollection(QueueHandle_t queue, SessionSummary *summary
         0 // Core 0 (protocol CPU)
     );
 
+    // Hybrid collections start the timer per burst
+    if (!hybridMode && esp_timer_start_periodic(sampleTimer, samplePeriodUs) != ESP_OK)
+    {
+        Serial.println("ERROR: Failed to start sensor sample timer");
+        stopCollection();
+        return false;
+    }
+
     if (!serialStudioEnabled)
-        Serial.println("Sensor collection started");
+        Serial.printf("Sensor collection started (%lu us sample period%s%s)\n", (unsigned long)samplePeriodUs,
+                      hybridMode ? ", hybrid INT bursts" : activeForce ? ", active force" : "",
+                      adaptiveRate ? ", adaptive idle rate" : "");
+    return true;
+}
+
+void SensorManager::sampleTimerCallback(void *arg)
+{
+    // Runs in the esp_timer task - just wake the sensor task
+    SensorManager *manager = (SensorManager *)arg;
+    TaskHandle_t task = manager->sensorTask;
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+}
+
+uint32_t SensorManager::resolveSamplePeriodUs() const
+{
+    uint16_t rate = (activeConfig != nullptr) ? activeConfig->sample_rate_hz : SAMPLE_RATE_HZ;
+    if (rate == 0)
+        rate = SAMPLE_RATE_HZ;
+    if (rate > SAMPLE_RATE_MAX_HZ)
+        rate = SAMPLE_RATE_MAX_HZ;
+
+    uint32_t periodUs = 1000000UL / rate;
+
+    // duplicate_mode "match": no faster than the sensors convert. The timer
+    // and the sensors' oscillators drift apart, so a conversion is now and
+    // then read twice or skipped; "suppress" is exact instead.
+    if (activeConfig != nullptr && activeConfig->duplicate_mode == "match" && !activeForce)
+    {
+        uint32_t conversionUs = activeConfig->conversionPeriodUs();
+        if (conversionUs > periodUs)
+            periodUs = conversionUs;
+    }
+    return periodUs;
+}
+
+// ============================================================================
+// Adaptive Rate (detector-driven idle sample rate)
+// ============================================================================
+
+bool SensorManager::applyAdaptiveRate()
+{
+    bool wantIdle = rateScheduler->wantsIdleRate();
+    uint32_t target = wantIdle ? idlePeriodUs : fullPeriodUs;
+    if (target == samplePeriodUs)
+        return false;
+
+    esp_timer_stop(sampleTimer);
+    if (esp_timer_start_periodic(sampleTimer, target) != ESP_OK)
+    {
+        Serial.println("ERROR: Failed to restart sensor sample timer, adaptive rate off");
+        adaptiveRate = false;
+        wantIdle = false;
+        target = fullPeriodUs;
+        esp_timer_start_periodic(sampleTimer, target);
+    }
+
+    // A tick of the old period may be pending; the new one starts now
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    uint32_t now = millis();
+    if (samplePeriodUs != fullPeriodUs && activeSummary)
+        activeSummary->idle_rate_ms_total += now - idleRateSinceMs;
+    if (wantIdle)
+        idleRateSinceMs = now;
+
+    samplePeriodUs = target;
+    recordRate(now);
     return true;
 }
 
+void SensorManager::recordRate(uint32_t nowMs)
+{
+    if (!activeSummary)
+        return;
+
+    SessionSummary *summary = activeSummary;
+    if (summary->rate_timeline_count > 0)
+        summary->rate_switches++;
+    if (summary->rate_timeline_count < SESSION_RATE_TIMELINE_MAX)
+    {
+        RateTimelineEntry &entry = summary->rate_timeline[summary->rate_timeline_count++];
+        entry.offset_ms = nowMs - collectionStartMs;
+        entry.rate_hz = 1000000UL / samplePeriodUs;
+    }
+}
+
+void SensorManager::finishAdaptiveRate()
+{
+    // The period only differs from the full one while at the idle rate
+    if (samplePeriodUs != fullPeriodUs && activeSummary)
+        activeSummary->idle_rate_ms_total += millis() - idleRateSinceMs;
+    samplePeriodUs = fullPeriodUs;
+    adaptiveRate = false;
+}
+
+// ============================================================================
+// Active Force Mode (synchronized triggering)
+// With PS_AF set a sensor converts only when PS_TRIG is written, and the
+// result stays in PS_DATA until the next trigger. Triggering every sensor in
+// one round gives samples taken together (to within the trigger round's bus
+// time) instead of at six free-running phases. The round for cycle N+1 goes
+// out right after cycle N's reads, so the conversion runs during the timer
+// wait; waitForConversion() only spins when the sample period is shorter
+// than the conversion.
+// ============================================================================
+
+bool SensorManager::setActiveForce(bool enable)
+{
+    if (activeConfig == nullptr)
+        return false;
+
+    // PS_CONF3 / PS_MS are one 16-bit register; keep multi-pulse and LED
+    // current exactly as applySensorConfig() wrote them
+    afConf3 = ((parseMultiPulse(activeConfig->multi_pulse) & 0x03) << 5) | (enable ? PS_CONF3_AF : 0);
+    afPsMs = parseLEDCurrent(activeConfig->led_current) & 0x07;
+
+    // 1T = 125 us (CONFIGURATION_GUIDE.md); multi-pulse fires 1/2/4/8 pulses
+    static const uint16_t IT_US[8] = {125, 188, 250, 313, 375, 438, 500, 1000};
+    uint8_t pulses = 1 << (parseMultiPulse(activeConfig->multi_pulse) & 0x03);
+    afConversionUs = IT_US[parseIntegrationTime(activeConfig->integration_time) & 0x07] * pulses +
+                     ACTIVE_FORCE_MARGIN_US;
+
+    bool ok = true;
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!sensorsActive[i])
+            continue;
+        if (!selectSensor(i))
+        {
+            ok = false;
+            continue;
+        }
+        TwoWire &bus = wireFor(sensorMapping[i].tca_channel);
+        bus.beginTransmission(0x60);
+        bus.write(0x04);
+        bus.write(afConf3);
+        bus.write(afPsMs);
+        ok &= bus.endTransmission() == 0;
+    }
+    return ok;
+}
+
+void SensorManager::triggerConversions()
+{
+    afTriggerStartUs = micros();
+
+    bool done = false;
+#if SENSOR_I2C_ENGINE
+    if (cyclePlanReady(triggerEngines))
+    {
+        done = (executeCycle(triggerEngines) == ESP_OK);
+        invalidateMuxCache();
+
+        for (int k = 0; done && skewCompensation && k < scanCount; k++)
+            afTriggerOffsetUs[scanOrder[k]] = skewOffsetUs(planSlotUs(scanOrder[k]) - afTriggerStartUs);
+    }
+#endif
+
+    if (!done)
+    {
+        for (int k = 0; k < scanCount; k++)
+        {
+            int i = scanOrder[k];
+            if ((planExcluded & (1 << i)) || !selectSensor(i))
+                continue;
+            afTriggerOffsetUs[i] = skewOffsetUs(micros() - afTriggerStartUs);
+            TwoWire &bus = wireFor(sensorMapping[i].tca_channel);
+            bus.beginTransmission(0x60);
+            bus.write(0x04);
+            bus.write(afConf3 | PS_CONF3_TRIG);
+            bus.write(afPsMs);
+            bus.endTransmission();
+        }
+    }
+
+    afTriggerEndUs = micros();
+}
+
+void SensorManager::waitForConversion()
+{
+    uint32_t elapsed = micros() - afTriggerEndUs;
+    if (elapsed < afConversionUs)
+        delayMicroseconds(afConversionUs - elapsed); // Sub-tick: a task delay would cost 1 ms
+}
+
+// ============================================================================
+// Hybrid Mode (interrupt idle + polling bursts)
+// While idle every sensor runs at hybrid_idle_duty_cycle with its PS
+// interrupt armed (close event, persistence from interrupt_persistence) and
+// the sample timer is stopped, so the sensor task sleeps and the bus is
+// quiet. A falling INT line wakes the task, which switches the sensors to
+// the polling configuration and starts the timer; the burst runs until
+// hybrid_burst_window_ms pass with no reading above the low threshold.
+//
+// The INT margin should sit below the detector's rise threshold so the
+// burst starts before the wave that the detector needs to see.
+// ============================================================================
+
+SensorManager *SensorManager::hybridInstance = nullptr;
+
+// Board INT lines (see InterruptManager::startMonitoring for the wiring)
+static const struct
+{
+    uint8_t pin;
+    uint8_t board; // TCA channel
+} HYBRID_INT_PINS[3] = {
+    {PIN_SENSOR_INT_3, 0},
+    {PIN_SENSOR_INT_2, 1},
+    {PIN_SENSOR_INT_1, 2},
+};
+
+// Boards with an INT line; the rest cannot wake the idle and join every burst
+static const uint8_t HYBRID_INT_BOARDS = 0x07;
+
+void IRAM_ATTR SensorManager::hybridIsrBoard0() { hybridIsr(0); }
+void IRAM_ATTR SensorManager::hybridIsrBoard1() { hybridIsr(1); }
+void IRAM_ATTR SensorManager::hybridIsrBoard2() { hybridIsr(2); }
+
+void IRAM_ATTR SensorManager::hybridIsr(uint8_t board)
+{
+    SensorManager *manager = hybridInstance;
+    if (manager == nullptr)
+        return;
+
+    // Every edge marks its board (partial bursts pick up late boards);
+    // only the first edge of an idle period wakes the task
+    manager->hybridBoardMask |= 1 << board;
+    if (!manager->hybridArmed)
+        return;
+    manager->hybridArmed = false;
+
+    TaskHandle_t task = manager->sensorTask;
+    if (task != NULL)
+    {
+        BaseType_t higherPriorityWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &higherPriorityWoken);
+        if (higherPriorityWoken == pdTRUE)
+            portYIELD_FROM_ISR();
+    }
+}
+
+void SensorManager::wakeFromSleep(uint8_t boards, uint32_t wakeUs)
+{
+    if (!hybridMode || sensorTask == NULL)
+        return;
+
+    sleepWakeUs = wakeUs != 0 ? wakeUs : 1;
+    __atomic_fetch_or(&hybridBoardMask, boards, __ATOMIC_RELAXED);
+    if (hybridArmed)
+    {
+        hybridArmed = false;
+        xTaskNotifyGive(sensorTask);
+    }
+}
+
+bool SensorManager::writeProximityMode(uint8_t sensorIndex, VCNL4040_LEDDutyCycle duty, bool interruptEnabled)
+{
+    if (!selectSensor(sensorIndex))
+        return false;
+    TwoWire &bus = wireFor(sensorMapping[sensorIndex].tca_channel);
+
+    // PS_CONF1: duty 7:6, persistence 5:4, IT 3:1. PS_CONF2: PS_HD bit 3,
+    // PS_INT 1:0 (01 = close). Same layout as applySensorConfig().
+    VCNL4040_ProximityIntegration integration = parseIntegrationTime(activeConfig->integration_time);
+    uint8_t persistence = constrain(activeConfig->interrupt_persistence, 1, 4) - 1;
+    uint8_t ps_conf1 = ((duty & 0x03) << 6) |
+                       ((interruptEnabled ? persistence : 0) << 4) |
+                       ((integration & 0x07) << 1);
+    uint8_t ps_conf2 = (activeConfig->high_resolution ? 0x08 : 0x00) | (interruptEnabled ? 0x01 : 0x00);
+
+    bool ok = true;
+    if (interruptEnabled)
+    {
+        uint16_t low = hybridThresholdLow[sensorIndex];
+        uint16_t high = hybridThresholdHigh[sensorIndex];
+        bus.beginTransmission(0x60);
+        bus.write(0x06); // PS_THDL
+        bus.write(low & 0xFF);
+        bus.write(low >> 8);
+        ok &= bus.endTransmission() == 0;
+        bus.beginTransmission(0x60);
+        bus.write(0x07); // PS_THDH
+        bus.write(high & 0xFF);
+        bus.write(high >> 8);
+        ok &= bus.endTransmission() == 0;
+    }
+
+    bus.beginTransmission(0x60);
+    bus.write(0x03);
+    bus.write(ps_conf1);
+    bus.write(ps_conf2);
+    ok &= bus.endTransmission() == 0;
+
+    // Reading INT_FLAG (0x0B) clears a pending interrupt, releasing the
+    // board's shared INT line
+    bus.beginTransmission(0x60);
+    bus.write(0x0B);
+    if (bus.endTransmission(false) == 0)
+        bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+    while (bus.available())
+        bus.read();
+
+    return ok;
+}
+
+bool SensorManager::prepareHybrid()
+{
+    // Thresholds sit interrupt_threshold_margin above the level read now
+    // (about 0 once PS_CANC is calibrated), like InterruptManager's fallback
+    uint16_t margin = activeConfig->interrupt_threshold_margin;
+    uint16_t hysteresis = activeConfig->interrupt_hysteresis;
+    int prepared = 0;
+
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!sensorsActive[i])
+            continue;
+
+        SensorReading reading;
+        uint32_t sum = 0;
+        int samples = 0;
+        for (int k = 0; k < 8; k++)
+        {
+            if (readSensor(i, reading))
+            {
+                sum += reading.proximity;
+                samples++;
+            }
+            delay(5); // New PS value every few ms at 1/40 duty
+        }
+        if (samples == 0)
+            continue;
+
+        uint32_t high = sum / samples + margin;
+        if (high > 0xFFFF)
+            high = 0xFFFF;
+        hybridThresholdHigh[i] = high;
+        hybridThresholdLow[i] = high > hysteresis ? high - hysteresis : 0;
+        prepared++;
+
+        if (!serialStudioEnabled)
+            Serial.printf("  Hybrid S%d: THDL=%u THDH=%u\n", i, hybridThresholdLow[i], hybridThresholdHigh[i]);
+    }
+
+    if (prepared == 0)
+        return false;
+
+    hybridArmed = false;
+    hybridBoardMask = 0;
+    hybridInstance = this;
+    for (const auto &line : HYBRID_INT_PINS)
+        pinMode(line.pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(HYBRID_INT_PINS[0].pin), hybridIsrBoard0, FALLING);
+    attachInterrupt(digitalPinToInterrupt(HYBRID_INT_PINS[1].pin), hybridIsrBoard1, FALLING);
+    attachInterrupt(digitalPinToInterrupt(HYBRID_INT_PINS[2].pin), hybridIsrBoard2, FALLING);
+    return true;
+}
+
+void SensorManager::enterHybridIdle()
+{
+    esp_timer_stop(sampleTimer);
+    if (burstActive && activeSummary)
+        activeSummary->hybrid_burst_ms_total += millis() - burstStartMs;
+    burstActive = false;
+    burstSensorMask = 0;
+
+    VCNL4040_LEDDutyCycle idleDuty = parseDutyCycle(activeConfig->hybrid_idle_duty_cycle);
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (sensorsActive[i])
+            writeProximityMode(i, idleDuty, true);
+    }
+
+    // Ticks that fired before the timer stopped are not INT wakes
+    ulTaskNotifyTake(pdTRUE, 0);
+    hybridBoardMask = 0;
+    sleepWakeUs = 0;
+    hybridArmed = true;
+
+    // A line that fell while the flags were being cleared gave its edge
+    // before arming - it would never wake us, so check the levels
+    uint8_t low = 0;
+    for (const auto &line : HYBRID_INT_PINS)
+    {
+        if (digitalRead(line.pin) == LOW)
+            low |= 1 << line.board;
+    }
+    if (low != 0 && hybridArmed)
+    {
+        hybridArmed = false;
+        hybridBoardMask |= low;
+        xTaskNotifyGive(sensorTask);
+    }
+}
+
+void SensorManager::addBurstBoards(uint8_t boards)
+{
+    boards |= (uint8_t)~HYBRID_INT_BOARDS;
+    VCNL4040_LEDDutyCycle duty = parseDutyCycle(activeConfig->duty_cycle);
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (!sensorsActive[i] || (burstSensorMask & (1 << i)))
+            continue;
+        if (!activeConfig->hybrid_burst_all_boards && !(boards & (1 << sensorMapping[i].tca_channel)))
+            continue;
+
+        writeProximityMode(i, duty, false);
+        burstSensorMask |= 1 << i;
+    }
+}
+
+void SensorManager::startBurst()
+{
+    uint8_t boards = __atomic_exchange_n(&hybridBoardMask, 0, __ATOMIC_RELAXED);
+    burstSensorMask = 0;
+    addBurstBoards(boards);
+
+    burstActive = true;
+    burstStartMs = millis();
+    burstLastActivityMs = burstStartMs;
+    if (activeSummary)
+        activeSummary->hybrid_bursts++;
+
+    if (esp_timer_start_periodic(sampleTimer, samplePeriodUs) != ESP_OK)
+    {
+        Serial.println("ERROR: Failed to start sensor sample timer for burst");
+        enterHybridIdle();
+    }
+}
+
+bool SensorManager::updateBurst(const SensorFrame &frame)
+{
+    // Partial bursts: boards that fired since the burst began join it
+    if (!activeConfig->hybrid_burst_all_boards)
+    {
+        uint8_t boards = __atomic_exchange_n(&hybridBoardMask, 0, __ATOMIC_RELAXED);
+        if (boards != 0)
+            addBurstBoards(boards);
+    }
+
+    uint32_t now = millis();
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (frame.isValid(i) && frame.proximity[i] >= hybridThresholdLow[i])
+        {
+            burstLastActivityMs = now;
+            break;
+        }
+    }
+
+    return (now - burstLastActivityMs < activeConfig->hybrid_burst_window_ms) &&
+           (now - burstStartMs < activeConfig->hybrid_burst_max_ms);
+}
+
+void SensorManager::releaseHybrid()
+{
+    hybridArmed = false;
+    for (const auto &line : HYBRID_INT_PINS)
+        detachInterrupt(digitalPinToInterrupt(line.pin));
+    hybridInstance = nullptr;
+
+    if (burstActive && activeSummary)
+        activeSummary->hybrid_burst_ms_total += millis() - burstStartMs;
+    burstActive = false;
+    burstSensorMask = SENSOR_MASK_ALL;
+
+    // Leave the sensors in the plain polling configuration
+    VCNL4040_LEDDutyCycle duty = parseDutyCycle(activeConfig->duty_cycle);
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (sensorsActive[i])
+            writeProximityMode(i, duty, false);
+    }
+    hybridMode = false;
+}
+
 void SensorManager::stopCollection()
 {
     if (sensorTask == NULL)
@@ -1113,9 +2549,19 @@ void SensorManager::stopCollection()
         // Task didn't stop in time - force delete as fallback
         // This shouldn't happen normally, but provides safety
         Serial.println("WARNING: Sensor task did not stop in time, forcing deletion");
+        esp_timer_stop(sampleTimer);
         vTaskDelete(sensorTask);
         sensorTask = NULL;
 
+        if (hybridMode)
+            releaseHybrid();
+
+        finishAdaptiveRate();
+        stopBusWorker();
+
+        if (activeForce)
+            setActiveForce(false);
+
         // Clean up I2C bus since task couldn't do it
         cleanupI2CBus();
         Serial.println("I2C bus cleaned up after forced stop");
@@ -1135,10 +2581,16 @@ std::vector<SensorMetadata> SensorManager::getSensorMetadata()
 
     for (int i = 0; i < NUM_SENSORS; i++)
     {
+        // The original three boards are always listed (inactive if missing);
+        // extra capacity only once a board answered there
+        uint8_t board = sensorMapping[i].tca_channel;
+        if (board >= 3 && !(boardMask & (1 << board)))
+            continue;
+
         SensorMetadata meta;
         meta.position = i;
-        meta.pcb_id = (i / 2) + 1;      // PCB 1, 2, or 3
-        meta.side = (i % 2) + 1;        // Side 1 or 2
+        meta.pcb_id = board + 1;
+        meta.side = sensorMapping[i].pca_channel + 1;
         meta.active = sensorsActive[i]; // Actual sensor status
 
         // Generate name: P1S1, P2S2, etc.
@@ -1150,6 +2602,146 @@ std::vector<SensorMetadata> SensorManager::getSensorMetadata()
     return metadata;
 }
 
+uint8_t SensorManager::getActiveSensorCount() const
+{
+    uint8_t count = 0;
+    for (int i = 0; i < NUM_SENSORS; i++)
+        count += sensorsActive[i] ? 1 : 0;
+    return count;
+}
+
+bool SensorManager::writeRegisterDelta(const ProximityRegisters &target)
+{
+    uint8_t changed = 0;
+    if (target.conf1 != appliedRegisters.conf1 || target.conf2 != appliedRegisters.conf2)
+        changed |= 0x01; // PS_CONF1/2
+    if (target.conf3 != appliedRegisters.conf3 || target.ms != appliedRegisters.ms)
+        changed |= 0x02; // PS_CONF3/PS_MS
+
+    bool allOk = true;
+    SensorMask knownMask = 0;
+
+    // Board by board: one TCA select, then each sensor's PCA channel
+    for (uint8_t board = 0; board < SENSOR_MAX_BOARDS; board++)
+    {
+        bool boardSelected = false;
+        for (uint8_t i = 0; i < NUM_SENSORS; i++)
+        {
+            if (!sensorsActive[i] || sensorMapping[i].tca_channel != board)
+                continue;
+
+            // A sensor whose last write failed gets both registers
+            uint8_t writes = (registersKnownMask & (1 << i)) ? changed : 0x03;
+            if (writes == 0)
+            {
+                knownMask |= 1 << i;
+                continue;
+            }
+
+            if (!boardSelected && !selectBoard(board))
+            {
+                allOk = false;
+                break;
+            }
+            boardSelected = true;
+            if (!pca_instances[board].selectChannel(sensorMapping[i].pca_channel))
+            {
+                allOk = false;
+                continue;
+            }
+
+            TwoWire &bus = wireFor(board);
+            bool ok = true;
+            if (writes & 0x01)
+            {
+                bus.beginTransmission(0x60);
+                bus.write(0x03);
+                bus.write(target.conf1);
+                bus.write(target.conf2);
+                ok &= bus.endTransmission() == 0;
+            }
+            if (writes & 0x02)
+            {
+                bus.beginTransmission(0x60);
+                bus.write(0x04);
+                bus.write(target.conf3);
+                bus.write(target.ms);
+                ok &= bus.endTransmission() == 0;
+            }
+
+            if (ok)
+                knownMask |= 1 << i;
+            allOk &= ok;
+        }
+    }
+
+    appliedRegisters = target;
+    registersKnownMask = knownMask;
+    return allOk;
+}
+
+void SensorManager::applyPendingRegisters()
+{
+    // Sensor task, between cycles: the bus is ours
+    registerUpdateOk = writeRegisterDelta(pendingRegisters);
+    invalidateMuxCache();
+    __atomic_store_n(&registerUpdatePending, false, __ATOMIC_RELEASE);
+}
+
+bool SensorManager::reconfigure(SensorConfiguration *config)
+{
+    if (!initialized || config == nullptr)
+        return false;
+
+    activeConfig = config;
+    ProximityRegisters target = registersFor(*config);
+    SensorMask activeMask = 0;
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (sensorsActive[i])
+            activeMask |= 1 << i;
+    }
+
+    if (registersKnownMask == activeMask && memcmp(&target, &appliedRegisters, sizeof(target)) == 0)
+    {
+        Serial.println("  Sensor registers unchanged");
+        return true;
+    }
+
+    if (!isCollecting())
+    {
+        unsigned long start = micros();
+        bool ok = writeRegisterDelta(target);
+        Serial.printf("  Sensor registers updated in %lu us%s\n", micros() - start, ok ? "" : " (write failed)");
+        return ok;
+    }
+
+    // Hybrid and active force own PS_CONF1/2 and PS_CONF3 while collecting
+    if (hybridMode || activeForce)
+    {
+        Serial.println("  Live register update unavailable in hybrid / active force collection");
+        return false;
+    }
+
+    // Hand the new image to the sensor task; it writes it between cycles
+    pendingRegisters = target;
+    __atomic_store_n(&registerUpdatePending, true, __ATOMIC_RELEASE);
+
+    unsigned long start = millis();
+    while (__atomic_load_n(&registerUpdatePending, __ATOMIC_ACQUIRE) &&
+           millis() - start < SENSOR_RECONFIG_TIMEOUT_MS && isCollecting())
+        delay(1);
+
+    if (__atomic_load_n(&registerUpdatePending, __ATOMIC_ACQUIRE))
+    {
+        Serial.println("  WARNING: Sensor task did not take the register update");
+        return false;
+    }
+    Serial.printf("  Sensor registers updated live in %lu ms%s\n", millis() - start,
+                  registerUpdateOk ? "" : " (write failed)");
+    return registerUpdateOk;
+}
+
 bool SensorManager::reinitialize(SensorConfiguration *config)
 {
     Serial.println("Reinitializing sensors with new configuration...");
@@ -1194,14 +2786,14 @@ bool SensorManager::reinitialize(SensorConfiguration *config)
             {
                 Serial.printf("    Switching TCA channel %d -> %d, cleaning up...\n", lastTcaChannel, tca_ch);
                 // Select the old TCA channel and disable its PCA
-                mux.selectChannel(lastTcaChannel);
+                selectBoard(lastTcaChannel);
                 delay(5);
                 pca_instances[lastTcaChannel].disableAllChannels();
                 delay(5);
             }
 
             // Select TCA channel for this sensor board
-            if (!mux.selectChannel(tca_ch))
+            if (!selectBoard(tca_ch))
             {
                 Serial.printf("    WARNING: Failed to select TCA channel %d\n", tca_ch);
                 continue;
@@ -1231,7 +2823,7 @@ bool SensorManager::reinitialize(SensorConfiguration *config)
     // Clean up
     Serial.println("  Cleaning up multiplexer channels...");
     // IMPORTANT: Must select each TCA channel before disabling its PCA!
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
     {
         mux.selectChannel(i);
         delay(2);
@@ -1284,8 +2876,10 @@ void SensorManager::dumpSensorConfiguration()
             continue;
         }
 
+        TwoWire &bus = wireFor(tca_ch);
+
         // Select the sensor's channel with proper delays
-        if (!mux.selectChannel(tca_ch))
+        if (!selectBoard(tca_ch))
         {
             Serial.printf("║ %-6s │  %d  │  %d  │  YES   │  TCA ERR    │   TCA ERR   │ ERR   │   ERR    ║\n",
                           sensorName, tca_ch, pca_ch);
@@ -1302,17 +2896,17 @@ void SensorManager::dumpSensorConfiguration()
         delay(10); // Increased delay for multiplexer settling
 
         // Verify we can communicate with the sensor by checking device ID first
-        Wire.beginTransmission(0x60);
-        Wire.write(0x0C); // Device ID register
-        if (Wire.endTransmission(false) != 0)
+        bus.beginTransmission(0x60);
+        bus.write(0x0C); // Device ID register
+        if (bus.endTransmission(false) != 0)
         {
             Serial.printf("║ %-6s │  %d  │  %d  │  YES   │  I2C ERR    │   I2C ERR   │ ERR   │   ERR    ║\n",
                           sensorName, tca_ch, pca_ch);
             continue;
         }
-        Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-        uint8_t id_low = Wire.available() ? Wire.read() : 0;
-        uint8_t id_high = Wire.available() ? Wire.read() : 0;
+        bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+        uint8_t id_low = bus.available() ? bus.read() : 0;
+        uint8_t id_high = bus.available() ? bus.read() : 0;
         uint16_t device_id = (id_high << 8) | id_low;
 
         if (device_id != 0x0186)
@@ -1324,29 +2918,29 @@ void SensorManager::dumpSensorConfiguration()
 
         // Read PS_CONF1/2 register (0x03) - contains integration time, duty cycle, high-res
         uint8_t ps_conf1_low = 0, ps_conf1_high = 0;
-        Wire.beginTransmission(0x60);
-        Wire.write(0x03);
-        if (Wire.endTransmission(false) == 0)
+        bus.beginTransmission(0x60);
+        bus.write(0x03);
+        if (bus.endTransmission(false) == 0)
         {
-            Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-            if (Wire.available() >= 2)
+            bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+            if (bus.available() >= 2)
             {
-                ps_conf1_low = Wire.read();
-                ps_conf1_high = Wire.read();
+                ps_conf1_low = bus.read();
+                ps_conf1_high = bus.read();
             }
         }
 
         // Read PS_CONF3/PS_MS register (0x04) - contains LED current
         uint8_t ps_ms_low = 0, ps_ms_high = 0;
-        Wire.beginTransmission(0x60);
-        Wire.write(0x04);
-        if (Wire.endTransmission(false) == 0)
+        bus.beginTransmission(0x60);
+        bus.write(0x04);
+        if (bus.endTransmission(false) == 0)
         {
-            Wire.requestFrom((uint8_t)0x60, (uint8_t)2);
-            if (Wire.available() >= 2)
+            bus.requestFrom((uint8_t)0x60, (uint8_t)2);
+            if (bus.available() >= 2)
             {
-                ps_ms_low = Wire.read();
-                ps_ms_high = Wire.read();
+                ps_ms_low = bus.read();
+                ps_ms_high = bus.read();
             }
         }
 
@@ -1420,7 +3014,7 @@ void SensorManager::dumpSensorConfiguration()
 
     // Clean up
     // IMPORTANT: Must select each TCA channel before disabling its PCA!
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < SENSOR_MAX_BOARDS; i++)
     {
         mux.selectChannel(i);
         delay(2);
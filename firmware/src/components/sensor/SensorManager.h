@@ -3,61 +3,109 @@
 
 #include <Arduino.h>
 #include <vector>
+#include <esp_timer.h>
+#include <freertos/semphr.h>
+#include <Wire.h>
 #include "../tca9548a/TCA9548A.h"
+#include "../i2c/I2CTransactionEngine.h"
+#include "../i2c/I2CBusHealth.h"
+#include "../memory/SPSCRing.h"
 #include <Adafruit_VCNL4040.h>
 #include "SensorConfiguration.h"
+#include "SensorFrame.h"
+#include "AdaptiveRateScheduler.h"
 
 // Forward declaration for session confirmation counters
 struct SessionSummary;
 
 // Sensor configuration
-#define NUM_SENSORS 6
 #define SAMPLE_RATE_HZ 1000
 #define SAMPLE_INTERVAL_US (1000000 / SAMPLE_RATE_HZ)
+#define SAMPLE_RATE_MAX_HZ 2000 // Timer periods shorter than 500 us are rejected
+
+// Active force: slack added to IT x pulses before a triggered result is read
+#ifndef ACTIVE_FORCE_MARGIN_US
+#define ACTIVE_FORCE_MARGIN_US 250
+#endif
+
+// duplicate_mode "suppress": a held (unchanged) position is sent again once
+// its last sent value is this old, so consumers never see it go stale (kept
+// below ML_RESAMPLE_MAX_GAP_MS)
+#ifndef SENSOR_DUPLICATE_HOLD_MAX_MS
+#define SENSOR_DUPLICATE_HOLD_MAX_MS 15
+#endif
+
+// Use the pre-built IDF command-link cycle instead of per-read Wire calls.
+// Falls back to the Wire path automatically if the plan fails to build/run.
+#ifndef SENSOR_I2C_ENGINE
+#define SENSOR_I2C_ENGINE true
+#endif
+
+// reconfigure() while collecting: how long to wait for the sensor task to
+// write the new registers (it does so after the current cycle)
+#ifndef SENSOR_RECONFIG_TIMEOUT_MS
+#define SENSOR_RECONFIG_TIMEOUT_MS 100
+#endif
+
+// Boards are split across up to two I2C controllers (Wire, Wire1); see
+// PIN_IIC1_SDA / SENSOR_BOARD_BUS in pin_config.h. Each bus runs its share
+// of the queued cycle concurrently with the other.
+#define SENSOR_I2C_BUSES 2
 
 // Simple PCA9546A wrapper class (for local multiplexing on each sensor board)
+// Caches the last channel mask written so redundant selects cost no bus time.
+// 0xFF = unknown (after construction, a failed write, or invalidateCache()).
 class PCA9546A
 {
 private:
     uint8_t address;
+    TwoWire *wire;
+    uint8_t currentMask = 0xFF;
+
+    bool writeMask(uint8_t mask)
+    {
+        if (currentMask == mask)
+            return true;
+        wire->beginTransmission(address);
+        wire->write(mask);
+        if (wire->endTransmission() == 0)
+        {
+            currentMask = mask;
+            return true;
+        }
+        currentMask = 0xFF;
+        return false;
+    }
 
 public:
-    PCA9546A(uint8_t addr = 0x70) : address(addr) {}
+    PCA9546A(uint8_t addr = 0x70, TwoWire *bus = &Wire) : address(addr), wire(bus) {}
 
     bool begin()
     {
-        Wire.beginTransmission(address);
-        return (Wire.endTransmission() == 0);
+        wire->beginTransmission(address);
+        return (wire->endTransmission() == 0);
     }
 
     bool selectChannel(uint8_t channel)
     {
         if (channel > 3)
             return false;
-        Wire.beginTransmission(address);
-        Wire.write(1 << channel);
-        return (Wire.endTransmission() == 0);
+        return writeMask(1 << channel);
     }
 
     bool disableAllChannels()
     {
-        Wire.beginTransmission(address);
-        Wire.write(0x00);
-        return (Wire.endTransmission() == 0);
+        return writeMask(0x00);
     }
-};
 
-// Sensor reading structure
-struct SensorReading
-{
-    uint32_t timestamp_us; // Microsecond timestamp (was timestamp_ms prior to microsecond-timestamps initiative)
-    uint8_t position;      // 0-5 (sensor array index)
-    uint8_t pcb_id;        // 1-3 (which sensor board: P1, P2, P3)
-    uint8_t side;          // 1-2 (which sensor on board: S1, S2)
-    uint16_t proximity;
-    uint16_t ambient;
+    void invalidateCache() { currentMask = 0xFF; }
 };
 
+// Core 0 → Core 1 hand-off: 512 cycles ≈ 0.5 s of headroom at 1 kHz (16 KB
+// with 3 boards; frames grow with SENSOR_MAX_BOARDS)
+#define SENSOR_FRAME_RING_SLOTS 512
+typedef SPSCRing<SensorFrame, SENSOR_FRAME_RING_SLOTS> SensorFrameRing;
+
 // Sensor metadata structure
 struct SensorMetadata
 {
@@ -74,36 +122,65 @@ private:
     TCA9548A mux;
     Adafruit_VCNL4040 sensors[NUM_SENSORS];
 
-    // PCA9546A multiplexers (one per sensor board, up to 3 boards)
-    PCA9546A pca_instances[3] = {PCA9546A(0x74), PCA9546A(0x75), PCA9546A(0x76)};
-    uint8_t pca_addresses[3] = {0, 0, 0}; // Detected addresses (0 = not found)
+    // PCA9546A multiplexers (one per sensor board, up to SENSOR_MAX_BOARDS)
+    PCA9546A pca_instances[SENSOR_MAX_BOARDS];
+    uint8_t pca_addresses[SENSOR_MAX_BOARDS] = {0}; // Detected addresses (0 = not found)
+    uint8_t boardMask = 0;                          // Boards initializePCA() found (bit = TCA channel)
+
+    // Bus per board (0 = Wire behind the TCA, 1 = Wire1 without TCA).
+    // Fixed at construction from pin_config.h.
+    uint8_t boardBus[SENSOR_MAX_BOARDS] = {0};
+    bool dualBus = false; // Any board on Wire1
 
     // Sensor mapping structure
     struct SensorMap
     {
-        uint8_t tca_channel; // 0-2 (which sensor board on TCA)
+        uint8_t tca_channel; // Which sensor board (TCA channel)
         uint8_t pca_channel; // 0-1 (which sensor on board: S1/S2)
     };
 
-    const SensorMap sensorMapping[NUM_SENSORS] = {
-        {0, 0}, // Sensor 0: P1S1 (TCA0, PCA0)
-        {0, 1}, // Sensor 1: P1S2 (TCA0, PCA1)
-        {1, 0}, // Sensor 2: P2S1 (TCA1, PCA0)
-        {1, 1}, // Sensor 3: P2S2 (TCA1, PCA1)
-        {2, 0}, // Sensor 4: P3S1 (TCA2, PCA0)
-        {2, 1}  // Sensor 5: P3S2 (TCA2, PCA1)
-    };
+    // Position -> board/side (P1S1, P1S2, P2S1, ...), built at construction
+    // for every position the capacity allows; init() activates the ones on
+    // boards that were found
+    SensorMap sensorMapping[NUM_SENSORS];
 
     bool initialized = false;
     bool sensorsActive[NUM_SENSORS] = {false}; // Track which sensors initialized
     TaskHandle_t sensorTask = NULL;
-    QueueHandle_t dataQueue = NULL;
+    SensorFrameRing *frameRing = nullptr; // Producer side (this task only)
+    SensorFrameRing *frameTap = nullptr;  // Optional second consumer (detection), producer side
+    TaskHandle_t frameTapTask = nullptr;  // Notified after each push into frameTap
     SensorConfiguration *activeConfig = nullptr; // Reference to active configuration
 
+    // Proximity register image (PS_CONF1/2 at 0x03, PS_CONF3/PS_MS at 0x04)
+    // last written to the sensors in registersKnownMask; every sensor gets
+    // the same image. reconfigure() writes only what differs from it.
+    struct ProximityRegisters
+    {
+        uint8_t conf1;
+        uint8_t conf2;
+        uint8_t conf3;
+        uint8_t ms;
+    };
+    ProximityRegisters appliedRegisters = {};
+    SensorMask registersKnownMask = 0;
+
+    // Live reconfiguration: the sensor task writes pendingRegisters after
+    // the cycle in progress and clears the flag
+    ProximityRegisters pendingRegisters = {};
+    volatile bool registerUpdatePending = false;
+    volatile bool registerUpdateOk = false;
+
     // Baseline cancellation values per sensor (for PS_CANC register)
     // These values are subtracted by the sensor hardware to compensate for
     // cover window reflections and other constant offsets
     uint16_t baselineValues[NUM_SENSORS] = {0};
+    SensorMask cancellationMask = 0; // Sensors whose baselineValues are in PS_CANC
+
+    // Live PS_CANC adjustment (adjustCancellation()): the sensor task writes
+    // pendingCancellation for the sensors in the mask between cycles
+    uint16_t pendingCancellation[NUM_SENSORS] = {0};
+    volatile SensorMask cancellationPending = 0;
 
     // Graceful shutdown flag - volatile because accessed from multiple cores
     volatile bool stopRequested = false;
@@ -113,11 +190,119 @@ private:
     // Written only from Core 0 sensor task — no synchronization needed.
     struct SessionSummary *activeSummary = nullptr;
 
+    // Queued I2C cycle: mux selects + register reads for all active sensors,
+    // built once per collection and replayed every sample interval.
+    // Raw little-endian bytes land in cycleRxBuffer: [PS_L, PS_H, ALS_L, ALS_H]
+    // One plan per bus; both run concurrently (Wire1's on busWorkerTask).
+    I2CTransactionEngine cycleEngines[SENSOR_I2C_BUSES] = {{I2C_NUM_0}, {I2C_NUM_1}};
+    bool cycleBusUsed[SENSOR_I2C_BUSES] = {false, false};
+    uint8_t cycleRxBuffer[NUM_SENSORS][4] = {{0}};
+    bool cycleReadsAmbient = false;
+    uint32_t lastCycleDurationUs = 0; // Wall time of the last executeCycle()
+    uint32_t lastCycleStartUs = 0;    // micros() when it started
+    bool lastCycleParallel = false;   // ...with the buses in parallel
+
+    // skew_compensation: frames carry each position's sample instant
+    // (SensorFrame::offset_us). Queued reads are not timed one by one, so a
+    // read is placed at the middle of its slot in its bus plan (planSlot of
+    // planSlotCount, same order for the read and trigger plans).
+    bool skewCompensation = false; // Captured at startCollection()
+    uint8_t planSlot[NUM_SENSORS] = {0};
+    uint8_t planSlotCount[SENSOR_I2C_BUSES] = {0};
+
+    // Active force mode: sensors convert only when triggered (PS_TRIG).
+    // All sensors are triggered in one round right after a cycle's reads,
+    // so they sample together and the conversion overlaps the timer wait;
+    // the next cycle reads the results.
+    bool activeForce = false;      // Captured at startCollection()
+    uint8_t afConf3 = 0;           // PS_CONF3 (multi-pulse + PS_AF); PS_TRIG is added per trigger
+    uint8_t afPsMs = 0;            // PS_MS, always written together with PS_CONF3
+    uint32_t afConversionUs = 0;   // IT x pulses + ACTIVE_FORCE_MARGIN_US
+    uint32_t afTriggerStartUs = 0; // Sample instant of the pending conversion
+    uint32_t afTriggerEndUs = 0;   // Last trigger sent; conversion done afConversionUs later
+    uint16_t afTriggerOffsetUs[NUM_SENSORS] = {0}; // Each sensor's trigger - afTriggerStartUs (skew_compensation)
+    I2CTransactionEngine triggerEngines[SENSOR_I2C_BUSES] = {{I2C_NUM_0}, {I2C_NUM_1}};
+
+    // Repeated-value tracker: a reading equal to the sensor's previous one
+    // is most likely a stale conversion read twice
+    uint16_t lastProximity[NUM_SENSORS] = {0};
+    SensorMask lastProximityMask = 0;
+
+    // duplicate_mode "suppress": repeats are marked held instead of sent
+    // (SensorFrame::held_mask); last value and time each position was sent
+    bool suppressDuplicates = false; // Captured at startCollection()
+    uint16_t lastAmbient[NUM_SENSORS] = {0};
+    uint32_t lastSentUs[NUM_SENSORS] = {0};
+
+    // Bus health: the sensor task reports every read; quarantined sensors
+    // and sensors on a bus in fault are left out of the cycle (planExcluded
+    // is what the queued plans were built without)
+    I2CBusHealth busHealth;
+    SensorMask planExcluded = 0;
+    SensorMask busSensors[SENSOR_I2C_BUSES] = {0}; // Active sensors per bus
+
+    // Executes the Wire1 plan while the sensor task runs Wire's
+    TaskHandle_t busWorkerTask = NULL;
+    SemaphoreHandle_t busWorkerDone = NULL;
+    I2CTransactionEngine *volatile busWorkerPlan = nullptr;
+    volatile esp_err_t busWorkerResult = ESP_OK;
+    volatile bool busWorkerStop = false;
+    bool busWorkerRunning = false; // Handed a plan, completion not taken yet (sensor task side)
+
+    // Duration of the last readSensor() bus transaction (written on Core 0)
+    uint32_t lastReadLatencyUs = 0;
+
+    // Sticky scan order: active sensors grouped by board so both sensors on a
+    // board are read under a single TCA select. The polling loop walks this
+    // list forward and backward on alternate cycles (serpentine), so the first
+    // sensor of a cycle is the one already selected at the end of the last.
+    uint8_t scanOrder[NUM_SENSORS] = {0};
+    uint8_t scanCount = 0;
+
+    // Periodic esp_timer that paces the sensor task. Each tick is a task
+    // notification; the task blocks in between instead of spinning on micros().
+    esp_timer_handle_t sampleTimer = nullptr;
+    uint32_t samplePeriodUs = SAMPLE_INTERVAL_US;
+
+    // Hybrid mode: sensors wait in a low-duty interrupt configuration with
+    // the sample timer stopped; a board INT line wakes the sensor task
+    // (same notification as a timer tick) and starts a polling burst.
+    // Sensors outside burstSensorMask are skipped by the cycle loop. Boards
+    // without an INT line (past the third) cannot end the idle; they join
+    // every burst.
+    bool hybridMode = false;           // Captured at startCollection()
+    bool burstActive = false;          // Sensor task only
+    volatile bool hybridArmed = false; // ISR may wake the task
+    volatile uint8_t hybridBoardMask = 0; // Boards whose INT fired (bit = TCA channel)
+    volatile uint32_t sleepWakeUs = 0;    // Light sleep ended by an INT line; 0 = no wake pending
+    SensorMask burstSensorMask = SENSOR_MASK_ALL;
+    uint32_t burstStartMs = 0;
+    uint32_t burstLastActivityMs = 0;
+    uint16_t hybridThresholdHigh[NUM_SENSORS] = {0}; // PS_THDH; also the burst activity level
+    uint16_t hybridThresholdLow[NUM_SENSORS] = {0};  // PS_THDL
+    static SensorManager *hybridInstance;              // For the GPIO ISRs
+
+    // Adaptive rate: the sensor task restarts the sample timer with
+    // idlePeriodUs while the scheduler reports no detector activity
+    AdaptiveRateScheduler *rateScheduler = nullptr;
+    bool adaptiveRate = false;     // Captured at startCollection()
+    uint32_t fullPeriodUs = SAMPLE_INTERVAL_US;
+    uint32_t idlePeriodUs = SAMPLE_INTERVAL_US;
+    uint32_t collectionStartMs = 0; // Rate timeline offsets
+    uint32_t idleRateSinceMs = 0;
+
     bool initializePCA();
     void cleanupI2CBus(); // Clean up I2C bus state
     void debugI2CScan();  // Debug: scan I2C bus on each TCA channel
     static void sensorTaskFunction(void *parameter);
+    static void sampleTimerCallback(void *arg);
+    uint32_t resolveSamplePeriodUs() const; // From activeConfig->sample_rate_hz
     bool calibrateSensorBaseline(uint8_t sensorIndex); // Calibrate single sensor PS_CANC
+    bool writeCancellation(TwoWire &bus, uint16_t value, bool verify = true); // Selected sensor: write PS_CANC
+    void applyPendingCancellation(); // Sensor task: write pendingCancellation
+    bool recoverBus(uint8_t bus);              // Sensor task: clear, restart, verify mux; false if still down
+    bool verifyMuxState(uint8_t bus);          // Close every PCA (and the TCA) on bus and read them back
+    void restoreSensors(SensorMask sensors);   // Sensor task: rewrite registers + PS_CANC after an outage
 
     // Configuration helpers
     VCNL4040_LEDCurrent parseLEDCurrent(const String &current);
@@ -125,19 +310,123 @@ private:
     VCNL4040_LEDDutyCycle parseDutyCycle(const String &duty);
     uint8_t parseMultiPulse(const String &mp); // Multi-pulse mode: 1, 2, 4, or 8 pulses
     bool applySensorConfig(uint8_t sensorIndex);
+    ProximityRegisters registersFor(const SensorConfiguration &config);
+    bool writeRegisterDelta(const ProximityRegisters &target); // Changed registers, one board select per board
+    void applyPendingRegisters();                              // Sensor task
+
+    // I2C cycle engine helpers
+    bool buildCyclePlan();
+    bool buildPlan(I2CTransactionEngine *plans, bool trigger); // Reads, or active force triggers
+    bool cyclePlanReady(const I2CTransactionEngine *plans) const;
+    esp_err_t executeCycle(I2CTransactionEngine *plans); // Both buses' plans, concurrently when both are used
+    bool startBusWorker();
+    void stopBusWorker();
+    bool joinBusWorker(TickType_t wait); // Take the worker's completion; false if still running
+    static void busWorkerFunction(void *parameter);
+    void decodeCycleReading(uint8_t sensorIndex, SensorReading &reading);
+    uint32_t planSlotUs(uint8_t sensorIndex) const; // Estimated instant of its op in the last executeCycle()
+    void buildScanOrder();
+    void invalidateMuxCache(); // Forget cached TCA/PCA state (after raw bus access)
+
+    // Hybrid mode helpers (sensor task, except prepareHybrid)
+    bool prepareHybrid();                    // Thresholds from the current level, attach ISRs
+    void enterHybridIdle();                  // Stop timer, idle duty + INT enabled, arm ISRs
+    void startBurst();                       // Full duty, INT off, start timer
+    void addBurstBoards(uint8_t boards);     // Switch these boards' sensors to polling
+    bool updateBurst(const SensorFrame &frame); // false once the burst window has elapsed
+    void releaseHybrid();                    // Detach ISRs, restore polling configuration
+    bool writeProximityMode(uint8_t sensorIndex, VCNL4040_LEDDutyCycle duty, bool interruptEnabled);
+
+    // Active force helpers
+    bool setActiveForce(bool enable); // PS_AF on every active sensor (Wire path)
+    void triggerConversions();        // One PS_TRIG round (sensor task)
+    void waitForConversion();         // Spin out the rest of the conversion, if any
+
+    // Adaptive rate helpers (sensor task)
+    bool applyAdaptiveRate();              // Follow the scheduler; true if the period changed
+    void recordRate(uint32_t nowMs);       // Timeline entry for the current period
+    void finishAdaptiveRate();             // Close the idle span at collection end
+    bool selectSensor(uint8_t sensorIndex);
+    bool selectBoard(uint8_t board); // TCA channel on Wire; other boards' PCAs off on Wire1
+    TwoWire &wireFor(uint8_t board) { return boardBus[board] ? Wire1 : Wire; }
+    i2c_port_t portFor(uint8_t board) const { return boardBus[board] ? I2C_NUM_1 : I2C_NUM_0; }
+    static void IRAM_ATTR hybridIsr(uint8_t board);
+    static void IRAM_ATTR hybridIsrBoard0();
+    static void IRAM_ATTR hybridIsrBoard1();
+    static void IRAM_ATTR hybridIsrBoard2();
 
 public:
     SensorManager();
     bool init(SensorConfiguration *config = nullptr);
-    bool startCollection(QueueHandle_t queue, SessionSummary *summary = nullptr);
+    bool startCollection(SensorFrameRing *ring, SessionSummary *summary = nullptr);
+    // Also push every cycle into tap (e.g. DetectionTask) and notify its
+    // consumer task, if given. Set while not collecting.
+    void setFrameTap(SensorFrameRing *tap, TaskHandle_t consumer = nullptr)
+    {
+        frameTap = tap;
+        frameTapTask = consumer;
+    }
+    // Detector-driven idle rate (adaptive_rate). Set while not collecting.
+    void setRateScheduler(AdaptiveRateScheduler *scheduler) { rateScheduler = scheduler; }
+
+    // Hybrid collection waiting for an INT line (timer stopped): may light sleep
+    bool isHybridIdle() const { return hybridMode && hybridArmed; }
+
+    /**
+     * A light sleep ended with these boards' INT lines low: start the burst
+     * as their ISRs would, and time wakeUs -> first frame (SessionSummary)
+     */
+    void wakeFromSleep(uint8_t boards, uint32_t wakeUs);
     void stopCollection();
     bool isCollecting();
     bool readSensor(uint8_t sensorIndex, SensorReading &reading);
+    uint32_t getLastReadLatencyUs() const { return lastReadLatencyUs; }
     std::vector<SensorMetadata> getSensorMetadata();
     bool reinitialize(SensorConfiguration *config);
+
+    /**
+     * Apply a config change by writing only the VCNL4040 registers that
+     * differ from the last written ones (LED current, IT, duty, multi-pulse,
+     * high resolution), one TCA select per board. While collecting, the
+     * sensor task writes them between two cycles and collection goes on.
+     * No PCA discovery, settle delays or read-back. Settings captured at
+     * startCollection() (mode, rate, ambient, active force, hybrid,
+     * adaptive) take effect at the next start.
+     * @return false if a write failed or a live update is not possible
+     *         (hybrid / active force collection): use reinitialize()
+     */
+    bool reconfigure(SensorConfiguration *config);
+    // Registers were written behind our back: next reconfigure() writes all
+    void forgetRegisters() { registersKnownMask = 0; }
     void dumpSensorConfiguration();                 // Diagnostic: print all sensor configs to serial
     bool calibrateProximityCancellation();          // Calibrate PS_CANC for all sensors (cover offset)
-    uint16_t getBaselineValue(uint8_t sensorIndex); // Get stored baseline for a sensor
+    uint16_t getBaselineValue(uint8_t sensorIndex) const; // Get stored baseline for a sensor
+    SensorMask getCancellationMask() const { return cancellationMask; } // Sensors with PS_CANC set
+
+    // Bus health (see I2CBusHealth.h). Events are for loop() only.
+    bool popHealthEvent(I2CHealthEvent &event) { return busHealth.popEvent(event); }
+    I2CHealthStats getBusHealthStats() const { return busHealth.getStats(); }
+    SensorMask getQuarantinedSensors() const { return busHealth.getQuarantined(); }
+
+    // Discovered topology (valid after init())
+    uint8_t getBoardMask() const { return boardMask; } // Bit = TCA channel with a board
+    uint8_t getBoardCount() const { return __builtin_popcount(boardMask); }
+    uint8_t getActiveSensorCount() const;
+
+    /**
+     * Write stored PS_CANC values (CalibrationStore) without sampling
+     * @param values One per sensor; only sensors in mask are written
+     * @return false if collecting or a write failed
+     */
+    bool restoreProximityCancellation(const uint16_t *values, SensorMask mask);
+
+    /**
+     * Move one sensor's PS_CANC to value without sampling (background
+     * calibration). While collecting, the sensor task writes it after the
+     * cycle in progress; never blocks.
+     * @return false if the sensor is inactive or the write failed
+     */
+    bool adjustCancellation(uint8_t sensorIndex, uint16_t value);
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,20 @@
 #include "SerialStudioOutput.h"
 
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+static uint16_t crc16(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
 void SerialStudioOutput::begin(
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> *buffer,
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> *buffer,
     DirectionDetector *detector)
 {
     _buffer = buffer;
@@ -10,6 +23,7 @@ void SerialStudioOutput::begin(
     _pollCount = 0;
     _pollRate = 0;
     _sensorRate = 0;
+    _decimationCount = 0;
     resetIndex();
 }
 
@@ -47,9 +61,28 @@ void SerialStudioOutput::cacheDetection(const DetectionResult &result)
 
 void SerialStudioOutput::update()
 {
-    if (!_enabled || !_buffer)
+    if (!_enabled || (!_buffer && !_ring))
         return;
 
+    // Ring: emit what arrived since the last pass (at most what it still holds)
+    if (_ring)
+    {
+        size_t pushed = _ring->pushedCount();
+        if (pushed < _lastProcessedIndex)
+            resetIndex();
+        size_t fresh = pushed - _lastProcessedIndex;
+        if (fresh == 0)
+            return;
+        if (fresh > _ring->size())
+            fresh = _ring->size();
+
+        updateRates();
+        for (size_t i = _ring->size() - fresh; i < _ring->size(); i++)
+            emitFrame((*_ring)[i]);
+        _lastProcessedIndex = pushed;
+        return;
+    }
+
     size_t bufferSize = _buffer->size();
 
     // Buffer index safety: detect external buffer clears
@@ -62,6 +95,18 @@ void SerialStudioOutput::update()
     if (bufferSize == 0 || _lastProcessedIndex >= bufferSize)
         return;
 
+    updateRates();
+
+    for (size_t i = _lastProcessedIndex; i < bufferSize; i++)
+    {
+        emitFrame((*_buffer)[i]);
+    }
+
+    _lastProcessedIndex = bufferSize;
+}
+
+void SerialStudioOutput::updateRates()
+{
     // Update rates every second
     unsigned long now = millis();
     if (now - _rateWindowStart >= 1000)
@@ -69,57 +114,79 @@ void SerialStudioOutput::update()
         _pollRate = _pollCount;
         _pollCount = 0;
         _sensorRate = calculateSensorRate();
+        updateConfigFields();
+        updateLatency();
         _rateWindowStart = now;
     }
+}
 
-    for (size_t i = _lastProcessedIndex; i < bufferSize; i++)
-    {
-        const SensorReading &reading = (*_buffer)[i];
-
-        if (!_hasPendingFrame)
-        {
-            resetAccumulator(reading.timestamp_us);
-        }
-        else if (reading.timestamp_us != _currentTimestamp)
-        {
-            emitFrame();
-            resetAccumulator(reading.timestamp_us);
-        }
+void SerialStudioOutput::updateLatency()
+{
+    LatencyPercentiles total = LatencyTracker::get(LatencyTracker::lastWasML(), LatencyStage::TOTAL);
+    _latencyLastMs = LatencyTracker::lastTotalUs() / 1000.0f;
+    _latencyP50Ms = total.p50 / 1000.0f;
+    _latencyP95Ms = total.p95 / 1000.0f;
+    _latencyP99Ms = total.p99 / 1000.0f;
+}
 
-        if (reading.position < NUM_SENSORS)
-        {
-            _accumulator[reading.position] = reading.proximity;
-            _slotFilled[reading.position] = true;
-        }
+void SerialStudioOutput::updateConfigFields()
+{
+    if (!_config)
+    {
+        _intTimeNum = _ledCurNum = _dutyCycNum = _multiPulseNum = 0;
+        return;
     }
 
-    _lastProcessedIndex = bufferSize;
+    _intTimeNum = _config->integration_time.toInt();
+    _ledCurNum = _config->led_current.toInt();
+    int slash = _config->duty_cycle.indexOf('/');
+    _dutyCycNum = (slash >= 0) ? _config->duty_cycle.substring(slash + 1).toInt() : _config->duty_cycle.toInt();
+    _multiPulseNum = _config->multi_pulse.toInt();
 }
 
-void SerialStudioOutput::emitFrame()
+void SerialStudioOutput::emitFrame(const SensorFrame &frame)
 {
-    if (!_hasPendingFrame)
-        return;
-
     _pollCount++;
 
-    uint16_t intTimeNum = _config ? _config->integration_time.toInt() : 0;
-    uint16_t ledCurNum = _config ? _config->led_current.toInt() : 0;
-    uint16_t dutyCycNum = 0;
-    if (_config)
+    for (int i = 0; i < NUM_SENSORS; i++)
     {
-        int slash = _config->duty_cycle.indexOf('/');
-        dutyCycNum = (slash >= 0) ? _config->duty_cycle.substring(slash + 1).toInt() : _config->duty_cycle.toInt();
+        if (frame.isValid(i))
+            _lastProximity[i] = frame.proximity[i];
     }
-    uint16_t multiPulseNum = _config ? _config->multi_pulse.toInt() : 0;
 
+    if (++_decimationCount < _decimation)
+        return;
+    _decimationCount = 0;
+
+    // Held positions (duplicate_mode "suppress") plot their last value, not 0
+    const SensorFrame *out = &frame;
+    SensorFrame filled;
+    if (frame.held_mask != 0)
+    {
+        filled = frame;
+        for (int i = 0; i < NUM_SENSORS; i++)
+        {
+            if (frame.held_mask & (1 << i))
+                filled.proximity[i] = _lastProximity[i];
+        }
+        out = &filled;
+    }
+
+    if (_format == SerialStudioFormat::BINARY)
+        emitBinary(*out);
+    else
+        emitCSV(*out);
+}
+
+void SerialStudioOutput::emitCSV(const SensorFrame &frame)
+{
     if (_emitTelemetry && _detector)
     {
-        Serial.printf("/*%lu,%u,%u,%u,%u,%u,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%d,%.1f,%.1f,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu*/\n",
-                      _currentTimestamp,
-                      _accumulator[0], _accumulator[1],
-                      _accumulator[2], _accumulator[3],
-                      _accumulator[4], _accumulator[5],
+        Serial.printf("/*%lu,%u,%u,%u,%u,%u,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%d,%.1f,%.1f,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%.1f,%.1f,%.1f,%.1f*/\n",
+                      frame.timestamp_us,
+                      frame.proximity[0], frame.proximity[1],
+                      frame.proximity[2], frame.proximity[3],
+                      frame.proximity[4], frame.proximity[5],
                       _detector->getSensorThreshold(0),
                       _detector->getSensorThreshold(1),
                       _detector->getSensorThreshold(2),
@@ -132,67 +199,116 @@ void SerialStudioOutput::emitFrame()
                       _cachedSpeedMs,
                       _sensorRate,
                       _pollRate,
-                      intTimeNum, ledCurNum, dutyCycNum, multiPulseNum,
+                      _intTimeNum, _ledCurNum, _dutyCycNum, _multiPulseNum,
                       _cachedPeakA, _cachedPeakB,
                       _cachedWaveDurA, _cachedWaveDurB,
-                      _cachedComGap);
+                      _cachedComGap,
+                      _latencyLastMs, _latencyP50Ms, _latencyP95Ms, _latencyP99Ms);
     }
     else
     {
         Serial.printf("/*%lu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u*/\n",
-                      _currentTimestamp,
-                      _accumulator[0], _accumulator[1],
-                      _accumulator[2], _accumulator[3],
-                      _accumulator[4], _accumulator[5],
+                      frame.timestamp_us,
+                      frame.proximity[0], frame.proximity[1],
+                      frame.proximity[2], frame.proximity[3],
+                      frame.proximity[4], frame.proximity[5],
                       _sensorRate,
                       _pollRate,
-                      intTimeNum, ledCurNum, dutyCycNum, multiPulseNum);
+                      _intTimeNum, _ledCurNum, _dutyCycNum, _multiPulseNum);
+    }
+}
+
+void SerialStudioOutput::emitBinary(const SensorFrame &frame)
+{
+    if (_emitTelemetry && _detector)
+    {
+        SerialStudioTelemetryFrame out;
+        out.type = 2;
+        out.timestampUs = frame.timestamp_us;
+        memcpy(out.proximity, frame.proximity, sizeof(out.proximity));
+        for (int i = 0; i < NUM_SENSORS; i++)
+            out.threshold[i] = _detector->getSensorThreshold(i);
+        out.detectedModule = _cachedDetModule;
+        out.direction = (uint8_t)_cachedDirection;
+        out.confidence = _cachedConfidence;
+        out.speedMs = _cachedSpeedMs;
+        out.sensorRate = _sensorRate;
+        out.pollRate = _pollRate;
+        out.integrationTime = _intTimeNum;
+        out.ledCurrent = _ledCurNum;
+        out.dutyCycle = _dutyCycNum;
+        out.multiPulse = _multiPulseNum;
+        out.peakA = _cachedPeakA;
+        out.peakB = _cachedPeakB;
+        out.waveDurationA = _cachedWaveDurA;
+        out.waveDurationB = _cachedWaveDurB;
+        out.comGapMs = _cachedComGap;
+        out.latencyLastMs = _latencyLastMs;
+        out.latencyP50Ms = _latencyP50Ms;
+        out.latencyP95Ms = _latencyP95Ms;
+        out.latencyP99Ms = _latencyP99Ms;
+        writeFramed((const uint8_t *)&out, sizeof(out));
+    }
+    else
+    {
+        SerialStudioRawFrame out;
+        out.type = 1;
+        out.timestampUs = frame.timestamp_us;
+        memcpy(out.proximity, frame.proximity, sizeof(out.proximity));
+        out.sensorRate = _sensorRate;
+        out.pollRate = _pollRate;
+        out.integrationTime = _intTimeNum;
+        out.ledCurrent = _ledCurNum;
+        out.dutyCycle = _dutyCycNum;
+        out.multiPulse = _multiPulseNum;
+        writeFramed((const uint8_t *)&out, sizeof(out));
     }
 }
 
-void SerialStudioOutput::resetAccumulator(uint32_t newTimestamp)
+void SerialStudioOutput::writeFramed(const uint8_t *data, size_t length)
 {
-    _currentTimestamp = newTimestamp;
-    memset(_accumulator, 0, sizeof(_accumulator));
-    memset(_slotFilled, 0, sizeof(_slotFilled));
-    _hasPendingFrame = true;
+    static const size_t MAX_FRAME = sizeof(SerialStudioTelemetryFrame) + 2;
+    // COBS adds one byte per 254 plus the leading code byte; then the 0x00
+    uint8_t encoded[MAX_FRAME + MAX_FRAME / 254 + 2];
+
+    uint16_t crc = crc16(data, length);
+    uint8_t trailer[2] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+    size_t codeIndex = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length + 2; i++)
+    {
+        uint8_t byte = i < length ? data[i] : trailer[i - length];
+        if (byte == 0)
+        {
+            encoded[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+            continue;
+        }
+        encoded[out++] = byte;
+        if (++code == 0xFF)
+        {
+            encoded[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        }
+    }
+    encoded[codeIndex] = code;
+    encoded[out++] = 0x00;
+
+    Serial.write(encoded, out);
 }
 
 void SerialStudioOutput::resetIndex()
 {
     _lastProcessedIndex = 0;
-    _hasPendingFrame = false;
-    memset(_accumulator, 0, sizeof(_accumulator));
-    memset(_slotFilled, 0, sizeof(_slotFilled));
-    _currentTimestamp = 0;
 }
 
 uint16_t SerialStudioOutput::calculateSensorRate()
 {
     if (!_config)
         return 0;
-
-    // VCNL4040 integration time → pulse width in μs (T = 125 μs base unit)
-    // Source: Vishay design guide oscilloscope measurement (designingvcnl4040.txt line 461)
-    float it_us = 125.0f;
-    String it = _config->integration_time;
-    if (it == "1.5T") it_us = 187.5f;
-    else if (it == "2T") it_us = 250.0f;
-    else if (it == "2.5T") it_us = 312.5f;
-    else if (it == "3T") it_us = 375.0f;
-    else if (it == "3.5T") it_us = 437.5f;
-    else if (it == "4T") it_us = 500.0f;
-    else if (it == "8T") it_us = 1000.0f;
-
-    // Duty cycle denominator (default 1/40)
-    uint16_t duty_denom = 40;
-    String dc = _config->duty_cycle;
-    int slash = dc.indexOf('/');
-    if (slash >= 0)
-        duty_denom = dc.substring(slash + 1).toInt();
-    if (duty_denom == 0)
-        duty_denom = 40;
-
-    float period_us = it_us * (float)duty_denom;
-    return (uint16_t)(1000000.0f / period_us);
+    return (uint16_t)(1000000UL / _config->conversionPeriodUs());
 }
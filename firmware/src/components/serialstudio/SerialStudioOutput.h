@@ -6,25 +6,90 @@
 #include "../sensor/SensorConfiguration.h"
 #include "../detection/DirectionDetector.h"
 #include "../memory/PSRAMAllocator.h"
+#include "../data/CaptureRing.h"
+#include "../diagnostics/LatencyTracker.h"
+
+// Frame output format. CSV is the text format the dashboards in
+// tools/serial-studio/ parse; BINARY is for high-rate bench captures.
+#ifndef SERIAL_STUDIO_BINARY_DEFAULT
+#define SERIAL_STUDIO_BINARY_DEFAULT false
+#endif
+
+// Emit every Nth frame (1 = all). Rates still count every frame.
+#ifndef SERIAL_STUDIO_DECIMATION_DEFAULT
+#define SERIAL_STUDIO_DECIMATION_DEFAULT 1
+#endif
+
+enum class SerialStudioFormat
+{
+    CSV,   // "/*a,b,c*/\n" text
+    BINARY // COBS-framed packed frames with CRC16, 0x00-terminated
+};
+
+/**
+ * Binary frames carry the same fields, in the same order, as the CSV
+ * columns, so one dashboard layout serves both (motion-play-v11-binary.json
+ * decodes them). On the wire: COBS(frame bytes + CRC16-CCITT, LE) 0x00.
+ * All fields little-endian; type 1 = raw, 2 = telemetry.
+ */
+struct __attribute__((packed)) SerialStudioRawFrame
+{
+    uint8_t type;
+    uint32_t timestampUs;
+    uint16_t proximity[NUM_SENSORS];
+    uint16_t sensorRate;
+    uint16_t pollRate;
+    uint16_t integrationTime;
+    uint16_t ledCurrent;
+    uint16_t dutyCycle;
+    uint16_t multiPulse;
+};
+
+struct __attribute__((packed)) SerialStudioTelemetryFrame
+{
+    uint8_t type;
+    uint32_t timestampUs;
+    uint16_t proximity[NUM_SENSORS];
+    float threshold[NUM_SENSORS];
+    uint8_t detectedModule;
+    uint8_t direction;
+    float confidence;
+    float speedMs;
+    uint16_t sensorRate;
+    uint16_t pollRate;
+    uint16_t integrationTime;
+    uint16_t ledCurrent;
+    uint16_t dutyCycle;
+    uint16_t multiPulse;
+    uint16_t peakA;
+    uint16_t peakB;
+    uint32_t waveDurationA;
+    uint32_t waveDurationB;
+    uint32_t comGapMs;
+    float latencyLastMs; // End-to-end (LatencyTracker TOTAL) of the newest detection
+    float latencyP50Ms;  // ...and that detector's percentiles
+    float latencyP95Ms;
+    float latencyP99Ms;
+};
 
 class SerialStudioOutput
 {
 private:
     // Reference to the session data buffer (owned by SessionManager)
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> *_buffer = nullptr;
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> *_buffer = nullptr;
     DirectionDetector *_detector = nullptr;
     SensorConfiguration *_config = nullptr;
     bool _enabled = false;
     bool _emitTelemetry = false;
+    SerialStudioFormat _format = SERIAL_STUDIO_BINARY_DEFAULT ? SerialStudioFormat::BINARY : SerialStudioFormat::CSV;
+    uint8_t _decimation = SERIAL_STUDIO_DECIMATION_DEFAULT;
+    uint8_t _decimationCount = 0;
 
-    // Buffer read tracking
-    size_t _lastProcessedIndex = 0;
+    // Live Debug capture ring; replaces _buffer while set
+    const CaptureRing *_ring = nullptr;
 
-    // Frame accumulator: one slot per sensor position (0-5)
-    uint16_t _accumulator[NUM_SENSORS] = {0};
-    bool _slotFilled[NUM_SENSORS] = {false};
-    uint32_t _currentTimestamp = 0;
-    bool _hasPendingFrame = false;
+    // Buffer read tracking (ring: pushedCount() already emitted)
+    size_t _lastProcessedIndex = 0;
 
     // Detection result cache (persists until next detection or full reset)
     Direction _cachedDirection = Direction::UNKNOWN;
@@ -37,27 +102,71 @@ private:
     uint32_t _cachedComGap = 0;
     uint8_t _cachedDetModule = 0; // 1-3 for module, 0 for none
 
+    // End-to-end detection latency (ms), refreshed with the rates
+    float _latencyLastMs = 0.0f;
+    float _latencyP50Ms = 0.0f;
+    float _latencyP95Ms = 0.0f;
+    float _latencyP99Ms = 0.0f;
+
+    // Last valid value per position: held positions repeat it
+    uint16_t _lastProximity[NUM_SENSORS] = {0};
+
     // Rate tracking
     uint32_t _pollCount = 0;         // Frames emitted in current 1-second window
     unsigned long _rateWindowStart = 0;
     uint16_t _pollRate = 0;          // Measured I2C polling rate (cycles/sec)
     uint16_t _sensorRate = 0;        // Calculated sensor measurement rate (Hz) from IT × duty
 
+    // Config fields as numbers (parsed from the config strings once a second,
+    // not per frame)
+    uint16_t _intTimeNum = 0;
+    uint16_t _ledCurNum = 0;
+    uint16_t _dutyCycNum = 0;
+    uint16_t _multiPulseNum = 0;
+
     uint16_t calculateSensorRate();
-    void emitFrame();
-    void resetAccumulator(uint32_t newTimestamp);
+    void updateConfigFields();
+    void updateRates();
+    void updateLatency();
+    void emitFrame(const SensorFrame &frame);
+    void emitCSV(const SensorFrame &frame);
+    void emitBinary(const SensorFrame &frame);
+    void writeFramed(const uint8_t *data, size_t length);
 
 public:
     /**
      * Initialize with references to session data buffer and direction detector.
      */
-    void begin(std::vector<SensorReading, PSRAMAllocator<SensorReading>> *buffer,
+    void begin(std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> *buffer,
                DirectionDetector *detector);
 
     void setEnabled(bool enabled) { _enabled = enabled; }
     bool isEnabled() const { return _enabled; }
 
-    void setConfig(SensorConfiguration *config) { _config = config; }
+    void setConfig(SensorConfiguration *config)
+    {
+        _config = config;
+        updateConfigFields();
+    }
+
+    void setFormat(SerialStudioFormat format) { _format = format; }
+    SerialStudioFormat getFormat() const { return _format; }
+
+    /**
+     * Emit only every Nth frame (0 is treated as 1).
+     */
+    void setDecimation(uint8_t everyN) { _decimation = everyN > 0 ? everyN : 1; }
+    uint8_t getDecimation() const { return _decimation; }
+
+    /**
+     * Follow a capture ring instead of the session buffer (Live Debug).
+     * Call again whenever the live ring is swapped; nullptr goes back to the buffer.
+     */
+    void setCaptureSource(const CaptureRing *ring)
+    {
+        _ring = ring;
+        resetIndex();
+    }
 
     /**
      * When true, frames include algorithm telemetry fields (smoothed signals,
@@ -72,13 +181,14 @@ public:
     void cacheDetection(const DetectionResult &result);
 
     /**
-     * Process new readings from the buffer and emit CSV frames.
+     * Process new frames from the buffer and emit one frame each (CSV or
+     * binary, after decimation).
      * Call once per Core 1 loop iteration, after sessionManager.processQueue().
      */
     void update();
 
     /**
-     * Reset read index and accumulator state.
+     * Reset read index.
      * Call when the buffer is cleared externally (detection events, overflow).
      */
     void resetIndex();
@@ -1,16 +1,13 @@
 #include "SessionManager.h"
+#include "../data/CaptureRing.h"
+#include "SessionSpill.h"
+#include "../diagnostics/HeapTracker.h"
 
 extern bool serialStudioEnabled;
 
 SessionManager::SessionManager()
 {
-    // Create queue for sensor data (6 sensors * 1000Hz = 6000 items/sec)
-    dataQueue = xQueueCreate(1000, sizeof(SensorReading));
-
-    if (dataQueue == NULL)
-    {
-        Serial.println("ERROR: Failed to create data queue");
-    }
+    // Frame ring is inline storage (SENSOR_FRAME_RING_SLOTS cycles) - nothing to allocate
 }
 
 void SessionManager::setDeviceId(const String &fullDeviceId)
@@ -36,6 +33,25 @@ void SessionManager::generateSessionId()
     sessionId = prefix + "_" + String(millis());
 }
 
+bool SessionManager::reserveBuffers()
+{
+    try
+    {
+        dataBuffer.reserve(MAX_BUFFER_SIZE);
+        interruptBuffer.reserve(MAX_INTERRUPT_BUFFER);
+    }
+    catch (const std::bad_alloc &)
+    {
+        Serial.println("ERROR: Session buffer reservation failed");
+        return false;
+    }
+
+    Serial.printf("Session buffers reserved: %u KB frames + %u KB events (PSRAM)\n",
+                  (unsigned)(dataBuffer.capacity() * sizeof(SensorFrame) / 1024),
+                  (unsigned)(interruptBuffer.capacity() * sizeof(InterruptEvent) / 1024));
+    return true;
+}
+
 bool SessionManager::startSession()
 {
     if (state != IDLE)
@@ -50,8 +66,12 @@ bool SessionManager::startSession()
 
     // Reset session confirmation counters
     sessionSummary.reset();
+    frameRing.resetOverflowCount();
+    HeapTracker::resetSessionMarks();
+    LatencyTracker::reset();
 
-    // Clear any old data based on session type
+    // Clear any old data based on session type. reserve() is a no-op once
+    // reserveBuffers() has run; it only allocates if that failed at boot.
     if (sessionType == SessionType::INTERRUPT_BASED)
     {
         interruptBuffer.clear();
@@ -67,6 +87,14 @@ bool SessionManager::startSession()
     generateSessionId();
     sessionStartTime = millis();
 
+    spilling = false;
+    if (sessionType == SessionType::PROXIMITY && spill != nullptr)
+    {
+        spilling = spill->start(sessionId, sessionStartTime);
+        if (!spilling)
+            Serial.println("WARNING: Flash spill unavailable - session limited to memory");
+    }
+
     state = COLLECTING;
 
     Serial.print("Session started: ");
@@ -94,6 +122,12 @@ bool SessionManager::stopSession()
         processQueue();
     }
 
+    if (spilling)
+    {
+        spill->finish();
+        sessionSummary.buffer_drops += spill->getLostReadings();
+    }
+
     Serial.print("Session stopped. Duration: ");
     Serial.print(sessionDuration);
     Serial.print("ms, ");
@@ -105,8 +139,9 @@ bool SessionManager::stopSession()
     }
     else
     {
-        Serial.print("Samples: ");
-        Serial.println(dataBuffer.size());
+        Serial.printf("Frames: %u (%u samples)%s\n",
+                      (unsigned)getDataCount(), (unsigned)getReadingCount(),
+                      spilling ? " in flash" : "");
     }
 
     return true;
@@ -121,25 +156,67 @@ void SessionManager::processQueue()
     if (sessionType != SessionType::PROXIMITY)
         return;
 
-    SensorReading reading;
+    // Drain whole cycles in bulk - one acquire/release per batch, no kernel calls
+    const size_t DRAIN_BATCH = 32;
+    SensorFrame frames[DRAIN_BATCH];
     int processed = 0;
+    size_t n;
 
-    // Process all available readings
-    while (xQueueReceive(dataQueue, &reading, 0) == pdTRUE)
+    // Capture ring: constant cost per frame, never full
+    if (captureRing != nullptr)
     {
-        if (dataBuffer.size() < MAX_BUFFER_SIZE)
+        while ((n = frameRing.popBulk(frames, DRAIN_BATCH)) > 0)
         {
-            dataBuffer.push_back(reading);
-            processed++;
+            for (size_t f = 0; f < n; f++)
+            {
+                if (!frames[f].isEmpty())
+                    captureRing->push(frames[f]);
+            }
         }
-        else
+        return;
+    }
+
+    // Flash spill: no size limit here, the writer's budget ends the session
+    if (spilling)
+    {
+        while ((n = frameRing.popBulk(frames, DRAIN_BATCH)) > 0)
+        {
+            for (size_t f = 0; f < n; f++)
+            {
+                if (!frames[f].isEmpty() && !spill->push(frames[f]))
+                    sessionSummary.buffer_drops += frames[f].validCount();
+            }
+        }
+        return;
+    }
+
+    while ((n = frameRing.popBulk(frames, DRAIN_BATCH)) > 0)
+    {
+        for (size_t f = 0; f < n; f++)
+        {
+            const SensorFrame &frame = frames[f];
+            if (frame.isEmpty())
+                continue;
+
+            if (dataBuffer.size() < MAX_BUFFER_SIZE)
+            {
+                dataBuffer.push_back(frame);
+                processed++;
+            }
+            else
+            {
+                sessionSummary.buffer_drops += frame.validCount();
+            }
+        }
+
+        if (dataBuffer.size() >= MAX_BUFFER_SIZE)
         {
-            // Count remaining items in queue that will be dropped
-            uint32_t dropped = 1; // This one
-            SensorReading discardReading;
-            while (xQueueReceive(dataQueue, &discardReading, 0) == pdTRUE)
+            // Count remaining cycles in the ring that will be dropped
+            uint32_t dropped = 0;
+            while ((n = frameRing.popBulk(frames, DRAIN_BATCH)) > 0)
             {
-                dropped++;
+                for (size_t f = 0; f < n; f++)
+                    dropped += frames[f].validCount();
             }
             sessionSummary.buffer_drops += dropped;
             Serial.printf("WARNING: Buffer full, dropped %lu samples\n", (unsigned long)dropped);
@@ -149,12 +226,12 @@ void SessionManager::processQueue()
 
     if (processed > 0)
     {
-        // Periodic status update (every 1000 samples)
+        // Periodic status update (every 1000 frames)
         if (dataBuffer.size() % 1000 == 0)
         {
             Serial.print("Buffered: ");
             Serial.print(dataBuffer.size());
-            Serial.println(" samples");
+            Serial.println(" frames");
         }
     }
 }
@@ -165,6 +242,8 @@ bool SessionManager::hasData()
     {
         return !interruptBuffer.empty();
     }
+    if (spilling)
+        return spill->frameCount() > 0;
     return !dataBuffer.empty();
 }
 
@@ -174,9 +253,30 @@ size_t SessionManager::getDataCount()
     {
         return interruptBuffer.size();
     }
+    if (captureRing != nullptr)
+        return captureRing->size();
+    if (spilling)
+        return spill->frameCount();
     return dataBuffer.size();
 }
 
+size_t SessionManager::getReadingCount()
+{
+    if (sessionType == SessionType::INTERRUPT_BASED)
+    {
+        return interruptBuffer.size();
+    }
+    if (spilling)
+        return spill->readingCount();
+
+    size_t count = 0;
+    for (const SensorFrame &frame : dataBuffer)
+    {
+        count += frame.validCount();
+    }
+    return count;
+}
+
 SessionState SessionManager::getState()
 {
     return state;
@@ -201,13 +301,46 @@ unsigned long SessionManager::getStartTime()
     return sessionStartTime;
 }
 
-std::vector<SensorReading, PSRAMAllocator<SensorReading>> &SessionManager::getDataBuffer()
+std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &SessionManager::getDataBuffer()
 {
     return dataBuffer;
 }
 
+bool SessionManager::isSpillFull() const
+{
+    return spilling && spill->isFull();
+}
+
+unsigned long SessionManager::getMaxDuration() const
+{
+    return spilling ? SESSION_SPILL_MAX_MS : MAX_SESSION_DURATION_MS;
+}
+
+void SessionManager::rewindUpload()
+{
+    uploadSegment = 0;
+    if (spilling)
+        spill->openRead();
+}
+
+bool SessionManager::nextUploadSegment()
+{
+    if (!spilling)
+        return uploadSegment++ == 0 && !dataBuffer.empty();
+
+    // Reuses the reserved buffer: capacity is MAX_BUFFER_SIZE
+    return spill->read(dataBuffer, MAX_BUFFER_SIZE) > 0;
+}
+
 void SessionManager::clearBuffer()
 {
+    if (spilling)
+    {
+        // Kept on flash for fetch_range until the next session replaces it
+        spill->finish();
+        spill->close();
+        spilling = false;
+    }
     dataBuffer.clear();
     interruptBuffer.clear();
     state = IDLE;
@@ -226,11 +359,6 @@ const std::vector<SensorMetadata> &SessionManager::getSensorMetadata()
     return activeSensors;
 }
 
-QueueHandle_t SessionManager::getQueue()
-{
-    return dataQueue;
-}
-
 bool SessionManager::addInterruptEvent(const InterruptEvent &event)
 {
     if (state != COLLECTING || sessionType != SessionType::INTERRUPT_BASED)
@@ -257,6 +385,8 @@ void SessionManager::finalizeSessionSummary(const SensorConfiguration *config, u
         sessionSummary.duration_ms = sessionDuration;
     }
     sessionSummary.num_active_sensors = numActiveSensors;
+    sessionSummary.heap = HeapTracker::getSessionMarks();
+    sessionSummary.latency = LatencyTracker::getAll();
 
     // Compute measured cycle rate from the ACTUAL collection time (time since startSession),
     // not the capture window duration. In Live Debug mode, sensors run continuously during the
@@ -283,10 +413,14 @@ void SessionManager::finalizeSessionSummary(const SensorConfiguration *config, u
     // Log summary
     uint32_t totalCollected = 0;
     uint32_t totalErrors = 0;
+    uint32_t totalRepeated = 0;
+    uint32_t totalSuppressed = 0;
     for (int i = 0; i < NUM_SENSORS; i++)
     {
         totalCollected += sessionSummary.readings_collected[i];
         totalErrors += sessionSummary.i2c_errors[i];
+        totalRepeated += sessionSummary.repeated_readings[i];
+        totalSuppressed += sessionSummary.suppressed_repeats[i];
     }
 
     Serial.println("\n=== Session Summary ===");
@@ -295,9 +429,77 @@ void SessionManager::finalizeSessionSummary(const SensorConfiguration *config, u
                   (unsigned long)sessionSummary.total_cycles, sessionSummary.measured_cycle_rate_hz);
     Serial.printf("  Readings collected: %lu\n", (unsigned long)totalCollected);
     Serial.printf("  I2C errors: %lu\n", (unsigned long)totalErrors);
-    Serial.printf("  Queue drops: %lu\n", (unsigned long)sessionSummary.queue_drops);
+    Serial.printf("  Repeated readings: %lu (%lu suppressed)\n", (unsigned long)totalRepeated,
+                  (unsigned long)totalSuppressed);
+    Serial.printf("  Queue drops: %lu (%lu ring overflows)\n", (unsigned long)sessionSummary.queue_drops,
+                  (unsigned long)frameRing.overflowCount());
     Serial.printf("  Buffer drops: %lu\n", (unsigned long)sessionSummary.buffer_drops);
     Serial.printf("  Theoretical max: %lu\n", (unsigned long)sessionSummary.theoretical_max_readings);
     Serial.printf("  Active sensors: %u\n", sessionSummary.num_active_sensors);
+    if (sessionSummary.cycle_period_samples > 0)
+    {
+        Serial.printf("  Cycle period: target %lu us, min %lu / avg %lu / max %lu us\n",
+                      (unsigned long)sessionSummary.cycle_period_target_us,
+                      (unsigned long)sessionSummary.cycle_period_us_min,
+                      (unsigned long)sessionSummary.avgCyclePeriodUs(),
+                      (unsigned long)sessionSummary.cycle_period_us_max);
+        Serial.printf("  Missed ticks: %lu, overruns: %lu\n",
+                      (unsigned long)sessionSummary.missed_ticks,
+                      (unsigned long)sessionSummary.cycle_overruns);
+    }
+    if (sessionSummary.cycle_i2c_samples > 0)
+    {
+        Serial.printf("  Queued cycle I2C: avg %lu us, max %lu us\n",
+                      (unsigned long)sessionSummary.avgCycleI2CUs(),
+                      (unsigned long)sessionSummary.cycle_i2c_us_max);
+    }
+    for (int i = 0; i < NUM_SENSORS; i++)
+    {
+        if (sessionSummary.read_latency_samples[i] == 0)
+            continue;
+        Serial.printf("  Sensor %d read: avg %lu us, max %lu us\n", i,
+                      (unsigned long)sessionSummary.avgReadLatencyUs(i),
+                      (unsigned long)sessionSummary.read_latency_us_max[i]);
+    }
+    if (sessionSummary.bus_recoveries > 0 || sessionSummary.bus_recovery_failures > 0 ||
+        sessionSummary.sensor_quarantines > 0)
+    {
+        Serial.printf("  Bus health: %lu recoveries (%lu failed), %lu quarantines, %lu reads skipped\n",
+                      (unsigned long)sessionSummary.bus_recoveries,
+                      (unsigned long)sessionSummary.bus_recovery_failures,
+                      (unsigned long)sessionSummary.sensor_quarantines,
+                      (unsigned long)sessionSummary.health_skipped_reads);
+    }
+    if (sessionSummary.rate_timeline_count > 0)
+    {
+        Serial.printf("  Adaptive rate: %lu switches, %lu ms at idle rate\n",
+                      (unsigned long)sessionSummary.rate_switches,
+                      (unsigned long)sessionSummary.idle_rate_ms_total);
+    }
+    if (sessionSummary.light_sleeps > 0)
+    {
+        Serial.printf("  Light sleep: %lu sleeps, %lu ms asleep, %lu INT wakes (wake -> sample avg %lu us, max %lu us)\n",
+                      (unsigned long)sessionSummary.light_sleeps,
+                      (unsigned long)sessionSummary.light_sleep_ms_total,
+                      (unsigned long)sessionSummary.sleep_wakes,
+                      (unsigned long)sessionSummary.avgWakeToSampleUs(),
+                      (unsigned long)sessionSummary.wake_to_sample_us_max);
+    }
+    Serial.printf("  Heap min: %lu free, %lu largest block (PSRAM %lu / %lu)\n",
+                  (unsigned long)sessionSummary.heap.heap_min_free,
+                  (unsigned long)sessionSummary.heap.heap_min_largest_block,
+                  (unsigned long)sessionSummary.heap.psram_min_free,
+                  (unsigned long)sessionSummary.heap.psram_min_largest_block);
+    for (uint8_t d = 0; d < LATENCY_DETECTOR_COUNT; d++)
+    {
+        const LatencyPercentiles &total = sessionSummary.latency.stage[d][(uint8_t)LatencyStage::TOTAL];
+        const LatencyPercentiles &led = sessionSummary.latency.stage[d][(uint8_t)LatencyStage::LED];
+        if (total.count == 0 && led.count == 0)
+            continue;
+        Serial.printf("  Latency (%s): total p50 %lu / p95 %lu / p99 %lu us (%lu), decision->LED p95 %lu us\n",
+                      d == 1 ? "ML" : "heuristic",
+                      (unsigned long)total.p50, (unsigned long)total.p95, (unsigned long)total.p99,
+                      (unsigned long)total.count, (unsigned long)led.p95);
+    }
     Serial.println("=======================\n");
 }
\ No newline at end of file
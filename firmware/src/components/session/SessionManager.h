@@ -7,6 +7,13 @@
 #include "../sensor/SensorManager.h"
 #include "../interrupt/InterruptManager.h"
 #include "../memory/PSRAMAllocator.h"
+#include "../diagnostics/LatencyTracker.h"
+
+class CaptureRing;
+class SessionSpill;
+
+// Interrupt session events live in PSRAM too (10,000 x 12 bytes)
+typedef std::vector<InterruptEvent, PSRAMAllocator<InterruptEvent>> InterruptEventBuffer;
 
 enum SessionState
 {
@@ -19,11 +26,24 @@ enum SessionState
 // Populated by SensorManager (collection), SessionManager (buffering),
 // and DataTransmitter (transmission). Sent as a separate MQTT message
 // after all data batches to verify end-to-end data delivery.
+// Sample-rate changes kept per session (adaptive_rate); later changes are only counted
+#ifndef SESSION_RATE_TIMELINE_MAX
+#define SESSION_RATE_TIMELINE_MAX 32
+#endif
+
+struct RateTimelineEntry
+{
+    uint32_t offset_ms; // Since collection start
+    uint16_t rate_hz;   // Effective sample rate from here on
+};
+
 struct SessionSummary
 {
     uint32_t total_cycles = 0;                      // Sensor loop iterations
     uint32_t readings_collected[NUM_SENSORS] = {0}; // Successful reads per sensor position
     uint32_t i2c_errors[NUM_SENSORS] = {0};         // Failed reads per sensor position
+    uint32_t repeated_readings[NUM_SENSORS] = {0};  // Reads equal to the sensor's previous value (stale/duplicate)
+    uint32_t suppressed_repeats[NUM_SENSORS] = {0}; // ...of those, left out of frames (duplicate_mode "suppress")
     uint32_t queue_drops = 0;                       // Readings lost due to full queue
     uint32_t buffer_drops = 0;                      // Readings lost due to full buffer
     uint32_t total_readings_transmitted = 0;        // Sum of readings across all MQTT batches
@@ -33,11 +53,62 @@ struct SessionSummary
     uint32_t theoretical_max_readings = 0;          // sample_rate_hz * (duration_ms/1000) * active_sensors
     uint8_t num_active_sensors = 0;                 // How many sensors were active
 
+    // I2C read latency (Core 0). Per-sensor figures come from the per-read
+    // path; queued whole-cycle transactions are tracked as a single figure.
+    uint64_t read_latency_us_total[NUM_SENSORS] = {0}; // Sum of per-read bus time
+    uint32_t read_latency_us_max[NUM_SENSORS] = {0};   // Worst single read
+    uint32_t read_latency_samples[NUM_SENSORS] = {0};  // Reads timed per sensor
+    uint64_t cycle_i2c_us_total = 0;                   // Sum of queued-cycle bus time
+    uint32_t cycle_i2c_us_max = 0;                     // Worst queued cycle
+    uint32_t cycle_i2c_samples = 0;                    // Queued cycles timed
+
+    // Sample timer (Core 0): period between consecutive cycle starts
+    uint32_t cycle_period_target_us = 0;   // Timer period from sample_rate_hz
+    uint32_t cycle_period_us_min = 0;      // Shortest observed period
+    uint32_t cycle_period_us_max = 0;      // Longest observed period
+    uint64_t cycle_period_us_total = 0;    // Sum of observed periods
+    uint32_t cycle_period_samples = 0;     // Periods measured
+    uint32_t missed_ticks = 0;             // Timer ticks that fired while a cycle was still running
+    uint32_t cycle_overruns = 0;           // Cycles that took longer than the target period
+
+    // I2C bus health (Core 0, I2CBusHealth)
+    uint32_t bus_recoveries = 0;           // Stuck buses cleared and verified
+    uint32_t bus_recovery_failures = 0;    // Recoveries after which the bus still failed
+    uint32_t sensor_quarantines = 0;       // Sensors taken out of the cycle
+    uint32_t health_skipped_reads = 0;     // Reads not attempted (quarantined / bus down)
+
+    // Hybrid mode (Core 0): interrupt-triggered polling bursts
+    uint32_t hybrid_bursts = 0;            // Bursts started by an INT line
+    uint32_t hybrid_burst_ms_total = 0;    // Time spent polling (rest of the session was INT idle)
+
+    // Light sleep while waiting for an INT line (light_sleep_idle)
+    uint32_t light_sleeps = 0;             // esp_light_sleep_start() calls (loop())
+    uint32_t light_sleep_ms_total = 0;     // Time asleep
+    uint32_t sleep_wakes = 0;              // Sleeps ended by an INT line (Core 0 below)
+    uint32_t wake_to_sample_us_max = 0;    // Wake -> first frame of the burst it started
+    uint64_t wake_to_sample_us_total = 0;
+
+    // Adaptive rate (Core 0): detector-driven idle sample rate
+    RateTimelineEntry rate_timeline[SESSION_RATE_TIMELINE_MAX] = {}; // Entry 0 = starting rate
+    uint8_t rate_timeline_count = 0;       // 0 = adaptive rate was off
+    uint32_t rate_switches = 0;            // Period changes, including any past the timeline cap
+    uint32_t idle_rate_ms_total = 0;       // Time spent at the idle rate
+
+    // Heap (HeapTracker): free / largest-block minimums and per-tag peaks
+    // while the session ran
+    HeapSessionMarks heap = {};
+
+    // Detection latency (LatencyTracker): per detector and stage, over the
+    // newest LATENCY_WINDOW detections of the session
+    LatencySessionStats latency = {};
+
     void reset()
     {
         total_cycles = 0;
         memset(readings_collected, 0, sizeof(readings_collected));
         memset(i2c_errors, 0, sizeof(i2c_errors));
+        memset(repeated_readings, 0, sizeof(repeated_readings));
+        memset(suppressed_repeats, 0, sizeof(suppressed_repeats));
         queue_drops = 0;
         buffer_drops = 0;
         total_readings_transmitted = 0;
@@ -46,6 +117,56 @@ struct SessionSummary
         duration_ms = 0;
         theoretical_max_readings = 0;
         num_active_sensors = 0;
+        memset(read_latency_us_total, 0, sizeof(read_latency_us_total));
+        memset(read_latency_us_max, 0, sizeof(read_latency_us_max));
+        memset(read_latency_samples, 0, sizeof(read_latency_samples));
+        cycle_i2c_us_total = 0;
+        cycle_i2c_us_max = 0;
+        cycle_i2c_samples = 0;
+        cycle_period_target_us = 0;
+        cycle_period_us_min = 0;
+        cycle_period_us_max = 0;
+        cycle_period_us_total = 0;
+        cycle_period_samples = 0;
+        missed_ticks = 0;
+        cycle_overruns = 0;
+        bus_recoveries = 0;
+        bus_recovery_failures = 0;
+        sensor_quarantines = 0;
+        health_skipped_reads = 0;
+        hybrid_bursts = 0;
+        hybrid_burst_ms_total = 0;
+        light_sleeps = 0;
+        light_sleep_ms_total = 0;
+        sleep_wakes = 0;
+        wake_to_sample_us_max = 0;
+        wake_to_sample_us_total = 0;
+        memset(rate_timeline, 0, sizeof(rate_timeline));
+        rate_timeline_count = 0;
+        rate_switches = 0;
+        idle_rate_ms_total = 0;
+        heap = {};
+        latency = {};
+    }
+
+    uint32_t avgReadLatencyUs(uint8_t position) const
+    {
+        return read_latency_samples[position] ? (uint32_t)(read_latency_us_total[position] / read_latency_samples[position]) : 0;
+    }
+
+    uint32_t avgCycleI2CUs() const
+    {
+        return cycle_i2c_samples ? (uint32_t)(cycle_i2c_us_total / cycle_i2c_samples) : 0;
+    }
+
+    uint32_t avgWakeToSampleUs() const
+    {
+        return sleep_wakes ? (uint32_t)(wake_to_sample_us_total / sleep_wakes) : 0;
+    }
+
+    uint32_t avgCyclePeriodUs() const
+    {
+        return cycle_period_samples ? (uint32_t)(cycle_period_us_total / cycle_period_samples) : 0;
     }
 };
 
@@ -53,7 +174,7 @@ struct SessionSummary
 // Note: Using SESSION_* prefix to avoid conflict with ESP32 SDK macros
 enum class SessionType
 {
-    PROXIMITY,      // Traditional polling mode - SensorReading data
+    PROXIMITY,      // Traditional polling mode - SensorFrame data
     INTERRUPT_BASED // Interrupt-based mode - InterruptEvent data
 };
 
@@ -62,7 +183,9 @@ class SessionManager
 private:
     SessionState state = IDLE;
     SessionType sessionType = SessionType::PROXIMITY;
-    QueueHandle_t dataQueue = NULL;
+
+    // Core 0 → Core 1 hand-off: one slot per sensor cycle, drained in bulk
+    SensorFrameRing frameRing;
 
     String sessionId;
     String deviceIdPrefix; // Short prefix for session IDs (e.g. "device-002")
@@ -70,16 +193,28 @@ private:
     unsigned long sessionDuration = 0;
 
     // CRITICAL: Use PSRAM allocator to prevent heap exhaustion
-    // 30,000 samples × 12 bytes = 360KB would exhaust the 400KB heap
+    // One element per polling cycle (all 6 positions, 32 bytes) instead of
+    // one 12-byte SensorReading per sensor: 72 -> 32 bytes per cycle.
+    // 30,000 cycles × 32 bytes = 960KB (1.3MB with SENSOR_SKEW_OFFSETS) -
     // PSRAM has 8MB available
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> dataBuffer;
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> dataBuffer;
     std::vector<SensorMetadata> activeSensors;
 
+    // Play / Live Debug: frames go to this fixed-size ring instead of dataBuffer
+    CaptureRing *captureRing = nullptr;
+
+    // Debug sessions: frames stream to flash instead of dataBuffer when set.
+    // At upload dataBuffer is refilled from the file one segment at a time.
+    SessionSpill *spill = nullptr;
+    bool spilling = false; // This session is being spilled
+    size_t uploadSegment = 0;
+
     // Interrupt session buffer (much smaller - typically <1000 events)
-    std::vector<InterruptEvent> interruptBuffer;
+    InterruptEventBuffer interruptBuffer;
 
-    static const size_t MAX_BUFFER_SIZE = 30000;      // 30 seconds * 1000 Hz (proximity)
+    static const size_t MAX_BUFFER_SIZE = 30000;      // Frames: 30 seconds * 1000 Hz cycles (proximity)
     static const size_t MAX_INTERRUPT_BUFFER = 10000; // Max interrupt events
+    static const unsigned long MAX_SESSION_DURATION_MS = 30000; // In-memory sessions
 
     // Session Confirmation: pipeline integrity counters
     SessionSummary sessionSummary;
@@ -92,6 +227,14 @@ public:
     // Device ID for session ID generation
     void setDeviceId(const String &fullDeviceId);
 
+    /**
+     * Reserve both session buffers at their maximum size (call once at boot,
+     * before the heap fragments). They are only cleared afterwards, never
+     * regrown or freed, so per-sample cost is flat for the whole session.
+     * @return false if PSRAM could not hold them (sessions then reserve lazily)
+     */
+    bool reserveBuffers();
+
     // Session control
     bool startSession();
     bool stopSession();
@@ -104,21 +247,45 @@ public:
 
     // State and metadata
     bool hasData();
-    size_t getDataCount();
+    size_t getDataCount();    // Frames (proximity) or events (interrupt)
+    size_t getReadingCount(); // Individual sensor readings across all frames
     SessionState getState();
     String getSessionId();
     unsigned long getDuration();
     unsigned long getStartTime();
-    QueueHandle_t getQueue();
+    SensorFrameRing *getFrameRing() { return &frameRing; }
 
     // Proximity mode data
-    std::vector<SensorReading, PSRAMAllocator<SensorReading>> &getDataBuffer();
+    std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> &getDataBuffer();
+
+    // Drain proximity frames into ring (overwriting its oldest) instead of
+    // the data buffer; nullptr restores the data buffer. Loop task only.
+    void setCaptureRing(CaptureRing *ring) { captureRing = ring; }
     void setSensorMetadata(const std::vector<SensorMetadata> &metadata);
     const std::vector<SensorMetadata> &getSensorMetadata();
 
+    // Spill proximity sessions started from now on to flash (nullptr = in
+    // memory). Falls back to memory if the spill file cannot be created.
+    void setSpill(SessionSpill *sessionSpill) { spill = sessionSpill; }
+    bool isSpilling() const { return spilling; }
+    bool isSpillFull() const;
+
+    // Auto-stop limit for the current session
+    unsigned long getMaxDuration() const;
+
+    /**
+     * Upload iteration over the proximity frames: rewindUpload(), then each
+     * nextUploadSegment() leaves the next run of frames in getDataBuffer().
+     * In memory that is the whole buffer once; a spilled session is decoded
+     * from flash MAX_BUFFER_SIZE frames at a time.
+     * @return false when there are no more frames
+     */
+    void rewindUpload();
+    bool nextUploadSegment();
+
     // Interrupt mode data
-    std::vector<InterruptEvent> &getInterruptBuffer() { return interruptBuffer; }
-    const std::vector<InterruptEvent> &getInterruptBuffer() const { return interruptBuffer; }
+    InterruptEventBuffer &getInterruptBuffer() { return interruptBuffer; }
+    const InterruptEventBuffer &getInterruptBuffer() const { return interruptBuffer; }
     size_t getInterruptEventCount() const { return interruptBuffer.size(); }
 
     // Add interrupt event to buffer
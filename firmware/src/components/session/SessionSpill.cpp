@@ -0,0 +1,454 @@
+#include "SessionSpill.h"
+
+bool SessionSpill::begin()
+{
+    if (writerTask != nullptr)
+        return true;
+
+    freeQueue = xQueueCreate(SESSION_SPILL_CHUNKS, sizeof(Chunk *));
+    writeQueue = xQueueCreate(SESSION_SPILL_CHUNKS, sizeof(Chunk *));
+    if (freeQueue == nullptr || writeQueue == nullptr)
+    {
+        Serial.println("ERROR: SessionSpill queue creation failed");
+        return false;
+    }
+
+    for (int i = 0; i < SESSION_SPILL_CHUNKS; i++)
+    {
+        try
+        {
+            chunks[i].frames.resize(SESSION_SPILL_CHUNK_FRAMES);
+        }
+        catch (const std::bad_alloc &)
+        {
+            Serial.println("ERROR: SessionSpill chunk allocation failed");
+            return false;
+        }
+        Chunk *chunk = &chunks[i];
+        xQueueSend(freeQueue, &chunk, 0);
+    }
+
+    try
+    {
+        columnBuffer.resize(COLUMN_CODEC_MAX_POSITION_BYTES(SESSION_SPILL_CHUNK_FRAMES));
+        index.reserve(SESSION_SPILL_INDEX_MAX);
+    }
+    catch (const std::bad_alloc &)
+    {
+        Serial.println("ERROR: SessionSpill index allocation failed");
+        return false;
+    }
+
+    // Core 1, below loop(): flash writes only need to keep up on average
+    BaseType_t created = xTaskCreatePinnedToCore(
+        writerTaskFunction,
+        "SpillWriter",
+        4096,
+        this,
+        0,
+        &writerTask,
+        1);
+
+    if (created != pdPASS)
+    {
+        Serial.println("ERROR: SessionSpill task creation failed");
+        writerTask = nullptr;
+        return false;
+    }
+
+    Serial.printf("SessionSpill ready: %d chunks x %d frames (%d KB PSRAM)\n",
+                  SESSION_SPILL_CHUNKS, SESSION_SPILL_CHUNK_FRAMES,
+                  (int)(SESSION_SPILL_CHUNKS * SESSION_SPILL_CHUNK_FRAMES * sizeof(SensorFrame) / 1024));
+    return true;
+}
+
+bool SessionSpill::start(const String &newSessionId, uint32_t newStartMs)
+{
+    if (writerTask == nullptr)
+        return false;
+
+    discard();
+    if (LittleFS.exists(SESSION_SPILL_LEGACY_PATH))
+        LittleFS.remove(SESSION_SPILL_LEGACY_PATH);
+
+    // Room for the index and trailer is kept back from the chunk budget
+    size_t freeBytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+    size_t indexBytes = SESSION_SPILL_INDEX_MAX * COLUMN_CODEC_ENTRY_BYTES + SESSION_SPILL_TRAILER_BYTES;
+    if (freeBytes <= SESSION_SPILL_RESERVE_BYTES + indexBytes)
+    {
+        Serial.printf("ERROR: Not enough flash for a spill file (%u KB free)\n", (unsigned)(freeBytes / 1024));
+        return false;
+    }
+
+    file = LittleFS.open(SESSION_SPILL_PATH, "w");
+    if (!file)
+    {
+        Serial.println("ERROR: Failed to create spill file");
+        return false;
+    }
+
+    budgetBytes = freeBytes - SESSION_SPILL_RESERVE_BYTES - indexBytes;
+    strlcpy(sessionId, newSessionId.c_str(), sizeof(sessionId));
+    startMs = newStartMs;
+    index.clear();
+    haveFirst = false;
+    containerReady = false;
+    full = false;
+    fileBytes = 0;
+    lostFrames = 0;
+    lostReadings = 0;
+    pushedFrames = 0;
+    pushedReadings = 0;
+
+    if (!writeHeader())
+    {
+        Serial.println("ERROR: Failed to write spill file header");
+        file.close();
+        return false;
+    }
+    active = true;
+
+    Serial.printf("Spilling session to %s (%u KB available)\n", SESSION_SPILL_PATH, (unsigned)(budgetBytes / 1024));
+    return true;
+}
+
+bool SessionSpill::writeHeader()
+{
+    uint8_t header[12 + SESSION_SPILL_ID_MAX];
+    uint8_t idLength = strlen(sessionId);
+    uint16_t chunkMs = SESSION_COLUMN_CHUNK_MS;
+
+    memcpy(header, "COL1", 4);
+    header[4] = 1; // Version
+    header[5] = NUM_SENSORS;
+    memcpy(header + 6, &chunkMs, 2);
+    memcpy(header + 8, &startMs, 4);
+    header[12] = idLength;
+    memcpy(header + 13, sessionId, idLength);
+
+    size_t length = 13 + idLength;
+    if (file.write(header, length) != length)
+        return false;
+    fileBytes = length;
+    return true;
+}
+
+bool SessionSpill::push(const SensorFrame &frame)
+{
+    if (current == nullptr && xQueueReceive(freeQueue, &current, 0) != pdTRUE)
+    {
+        current = nullptr;
+        return false;
+    }
+
+    current->frames[current->count++] = frame;
+    pushedFrames++;
+    pushedReadings += frame.validCount();
+
+    if (current->count == SESSION_SPILL_CHUNK_FRAMES)
+    {
+        // Never blocks: the write queue holds every chunk
+        xQueueSend(writeQueue, &current, 0);
+        current = nullptr;
+    }
+    return true;
+}
+
+void SessionSpill::finish()
+{
+    if (!active)
+        return;
+
+    if (current != nullptr)
+    {
+        if (current->count > 0)
+            xQueueSend(writeQueue, &current, 0);
+        else
+            xQueueSend(freeQueue, &current, 0);
+        current = nullptr;
+    }
+
+    // Every chunk back in the free queue = writer idle
+    while (uxQueueMessagesWaiting(freeQueue) < SESSION_SPILL_CHUNKS)
+        vTaskDelay(pdMS_TO_TICKS(5));
+
+    containerReady = writeIndex();
+    if (!containerReady)
+        Serial.println("ERROR: Failed to write spill file index");
+    file.close();
+    active = false;
+
+    Serial.printf("Spill file closed: %lu frames in %u chunks, %lu KB (%lu readings lost)\n",
+                  (unsigned long)frameCount(), (unsigned)index.size(), (unsigned long)(fileBytes / 1024),
+                  (unsigned long)lostReadings);
+}
+
+bool SessionSpill::writeIndex()
+{
+    uint8_t entry[COLUMN_CODEC_ENTRY_BYTES];
+    for (const ColumnChunkEntry &chunk : index)
+    {
+        ColumnCodec::packEntry(chunk, entry);
+        if (file.write(entry, sizeof(entry)) != sizeof(entry))
+            return false;
+    }
+
+    uint8_t trailer[SESSION_SPILL_TRAILER_BYTES];
+    uint32_t indexOffset = fileBytes; // The chunks end there
+    uint32_t chunkCount = index.size();
+    uint32_t frames = frameCount();
+    memcpy(trailer, &indexOffset, 4);
+    memcpy(trailer + 4, &chunkCount, 4);
+    memcpy(trailer + 8, &frames, 4);
+    memcpy(trailer + 12, "COL1", 4);
+    return file.write(trailer, sizeof(trailer)) == sizeof(trailer);
+}
+
+void SessionSpill::discard()
+{
+    finish();
+    close();
+    index.clear();
+    containerReady = false;
+    if (LittleFS.exists(SESSION_SPILL_PATH))
+        LittleFS.remove(SESSION_SPILL_PATH);
+}
+
+void SessionSpill::close()
+{
+    if (file)
+        file.close();
+}
+
+bool SessionSpill::openRead()
+{
+    if (active)
+        finish();
+    close();
+
+    if (!containerReady)
+    {
+        Serial.println("ERROR: Spill file has no index");
+        return false;
+    }
+
+    file = LittleFS.open(SESSION_SPILL_PATH, "r");
+    if (!file)
+    {
+        Serial.println("ERROR: Failed to open spill file");
+        return false;
+    }
+
+    readChunk = 0;
+    return true;
+}
+
+size_t SessionSpill::read(Storage &out, size_t maxFrames)
+{
+    out.clear();
+    if (!file || !containerReady)
+        return 0;
+
+    // Whole chunks only, one column at a time through columnBuffer
+    while (readChunk < index.size() && out.size() + index[readChunk].frames <= maxFrames)
+    {
+        const ColumnChunkEntry &chunk = index[readChunk];
+        size_t base = out.size();
+        out.resize(base + chunk.frames);
+
+        bool ok = true;
+        for (uint8_t column = 0; column <= NUM_SENSORS && ok; column++)
+        {
+            size_t length = chunk.columnSize(column);
+            if (length == 0)
+                continue;
+            ok = length <= columnBuffer.size() && readColumn(readChunk, column, 0, columnBuffer.data(), length) &&
+                 (column == 0 ? ColumnCodec::decodeTimestamps(columnBuffer.data(), length, &out[base], chunk.frames)
+                              : ColumnCodec::decodePosition(columnBuffer.data(), length, column - 1, &out[base],
+                                                            chunk.frames));
+        }
+
+        if (!ok)
+        {
+            Serial.printf("ERROR: Spill file chunk %u of %u unreadable\n", (unsigned)readChunk,
+                          (unsigned)index.size());
+            out.resize(base);
+            readChunk = index.size();
+            break;
+        }
+        readChunk++;
+    }
+    return out.size();
+}
+
+bool SessionSpill::openContainer()
+{
+    if (active)
+        return false;
+    if (!containerReady && !loadIndex())
+        return false;
+    if (!file)
+        file = LittleFS.open(SESSION_SPILL_PATH, "r");
+    return (bool)file;
+}
+
+bool SessionSpill::loadIndex()
+{
+    // Written by an earlier boot: header and trailer say what it holds
+    File in = LittleFS.open(SESSION_SPILL_PATH, "r");
+    if (!in)
+        return false;
+
+    uint8_t header[13];
+    uint8_t trailer[SESSION_SPILL_TRAILER_BYTES];
+    size_t size = in.size();
+    bool ok = size >= sizeof(header) + sizeof(trailer) && in.read(header, sizeof(header)) == sizeof(header) &&
+              memcmp(header, "COL1", 4) == 0 && header[4] == 1 && header[5] == NUM_SENSORS &&
+              header[12] < SESSION_SPILL_ID_MAX && in.read((uint8_t *)sessionId, header[12]) == header[12] &&
+              in.seek(size - sizeof(trailer)) && in.read(trailer, sizeof(trailer)) == sizeof(trailer) &&
+              memcmp(trailer + 12, "COL1", 4) == 0;
+
+    uint32_t indexOffset = 0;
+    uint32_t chunkCount = 0;
+    if (ok)
+    {
+        sessionId[header[12]] = '\0';
+        memcpy(&startMs, header + 8, 4);
+        memcpy(&indexOffset, trailer, 4);
+        memcpy(&chunkCount, trailer + 4, 4);
+        ok = chunkCount <= SESSION_SPILL_INDEX_MAX &&
+             indexOffset + chunkCount * COLUMN_CODEC_ENTRY_BYTES + sizeof(trailer) == size &&
+             in.seek(indexOffset);
+    }
+
+    index.clear();
+    uint8_t entry[COLUMN_CODEC_ENTRY_BYTES];
+    for (uint32_t i = 0; ok && i < chunkCount; i++)
+    {
+        ok = in.read(entry, sizeof(entry)) == sizeof(entry);
+        ColumnChunkEntry chunk;
+        ColumnCodec::unpackEntry(entry, chunk);
+        index.push_back(chunk);
+    }
+    in.close();
+
+    if (!ok)
+    {
+        index.clear();
+        sessionId[0] = '\0';
+        return false;
+    }
+    containerReady = true;
+    return true;
+}
+
+bool SessionSpill::readColumn(size_t chunk, uint8_t column, size_t offset, uint8_t *out, size_t length)
+{
+    if (!file || chunk >= index.size() || column > NUM_SENSORS ||
+        offset + length > index[chunk].columnSize(column))
+        return false;
+    return file.seek(index[chunk].columnOffset(column) + offset) && file.read(out, length) == length;
+}
+
+void SessionSpill::writerTaskFunction(void *parameter)
+{
+    static_cast<SessionSpill *>(parameter)->runWriter();
+}
+
+void SessionSpill::runWriter()
+{
+    for (;;)
+    {
+        Chunk *chunk = nullptr;
+        if (xQueueReceive(writeQueue, &chunk, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        if (full)
+            loseFrames(*chunk, 0);
+        else
+            writeChunk(*chunk);
+
+        chunk->count = 0;
+        xQueueSend(freeQueue, &chunk, 0);
+    }
+}
+
+void SessionSpill::writeChunk(const Chunk &chunk)
+{
+    // One column chunk per SESSION_COLUMN_CHUNK_MS window since the first
+    // frame; a window split by two spill chunks gets two
+    const uint32_t windowUs = SESSION_COLUMN_CHUNK_MS * 1000UL;
+    if (!haveFirst && chunk.count > 0)
+    {
+        firstUs = chunk.frames[0].timestamp_us;
+        haveFirst = true;
+    }
+
+    size_t start = 0;
+    while (start < chunk.count)
+    {
+        uint32_t window = (chunk.frames[start].timestamp_us - firstUs) / windowUs;
+        size_t count = 1;
+        while (start + count < chunk.count && (chunk.frames[start + count].timestamp_us - firstUs) / windowUs == window)
+            count++;
+
+        if (!writeColumnChunk(&chunk.frames[start], count))
+        {
+            loseFrames(chunk, start);
+            return;
+        }
+        start += count;
+    }
+}
+
+bool SessionSpill::writeColumnChunk(const SensorFrame *frames, size_t count)
+{
+    // Worst-case size, so the budget can never be overrun mid-chunk
+    size_t worst = COLUMN_CODEC_MAX_TIMESTAMP_BYTES(count) + NUM_SENSORS * COLUMN_CODEC_MAX_POSITION_BYTES(count);
+    if (fileBytes + worst > budgetBytes || index.size() >= SESSION_SPILL_INDEX_MAX)
+    {
+        Serial.println("WARNING: Spill file reached the flash budget");
+        full = true;
+        return false;
+    }
+
+    ColumnChunkEntry entry = {};
+    entry.offset = fileBytes;
+    entry.firstUs = frames[0].timestamp_us;
+    entry.lastUs = frames[count - 1].timestamp_us;
+    entry.frames = count;
+
+    uint8_t *buffer = columnBuffer.data();
+    size_t length = ColumnCodec::encodeTimestamps(frames, count, buffer);
+    bool ok = file.write(buffer, length) == length;
+    entry.timestampBytes = length;
+    fileBytes += length;
+
+    for (uint8_t pos = 0; pos < NUM_SENSORS && ok; pos++)
+    {
+        length = ColumnCodec::encodePosition(frames, count, pos, buffer);
+        ok = length == 0 || file.write(buffer, length) == length;
+        entry.columnBytes[pos] = length;
+        fileBytes += length;
+    }
+
+    if (!ok)
+    {
+        // Nothing after this would be where the index says
+        Serial.println("ERROR: Spill file write failed");
+        full = true;
+        return false;
+    }
+
+    index.push_back(entry);
+    return true;
+}
+
+void SessionSpill::loseFrames(const Chunk &chunk, size_t from)
+{
+    uint32_t readings = 0;
+    for (size_t f = from; f < chunk.count; f++)
+        readings += chunk.frames[f].validCount();
+    lostFrames += chunk.count - from;
+    lostReadings += readings;
+}
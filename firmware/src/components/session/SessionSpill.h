@@ -0,0 +1,215 @@
+#ifndef SESSION_SPILL_H
+#define SESSION_SPILL_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "../sensor/SensorFrame.h"
+#include "../memory/PSRAMAllocator.h"
+#include "../data/ColumnCodec.h"
+
+/**
+ * SessionSpill - Streams a Debug session to a LittleFS file while it runs
+ *
+ * Lifts the in-memory session ceiling (MAX_BUFFER_SIZE frames, 30 s at
+ * 1 kHz): SessionManager fills fixed PSRAM chunks instead of the data
+ * buffer, and every full chunk is handed to a background writer task that
+ * appends it to SESSION_SPILL_PATH as col1 chunks (see ColumnCodec.h: one
+ * per SESSION_COLUMN_CHUNK_MS window, columns per position). At upload time
+ * the file is decoded back into the data buffer one segment at a time and
+ * sent with the normal batch code.
+ *
+ * The file is a self-describing container, kept after the upload until
+ * the next spilled session starts:
+ *
+ *   header   "COL1", u8 version, u8 positions, u16 chunk_ms, u32 start_ms,
+ *            u8 id length, session id
+ *   chunks   columns back to back (ColumnChunkEntry)
+ *   index    one packed ColumnChunkEntry per chunk
+ *   trailer  u32 index offset, u32 chunk count, u32 frame count, "COL1"
+ *
+ * so a time range or a subset of positions can be served later (fetch_range,
+ * DataTransmitter::transmitRange()) by reading only the columns it needs.
+ * A file without a trailer (power lost while collecting) is not served.
+ *
+ * - Chunks are reserved once at begin(); push() never allocates or
+ *   touches flash
+ * - If the writer falls behind and no chunk is free, push() fails and the
+ *   caller counts the frame as a buffer drop
+ * - The file is capped by free filesystem space less
+ *   SESSION_SPILL_RESERVE_BYTES (config and certificates stay
+ *   writable); past that isFull() is set and further chunks are lost
+ * - Flash erases stall both cores briefly; they show up in the session
+ *   summary as missed ticks / long cycle periods
+ *
+ * Everything but the writer is loop task only.
+ */
+
+#ifndef SESSION_SPILL_CHUNKS
+#define SESSION_SPILL_CHUNKS 3
+#endif
+
+// Frames per chunk (2 s at 1 kHz, 64 KB of PSRAM)
+#ifndef SESSION_SPILL_CHUNK_FRAMES
+#define SESSION_SPILL_CHUNK_FRAMES 2048
+#endif
+
+// Filesystem space left free for config.json and certificates
+#ifndef SESSION_SPILL_RESERVE_BYTES
+#define SESSION_SPILL_RESERVE_BYTES (64 * 1024)
+#endif
+
+// Auto-stop for spilled sessions (flash space may end them sooner)
+#ifndef SESSION_SPILL_MAX_MS
+#define SESSION_SPILL_MAX_MS 300000
+#endif
+
+// Index records reserved at begin(): a full-length session needs about
+// SESSION_SPILL_MAX_MS / SESSION_COLUMN_CHUNK_MS plus one per spill chunk
+#ifndef SESSION_SPILL_INDEX_MAX
+#define SESSION_SPILL_INDEX_MAX 2048
+#endif
+
+#define SESSION_SPILL_PATH "/session.col"
+#define SESSION_SPILL_LEGACY_PATH "/session.dvz" // dvz1 stream of older firmware
+#define SESSION_SPILL_ID_MAX 64
+#define SESSION_SPILL_TRAILER_BYTES 16
+
+static_assert(SESSION_SPILL_CHUNKS >= 2, "SessionSpill needs one chunk filling while another is written");
+
+class SessionSpill
+{
+public:
+    typedef std::vector<SensorFrame, PSRAMAllocator<SensorFrame>> Storage;
+    typedef std::vector<ColumnChunkEntry, PSRAMAllocator<ColumnChunkEntry>> Index;
+
+    /**
+     * Reserve chunk memory and start the writer task (LittleFS must be mounted
+     * before start())
+     * @return false if PSRAM or task creation failed
+     */
+    bool begin();
+
+    bool isReady() const { return writerTask != nullptr; }
+
+    /**
+     * Replace the spill file with an empty container and start accepting frames
+     * @param sessionId Stored in the header (fetch_range checks it)
+     * @param startMs Session start (millis(); uploads send it as start_timestamp)
+     * @return false if the file cannot be created
+     */
+    bool start(const String &sessionId, uint32_t startMs);
+
+    /**
+     * Queue one frame (loop task). Constant cost; a full chunk is handed to
+     * the writer.
+     * @return false if no chunk was free (frame dropped)
+     */
+    bool push(const SensorFrame &frame);
+
+    /**
+     * Hand over the partial chunk, wait for the writer to drain, append the
+     * index and close the file
+     */
+    void finish();
+
+    /**
+     * Delete the spill file
+     */
+    void discard();
+
+    /**
+     * Session cleared: close the file but keep it for range fetches
+     */
+    void close();
+
+    // Frames / readings accepted and not lost to the flash budget or a write error
+    uint32_t frameCount() const { return pushedFrames - lostFrames; }
+    uint32_t readingCount() const { return pushedReadings - lostReadings; }
+    uint32_t getLostReadings() const { return lostReadings; }
+    uint32_t getFileBytes() const { return fileBytes; }
+    bool isFull() const { return full; }
+
+    /**
+     * Rewind to the first spilled frame for read()
+     */
+    bool openRead();
+
+    /**
+     * Decode the next whole chunks into out (cleared first, capacity kept)
+     * @param maxFrames At least SESSION_SPILL_CHUNK_FRAMES
+     * @return Frames read; 0 at end of file or on a decode error
+     */
+    size_t read(Storage &out, size_t maxFrames);
+
+    // --- Finished container (range fetches) ---
+
+    /**
+     * Open the last finished container for readColumn(), loading its header
+     * and index if this boot did not write it
+     * @return false if there is none (or it was never finished)
+     */
+    bool openContainer();
+
+    const char *getSessionId() const { return sessionId; }
+    uint32_t getStartMs() const { return startMs; }
+    const Index &getIndex() const { return index; }
+
+    /**
+     * Read part of one column of a chunk (after openContainer())
+     * @param column 0 = timestamps, 1 + position
+     * @param offset Byte offset into the column
+     * @return false on a read error or past the end of the column
+     */
+    bool readColumn(size_t chunk, uint8_t column, size_t offset, uint8_t *out, size_t length);
+
+private:
+    struct Chunk
+    {
+        Storage frames;
+        size_t count = 0;
+    };
+
+    Chunk chunks[SESSION_SPILL_CHUNKS];
+    Chunk *current = nullptr; // Loop task only
+    QueueHandle_t freeQueue = nullptr;
+    QueueHandle_t writeQueue = nullptr;
+    TaskHandle_t writerTask = nullptr;
+
+    File file;
+
+    // One column at a time: encoded by the writer while collecting,
+    // decoded from while uploading (PSRAM, reserved at begin())
+    std::vector<uint8_t, PSRAMAllocator<uint8_t>> columnBuffer;
+
+    // Container: header fields and the index (PSRAM, reserved at begin())
+    Index index;
+    char sessionId[SESSION_SPILL_ID_MAX] = "";
+    uint32_t startMs = 0;
+    uint32_t firstUs = 0;     // First frame: chunk windows count from here
+    bool haveFirst = false;
+    bool containerReady = false; // Index complete (finished or loaded)
+    size_t readChunk = 0;     // read(): next chunk to decode
+
+    size_t budgetBytes = 0;
+    bool active = false;
+    volatile bool full = false;
+    volatile uint32_t fileBytes = 0;
+    volatile uint32_t lostFrames = 0;
+    volatile uint32_t lostReadings = 0;
+    uint32_t pushedFrames = 0;
+    uint32_t pushedReadings = 0;
+
+    static void writerTaskFunction(void *parameter);
+    void runWriter();
+    void writeChunk(const Chunk &chunk);
+    bool writeColumnChunk(const SensorFrame *frames, size_t count);
+    void loseFrames(const Chunk &chunk, size_t from);
+    bool writeHeader();
+    bool writeIndex();
+    bool loadIndex();
+};
+
+#endif
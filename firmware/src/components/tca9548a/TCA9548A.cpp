@@ -37,6 +37,7 @@ bool TCA9548A::selectChannel(uint8_t channel)
         _currentChannel = channel;
         return true;
     }
+    _currentChannel = 0xFF; // Hardware state unknown after a failed write
     return false;
 }
 
@@ -61,4 +62,9 @@ uint8_t TCA9548A::getCurrentChannel()
 bool TCA9548A::isChannelSelected(uint8_t channel)
 {
     return (_currentChannel == channel);
+}
+
+void TCA9548A::invalidateCache()
+{
+    _currentChannel = 0xFF;
 }
\ No newline at end of file
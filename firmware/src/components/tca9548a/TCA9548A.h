@@ -12,6 +12,7 @@ public:
     void disableAllChannels();
     uint8_t getCurrentChannel();
     bool isChannelSelected(uint8_t channel);
+    void invalidateCache(); // Forget cached channel (next select always writes)
 
 private:
     uint8_t _address;
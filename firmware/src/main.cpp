@@ -4,20 +4,42 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include "components/network/NetworkManager.h"
+#include "components/network/ConnectionSupervisor.h"
+#include "components/network/LanEventStream.h"
+#include "components/network/HoopArray.h"
+#include "components/network/TimeSync.h"
 #include "components/mqtt/MQTTManager.h"
+#include "components/mqtt/StatusPublisher.h"
+#include "components/mqtt/CommandDispatcher.h"
 #include "components/display/DisplayManager.h"
+#include "components/display/UITask.h"
 #include "components/sensor/SensorManager.h"
 #include "components/sensor/SensorConfiguration.h"
+#include "components/sensor/ConfigCache.h"
+#include "components/sensor/AdaptiveRateScheduler.h"
 #include "components/session/SessionManager.h"
+#include "components/session/SessionSpill.h"
 #include "components/data/DataTransmitter.h"
+#include "components/data/CaptureUploader.h"
 #include "components/diagnostics/MemoryMonitor.h"
+#include "components/diagnostics/CycleProfiler.h"
+#include "components/diagnostics/HeapTracker.h"
+#include "components/diagnostics/TaskMonitor.h"
+#include "components/diagnostics/LatencyTracker.h"
 #include "components/detection/DirectionDetector.h"
 #include "components/detection/MLDetector.h"
+#include "components/detection/DetectionTask.h"
+#include "components/detection/LaneKernels.h"
 #include "components/led/LEDController.h"
 #include "components/power/PowerMonitor.h"
+#include "components/power/PowerProfileManager.h"
+#include "components/power/LightSleepIdle.h"
 #include "components/interrupt/InterruptManager.h"
 #include "components/calibration/CalibrationManager.h"
+#include "components/calibration/CalibrationStore.h"
+#include "components/calibration/AutoCalibrator.h"
 #include "components/serialstudio/SerialStudioOutput.h"
+#include "components/ota/OtaUpdater.h"
 
 // Button pins for T-Display-S3
 #define BUTTON_1 0  // Left button (BOOT)
@@ -40,15 +62,43 @@ DisplayManager display;
 SensorManager sensorManager;
 SessionManager sessionManager;
 DataTransmitter *dataTransmitter;
+CaptureUploader captureUploader; // Live Debug captures upload in the background
+CaptureRing playStream;          // Play: newest frames for Serial Studio, followed by cursor
+SessionSpill sessionSpill;       // Debug: sessions longer than memory stream to LittleFS
+ConfigCache configCache;         // Last good cloud sensor_config, used at boot
+CalibrationStore calibrationStore; // Calibration, PS_CANC and detector baselines in NVS
+AutoCalibrator autoCalibrator;     // Thresholds / PS_CANC follow idle drift during detection
+MessageOutbox outbox;            // Data messages held while the broker is unreachable
+ConnectionSupervisor connectionSupervisor; // WiFi/MQTT reconnects with backoff, off loop()
+StatusPublisher statusPublisher;           // Status messages sent from a background task
+CommandDispatcher commands;                // MQTT commands, run on their own task
 DirectionDetector directionDetector;
 MLDetector mlDetector;
+DetectionTask detectionTask; // Feeds the detectors from the sensor task, off loop()
+AdaptiveRateScheduler rateScheduler; // Detector activity -> sensor sample rate (adaptive_rate)
+LanEventStream lanStream;            // Detections to the LAN as UDP datagrams (lan_stream)
+HoopArray hoopArray;                 // Shared clock and merged detections across units (array_role)
 LEDController ledController;
+UITask ui;                           // Renders display + LED commands off loop()
 PowerMonitor powerMonitor;
+PowerProfileManager powerProfiles;   // VSYS / current draw -> operating profile (battery installs)
+LightSleepIdle lightSleep;           // Sleep through INT idle instead of spinning loop() (light_sleep_idle)
 SerialStudioOutput serialStudioOutput;
+OtaUpdater otaUpdater;               // Firmware / model images streamed to flash, with rollback
 
 // Detection mode: false = heuristic (DirectionDetector), true = ML (MLDetector)
 bool useMLDetection = false;
 
+// ML inference scheduling: detection_mode "ml" (triggered) or "ml_sliding"
+bool mlSlidingInference = false;
+uint16_t mlStrideMs = ML_SLIDING_STRIDE_MS;
+
+// detection_mode "ensemble": heuristic on every frame, the model (on demand)
+// only for ambiguous results. Needs the model, so useMLDetection is set too.
+bool ensembleDetection = false;
+float ensembleConfidence = ENSEMBLE_CONFIDENCE;
+uint16_t ensembleMinGapMs = ENSEMBLE_MIN_GAP_MS;
+
 // Detection algorithm config (runtime-configurable via cloud config)
 DetectorConfig detectorConfig;
 
@@ -63,30 +113,83 @@ DeviceMode currentMode = DeviceMode::DEBUG; // Default to debug for backwards co
 bool playModeActive = false;
 unsigned long lastDetectionTime = 0;
 const unsigned long DETECTION_COOLDOWN = 500; // 500ms - prevents double-trigger, allows quick successive throws
+const unsigned long LIGHT_SLEEP_QUIET_MS = 3500; // No light sleep while a detection is shown on the LEDs
 
 // Live Debug mode state
 bool liveDebugActive = false;
 
-// Live Debug capture window constants
-const size_t LIVE_DEBUG_BUFFER_CAP = 18000;        // ~3 seconds buffer cap
-const unsigned long DETECTION_WINDOW_MS = 500;     // 0.5s of pre-detection data to capture
-const unsigned long POST_DETECTION_DELAY_MS = 250; // 0.25s of post-detection data (sensor task keeps collecting)
+// Detection capture waiting for its post-detection tail (sampling never pauses)
+bool liveDebugCapturePending = false;
+unsigned long liveDebugCaptureDue = 0;
+const char *pendingCaptureDirection = "unknown";
+float pendingCaptureConfidence = 0.0f;
+uint32_t pendingCaptureTriggerUs = 0; // Timestamp of the detecting frame
+
+// DEBUG session upload: runs on the command task ("upload_session"); a failed
+// upload keeps the stopped session (state UPLOADING) and is tried again
+const unsigned long SESSION_UPLOAD_RETRY_MS = 15000;
+const uint8_t SESSION_UPLOAD_ATTEMPTS = 5;
+const char *sessionUploadStatus = "upload_complete"; // Posted on success
+uint8_t sessionUploadAttempts = 0;
+unsigned long sessionUploadRetryAt = 0; // 0 = no retry scheduled
+
+// Capture window constants (detection windows: capture_pre/post_trigger_ms)
+const size_t PLAY_STREAM_FRAMES = 256;             // Play ring depth: Serial Studio lag it can absorb
 const unsigned long MISSED_EVENT_WINDOW_MS = 3000; // 3s of pre-button data to capture
 
 // Timing
 unsigned long lastStatusUpdate = 0;
 const unsigned long STATUS_UPDATE_INTERVAL = 30000; // 30 seconds
 
+// Set by the connection supervisor task, reported from loop()
+volatile bool connectionStateChanged = false;
+volatile bool configRefreshDue = false; // Came online; loop() starts the config fetch
+
 bool systemInitialized = false;
 
 // Global sensor configuration instance
 SensorConfiguration currentConfig;
 
+// currentConfig within the power profile's limits: what the sensors run with
+SensorConfiguration sensorConfig;
+
 // Forward declarations
 void initializeSystem();
-void handleCommand(const String &command, JsonDocument *doc = nullptr);
+void registerCommands();
+bool queueLiveDebugCapture(const char *captureReason, const char *detectionDirection,
+                           float detectionConfidence, unsigned long windowStartUs, const char *successStatus);
+unsigned long captureWindowStart(uint32_t triggerUs, unsigned long preMs);
 bool fetchConfigFromCloud();
 void configureBQ24195();
+bool postStatusWithML(const char *status);
+void addMLStatus(JsonDocument &details);
+DetectorMode activeDetectorMode();
+bool pipelinedDetection();
+const char *detectionModeName();
+void applyEnsembleConfig(JsonObject config);
+void stageDetectorSetup();
+void applyHybridConfig(JsonObject config);
+void applyAdaptiveRateConfig(JsonObject config);
+CalibrationSettings calibrationSettings();
+bool parallelCalibration();
+void resetDirectionDetector();
+void addAutoCalibration(JsonDocument &details);
+void addI2CHealth(JsonDocument &details);
+void recordShownLatency(const DetectionEvent &event);
+void applyPowerConfig(JsonObject config);
+SensorConfiguration *limitedSensorConfig();
+void applyPowerProfile();
+void addPowerProfile(JsonDocument &details);
+void addArrayDetections(JsonDocument &details);
+void addHeapStats(JsonDocument &details);
+bool bq24195PowerGood();
+void idleLightSleep();
+void finalizeDebugSession();
+void uploadDebugSession();
+void queueSessionUpload(const char *successStatus);
+void submitSessionUpload();
+void addSessionUpload(JsonDocument &details);
+bool swapModel(OtaUpdater &ota, void *context);
 
 // BQ24195 battery charger / power-path manager (main PCB v6+)
 // On v6 the D+/D- pins are tied to GND, so the BQ falls back to its default
@@ -102,6 +205,10 @@ void configureBQ24195();
 #define BQ24195_REG00_VAL   0x36
 // REG05: EN_TERM=1, WATCHDOG=00 (disabled), EN_TIMER=1, CHG_TIMER=01 (8 h) -> 0x8A
 #define BQ24195_REG05_VAL   0x8A
+#define BQ24195_REG08       0x08 // System Status (read only)
+#define BQ24195_PG_STAT     0x04 // REG08 bit 2: input source present (power good)
+
+bool bq24195Present = false;
 
 void setup()
 {
@@ -147,6 +254,7 @@ void configureBQ24195()
         Serial.println("BQ24195 not found at 0x6B - skipping (bare T-Display?)");
         return;
     }
+    bq24195Present = true;
 
     // REG00: raise IINLIM to 2 A and clear EN_HIZ.
     Wire.beginTransmission(BQ24195_I2C_ADDR);
@@ -170,6 +278,212 @@ void configureBQ24195()
     }
 }
 
+// Cloud sensor_config (cached copy at boot) -> currentConfig, detector
+// config and output settings. Runs before the sensors are initialized.
+void loadSensorConfig(JsonObject config)
+{
+    // Update current configuration
+    // Handle both sample_rate and sample_rate_hz for compatibility
+    if (config.containsKey("sample_rate_hz"))
+    {
+        currentConfig.sample_rate_hz = config["sample_rate_hz"];
+    }
+    else if (config.containsKey("sample_rate"))
+    {
+        currentConfig.sample_rate_hz = config["sample_rate"];
+    }
+
+    currentConfig.led_current = config["led_current"] | "200mA";
+    currentConfig.integration_time = config["integration_time"] | "1T";
+    currentConfig.duty_cycle = config["duty_cycle"] | "1/40";
+    currentConfig.high_resolution = config["high_resolution"] | true;
+    currentConfig.read_ambient = config["read_ambient"] | true;
+    currentConfig.active_force = config["active_force"] | false;
+    currentConfig.skew_compensation = config["skew_compensation"] | false;
+    currentConfig.duplicate_mode = config["duplicate_mode"] | "off";
+
+    // New field: I2C clock speed
+    if (config.containsKey("i2c_clock_khz"))
+    {
+        currentConfig.i2c_clock_khz = config["i2c_clock_khz"];
+    }
+
+    // New field: Multi-pulse mode
+    if (config.containsKey("multi_pulse"))
+    {
+        currentConfig.multi_pulse = config["multi_pulse"].as<String>();
+    }
+    else
+    {
+        currentConfig.multi_pulse = "1"; // Default: 1 pulse
+    }
+
+    // Physical geometry for transit speed estimation
+    if (config.containsKey("ball_diameter_mm"))
+        currentConfig.ball_diameter_mm = config["ball_diameter_mm"];
+    if (config.containsKey("hoop_inner_diameter_mm"))
+        currentConfig.hoop_inner_diameter_mm = config["hoop_inner_diameter_mm"];
+
+    // Sensor mode (polling vs interrupt)
+    if (config.containsKey("sensor_mode"))
+    {
+        String modeStr = config["sensor_mode"].as<String>();
+        currentConfig.sensor_mode = (modeStr == "interrupt") ? SensorMode::INTERRUPT_MODE
+                                    : (modeStr == "hybrid")  ? SensorMode::HYBRID_MODE
+                                                             : SensorMode::POLLING_MODE;
+    }
+    applyHybridConfig(config);
+    applyAdaptiveRateConfig(config);
+    applyPowerConfig(config);
+
+    // Interrupt settings (calibration-based approach)
+    if (config.containsKey("interrupt_threshold_margin"))
+    {
+        currentConfig.interrupt_threshold_margin = config["interrupt_threshold_margin"];
+    }
+    if (config.containsKey("interrupt_hysteresis"))
+    {
+        currentConfig.interrupt_hysteresis = config["interrupt_hysteresis"];
+    }
+    if (config.containsKey("interrupt_integration_time"))
+    {
+        currentConfig.interrupt_integration_time = config["interrupt_integration_time"];
+    }
+    if (config.containsKey("interrupt_multi_pulse"))
+    {
+        currentConfig.interrupt_multi_pulse = config["interrupt_multi_pulse"];
+    }
+    if (config.containsKey("interrupt_persistence"))
+    {
+        currentConfig.interrupt_persistence = config["interrupt_persistence"];
+    }
+    if (config.containsKey("interrupt_smart_persistence"))
+    {
+        currentConfig.interrupt_smart_persistence = config["interrupt_smart_persistence"];
+    }
+    if (config.containsKey("interrupt_mode"))
+    {
+        currentConfig.interrupt_mode = config["interrupt_mode"].as<String>();
+    }
+    if (config.containsKey("upload_format"))
+    {
+        currentConfig.upload_format = config["upload_format"].as<String>();
+    }
+    if (config.containsKey("capture_pre_trigger_ms"))
+        currentConfig.capture_pre_trigger_ms = config["capture_pre_trigger_ms"];
+    if (config.containsKey("capture_post_trigger_ms"))
+        currentConfig.capture_post_trigger_ms = config["capture_post_trigger_ms"];
+    if (config.containsKey("spill_to_flash"))
+        currentConfig.spill_to_flash = config["spill_to_flash"];
+    if (config.containsKey("lan_stream"))
+        currentConfig.lan_stream = config["lan_stream"];
+    if (config.containsKey("lan_stream_frames"))
+        currentConfig.lan_stream_frames = config["lan_stream_frames"];
+    if (config.containsKey("array_role"))
+        currentConfig.array_role = config["array_role"].as<String>();
+    if (config.containsKey("auto_calibration"))
+        currentConfig.auto_calibration = config["auto_calibration"];
+    autoCalibrator.setEnabled(currentConfig.auto_calibration);
+
+    Serial.println("\nSensor config:");
+    Serial.printf("  Sensor Mode: %s\n", currentConfig.sensor_mode == SensorMode::INTERRUPT_MODE ? "INTERRUPT"
+                                          : currentConfig.sensor_mode == SensorMode::HYBRID_MODE  ? "HYBRID"
+                                                                                                  : "POLLING");
+    Serial.printf("  Sample Rate: %d Hz\n", currentConfig.sample_rate_hz);
+    Serial.printf("  LED Current: %s\n", currentConfig.led_current.c_str());
+    Serial.printf("  Integration Time: %s\n", currentConfig.integration_time.c_str());
+    Serial.printf("  Multi-Pulse: %s pulses\n", currentConfig.multi_pulse.c_str());
+    Serial.printf("  High Resolution: %s\n", currentConfig.high_resolution ? "enabled" : "disabled");
+    Serial.printf("  Read Ambient: %s\n", currentConfig.read_ambient ? "enabled" : "disabled");
+    Serial.printf("  Active Force: %s\n", currentConfig.active_force ? "enabled" : "disabled");
+    Serial.printf("  Skew Compensation: %s\n",
+                  !currentConfig.skew_compensation ? "disabled"
+                  : SENSOR_SKEW_OFFSETS            ? "enabled"
+                                                   : "enabled (cycle timestamps only)");
+    Serial.printf("  Duplicate Mode: %s (sensors convert every %lu us)\n", currentConfig.duplicate_mode.c_str(),
+                  (unsigned long)currentConfig.conversionPeriodUs());
+    if (currentConfig.adaptive_rate)
+        Serial.printf("  Adaptive Rate: idle %d Hz, approach %.2f, hold %d ms\n",
+                      currentConfig.adaptive_idle_rate_hz, currentConfig.adaptive_approach_fraction,
+                      currentConfig.adaptive_hold_ms);
+    Serial.printf("  I2C Clock: %d kHz\n", currentConfig.i2c_clock_khz);
+    Serial.printf("  Upload Format: %s\n", currentConfig.upload_format.c_str());
+    Serial.printf("  Spill To Flash: %s\n", currentConfig.spill_to_flash ? "enabled" : "disabled");
+    Serial.printf("  LAN Stream: %s\n", currentConfig.lan_stream ? (currentConfig.lan_stream_frames ? "detections + frames" : "detections") : "disabled");
+    Serial.printf("  Auto Calibration: %s\n", currentConfig.auto_calibration ? "enabled" : "disabled");
+    lanStream.setEnabled(currentConfig.lan_stream, currentConfig.lan_stream_frames);
+    Serial.printf("  Hoop Array: %s\n", currentConfig.array_role.c_str());
+    hoopArray.setRole(HoopArray::parseRole(currentConfig.array_role));
+    Serial.printf("  Capture Window: %d ms pre / %d ms post trigger\n",
+                  currentConfig.capture_pre_trigger_ms, currentConfig.capture_post_trigger_ms);
+    if (currentConfig.sensor_mode == SensorMode::INTERRUPT_MODE)
+    {
+        Serial.printf("  INT Threshold Margin: %d\n", currentConfig.interrupt_threshold_margin);
+        Serial.printf("  INT Hysteresis: %d\n", currentConfig.interrupt_hysteresis);
+        Serial.printf("  INT Integration Time: %dT\n", currentConfig.interrupt_integration_time);
+        Serial.printf("  INT Multi-Pulse: %d\n", currentConfig.interrupt_multi_pulse);
+    }
+
+    // Check for detection_mode in sensor config
+    if (config.containsKey("detection_mode"))
+    {
+        String detMode = config["detection_mode"].as<String>();
+        useMLDetection = (detMode == "ml" || detMode == "ml_sliding" || detMode == "ensemble");
+        mlSlidingInference = (detMode == "ml_sliding");
+        ensembleDetection = (detMode == "ensemble");
+        Serial.printf("  Detection Mode: %s (raw value: '%s')\n", detectionModeName(), detMode.c_str());
+    }
+    else
+    {
+        Serial.println("  Detection Mode: not present in cloud config (defaulting to heuristic)");
+    }
+    if (config.containsKey("ml_stride_ms"))
+    {
+        mlStrideMs = config["ml_stride_ms"];
+    }
+    applyEnsembleConfig(config);
+
+    if (config.containsKey("serial_studio_enabled"))
+    {
+        serialStudioEnabled = config["serial_studio_enabled"].as<bool>();
+        serialStudioOutput.setEnabled(serialStudioEnabled);
+        Serial.printf("  Serial Studio: %s\n", serialStudioEnabled ? "enabled" : "disabled");
+    }
+    if (config.containsKey("serial_studio_format"))
+    {
+        String format = config["serial_studio_format"].as<String>();
+        serialStudioOutput.setFormat(format == "binary" ? SerialStudioFormat::BINARY : SerialStudioFormat::CSV);
+        Serial.printf("  Serial Studio Format: %s\n", format == "binary" ? "binary" : "csv");
+    }
+    if (config.containsKey("serial_studio_decimation"))
+    {
+        serialStudioOutput.setDecimation(config["serial_studio_decimation"].as<uint8_t>());
+        Serial.printf("  Serial Studio Decimation: every %d frame(s)\n", serialStudioOutput.getDecimation());
+    }
+
+    // Detection algorithm parameters
+    if (config.containsKey("peak_multiplier"))
+        detectorConfig.peakMultiplier = config["peak_multiplier"].as<float>();
+    if (config.containsKey("min_rise"))
+        detectorConfig.minRise = config["min_rise"];
+    if (config.containsKey("min_wave_duration_ms"))
+        detectorConfig.minWaveDurationMs = config["min_wave_duration_ms"];
+    if (config.containsKey("smoothing_window"))
+        detectorConfig.smoothingWindow = config["smoothing_window"];
+    if (config.containsKey("multi_transit"))
+        detectorConfig.multiTransit = config["multi_transit"];
+    detectorConfig.skewCompensation = currentConfig.skew_compensation;
+
+    directionDetector.setConfig(detectorConfig);
+    Serial.printf("  Detection Config: peak=%.1fx, rise=%d, wave=%dms, smooth=%d%s\n",
+                  detectorConfig.peakMultiplier, detectorConfig.minRise,
+                  detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow,
+                  detectorConfig.multiTransit ? ", multi-transit" : "");
+}
+
+// Cloud config refresh, on the config fetch task once WiFi is up. A changed
+// sensor_config replaces the cache and is applied through configure_sensors
+// on the command task, like one pushed over MQTT.
 bool fetchConfigFromCloud()
 {
     Serial.println("\n=== Fetching Config from Cloud ===");
@@ -180,7 +494,7 @@ bool fetchConfigFromCloud()
 
     if (apiEndpoint.isEmpty())
     {
-        Serial.println("WARNING: No API endpoint configured, using defaults");
+        Serial.println("WARNING: No API endpoint configured, keeping cached config");
         return false;
     }
 
@@ -193,184 +507,107 @@ bool fetchConfigFromCloud()
     http.setTimeout(5000);
 
     int httpCode = http.GET();
-
-    if (httpCode == HTTP_CODE_OK)
+    if (httpCode != HTTP_CODE_OK)
     {
-        String payload = http.getString();
-        Serial.println("Config received:");
-        Serial.println(payload);
-
-        // Parse JSON response
-        DynamicJsonDocument doc(2048);
-        DeserializationError error = deserializeJson(doc, payload);
-
-        if (error)
-        {
-            Serial.print("JSON parse error: ");
-            Serial.println(error.c_str());
-            http.end();
-            return false;
-        }
-
-        // Extract sensor_config
-        if (doc.containsKey("sensor_config"))
-        {
-            JsonObject config = doc["sensor_config"];
-
-            // Update current configuration
-            // Handle both sample_rate and sample_rate_hz for compatibility
-            if (config.containsKey("sample_rate_hz"))
-            {
-                currentConfig.sample_rate_hz = config["sample_rate_hz"];
-            }
-            else if (config.containsKey("sample_rate"))
-            {
-                currentConfig.sample_rate_hz = config["sample_rate"];
-            }
-
-            currentConfig.led_current = config["led_current"] | "200mA";
-            currentConfig.integration_time = config["integration_time"] | "1T";
-            currentConfig.high_resolution = config["high_resolution"] | true;
-            currentConfig.read_ambient = config["read_ambient"] | true;
-
-            // New field: I2C clock speed
-            if (config.containsKey("i2c_clock_khz"))
-            {
-                currentConfig.i2c_clock_khz = config["i2c_clock_khz"];
-            }
+        Serial.printf("HTTP GET failed, error: %s (code: %d)\n", http.errorToString(httpCode).c_str(), httpCode);
+        http.end();
+        return false;
+    }
 
-            // New field: Multi-pulse mode
-            if (config.containsKey("multi_pulse"))
-            {
-                currentConfig.multi_pulse = config["multi_pulse"].as<String>();
-            }
-            else
-            {
-                currentConfig.multi_pulse = "1"; // Default: 1 pulse
-            }
+    String payload = http.getString();
+    http.end();
+    Serial.println("Config received:");
+    Serial.println(payload);
 
-            // Physical geometry for transit speed estimation
-            if (config.containsKey("ball_diameter_mm"))
-                currentConfig.ball_diameter_mm = config["ball_diameter_mm"];
-            if (config.containsKey("hoop_inner_diameter_mm"))
-                currentConfig.hoop_inner_diameter_mm = config["hoop_inner_diameter_mm"];
+    // Parse JSON response
+    DynamicJsonDocument doc(2048);
+    DeserializationError error = deserializeJson(doc, payload);
+    if (error)
+    {
+        Serial.print("JSON parse error: ");
+        Serial.println(error.c_str());
+        return false;
+    }
 
-            // Sensor mode (polling vs interrupt)
-            if (config.containsKey("sensor_mode"))
-            {
-                String modeStr = config["sensor_mode"].as<String>();
-                currentConfig.sensor_mode = (modeStr == "interrupt")
-                                                ? SensorMode::INTERRUPT_MODE
-                                                : SensorMode::POLLING_MODE;
-            }
+    // Extract sensor_config
+    if (!doc.containsKey("sensor_config"))
+    {
+        Serial.println("WARNING: No sensor_config in response");
+        return false;
+    }
+    JsonObject config = doc["sensor_config"];
 
-            // Interrupt settings (calibration-based approach)
-            if (config.containsKey("interrupt_threshold_margin"))
-            {
-                currentConfig.interrupt_threshold_margin = config["interrupt_threshold_margin"];
-            }
-            if (config.containsKey("interrupt_hysteresis"))
-            {
-                currentConfig.interrupt_hysteresis = config["interrupt_hysteresis"];
-            }
-            if (config.containsKey("interrupt_integration_time"))
-            {
-                currentConfig.interrupt_integration_time = config["interrupt_integration_time"];
-            }
-            if (config.containsKey("interrupt_multi_pulse"))
-            {
-                currentConfig.interrupt_multi_pulse = config["interrupt_multi_pulse"];
-            }
-            if (config.containsKey("interrupt_persistence"))
-            {
-                currentConfig.interrupt_persistence = config["interrupt_persistence"];
-            }
-            if (config.containsKey("interrupt_smart_persistence"))
-            {
-                currentConfig.interrupt_smart_persistence = config["interrupt_smart_persistence"];
-            }
-            if (config.containsKey("interrupt_mode"))
-            {
-                currentConfig.interrupt_mode = config["interrupt_mode"].as<String>();
-            }
+    if (configCache.isCurrent(config))
+    {
+        Serial.println("Cloud config unchanged");
+        return true;
+    }
+    configCache.save(config);
+
+    // Hot-apply: same path as a config pushed over MQTT
+    DynamicJsonDocument command(2048);
+    command["command"] = "configure_sensors";
+    command["sensor_config"] = config;
+    static char text[COMMAND_PAYLOAD_MAX];
+    size_t length = serializeJson(command, text, sizeof(text));
+    if (length == 0 || length >= sizeof(text) - 1)
+    {
+        Serial.println("WARNING: Cloud config too large to apply - cached for next boot");
+        return false;
+    }
+    Serial.println("Cloud config changed - applying");
+    return commands.submit((const uint8_t *)text, length);
+}
 
-            Serial.println("\nConfig loaded from cloud:");
-            Serial.printf("  Sensor Mode: %s\n", currentConfig.sensor_mode == SensorMode::INTERRUPT_MODE ? "INTERRUPT" : "POLLING");
-            Serial.printf("  Sample Rate: %d Hz\n", currentConfig.sample_rate_hz);
-            Serial.printf("  LED Current: %s\n", currentConfig.led_current.c_str());
-            Serial.printf("  Integration Time: %s\n", currentConfig.integration_time.c_str());
-            Serial.printf("  Multi-Pulse: %s pulses\n", currentConfig.multi_pulse.c_str());
-            Serial.printf("  High Resolution: %s\n", currentConfig.high_resolution ? "enabled" : "disabled");
-            Serial.printf("  Read Ambient: %s\n", currentConfig.read_ambient ? "enabled" : "disabled");
-            Serial.printf("  I2C Clock: %d kHz\n", currentConfig.i2c_clock_khz);
-            if (currentConfig.sensor_mode == SensorMode::INTERRUPT_MODE)
-            {
-                Serial.printf("  INT Threshold Margin: %d\n", currentConfig.interrupt_threshold_margin);
-                Serial.printf("  INT Hysteresis: %d\n", currentConfig.interrupt_hysteresis);
-                Serial.printf("  INT Integration Time: %dT\n", currentConfig.interrupt_integration_time);
-                Serial.printf("  INT Multi-Pulse: %d\n", currentConfig.interrupt_multi_pulse);
-            }
+// Runs fetchConfigFromCloud() once per boot; a failed fetch is retried the
+// next time the connection comes back
+volatile bool cloudConfigFetched = false;
+TaskHandle_t configFetchTask = nullptr;
 
-            // Check for detection_mode in sensor config
-            if (config.containsKey("detection_mode"))
-            {
-                String detMode = config["detection_mode"].as<String>();
-                useMLDetection = (detMode == "ml");
-                Serial.printf("  Detection Mode: %s (raw value: '%s')\n", useMLDetection ? "ML" : "heuristic", detMode.c_str());
-            }
-            else
-            {
-                Serial.println("  Detection Mode: not present in cloud config (defaulting to heuristic)");
-            }
+void configFetchTaskFunction(void *)
+{
+    if (fetchConfigFromCloud())
+        cloudConfigFetched = true;
+    configFetchTask = nullptr;
+    vTaskDelete(nullptr);
+}
 
-            if (config.containsKey("serial_studio_enabled"))
-            {
-                serialStudioEnabled = config["serial_studio_enabled"].as<bool>();
-                serialStudioOutput.setEnabled(serialStudioEnabled);
-                Serial.printf("  Serial Studio: %s\n", serialStudioEnabled ? "enabled" : "disabled");
-            }
+void startConfigRefresh()
+{
+    if (cloudConfigFetched || configFetchTask != nullptr)
+        return;
 
-            // Detection algorithm parameters
-            if (config.containsKey("peak_multiplier"))
-                detectorConfig.peakMultiplier = config["peak_multiplier"].as<float>();
-            if (config.containsKey("min_rise"))
-                detectorConfig.minRise = config["min_rise"];
-            if (config.containsKey("min_wave_duration_ms"))
-                detectorConfig.minWaveDurationMs = config["min_wave_duration_ms"];
-            if (config.containsKey("smoothing_window"))
-                detectorConfig.smoothingWindow = config["smoothing_window"];
-
-            directionDetector.setConfig(detectorConfig);
-            Serial.printf("  Detection Config: peak=%.1fx, rise=%d, wave=%dms, smooth=%d\n",
-                          detectorConfig.peakMultiplier, detectorConfig.minRise,
-                          detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow);
-
-            http.end();
-            return true;
-        }
-        else
-        {
-            Serial.println("WARNING: No sensor_config in response");
-            http.end();
-            return false;
-        }
-    }
-    else
+    // Stack sized for the HTTPS handshake, like the connection supervisor
+    if (xTaskCreatePinnedToCore(configFetchTaskFunction, "ConfigFetch", 8192, nullptr, 1,
+                                &configFetchTask, 1) != pdPASS)
     {
-        Serial.printf("HTTP GET failed, error: %s (code: %d)\n", http.errorToString(httpCode).c_str(), httpCode);
-        http.end();
-        return false;
+        Serial.println("WARNING: Config fetch task creation failed - running cached config");
+        configFetchTask = nullptr;
     }
 }
 
+// Cached sensor_config, if any, before the sensors are initialized
+bool loadCachedConfig()
+{
+    DynamicJsonDocument doc(2048);
+    if (!configCache.load(doc))
+        return false;
+    loadSensorConfig(doc.as<JsonObject>());
+    return true;
+}
+
 void initializeSystem()
 {
     Serial.println("\n=== Starting System Initialization ===\n");
 
     display.updateInitStage(INIT_BOOT, "Booting up...");
 
-    // --- Phase 1: Network (WiFi → MQTT → cloud config) ---
-    // Done first so we have the real sensor config before initializing hardware.
+    // Session memory first, while PSRAM is still unfragmented
+    sessionManager.reserveBuffers();
+
+    // --- Phase 1: Local config (device credentials, cached sensor config) ---
+    // Nothing here waits for the network: the sensors start with the last
+    // good cloud config and the network comes up in the background.
 
     Serial.println("Loading WiFi config...");
     if (!networkManager.loadConfig())
@@ -382,19 +619,16 @@ void initializeSystem()
     }
     Serial.println("Config loaded successfully");
 
-    Serial.println("Connecting to WiFi...");
-    display.updateInitStage(INIT_WIFI_CONNECTING, "Connecting to WiFi...");
-    if (!networkManager.connectWiFi())
-    {
-        Serial.println("ERROR: WiFi failed!");
-        display.setInitError("WiFi connection failed!");
-        while (1)
-            delay(1000);
-    }
-    Serial.println("WiFi connected!");
-    display.updateInitStage(INIT_WIFI_CONNECTED, "WiFi connected");
-
     mqttManager = new MQTTManager(&networkManager);
+    if (outbox.begin())
+        mqttManager->setOutbox(&outbox);
+    else
+        Serial.println("WARNING: Outbox unavailable - data is lost while MQTT is down");
+
+    // Counts this boot if a new firmware is on probation (may roll back)
+    otaUpdater.setModelSwap(swapModel);
+    if (!otaUpdater.begin(mqttManager))
+        Serial.println("WARNING: OTA updates unavailable");
 
     Serial.println("Loading MQTT config...");
     if (!mqttManager->loadConfig())
@@ -405,59 +639,51 @@ void initializeSystem()
             delay(1000);
     }
     Serial.println("MQTT config loaded");
+    if (!statusPublisher.begin(mqttManager))
+    {
+        Serial.println("WARNING: Status task unavailable - status messages sent inline");
+    }
 
-    Serial.println("Connecting to MQTT...");
-    display.updateInitStage(INIT_MQTT_CONNECTING, "Connecting to AWS IoT...");
-    if (!mqttManager->connect())
+    dataTransmitter = new DataTransmitter(mqttManager);
+    if (!captureUploader.begin(mqttManager))
     {
-        Serial.println("WARNING: MQTT connection failed");
-        display.setInitError("MQTT connection failed!");
-        delay(3000);
+        Serial.println("WARNING: Background capture upload unavailable");
     }
-    else
+    if (!playStream.allocate(PLAY_STREAM_FRAMES))
     {
-        Serial.println("MQTT connected!");
-        display.updateInitStage(INIT_MQTT_CONNECTED, "AWS IoT connected");
+        Serial.println("WARNING: Play stream ring allocation failed");
+    }
+    if (!sessionSpill.begin())
+    {
+        Serial.println("WARNING: Flash spill unavailable - Debug sessions limited to memory");
     }
-
-    dataTransmitter = new DataTransmitter(mqttManager);
     sessionManager.setDeviceId(networkManager.getDeviceId());
 
+    // Commands only get queued in the callback; the command task runs them
+    registerCommands();
+    if (!commands.begin())
+        Serial.println("WARNING: Command task unavailable - commands run inside the MQTT callback");
     mqttManager->setCallback([](char *topic, byte *payload, unsigned int length)
-                             {
-        char message[length + 1];
-        memcpy(message, payload, length);
-        message[length] = '\0';
-
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, message);
+                             { commands.submit(payload, length); });
 
-        if (!error) {
-            String command = doc["command"].as<String>();
-            handleCommand(command, &doc);
-        } });
-
-    // Fetch cloud config so sensors get initialized with the right settings
-    Serial.println("Fetching sensor config from cloud...");
-    display.updateInitStage(INIT_COMPLETE, "Loading config...");
-    bool cloudConfigLoaded = fetchConfigFromCloud();
-    if (cloudConfigLoaded)
+    display.updateInitStage(INIT_SENSORS, "Loading config...");
+    if (loadCachedConfig())
     {
-        Serial.println("Cloud config loaded — sensors will init with cloud settings");
+        Serial.println("Cached config loaded — sensors will init with it, cloud refresh follows");
     }
     else
     {
-        Serial.println("WARNING: Cloud config unavailable, sensors will use defaults");
+        Serial.println("WARNING: No cached config, sensors will use defaults until the cloud config arrives");
     }
 
     Serial.printf("\n[Config] Detection mode: %s (useMLDetection=%d)\n",
-                  useMLDetection ? "ML" : "heuristic", useMLDetection);
+                  detectionModeName(), useMLDetection);
 
-    // --- Phase 2: Sensors (one-shot init with final config) ---
+    // --- Phase 2: Sensors (one-shot init with cached config) ---
 
     Serial.println("Initializing sensors...");
     display.updateInitStage(INIT_SENSORS, "Initializing sensors...");
-    if (!sensorManager.init(&currentConfig))
+    if (!sensorManager.init(limitedSensorConfig()))
     {
         Serial.println("ERROR: Sensor initialization failed!");
         display.setInitError("Sensor init failed!");
@@ -466,25 +692,36 @@ void initializeSystem()
     }
     Serial.println("Sensors initialized successfully");
 
+    // Stored calibration: wizard result into deviceCalibration, PS_CANC
+    // written back without sampling (if measured with these settings)
+    if (calibrationStore.begin())
+        calibrationStore.restoreCancellation(sensorManager, calibrationSettings());
+
     // CalibrationManager (just GPIO setup, no delay)
     Serial.println("Initializing CalibrationManager...");
-    if (!calibrationManager.begin(&sensorManager, &display))
+    if (!calibrationManager.begin(&sensorManager, &display, &calibrationStore))
     {
         Serial.println("WARNING: CalibrationManager init failed");
     }
     else
     {
+        // Parallel calibration drains the sensor task's frames from here
+        calibrationManager.setFrameRing(sessionManager.getFrameRing());
         Serial.println("CalibrationManager initialized");
     }
 
     // --- Phase 3: Detection & output ---
 
-    if (useMLDetection)
+    // Both detectors are loaded at boot with DETECTION_WARM_STANDBY, so a
+    // later detection_mode switch neither allocates the arena nor waits
+    // for a baseline
+    if (useMLDetection || DETECTION_WARM_STANDBY)
     {
         Serial.println("\n=== Initializing ML Detector ===");
         if (!mlDetector.init())
         {
-            Serial.println("WARNING: ML detector initialization failed, falling back to heuristic");
+            Serial.printf("WARNING: ML detector initialization failed%s\n",
+                          useMLDetection ? ", falling back to heuristic" : "");
             useMLDetection = false;
         }
         else
@@ -493,10 +730,43 @@ void initializeSystem()
         }
     }
 
+    if (lanStream.begin())
+        lanStream.setEnabled(currentConfig.lan_stream, currentConfig.lan_stream_frames);
+    else
+        Serial.println("WARNING: LAN stream unavailable");
+
+    // SNTP runs from here on; the array task only once array_role is set
+    TimeSync::begin();
+    if (hoopArray.begin(&lanStream))
+        hoopArray.setRole(HoopArray::parseRole(currentConfig.array_role));
+    else
+        Serial.println("WARNING: Hoop array unavailable");
+
+    detectionTask.setRateScheduler(&rateScheduler);
+    detectionTask.setEventStream(&lanStream);
+    autoCalibrator.begin(&sensorManager);
+    detectionTask.setAutoCalibrator(&autoCalibrator);
+    if (detectionTask.begin(&directionDetector, &mlDetector))
+    {
+        sensorManager.setFrameTap(detectionTask.getFrameRing(), detectionTask.getTaskHandle());
+        sensorManager.setRateScheduler(&rateScheduler);
+    }
+    else
+    {
+        Serial.println("WARNING: DetectionTask unavailable - Play/Live Debug detection disabled");
+    }
+    stageDetectorSetup();
+    {
+        // Ready from the first frame when baselines are stored
+        DetectionTask::Guard guard(detectionTask);
+        resetDirectionDetector();
+    }
+
     serialStudioOutput.begin(&sessionManager.getDataBuffer(), &directionDetector);
     serialStudioOutput.setConfig(&currentConfig);
     serialStudioOutput.setEnabled(serialStudioEnabled);
-    Serial.printf("Serial Studio output: %s\n", serialStudioEnabled ? "enabled" : "disabled");
+    Serial.printf("Serial Studio output: %s (%s)\n", serialStudioEnabled ? "enabled" : "disabled",
+                  serialStudioOutput.getFormat() == SerialStudioFormat::BINARY ? "binary" : "csv");
 
     // --- Power Monitor ---
     if (powerMonitor.init())
@@ -504,854 +774,1617 @@ void initializeSystem()
         Serial.println("INA219 power monitor ready on VSYS rail");
     }
 
+    // --- Network: WiFi, MQTT and the config refresh, in the background ---
+    // The supervisor starts the association right away. Once online, loop()
+    // starts the cloud config fetch (after the MQTT handshake, so the two TLS
+    // sessions are not set up at the same time).
+    connectionSupervisor.subscribe([](ConnectionState state, void *)
+                                   {
+        connectionStateChanged = true;
+        if (state == ConnectionState::ONLINE)
+        {
+            configRefreshDue = true;
+            otaUpdater.confirmBoot();
+        } });
+    if (!connectionSupervisor.begin(&networkManager, mqttManager))
+    {
+        // Without the supervisor, connect as before (blocking)
+        Serial.println("WARNING: Connection supervisor unavailable - connecting inline");
+        if (networkManager.connectWiFi())
+        {
+            if (!mqttManager->connect())
+                Serial.println("WARNING: MQTT connection failed");
+            configRefreshDue = true;
+        }
+    }
+
     // --- Done ---
 
     Serial.println("\n=== System Initialization Complete ===\n");
     MemoryMonitor::printMemoryStats();
 
     display.updateInitStage(INIT_COMPLETE, "System ready!");
-    delay(500);
 
     display.setSensorConfig(&currentConfig);
     display.setDetectionConfig(detectorConfig.peakMultiplier, detectorConfig.minRise,
                                detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow);
     display.showSessionScreen();
+
+    // From here on display and LEDs are driven through the UI task
+    if (!ui.begin(&display, &ledController))
+        Serial.println("WARNING: UI task unavailable - rendering inline");
     systemInitialized = true;
+    Serial.printf("Ready %lu ms after power-on (network %s)\n", millis(),
+                  ConnectionSupervisor::stateName(connectionSupervisor.getState()));
 }
 
-void handleCommand(const String &command, JsonDocument *doc)
+void commandPing(JsonDocument *doc)
 {
-    Serial.print("Received command: ");
-    Serial.println(command);
+    statusPublisher.post("pong");
+    ui.showMessage("Ping received", TFT_YELLOW);
+    ui.hold(1000);
+    ui.setDisplayState(DISPLAY_IDLE);
+}
 
-    if (command == "ping")
+void commandStartCollection(JsonDocument *doc)
+{
+    // The new session replaces a stopped one still waiting for an upload retry
+    sessionUploadRetryAt = 0;
+    if (sessionManager.getState() == UPLOADING)
     {
-        mqttManager->publishStatus("pong");
-        display.showMessage("Ping received", TFT_YELLOW);
-        delay(1000);
-        display.setDisplayState(DISPLAY_IDLE);
+        Serial.println("Dropping the stopped session awaiting upload retry");
+        sessionManager.clearBuffer();
     }
-    else if (command == "start_collection")
+
+    // Check memory health before starting any collection
+    MemoryMonitor::printMemoryStats();
+    if (!MemoryMonitor::isMemoryHealthy())
     {
-        // Check memory health before starting any collection
-        MemoryMonitor::printMemoryStats();
-        if (!MemoryMonitor::isMemoryHealthy())
-        {
-            Serial.println("ERROR: Insufficient memory to start collection!");
-            mqttManager->publishStatus("collection_failed_low_memory");
-            display.showMessage("Low memory!", TFT_RED);
-            delay(2000);
-            display.setDisplayState(DISPLAY_ERROR);
-            return;
-        }
+        Serial.println("ERROR: Insufficient memory to start collection!");
+        statusPublisher.post("collection_failed_low_memory");
+        ui.showMessage("Low memory!", TFT_RED);
+        ui.hold(2000);
+        ui.setDisplayState(DISPLAY_ERROR);
+        return;
+    }
 
-        // Determine sensor mode from config (how we sense)
-        bool useInterruptMode = (currentConfig.sensor_mode == SensorMode::INTERRUPT_MODE);
+    // Determine sensor mode from config (how we sense)
+    bool useInterruptMode = (currentConfig.sensor_mode == SensorMode::INTERRUPT_MODE);
 
-        const char *modeLabel = currentMode == DeviceMode::PLAY ? "PLAY" : currentMode == DeviceMode::LIVE_DEBUG ? "LIVE_DEBUG"
-                                                                                                                 : "DEBUG";
-        Serial.printf("Starting collection - Mode: %s, Sensor: %s\n",
-                      modeLabel,
-                      useInterruptMode ? "INTERRUPT" : "POLLING");
+    const char *modeLabel = currentMode == DeviceMode::PLAY ? "PLAY" : currentMode == DeviceMode::LIVE_DEBUG ? "LIVE_DEBUG"
+                                                                                                             : "DEBUG";
+    // Hybrid runs through the polling path: SensorManager idles on the
+    // INT lines itself and bursts into the same frame ring
+    Serial.printf("Starting collection - Mode: %s, Sensor: %s\n",
+                  modeLabel,
+                  useInterruptMode                                       ? "INTERRUPT"
+                  : currentConfig.sensor_mode == SensorMode::HYBRID_MODE ? "HYBRID"
+                                                                         : "POLLING");
 
-        if (useInterruptMode)
+    if (useInterruptMode)
+    {
+        // === INTERRUPT-BASED SENSING ===
+        // Initialize InterruptManager if not already done
+        if (!interruptManager.isMonitoring())
         {
-            // === INTERRUPT-BASED SENSING ===
-            // Initialize InterruptManager if not already done
-            if (!interruptManager.isMonitoring())
-            {
-                Serial.println("Initializing InterruptManager...");
-                if (!interruptManager.begin())
-                {
-                    Serial.println("ERROR: InterruptManager initialization failed!");
-                    mqttManager->publishStatus("interrupt_init_failed");
-                    display.showMessage("INT init failed!", TFT_RED);
-                    delay(2000);
-                    display.setDisplayState(DISPLAY_ERROR);
-                    return;
-                }
-
-                // Configure for detection using current config
-                // Uses calibration-based approach: baseline measured at startup, thresholds relative to 0
-                InterruptConfig intConfig;
-                intConfig.thresholdMargin = currentConfig.interrupt_threshold_margin;
-                intConfig.hysteresis = currentConfig.interrupt_hysteresis;
-                intConfig.persistence = currentConfig.interrupt_persistence;
-                intConfig.smartPersistence = currentConfig.interrupt_smart_persistence;
-                intConfig.mode = (currentConfig.interrupt_mode == "logic")
-                                     ? InterruptMode::LOGIC_OUTPUT
-                                     : InterruptMode::NORMAL;
-                intConfig.ledCurrent = currentConfig.led_current.toInt();
-                if (intConfig.ledCurrent == 0)
-                    intConfig.ledCurrent = 200;
-                intConfig.integrationTime = currentConfig.interrupt_integration_time;
-                intConfig.multiPulse = currentConfig.interrupt_multi_pulse;
-                intConfig.autoCalibrate = true; // Enable auto-calibration
-
-                Serial.printf("Interrupt config: margin=%d, hysteresis=%d, pers=%d, IT=%dT, mode=%s\n",
-                              intConfig.thresholdMargin, intConfig.hysteresis,
-                              intConfig.persistence, intConfig.integrationTime,
-                              intConfig.mode == InterruptMode::LOGIC_OUTPUT ? "logic" : "normal");
-
-                // Apply calibration data if available
-                if (deviceCalibration.isValid())
-                {
-                    interruptManager.setCalibration(&deviceCalibration);
-                    Serial.println("Calibration data applied to InterruptManager");
-                }
-                else
-                {
-                    interruptManager.setCalibration(nullptr);
-                    Serial.println("No calibration - InterruptManager using fallback thresholds");
-                }
-
-                if (!interruptManager.configure(intConfig))
-                {
-                    Serial.println("WARNING: Some sensors failed to configure for interrupt mode");
-                }
+            Serial.println("Initializing InterruptManager...");
+            if (!interruptManager.begin())
+            {
+                Serial.println("ERROR: InterruptManager initialization failed!");
+                statusPublisher.post("interrupt_init_failed");
+                ui.showMessage("INT init failed!", TFT_RED);
+                ui.hold(2000);
+                ui.setDisplayState(DISPLAY_ERROR);
+                return;
+            }
+
+            // Configure for detection using current config
+            // Uses calibration-based approach: baseline measured at startup, thresholds relative to 0
+            InterruptConfig intConfig;
+            intConfig.thresholdMargin = currentConfig.interrupt_threshold_margin;
+            intConfig.hysteresis = currentConfig.interrupt_hysteresis;
+            intConfig.persistence = currentConfig.interrupt_persistence;
+            intConfig.smartPersistence = currentConfig.interrupt_smart_persistence;
+            intConfig.mode = (currentConfig.interrupt_mode == "logic")
+                                 ? InterruptMode::LOGIC_OUTPUT
+                                 : InterruptMode::NORMAL;
+            intConfig.ledCurrent = currentConfig.led_current.toInt();
+            if (intConfig.ledCurrent == 0)
+                intConfig.ledCurrent = 200;
+            intConfig.integrationTime = currentConfig.interrupt_integration_time;
+            intConfig.multiPulse = currentConfig.interrupt_multi_pulse;
+            intConfig.autoCalibrate = true; // Enable auto-calibration
+
+            Serial.printf("Interrupt config: margin=%d, hysteresis=%d, pers=%d, IT=%dT, mode=%s\n",
+                          intConfig.thresholdMargin, intConfig.hysteresis,
+                          intConfig.persistence, intConfig.integrationTime,
+                          intConfig.mode == InterruptMode::LOGIC_OUTPUT ? "logic" : "normal");
+
+            // Apply calibration data if available
+            if (deviceCalibration.isValid())
+            {
+                interruptManager.setCalibration(&deviceCalibration);
+                Serial.println("Calibration data applied to InterruptManager");
             }
-
-            // Start interrupt session
-            sessionManager.setSessionType(SessionType::INTERRUPT_BASED);
-            if (sessionManager.startSession())
+            else
             {
-                if (!interruptManager.startMonitoring())
-                {
-                    Serial.println("ERROR: Failed to start interrupt monitoring!");
-                    sessionManager.clearBuffer();
-                    mqttManager->publishStatus("interrupt_start_failed");
-                    display.setDisplayState(DISPLAY_ERROR);
-                    return;
-                }
-
-                if (currentMode == DeviceMode::PLAY)
-                {
-                    // Initialize LED controller for play mode
-                    if (!ledController.init())
-                    {
-                        Serial.println("WARNING: LED controller init failed");
-                    }
-                    directionDetector.reset();
-                    playModeActive = true;
-                    lastDetectionTime = 0;
-                    ledController.showReady();
-
-                    mqttManager->publishStatus("play_started_interrupt");
-                    display.showMessage("PLAY [INT]", TFT_GREEN);
-                }
-                else
-                {
-                    mqttManager->publishStatus("collection_started_interrupt");
-                    display.showMessage("DEBUG [INT]", TFT_CYAN);
-                }
-                display.setDisplayState(DISPLAY_RECORDING);
+                interruptManager.setCalibration(nullptr);
+                Serial.println("No calibration - InterruptManager using fallback thresholds");
             }
-            else
+
+            if (!interruptManager.configure(intConfig))
             {
-                mqttManager->publishStatus("collection_failed");
-                display.setDisplayState(DISPLAY_ERROR);
+                Serial.println("WARNING: Some sensors failed to configure for interrupt mode");
             }
+            sensorManager.forgetRegisters(); // Interrupt config wrote its own LED current / IT
         }
-        else
+
+        // Start interrupt session
+        sessionManager.setSessionType(SessionType::INTERRUPT_BASED);
+        if (sessionManager.startSession())
         {
-            // === POLLING-BASED SENSING ===
-            sessionManager.setSessionType(SessionType::PROXIMITY);
-            if (sessionManager.startSession())
+            if (!interruptManager.startMonitoring())
             {
-                std::vector<SensorMetadata> metadata = sensorManager.getSensorMetadata();
-                sessionManager.setSensorMetadata(metadata);
+                Serial.println("ERROR: Failed to start interrupt monitoring!");
+                sessionManager.clearBuffer();
+                statusPublisher.post("interrupt_start_failed");
+                ui.setDisplayState(DISPLAY_ERROR);
+                return;
+            }
 
-                sensorManager.startCollection(sessionManager.getQueue(), &sessionManager.getSessionSummary());
+            if (currentMode == DeviceMode::PLAY)
+            {
+                // Initialize LED controller for play mode
+                ui.initLeds();
+                detectionTask.resetDetectors();
+                playModeActive = true;
+                lastDetectionTime = 0;
 
-                if (currentMode == DeviceMode::PLAY)
-                {
-                    // Initialize LED controller for play mode
-                    if (!ledController.init())
-                    {
-                        Serial.println("WARNING: LED controller init failed");
-                    }
-                    directionDetector.reset();
-                    playModeActive = true;
-                    lastDetectionTime = 0;
-                    ledController.showReady();
-
-                    mqttManager->publishStatus("play_started");
-                    display.showMessage("PLAY MODE", TFT_GREEN);
-                }
-                else if (currentMode == DeviceMode::LIVE_DEBUG)
-                {
-                    // Initialize LED controller and detector for live debug
-                    if (!ledController.init())
-                    {
-                        Serial.println("WARNING: LED controller init failed");
-                    }
-                    directionDetector.reset();
-                    liveDebugActive = true;
-                    lastDetectionTime = 0;
-                    ledController.showReady();
-
-                    mqttManager->publishStatus("live_debug_started");
-                    display.showMessage("LIVE DEBUG", TFT_MAGENTA);
-                }
-                else
-                {
-                    mqttManager->publishStatus("collection_started");
-                    display.showMessage("DEBUG MODE", TFT_BLUE);
-                }
-                display.setDisplayState(DISPLAY_RECORDING);
+                statusPublisher.post("play_started_interrupt");
+                ui.showMessage("PLAY [INT]", TFT_GREEN);
             }
             else
             {
-                mqttManager->publishStatus("collection_failed");
-                display.setDisplayState(DISPLAY_ERROR);
+                statusPublisher.post("collection_started_interrupt");
+                ui.showMessage("DEBUG [INT]", TFT_CYAN);
             }
-        }
-    }
-    else if (command == "stop_collection")
-    {
-        // Check session type to determine how to stop
-        bool wasInterruptSession = (sessionManager.getSessionType() == SessionType::INTERRUPT_BASED);
-        bool isPlayMode = (currentMode == DeviceMode::PLAY);
-        bool isLiveDebugMode = (currentMode == DeviceMode::LIVE_DEBUG);
-
-        const char *stopModeLabel = isPlayMode ? "PLAY" : isLiveDebugMode ? "LIVE_DEBUG"
-                                                                          : "DEBUG";
-        Serial.printf("Stopping collection - Mode: %s, Session: %s\n",
-                      stopModeLabel,
-                      wasInterruptSession ? "INTERRUPT" : "POLLING");
-
-        // Stop the appropriate sensor system
-        if (wasInterruptSession)
-        {
-            interruptManager.stopMonitoring();
-            Serial.printf("Collected %d interrupt events\n", sessionManager.getInterruptEventCount());
-            InterruptSessionStats stats = interruptManager.getStats();
-            Serial.printf("  ISR count: %lu, dropped: %lu\n", stats.isrCount, stats.droppedEvents);
+            ui.setDisplayState(DISPLAY_RECORDING);
         }
         else
         {
-            sensorManager.stopCollection();
-            Serial.printf("Collected %d samples\n", sessionManager.getDataCount());
+            statusPublisher.post("collection_failed");
+            ui.setDisplayState(DISPLAY_ERROR);
         }
+    }
+    else
+    {
+        // === POLLING-BASED SENSING ===
+        sessionManager.setSessionType(SessionType::PROXIMITY);
+        sessionManager.setSpill(currentMode == DeviceMode::DEBUG && currentConfig.spill_to_flash ? &sessionSpill : nullptr);
+        if (sessionManager.startSession())
+        {
+            std::vector<SensorMetadata> metadata = sensorManager.getSensorMetadata();
+            sessionManager.setSensorMetadata(metadata);
 
-        sessionManager.stopSession();
-        MemoryMonitor::printMemoryStats();
+            sensorManager.startCollection(sessionManager.getFrameRing(), &sessionManager.getSessionSummary());
 
-        if (isPlayMode && playModeActive)
-        {
-            // PLAY MODE: Just stop detection, no upload needed
-            sessionManager.clearBuffer();
-            playModeActive = false;
-            directionDetector.reset();
-            ledController.off();
+            if (currentMode == DeviceMode::PLAY)
+            {
+                // Initialize LED controller for play mode
+                ui.initLeds();
+                detectionTask.resetDetectors();
 
-            mqttManager->publishStatus("play_stopped");
-            display.showMessage("Play mode stopped", TFT_YELLOW);
-            delay(1500);
-            display.setDisplayState(DISPLAY_IDLE);
-        }
-        else if (currentMode == DeviceMode::LIVE_DEBUG && liveDebugActive)
-        {
-            // LIVE DEBUG MODE: Just stop listening, no bulk upload
-            // Individual captures were already uploaded during the session
-            sessionManager.clearBuffer();
-            liveDebugActive = false;
-            directionDetector.reset();
-            ledController.off();
+                // Frames stream through a fixed ring: no buffer growth, no flush
+                playStream.clear();
+                sessionManager.setCaptureRing(&playStream);
+                serialStudioOutput.setCaptureSource(&playStream);
 
-            mqttManager->publishStatus("live_debug_stopped");
-            display.showMessage("Live Debug stopped", TFT_YELLOW);
-            delay(1500);
-            display.setDisplayState(DISPLAY_IDLE);
-        }
-        else
-        {
-            // DEBUG MODE: Upload data
-            display.setDisplayState(DISPLAY_UPLOADING);
+                playModeActive = true;
+                lastDetectionTime = 0;
 
-            // Session Confirmation: finalize counters and set summary on transmitter
-            uint8_t activeSensorCount = 0;
-            for (const auto &m : sessionManager.getSensorMetadata())
-            {
-                if (m.active)
-                    activeSensorCount++;
+                statusPublisher.post("play_started");
+                ui.showMessage("PLAY MODE", TFT_GREEN);
             }
-            sessionManager.finalizeSessionSummary(&currentConfig, activeSensorCount);
-            dataTransmitter->setSessionSummary(&sessionManager.getSessionSummary());
-
-            if (dataTransmitter->transmitSession(sessionManager, &currentConfig))
+            else if (currentMode == DeviceMode::LIVE_DEBUG)
             {
-                // Session Confirmation: send pipeline integrity summary
-                dataTransmitter->transmitSessionSummary(
-                    sessionManager.getSessionSummary(),
-                    sessionManager.getSessionId(),
-                    mqttManager->getDeviceId());
-
-                mqttManager->publishStatus("upload_complete");
-                display.setDisplayState(DISPLAY_SUCCESS);
-                delay(3000);
-                dataTransmitter->setSessionSummary(nullptr);
-                sessionManager.clearBuffer();
-                display.setDisplayState(DISPLAY_IDLE);
+                // Initialize LED controller and detector for live debug
+                ui.initLeds();
+                detectionTask.resetDetectors();
+
+                // Frames go to the live capture ring from the first drain on
+                CaptureRing *ring = captureUploader.beginLive();
+                if (ring == nullptr)
+                    Serial.println("WARNING: No free capture slot - Live Debug captures unavailable");
+                sessionManager.setCaptureRing(ring);
+                serialStudioOutput.setCaptureSource(ring);
+
+                liveDebugActive = true;
+                liveDebugCapturePending = false;
+                lastDetectionTime = 0;
+
+                statusPublisher.post("live_debug_started");
+                ui.showMessage("LIVE DEBUG", TFT_MAGENTA);
             }
             else
             {
-                Serial.println("ERROR: Session transmission failed!");
-                mqttManager->publishStatus("upload_failed");
-                display.setDisplayState(DISPLAY_ERROR);
-                display.showMessage("Upload failed!", TFT_RED);
-                delay(3000);
-                dataTransmitter->setSessionSummary(nullptr);
-                sessionManager.clearBuffer();
-                display.setDisplayState(DISPLAY_IDLE);
+                statusPublisher.post("collection_started");
+                ui.showMessage("DEBUG MODE", TFT_BLUE);
             }
+            ui.setDisplayState(DISPLAY_RECORDING);
         }
-    }
-    else if (command == "configure_sensors")
-    {
-        Serial.println("[Config] Received configure_sensors command");
-        // Log raw payload keys for debugging
-        if (doc != nullptr)
+        else
         {
-            Serial.print("[Config] Top-level keys: ");
-            for (JsonPair kv : doc->as<JsonObject>())
+            statusPublisher.post("collection_failed");
+            ui.setDisplayState(DISPLAY_ERROR);
+        }
+    }
+}
+
+void commandStopCollection(JsonDocument *doc)
+{
+    // Check session type to determine how to stop
+    bool wasInterruptSession = (sessionManager.getSessionType() == SessionType::INTERRUPT_BASED);
+    bool isPlayMode = (currentMode == DeviceMode::PLAY);
+    bool isLiveDebugMode = (currentMode == DeviceMode::LIVE_DEBUG);
+
+    const char *stopModeLabel = isPlayMode ? "PLAY" : isLiveDebugMode ? "LIVE_DEBUG"
+                                                                      : "DEBUG";
+    Serial.printf("Stopping collection - Mode: %s, Session: %s\n",
+                  stopModeLabel,
+                  wasInterruptSession ? "INTERRUPT" : "POLLING");
+
+    // Stop the appropriate sensor system
+    if (wasInterruptSession)
+    {
+        interruptManager.stopMonitoring();
+        Serial.printf("Collected %d interrupt events\n", sessionManager.getInterruptEventCount());
+        InterruptSessionStats stats = interruptManager.getStats();
+        Serial.printf("  ISR count: %lu, dropped: %lu, Wire fallbacks: %lu\n",
+                      stats.isrCount, stats.droppedEvents, stats.wireFallbacks);
+    }
+    else
+    {
+        sensorManager.stopCollection();
+        Serial.printf("Collected %d samples\n", sessionManager.getReadingCount());
+    }
+
+    sessionManager.stopSession();
+    MemoryMonitor::printMemoryStats();
+
+    // Play / Live Debug: back to the session buffer; the live capture
+    // slot is returned (frozen captures keep uploading)
+    sessionManager.setCaptureRing(nullptr);
+    serialStudioOutput.setCaptureSource(nullptr);
+    captureUploader.endLive();
+
+    if (isPlayMode && playModeActive)
+    {
+        // PLAY MODE: Just stop detection, no upload needed
+        sessionManager.clearBuffer();
+        playModeActive = false;
+        detectionTask.resetDetectors();
+        ui.ledsOff();
+
+        statusPublisher.post("play_stopped");
+        ui.showMessage("Play mode stopped", TFT_YELLOW);
+        ui.hold(1500);
+        ui.setDisplayState(DISPLAY_IDLE);
+    }
+    else if (currentMode == DeviceMode::LIVE_DEBUG && liveDebugActive)
+    {
+        // LIVE DEBUG MODE: Just stop listening, no bulk upload
+        // Individual captures were already queued during the session;
+        // any still in the upload task finish in the background
+        sessionManager.clearBuffer();
+        liveDebugActive = false;
+        liveDebugCapturePending = false;
+        detectionTask.resetDetectors();
+        ui.ledsOff();
+
+        statusPublisher.post("live_debug_stopped");
+        ui.showMessage("Live Debug stopped", TFT_YELLOW);
+        ui.hold(1500);
+        ui.setDisplayState(DISPLAY_IDLE);
+    }
+    else
+    {
+        // DEBUG MODE: Upload data (already on the command task)
+        finalizeDebugSession();
+        sessionUploadStatus = "upload_complete";
+        sessionUploadAttempts = 0;
+        uploadDebugSession();
+    }
+}
+
+// Session Confirmation: finalize counters once the session has stopped
+void finalizeDebugSession()
+{
+    uint8_t activeSensorCount = 0;
+    for (const auto &m : sessionManager.getSensorMetadata())
+    {
+        if (m.active)
+            activeSensorCount++;
+    }
+    sessionManager.finalizeSessionSummary(&currentConfig, activeSensorCount);
+}
+
+// Uploads the stopped session with its summary. On failure the session stays
+// in the buffer / spill file and loopStep() queues another attempt; after
+// SESSION_UPLOAD_ATTEMPTS it is dropped (a spill file stays for fetch_range)
+void uploadDebugSession()
+{
+    sessionUploadRetryAt = 0;
+    sessionUploadAttempts++;
+    ui.setDisplayState(DISPLAY_UPLOADING);
+
+    // The transmitted counters describe this attempt only
+    SessionSummary &summary = sessionManager.getSessionSummary();
+    summary.total_readings_transmitted = 0;
+    summary.total_batches_transmitted = 0;
+    dataTransmitter->setSessionSummary(&summary);
+
+    bool sent = dataTransmitter->transmitSession(sessionManager, &currentConfig);
+    if (sent)
+    {
+        // Session Confirmation: send pipeline integrity summary
+        dataTransmitter->transmitSessionSummary(summary, sessionManager.getSessionId(),
+                                                mqttManager->getDeviceId());
+    }
+    dataTransmitter->setSessionSummary(nullptr);
+
+    if (sent)
+    {
+        sessionUploadAttempts = 0;
+        statusPublisher.post(sessionUploadStatus);
+        ui.setDisplayState(DISPLAY_SUCCESS);
+        ui.hold(2000);
+        sessionManager.clearBuffer();
+        ui.setDisplayState(DISPLAY_IDLE);
+        return;
+    }
+
+    bool retry = sessionUploadAttempts < SESSION_UPLOAD_ATTEMPTS;
+    Serial.printf("ERROR: Session transmission failed (attempt %u/%u)%s\n", sessionUploadAttempts,
+                  SESSION_UPLOAD_ATTEMPTS, retry ? " - retrying" : "");
+    if (retry)
+        sessionUploadRetryAt = (millis() + SESSION_UPLOAD_RETRY_MS) | 1;
+    statusPublisher.post("upload_failed", addSessionUpload);
+    ui.setDisplayState(DISPLAY_ERROR);
+    ui.showMessage(retry ? "Upload failed - retrying" : "Upload failed!", TFT_RED);
+    ui.hold(2000);
+    if (!retry)
+        sessionManager.clearBuffer();
+    ui.setDisplayState(DISPLAY_IDLE);
+}
+
+// Auto-stop (loopStep): the upload runs on the command task, not in loop()
+void queueSessionUpload(const char *successStatus)
+{
+    sessionUploadStatus = successStatus;
+    sessionUploadAttempts = 0;
+    submitSessionUpload();
+}
+
+void submitSessionUpload()
+{
+    static const char payload[] = "{\"command\":\"upload_session\"}";
+    sessionUploadRetryAt = 0;
+    if (!commands.submit((const uint8_t *)payload, sizeof(payload) - 1))
+        sessionUploadRetryAt = (millis() + SESSION_UPLOAD_RETRY_MS) | 1; // Queue full: later
+}
+
+void addSessionUpload(JsonDocument &details)
+{
+    details["upload_attempt"] = sessionUploadAttempts;
+    details["upload_attempts_max"] = SESSION_UPLOAD_ATTEMPTS;
+    details["upload_retry"] = sessionUploadRetryAt != 0;
+}
+
+void commandUploadSession(JsonDocument *doc)
+{
+    // Only a stopped session: a new one may have replaced it meanwhile
+    if (sessionManager.getState() != UPLOADING)
+    {
+        sessionUploadRetryAt = 0;
+        Serial.println("upload_session: no stopped session to upload");
+        return;
+    }
+    uploadDebugSession();
+}
+
+void commandConfigureSensors(JsonDocument *doc)
+{
+    Serial.println("[Config] Received configure_sensors command");
+    // Log raw payload keys for debugging
+    if (doc != nullptr)
+    {
+        Serial.print("[Config] Top-level keys: ");
+        for (JsonPair kv : doc->as<JsonObject>())
+        {
+            Serial.printf("%s ", kv.key().c_str());
+        }
+        Serial.println();
+        if (doc->containsKey("sensor_config"))
+        {
+            JsonObject sc = (*doc)["sensor_config"];
+            Serial.print("[Config] sensor_config keys: ");
+            for (JsonPair kv : sc)
             {
                 Serial.printf("%s ", kv.key().c_str());
             }
             Serial.println();
-            if (doc->containsKey("sensor_config"))
+            if (sc.containsKey("detection_mode"))
             {
-                JsonObject sc = (*doc)["sensor_config"];
-                Serial.print("[Config] sensor_config keys: ");
-                for (JsonPair kv : sc)
-                {
-                    Serial.printf("%s ", kv.key().c_str());
-                }
-                Serial.println();
-                if (sc.containsKey("detection_mode"))
-                {
-                    Serial.printf("[Config] detection_mode value: '%s'\n", sc["detection_mode"].as<const char *>());
-                }
-                else
-                {
-                    Serial.println("[Config] detection_mode NOT found in sensor_config");
-                }
+                Serial.printf("[Config] detection_mode value: '%s'\n", sc["detection_mode"].as<const char *>());
             }
             else
             {
-                Serial.println("[Config] sensor_config key NOT found in payload");
+                Serial.println("[Config] detection_mode NOT found in sensor_config");
             }
         }
-        display.showMessage("Configuring sensors...", TFT_CYAN);
+        else
+        {
+            Serial.println("[Config] sensor_config key NOT found in payload");
+        }
+    }
+    ui.showMessage("Configuring sensors...", TFT_CYAN);
+
+    if (doc != nullptr && doc->containsKey("sensor_config"))
+    {
+        JsonObject config = (*doc)["sensor_config"];
+
+        // Update current configuration
+        // Handle both sample_rate and sample_rate_hz for compatibility
+        if (config.containsKey("sample_rate_hz"))
+        {
+            currentConfig.sample_rate_hz = config["sample_rate_hz"];
+        }
+        else if (config.containsKey("sample_rate"))
+        {
+            currentConfig.sample_rate_hz = config["sample_rate"];
+        }
+        else
+        {
+            currentConfig.sample_rate_hz = 1000; // Default
+        }
 
-        if (doc != nullptr && doc->containsKey("sensor_config"))
+        currentConfig.led_current = config["led_current"] | "200mA";
+        currentConfig.integration_time = config["integration_time"] | "1T";
+        currentConfig.duty_cycle = config["duty_cycle"] | "1/40"; // CRITICAL: Was missing!
+        currentConfig.high_resolution = config["high_resolution"] | true;
+        currentConfig.read_ambient = config["read_ambient"] | true;
+        currentConfig.active_force = config["active_force"] | false;
+        currentConfig.skew_compensation = config["skew_compensation"] | false;
+        currentConfig.duplicate_mode = config["duplicate_mode"] | "off";
+
+        // Handle I2C clock speed if provided
+        if (config.containsKey("i2c_clock_khz"))
         {
-            JsonObject config = (*doc)["sensor_config"];
+            currentConfig.i2c_clock_khz = config["i2c_clock_khz"];
+        }
 
-            // Update current configuration
-            // Handle both sample_rate and sample_rate_hz for compatibility
-            if (config.containsKey("sample_rate_hz"))
-            {
-                currentConfig.sample_rate_hz = config["sample_rate_hz"];
-            }
-            else if (config.containsKey("sample_rate"))
-            {
-                currentConfig.sample_rate_hz = config["sample_rate"];
-            }
-            else
-            {
-                currentConfig.sample_rate_hz = 1000; // Default
-            }
+        // Handle multi-pulse mode if provided
+        if (config.containsKey("multi_pulse"))
+        {
+            currentConfig.multi_pulse = config["multi_pulse"].as<String>();
+        }
+        else
+        {
+            currentConfig.multi_pulse = "1"; // Default: 1 pulse
+        }
 
-            currentConfig.led_current = config["led_current"] | "200mA";
-            currentConfig.integration_time = config["integration_time"] | "1T";
-            currentConfig.duty_cycle = config["duty_cycle"] | "1/40"; // CRITICAL: Was missing!
-            currentConfig.high_resolution = config["high_resolution"] | true;
-            currentConfig.read_ambient = config["read_ambient"] | true;
+        // Physical geometry for transit speed estimation
+        if (config.containsKey("ball_diameter_mm"))
+            currentConfig.ball_diameter_mm = config["ball_diameter_mm"];
+        if (config.containsKey("hoop_inner_diameter_mm"))
+            currentConfig.hoop_inner_diameter_mm = config["hoop_inner_diameter_mm"];
 
-            // Handle I2C clock speed if provided
-            if (config.containsKey("i2c_clock_khz"))
+        // Handle sensor_mode (polling vs interrupt)
+        if (config.containsKey("sensor_mode"))
+        {
+            String modeStr = config["sensor_mode"].as<String>();
+            if (modeStr == "interrupt")
             {
-                currentConfig.i2c_clock_khz = config["i2c_clock_khz"];
+                currentConfig.sensor_mode = SensorMode::INTERRUPT_MODE;
+                Serial.println("  Sensor mode: INTERRUPT");
             }
-
-            // Handle multi-pulse mode if provided
-            if (config.containsKey("multi_pulse"))
+            else if (modeStr == "hybrid")
             {
-                currentConfig.multi_pulse = config["multi_pulse"].as<String>();
+                currentConfig.sensor_mode = SensorMode::HYBRID_MODE;
+                Serial.println("  Sensor mode: HYBRID");
             }
             else
             {
-                currentConfig.multi_pulse = "1"; // Default: 1 pulse
+                currentConfig.sensor_mode = SensorMode::POLLING_MODE;
+                Serial.println("  Sensor mode: POLLING");
             }
+        }
+        applyHybridConfig(config);
+        applyAdaptiveRateConfig(config);
+        applyPowerConfig(config);
 
-            // Physical geometry for transit speed estimation
-            if (config.containsKey("ball_diameter_mm"))
-                currentConfig.ball_diameter_mm = config["ball_diameter_mm"];
-            if (config.containsKey("hoop_inner_diameter_mm"))
-                currentConfig.hoop_inner_diameter_mm = config["hoop_inner_diameter_mm"];
-
-            // Handle sensor_mode (polling vs interrupt)
-            if (config.containsKey("sensor_mode"))
-            {
-                String modeStr = config["sensor_mode"].as<String>();
-                if (modeStr == "interrupt")
-                {
-                    currentConfig.sensor_mode = SensorMode::INTERRUPT_MODE;
-                    Serial.println("  Sensor mode: INTERRUPT");
-                }
-                else
+        // Handle interrupt configuration if provided (calibration-based)
+        if (config.containsKey("interrupt_threshold_margin"))
+        {
+            currentConfig.interrupt_threshold_margin = config["interrupt_threshold_margin"];
+        }
+        if (config.containsKey("interrupt_hysteresis"))
+        {
+            currentConfig.interrupt_hysteresis = config["interrupt_hysteresis"];
+        }
+        if (config.containsKey("interrupt_integration_time"))
+        {
+            currentConfig.interrupt_integration_time = config["interrupt_integration_time"];
+        }
+        if (config.containsKey("interrupt_multi_pulse"))
+        {
+            currentConfig.interrupt_multi_pulse = config["interrupt_multi_pulse"];
+        }
+        if (config.containsKey("interrupt_persistence"))
+        {
+            currentConfig.interrupt_persistence = config["interrupt_persistence"];
+        }
+        if (config.containsKey("interrupt_smart_persistence"))
+        {
+            currentConfig.interrupt_smart_persistence = config["interrupt_smart_persistence"];
+        }
+        if (config.containsKey("interrupt_mode"))
+        {
+            currentConfig.interrupt_mode = config["interrupt_mode"].as<String>();
+        }
+        if (config.containsKey("upload_format"))
+        {
+            currentConfig.upload_format = config["upload_format"].as<String>();
+        }
+        if (config.containsKey("capture_pre_trigger_ms"))
+            currentConfig.capture_pre_trigger_ms = config["capture_pre_trigger_ms"];
+        if (config.containsKey("capture_post_trigger_ms"))
+            currentConfig.capture_post_trigger_ms = config["capture_post_trigger_ms"];
+        if (config.containsKey("spill_to_flash"))
+            currentConfig.spill_to_flash = config["spill_to_flash"];
+        if (config.containsKey("lan_stream"))
+            currentConfig.lan_stream = config["lan_stream"];
+        if (config.containsKey("lan_stream_frames"))
+            currentConfig.lan_stream_frames = config["lan_stream_frames"];
+        if (config.containsKey("array_role"))
+            currentConfig.array_role = config["array_role"].as<String>();
+        if (config.containsKey("auto_calibration"))
+            currentConfig.auto_calibration = config["auto_calibration"];
+        autoCalibrator.setEnabled(currentConfig.auto_calibration);
+
+        // Handle detection_mode (heuristic vs ml)
+        if (config.containsKey("detection_mode"))
+        {
+            String detMode = config["detection_mode"].as<String>();
+            bool wasML = useMLDetection;
+            useMLDetection = (detMode == "ml" || detMode == "ml_sliding" || detMode == "ensemble");
+            mlSlidingInference = (detMode == "ml_sliding");
+            ensembleDetection = (detMode == "ensemble");
+            if (config.containsKey("ml_stride_ms"))
+            {
+                mlStrideMs = config["ml_stride_ms"];
+            }
+            applyEnsembleConfig(config);
+            // Preloaded at boot; loaded here only if that failed or standby is off
+            if (useMLDetection && !wasML && !mlDetector.hasModel())
+            {
+                Serial.println("  Initializing ML detector on config change...");
+                DetectionTask::Guard guard(detectionTask);
+                if (!mlDetector.init())
                 {
-                    currentConfig.sensor_mode = SensorMode::POLLING_MODE;
-                    Serial.println("  Sensor mode: POLLING");
+                    Serial.println("  ML detector init failed, staying on heuristic");
+                    useMLDetection = false;
                 }
             }
+            Serial.printf("  Detection Mode: %s\n", detectionModeName());
+        }
+
+        if (config.containsKey("serial_studio_enabled"))
+        {
+            serialStudioEnabled = config["serial_studio_enabled"].as<bool>();
+            serialStudioOutput.setEnabled(serialStudioEnabled);
+            Serial.printf("  Serial Studio: %s\n", serialStudioEnabled ? "enabled" : "disabled");
+        }
+        if (config.containsKey("serial_studio_format"))
+        {
+            String format = config["serial_studio_format"].as<String>();
+            serialStudioOutput.setFormat(format == "binary" ? SerialStudioFormat::BINARY : SerialStudioFormat::CSV);
+            Serial.printf("  Serial Studio Format: %s\n", format == "binary" ? "binary" : "csv");
+        }
+        if (config.containsKey("serial_studio_decimation"))
+        {
+            serialStudioOutput.setDecimation(config["serial_studio_decimation"].as<uint8_t>());
+            Serial.printf("  Serial Studio Decimation: every %d frame(s)\n", serialStudioOutput.getDecimation());
+        }
 
-            // Handle interrupt configuration if provided (calibration-based)
-            if (config.containsKey("interrupt_threshold_margin"))
+        // Detection algorithm parameters
+        if (config.containsKey("peak_multiplier"))
+            detectorConfig.peakMultiplier = config["peak_multiplier"].as<float>();
+        if (config.containsKey("min_rise"))
+            detectorConfig.minRise = config["min_rise"];
+        if (config.containsKey("min_wave_duration_ms"))
+            detectorConfig.minWaveDurationMs = config["min_wave_duration_ms"];
+        if (config.containsKey("smoothing_window"))
+            detectorConfig.smoothingWindow = config["smoothing_window"];
+        if (config.containsKey("multi_transit"))
+            detectorConfig.multiTransit = config["multi_transit"];
+        detectorConfig.skewCompensation = currentConfig.skew_compensation;
+
+        // With the ML inference mode, swapped in at the next detection cycle
+        stageDetectorSetup();
+
+        Serial.println("Configuration updated:");
+        Serial.printf("  Sample Rate: %d Hz\n", currentConfig.sample_rate_hz);
+        Serial.printf("  LED Current: %s\n", currentConfig.led_current.c_str());
+        Serial.printf("  Integration Time: %s\n", currentConfig.integration_time.c_str());
+        Serial.printf("  Duty Cycle: %s\n", currentConfig.duty_cycle.c_str());
+        Serial.printf("  Multi-Pulse: %s pulses\n", currentConfig.multi_pulse.c_str());
+        Serial.printf("  High Resolution: %s\n", currentConfig.high_resolution ? "enabled" : "disabled");
+        Serial.printf("  Read Ambient: %s\n", currentConfig.read_ambient ? "enabled" : "disabled");
+        Serial.printf("  Active Force: %s\n", currentConfig.active_force ? "enabled" : "disabled");
+        Serial.printf("  Skew Compensation: %s\n",
+                      !currentConfig.skew_compensation ? "disabled"
+                      : SENSOR_SKEW_OFFSETS            ? "enabled"
+                                                       : "enabled (cycle timestamps only)");
+        Serial.printf("  Duplicate Mode: %s (sensors convert every %lu us)\n", currentConfig.duplicate_mode.c_str(),
+                      (unsigned long)currentConfig.conversionPeriodUs());
+        if (currentConfig.adaptive_rate)
+            Serial.printf("  Adaptive Rate: idle %d Hz, approach %.2f, hold %d ms\n",
+                          currentConfig.adaptive_idle_rate_hz, currentConfig.adaptive_approach_fraction,
+                          currentConfig.adaptive_hold_ms);
+        Serial.printf("  Power Profile: %s (balanced < %.2f V, saver < %.2f V, budget %d mA)\n",
+                      currentConfig.power_profile.c_str(), currentConfig.power_balanced_below_v,
+                      currentConfig.power_saver_below_v, currentConfig.power_current_budget_ma);
+        Serial.printf("  I2C Clock: %d kHz\n", currentConfig.i2c_clock_khz);
+        Serial.printf("  Upload Format: %s\n", currentConfig.upload_format.c_str());
+        Serial.printf("  Spill To Flash: %s\n", currentConfig.spill_to_flash ? "enabled" : "disabled");
+        Serial.printf("  LAN Stream: %s\n", currentConfig.lan_stream ? (currentConfig.lan_stream_frames ? "detections + frames" : "detections") : "disabled");
+        Serial.printf("  Auto Calibration: %s\n", currentConfig.auto_calibration ? "enabled" : "disabled");
+        lanStream.setEnabled(currentConfig.lan_stream, currentConfig.lan_stream_frames);
+        Serial.printf("  Hoop Array: %s\n", currentConfig.array_role.c_str());
+        hoopArray.setRole(HoopArray::parseRole(currentConfig.array_role));
+        Serial.printf("  Capture Window: %d ms pre / %d ms post trigger\n",
+                      currentConfig.capture_pre_trigger_ms, currentConfig.capture_post_trigger_ms);
+        Serial.printf("  Detection Config: peak=%.1fx, rise=%d, wave=%dms, smooth=%d%s\n",
+                      detectorConfig.peakMultiplier, detectorConfig.minRise,
+                      detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow,
+                      detectorConfig.multiTransit ? ", multi-transit" : "");
+
+        // Apply configuration to sensors immediately: only the changed
+        // registers, without stopping collection, where possible
+        bool applied = sensorManager.reconfigure(limitedSensorConfig());
+        if (!applied)
+        {
+            Serial.println("  Reinitializing sensors instead");
+            applied = sensorManager.reinitialize(&sensorConfig);
+        }
+        if (applied)
+        {
+            // Update display with new config
+            ui.setSensorConfig(&currentConfig);
+            ui.setDetectionConfig(detectorConfig.peakMultiplier, detectorConfig.minRise,
+                                       detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow);
+            ui.showMessage("Config applied successfully!", TFT_GREEN);
+            statusPublisher.post("config_applied");
+        }
+        else
+        {
+            ui.showMessage("Config apply failed", TFT_RED);
+            statusPublisher.post("config_failed");
+        }
+    }
+    else
+    {
+        Serial.println("No sensor_config in command payload");
+        ui.showMessage("Config data missing", TFT_RED);
+    }
+
+    ui.hold(2000);
+    ui.setDisplayState(DISPLAY_IDLE);
+}
+
+void commandSetMode(JsonDocument *doc)
+{
+    Serial.printf("[Config] Current detection mode: %s (useMLDetection=%d)\n",
+                  detectionModeName(), useMLDetection);
+    if (doc != nullptr && doc->containsKey("mode"))
+    {
+        String modeStr = (*doc)["mode"].as<String>();
+
+        if (modeStr == "idle")
+        {
+            currentMode = DeviceMode::IDLE;
+            playModeActive = false;
+            ui.ledsOff();
+            serialStudioOutput.setEmitTelemetry(false);
+            // Stop interrupt monitoring if it was running
+            if (interruptManager.isMonitoring())
             {
-                currentConfig.interrupt_threshold_margin = config["interrupt_threshold_margin"];
+                interruptManager.stopMonitoring();
             }
-            if (config.containsKey("interrupt_hysteresis"))
+            ui.setMode(MODE_IDLE);
+            ui.showMessage("Mode: IDLE", TFT_DARKGREY);
+            statusPublisher.post("mode_idle");
+        }
+        else if (modeStr == "debug")
+        {
+            currentMode = DeviceMode::DEBUG;
+            playModeActive = false;
+            ui.ledsOff();
+            serialStudioOutput.setEmitTelemetry(false);
+            // Stop interrupt monitoring if it was running
+            if (interruptManager.isMonitoring())
             {
-                currentConfig.interrupt_hysteresis = config["interrupt_hysteresis"];
+                interruptManager.stopMonitoring();
             }
-            if (config.containsKey("interrupt_integration_time"))
+            ui.setMode(MODE_DEBUG);
+            ui.showMessage("Mode: DEBUG", TFT_BLUE);
+            statusPublisher.post("mode_debug");
+        }
+        else if (modeStr == "play")
+        {
+            currentMode = DeviceMode::PLAY;
+            serialStudioOutput.setEmitTelemetry(true);
+            // Stop interrupt monitoring if it was running
+            if (interruptManager.isMonitoring())
             {
-                currentConfig.interrupt_integration_time = config["interrupt_integration_time"];
+                interruptManager.stopMonitoring();
             }
-            if (config.containsKey("interrupt_multi_pulse"))
+            ui.setMode(MODE_PLAY);
+            ui.showMessage("Mode: PLAY", TFT_GREEN);
+            statusPublisher.post("mode_play");
+            // Reset detector to establish fresh baseline for this session
+            DetectionTask::Guard guard(detectionTask);
+            if (useMLDetection)
             {
-                currentConfig.interrupt_multi_pulse = config["interrupt_multi_pulse"];
+                mlDetector.fullReset();
+                Serial.println("ML detector reset for new play session");
             }
-            if (config.containsKey("interrupt_persistence"))
+            else
             {
-                currentConfig.interrupt_persistence = config["interrupt_persistence"];
+                resetDirectionDetector();
+                Serial.println("Heuristic detector reset for new play session");
             }
-            if (config.containsKey("interrupt_smart_persistence"))
+
+            // Turn off LEDs until baseline is established
+            ui.ledsOff();
+        }
+        else if (modeStr == "live_debug")
+        {
+            currentMode = DeviceMode::LIVE_DEBUG;
+            playModeActive = false;
+            liveDebugActive = false;
+            ui.ledsOff();
+            serialStudioOutput.setEmitTelemetry(true);
+            if (interruptManager.isMonitoring())
+            {
+                interruptManager.stopMonitoring();
+            }
+            ui.setMode(MODE_LIVE_DEBUG);
+            ui.showMessage("Mode: LIVE DEBUG", TFT_MAGENTA);
+            statusPublisher.post("mode_live_debug");
+            // Reset detector for live debug session
+            DetectionTask::Guard guard(detectionTask);
+            if (useMLDetection)
             {
-                currentConfig.interrupt_smart_persistence = config["interrupt_smart_persistence"];
+                mlDetector.fullReset();
+                Serial.println("ML detector reset for live debug session");
             }
-            if (config.containsKey("interrupt_mode"))
+            else
             {
-                currentConfig.interrupt_mode = config["interrupt_mode"].as<String>();
+                resetDirectionDetector();
+                Serial.println("Heuristic detector reset for live debug session");
             }
+            ui.ledsOff();
+        }
+        else if (modeStr == "calibrate")
+        {
+            // Start calibration mode
+            Serial.println("Starting calibration via MQTT command...");
 
-            // Handle detection_mode (heuristic vs ml)
-            if (config.containsKey("detection_mode"))
+            // Only start if not collecting
+            if (sessionManager.getState() == IDLE)
             {
-                String detMode = config["detection_mode"].as<String>();
-                bool wasML = useMLDetection;
-                useMLDetection = (detMode == "ml");
-                if (useMLDetection && !wasML)
+                // Set sensor config before starting
+                CalibrationSettings settings = calibrationSettings();
+                calibrationManager.setSensorConfig(settings.multi_pulse, settings.integration_time,
+                                                   settings.led_current);
+
+                // Calibration draws on the display itself; loop() runs it and
+                // holds the UI from its first pass until it ends
+                // All PCBs at once needs polling; "parallel": false forces
+                // the one-PCB-at-a-time wizard
+                bool parallel = parallelCalibration() && ((*doc)["parallel"] | true);
+                ui.lock();
+                bool started = calibrationManager.startCalibration(parallel);
+                ui.unlock();
+                if (started)
+                {
+                    statusPublisher.post("calibration_started");
+                }
+                else
                 {
-                    // Switching to ML: initialize if needed
-                    if (!mlDetector.isReady())
-                    {
-                        Serial.println("  Initializing ML detector on config change...");
-                        if (!mlDetector.init())
-                        {
-                            Serial.println("  ML detector init failed, staying on heuristic");
-                            useMLDetection = false;
-                        }
-                    }
+                    ui.showMessage("Calibration failed to start", TFT_RED);
+                    statusPublisher.post("calibration_failed");
                 }
-                Serial.printf("  Detection Mode: %s\n", useMLDetection ? "ML" : "heuristic");
             }
+            else
+            {
+                ui.showMessage("Stop collection first!", TFT_RED);
+                statusPublisher.post("calibration_rejected_busy");
+            }
+
+            ui.hold(1500);
+            return; // Skip the displayState set below
+        }
+        else
+        {
+            ui.showMessage("Unknown mode", TFT_RED);
+            statusPublisher.post("mode_invalid");
+        }
+
+        Serial.printf("Device mode set to: %s\n", modeStr.c_str());
+        ui.hold(1500);
+        ui.setDisplayState(DISPLAY_IDLE);
+    }
+}
+
+void commandCaptureMissedEvent(JsonDocument *doc)
+{
+    // Live Debug: capture data window for a missed event (user-triggered)
+    if (currentMode != DeviceMode::LIVE_DEBUG || !liveDebugActive)
+    {
+        Serial.println("capture_missed_event ignored — not in Live Debug mode");
+        statusPublisher.post("capture_missed_ignored");
+        return;
+    }
+
+    if (!serialStudioEnabled)
+        Serial.println("[LIVE_DEBUG] Missed event capture requested");
+
+    // Sampling keeps running: freeze the last MISSED_EVENT_WINDOW_MS of
+    // the live ring and let the upload task send it
+    sessionManager.processQueue();
+
+    CaptureRing *ring = captureUploader.liveRing();
+    uint32_t newestUs = (ring != nullptr && !ring->empty()) ? ring->back().timestamp_us : 0;
+    if (queueLiveDebugCapture("missed_event", nullptr, 0.0, captureWindowStart(newestUs, MISSED_EVENT_WINDOW_MS),
+                              "live_debug_missed_captured"))
+    {
+        ui.showMessage("Missed event queued", TFT_MAGENTA);
+    }
+    else
+    {
+        statusPublisher.post("live_debug_capture_failed");
+    }
 
-            if (config.containsKey("serial_studio_enabled"))
+    // Start detection over on a fresh buffer
+    detectionTask.resetDetectors();
+}
+
+void commandSetDetectionMode(JsonDocument *doc)
+{
+    if (doc && doc->containsKey("mode"))
+    {
+        String mode = (*doc)["mode"].as<String>();
+        if (mode == "ml" || mode == "ml_sliding" || mode == "ensemble")
+        {
+            mlSlidingInference = (mode == "ml_sliding");
+            ensembleDetection = (mode == "ensemble");
+            const char *status = ensembleDetection ? "detection_mode_ensemble" : "detection_mode_ml";
+            if (doc->containsKey("stride_ms"))
             {
-                serialStudioEnabled = config["serial_studio_enabled"].as<bool>();
-                serialStudioOutput.setEnabled(serialStudioEnabled);
-                Serial.printf("  Serial Studio: %s\n", serialStudioEnabled ? "enabled" : "disabled");
+                mlStrideMs = (*doc)["stride_ms"];
+            }
+            // Preloaded at boot; loaded here only if that failed or standby is off
+            if (!mlDetector.hasModel())
+            {
+                Serial.println("Initializing ML detector on demand...");
+                DetectionTask::Guard guard(detectionTask);
+                if (!mlDetector.init())
+                {
+                    Serial.println("ML detector init failed, staying on heuristic");
+                    statusPublisher.post("detection_mode_ml_failed");
+                    return;
+                }
             }
+            useMLDetection = true;
+            stageDetectorSetup();
+            Serial.printf("Switched to %s detection\n", detectionModeName());
+            postStatusWithML(status);
+        }
+        else
+        {
+            useMLDetection = false;
+            Serial.println("Switched to heuristic detection");
+            statusPublisher.post("detection_mode_heuristic");
+        }
+    }
+}
+
+void commandLedStripTest(JsonDocument *doc)
+{
+    if (sessionManager.getState() != IDLE)
+    {
+        Serial.println("[LEDTest] Refused: session not IDLE");
+        statusPublisher.post("led_strip_test_refused_busy");
+    }
+    else
+    {
+        uint16_t ledCount = 90;
+        if (doc && (*doc)["led_count"].is<int>())
+        {
+            int requested = (*doc)["led_count"].as<int>();
+            if (requested > 0)
+                ledCount = (uint16_t)requested;
+        }
+        Serial.printf("[LEDTest] Running strip test with %u LEDs\n", ledCount);
+        statusPublisher.post("led_strip_test_started");
+        ui.lock(); // Blocking diagnostic: the strip is ours until it is done
+        ledController.runStripTest(ledCount);
+        ui.unlock();
+        statusPublisher.post("led_strip_test_complete");
+    }
+}
+
+void commandSetProfiling(JsonDocument *doc)
+{
+#if CYCLE_PROFILER
+    if (doc && (*doc)["reset"] | false)
+        CycleProfiler::reset();
+    if (doc && doc->containsKey("enabled"))
+        CycleProfiler::setEnabled((*doc)["enabled"].as<bool>());
+
+    Serial.printf("Cycle profiler %s\n", CycleProfiler::isEnabled() ? "recording" : "stopped");
+    statusPublisher.post(CycleProfiler::isEnabled() ? "profiling_enabled" : "profiling_disabled");
+#else
+    statusPublisher.post("profiling_unavailable");
+#endif
+}
+
+void commandGetProfile(JsonDocument *doc)
+{
+#if CYCLE_PROFILER
+    // "events": newest N raw events as well; "serial": also print the table
+    size_t maxEvents = doc ? (*doc)["events"] | 0 : 0;
+    if (doc && (*doc)["serial"] | false)
+        CycleProfiler::printReport();
+
+    DynamicJsonDocument profile(CycleProfiler::jsonCapacity(maxEvents));
+    CycleProfiler::toJson(profile, maxEvents);
+    mqttManager->publishStatus("profile", profile);
+#else
+    statusPublisher.post("profiling_unavailable");
+#endif
+}
+
+// Per-task CPU share and stack headroom ("serial": also print the table)
+void commandGetTaskStats(JsonDocument *doc)
+{
+    if (doc && (*doc)["serial"] | false)
+        TaskMonitor::printReport();
+
+    DynamicJsonDocument stats(TaskMonitor::jsonCapacity());
+    TaskMonitor::toJson(stats);
+    mqttManager->publishStatus("task_stats", stats);
+}
+
+// Per-command ack latency and run time
+void commandGetCommandStats(JsonDocument *doc)
+{
+    DynamicJsonDocument stats(2048);
+    commands.toJson(stats);
+    mqttManager->publishStatus("command_stats", stats);
+}
+
+// Power profile, smoothed VSYS / current and charge drawn on battery
+void commandGetPower(JsonDocument *doc)
+{
+    DynamicJsonDocument stats(768);
+    powerProfiles.toJson(stats);
+    mqttManager->publishStatus("power_status", stats);
+}
+
+// Hoop array role, shared clock and (coordinator) the units merged
+void commandGetArray(JsonDocument *doc)
+{
+    DynamicJsonDocument stats(HOOP_ARRAY_JSON_CAPACITY);
+    hoopArray.toJson(stats);
+    mqttManager->publishStatus("array_status", stats);
+}
+
+// Lane kernels (ML normalize / quantize): dispatched vs scalar ns per call
+void commandBenchKernels(JsonDocument *doc)
+{
+    uint32_t iterations = doc ? (*doc)["iterations"] | 200 : 200;
+
+    DynamicJsonDocument bench(512);
+    LaneKernels::benchmark(bench, iterations);
+    mqttManager->publishStatus("kernel_bench", bench);
+}
+
+// Stream a firmware or model image to flash (see OtaUpdater.h)
+void commandOtaUpdate(JsonDocument *doc)
+{
+    OtaJob job;
+    const char *error = doc ? OtaUpdater::parseJob(*doc, job) : "no parameters";
+    if (error == nullptr && !otaUpdater.submit(job))
+        error = "update in progress";
+    if (error != nullptr)
+    {
+        DynamicJsonDocument details(128);
+        details["error"] = error;
+        mqttManager->publishStatus("ota_failed", details);
+    }
+}
+
+void commandOtaRollback(JsonDocument *doc)
+{
+    const char *error = nullptr;
+    ui.showMessage("Rolling back...", TFT_YELLOW);
+    if (!otaUpdater.rollbackFirmware(error))
+    {
+        DynamicJsonDocument details(128);
+        details["error"] = error;
+        mqttManager->publishStatus("ota_rollback_failed", details);
+    }
+}
+
+// Range fetch from the kept spill container (see SessionSpill.h):
+// session_id, start_ms / end_ms since session start, positions (mask or
+// list, default all), fetch_id echoed back in every message
+void commandFetchRange(JsonDocument *doc)
+{
+    const char *error = nullptr;
+    const char *sessionId = doc ? (*doc)["session_id"] | "" : "";
+    if (doc == nullptr)
+        error = "no parameters";
+    else if (sessionManager.getState() != IDLE)
+        error = "session in progress";
+    else if (!sessionSpill.openContainer())
+        error = "no stored session";
+    else if (strcmp(sessionId, sessionSpill.getSessionId()) != 0)
+        error = "session not stored";
+
+    SensorMask positions = (SensorMask)((1UL << NUM_SENSORS) - 1);
+    if (error == nullptr && (*doc)["positions"].is<JsonArray>())
+    {
+        positions = 0;
+        for (int pos : (*doc)["positions"].as<JsonArray>())
+        {
+            if (pos >= 0 && pos < NUM_SENSORS)
+                positions |= 1 << pos;
+        }
+    }
+    else if (error == nullptr && (*doc)["positions"].is<unsigned int>())
+    {
+        positions &= (*doc)["positions"].as<unsigned int>();
+    }
+    if (error == nullptr && positions == 0)
+        error = "no positions";
+
+    const char *fetchId = doc ? (*doc)["fetch_id"] | "" : "";
+    if (error == nullptr)
+    {
+        uint32_t startMs = (*doc)["start_ms"] | 0UL;
+        uint32_t endMs = (*doc)["end_ms"] | (uint32_t)SESSION_SPILL_MAX_MS;
+        if (!dataTransmitter->transmitRange(sessionSpill, fetchId, startMs, endMs, positions))
+            error = "transmit failed";
+    }
+
+    DynamicJsonDocument details(192);
+    details["session_id"] = sessionId;
+    details["fetch_id"] = fetchId;
+    if (error != nullptr)
+        details["error"] = error;
+    mqttManager->publishStatus(error != nullptr ? "fetch_range_failed" : "fetch_range_complete", details);
+}
+
+// OTA model install (OTA task): the detector lets go of the model
+// partition while it is rewritten, then loads the new model - or the
+// previous one again if the new one does not load. Unused models are
+// loaded once to check them and released again.
+bool swapModel(OtaUpdater &ota, void *)
+{
+    DetectionTask::Guard guard(detectionTask);
+    bool inUse = mlDetector.hasModel();
+    mlDetector.deinit();
+
+    bool installed = ota.writeStagedModel() && mlDetector.init();
+    if (!installed && ota.restoreModel() && inUse && !mlDetector.init())
+        Serial.println("ERROR: ML detector did not reload the previous model");
+    if (!inUse)
+        mlDetector.deinit();
+    return installed;
+}
+
+void commandReboot(JsonDocument *doc)
+{
+    ui.showMessage("Rebooting...", TFT_YELLOW);
+    delay(1000);
+    ESP.restart();
+}
+
+// MQTT command names -> handlers (run on the command task, see CommandDispatcher)
+void registerCommands()
+{
+    commands.add("ping", commandPing);
+    commands.add("start_collection", commandStartCollection);
+    commands.add("stop_collection", commandStopCollection);
+    commands.add("configure_sensors", commandConfigureSensors);
+    commands.add("set_mode", commandSetMode);
+    commands.add("capture_missed_event", commandCaptureMissedEvent);
+    commands.add("set_detection_mode", commandSetDetectionMode);
+    commands.add("led_strip_test", commandLedStripTest);
+    commands.add("set_profiling", commandSetProfiling);
+    commands.add("get_profile", commandGetProfile);
+    commands.add("get_task_stats", commandGetTaskStats);
+    commands.add("get_command_stats", commandGetCommandStats);
+    commands.add("get_power", commandGetPower);
+    commands.add("get_array", commandGetArray);
+    commands.add("bench_kernels", commandBenchKernels);
+    commands.add("fetch_range", commandFetchRange);
+    commands.add("ota_update", commandOtaUpdate);
+    commands.add("ota_rollback", commandOtaRollback);
+    commands.add("reboot", commandReboot);
+    commands.add("upload_session", commandUploadSession);
+}
+
+// First frame timestamp of a capture reaching preMs back from triggerUs
+unsigned long captureWindowStart(uint32_t triggerUs, unsigned long preMs)
+{
+    unsigned long preUs = preMs * 1000UL;
+    return triggerUs > preUs ? triggerUs - preUs : 0;
+}
+
+// Live Debug: freeze the live capture ring (frames from windowStartUs to
+// now) and hand it to the upload task; a free slot becomes the live ring.
+// Nothing is copied and sampling is never stopped - frames arriving
+// meanwhile wait in the frame ring.
+bool queueLiveDebugCapture(const char *captureReason, const char *detectionDirection,
+                           float detectionConfidence, unsigned long windowStartUs, const char *successStatus)
+{
+    liveDebugCapturePending = false;
+
+    CaptureRing *ring = captureUploader.liveRing();
+    if (ring == nullptr || ring->empty())
+    {
+        if (!serialStudioEnabled)
+            Serial.printf("[LIVE_DEBUG] %s capture skipped: buffer empty\n", captureReason);
+        return false;
+    }
+
+    // Window from actual ring timestamps (the ring may not reach back to windowStartUs)
+    size_t startIdx = ring->lowerBound(windowStartUs);
+    if (startIdx >= ring->size())
+        startIdx = ring->size() - 1;
+    size_t captureCount = ring->size() - startIdx;
+
+    // Session Confirmation: finalize summary for this capture
+    {
+        uint8_t activeCnt = 0;
+        for (const auto &m : sessionManager.getSensorMetadata())
+        {
+            if (m.active)
+                activeCnt++;
+        }
+        // Use capture duration for summary, not full session duration
+        sessionManager.getSessionSummary().duration_ms =
+            (ring->back().timestamp_us - (*ring)[startIdx].timestamp_us) / 1000;
+        sessionManager.finalizeSessionSummary(&currentConfig, activeCnt);
+    }
+
+    bool queued = false;
+    CaptureJob *job = captureUploader.freezeLive();
+    if (job == nullptr)
+    {
+        // The live ring keeps filling; a later capture can still use it
+        captureUploader.countDropped();
+        if (!serialStudioEnabled)
+            Serial.printf("[LIVE_DEBUG] Upload slots busy - %s capture dropped (%lu total)\n",
+                          captureReason, captureUploader.getDroppedCount());
+    }
+    else
+    {
+        job->windowStartUs = windowStartUs;
+        job->captureReason = captureReason;
+        job->detectionDirection = detectionDirection;
+        job->detectionConfidence = detectionConfidence;
+        job->successStatus = successStatus;
+        job->summary = sessionManager.getSessionSummary();
+        job->config = currentConfig;
+        captureUploader.submit(job);
+        queued = true;
+
+        // Frames from here on go to the fresh live ring
+        sessionManager.setCaptureRing(captureUploader.liveRing());
+        serialStudioOutput.setCaptureSource(captureUploader.liveRing());
+
+        if (!serialStudioEnabled)
+            Serial.printf("[LIVE_DEBUG] %s capture queued: %d frames (%d uploads pending)\n",
+                          captureReason, captureCount, captureUploader.pending());
+    }
+
+    // Fresh summary for the next capture. The sensor task is still
+    // counting, so the next summary may include a few cycles in flight.
+    sessionManager.getSessionSummary().reset();
+
+    return queued;
+}
+
+// Detector settings to the detection task, swapped in at its next cycle
+// boundary. The ML inference mode follows the detector mode there
+// (ensemble and standby: ON_DEMAND).
+void stageDetectorSetup()
+{
+    DetectorSetup setup;
+    setup.config = detectorConfig;
+    setup.mlMode = mlSlidingInference ? MLInferenceMode::SLIDING : MLInferenceMode::TRIGGERED;
+    setup.mlStrideMs = mlStrideMs;
+    detectionTask.stage(setup);
+}
+
+// Ensemble thresholds (either config source)
+void applyEnsembleConfig(JsonObject config)
+{
+    if (config.containsKey("ensemble_confidence"))
+        ensembleConfidence = config["ensemble_confidence"];
+    if (config.containsKey("ensemble_min_gap_ms"))
+        ensembleMinGapMs = config["ensemble_min_gap_ms"];
+    detectionTask.setEnsembleThresholds(ensembleConfidence, ensembleMinGapMs);
+}
 
-            // Detection algorithm parameters
-            if (config.containsKey("peak_multiplier"))
-                detectorConfig.peakMultiplier = config["peak_multiplier"].as<float>();
-            if (config.containsKey("min_rise"))
-                detectorConfig.minRise = config["min_rise"];
-            if (config.containsKey("min_wave_duration_ms"))
-                detectorConfig.minWaveDurationMs = config["min_wave_duration_ms"];
-            if (config.containsKey("smoothing_window"))
-                detectorConfig.smoothingWindow = config["smoothing_window"];
-
-            directionDetector.setConfig(detectorConfig);
-
-            Serial.println("Configuration updated:");
-            Serial.printf("  Sample Rate: %d Hz\n", currentConfig.sample_rate_hz);
-            Serial.printf("  LED Current: %s\n", currentConfig.led_current.c_str());
-            Serial.printf("  Integration Time: %s\n", currentConfig.integration_time.c_str());
-            Serial.printf("  Duty Cycle: %s\n", currentConfig.duty_cycle.c_str());
-            Serial.printf("  Multi-Pulse: %s pulses\n", currentConfig.multi_pulse.c_str());
-            Serial.printf("  High Resolution: %s\n", currentConfig.high_resolution ? "enabled" : "disabled");
-            Serial.printf("  Read Ambient: %s\n", currentConfig.read_ambient ? "enabled" : "disabled");
-            Serial.printf("  I2C Clock: %d kHz\n", currentConfig.i2c_clock_khz);
-            Serial.printf("  Detection Config: peak=%.1fx, rise=%d, wave=%dms, smooth=%d\n",
-                          detectorConfig.peakMultiplier, detectorConfig.minRise,
-                          detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow);
-
-            // Apply configuration to sensors immediately
-            if (sensorManager.reinitialize(&currentConfig))
-            {
-                // Update display with new config
-                display.setSensorConfig(&currentConfig);
-                display.setDetectionConfig(detectorConfig.peakMultiplier, detectorConfig.minRise,
-                                           detectorConfig.minWaveDurationMs, detectorConfig.smoothingWindow);
-                display.showMessage("Config applied successfully!", TFT_GREEN);
-                mqttManager->publishStatus("config_applied");
-            }
-            else
-            {
-                display.showMessage("Config apply failed", TFT_RED);
-                mqttManager->publishStatus("config_failed");
-            }
-        }
-        else
-        {
-            Serial.println("No sensor_config in command payload");
-            display.showMessage("Config data missing", TFT_RED);
-        }
+// multi_transit applies to the heuristic detector (alone or in the ensemble)
+bool pipelinedDetection()
+{
+    return detectorConfig.multiTransit && activeDetectorMode() != DetectorMode::ML;
+}
 
-        delay(2000);
-        display.setDisplayState(DISPLAY_IDLE);
-    }
-    else if (command == "set_mode")
+DetectorMode activeDetectorMode()
+{
+    if (!useMLDetection)
+        return DetectorMode::HEURISTIC;
+    return ensembleDetection ? DetectorMode::ENSEMBLE : DetectorMode::ML;
+}
+
+const char *detectionModeName()
+{
+    switch (activeDetectorMode())
     {
-        Serial.printf("[Config] Current detection mode: %s (useMLDetection=%d)\n",
-                      useMLDetection ? "ML" : "heuristic", useMLDetection);
-        if (doc != nullptr && doc->containsKey("mode"))
-        {
-            String modeStr = (*doc)["mode"].as<String>();
+    case DetectorMode::ENSEMBLE:
+        return "ensemble";
+    case DetectorMode::ML:
+        return "ML";
+    default:
+        return "heuristic";
+    }
+}
 
-            if (modeStr == "idle")
-            {
-                currentMode = DeviceMode::IDLE;
-                playModeActive = false;
-                ledController.off();
-                serialStudioOutput.setEmitTelemetry(false);
-                // Stop interrupt monitoring if it was running
-                if (interruptManager.isMonitoring())
-                {
-                    interruptManager.stopMonitoring();
-                }
-                display.setMode(MODE_IDLE);
-                display.showMessage("Mode: IDLE", TFT_DARKGREY);
-                mqttManager->publishStatus("mode_idle");
-            }
-            else if (modeStr == "debug")
-            {
-                currentMode = DeviceMode::DEBUG;
-                playModeActive = false;
-                ledController.off();
-                serialStudioOutput.setEmitTelemetry(false);
-                // Stop interrupt monitoring if it was running
-                if (interruptManager.isMonitoring())
-                {
-                    interruptManager.stopMonitoring();
-                }
-                display.setMode(MODE_DEBUG);
-                display.showMessage("Mode: DEBUG", TFT_BLUE);
-                mqttManager->publishStatus("mode_debug");
-            }
-            else if (modeStr == "play")
-            {
-                currentMode = DeviceMode::PLAY;
-                serialStudioOutput.setEmitTelemetry(true);
-                // Stop interrupt monitoring if it was running
-                if (interruptManager.isMonitoring())
-                {
-                    interruptManager.stopMonitoring();
-                }
-                display.setMode(MODE_PLAY);
-                display.showMessage("Mode: PLAY", TFT_GREEN);
-                mqttManager->publishStatus("mode_play");
-                // Reset detector to establish fresh baseline for this session
-                if (useMLDetection)
-                {
-                    mlDetector.fullReset();
-                    Serial.println("ML detector reset for new play session");
-                }
-                else
-                {
-                    directionDetector.fullReset();
-
-                    // Apply calibration data if available
-                    if (deviceCalibration.isValid())
-                    {
-                        directionDetector.setCalibration(&deviceCalibration);
-                        Serial.println("Calibration data applied to DirectionDetector");
-                    }
-                    else
-                    {
-                        directionDetector.setCalibration(nullptr);
-                        Serial.println("No calibration - using fallback thresholds");
-                    }
-                    Serial.println("Heuristic detector reset for new play session");
-                }
+// Hybrid sensor mode settings (either config source)
+void applyHybridConfig(JsonObject config)
+{
+    if (config.containsKey("hybrid_idle_duty_cycle"))
+        currentConfig.hybrid_idle_duty_cycle = config["hybrid_idle_duty_cycle"].as<String>();
+    if (config.containsKey("hybrid_burst_window_ms"))
+        currentConfig.hybrid_burst_window_ms = config["hybrid_burst_window_ms"];
+    if (config.containsKey("hybrid_burst_max_ms"))
+        currentConfig.hybrid_burst_max_ms = config["hybrid_burst_max_ms"];
+    if (config.containsKey("hybrid_burst_all_boards"))
+        currentConfig.hybrid_burst_all_boards = config["hybrid_burst_all_boards"];
+    if (config.containsKey("light_sleep_idle"))
+        currentConfig.light_sleep_idle = config["light_sleep_idle"];
+    if (config.containsKey("light_sleep_max_ms"))
+        currentConfig.light_sleep_max_ms = config["light_sleep_max_ms"];
+    lightSleep.configure(currentConfig.light_sleep_idle, currentConfig.light_sleep_max_ms);
+}
 
-                // Turn off LEDs until baseline is established
-                ledController.off();
-            }
-            else if (modeStr == "live_debug")
-            {
-                currentMode = DeviceMode::LIVE_DEBUG;
-                playModeActive = false;
-                liveDebugActive = false;
-                ledController.off();
-                serialStudioOutput.setEmitTelemetry(true);
-                if (interruptManager.isMonitoring())
-                {
-                    interruptManager.stopMonitoring();
-                }
-                display.setMode(MODE_LIVE_DEBUG);
-                display.showMessage("Mode: LIVE DEBUG", TFT_MAGENTA);
-                mqttManager->publishStatus("mode_live_debug");
-                // Reset detector for live debug session
-                if (useMLDetection)
-                {
-                    mlDetector.fullReset();
-                    Serial.println("ML detector reset for live debug session");
-                }
-                else
-                {
-                    directionDetector.fullReset();
-
-                    // Apply calibration data if available
-                    if (deviceCalibration.isValid())
-                    {
-                        directionDetector.setCalibration(&deviceCalibration);
-                        Serial.println("Calibration data applied to DirectionDetector");
-                    }
-                    else
-                    {
-                        directionDetector.setCalibration(nullptr);
-                        Serial.println("No calibration - using fallback thresholds");
-                    }
-                    Serial.println("Heuristic detector reset for live debug session");
-                }
-                ledController.off();
-            }
-            else if (modeStr == "calibrate")
-            {
-                // Start calibration mode
-                Serial.println("Starting calibration via MQTT command...");
+// Adaptive sample rate settings (either config source)
+// Sensor settings calibrations are measured with (and stored for)
+// Calibrate all PCBs at once from sensor-task frames: polling only (a
+// hybrid/interrupt cycle does not read idle sensors)
+bool parallelCalibration()
+{
+    return CAL_PARALLEL_DEFAULT && currentConfig.sensor_mode == SensorMode::POLLING_MODE;
+}
 
-                // Only start if not collecting
-                if (sessionManager.getState() == IDLE)
-                {
-                    // Set sensor config before starting
-                    uint8_t mp = currentConfig.multi_pulse.toInt();
-                    if (mp == 0)
-                        mp = 1;
-                    uint8_t it = currentConfig.integration_time.substring(0, 1).toInt();
-                    if (it == 0)
-                        it = 1;
-                    uint8_t led = currentConfig.led_current.toInt();
-                    if (led == 0)
-                        led = 200;
-                    calibrationManager.setSensorConfig(mp, it, led);
-
-                    if (calibrationManager.startCalibration())
-                    {
-                        mqttManager->publishStatus("calibration_started");
-                    }
-                    else
-                    {
-                        display.showMessage("Calibration failed to start", TFT_RED);
-                        mqttManager->publishStatus("calibration_failed");
-                    }
-                }
-                else
-                {
-                    display.showMessage("Stop collection first!", TFT_RED);
-                    mqttManager->publishStatus("calibration_rejected_busy");
-                }
+CalibrationSettings calibrationSettings()
+{
+    CalibrationSettings settings;
+    settings.multi_pulse = currentConfig.multi_pulse.toInt();
+    if (settings.multi_pulse == 0)
+        settings.multi_pulse = 1;
+    settings.integration_time = currentConfig.integration_time.substring(0, 1).toInt();
+    if (settings.integration_time == 0)
+        settings.integration_time = 1;
+    settings.led_current = currentConfig.led_current.toInt();
+    if (settings.led_current == 0)
+        settings.led_current = 200;
+    return settings;
+}
 
-                delay(1500);
-                return; // Skip the displayState set below
-            }
-            else
-            {
-                display.showMessage("Unknown mode", TFT_RED);
-                mqttManager->publishStatus("mode_invalid");
-            }
+// Fresh heuristic detector: calibration thresholds if calibrated, baselines
+// from NVS if stored for the current settings. Caller holds the
+// DetectionTask guard.
+void resetDirectionDetector()
+{
+    directionDetector.fullReset();
 
-            Serial.printf("Device mode set to: %s\n", modeStr.c_str());
-            delay(1500);
-            display.setDisplayState(DISPLAY_IDLE);
-        }
+    // Apply calibration data if available (the auto calibrator's copy:
+    // its thresholds follow baseline drift)
+    if (deviceCalibration.isValid())
+    {
+        directionDetector.setCalibration(autoCalibrator.reference(deviceCalibration));
+        Serial.println("Calibration data applied to DirectionDetector");
     }
-    else if (command == "capture_missed_event")
+    else
     {
-        // Live Debug: capture data window for a missed event (user-triggered)
-        if (currentMode != DeviceMode::LIVE_DEBUG || !liveDebugActive)
-        {
-            Serial.println("capture_missed_event ignored — not in Live Debug mode");
-            mqttManager->publishStatus("capture_missed_ignored");
-            return;
-        }
+        autoCalibrator.reference(deviceCalibration);
+        directionDetector.setCalibration(nullptr);
+        Serial.println("No calibration - using fallback thresholds");
+    }
 
-        if (!serialStudioEnabled)
-            Serial.println("[LIVE_DEBUG] Missed event capture requested");
+    uint8_t warm = calibrationStore.warmStart(directionDetector, calibrationSettings());
+    if (warm > 0)
+        Serial.printf("DirectionDetector warm-started: %d sensors ready from stored baselines\n", warm);
+}
 
-        // 1. Stop sensor polling
-        sensorManager.stopCollection();
-        delay(50);
-        sessionManager.processQueue();
+// Status details (publisher task): the auto calibrator's last snapshot
+void addAutoCalibration(JsonDocument &details)
+{
+    autoCalibrator.toJson(details);
+}
 
-        // 2. Show status
-        display.showMessage("Capturing missed...", TFT_MAGENTA);
+// Status details (publisher task): the last bus health event and totals
+I2CHealthEvent lastHealthEvent = {};
 
-        // 3. Extract window: last MISSED_EVENT_WINDOW_MS of data (using timestamps)
-        auto &buffer = sessionManager.getDataBuffer();
-        size_t actualBufferSize = buffer.size();
-        size_t startIdx = 0;
+void addI2CHealth(JsonDocument &details)
+{
+    I2CHealthEvent event = lastHealthEvent;
+    details["bus"] = event.bus;
+    if (event.sensor < NUM_SENSORS)
+        details["sensor"] = event.sensor;
+    if (event.type == I2CHealthEventType::BUS_RECOVERED || event.type == I2CHealthEventType::BUS_RECOVERY_FAILED)
+    {
+        details["sda_stuck"] = event.sdaStuck;
+        details["scl_stuck"] = event.sclStuck;
+        details["pulses"] = event.pulses;
+        details["duration_us"] = event.durationUs;
+    }
+    details["quarantined_mask"] = sensorManager.getQuarantinedSensors();
+
+    I2CHealthStats stats = sensorManager.getBusHealthStats();
+    details["recoveries"] = stats.recoveries;
+    details["recovery_failures"] = stats.recoveryFailures;
+    details["quarantines"] = stats.quarantines;
+    details["restores"] = stats.restores;
+    if (stats.droppedEvents > 0)
+        details["dropped_events"] = stats.droppedEvents;
+}
 
-        if (actualBufferSize > 0)
-        {
-            unsigned long latestTs = buffer[actualBufferSize - 1].timestamp_us;
-            unsigned long windowUs = MISSED_EVENT_WINDOW_MS * 1000UL; // Convert ms constant to microseconds
-            unsigned long cutoffTs = (latestTs > windowUs) ? latestTs - windowUs : 0;
+void applyAdaptiveRateConfig(JsonObject config)
+{
+    if (config.containsKey("adaptive_rate"))
+        currentConfig.adaptive_rate = config["adaptive_rate"];
+    if (config.containsKey("adaptive_idle_rate_hz"))
+        currentConfig.adaptive_idle_rate_hz = config["adaptive_idle_rate_hz"];
+    if (config.containsKey("adaptive_approach_fraction"))
+        currentConfig.adaptive_approach_fraction = config["adaptive_approach_fraction"];
+    if (config.containsKey("adaptive_hold_ms"))
+        currentConfig.adaptive_hold_ms = config["adaptive_hold_ms"];
+}
 
-            // Binary search for the first reading at or after cutoffTs
-            size_t lo = 0, hi = actualBufferSize;
-            while (lo < hi)
-            {
-                size_t mid = lo + (hi - lo) / 2;
-                if (buffer[mid].timestamp_us < cutoffTs)
-                    lo = mid + 1;
-                else
-                    hi = mid;
-            }
-            startIdx = lo;
-        }
+void applyPowerConfig(JsonObject config)
+{
+    if (config.containsKey("power_profile"))
+        currentConfig.power_profile = config["power_profile"].as<String>();
+    if (config.containsKey("power_balanced_below_v"))
+        currentConfig.power_balanced_below_v = config["power_balanced_below_v"];
+    if (config.containsKey("power_saver_below_v"))
+        currentConfig.power_saver_below_v = config["power_saver_below_v"];
+    if (config.containsKey("power_current_budget_ma"))
+        currentConfig.power_current_budget_ma = config["power_current_budget_ma"];
+    powerProfiles.configure(currentConfig);
+}
 
-        size_t captureCount = actualBufferSize - startIdx;
-        unsigned long capDurationMs = (captureCount > 0)
-                                          ? (buffer[actualBufferSize - 1].timestamp_us - buffer[startIdx].timestamp_us) / 1000
-                                          : 0;
+// Refresh sensorConfig from currentConfig and the power profile
+SensorConfiguration *limitedSensorConfig()
+{
+    sensorConfig = currentConfig;
+    powerProfiles.limit(sensorConfig);
+    return &sensorConfig;
+}
 
-        if (!serialStudioEnabled)
-            Serial.printf("[LIVE_DEBUG] Missed event: capturing %d readings (%lums)\n",
-                          captureCount, capDurationMs);
+// Input source present; without the charger the voltage alone decides
+bool bq24195PowerGood()
+{
+    if (!bq24195Present)
+        return false;
+    Wire.beginTransmission(BQ24195_I2C_ADDR);
+    Wire.write(BQ24195_REG08);
+    if (Wire.endTransmission(false) != 0 || Wire.requestFrom((uint8_t)BQ24195_I2C_ADDR, (uint8_t)1) != 1)
+        return false;
+    return (Wire.read() & BQ24195_PG_STAT) != 0;
+}
 
-        // 4. Session Confirmation: finalize summary for missed event capture
-        {
-            uint8_t activeCnt = 0;
-            for (const auto &m : sessionManager.getSensorMetadata())
-            {
-                if (m.active)
-                    activeCnt++;
-            }
-            sessionManager.getSessionSummary().duration_ms = capDurationMs;
-            sessionManager.finalizeSessionSummary(&currentConfig, activeCnt);
-        }
+// Profile switch (loop()): CPU, Wi-Fi and backlight now; sensor LED current /
+// duty between two cycles, the sample rate cap at the next collection start
+void applyPowerProfile()
+{
+    const PowerProfileLimits &limits = powerProfiles.getLimits();
+    Serial.printf("[Power] Profile %s (%s): CPU %u MHz, Wi-Fi PS %u, backlight %u, VSYS %.2f V, %.0f mA\n",
+                  powerProfiles.isManaged() ? PowerProfileManager::profileName(powerProfiles.getProfile()) : "off",
+                  powerProfiles.getReason(), limits.cpuFrequencyMhz, limits.wifiPowerSave,
+                  limits.displayBrightness, powerMonitor.getVoltage(), powerMonitor.getCurrentMA());
 
-        // 5. Transmit (binary-packed single message — data + summary)
-        String captureSessionId = dataTransmitter->transmitLiveDebugCaptureBinary(
-            buffer, startIdx, captureCount,
-            "missed_event", nullptr, 0.0,
-            sessionManager.getSessionSummary(),
-            &currentConfig);
+    setCpuFrequencyMhz(limits.cpuFrequencyMhz);
+    networkManager.setPowerSave((wifi_ps_type_t)limits.wifiPowerSave);
+    ui.setBrightness(limits.displayBrightness);
 
-        if (captureSessionId.length() > 0)
-        {
-            if (!serialStudioEnabled)
-                Serial.println("[LIVE_DEBUG] Missed event capture transmitted");
-            mqttManager->publishStatus("live_debug_missed_captured");
-        }
-        else
-        {
-            if (!serialStudioEnabled)
-                Serial.println("[LIVE_DEBUG] ERROR: Missed event capture failed!");
-            mqttManager->publishStatus("live_debug_capture_failed");
-        }
+    SensorConfiguration *config = limitedSensorConfig();
+    if (!calibrationManager.isActive() && !sensorManager.reconfigure(config))
+        Serial.println("[Power] Sensor limits apply at the next collection start");
 
-        // 6. Clear buffer and reset
-        directionDetector.reset();
-        buffer.clear();
+    statusPublisher.post("power_profile", addPowerProfile);
+}
 
-        // 7. Resume with fresh summary
-        sessionManager.getSessionSummary().reset();
-        sensorManager.startCollection(sessionManager.getQueue(), &sessionManager.getSessionSummary());
-        display.showMessage("Ready", TFT_MAGENTA);
-        if (!serialStudioEnabled)
-            Serial.println("[LIVE_DEBUG] Resumed after missed event capture");
+// Status details (publisher task)
+void addPowerProfile(JsonDocument &details)
+{
+    powerProfiles.toJson(details);
+}
+
+// Status details (publisher task): the array detections queued since the last post
+void addArrayDetections(JsonDocument &details)
+{
+    JsonArray list = details.createNestedArray("detections");
+    ArrayDetection detection;
+    while (hoopArray.pollDetection(detection))
+    {
+        JsonObject entry = list.createNestedObject();
+        entry["sync_us"] = detection.syncUs;
+        entry["direction"] = DirectionDetector::directionToString(detection.direction);
+        entry["confidence"] = detection.confidence;
+        entry["units"] = detection.units;
+        entry["agreeing"] = detection.agreeing;
+        entry["spread_us"] = detection.spreadUs;
     }
-    else if (command == "set_detection_mode")
+    details["clock"] = TimeSync::sourceName(TimeSync::source());
+}
+
+// Status details (publisher task): HeapTracker's last sample and per-tag counts
+void addHeapStats(JsonDocument &details)
+{
+    HeapSnapshot s = HeapTracker::getSnapshot();
+    details["heap_free"] = s.heapFree;
+    details["heap_largest_block"] = s.heapLargest;
+    details["heap_min_free_ever"] = s.heapMinEver;
+    // 0 = one contiguous block, near 100 = free memory is all small pieces
+    details["heap_fragmentation_pct"] = s.heapFree ? 100 - (uint32_t)((uint64_t)s.heapLargest * 100 / s.heapFree) : 0;
+    details["psram_free"] = s.psramFree;
+    details["psram_largest_block"] = s.psramLargest;
+    details["psram_min_free_ever"] = s.psramMinEver;
+
+    // Smallest internal largest-block per HEAP_TREND_INTERVAL_MS, oldest first
+    JsonArray trend = details.createNestedArray("heap_largest_trend");
+    for (uint8_t i = 0; i < s.trendCount; i++)
+        trend.add(s.trend[i]);
+
+    JsonObject tags = details.createNestedObject("tags");
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++)
     {
-        if (doc && doc->containsKey("mode"))
-        {
-            String mode = (*doc)["mode"].as<String>();
-            if (mode == "ml")
-            {
-                if (!mlDetector.isReady() && !useMLDetection)
-                {
-                    Serial.println("Initializing ML detector on demand...");
-                    if (mlDetector.init())
-                    {
-                        useMLDetection = true;
-                        Serial.println("Switched to ML detection");
-                        mqttManager->publishStatus("detection_mode_ml");
-                    }
-                    else
-                    {
-                        Serial.println("ML detector init failed, staying on heuristic");
-                        mqttManager->publishStatus("detection_mode_ml_failed");
-                    }
-                }
-                else
-                {
-                    useMLDetection = true;
-                    Serial.println("Switched to ML detection");
-                    mqttManager->publishStatus("detection_mode_ml");
-                }
-            }
-            else
-            {
-                useMLDetection = false;
-                Serial.println("Switched to heuristic detection");
-                mqttManager->publishStatus("detection_mode_heuristic");
-            }
-        }
+        HeapTagCounts counts = HeapTracker::tagCounts((HeapTag)i);
+        JsonObject tag = tags.createNestedObject(HeapTracker::tagName((HeapTag)i));
+        tag["bytes"] = counts.bytes;
+        tag["peak"] = counts.peak;
+        tag["allocs"] = counts.allocs;
+        tag["failures"] = counts.failures;
     }
-    else if (command == "led_strip_test")
+}
+
+// light_sleep_idle: sleep through hybrid INT idle or an interrupt session
+// with nothing queued, instead of spinning loop(). Not with Serial Studio
+// attached (USB CDC drops during light sleep).
+void idleLightSleep()
+{
+    if (!lightSleep.isEnabled() || serialStudioEnabled || calibrationManager.isActive())
+        return;
+
+    bool hybridIdle = sensorManager.isCollecting() && sensorManager.isHybridIdle();
+    bool interruptIdle = interruptManager.isMonitoring() && !interruptManager.hasEvents();
+    if (!hybridIdle && !interruptIdle)
+        return;
+
+    // Let a direction on the LEDs, a pending capture and queued uploads finish
+    if (liveDebugCapturePending || captureUploader.pending() > 0 ||
+        (lastDetectionTime != 0 && millis() - lastDetectionTime < LIGHT_SLEEP_QUIET_MS))
+        return;
+
+    // Network traffic in flight: sleeping stalls TCP (OTA download timeouts)
+    if (otaUpdater.isBusy())
+        return;
+    if (outbox.pending() > 0)
+        return;
+    if (!statusPublisher.isIdle())
+        return;
+
+    LightSleepWake wake = lightSleep.sleep();
+    if (!wake.slept)
+        return;
+
+    SessionSummary &summary = sessionManager.getSessionSummary();
+    summary.light_sleeps++;
+    summary.light_sleep_ms_total += wake.sleptUs / 1000;
+
+    // The edge that woke us may never reach the ISRs: hand the lines over
+    if (wake.lowBoards != 0)
     {
-        if (sessionManager.getState() != IDLE)
-        {
-            Serial.println("[LEDTest] Refused: session not IDLE");
-            mqttManager->publishStatus("led_strip_test_refused_busy");
-        }
-        else
-        {
-            uint16_t ledCount = 90;
-            if (doc && (*doc)["led_count"].is<int>())
-            {
-                int requested = (*doc)["led_count"].as<int>();
-                if (requested > 0)
-                    ledCount = (uint16_t)requested;
-            }
-            Serial.printf("[LEDTest] Running strip test with %u LEDs\n", ledCount);
-            mqttManager->publishStatus("led_strip_test_started");
-            ledController.runStripTest(ledCount);
-            mqttManager->publishStatus("led_strip_test_complete");
-        }
+        if (hybridIdle)
+            sensorManager.wakeFromSleep(wake.lowBoards, wake.wakeUs);
+        if (interruptIdle)
+            interruptManager.wakeBoards(wake.lowBoards);
     }
-    else if (command == "reboot")
+}
+
+// Status message plus ML model / tensor arena fields while ML detection is in use,
+// so the arena can be sized from the reported high-water mark
+bool postStatusWithML(const char *status)
+{
+    return statusPublisher.post(status, addMLStatus);
+}
+
+// Runs on the status task at send time
+void addMLStatus(JsonDocument &ml)
+{
+    if (!useMLDetection || mlDetector.getArenaUsedBytes() == 0)
+        return;
+
+    MLInferenceStats stats = mlDetector.getInferenceStats();
+    ml["ml_model_version"] = mlDetector.getModelVersion();
+    ml["ml_model_source"] = mlDetector.isModelFromPartition() ? "partition" : "builtin";
+    ml["ml_model_bytes"] = mlDetector.getModelSize();
+    ml["ml_model_int8"] = mlDetector.isInt8Model();
+    ml["ml_arena_used_bytes"] = mlDetector.getArenaUsedBytes();
+    ml["ml_arena_size"] = mlDetector.getArenaSize();
+    ml["ml_arena_region"] = mlDetector.isArenaInternal() ? "internal" : "psram";
+    ml["ml_inference_mode"] = MLDetector::inferenceModeName(mlDetector.getInferenceMode());
+    ml["ml_stride_ms"] = mlDetector.getStrideMs();
+    ml["ml_inference_count"] = stats.count;
+    ml["ml_inference_avg_us"] = stats.avgUs;
+    ml["ml_inference_max_us"] = stats.maxUs;
+    ml["ml_prepare_avg_us"] = stats.prepareAvgUs;
+    ml["ml_windows_skipped"] = stats.skippedWindows;
+
+    if (ensembleDetection)
     {
-        display.showMessage("Rebooting...", TFT_YELLOW);
-        delay(1000);
-        ESP.restart();
+        EnsembleStats ensemble = detectionTask.getEnsembleStats();
+        ml["ensemble_heuristic"] = ensemble.heuristic;
+        ml["ensemble_ml_confirmed"] = ensemble.mlConfirmed;
+        ml["ensemble_ml_overruled"] = ensemble.mlOverruled;
+        ml["ensemble_ml_rejected"] = ensemble.mlRejected;
+        ml["ensemble_ml_unavailable"] = ensemble.mlUnavailable;
     }
 }
 
-void loop()
+// Detector and LED stages of a detection just shown; the publish stages
+// are recorded by the status task once the MQTT message is out
+void recordShownLatency(const DetectionEvent &event)
+{
+    uint32_t ledUs = micros();
+    const DetectionResult &result = event.result;
+    LatencyTracker::record(event.ml, LatencyStage::WAVE, result.firstCrossingUs, result.waveCompleteUs);
+    LatencyTracker::record(event.ml, LatencyStage::DECISION, result.waveCompleteUs, event.decisionUs);
+    LatencyTracker::record(event.ml, LatencyStage::LED, event.decisionUs, ledUs);
+}
+
+// One pass of loop() over device state; runs with the command state lock
+// held, so a command handler never interleaves with it
+void loopStep()
 {
     static int buttonState2 = HIGH;
     static unsigned long lastSampleUpdate = 0;
     static unsigned long button1HoldStart = 0;
     static bool button1WasPressed = false;
+    static bool calibrationHoldsUI = false;
 
     int currentButton1 = digitalRead(BUTTON_1);
     int currentButton2 = digitalRead(BUTTON_2);
@@ -1359,28 +2392,29 @@ void loop()
     // If calibration is active, handle it exclusively
     if (calibrationManager.isActive())
     {
+        // The UI lock is taken and released here: it belongs to this task,
+        // whichever task started calibration
+        if (!calibrationHoldsUI)
+        {
+            ui.lock();
+            calibrationHoldsUI = true;
+        }
         calibrationManager.update();
 
-        // After calibration completes, restore normal display
+        // After calibration completes, hand the display back and restore it
         if (!calibrationManager.isActive())
         {
-            display.showSessionScreen();
-            display.setSensorConfig(&currentConfig);
+            ui.unlock();
+            calibrationHoldsUI = false;
+            ui.showSessionScreen();
+            ui.setSensorConfig(&currentConfig);
 
             // Set sensor config in calibration manager for next time
-            uint8_t mp = currentConfig.multi_pulse.toInt();
-            if (mp == 0)
-                mp = 1;
-            uint8_t it = currentConfig.integration_time.substring(0, 1).toInt();
-            if (it == 0)
-                it = 1;
-            uint8_t led = currentConfig.led_current.toInt();
-            if (led == 0)
-                led = 200;
-            calibrationManager.setSensorConfig(mp, it, led);
+            CalibrationSettings settings = calibrationSettings();
+            calibrationManager.setSensorConfig(settings.multi_pulse, settings.integration_time,
+                                               settings.led_current);
         }
 
-        delay(10);
         return; // Skip normal loop during calibration
     }
 
@@ -1401,24 +2435,20 @@ void loop()
             if (sessionManager.getState() == IDLE)
             {
                 // Set sensor config before starting
-                uint8_t mp = currentConfig.multi_pulse.toInt();
-                if (mp == 0)
-                    mp = 1;
-                uint8_t it = currentConfig.integration_time.substring(0, 1).toInt();
-                if (it == 0)
-                    it = 1;
-                uint8_t led = currentConfig.led_current.toInt();
-                if (led == 0)
-                    led = 200;
-                calibrationManager.setSensorConfig(mp, it, led);
-
-                calibrationManager.startCalibration();
+                CalibrationSettings settings = calibrationSettings();
+                calibrationManager.setSensorConfig(settings.multi_pulse, settings.integration_time,
+                                                   settings.led_current);
+
+                // Calibration draws on the display itself until it ends
+                ui.lock();
+                calibrationManager.startCalibration(parallelCalibration());
+                ui.unlock();
             }
             else
             {
-                display.showMessage("Stop collection first!", TFT_RED);
-                delay(1500);
-                display.setDisplayState(DISPLAY_IDLE);
+                ui.showMessage("Stop collection first!", TFT_RED);
+                ui.hold(1500);
+                ui.setDisplayState(DISPLAY_IDLE);
             }
 
             button1WasPressed = false; // Reset to prevent re-trigger
@@ -1435,17 +2465,87 @@ void loop()
     if (currentButton2 == LOW && buttonState2 == HIGH)
     {
         Serial.println("RIGHT BUTTON - Restarting...");
-        display.showMessage("Restarting...", TFT_YELLOW);
+        ui.showMessage("Restarting...", TFT_YELLOW);
         delay(500);
         ESP.restart();
     }
     buttonState2 = currentButton2;
 
-    // Check network connection
-    networkManager.checkConnection();
+    // WiFi/MQTT reconnects run on the connection supervisor task
+    if (connectionStateChanged)
+    {
+        connectionStateChanged = false;
+        if (!serialStudioEnabled)
+        {
+            Serial.printf("Network: %s\n", ConnectionSupervisor::stateName(connectionSupervisor.getState()));
+        }
+    }
+    if (configRefreshDue)
+    {
+        configRefreshDue = false;
+        startConfigRefresh();
+    }
+
+    // Detection runs on DetectionTask while Play / Live Debug collect
+    bool detectionWanted = sessionManager.getState() == COLLECTING &&
+                           ((playModeActive && currentMode == DeviceMode::PLAY) ||
+                            (liveDebugActive && currentMode == DeviceMode::LIVE_DEBUG));
+    detectionTask.setActive(detectionWanted, activeDetectorMode());
+
+    // Keep the stored baselines current; NVS is written only when they drift
+    if (detectionWanted && activeDetectorMode() != DetectorMode::ML && calibrationStore.driftCheckDue())
+    {
+        SensorBaseline live[NUM_SENSORS];
+        SensorMask liveMask = 0;
+        {
+            DetectionTask::Guard guard(detectionTask);
+            for (uint8_t i = 0; i < NUM_SENSORS; i++)
+            {
+                if (directionDetector.getBaseline(i, live[i]))
+                    liveMask |= (1 << i);
+            }
+        }
+        calibrationStore.checkDrift(live, liveMask, sensorManager, calibrationSettings());
+    }
+
+    // Drift telemetry: only when the auto calibrator moved something
+    static uint32_t reportedAdjustments = 0;
+    static unsigned long lastDriftReport = 0;
+    if (autoCalibrator.getAdjustmentCount() != reportedAdjustments &&
+        millis() - lastDriftReport >= AUTO_CAL_REPORT_INTERVAL_MS)
+    {
+        reportedAdjustments = autoCalibrator.getAdjustmentCount();
+        lastDriftReport = millis();
+        statusPublisher.post("calibration_drift", addAutoCalibration);
+    }
+
+    // Bus health events from the sensor task (recoveries, quarantines)
+    I2CHealthEvent healthEvent;
+    while (sensorManager.popHealthEvent(healthEvent))
+    {
+        static const char *const HEALTH_STATUS[] = {"i2c_bus_recovered", "i2c_bus_recovery_failed",
+                                                    "sensor_quarantined", "sensor_restored"};
+        lastHealthEvent = healthEvent;
+        statusPublisher.post(HEALTH_STATUS[(uint8_t)healthEvent.type], addI2CHealth);
+    }
+
+    // Shared clock; array detections merged by the coordinator (HoopArray task)
+    TimeSync::poll();
+    if (hoopArray.takeNewDetections())
+        statusPublisher.post("array_detections", addArrayDetections);
+
+    // Heap accounting: sampled every HEAP_SAMPLE_INTERVAL_MS, reported less often
+    HeapTracker::sample();
+    static unsigned long lastHeapReport = 0;
+    if (millis() - lastHeapReport >= HEAP_REPORT_INTERVAL_MS)
+    {
+        lastHeapReport = millis();
+        statusPublisher.post("heap_stats", addHeapStats);
+    }
 
-    // Handle MQTT
-    mqttManager->loop();
+    // Task runtime / stack sampling; core loads drive the CPU gauge
+    if (TaskMonitor::sample())
+        ui.updateCpuLoad(TaskMonitor::coreLoad(0), TaskMonitor::coreLoad(1));
 
     // Process sensor data queue if collecting
     if (sessionManager.getState() == COLLECTING)
@@ -1480,36 +2580,24 @@ void loop()
             if (sessionManager.getDuration() >= 30000)
             {
                 Serial.println("WARNING: Maximum interrupt session duration reached (30s), auto-stopping...");
-                display.showMessage("Max duration!", TFT_ORANGE);
-                delay(1000);
+                ui.showMessage("Max duration!", TFT_ORANGE);
+                ui.hold(1000);
 
-                // Auto-stop
+                // Auto-stop; the upload runs on the command task
                 interruptManager.stopMonitoring();
                 sessionManager.stopSession();
-                display.setDisplayState(DISPLAY_UPLOADING);
-
-                if (dataTransmitter->transmitSession(sessionManager, &currentConfig))
-                {
-                    mqttManager->publishStatus("upload_complete_auto_stopped");
-                    display.setDisplayState(DISPLAY_SUCCESS);
-                    delay(2000);
-                    sessionManager.clearBuffer();
-                    display.setDisplayState(DISPLAY_IDLE);
-                }
-                else
-                {
-                    mqttManager->publishStatus("upload_failed");
-                    display.setDisplayState(DISPLAY_ERROR);
-                    delay(2000);
-                    sessionManager.clearBuffer();
-                    display.setDisplayState(DISPLAY_IDLE);
-                }
+                ui.setDisplayState(DISPLAY_UPLOADING);
+                finalizeDebugSession();
+                queueSessionUpload("upload_complete_auto_stopped");
             }
         }
         else
         {
             // POLLING MODE: Regular proximity processing
-            sessionManager.processQueue();
+            {
+                PROFILE_SCOPE(ProfileSpan::PROCESS_QUEUE);
+                sessionManager.processQueue();
+            }
 
             // Serial Studio: emit CSV frames for new readings
             serialStudioOutput.update();
@@ -1518,109 +2606,73 @@ void loop()
         // PLAY MODE: Run direction detection on collected data
         if (playModeActive && currentMode == DeviceMode::PLAY)
         {
-            // Update LED animation (handles fade-out after detection)
-            bool animating = ledController.update();
-
             // Debug: log buffer status periodically (suppressed when Serial Studio active)
             static unsigned long lastPlayDebug = 0;
             if (!serialStudioEnabled && millis() - lastPlayDebug > 2000)
             {
                 lastPlayDebug = millis();
-                bool detectorReady = useMLDetection ? mlDetector.isReady() : directionDetector.isReady();
-                Serial.printf("[PLAY] Buffer: %d samples, Detector(%s): %s\n",
+                bool detectorReady = activeDetectorMode() == DetectorMode::ML ? mlDetector.isReady() : directionDetector.isReady();
+                Serial.printf("[PLAY] Buffer: %d frames, Detector(%s): %s, fed %lu (%lu dropped)\n",
                               sessionManager.getDataCount(),
-                              useMLDetection ? "ML" : "heuristic",
-                              detectorReady ? "READY" : "establishing baseline...");
+                              detectionModeName(),
+                              detectorReady ? "READY" : "establishing baseline...",
+                              detectionTask.getFramesProcessed(), detectionTask.getDroppedFrames());
             }
 
-            // Check cooldown between detections
-            unsigned long now = millis();
-            bool inCooldown = (lastDetectionTime > 0) && (now - lastDetectionTime < DETECTION_COOLDOWN);
-
-            if (!inCooldown)
+            // Detections arrive from DetectionTask; results inside the
+            // cooldown are dropped. With multi_transit the heuristic detector
+            // consumes each transit itself: no cooldown and no reset, so
+            // back-to-back transits are all reported.
+            bool pipelined = pipelinedDetection();
+            DetectionEvent event;
+            while (detectionTask.pollResult(event))
             {
-                // Feed new readings to the detector
-                auto &buffer = sessionManager.getDataBuffer();
-                static size_t lastProcessedIndex = 0;
-
-                // Add new readings since last check
-                size_t bufferSize = buffer.size();
-                for (size_t i = lastProcessedIndex; i < bufferSize; i++)
-                {
-                    if (useMLDetection)
-                        mlDetector.addReading(buffer[i]);
-                    else
-                        directionDetector.addReading(buffer[i]);
-                }
-                // Flush the last reading to ensure it's processed
-                if (useMLDetection)
-                    mlDetector.flushReading();
-                else
-                    directionDetector.flushReading();
-                lastProcessedIndex = bufferSize;
-
-                // Check for detection
-                bool detected = useMLDetection ? mlDetector.hasDetection() : directionDetector.hasDetection();
-                if (detected)
-                {
-                    DetectionResult result = useMLDetection ? mlDetector.getResult() : directionDetector.getResult();
-                    serialStudioOutput.cacheDetection(result);
+                unsigned long now = millis();
+                if (!pipelined && (lastDetectionTime > 0) && (now - lastDetectionTime < DETECTION_COOLDOWN))
+                    continue;
 
-                    // Detection successful!
-                    if (!serialStudioEnabled)
-                        Serial.printf("DETECTION [%s]: %s (confidence: %.2f)\n",
-                                      useMLDetection ? "ML" : "heuristic",
-                                      DirectionDetector::directionToString(result.direction),
-                                      result.confidence);
-
-                    // Show on LEDs
-                    ledController.showDirection(result.direction, 3000);
-
-                    // Show on display
-                    if (result.direction == Direction::A_TO_B)
-                        display.showMessage("A -> B", TFT_BLUE);
-                    else if (result.direction == Direction::B_TO_A)
-                        display.showMessage("B -> A", TFT_ORANGE);
-                    else
-                        display.showMessage("Unknown", TFT_RED);
-
-                    // Publish detection result
-                    String statusMsg = "detection_" + String(DirectionDetector::directionToString(result.direction));
-                    mqttManager->publishStatus(statusMsg.c_str());
-
-                    // Reset for next detection (clear buffer without changing state)
-                    lastDetectionTime = now;
-                    if (useMLDetection)
-                        mlDetector.reset();
-                    else
-                        directionDetector.reset();
-                    lastProcessedIndex = 0;
-                    buffer.clear();
-                    serialStudioOutput.resetIndex();
-                    if (!serialStudioEnabled)
-                        Serial.println("Detection complete, buffer cleared for next event");
-                }
+                const DetectionResult &result = event.result;
+                serialStudioOutput.cacheDetection(result);
 
-                // Limit buffer size to prevent memory issues in play mode.
-                // Only clear the session buffer — detectors maintain their own
-                // internal state (ring buffer for ML, wave state for heuristic)
-                // and must NOT be reset here or they lose accumulated data.
-                if (bufferSize > 500)
+                // Detection successful!
+                if (!serialStudioEnabled)
+                    Serial.printf("DETECTION [%s]: %s (confidence: %.2f)\n",
+                                  event.ml ? "ML" : "heuristic",
+                                  DirectionDetector::directionToString(result.direction),
+                                  result.confidence);
+
+                // Show on LEDs
+                ui.showDirection(result.direction, 3000);
+                recordShownLatency(event);
+
+                // Show on display
+                if (result.direction == Direction::A_TO_B)
+                    ui.showMessage("A -> B", TFT_BLUE);
+                else if (result.direction == Direction::B_TO_A)
+                    ui.showMessage("B -> A", TFT_ORANGE);
+                else
+                    ui.showMessage("Unknown", TFT_RED);
+
+                // Publish detection result (queued; sent by the status task)
+                statusPublisher.postDetection(DirectionDetector::directionToString(result.direction),
+                                              result.confidence, event.ml,
+                                              result.firstCrossingUs, event.decisionUs);
+
+                // Reset wave state for the next detection (baselines are kept);
+                // a pipelined detector has consumed this transit already.
+                // The frame stream itself is never cut.
+                lastDetectionTime = millis();
+                if (!pipelined)
                 {
+                    detectionTask.resetDetectors();
                     if (!serialStudioEnabled)
-                        Serial.printf("Buffer overflow prevention: clearing %d samples\n", bufferSize);
-                    if (!useMLDetection)
-                        directionDetector.reset();
-                    lastProcessedIndex = 0;
-                    buffer.clear();
-                    serialStudioOutput.resetIndex();
+                        Serial.println("Detection complete, detector reset for next event");
                 }
             }
-            else if (!ledController.isAnimating() &&
-                     (useMLDetection ? mlDetector.isReady() : directionDetector.isReady()))
-            {
-                ledController.showReady();
-            }
+
+            bool inCooldown = !pipelined && (lastDetectionTime > 0) && (millis() - lastDetectionTime < DETECTION_COOLDOWN);
+            // Ready pulse (the UI task animates it once the direction has faded)
+            ui.setLedReady(!inCooldown && (activeDetectorMode() == DetectorMode::ML ? mlDetector.isReady() : directionDetector.isReady()));
 
             // No timeout in play mode - it runs until stopped
         }
@@ -1628,266 +2680,111 @@ void loop()
         {
             // LIVE DEBUG MODE: Detection with event capture
 
-            // Update LED animation (handles fade-out after detection)
-            ledController.update();
-
             // Debug: log buffer status periodically (suppressed when Serial Studio active)
             static unsigned long lastLiveDebugLog = 0;
             if (!serialStudioEnabled && millis() - lastLiveDebugLog > 2000)
             {
                 lastLiveDebugLog = millis();
-                bool detectorReady = useMLDetection ? mlDetector.isReady() : directionDetector.isReady();
-                Serial.printf("[LIVE_DEBUG] Buffer: %d samples, Detector(%s): %s\n",
+                bool detectorReady = activeDetectorMode() == DetectorMode::ML ? mlDetector.isReady() : directionDetector.isReady();
+                Serial.printf("[LIVE_DEBUG] Buffer: %d frames, Detector(%s): %s, fed %lu (%lu dropped)\n",
                               sessionManager.getDataCount(),
-                              useMLDetection ? "ML" : "heuristic",
-                              detectorReady ? "READY" : "establishing baseline...");
+                              detectionModeName(),
+                              detectorReady ? "READY" : "establishing baseline...",
+                              detectionTask.getFramesProcessed(), detectionTask.getDroppedFrames());
             }
 
-            // Check cooldown between detections
-            unsigned long now = millis();
-            bool inCooldown = (lastDetectionTime > 0) && (now - lastDetectionTime < DETECTION_COOLDOWN);
-
-            if (!inCooldown)
+            // Pending detection capture: cut it once the trailing edge is in
+            if (liveDebugCapturePending && (long)(millis() - liveDebugCaptureDue) >= 0)
             {
-                // Feed new readings to the detector
-                auto &buffer = sessionManager.getDataBuffer();
-                static size_t lastLiveDebugIndex = 0;
+                queueLiveDebugCapture("detection", pendingCaptureDirection, pendingCaptureConfidence,
+                                      captureWindowStart(pendingCaptureTriggerUs, currentConfig.capture_pre_trigger_ms),
+                                      "live_debug_detection_captured");
 
-                // Add new readings since last check
-                size_t bufferSize = buffer.size();
-                for (size_t i = lastLiveDebugIndex; i < bufferSize; i++)
-                {
-                    if (useMLDetection)
-                        mlDetector.addReading(buffer[i]);
-                    else
-                        directionDetector.addReading(buffer[i]);
-                }
-                if (useMLDetection)
-                    mlDetector.flushReading();
-                else
-                    directionDetector.flushReading();
-                lastLiveDebugIndex = bufferSize;
+                detectionTask.resetDetectors();
+            }
 
-                // Check for detection
-                bool detected = useMLDetection ? mlDetector.hasDetection() : directionDetector.hasDetection();
-                if (detected)
-                {
-                    DetectionResult result = useMLDetection ? mlDetector.getResult() : directionDetector.getResult();
-                    serialStudioOutput.cacheDetection(result);
+            // Detections arrive from DetectionTask; results while a capture
+            // is pending or inside the cooldown are dropped
+            DetectionEvent event;
+            while (detectionTask.pollResult(event))
+            {
+                unsigned long now = millis();
+                if (liveDebugCapturePending ||
+                    ((lastDetectionTime > 0) && (now - lastDetectionTime < DETECTION_COOLDOWN)))
+                    continue;
 
-                    if (!serialStudioEnabled)
-                        Serial.printf("[LIVE_DEBUG] DETECTION [%s]: %s (confidence: %.2f)\n",
-                                      useMLDetection ? "ML" : "heuristic",
-                                      DirectionDetector::directionToString(result.direction),
-                                      result.confidence);
-
-                    // LED feedback (same as Play)
-                    ledController.showDirection(result.direction, 3000);
-
-                    // Display feedback
-                    if (result.direction == Direction::A_TO_B)
-                        display.showMessage("A -> B", TFT_BLUE);
-                    else if (result.direction == Direction::B_TO_A)
-                        display.showMessage("B -> A", TFT_ORANGE);
-                    else
-                        display.showMessage("Unknown", TFT_RED);
-
-                    // === CAPTURE FLOW: Delay → Pause → Extract → Transmit → Resume ===
-
-                    // 1. Post-detection delay: keep collecting so we capture the trailing edge
-                    //    Sensor task runs on Core 0, so delay() on Core 1 lets it continue
-                    if (!serialStudioEnabled)
-                        Serial.printf("[LIVE_DEBUG] Post-detection delay: %lums\n", POST_DETECTION_DELAY_MS);
-                    delay(POST_DETECTION_DELAY_MS);
-
-                    // 2. Stop sensor polling
-                    sensorManager.stopCollection();
-                    delay(50); // Let queue drain
-
-                    // Process any remaining queued readings
-                    sessionManager.processQueue();
-
-                    // 3. Show transmitting status
-                    display.showMessage("Transmitting...", TFT_MAGENTA);
-
-                    // 4. Calculate window using actual timestamps in the buffer
-                    //    Capture from (detectionTime - DETECTION_WINDOW_MS) to end of buffer
-                    size_t actualBufferSize = buffer.size();
-                    size_t startIdx = 0;
-
-                    if (actualBufferSize > 0)
-                    {
-                        unsigned long latestTs = buffer[actualBufferSize - 1].timestamp_us;
-                        unsigned long totalWindowUs = (DETECTION_WINDOW_MS + POST_DETECTION_DELAY_MS) * 1000UL; // Convert ms to us
-                        unsigned long cutoffTs = (latestTs > totalWindowUs) ? latestTs - totalWindowUs : 0;
-
-                        // Binary search for the first reading at or after cutoffTs
-                        size_t lo = 0, hi = actualBufferSize;
-                        while (lo < hi)
-                        {
-                            size_t mid = lo + (hi - lo) / 2;
-                            if (buffer[mid].timestamp_us < cutoffTs)
-                                lo = mid + 1;
-                            else
-                                hi = mid;
-                        }
-                        startIdx = lo;
-                    }
-
-                    size_t captureCount = actualBufferSize - startIdx;
-                    if (!serialStudioEnabled)
-                        Serial.printf("[LIVE_DEBUG] Capture: %d readings from idx %d (buffer has %d)\n",
-                                      captureCount, startIdx, actualBufferSize);
-
-                    // 5. Session Confirmation: finalize summary for this capture
-                    {
-                        uint8_t activeCnt = 0;
-                        for (const auto &m : sessionManager.getSensorMetadata())
-                        {
-                            if (m.active)
-                                activeCnt++;
-                        }
-                        // Use capture duration for summary, not full session duration
-                        unsigned long capDur = (captureCount > 0)
-                                                   ? (buffer[actualBufferSize - 1].timestamp_us - buffer[startIdx].timestamp_us) / 1000
-                                                   : 0;
-                        sessionManager.getSessionSummary().duration_ms = capDur;
-                        sessionManager.finalizeSessionSummary(&currentConfig, activeCnt);
-                    }
-
-                    // 6. Transmit the capture (binary-packed single message — data + summary)
-                    const char *dirStr;
-                    if (result.direction == Direction::A_TO_B)
-                        dirStr = "a_to_b";
-                    else if (result.direction == Direction::B_TO_A)
-                        dirStr = "b_to_a";
-                    else
-                        dirStr = "unknown";
-                    String captureSessionId = dataTransmitter->transmitLiveDebugCaptureBinary(
-                        buffer, startIdx, captureCount,
-                        "detection", dirStr, result.confidence,
-                        sessionManager.getSessionSummary(),
-                        &currentConfig);
-
-                    if (captureSessionId.length() > 0)
-                    {
-                        if (!serialStudioEnabled)
-                            Serial.println("[LIVE_DEBUG] Detection capture transmitted successfully");
-                        mqttManager->publishStatus("live_debug_detection_captured");
-                    }
-                    else
-                    {
-                        if (!serialStudioEnabled)
-                            Serial.println("[LIVE_DEBUG] ERROR: Detection capture transmission failed!");
-                        mqttManager->publishStatus("live_debug_capture_failed");
-                    }
-
-                    // 7. Clear buffer and reset detector
-                    lastDetectionTime = millis();
-                    if (useMLDetection)
-                        mlDetector.reset();
-                    else
-                        directionDetector.reset();
-                    lastLiveDebugIndex = 0;
-                    buffer.clear();
-                    serialStudioOutput.resetIndex();
-
-                    // 8. Reset summary for next capture and resume sensor polling
-                    sessionManager.getSessionSummary().reset();
-                    sensorManager.startCollection(sessionManager.getQueue(), &sessionManager.getSessionSummary());
-                    display.showMessage("Ready", TFT_MAGENTA);
-                    if (!serialStudioEnabled)
-                        Serial.println("[LIVE_DEBUG] Resumed — waiting for next event");
-                }
+                const DetectionResult &result = event.result;
+                serialStudioOutput.cacheDetection(result);
 
-                // Buffer overflow prevention (higher cap than Play)
-                if (bufferSize > LIVE_DEBUG_BUFFER_CAP)
-                {
-                    if (!serialStudioEnabled)
-                        Serial.printf("[LIVE_DEBUG] Buffer overflow prevention: clearing %d samples\n", bufferSize);
-                    if (useMLDetection)
-                        mlDetector.reset();
-                    else
-                        directionDetector.reset();
-                    lastLiveDebugIndex = 0;
-                    buffer.clear();
-                    serialStudioOutput.resetIndex();
-                }
-            }
-            else if (!ledController.isAnimating() &&
-                     (useMLDetection ? mlDetector.isReady() : directionDetector.isReady()))
-            {
-                ledController.showReady();
+                if (!serialStudioEnabled)
+                    Serial.printf("[LIVE_DEBUG] DETECTION [%s]: %s (confidence: %.2f)\n",
+                                  event.ml ? "ML" : "heuristic",
+                                  DirectionDetector::directionToString(result.direction),
+                                  result.confidence);
+
+                // LED feedback (same as Play)
+                ui.showDirection(result.direction, 3000);
+                recordShownLatency(event);
+
+                // Display feedback
+                if (result.direction == Direction::A_TO_B)
+                    ui.showMessage("A -> B", TFT_BLUE);
+                else if (result.direction == Direction::B_TO_A)
+                    ui.showMessage("B -> A", TFT_ORANGE);
+                else
+                    ui.showMessage("Unknown", TFT_RED);
+
+                // === CAPTURE FLOW: Tail → Snapshot → Queue (sampling never pauses) ===
+                // The capture is cut once capture_post_trigger_ms of trailing-edge
+                // data has arrived, then uploaded in the background.
+                if (result.direction == Direction::A_TO_B)
+                    pendingCaptureDirection = "a_to_b";
+                else if (result.direction == Direction::B_TO_A)
+                    pendingCaptureDirection = "b_to_a";
+                else
+                    pendingCaptureDirection = "unknown";
+                pendingCaptureConfidence = result.confidence;
+                pendingCaptureTriggerUs = event.frameTimestampUs;
+                liveDebugCaptureDue = millis() + currentConfig.capture_post_trigger_ms;
+                liveDebugCapturePending = true;
+                lastDetectionTime = millis();
             }
 
+            bool inCooldown = liveDebugCapturePending ||
+                              ((lastDetectionTime > 0) && (millis() - lastDetectionTime < DETECTION_COOLDOWN));
+            // Ready pulse (the UI task animates it once the direction has faded)
+            ui.setLedReady(!inCooldown && (activeDetectorMode() == DetectorMode::ML ? mlDetector.isReady() : directionDetector.isReady()));
+
             // No timeout in live debug mode - runs until stopped
         }
         else
         {
             // DEBUG MODE: Standard collection behavior
 
-            // Check for maximum session duration (30 seconds safety limit)
-            if (sessionManager.getDuration() >= 30000) // 30 seconds in milliseconds
+            // Check for maximum session duration (30 s in memory, longer when
+            // spilling to flash - or sooner if the spill file fills the flash)
+            if (sessionManager.getDuration() >= sessionManager.getMaxDuration() || sessionManager.isSpillFull())
             {
-                Serial.println("WARNING: Maximum session duration reached (30s), auto-stopping...");
-                display.showMessage("Max duration reached!", TFT_ORANGE);
-                delay(1000);
+                Serial.printf("WARNING: Maximum session %s reached (%lus), auto-stopping...\n",
+                              sessionManager.isSpillFull() ? "flash space" : "duration",
+                              sessionManager.getDuration() / 1000);
+                ui.showMessage("Max duration reached!", TFT_ORANGE);
+                ui.hold(1000);
 
-                // Auto-stop collection
+                // Auto-stop collection; the upload runs on the command task
                 sensorManager.stopCollection();
                 sessionManager.stopSession();
-                display.setDisplayState(DISPLAY_UPLOADING);
-
-                // Session Confirmation: finalize summary
-                {
-                    uint8_t activeCnt = 0;
-                    for (const auto &m : sessionManager.getSensorMetadata())
-                    {
-                        if (m.active)
-                            activeCnt++;
-                    }
-                    sessionManager.finalizeSessionSummary(&currentConfig, activeCnt);
-                    dataTransmitter->setSessionSummary(&sessionManager.getSessionSummary());
-                }
-
-                // Transmit data
-                if (dataTransmitter->transmitSession(sessionManager, &currentConfig))
-                {
-                    // Session Confirmation: send summary
-                    dataTransmitter->transmitSessionSummary(
-                        sessionManager.getSessionSummary(),
-                        sessionManager.getSessionId(),
-                        mqttManager->getDeviceId());
-
-                    mqttManager->publishStatus("upload_complete_auto_stopped");
-                    display.setDisplayState(DISPLAY_SUCCESS);
-                    delay(2000);
-                    dataTransmitter->setSessionSummary(nullptr);
-                    sessionManager.clearBuffer();
-                    display.setDisplayState(DISPLAY_IDLE);
-                }
-                else
-                {
-                    Serial.println("ERROR: Auto-stop session transmission failed!");
-                    mqttManager->publishStatus("upload_failed");
-                    display.setDisplayState(DISPLAY_ERROR);
-                    display.showMessage("Upload failed - Restarting...", TFT_RED);
-                    delay(3000);
-                    dataTransmitter->setSessionSummary(nullptr);
-                    sessionManager.clearBuffer();
-
-                    // Restart device to recover from potential I2C/sensor issues
-                    Serial.println("Restarting device to recover from upload failure...");
-                    ESP.restart();
-                }
+                ui.setDisplayState(DISPLAY_UPLOADING);
+                finalizeDebugSession();
+                queueSessionUpload("upload_complete_auto_stopped");
             }
 
             // Update sample count on display every second
             if (millis() - lastSampleUpdate > 1000)
             {
                 lastSampleUpdate = millis();
-                int sampleCount = sessionManager.getDataCount();
-                display.updateSampleCount(sampleCount);
+                int sampleCount = sessionManager.getReadingCount();
+                ui.updateSampleCount(sampleCount);
 
                 if (!serialStudioEnabled)
                 {
@@ -1910,7 +2807,10 @@ void loop()
     {
         lastPowerUpdate = millis();
         powerMonitor.update();
-        display.updatePowerStatus(powerMonitor.getVoltage(), powerMonitor.getCurrentMA());
+        ui.updatePowerStatus(powerMonitor.getVoltage(), powerMonitor.getCurrentMA());
+        if (powerProfiles.update(powerMonitor.getVoltage(), powerMonitor.getCurrentMA(),
+                                 bq24195PowerGood(), millis()))
+            applyPowerProfile();
     }
 
     // Send periodic status updates
@@ -1920,7 +2820,7 @@ void loop()
 
         if (mqttManager->isConnected())
         {
-            mqttManager->publishStatus("online");
+            postStatusWithML("online");
             if (!serialStudioEnabled)
             {
                 Serial.print("Status update sent. Session state: ");
@@ -1931,7 +2831,7 @@ void loop()
                     break;
                 case COLLECTING:
                     Serial.print("COLLECTING (");
-                    Serial.print(sessionManager.getDataCount());
+                    Serial.print(sessionManager.getReadingCount());
                     Serial.println(" samples)");
                     break;
                 case UPLOADING:
@@ -1942,5 +2842,27 @@ void loop()
         }
     }
 
+    // Failed session upload: next attempt, again on the command task
+    if (sessionUploadRetryAt != 0 && (long)(millis() - sessionUploadRetryAt) >= 0)
+        submitSessionUpload();
+
+    // Light sleep while the sensors wait for an INT line (light_sleep_idle)
+    idleLightSleep();
+}
+
+void loop()
+{
+    // Handle MQTT (commands are queued, outbox drains while connected).
+    // Outside the state lock: keeps going while a command runs.
+    if (!calibrationManager.isActive())
+        mqttManager->loop();
+
+    // Device state: skipped for this pass while a command handler has it
+    if (commands.tryLockState())
+    {
+        loopStep();
+        commands.unlockState();
+    }
+
     delay(10);
 }
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "CaptureReader.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <strings.h>
+#include "../components/data/FrameCodec.h"
+
+static const size_t BIN9_READING_SIZE = 9;
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &bytes)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool decodeBase64(const char *text, std::vector<uint8_t> &out)
+{
+    static int8_t table[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        memset(table, -1, sizeof(table));
+        for (int i = 0; i < 64; i++)
+            table[(uint8_t)alphabet[i]] = i;
+        tableReady = true;
+    }
+
+    out.clear();
+    uint32_t acc = 0;
+    int bits = 0;
+    for (const char *p = text; *p != '\0' && *p != '='; p++)
+    {
+        int8_t v = table[(uint8_t)*p];
+        if (v < 0)
+            return false;
+        acc = (acc << 6) | v;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back((uint8_t)(acc >> bits));
+        }
+    }
+    return true;
+}
+
+static void appendReading(std::vector<SensorFrame> &frames, uint32_t timestampUs, uint8_t pos,
+                          uint16_t proximity, uint16_t ambient)
+{
+    if (frames.empty() || frames.back().timestamp_us != timestampUs)
+    {
+        SensorFrame frame = {};
+        frame.timestamp_us = timestampUs;
+        frames.push_back(frame);
+    }
+
+    SensorFrame &frame = frames.back();
+    frame.proximity[pos] = proximity;
+    frame.ambient[pos] = ambient;
+    frame.valid_mask |= 1 << pos;
+}
+
+static bool unpackBin9(const uint8_t *data, size_t length, size_t readingCount,
+                       ReplayCapture &capture, std::string &error)
+{
+    if (length != readingCount * BIN9_READING_SIZE)
+    {
+        error = "bin9 size mismatch";
+        return false;
+    }
+
+    for (size_t i = 0; i < readingCount; i++)
+    {
+        const uint8_t *rec = data + i * BIN9_READING_SIZE;
+        uint32_t ts;
+        uint16_t prox, amb;
+        memcpy(&ts, rec, 4);
+        memcpy(&prox, rec + 5, 2);
+        memcpy(&amb, rec + 7, 2);
+        if (rec[4] >= NUM_SENSORS)
+        {
+            error = "bin9 position out of range";
+            return false;
+        }
+        appendReading(capture.frames, ts, rec[4], prox, amb);
+    }
+    return true;
+}
+
+static bool unpackDvz1(const uint8_t *data, size_t length, size_t frameCount,
+                       ReplayCapture &capture, std::string &error)
+{
+    FrameDecoder decoder;
+    size_t offset = 0;
+    for (size_t f = 0; f < frameCount; f++)
+    {
+        SensorFrame frame;
+        size_t used = decoder.decode(data + offset, length - offset, frame);
+        if (used == 0)
+        {
+            error = "dvz1 payload truncated or malformed";
+            return false;
+        }
+        offset += used;
+        capture.frames.push_back(frame);
+    }
+    if (offset != length)
+    {
+        error = "dvz1 trailing bytes";
+        return false;
+    }
+    return true;
+}
+
+static bool unpackReadings(const JsonDocument &header, const uint8_t *data, size_t length,
+                           ReplayCapture &capture, std::string &error)
+{
+    const char *format = header["reading_format"] | "";
+    if (strcmp(format, "bin9") == 0)
+        return unpackBin9(data, length, header["reading_count"] | 0, capture, error);
+    if (strcmp(format, "dvz1") == 0)
+        return unpackDvz1(data, length, header["frame_count"] | 0, capture, error);
+
+    error = std::string("unsupported reading_format '") + format + "'";
+    return false;
+}
+
+static bool loadBinaryMessage(const std::vector<uint8_t> &bytes, ReplayCapture &capture, std::string &error)
+{
+    uint32_t headerLength;
+    memcpy(&headerLength, bytes.data(), 4);
+    if (headerLength > bytes.size() - 4)
+    {
+        error = "header length exceeds file";
+        return false;
+    }
+
+    DynamicJsonDocument header(headerLength * 2 + 1024);
+    if (deserializeJson(header, (const char *)bytes.data() + 4, headerLength))
+    {
+        error = "header JSON parse failed";
+        return false;
+    }
+
+    size_t offset = 4 + headerLength;
+    return unpackReadings(header, bytes.data() + offset, bytes.size() - offset, capture, error);
+}
+
+static bool loadJsonMessage(const std::vector<uint8_t> &bytes, ReplayCapture &capture, std::string &error)
+{
+    DynamicJsonDocument doc(bytes.size() * 2 + 1024);
+    if (deserializeJson(doc, (const char *)bytes.data(), bytes.size()))
+    {
+        error = "JSON parse failed";
+        return false;
+    }
+
+    const char *b64 = doc["readings_b64"] | (const char *)nullptr;
+    if (b64 == nullptr)
+    {
+        error = "no readings_b64";
+        return false;
+    }
+
+    std::vector<uint8_t> packed;
+    if (!decodeBase64(b64, packed))
+    {
+        error = "readings_b64 is not base64";
+        return false;
+    }
+    return unpackReadings(doc, packed.data(), packed.size(), capture, error);
+}
+
+static bool loadCsv(const std::vector<uint8_t> &bytes, ReplayCapture &capture, std::string &error)
+{
+    std::istringstream in(std::string(bytes.begin(), bytes.end()));
+    std::string line;
+    std::getline(in, line); // Header
+
+    struct Row
+    {
+        long offsetMs; // Negative for readings just before the session start
+        uint8_t pos;
+        uint16_t proximity;
+        uint16_t ambient;
+    };
+    std::vector<Row> rows;
+    long firstMs = LONG_MAX;
+    while (std::getline(in, line))
+    {
+        long offsetMs;
+        unsigned long pcb, side, prox, amb;
+        if (sscanf(line.c_str(), "%ld,%lu,%lu,%lu,%lu", &offsetMs, &pcb, &side, &prox, &amb) != 5)
+            continue;
+        if (pcb < 1 || pcb > SENSOR_MAX_BOARDS || side < 1 || side > SENSORS_PER_BOARD)
+            continue;
+
+        rows.push_back({offsetMs, (uint8_t)((pcb - 1) * 2 + (side - 1)), (uint16_t)prox, (uint16_t)amb});
+        firstMs = min(firstMs, offsetMs);
+    }
+
+    // Rows are not guaranteed to be grouped by cycle: collect, then sort.
+    // Timestamps restart at 0 so long-uptime offsets cannot wrap in 32-bit us.
+    std::map<uint32_t, SensorFrame> byTimestamp;
+    for (const Row &row : rows)
+    {
+        uint32_t ts = (uint32_t)((row.offsetMs - firstMs) * 1000);
+        SensorFrame &frame = byTimestamp[ts];
+        frame.timestamp_us = ts;
+        frame.proximity[row.pos] = row.proximity;
+        frame.ambient[row.pos] = row.ambient;
+        frame.valid_mask |= 1 << row.pos;
+    }
+
+    if (byTimestamp.empty())
+    {
+        error = "no CSV rows";
+        return false;
+    }
+    for (const auto &entry : byTimestamp)
+        capture.frames.push_back(entry.second);
+    return true;
+}
+
+bool loadCapture(const std::string &path, ReplayCapture &capture, std::string &error)
+{
+    capture = ReplayCapture();
+    capture.path = path;
+    capture.label = labelFromPath(path);
+
+    std::vector<uint8_t> bytes;
+    if (!readFile(path, bytes) || bytes.size() < 4)
+    {
+        error = "unreadable or empty";
+        return false;
+    }
+
+    bool isCsv = path.size() > 4 && strcasecmp(path.c_str() + path.size() - 4, ".csv") == 0;
+
+    bool ok;
+    if (isCsv)
+        ok = loadCsv(bytes, capture, error);
+    else if (bytes[0] == '{')
+        ok = loadJsonMessage(bytes, capture, error);
+    else
+        ok = loadBinaryMessage(bytes, capture, error);
+
+    if (!ok)
+        return false;
+
+    for (const SensorFrame &frame : capture.frames)
+        capture.readings += frame.validCount();
+    return true;
+}
+
+ReplayLabel labelFromPath(const std::string &path)
+{
+    std::string lower(path);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    // The match closest to the file name wins (file over folder)
+    struct Pattern
+    {
+        const char *text;
+        ReplayLabel label;
+    };
+    static const Pattern patterns[] = {
+        {"a_to_b", ReplayLabel::A_TO_B},
+        {"a->b", ReplayLabel::A_TO_B},
+        {"b_to_a", ReplayLabel::B_TO_A},
+        {"b->a", ReplayLabel::B_TO_A},
+        {"no_transit", ReplayLabel::NO_TRANSIT},
+        {"no-transit", ReplayLabel::NO_TRANSIT},
+        {"baseline", ReplayLabel::NO_TRANSIT},
+    };
+
+    ReplayLabel label = ReplayLabel::UNLABELED;
+    size_t bestPos = 0;
+    bool found = false;
+    for (const Pattern &p : patterns)
+    {
+        size_t pos = lower.rfind(p.text);
+        if (pos != std::string::npos && (!found || pos > bestPos))
+        {
+            bestPos = pos;
+            label = p.label;
+            found = true;
+        }
+    }
+    return label;
+}
+
+const char *labelToString(ReplayLabel label)
+{
+    switch (label)
+    {
+    case ReplayLabel::A_TO_B:
+        return "A_TO_B";
+    case ReplayLabel::B_TO_A:
+        return "B_TO_A";
+    case ReplayLabel::NO_TRANSIT:
+        return "NO_TRANSIT";
+    default:
+        return "unlabeled";
+    }
+}
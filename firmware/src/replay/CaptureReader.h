@@ -0,0 +1,53 @@
+#ifndef CAPTURE_READER_H
+#define CAPTURE_READER_H
+
+#include <string>
+#include <vector>
+#include "../components/sensor/SensorFrame.h"
+
+/**
+ * CaptureReader - Loads recorded sessions for the host replay harness
+ *
+ * Accepted files (.csv by extension, the rest by content):
+ * - data/bin message: [u32 header length][header JSON][bin9 or dvz1 bytes]
+ *   (what transmitLiveDebugCaptureBinary streams with LIVE_DEBUG_RAW_BINARY)
+ * - JSON message with readings_b64 (bin9 or dvz1, the default base64 path)
+ * - CSV export (timestamp_offset,pcb_id,side,proximity,ambient,...),
+ *   as in session_data/; timestamp_offset is in ms and is rebased to 0
+ *
+ * bin9 readings sharing a timestamp are regrouped into one SensorFrame,
+ * the inverse of DataTransmitter::packFrames().
+ */
+
+enum class ReplayLabel
+{
+    UNLABELED,
+    A_TO_B,
+    B_TO_A,
+    NO_TRANSIT
+};
+
+struct ReplayCapture
+{
+    std::string path;
+    ReplayLabel label = ReplayLabel::UNLABELED;
+    std::vector<SensorFrame> frames;
+    size_t readings = 0; // Valid position readings across all frames
+};
+
+/**
+ * Load one capture file
+ * @param error Set to a short reason when loading fails
+ */
+bool loadCapture(const std::string &path, ReplayCapture &capture, std::string &error);
+
+/**
+ * Label from the path: a directory or file name containing a_to_b / a->b,
+ * b_to_a / b->a, or no_transit / no-transit / baseline (the download_sessions.py
+ * class folders and the session_data/labeled-data names)
+ */
+ReplayLabel labelFromPath(const std::string &path);
+
+const char *labelToString(ReplayLabel label);
+
+#endif
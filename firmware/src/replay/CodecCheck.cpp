@@ -0,0 +1,169 @@
+#include "CodecCheck.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "../components/data/ColumnCodec.h"
+#include "../components/data/FrameCodec.h"
+
+// Frames lost between the sensor task and the encoder (1 in DROP_EVERY)
+static const size_t DROP_EVERY = 97;
+
+// Frames per dvz1 block (DataTransmitter resets the encoder per message)
+static const size_t DVZ1_BLOCK_FRAMES = 250;
+
+// The frames duplicate_mode "suppress" would have published
+static std::vector<SensorFrame> suppressRepeats(const std::vector<SensorFrame> &frames, size_t &held)
+{
+    uint16_t lastProximity[NUM_SENSORS] = {0};
+    uint16_t lastAmbient[NUM_SENSORS] = {0};
+    SensorMask seen = 0;
+    std::vector<SensorFrame> out;
+
+    for (size_t f = 0; f < frames.size(); f++)
+    {
+        SensorFrame frame = frames[f];
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+            frame.setOffsetUs(pos, 0);
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (!frame.isValid(pos))
+                continue;
+            SensorMask bit = (SensorMask)1 << pos;
+            if ((seen & bit) && lastProximity[pos] == frame.proximity[pos] && lastAmbient[pos] == frame.ambient[pos])
+            {
+                frame.valid_mask &= (SensorMask)~bit;
+                frame.held_mask |= bit;
+            }
+            lastProximity[pos] = frame.proximity[pos];
+            lastAmbient[pos] = frame.ambient[pos];
+            seen |= bit;
+        }
+
+        if (f % DROP_EVERY == DROP_EVERY - 1 || frame.isEmpty())
+            continue;
+        held += __builtin_popcount(frame.held_mask);
+        out.push_back(frame);
+    }
+    return out;
+}
+
+static bool sameFrame(const SensorFrame &a, const SensorFrame &b)
+{
+    if (a.timestamp_us != b.timestamp_us || a.valid_mask != b.valid_mask || a.held_mask != b.held_mask)
+        return false;
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if ((a.isValid(pos) || a.isHeld(pos)) &&
+            (a.proximity[pos] != b.proximity[pos] || a.ambient[pos] != b.ambient[pos]))
+            return false;
+    }
+    return true;
+}
+
+static size_t checkDvz1(const std::vector<SensorFrame> &frames, size_t &bytes)
+{
+    FrameEncoder encoder;
+    FrameDecoder decoder;
+    std::vector<uint8_t> block;
+    size_t mismatches = 0;
+
+    for (size_t first = 0; first < frames.size(); first += DVZ1_BLOCK_FRAMES)
+    {
+        size_t count = std::min(DVZ1_BLOCK_FRAMES, frames.size() - first);
+        encoder.reset();
+        block.resize(count * FRAME_CODEC_MAX_FRAME_BYTES);
+        size_t length = 0;
+        for (size_t f = 0; f < count; f++)
+            length += encoder.encode(frames[first + f], block.data() + length);
+        bytes += length;
+
+        decoder.reset();
+        size_t at = 0;
+        for (size_t f = 0; f < count; f++)
+        {
+            SensorFrame decoded;
+            size_t used = at < length ? decoder.decode(block.data() + at, length - at, decoded) : 0;
+            if (used == 0)
+            {
+                mismatches += count - f;
+                break;
+            }
+            at += used;
+            if (!sameFrame(frames[first + f], decoded))
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+static size_t checkCol1(const std::vector<SensorFrame> &frames, size_t &bytes)
+{
+    std::vector<uint8_t> column;
+    std::vector<SensorFrame> decoded;
+    size_t mismatches = 0;
+
+    // Chunks of SESSION_COLUMN_CHUNK_MS, like SessionSpill
+    size_t first = 0;
+    while (first < frames.size())
+    {
+        size_t count = 1;
+        while (first + count < frames.size() &&
+               frames[first + count].timestamp_us - frames[first].timestamp_us < SESSION_COLUMN_CHUNK_MS * 1000UL)
+            count++;
+
+        const SensorFrame *chunk = &frames[first];
+        decoded.assign(count, SensorFrame());
+        column.resize(COLUMN_CODEC_MAX_TIMESTAMP_BYTES(count));
+        size_t length = ColumnCodec::encodeTimestamps(chunk, count, column.data());
+        bytes += length;
+        bool ok = ColumnCodec::decodeTimestamps(column.data(), length, decoded.data(), count);
+
+        column.resize(COLUMN_CODEC_MAX_POSITION_BYTES(count));
+        for (uint8_t pos = 0; pos < NUM_SENSORS && ok; pos++)
+        {
+            length = ColumnCodec::encodePosition(chunk, count, pos, column.data());
+            bytes += length;
+            ok = ColumnCodec::decodePosition(column.data(), length, pos, decoded.data(), count);
+        }
+
+        for (size_t f = 0; f < count; f++)
+        {
+            if (!ok || !sameFrame(chunk[f], decoded[f]))
+                mismatches++;
+        }
+        first += count;
+    }
+    return mismatches;
+}
+
+size_t checkCodecs(const std::vector<ReplayCapture> &captures)
+{
+    size_t frames = 0;
+    size_t readings = 0;
+    size_t held = 0;
+    size_t dvz1Bytes = 0;
+    size_t col1Bytes = 0;
+    size_t dvz1Mismatches = 0;
+    size_t col1Mismatches = 0;
+
+    for (const ReplayCapture &capture : captures)
+    {
+        std::vector<SensorFrame> published = suppressRepeats(capture.frames, held);
+        frames += published.size();
+        for (const SensorFrame &frame : published)
+            readings += frame.validCount();
+
+        size_t dvz1 = checkDvz1(published, dvz1Bytes);
+        size_t col1 = checkCol1(published, col1Bytes);
+        if (dvz1 || col1)
+            printf("  %s: %zu dvz1, %zu col1 frame(s) differ\n", capture.path.c_str(), dvz1, col1);
+        dvz1Mismatches += dvz1;
+        col1Mismatches += col1;
+    }
+
+    printf("\ncodec round trip (suppress, 1 in %zu frames dropped): %zu frames, %zu readings, %zu held\n",
+           DROP_EVERY, frames, readings, held);
+    printf("  %-6s %10zu bytes %8s\n", "dvz1", dvz1Bytes, dvz1Mismatches ? "DIFFER" : "ok");
+    printf("  %-6s %10zu bytes %8s\n", "col1", col1Bytes, col1Mismatches ? "DIFFER" : "ok");
+    return dvz1Mismatches + col1Mismatches;
+}
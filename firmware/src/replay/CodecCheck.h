@@ -0,0 +1,27 @@
+#ifndef CODEC_CHECK_H
+#define CODEC_CHECK_H
+
+#include <vector>
+#include "CaptureReader.h"
+
+/**
+ * CodecCheck - Round trip of the wire codecs on recorded captures
+ *
+ * Each capture is turned into what duplicate_mode "suppress" publishes
+ * (a reading equal to the position's previous one, ambient included, is
+ * held; every DROP_EVERY-th frame is then lost, as on a full ring, so held
+ * readings also follow values the stream never carried) and encoded as
+ * dvz1 blocks and col1 chunks. The decoded frames must match: same
+ * timestamps, valid and held masks, and value at every valid or held
+ * position (offset_us is not on the wire).
+ *
+ *   .pio/build/native_replay/program --codec-check session_data/labeled-data
+ */
+
+/**
+ * Run the round trip on every capture, printing one summary line per codec
+ * @return Number of frames that did not decode back
+ */
+size_t checkCodecs(const std::vector<ReplayCapture> &captures);
+
+#endif
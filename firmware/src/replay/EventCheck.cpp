@@ -0,0 +1,138 @@
+#include "EventCheck.h"
+#include <cstdio>
+#include "../components/detection/DirectionDetector.h"
+
+// Detecting frame to the detector reset in Play: a couple of loop() passes
+static const uint32_t LOOP_LAG_US = 20 * 1000;
+
+// Live Debug: the reset comes when the capture is cut (capture_post_trigger_ms default)
+static const uint32_t CAPTURE_POST_TRIGGER_US = 250 * 1000;
+
+enum class LoopMode
+{
+    PLAY,
+    LIVE_DEBUG,
+    MULTI_TRANSIT
+};
+
+struct EventCount
+{
+    size_t events = 0;  // DetectionTask results (result queue, LAN datagram)
+    size_t pending = 0; // Frames with hasDetection(): sends without the latch
+};
+
+// The detector as DetectionTask feeds it, reset when loop() would
+static EventCount replayTask(DirectionDetector &detector, const ReplayCapture &capture,
+                             LoopMode mode, uint32_t cooldownUs)
+{
+    EventCount count;
+    DetectionLatch latch;
+    bool resetDue = false;
+    uint32_t resetAtUs = 0;
+    bool haveLast = false;
+    uint32_t lastUs = 0;
+
+    detector.fullReset();
+    for (const SensorFrame &frame : capture.frames)
+    {
+        if (resetDue && (int32_t)(frame.timestamp_us - resetAtUs) >= 0)
+        {
+            detector.reset();
+            resetDue = false;
+        }
+
+        detector.addFrame(frame);
+        bool pending = detector.hasDetection();
+        if (pending)
+            count.pending++;
+        if (!latch.report(pending, detector.isMultiTransit()))
+            continue;
+        detector.getResult();
+        count.events++;
+
+        // loop(): events in the cooldown or while a capture is pending are
+        // dropped and do not reset the detector
+        if (mode == LoopMode::MULTI_TRANSIT)
+            continue;
+        if (resetDue || (haveLast && frame.timestamp_us - lastUs < cooldownUs))
+            continue;
+        haveLast = true;
+        lastUs = frame.timestamp_us;
+        resetDue = true;
+        resetAtUs = frame.timestamp_us + (mode == LoopMode::PLAY ? LOOP_LAG_US : CAPTURE_POST_TRIGGER_US);
+    }
+    return count;
+}
+
+// Reset at the detecting frame (ReplayMain's handling)
+static size_t replayReference(DirectionDetector &detector, const ReplayCapture &capture,
+                              bool multiTransit, uint32_t cooldownUs)
+{
+    size_t detections = 0;
+    bool haveLast = false;
+    uint32_t lastUs = 0;
+
+    detector.fullReset();
+    for (const SensorFrame &frame : capture.frames)
+    {
+        detector.addFrame(frame);
+        if (!detector.hasDetection())
+            continue;
+        detector.getResult();
+        if (multiTransit)
+        {
+            detections++;
+            continue;
+        }
+        detector.reset();
+        if (haveLast && frame.timestamp_us - lastUs < cooldownUs)
+            continue;
+        haveLast = true;
+        lastUs = frame.timestamp_us;
+        detections++;
+    }
+    return detections;
+}
+
+size_t checkEvents(const std::vector<ReplayCapture> &captures, uint32_t cooldownUs)
+{
+    static const LoopMode modes[] = {LoopMode::PLAY, LoopMode::LIVE_DEBUG, LoopMode::MULTI_TRANSIT};
+    static const char *names[] = {"play", "live_debug", "multi_transit"};
+
+    // Large (baseline rings): keep it off the stack
+    DirectionDetector *detector = new DirectionDetector();
+    size_t failures = 0;
+
+    printf("\nevents per detection (DetectionTask polling, loop() resets later):\n");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        DetectorConfig config;
+        config.multiTransit = modes[m] == LoopMode::MULTI_TRANSIT;
+        detector->setConfig(config);
+
+        size_t reference = 0;
+        size_t events = 0;
+        size_t pending = 0;
+        size_t differ = 0;
+        for (const ReplayCapture &capture : captures)
+        {
+            size_t expected = replayReference(*detector, capture, config.multiTransit, cooldownUs);
+            EventCount count = replayTask(*detector, capture, modes[m], cooldownUs);
+            if (count.events != expected)
+            {
+                printf("  %s: %s: %zu event(s), %zu detection(s)\n", names[m], capture.path.c_str(),
+                       count.events, expected);
+                differ++;
+            }
+            reference += expected;
+            events += count.events;
+            pending += count.pending;
+        }
+        printf("  %-14s %4zu detections %4zu events (%zu without the latch) %8s\n", names[m], reference,
+               events, pending, differ ? "DIFFER" : "ok");
+        failures += differ;
+    }
+
+    delete detector;
+    return failures;
+}
@@ -0,0 +1,29 @@
+#ifndef EVENT_CHECK_H
+#define EVENT_CHECK_H
+
+#include <vector>
+#include "CaptureReader.h"
+
+/**
+ * EventCheck - One DetectionTask event per transit, on recorded captures
+ *
+ * Replays each capture through the runtime heuristic detector the way
+ * DetectionTask::feed() polls it: hasDetection() after every frame, events
+ * let through by DetectionLatch, and the detector reset only once loop()
+ * has taken the event - LOOP_LAG_US later in Play, capture_post_trigger_ms
+ * later in Live Debug (and never with multi_transit, where getResult()
+ * consumes the pair). A capture must produce as many events as the
+ * reference replay (reset at the detecting frame) reports detections; the
+ * frames a pending detection stayed visible for are printed as what the
+ * task used to send without the latch.
+ *
+ *   .pio/build/native_replay/program --event-check session_data/labeled-data
+ */
+
+/**
+ * Run the check on every capture, without and with multi_transit
+ * @return Number of captures whose event count differs from the reference
+ */
+size_t checkEvents(const std::vector<ReplayCapture> &captures, uint32_t cooldownUs);
+
+#endif
@@ -0,0 +1,135 @@
+#include "PerfBudgets.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool PerfBudgets::isRate(const std::string &name)
+{
+    static const std::string suffix = "_per_s";
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool PerfBudgets::load(const std::string &path, std::string &error)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        error = "cannot open";
+        return false;
+    }
+
+    size_t loaded = limits.size();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+
+        std::istringstream fields(line);
+        PerfMetric limit;
+        if (!(fields >> limit.name))
+            continue; // Blank or comment
+        if (!(fields >> limit.value))
+        {
+            error = "line " + std::to_string(lineNumber) + ": expected <metric> <limit>";
+            return false;
+        }
+        limits.push_back(limit);
+    }
+    if (limits.size() == loaded)
+    {
+        error = "no budgets";
+        return false;
+    }
+    return true;
+}
+
+int PerfBudgets::check(const std::vector<PerfMetric> &metrics, double tolerancePercent) const
+{
+    double slack = tolerancePercent / 100.0;
+    int failures = 0;
+
+    printf("\nbudgets (tolerance %.0f%%):\n", tolerancePercent);
+    printf("  %-38s %12s %12s %8s\n", "metric", "measured", "limit", "");
+    for (const PerfMetric &limit : limits)
+    {
+        const PerfMetric *measured = nullptr;
+        for (const PerfMetric &metric : metrics)
+        {
+            if (metric.name == limit.name)
+                measured = &metric;
+        }
+        if (!measured)
+        {
+            failures++;
+            printf("  %-38s %12s %12.4g %8s\n", limit.name.c_str(), "-", limit.value, "NOT RUN");
+            continue;
+        }
+
+        bool over = isRate(limit.name) ? measured->value < limit.value * (1.0 - slack)
+                                       : measured->value > limit.value * (1.0 + slack);
+        if (over)
+            failures++;
+        printf("  %-38s %12.4g %12.4g %8s\n", limit.name.c_str(), measured->value, limit.value,
+               over ? "OVER" : "ok");
+    }
+
+    for (const PerfMetric &metric : metrics)
+    {
+        bool budgeted = false;
+        for (const PerfMetric &limit : limits)
+            budgeted = budgeted || limit.name == metric.name;
+        if (!budgeted)
+            printf("  %-38s %12.4g %12s %8s\n", metric.name.c_str(), metric.value, "-", "no limit");
+    }
+
+    if (failures)
+        printf("%d metric(s) over budget or not run\n", failures);
+    return failures;
+}
+
+std::vector<PerfMetric> PerfBudgets::worst(const std::vector<std::vector<PerfMetric>> &runs)
+{
+    std::vector<PerfMetric> result;
+    for (const std::vector<PerfMetric> &run : runs)
+    {
+        for (const PerfMetric &metric : run)
+        {
+            PerfMetric *known = nullptr;
+            for (PerfMetric &have : result)
+            {
+                if (have.name == metric.name)
+                    known = &have;
+            }
+            if (!known)
+                result.push_back(metric);
+            else if (isRate(metric.name) ? metric.value < known->value : metric.value > known->value)
+                known->value = metric.value;
+        }
+    }
+    return result;
+}
+
+bool PerfBudgets::record(const std::string &path, const std::vector<PerfMetric> &metrics, double headroomPercent,
+                         const std::string &note)
+{
+    FILE *out = fopen(path.c_str(), "w");
+    if (!out)
+        return false;
+    double headroom = headroomPercent / 100.0;
+    fprintf(out, "# Replay harness budgets (--budgets), recorded with --record-budgets\n");
+    fprintf(out, "# %s; timing limits include %.0f%% headroom\n", note.c_str(), headroomPercent);
+    fprintf(out, "# metric                          limit  (_per_s: floor, else ceiling)\n");
+    for (const PerfMetric &metric : metrics)
+    {
+        double limit = metric.value;
+        if (metric.timing)
+            limit *= isRate(metric.name) ? 1.0 - headroom : 1.0 + headroom;
+        fprintf(out, "%-38s %.4g\n", metric.name.c_str(), limit);
+    }
+    return fclose(out) == 0;
+}
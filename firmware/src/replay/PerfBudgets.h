@@ -0,0 +1,70 @@
+#ifndef PERF_BUDGETS_H
+#define PERF_BUDGETS_H
+
+#include <string>
+#include <vector>
+
+/**
+ * PerfBudgets - Regression gate for the replay harness
+ *
+ * A budget file lists one limit per metric, recorded on the reference
+ * fixtures (session_data/labeled-data) with --record-budgets:
+ *
+ *   # metric                          limit
+ *   detector.fixed.ref_ratio          15.2
+ *   encode.dvz1.bytes_per_reading     2.39
+ *
+ * Metrics ending in _per_s are rates (a floor); everything else is a cost
+ * (a ceiling), the same convention as scripts/bench-compare.py. A metric
+ * fails when it is worse than its limit by more than the tolerance, and
+ * when it was not measured at all (a detector not built or not selected):
+ * run the gate with every budgeted metric, or load fewer files.
+ *
+ * One timing sample moves by more than any sensible tolerance, so a
+ * recorded timing limit is the worst of several runs plus headroom;
+ * size metrics are deterministic and recorded as measured. Timings are
+ * budgeted as ratios (to a host reference loop, or to a plain copy), never
+ * as absolute times, so a file recorded on one machine gates another.
+ */
+
+struct PerfMetric
+{
+    std::string name;
+    double value;
+    bool timing = true; // Varies run to run (recorded with headroom)
+};
+
+class PerfBudgets
+{
+public:
+    /**
+     * Add the limits of a budget file (several files add up)
+     * @param error Set to a short reason when loading fails
+     */
+    bool load(const std::string &path, std::string &error);
+
+    /**
+     * Print every metric against its limit
+     * @param tolerancePercent Allowed excess over a limit
+     * @return Number of metrics over budget or not measured
+     */
+    int check(const std::vector<PerfMetric> &metrics, double tolerancePercent) const;
+
+    // Per metric, the worst value of several runs of the same metrics
+    static std::vector<PerfMetric> worst(const std::vector<std::vector<PerfMetric>> &runs);
+
+    /**
+     * Write metrics as a new budget file
+     * @param headroomPercent Added to timing metrics (removed from rates)
+     * @param note Provenance line for the file header
+     */
+    static bool record(const std::string &path, const std::vector<PerfMetric> &metrics, double headroomPercent,
+                       const std::string &note);
+
+    static bool isRate(const std::string &name);
+
+private:
+    std::vector<PerfMetric> limits;
+};
+
+#endif
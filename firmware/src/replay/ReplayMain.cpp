@@ -0,0 +1,705 @@
+/**
+ * Host replay harness for the direction detectors (PlatformIO env native_replay)
+ *
+ * Feeds recorded captures through the detectors as fast as the host runs
+ * them and reports, per detector:
+ * - throughput (readings/s and ns per frame, detector calls only)
+ * - latency from first rise to result, in capture time: first rise is the
+ *   frame where the detector left idle (a sensor entered IN_WAVE, or the
+ *   ML trigger fired), result is the frame that completed the detection
+ * - a confusion matrix of labels (from the file path, see CaptureReader.h)
+ *   against detection directions; a capture without detections counts once
+ *   as "none"
+ *
+ * The -static detectors run the compile-time ProductionDetectorProfile
+ * (DirectionDetector.h); when a detector ran with both profiles, the
+ * report ends with their ns/frame ratio and whether the results matched.
+ * The static profile ignores --multi-transit and --skew-compensation.
+ *
+ * Detections are handled like PLAY mode in main.cpp: the detector is reset
+ * after each one, and results within the cooldown of the previous one are
+ * dropped (with --multi-transit, heuristic detectors consume their results
+ * instead: no reset, no cooldown). Each capture starts from a full reset
+ * (fresh baseline).
+ *
+ *   .pio/build/native_replay/program [options] <capture files or directories>
+ *     --detector NAME              run only this detector (repeatable; default all built):
+ *                                  float, fixed, float-static, fixed-static, ml
+ *     --cooldown-ms N              default 500 (DETECTION_COOLDOWN)
+ *     --multi-transit              pipelined heuristic detection (multi_transit)
+ *     --skew-compensation          us center of mass from each sample's instant (skew_compensation)
+ *     --repeat N                   replay everything N times (steadier timing)
+ *     --per-capture                one line per capture / detection
+ *     --verbose                    echo the detectors' Serial logging to stderr
+ *     --budgets FILE               check the metrics below against FILE (PerfBudgets.h,
+ *                                  repeatable); exit status 1 if one is over budget or not run
+ *     --tolerance PCT              allowed excess over a budget, default 10
+ *     --record-budgets FILE        write the metrics below as a new budget file: worst of
+ *                                  --record-runs N replays (default 5), timing metrics plus
+ *                                  --headroom PCT (default 15)
+ *     --codec-check                only round-trip the captures through dvz1 and col1
+ *                                  with held readings (CodecCheck.h); exit status 1 on a mismatch
+ *     --event-check                only count DetectionTask events per detection (EventCheck.h);
+ *                                  exit status 1 if a capture has more or fewer
+ *
+ * Budget metrics, on the given captures. Timings are ratios to a host
+ * reference (a per-position moving average and threshold test over the same
+ * frames, fastest --repeat pass, timed next to each detector pass), so one
+ * budget file holds on any machine:
+ *   detector.<name>.ref_ratio       detector time per sensor reading, fastest --repeat pass
+ *   ml.prepare_ref_ratio            MLDetector input tensor fill, per inference (native_replay_ml)
+ *   encode.dvz1.bytes_per_reading   FrameEncoder output, one block per capture
+ *   ring.copy_ratio                 SPSCRing push + bulk pop, one thread, over the same
+ *                                   frames copied in and out of a plain array
+ *
+ * The regression gate before merging anything that touches these paths
+ * (native_replay_ml: --budgets firmware/src/replay/budgets-ml.txt instead,
+ * recorded by that env):
+ *   .pio/build/native_replay/program --repeat 5 --budgets firmware/src/replay/budgets.txt \
+ *       session_data/labeled-data
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "CaptureReader.h"
+#include "CodecCheck.h"
+#include "EventCheck.h"
+#include "PerfBudgets.h"
+#include "../components/data/FrameCodec.h"
+#include "../components/detection/DirectionDetector.h"
+#include "../components/memory/SPSCRing.h"
+#if REPLAY_WITH_ML
+#include "../components/detection/MLDetector.h"
+#endif
+
+struct ReplayOptions
+{
+    std::vector<std::string> detectors;
+    uint32_t cooldownUs = 500 * 1000;
+    bool multiTransit = false;
+    bool skewCompensation = false;
+    int repeat = 1;
+    bool perCapture = false;
+    std::vector<std::string> budgetsPaths;
+    std::string recordPath;
+    double tolerancePercent = 10;
+    int recordRuns = 5;
+    double headroomPercent = 15;
+    bool codecCheck = false;
+    bool eventCheck = false;
+};
+
+// Confusion matrix columns
+enum ResultColumn
+{
+    RESULT_A_TO_B,
+    RESULT_B_TO_A,
+    RESULT_UNKNOWN,
+    RESULT_NONE,
+    RESULT_COLUMNS
+};
+
+static const int LABEL_ROWS = 4; // ReplayLabel values
+
+struct ReplayStats
+{
+    std::string name;
+    size_t captures = 0;
+    int passes = 0; // --repeat passes run
+    size_t frames = 0;
+    size_t readings = 0;
+    size_t detections = 0;
+    size_t cooldownDrops = 0;
+    double detectorSeconds = 0;
+    double fastestPassSeconds = 0; // Quickest --repeat pass (the budget metric: noise only adds time)
+    double referenceSeconds = 0;   // Quickest host reference pass, timed next to the detector's
+    std::vector<uint32_t> latenciesUs;
+    uint32_t confusion[LABEL_ROWS][RESULT_COLUMNS] = {};
+    std::vector<PerfMetric> metrics; // Detector specific budget metrics
+};
+
+// --- Detector adapters: how each one reports "left idle" ---
+
+template <typename Detector>
+struct HeuristicReplay
+{
+    Detector detector;
+
+    bool begin(const ReplayOptions &options)
+    {
+        DetectorConfig config;
+        config.multiTransit = options.multiTransit;
+        config.skewCompensation = options.skewCompensation;
+        detector.setConfig(config);
+        return true;
+    }
+    bool consumesResults() const { return detector.isMultiTransit(); }
+    bool rising() const { return detector.getState() == DetectorState::DETECTING; }
+    bool idle() const
+    {
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (detector.getSensorWaveState(pos) != WaveState::IDLE)
+                return false;
+        }
+        return true;
+    }
+    void finish(ReplayStats &) const {}
+};
+
+#if REPLAY_WITH_ML
+struct MLReplay
+{
+    MLDetector detector;
+
+    bool begin(const ReplayOptions &) { return detector.init(); }
+    bool consumesResults() const { return false; }
+    bool rising() const { return detector.isTriggered(); }
+    bool idle() const { return !detector.isTriggered(); }
+    void finish(ReplayStats &stats) const
+    {
+        double referenceNs = stats.referenceSeconds * 1e9 / (stats.readings / stats.passes);
+        stats.metrics.push_back({"ml.prepare_ref_ratio", detector.getInferenceStats().prepareAvgUs * 1000.0 / referenceNs});
+    }
+};
+#endif
+
+static ResultColumn columnFor(Direction dir)
+{
+    switch (dir)
+    {
+    case Direction::A_TO_B:
+        return RESULT_A_TO_B;
+    case Direction::B_TO_A:
+        return RESULT_B_TO_A;
+    default:
+        return RESULT_UNKNOWN;
+    }
+}
+
+// Host reference for the timing budgets: the skeleton of a detector's
+// per-reading work (moving average, slow baseline, threshold test) over the
+// same frames. Looped REFERENCE_LOOPS times so a pass is as long as a
+// detector's and timer granularity does not show.
+static const int REFERENCE_LOOPS = 4;
+static const uint8_t REFERENCE_WINDOW = 5;
+static uint32_t referenceChecksum = 0;
+
+static double referencePass(const std::vector<ReplayCapture> &captures)
+{
+    uint32_t crossings = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < REFERENCE_LOOPS; loop++)
+    {
+        for (const ReplayCapture &capture : captures)
+        {
+            uint16_t window[NUM_SENSORS][REFERENCE_WINDOW] = {};
+            uint32_t sum[NUM_SENSORS] = {};
+            float baseline[NUM_SENSORS] = {};
+            uint8_t slot = 0;
+            for (const SensorFrame &frame : capture.frames)
+            {
+                for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+                {
+                    if (!frame.isValid(pos))
+                        continue;
+                    sum[pos] += frame.proximity[pos] - window[pos][slot];
+                    window[pos][slot] = frame.proximity[pos];
+                    float smoothed = sum[pos] / (float)REFERENCE_WINDOW;
+                    baseline[pos] += (smoothed - baseline[pos]) * 0.02f;
+                    if (smoothed > baseline[pos] * 1.5f + 10)
+                        crossings++;
+                }
+                slot = slot + 1 < REFERENCE_WINDOW ? slot + 1 : 0;
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Keeps the loop from being optimized away
+    referenceChecksum += crossings;
+    if (referenceChecksum == 1)
+        fprintf(stderr, " ");
+    return seconds / REFERENCE_LOOPS;
+}
+
+template <typename Adapter>
+static void replayCapture(Adapter &adapter, const ReplayCapture &capture,
+                          const ReplayOptions &options, ReplayStats &stats)
+{
+    adapter.detector.fullReset();
+
+    bool haveOnset = false;
+    uint32_t onsetUs = 0;
+    bool haveLast = false;
+    uint32_t lastDetectionUs = 0;
+    size_t detectionsHere = 0;
+    int row = (int)capture.label;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const SensorFrame &frame : capture.frames)
+    {
+        adapter.detector.addFrame(frame);
+
+        if (!haveOnset && adapter.rising())
+        {
+            haveOnset = true;
+            onsetUs = frame.timestamp_us;
+        }
+
+        if (!adapter.detector.hasDetection())
+        {
+            // Rise that never completed into a detection
+            if (haveOnset && adapter.idle())
+                haveOnset = false;
+            continue;
+        }
+
+        DetectionResult result = adapter.detector.getResult();
+        bool pipelined = adapter.consumesResults();
+        if (!pipelined)
+            adapter.detector.reset();
+
+        if (!pipelined && haveLast && frame.timestamp_us - lastDetectionUs < options.cooldownUs)
+        {
+            stats.cooldownDrops++;
+            haveOnset = false;
+            continue;
+        }
+        haveLast = true;
+        lastDetectionUs = frame.timestamp_us;
+
+        uint32_t latencyUs = haveOnset ? frame.timestamp_us - onsetUs : 0;
+        if (haveOnset)
+            stats.latenciesUs.push_back(latencyUs);
+        haveOnset = false;
+
+        stats.detections++;
+        stats.confusion[row][columnFor(result.direction)]++;
+        detectionsHere++;
+
+        if (options.perCapture)
+            printf("    %s @%.3fs %s conf=%.2f M%d latency=%.1fms\n",
+                   stats.name.c_str(), (frame.timestamp_us - capture.frames.front().timestamp_us) / 1e6,
+                   DirectionDetector::directionToString(result.direction), result.confidence,
+                   result.detectedModule, latencyUs / 1000.0);
+    }
+    stats.detectorSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (detectionsHere == 0)
+        stats.confusion[row][RESULT_NONE]++;
+
+    stats.captures++;
+    stats.frames += capture.frames.size();
+    stats.readings += capture.readings;
+}
+
+template <typename Adapter>
+static bool replayAll(const char *name, const std::vector<ReplayCapture> &captures,
+                      const ReplayOptions &options, std::vector<ReplayStats> &results)
+{
+    // Detectors are large (baseline rings, tensor arena): keep them off the stack
+    Adapter *adapter = new Adapter();
+    if (!adapter->begin(options))
+    {
+        fprintf(stderr, "%s: detector init failed, skipped\n", name);
+        delete adapter;
+        return false;
+    }
+
+    ReplayStats stats;
+    stats.name = name;
+    for (int r = 0; r < options.repeat; r++)
+    {
+        double reference = referencePass(captures);
+        stats.referenceSeconds = r == 0 ? reference : std::min(stats.referenceSeconds, reference);
+
+        double before = stats.detectorSeconds;
+        for (const ReplayCapture &capture : captures)
+        {
+            if (options.perCapture && r == 0)
+                printf("  [%s] %s (%s, %zu frames)\n", name, capture.path.c_str(),
+                       labelToString(capture.label), capture.frames.size());
+            replayCapture(*adapter, capture, options, stats);
+        }
+        double pass = stats.detectorSeconds - before;
+        stats.fastestPassSeconds = r == 0 ? pass : std::min(stats.fastestPassSeconds, pass);
+        stats.passes++;
+    }
+
+    adapter->finish(stats);
+    delete adapter;
+    results.push_back(stats);
+    return true;
+}
+
+static uint32_t percentile(const std::vector<uint32_t> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+static void printReport(const ReplayStats &stats, int repeat)
+{
+    printf("\n=== %s ===\n", stats.name.c_str());
+    printf("captures: %zu  frames: %zu  readings: %zu", stats.captures / repeat,
+           stats.frames / repeat, stats.readings / repeat);
+    if (repeat > 1)
+        printf("  (x%d)", repeat);
+    printf("\n");
+
+    double seconds = stats.detectorSeconds > 0 ? stats.detectorSeconds : 1e-9;
+    printf("throughput: %.0f readings/s, %.0f ns/frame, fastest pass %.2fx host reference\n",
+           stats.readings / seconds, seconds * 1e9 / (stats.frames ? stats.frames : 1),
+           stats.referenceSeconds > 0 ? stats.fastestPassSeconds / stats.referenceSeconds : 0.0);
+
+    printf("detections: %zu (dropped in cooldown: %zu)\n", stats.detections / repeat,
+           stats.cooldownDrops / repeat);
+
+    std::vector<uint32_t> sorted(stats.latenciesUs);
+    std::sort(sorted.begin(), sorted.end());
+    if (!sorted.empty())
+    {
+        double sum = 0;
+        for (uint32_t v : sorted)
+            sum += v;
+        printf("latency rise->result (ms): avg %.1f  p50 %.1f  p95 %.1f  max %.1f  (n=%zu)\n",
+               sum / sorted.size() / 1000.0, percentile(sorted, 0.5) / 1000.0,
+               percentile(sorted, 0.95) / 1000.0, sorted.back() / 1000.0, sorted.size() / repeat);
+    }
+
+    static const char *columns[RESULT_COLUMNS] = {"A_TO_B", "B_TO_A", "UNKNOWN", "none"};
+    static const ReplayLabel rows[LABEL_ROWS] = {ReplayLabel::A_TO_B, ReplayLabel::B_TO_A,
+                                                 ReplayLabel::NO_TRANSIT, ReplayLabel::UNLABELED};
+
+    printf("confusion (label \\ result):\n  %-11s", "");
+    for (int c = 0; c < RESULT_COLUMNS; c++)
+        printf(" %8s", columns[c]);
+    printf("\n");
+
+    uint32_t correct = 0;
+    uint32_t labeled = 0;
+    for (ReplayLabel label : rows)
+    {
+        const uint32_t *counts = stats.confusion[(int)label];
+        printf("  %-11s", labelToString(label));
+        for (int c = 0; c < RESULT_COLUMNS; c++)
+            printf(" %8u", counts[c] / repeat);
+        printf("\n");
+
+        if (label == ReplayLabel::UNLABELED)
+            continue;
+        for (int c = 0; c < RESULT_COLUMNS; c++)
+            labeled += counts[c];
+        if (label == ReplayLabel::A_TO_B)
+            correct += counts[RESULT_A_TO_B];
+        else if (label == ReplayLabel::B_TO_A)
+            correct += counts[RESULT_B_TO_A];
+        else
+            correct += counts[RESULT_NONE];
+    }
+    if (labeled > 0)
+        printf("accuracy (labeled): %.1f%% (%u/%u)\n", 100.0 * correct / labeled,
+               correct / repeat, labeled / repeat);
+}
+
+static void collectFiles(const std::string &arg, std::vector<std::string> &files)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(arg, ec))
+    {
+        files.push_back(arg);
+        return;
+    }
+
+    std::vector<std::string> found;
+    for (const auto &entry : fs::recursive_directory_iterator(arg, ec))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        std::string ext = entry.path().extension().string();
+        if (ext == ".bin" || ext == ".json" || ext == ".csv")
+            found.push_back(entry.path().string());
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+static bool wants(const ReplayOptions &options, const char *name)
+{
+    return options.detectors.empty() ||
+           std::find(options.detectors.begin(), options.detectors.end(), name) != options.detectors.end();
+}
+
+// Static profile benchmark: the same arithmetic with both detector profiles
+static void printProfileComparison(const std::vector<ReplayStats> &results)
+{
+    for (const ReplayStats &runtime : results)
+    {
+        for (const ReplayStats &fixed : results)
+        {
+            if (fixed.name != runtime.name + "-static")
+                continue;
+            double runtimeNs = runtime.detectorSeconds * 1e9 / (runtime.frames ? runtime.frames : 1);
+            double fixedNs = fixed.detectorSeconds * 1e9 / (fixed.frames ? fixed.frames : 1);
+            bool same = runtime.detections == fixed.detections &&
+                        memcmp(runtime.confusion, fixed.confusion, sizeof(runtime.confusion)) == 0;
+            printf("\n%s vs %s: %.0f vs %.0f ns/frame (%.2fx), results %s\n", fixed.name.c_str(),
+                   runtime.name.c_str(), fixedNs, runtimeNs, fixedNs > 0 ? runtimeNs / fixedNs : 0.0,
+                   same ? "identical" : "differ");
+        }
+    }
+}
+
+// --- Budget metrics beyond the detectors ---
+
+static double encodedBytesPerReading(const std::vector<ReplayCapture> &captures)
+{
+    FrameEncoder encoder;
+    uint8_t buffer[FRAME_CODEC_MAX_FRAME_BYTES];
+    size_t bytes = 0;
+    size_t readings = 0;
+    for (const ReplayCapture &capture : captures)
+    {
+        encoder.reset();
+        for (const SensorFrame &frame : capture.frames)
+            bytes += encoder.encode(frame, buffer);
+        readings += capture.readings;
+    }
+    return readings ? (double)bytes / readings : 0;
+}
+
+// The sensor task's hand-off ring, pushed in bursts and drained like the
+// detection task does (popBulk); both sides on one thread, so this is the
+// ring's own cost without cross-core traffic. Reported against copying the
+// same bursts in and out of a plain array, which takes the host's speed out
+// of the number: a ring cost that grows is a regression on any machine.
+static SPSCRing<SensorFrame, 256> handoffRing;
+static const size_t HANDOFF_BURST = 32;
+static SensorFrame handoffCopy[HANDOFF_BURST];
+
+static double handoffSeconds(const std::vector<ReplayCapture> &captures, int repeat, bool ring, uint32_t &checksum)
+{
+    SensorFrame batch[HANDOFF_BURST];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++)
+    {
+        for (const ReplayCapture &capture : captures)
+        {
+            for (size_t i = 0; i < capture.frames.size(); i += HANDOFF_BURST)
+            {
+                size_t end = std::min(i + HANDOFF_BURST, capture.frames.size());
+                size_t n = end - i;
+                if (ring)
+                {
+                    for (size_t f = i; f < end; f++)
+                        handoffRing.push(capture.frames[f]);
+                    n = handoffRing.popBulk(batch, HANDOFF_BURST);
+                }
+                else
+                {
+                    for (size_t f = i; f < end; f++)
+                        memcpy(&handoffCopy[f - i], &capture.frames[f], sizeof(SensorFrame));
+                    memcpy(batch, handoffCopy, n * sizeof(SensorFrame));
+                }
+                checksum += batch[n - 1].timestamp_us;
+            }
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double ringCopyRatio(const std::vector<ReplayCapture> &captures, int repeat)
+{
+    // Best of a few alternating passes: both sides see the same host state
+    double ringSeconds = 0;
+    double copySeconds = 0;
+    uint32_t checksum = 0;
+    for (int pass = 0; pass < 5; pass++)
+    {
+        double ring = handoffSeconds(captures, repeat, true, checksum);
+        double copy = handoffSeconds(captures, repeat, false, checksum);
+        ringSeconds = pass == 0 ? ring : std::min(ringSeconds, ring);
+        copySeconds = pass == 0 ? copy : std::min(copySeconds, copy);
+    }
+
+    // Keeps the copies from being optimized away
+    if (checksum == 1)
+        fprintf(stderr, " ");
+    return copySeconds > 0 ? ringSeconds / copySeconds : 0;
+}
+
+static std::vector<PerfMetric> collectMetrics(const std::vector<ReplayStats> &results,
+                                              const std::vector<ReplayCapture> &captures, int repeat)
+{
+    std::vector<PerfMetric> metrics;
+    for (const ReplayStats &stats : results)
+    {
+        double reference = stats.referenceSeconds > 0 ? stats.referenceSeconds : 1e-9;
+        metrics.push_back({"detector." + stats.name + ".ref_ratio", stats.fastestPassSeconds / reference});
+        metrics.insert(metrics.end(), stats.metrics.begin(), stats.metrics.end());
+    }
+    metrics.push_back({"encode.dvz1.bytes_per_reading", encodedBytesPerReading(captures), false});
+    metrics.push_back({"ring.copy_ratio", ringCopyRatio(captures, repeat)});
+    return metrics;
+}
+
+static void replayDetectors(const std::vector<ReplayCapture> &captures, const ReplayOptions &options,
+                            std::vector<ReplayStats> &results)
+{
+    if (wants(options, "float"))
+        replayAll<HeuristicReplay<FloatDirectionDetector>>("float", captures, options, results);
+    if (wants(options, "fixed"))
+        replayAll<HeuristicReplay<FixedDirectionDetector>>("fixed", captures, options, results);
+    if (wants(options, "float-static"))
+        replayAll<HeuristicReplay<StaticFloatDirectionDetector>>("float-static", captures, options, results);
+    if (wants(options, "fixed-static"))
+        replayAll<HeuristicReplay<StaticFixedDirectionDetector>>("fixed-static", captures, options, results);
+#if REPLAY_WITH_ML
+    if (wants(options, "ml"))
+        replayAll<MLReplay>("ml", captures, options, results);
+#endif
+}
+
+static int usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [--detector float|fixed|float-static|fixed-static|ml] [--cooldown-ms N] [--multi-transit] [--skew-compensation]\n"
+            "          [--repeat N] [--per-capture] [--verbose]\n"
+            "          [--budgets FILE] [--tolerance PCT] [--record-budgets FILE] [--record-runs N] [--headroom PCT]\n"
+            "          [--codec-check]\n"
+            "          <captures or directories>...\n",
+            program);
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    ReplayOptions options;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--detector" && i + 1 < argc)
+            options.detectors.push_back(argv[++i]);
+        else if (arg == "--cooldown-ms" && i + 1 < argc)
+            options.cooldownUs = (uint32_t)atoi(argv[++i]) * 1000;
+        else if (arg == "--multi-transit")
+            options.multiTransit = true;
+        else if (arg == "--skew-compensation")
+            options.skewCompensation = true;
+        else if (arg == "--repeat" && i + 1 < argc)
+            options.repeat = max(1, atoi(argv[++i]));
+        else if (arg == "--per-capture")
+            options.perCapture = true;
+        else if (arg == "--verbose")
+            HostSerial::echo = true;
+        else if (arg == "--budgets" && i + 1 < argc)
+            options.budgetsPaths.push_back(argv[++i]);
+        else if (arg == "--tolerance" && i + 1 < argc)
+            options.tolerancePercent = atof(argv[++i]);
+        else if (arg == "--record-budgets" && i + 1 < argc)
+            options.recordPath = argv[++i];
+        else if (arg == "--record-runs" && i + 1 < argc)
+            options.recordRuns = max(1, atoi(argv[++i]));
+        else if (arg == "--headroom" && i + 1 < argc)
+            options.headroomPercent = atof(argv[++i]);
+        else if (arg == "--codec-check")
+            options.codecCheck = true;
+        else if (arg == "--event-check")
+            options.eventCheck = true;
+        else if (arg.rfind("--", 0) == 0)
+            return usage(argv[0]);
+        else
+            collectFiles(arg, files);
+    }
+    if (files.empty())
+        return usage(argv[0]);
+
+    // Load before the (long) replay, so a bad file fails fast
+    PerfBudgets budgets;
+    for (const std::string &path : options.budgetsPaths)
+    {
+        std::string error;
+        if (!budgets.load(path, error))
+        {
+            fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<ReplayCapture> captures;
+    for (const std::string &path : files)
+    {
+        ReplayCapture capture;
+        std::string error;
+        if (!loadCapture(path, capture, error))
+        {
+            fprintf(stderr, "skip %s: %s\n", path.c_str(), error.c_str());
+            continue;
+        }
+        captures.push_back(std::move(capture));
+    }
+    if (captures.empty())
+    {
+        fprintf(stderr, "no captures loaded\n");
+        return 1;
+    }
+    printf("Loaded %zu captures\n", captures.size());
+
+    if (options.codecCheck)
+        return checkCodecs(captures) ? 1 : 0;
+    if (options.eventCheck)
+        return checkEvents(captures, options.cooldownUs) ? 1 : 0;
+
+    std::vector<ReplayStats> results;
+    replayDetectors(captures, options, results);
+#if !REPLAY_WITH_ML
+    if (!options.detectors.empty() && wants(options, "ml"))
+        fprintf(stderr, "ml: not built (use env native_replay_ml)\n");
+#endif
+
+    for (const ReplayStats &stats : results)
+        printReport(stats, options.repeat);
+    printProfileComparison(results);
+    if (results.empty())
+        return 1;
+
+    int overBudget = 0;
+    if (!options.budgetsPaths.empty() || !options.recordPath.empty())
+    {
+        std::vector<PerfMetric> metrics = collectMetrics(results, captures, options.repeat);
+        if (!options.budgetsPaths.empty())
+            overBudget = budgets.check(metrics, options.tolerancePercent);
+        if (!options.recordPath.empty())
+        {
+            // The run above plus recordRuns - 1 more, quietly
+            std::vector<std::vector<PerfMetric>> runs = {metrics};
+            for (int run = 1; run < options.recordRuns; run++)
+            {
+                std::vector<ReplayStats> again;
+                replayDetectors(captures, options, again);
+                runs.push_back(collectMetrics(again, captures, options.repeat));
+            }
+            std::string note = "worst of " + std::to_string(options.recordRuns) + " runs, --repeat " +
+                               std::to_string(options.repeat);
+            if (!PerfBudgets::record(options.recordPath, PerfBudgets::worst(runs), options.headroomPercent, note))
+            {
+                fprintf(stderr, "%s: cannot write\n", options.recordPath.c_str());
+                return 1;
+            }
+            printf("\nbudgets recorded to %s\n", options.recordPath.c_str());
+        }
+    }
+
+    return overBudget ? 1 : 0;
+}
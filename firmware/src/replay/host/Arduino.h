@@ -0,0 +1,68 @@
+#ifndef REPLAY_HOST_ARDUINO_H
+#define REPLAY_HOST_ARDUINO_H
+
+/**
+ * Host stand-in for the parts of Arduino.h the detectors and codecs use
+ * (native replay build only — see ../ReplayMain.cpp)
+ *
+ * - millis()/micros() are wall-clock since process start
+ * - Serial output is discarded unless HostSerial::echo is set (--verbose)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using std::max;
+using std::min;
+
+inline unsigned long micros()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+inline void delay(unsigned long) {}
+
+class HostSerial
+{
+public:
+    static bool echo;
+
+    void printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        if (!echo)
+            return;
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+    }
+
+    void print(const char *text)
+    {
+        if (echo)
+            fputs(text, stderr);
+    }
+
+    void println(const char *text = "")
+    {
+        if (echo)
+            fprintf(stderr, "%s\n", text);
+    }
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,9 @@
+#include <Arduino.h>
+
+// Globals main.cpp defines on the device, for the host builds (replay, tests)
+
+HostSerial Serial;
+bool HostSerial::echo = false;
+
+// DirectionDetector logs only when Serial Studio is off
+bool serialStudioEnabled = false;
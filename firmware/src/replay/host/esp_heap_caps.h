@@ -0,0 +1,19 @@
+#ifndef REPLAY_HOST_ESP_HEAP_CAPS_H
+#define REPLAY_HOST_ESP_HEAP_CAPS_H
+
+// Host stand-in: one heap, every capability satisfied by malloc
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline void *heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+inline void heap_caps_free(void *ptr) { free(ptr); }
+inline size_t heap_caps_get_free_size(uint32_t) { return SIZE_MAX / 2; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return SIZE_MAX / 2; }
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef REPLAY_HOST_ESP_ROM_CRC_H
+#define REPLAY_HOST_ESP_ROM_CRC_H
+
+// Host stand-in for the ROM CRC: same result as zlib.crc32 for crc = 0
+
+#include <cstddef>
+#include <cstdint>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef REPLAY_HOST_FREERTOS_H
+#define REPLAY_HOST_FREERTOS_H
+
+/**
+ * Host stand-in for the FreeRTOS API MLDetector touches
+ *
+ * The replay is single-threaded: task creation fails (so sliding-window
+ * inference is unavailable and setInferenceMode() reports it), and queues
+ * are never created.
+ */
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+#endif
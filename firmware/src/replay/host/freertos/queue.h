@@ -0,0 +1,13 @@
+#ifndef REPLAY_HOST_FREERTOS_QUEUE_H
+#define REPLAY_HOST_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t, UBaseType_t) { return nullptr; }
+inline BaseType_t xQueueSend(QueueHandle_t, const void *, TickType_t) { return pdFAIL; }
+inline BaseType_t xQueueReceive(QueueHandle_t, void *, TickType_t) { return pdFALSE; }
+inline void vQueueDelete(QueueHandle_t) {}
+
+#endif
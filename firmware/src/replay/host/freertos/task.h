@@ -0,0 +1,21 @@
+#ifndef REPLAY_HOST_FREERTOS_TASK_H
+#define REPLAY_HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *,
+                                          UBaseType_t, TaskHandle_t *created, BaseType_t)
+{
+    if (created != nullptr)
+        *created = nullptr;
+    return pdFAIL;
+}
+
+inline void vTaskDelay(TickType_t) {}
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+
+#endif
@@ -0,0 +1,112 @@
+#include <unity.h>
+#include <cstdio>
+#include <fstream>
+#include "replay/PerfBudgets.h"
+
+static const char *BUDGET_FILE = "test_budgets.txt";
+
+static void writeFile(const char *text)
+{
+    std::ofstream out(BUDGET_FILE);
+    out << text;
+}
+
+static PerfMetric metric(const char *name, double value, bool timing = true)
+{
+    PerfMetric m;
+    m.name = name;
+    m.value = value;
+    m.timing = timing;
+    return m;
+}
+
+void setUp() {}
+void tearDown() { remove(BUDGET_FILE); }
+
+void test_load_skips_comments_and_blank_lines()
+{
+    writeFile("# header\n\ndetector.fixed.ref_ratio 15.2   # trailing\n"
+              "  encode.dvz1.bytes_per_reading 2.39\n");
+    PerfBudgets budgets;
+    std::string error;
+    TEST_ASSERT_TRUE(budgets.load(BUDGET_FILE, error));
+
+    std::vector<PerfMetric> metrics = {metric("detector.fixed.ref_ratio", 15.0),
+                                       metric("encode.dvz1.bytes_per_reading", 2.39, false)};
+    TEST_ASSERT_EQUAL_INT(0, budgets.check(metrics, 0));
+}
+
+void test_load_reports_errors()
+{
+    PerfBudgets budgets;
+    std::string error;
+    TEST_ASSERT_FALSE(budgets.load("no/such/file.txt", error));
+    TEST_ASSERT_EQUAL_STRING("cannot open", error.c_str());
+
+    writeFile("# nothing but comments\n\n");
+    TEST_ASSERT_FALSE(budgets.load(BUDGET_FILE, error));
+    TEST_ASSERT_EQUAL_STRING("no budgets", error.c_str());
+
+    writeFile("a.ratio 1.0\nb.ratio\n");
+    TEST_ASSERT_FALSE(budgets.load(BUDGET_FILE, error));
+    TEST_ASSERT_EQUAL_STRING("line 2: expected <metric> <limit>", error.c_str());
+}
+
+void test_check_ceilings_floors_and_missing_metrics()
+{
+    writeFile("cost.ratio 10\nframes_per_s 1000\nnever.measured 1\n");
+    PerfBudgets budgets;
+    std::string error;
+    TEST_ASSERT_TRUE(budgets.load(BUDGET_FILE, error));
+
+    // Within tolerance either way; the unmeasured metric still fails
+    std::vector<PerfMetric> metrics = {metric("cost.ratio", 10.9), metric("frames_per_s", 910)};
+    TEST_ASSERT_EQUAL_INT(1, budgets.check(metrics, 10));
+
+    metrics = {metric("cost.ratio", 11.5), metric("frames_per_s", 850), metric("never.measured", 0.5)};
+    TEST_ASSERT_EQUAL_INT(2, budgets.check(metrics, 10));
+}
+
+void test_worst_keeps_highest_cost_and_lowest_rate()
+{
+    std::vector<std::vector<PerfMetric>> runs = {
+        {metric("cost.ratio", 3), metric("frames_per_s", 900)},
+        {metric("cost.ratio", 5), metric("frames_per_s", 800)},
+        {metric("cost.ratio", 4), metric("frames_per_s", 950), metric("late.ratio", 1)},
+    };
+    std::vector<PerfMetric> worst = PerfBudgets::worst(runs);
+    TEST_ASSERT_EQUAL_size_t(3, worst.size());
+    TEST_ASSERT_EQUAL_DOUBLE(5, worst[0].value);
+    TEST_ASSERT_EQUAL_DOUBLE(800, worst[1].value);
+    TEST_ASSERT_EQUAL_DOUBLE(1, worst[2].value);
+}
+
+void test_record_adds_headroom_to_timings_only()
+{
+    std::vector<PerfMetric> metrics = {metric("cost.ratio", 10), metric("frames_per_s", 1000),
+                                       metric("encode.bytes_per_reading", 2.5, false)};
+    TEST_ASSERT_TRUE(PerfBudgets::record(BUDGET_FILE, metrics, 20, "unit test"));
+
+    PerfBudgets budgets;
+    std::string error;
+    TEST_ASSERT_TRUE(budgets.load(BUDGET_FILE, error));
+
+    // Limits 12, 800 and 2.5
+    metrics = {metric("cost.ratio", 11.9), metric("frames_per_s", 801),
+               metric("encode.bytes_per_reading", 2.5, false)};
+    TEST_ASSERT_EQUAL_INT(0, budgets.check(metrics, 0));
+    metrics = {metric("cost.ratio", 12.1), metric("frames_per_s", 799),
+               metric("encode.bytes_per_reading", 2.6, false)};
+    TEST_ASSERT_EQUAL_INT(3, budgets.check(metrics, 0));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_load_skips_comments_and_blank_lines);
+    RUN_TEST(test_load_reports_errors);
+    RUN_TEST(test_check_ceilings_floors_and_missing_metrics);
+    RUN_TEST(test_worst_keeps_highest_cost_and_lowest_rate);
+    RUN_TEST(test_record_adds_headroom_to_timings_only);
+    return UNITY_END();
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+#include <vector>
+#include "components/data/ColumnCodec.h"
+#include "components/data/FrameCodec.h"
+
+// Frames 1 ms apart with some timing jitter; position 5 never reads, 3 drops
+// out now and then, 1 repeats its value (held) every fourth frame
+static std::vector<SensorFrame> makeFrames(size_t count)
+{
+    std::vector<SensorFrame> frames(count);
+    uint32_t timestamp = 0xFFFFF000; // Wraps mid-stream
+    for (size_t f = 0; f < count; f++)
+    {
+        SensorFrame &frame = frames[f];
+        memset(&frame, 0, sizeof(frame));
+        timestamp += 1000 + (f % 7) * 13;
+        frame.timestamp_us = timestamp;
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            if (pos == 5 || (pos == 3 && f % 11 == 0))
+                continue;
+            frame.proximity[pos] = (uint16_t)(200 + pos * 40 + (f * (pos + 3)) % 97);
+            frame.ambient[pos] = (uint16_t)(5 + f % 3);
+            frame.valid_mask |= (SensorMask)1 << pos;
+        }
+        if (f > 0 && f % 4 == 0)
+        {
+            frame.proximity[1] = frames[f - 1].proximity[1];
+            frame.ambient[1] = frames[f - 1].ambient[1];
+            frame.valid_mask &= (SensorMask)~2;
+            frame.held_mask |= 2;
+        }
+    }
+    return frames;
+}
+
+static void assertSameFrame(const SensorFrame &expected, const SensorFrame &actual)
+{
+    TEST_ASSERT_EQUAL_UINT32(expected.timestamp_us, actual.timestamp_us);
+    TEST_ASSERT_EQUAL_UINT32(expected.valid_mask, actual.valid_mask);
+    TEST_ASSERT_EQUAL_UINT32(expected.held_mask, actual.held_mask);
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        if (!expected.isValid(pos) && !expected.isHeld(pos))
+            continue;
+        TEST_ASSERT_EQUAL_UINT16(expected.proximity[pos], actual.proximity[pos]);
+        TEST_ASSERT_EQUAL_UINT16(expected.ambient[pos], actual.ambient[pos]);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_dvz1_round_trip()
+{
+    std::vector<SensorFrame> frames = makeFrames(300);
+    std::vector<uint8_t> block(frames.size() * FRAME_CODEC_MAX_FRAME_BYTES);
+    FrameEncoder encoder;
+    size_t length = 0;
+    for (const SensorFrame &frame : frames)
+        length += encoder.encode(frame, block.data() + length);
+
+    FrameDecoder decoder;
+    size_t at = 0;
+    for (const SensorFrame &frame : frames)
+    {
+        SensorFrame decoded;
+        size_t used = decoder.decode(block.data() + at, length - at, decoded);
+        TEST_ASSERT_NOT_EQUAL(0, used);
+        at += used;
+        assertSameFrame(frame, decoded);
+    }
+    TEST_ASSERT_EQUAL_size_t(length, at);
+}
+
+// Encoded size of frames[1] after frames[0], checked to round-trip
+static size_t encodeSecond(const std::vector<SensorFrame> &frames)
+{
+    uint8_t block[2 * FRAME_CODEC_MAX_FRAME_BYTES];
+    FrameEncoder encoder;
+    size_t first = encoder.encode(frames[0], block);
+    size_t second = encoder.encode(frames[1], block + first);
+
+    FrameDecoder decoder;
+    SensorFrame decoded;
+    TEST_ASSERT_EQUAL_size_t(first, decoder.decode(block, first + second, decoded));
+    TEST_ASSERT_EQUAL_size_t(second, decoder.decode(block + first, second, decoded));
+    assertSameFrame(frames[1], decoded);
+    return second;
+}
+
+void test_dvz1_held_reading_costs_no_value()
+{
+    std::vector<SensorFrame> frames = makeFrames(2);
+    frames[1] = frames[0];
+    frames[1].timestamp_us += 1000;
+    size_t sentBytes = encodeSecond(frames);
+
+    frames[1].valid_mask &= (SensorMask)~1;
+    frames[1].held_mask |= 1;
+    size_t heldBytes = encodeSecond(frames);
+
+    // Held: the two zero deltas (1 byte each) are not sent, the mask varint
+    // grows from 1 to 3 bytes for bit 16
+    TEST_ASSERT_EQUAL_size_t(sentBytes, heldBytes);
+}
+
+void test_dvz1_truncated_input_is_rejected()
+{
+    std::vector<SensorFrame> frames = makeFrames(1);
+    uint8_t buffer[FRAME_CODEC_MAX_FRAME_BYTES];
+    FrameEncoder encoder;
+    size_t length = encoder.encode(frames[0], buffer);
+
+    FrameDecoder decoder;
+    SensorFrame decoded;
+    TEST_ASSERT_EQUAL_size_t(0, decoder.decode(buffer, length - 1, decoded));
+}
+
+void test_col1_round_trip()
+{
+    std::vector<SensorFrame> frames = makeFrames(400);
+    std::vector<SensorFrame> decoded(frames.size());
+    std::vector<uint8_t> column(COLUMN_CODEC_MAX_TIMESTAMP_BYTES(frames.size()));
+
+    size_t length = ColumnCodec::encodeTimestamps(frames.data(), frames.size(), column.data());
+    TEST_ASSERT_TRUE(ColumnCodec::decodeTimestamps(column.data(), length, decoded.data(), decoded.size()));
+
+    column.resize(COLUMN_CODEC_MAX_POSITION_BYTES(frames.size()));
+    for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+    {
+        length = ColumnCodec::encodePosition(frames.data(), frames.size(), pos, column.data());
+        if (pos == 5)
+            TEST_ASSERT_EQUAL_size_t(0, length);
+        TEST_ASSERT_TRUE(ColumnCodec::decodePosition(column.data(), length, pos, decoded.data(), decoded.size()));
+    }
+
+    for (size_t f = 0; f < frames.size(); f++)
+        assertSameFrame(frames[f], decoded[f]);
+}
+
+void test_col1_leftover_bytes_are_rejected()
+{
+    std::vector<SensorFrame> frames = makeFrames(10);
+    std::vector<SensorFrame> decoded(frames.size());
+    std::vector<uint8_t> column(COLUMN_CODEC_MAX_TIMESTAMP_BYTES(frames.size()) + 1);
+
+    size_t length = ColumnCodec::encodeTimestamps(frames.data(), frames.size(), column.data());
+    column[length] = 0;
+    TEST_ASSERT_FALSE(ColumnCodec::decodeTimestamps(column.data(), length + 1, decoded.data(), decoded.size()));
+    TEST_ASSERT_FALSE(ColumnCodec::decodeTimestamps(column.data(), length - 1, decoded.data(), decoded.size()));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_dvz1_round_trip);
+    RUN_TEST(test_dvz1_held_reading_costs_no_value);
+    RUN_TEST(test_dvz1_truncated_input_is_rejected);
+    RUN_TEST(test_col1_round_trip);
+    RUN_TEST(test_col1_leftover_bytes_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+#include <unity.h>
+#include "components/detection/DirectionDetector.h"
+
+static const uint16_t BASELINE = 100;
+static const uint16_t PEAK = 400;
+static const uint32_t FRAME_US = 1000;
+
+// Module 1 (positions 0, 1) sees a 40 ms wave, side B lagging by lagMs
+// (negative: B first); the other modules stay flat
+struct TransitSignal
+{
+    int32_t lagMs;
+
+    uint16_t proximity(uint8_t pos, uint32_t ms, uint32_t startMs) const
+    {
+        if (pos > 1)
+            return BASELINE;
+        int32_t t = (int32_t)(ms - startMs) - (pos == 1 ? lagMs : 0);
+        if (t < 0 || t >= 40)
+            return BASELINE;
+        int32_t rise = t < 20 ? t : 40 - t;
+        return (uint16_t)(BASELINE + (PEAK - BASELINE) * rise / 20);
+    }
+};
+
+// Feed frames [fromMs, toMs); transits start at each of startMs (0: none)
+template <typename Detector>
+static int feed(Detector &detector, uint32_t fromMs, uint32_t toMs, const TransitSignal *signal,
+                uint32_t startMs, Direction *direction = nullptr)
+{
+    int detections = 0;
+    for (uint32_t ms = fromMs; ms < toMs; ms++)
+    {
+        SensorFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.timestamp_us = ms * FRAME_US;
+        for (uint8_t pos = 0; pos < NUM_SENSORS; pos++)
+        {
+            frame.proximity[pos] = signal ? signal->proximity(pos, ms, startMs) : BASELINE;
+            frame.valid_mask |= (SensorMask)1 << pos;
+        }
+        detector.addFrame(frame);
+        if (!detector.hasDetection())
+            continue;
+        DetectionResult result = detector.getResult();
+        if (direction)
+            *direction = result.direction;
+        detections++;
+        detector.reset();
+    }
+    return detections;
+}
+
+template <typename Detector>
+static void checkTransit(int32_t lagMs, Direction expected)
+{
+    Detector *detector = new Detector(); // Large (baseline rings): off the stack
+    detector->setConfig(DetectorConfig());
+    detector->fullReset();
+
+    TEST_ASSERT_EQUAL_INT(0, feed(*detector, 0, 100, nullptr, 0));
+    TEST_ASSERT_TRUE(detector->isReady());
+
+    TransitSignal signal = {lagMs};
+    Direction direction = Direction::UNKNOWN;
+    TEST_ASSERT_EQUAL_INT(1, feed(*detector, 100, 400, &signal, 150, &direction));
+    TEST_ASSERT_TRUE(direction == expected);
+    delete detector;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_flat_signal_gives_no_detection()
+{
+    FloatDirectionDetector *detector = new FloatDirectionDetector();
+    detector->setConfig(DetectorConfig());
+    detector->fullReset();
+    TEST_ASSERT_FALSE(detector->isReady());
+    TEST_ASSERT_EQUAL_INT(0, feed(*detector, 0, 2000, nullptr, 0));
+    TEST_ASSERT_TRUE(detector->isReady());
+    delete detector;
+}
+
+void test_float_a_to_b() { checkTransit<FloatDirectionDetector>(12, Direction::A_TO_B); }
+void test_float_b_to_a() { checkTransit<FloatDirectionDetector>(-12, Direction::B_TO_A); }
+void test_fixed_a_to_b() { checkTransit<FixedDirectionDetector>(12, Direction::A_TO_B); }
+void test_fixed_b_to_a() { checkTransit<FixedDirectionDetector>(-12, Direction::B_TO_A); }
+
+void test_latch_reports_a_held_detection_once()
+{
+    DetectionLatch latch;
+    TEST_ASSERT_FALSE(latch.report(false, false));
+    TEST_ASSERT_TRUE(latch.report(true, false));
+    TEST_ASSERT_FALSE(latch.report(true, false));
+    TEST_ASSERT_FALSE(latch.report(true, false));
+
+    // Detector reset: the next detection is reported again
+    TEST_ASSERT_FALSE(latch.report(false, false));
+    TEST_ASSERT_TRUE(latch.report(true, false));
+}
+
+void test_latch_passes_consumed_results()
+{
+    DetectionLatch latch;
+    TEST_ASSERT_TRUE(latch.report(true, true));
+    TEST_ASSERT_TRUE(latch.report(true, true));
+    TEST_ASSERT_FALSE(latch.report(false, true));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_flat_signal_gives_no_detection);
+    RUN_TEST(test_float_a_to_b);
+    RUN_TEST(test_float_b_to_a);
+    RUN_TEST(test_fixed_a_to_b);
+    RUN_TEST(test_fixed_b_to_a);
+    RUN_TEST(test_latch_reports_a_held_detection_once);
+    RUN_TEST(test_latch_passes_consumed_results);
+    return UNITY_END();
+}
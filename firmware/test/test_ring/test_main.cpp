@@ -0,0 +1,94 @@
+#include <unity.h>
+#include "components/memory/SPSCRing.h"
+
+typedef SPSCRing<uint32_t, 8> Ring;
+
+void setUp() {}
+void tearDown() {}
+
+void test_pop_returns_items_in_order()
+{
+    Ring ring;
+    uint32_t item = 0;
+    TEST_ASSERT_FALSE(ring.pop(item));
+    TEST_ASSERT_TRUE(ring.empty());
+
+    for (uint32_t i = 1; i <= 3; i++)
+        TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_EQUAL_size_t(3, ring.size());
+
+    for (uint32_t i = 1; i <= 3; i++)
+    {
+        TEST_ASSERT_TRUE(ring.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item);
+    }
+    TEST_ASSERT_FALSE(ring.pop(item));
+}
+
+void test_full_ring_rejects_and_counts()
+{
+    Ring ring;
+    for (uint32_t i = 0; i < Ring::capacity(); i++)
+        TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_FALSE(ring.push(100));
+    TEST_ASSERT_FALSE(ring.push(101));
+    TEST_ASSERT_EQUAL_UINT32(2, ring.overflowCount());
+    TEST_ASSERT_EQUAL_size_t(Ring::capacity(), ring.size());
+
+    // The rejected items were dropped, not written over the oldest
+    uint32_t item = 0;
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL_UINT32(0, item);
+    TEST_ASSERT_TRUE(ring.push(8));
+
+    ring.resetOverflowCount();
+    TEST_ASSERT_EQUAL_UINT32(0, ring.overflowCount());
+}
+
+void test_pop_bulk_across_the_wrap()
+{
+    Ring ring;
+    uint32_t out[Ring::capacity()];
+    uint32_t next = 0;
+    uint32_t expected = 0;
+
+    // Indices run past the end of the storage several times
+    for (int round = 0; round < 5; round++)
+    {
+        for (int i = 0; i < 6; i++)
+            TEST_ASSERT_TRUE(ring.push(next++));
+
+        TEST_ASSERT_EQUAL_size_t(4, ring.popBulk(out, 4));
+        for (size_t i = 0; i < 4; i++)
+            TEST_ASSERT_EQUAL_UINT32(expected++, out[i]);
+
+        TEST_ASSERT_EQUAL_size_t(2, ring.popBulk(out, Ring::capacity()));
+        for (size_t i = 0; i < 2; i++)
+            TEST_ASSERT_EQUAL_UINT32(expected++, out[i]);
+    }
+    TEST_ASSERT_EQUAL_size_t(0, ring.popBulk(out, Ring::capacity()));
+}
+
+void test_discard_all_empties_the_ring()
+{
+    Ring ring;
+    for (uint32_t i = 0; i < 5; i++)
+        ring.push(i);
+    TEST_ASSERT_EQUAL_size_t(5, ring.discardAll());
+    TEST_ASSERT_TRUE(ring.empty());
+
+    uint32_t item = 0;
+    TEST_ASSERT_TRUE(ring.push(42));
+    TEST_ASSERT_TRUE(ring.pop(item));
+    TEST_ASSERT_EQUAL_UINT32(42, item);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_pop_returns_items_in_order);
+    RUN_TEST(test_full_ring_rejects_and_counts);
+    RUN_TEST(test_pop_bulk_across_the_wrap);
+    RUN_TEST(test_discard_all_empties_the_ring);
+    return UNITY_END();
+}
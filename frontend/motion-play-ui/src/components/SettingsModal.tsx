@@ -17,7 +17,8 @@ interface SensorConfig {
     // Primary sensor mode selection
     sensor_mode: 'polling' | 'interrupt';
     // Detection algorithm mode
-    detection_mode: 'heuristic' | 'ml';
+    detection_mode: 'heuristic' | 'ml' | 'ml_sliding';
+    ml_stride_ms?: number;          // Sliding ML: ms between inferences
     // Polling mode settings
     sample_rate_hz: number;
     led_current: string;
@@ -103,6 +104,7 @@ export const SettingsModal = ({ isOpen, onClose }: SettingsModalProps) => {
                 sensor_mode: cloudConfig.sensor_mode ?? 'polling',
                 // Detection algorithm
                 detection_mode: cloudConfig.detection_mode ?? 'heuristic',
+                ml_stride_ms: cloudConfig.ml_stride_ms ?? 40,
                 // Polling settings
                 i2c_clock_khz: cloudConfig.i2c_clock_khz || 400,
                 multi_pulse: cloudConfig.multi_pulse || '1',
@@ -250,14 +252,43 @@ export const SettingsModal = ({ isOpen, onClose }: SettingsModalProps) => {
                             >
                                 ML (Neural Network)
                             </button>
+                            <button
+                                onClick={() => setConfig({ ...config, detection_mode: 'ml_sliding' })}
+                                className={`px-4 py-2 rounded-lg text-sm font-medium transition-all ${config.detection_mode === 'ml_sliding'
+                                    ? 'bg-purple-600 text-white shadow-md'
+                                    : 'bg-white text-gray-700 border border-gray-300 hover:bg-gray-50'
+                                    }`}
+                            >
+                                ML Sliding
+                            </button>
                         </div>
                     </div>
                     <p className="text-xs text-gray-500 mt-1">
                         {config.detection_mode === 'heuristic'
                             ? 'Wave envelope + center-of-mass algorithm. Well-tested, no model required.'
-                            : 'TFLite Micro 1D CNN inference on-device. Experimental — requires trained model in firmware.'}
+                            : config.detection_mode === 'ml'
+                                ? 'TFLite Micro 1D CNN inference on-device. Experimental — requires trained model in firmware.'
+                                : 'CNN runs continuously on the latest 300ms window, no threshold trigger. Catches weak transits earlier, at more CPU.'}
                     </p>
 
+                    {config.detection_mode === 'ml_sliding' && (
+                        <div className="mt-3 pt-3 border-t border-gray-200">
+                            <label className="flex items-center text-xs text-gray-600 mb-1">
+                                Inference Stride (ms)
+                                <Tooltip text="Time between inferences. Shorter = earlier detection; windows are skipped if inference takes longer than the stride." />
+                            </label>
+                            <input
+                                type="number"
+                                value={config.ml_stride_ms}
+                                onChange={(e) => setConfig({ ...config, ml_stride_ms: parseInt(e.target.value) || 40 })}
+                                min={10}
+                                max={200}
+                                step={5}
+                                className="w-24 px-2 py-1.5 border border-gray-300 rounded-md focus:outline-none focus:ring-2 focus:ring-purple-500 text-sm"
+                            />
+                        </div>
+                    )}
+
                     {/* Detection algorithm tuning (heuristic only) */}
                     {config.detection_mode === 'heuristic' && (
                         <div className="mt-3 pt-3 border-t border-gray-200">
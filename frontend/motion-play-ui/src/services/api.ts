@@ -111,6 +111,7 @@ export interface InterruptEvent {
     sensor_position: number;
     event_type: 'close' | 'away' | 'unknown';
     raw_flags?: number;
+    proximity?: number;          // PS_DATA at the edge (absent for older firmware)
 }
 
 export interface ActiveSensor {
@@ -160,6 +161,20 @@ class MotionPlayAPI {
         });
     }
 
+    // Re-fetch part of a session the device still holds on flash (spill_to_flash
+    // sessions, until the next one starts). Readings arrive through processData.
+    async fetchRange(sessionId: string, range: {
+        start_ms?: number;
+        end_ms?: number;
+        positions?: number[];
+        fetch_id?: string;
+    }): Promise<void> {
+        await this.sendCommand('fetch_range', {
+            session_id: sessionId,
+            ...range
+        });
+    }
+
     // Configure sensors (DEPRECATED - use updateDeviceConfig instead)
     async configureSensors(config: {
         sample_rate: number;
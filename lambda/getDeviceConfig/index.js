@@ -16,9 +16,12 @@ const DEVICES_TABLE = process.env.DEVICES_TABLE || 'MotionPlayDevices';
 // Default sensor configuration
 const DEFAULT_CONFIG = {
     // Primary sensor mode
-    sensor_mode: "polling",  // "polling" or "interrupt"
+    sensor_mode: "polling",  // "polling", "interrupt" or "hybrid"
     // Detection algorithm mode
-    detection_mode: "heuristic",  // "heuristic" or "ml"
+    detection_mode: "heuristic",  // "heuristic", "ml" (triggered), "ml_sliding" or "ensemble"
+    ml_stride_ms: 40,             // ml_sliding: ms between inferences
+    ensemble_confidence: 0.7,     // ensemble: heuristic confidence that skips the model
+    ensemble_min_gap_ms: 10,      // ensemble: ...with at least this COM gap
     // Polling mode settings
     sample_rate_hz: 1000,
     led_current: "200mA",
@@ -26,6 +29,9 @@ const DEFAULT_CONFIG = {
     duty_cycle: "1/40",
     high_resolution: true,
     read_ambient: true,
+    active_force: false,          // Trigger all sensors together each cycle instead of free-running
+    skew_compensation: false,     // Frames carry each sensor's sample instant; detectors use it for timing
+    duplicate_mode: "off",        // "match" = read no faster than the sensors convert, "suppress" = drop repeats
     i2c_clock_khz: 400,
     multi_pulse: "1",
     // Interrupt mode settings (calibration-based)
@@ -36,11 +42,39 @@ const DEFAULT_CONFIG = {
     interrupt_persistence: 1,
     interrupt_smart_persistence: true,
     interrupt_mode: "normal",
+    // Hybrid mode settings (interrupt idle, polling bursts)
+    hybrid_idle_duty_cycle: "1/160",  // Sensor duty while waiting for INT
+    hybrid_burst_window_ms: 1500,     // Burst ends this long after the last activity
+    hybrid_burst_max_ms: 10000,       // Hard cap on one burst
+    hybrid_burst_all_boards: true,    // false = poll only the boards that fired
+    light_sleep_idle: false,          // Light sleep while waiting for an INT line
+    light_sleep_max_ms: 200,          // Longest sleep before the main loop runs again
+    // Adaptive sample rate (polling sessions with the heuristic detector)
+    adaptive_rate: false,             // Drop to the idle rate while nothing is near threshold
+    adaptive_idle_rate_hz: 100,       // Idle sample rate
+    adaptive_approach_fraction: 0.5,  // Full rate from this fraction of the way to threshold
+    adaptive_hold_ms: 500,            // Full rate kept this long after activity drops
+    auto_calibration: true,           // Thresholds / PS_CANC follow idle drift while detecting
+    // Power profiles (battery installs, INA219 on VSYS)
+    power_profile: 'auto',            // auto, performance, balanced, saver or off
+    power_balanced_below_v: 3.7,      // VSYS on battery below which BALANCED applies
+    power_saver_below_v: 3.5,         // ...and SAVER
+    power_current_budget_ma: 0,       // One profile lower while drawing more (0 = no budget)
     // Detection algorithm parameters (heuristic mode)
     peak_multiplier: 1.5,             // Adaptive threshold sensitivity
     min_rise: 10,                     // Minimum absolute signal rise
     min_wave_duration_ms: 8,          // Noise spike filter (ms)
-    smoothing_window: 5               // Signal smoothing window size
+    smoothing_window: 5,              // Signal smoothing window size
+    multi_transit: false,             // Pipelined waves: back-to-back transits without cooldown
+    // Upload settings
+    upload_format: "json",            // "json", "binary" or "delta" (see infrastructure/WIRE_FORMATS.md)
+    spill_to_flash: false,            // Debug sessions stream to flash (minutes instead of 30 s)
+    lan_stream: false,                // Detections as UDP datagrams on the local network
+    lan_stream_frames: false,         // ...plus the live sensor frames
+    array_role: "off",                // "peer" / "coordinator": units on one hoop share a clock, coordinator merges detections
+    // Live Debug capture window around each detection
+    capture_pre_trigger_ms: 500,      // Data before the detecting frame
+    capture_post_trigger_ms: 250      // Data after it before the capture is cut
 };
 
 exports.handler = async (event) => {
@@ -120,7 +120,8 @@ async function getInterruptSessionData(session) {
         board_id: item.board_id,
         sensor_position: item.sensor_position,
         event_type: item.event_type,
-        raw_flags: item.raw_flags
+        raw_flags: item.raw_flags,
+        proximity: item.proximity
     }));
     
     // Sort by timestamp
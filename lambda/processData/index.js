@@ -62,13 +62,48 @@ exports.handler = async (event) => {
     console.log('Received event:', JSON.stringify(event, null, 2));
     
     try {
-        const data = event;
+        let data = event;
+        
+        // Raw binary Live Debug capture (motionplay/+/data/bin, firmware built with
+        // LIVE_DEBUG_RAW_BINARY). The IoT rule wraps the payload as base64:
+        // [u32 LE header length][header JSON][bin9/dvz1 readings]
+        if (data.raw_b64) {
+            data = unpackRawCapture(data.raw_b64);
+        }
+        
+        // Delta-compressed readings (upload_format "delta"): expand to bin9 so
+        // every binary path below handles one reading format; held readings
+        // (duplicate_mode "suppress") have no bin9 form and travel beside it
+        if (data.reading_format === 'dvz1' && data.readings_b64) {
+            const decoded = decodeDvz1Frames(data.readings_b64, data.frame_count, data.reading_count);
+            data.readings_b64 = decoded.bin9.toString('base64');
+            data.held_readings = decoded.held;
+            data.reading_format = 'bin9';
+        }
+        
+        // Binary session batches (upload_format "binary"/"delta"): decode into the same
+        // readings/events arrays the JSON batches carry, then reuse the batch paths
+        if (data.reading_format === 'bin9' && data.readings_b64 && data.batch_offset !== undefined) {
+            data.readings = decodeBin9Readings(data.readings_b64, data.reading_count);
+            delete data.readings_b64;
+            return await processProximitySession(data);
+        }
+        if ((data.event_format === 'ibin10' || data.event_format === 'ibin8') && data.events_b64) {
+            data.events = decodeIbinEvents(data.events_b64, data.event_count, data.event_format === 'ibin10' ? 10 : 8);
+            delete data.events_b64;
+            return await processInterruptSession(data);
+        }
         
         // Binary-packed Live Debug capture (data + summary in single message)
         if (data.reading_format === 'bin9' && data.readings_b64) {
             return await processBinarySession(data);
         }
         
+        // Range fetch: col1 chunks of a session stored on the device
+        if (data.type === 'session_range' && data.reading_format === 'col1') {
+            return await processSessionRange(data);
+        }
+        
         // Session Confirmation: handle summary message (separate from data batches)
         if (data.type === 'session_summary') {
             return await processSessionSummary(data);
@@ -206,19 +241,21 @@ async function processInterruptSession(data) {
                 const eventIndex = batchOffset + i + idx;
                 const compositeKey = eventIndex;  // Simple incrementing index
                 
-                return {
-                    PutRequest: {
-                        Item: {
-                            session_id: data.session_id,
-                            event_index: compositeKey,
-                            timestamp_us: evt.ts,
-                            board_id: evt.board,
-                            sensor_position: evt.sensor,
-                            event_type: evt.type,  // "close" or "away"
-                            raw_flags: evt.flags || 0
-                        }
-                    }
+                const item = {
+                    session_id: data.session_id,
+                    event_index: compositeKey,
+                    timestamp_us: evt.ts,
+                    board_id: evt.board,
+                    sensor_position: evt.sensor,
+                    event_type: evt.type,  // "close" or "away"
+                    raw_flags: evt.flags || 0
                 };
+                // PS_DATA at the edge (firmware with batched flag reads)
+                if (evt.prox !== undefined) {
+                    item.proximity = evt.prox;
+                }
+                
+                return { PutRequest: { Item: item } };
             });
             
             // Write batch with retry
@@ -437,6 +474,12 @@ async function processProximitySession(data) {
                 if (data.detection_confidence !== undefined && Number.isFinite(data.detection_confidence)) {
                     sessionItem.detection_confidence = data.detection_confidence;
                 }
+
+                // Shared clock across units (hoop arrays): start_timestamp on it
+                if (data.start_sync_us !== undefined) {
+                    sessionItem.start_sync_us = String(data.start_sync_us);
+                    sessionItem.clock_sync = data.clock || 'sntp';
+                }
                 
                 await docClient.send(new PutCommand({
                     TableName: SESSIONS_TABLE,
@@ -464,77 +507,7 @@ async function processProximitySession(data) {
         }
         
     // Store sensor readings
-        if (data.readings && data.readings.length > 0) {
-            console.log(`Processing ${data.readings.length} readings for session ${data.session_id}`);
-            
-            const batchSize = 25;
-            const readings = data.readings;
-        const startTimestamp = Number(data.start_timestamp);
-        const isTimestampMicroseconds = data.timestamp_unit === 'us';
-            
-            for (let i = 0; i < readings.length; i += batchSize) {
-                const batch = readings.slice(i, i + batchSize);
-                const putRequests = batch.map(reading => {
-                    const absoluteTimestamp = reading.ts || reading.t;
-                    const relativeTimestamp = absoluteTimestamp - startTimestamp;
-                    const position = reading.pos !== undefined ? reading.pos : reading.p;
-                    
-                    // Composite key: (relativeTimestamp * 10) + position
-                    // With microsecond timestamps, this provides unique keys at >1000Hz cycle rates
-                    // Old firmware sends millisecond timestamps; new firmware sends microsecond timestamps
-                    const compositeKey = (relativeTimestamp * 10) + position;
-                    
-                    // Derive millisecond timestamp for query convenience
-                    const timestampMs = isTimestampMicroseconds 
-                        ? Math.floor(relativeTimestamp / 1000)
-                        : relativeTimestamp;
-                    
-                return {
-                    PutRequest: {
-                        Item: {
-                        session_id: data.session_id,
-                            timestamp_offset: compositeKey,
-                            timestamp_ms: timestampMs,
-                            position: position,
-                            pcb_id: reading.pcb || 0,
-                            side: reading.side || 0,
-                        proximity: reading.prox || 0,
-                        ambient: reading.amb || 0
-                        }
-                        }
-                    };
-                });
-                
-            let requestItems = { [SENSOR_DATA_TABLE]: putRequests };
-                let retryCount = 0;
-                const maxRetries = 3;
-                
-                while (requestItems && Object.keys(requestItems).length > 0 && retryCount <= maxRetries) {
-                    if (retryCount > 0) {
-                        const delay = 100 * Math.pow(2, retryCount - 1);
-                        await new Promise(resolve => setTimeout(resolve, delay));
-                    }
-                    
-                    const batchWriteResult = await docClient.send(new BatchWriteCommand({
-                        RequestItems: requestItems
-                    }));
-                    
-                    if (batchWriteResult.UnprocessedItems && 
-                    batchWriteResult.UnprocessedItems[SENSOR_DATA_TABLE]?.length > 0) {
-                        requestItems = batchWriteResult.UnprocessedItems;
-                        retryCount++;
-                    } else {
-                        requestItems = null;
-                    console.log(`Stored batch ${Math.floor(i / batchSize) + 1}`);
-                    }
-                }
-                
-                if (requestItems && Object.keys(requestItems).length > 0) {
-                    const failedCount = requestItems[SENSOR_DATA_TABLE]?.length || 0;
-                    throw new Error(`Failed to write ${failedCount} items after ${maxRetries} retries`);
-            }
-        }
-        }
+        await storeReadings(data);
         
         return {
             statusCode: 200,
@@ -546,12 +519,381 @@ async function processProximitySession(data) {
         };
     }
 
+// Sensor readings (and held_readings) -> SENSOR_DATA_TABLE, 25 per BatchWrite
+// with retries. Keys derive from the reading itself, so storing a reading
+// again is a no-op.
+async function storeReadings(data) {
+    const readings = (data.readings || []).concat(data.held_readings || []);
+    if (readings.length === 0) {
+        return;
+    }
+    console.log(`Processing ${readings.length} readings for session ${data.session_id}`);
+
+    const batchSize = 25;
+    const startTimestamp = Number(data.start_timestamp);
+    const isTimestampMicroseconds = data.timestamp_unit === 'us';
+
+    for (let i = 0; i < readings.length; i += batchSize) {
+        const batch = readings.slice(i, i + batchSize);
+        const putRequests = batch.map(reading => {
+            const absoluteTimestamp = reading.ts || reading.t;
+            const relativeTimestamp = absoluteTimestamp - startTimestamp;
+            const position = reading.pos !== undefined ? reading.pos : reading.p;
+
+            // Composite key: (relativeTimestamp * 10) + position
+            // With microsecond timestamps, this provides unique keys at >1000Hz cycle rates
+            // (positions 10-15 of extra boards spill into ts+1, which no cycle uses)
+            // Old firmware sends millisecond timestamps; new firmware sends microsecond timestamps
+            const compositeKey = (relativeTimestamp * 10) + position;
+
+            // Derive millisecond timestamp for query convenience
+            const timestampMs = isTimestampMicroseconds
+                ? Math.floor(relativeTimestamp / 1000)
+                : relativeTimestamp;
+
+            const item = {
+                session_id: data.session_id,
+                timestamp_offset: compositeKey,
+                timestamp_ms: timestampMs,
+                position: position,
+                pcb_id: reading.pcb || 0,
+                side: reading.side || 0,
+                proximity: reading.prox || 0,
+                ambient: reading.amb || 0
+            };
+            // Repeat of the position's previous value (duplicate_mode "suppress")
+            if (reading.held) {
+                item.held = true;
+            }
+            return { PutRequest: { Item: item } };
+        });
+
+        let requestItems = { [SENSOR_DATA_TABLE]: putRequests };
+        let retryCount = 0;
+        const maxRetries = 3;
+
+        while (requestItems && Object.keys(requestItems).length > 0 && retryCount <= maxRetries) {
+            if (retryCount > 0) {
+                const delay = 100 * Math.pow(2, retryCount - 1);
+                await new Promise(resolve => setTimeout(resolve, delay));
+            }
+
+            const batchWriteResult = await docClient.send(new BatchWriteCommand({
+                RequestItems: requestItems
+            }));
+
+            if (batchWriteResult.UnprocessedItems &&
+                batchWriteResult.UnprocessedItems[SENSOR_DATA_TABLE]?.length > 0) {
+                requestItems = batchWriteResult.UnprocessedItems;
+                retryCount++;
+            } else {
+                requestItems = null;
+                console.log(`Stored batch ${Math.floor(i / batchSize) + 1}`);
+            }
+        }
+
+        if (requestItems && Object.keys(requestItems).length > 0) {
+            const failedCount = requestItems[SENSOR_DATA_TABLE]?.length || 0;
+            throw new Error(`Failed to write ${failedCount} items after ${maxRetries} retries`);
+        }
+    }
+}
+
+// ============================================================================
+// Range fetch (fetch_range command): col1 chunks of a session kept on the
+// device. Fills in readings only; session counters belong to the upload.
+// ============================================================================
+
+async function processSessionRange(data) {
+    if (!data.session_id || !data.readings_b64) {
+        throw new Error('Missing required fields');
+    }
+    data.readings = decodeCol1Ranges(data.readings_b64, data.chunk_count, data.positions);
+    delete data.readings_b64;
+    await storeReadings(data);
+
+    return {
+        statusCode: 200,
+        body: JSON.stringify({
+            message: 'Session range processed successfully',
+            session_id: data.session_id,
+            fetch_id: data.fetch_id,
+            part: data.part,
+            readings_count: data.readings.length
+        })
+    };
+}
+
+// col1 range records (see infrastructure/WIRE_FORMATS.md), one per chunk:
+//   u16 frames | u16 ts_bytes | u16 col_bytes per position in the mask
+//   timestamp column, then the columns of the masked positions
+function decodeCol1Ranges(b64, chunkCount, positionMask) {
+    const buf = Buffer.from(b64, 'base64');
+    const positions = [];
+    for (let pos = 0; pos < 16; pos++) {
+        if ((positionMask >> pos) & 1) positions.push(pos);
+    }
+    const readings = [];
+    let off = 0;
+
+    const readUvarint = (end) => {
+        let value = 0;
+        for (let i = 0; i < 5; i++) {
+            if (off >= end) break;
+            const b = buf[off++];
+            value += (b & 0x7F) * Math.pow(2, 7 * i);
+            if ((b & 0x80) === 0) return value;
+        }
+        throw new Error(`col1 varint truncated at byte ${off}`);
+    };
+    const readVarint = (end) => {
+        const value = readUvarint(end);
+        return (value % 2) ? -(value + 1) / 2 : value / 2;
+    };
+
+    for (let c = 0; c < chunkCount; c++) {
+        if (off + 4 + 2 * positions.length > buf.length) {
+            throw new Error(`col1 payload truncated at chunk ${c}/${chunkCount}`);
+        }
+        const frames = buf.readUInt16LE(off);
+        const tsBytes = buf.readUInt16LE(off + 2);
+        const colBytes = positions.map((_, i) => buf.readUInt16LE(off + 4 + 2 * i));
+        off += 4 + 2 * positions.length;
+
+        // Timestamp column: delta-of-delta, predictors reset per chunk
+        const ts = new Array(frames);
+        let prevTs = 0;
+        let prevDelta = 0;
+        let end = off + tsBytes;
+        for (let f = 0; f < frames; f++) {
+            prevDelta = (prevDelta + readVarint(end)) >>> 0;
+            prevTs = (prevTs + prevDelta) >>> 0;
+            ts[f] = prevTs;
+        }
+        if (off !== end) {
+            throw new Error(`col1 timestamp column size mismatch in chunk ${c}`);
+        }
+
+        positions.forEach((pos, i) => {
+            end = off + colBytes[i];
+            if (colBytes[i] === 0) return;
+            if (end > buf.length) {
+                throw new Error(`col1 column truncated in chunk ${c}`);
+            }
+            const flags = buf[off++];
+            let bitmap = null;
+            let heldBitmap = null;
+            if (!(flags & 0x01)) {
+                bitmap = buf.subarray(off, off + Math.ceil(frames / 8));
+                off += bitmap.length;
+            }
+            if (flags & 0x04) {
+                heldBitmap = buf.subarray(off, off + Math.ceil(frames / 8));
+                off += heldBitmap.length;
+            }
+            // Frames with a value, and frames held (value = the predictor)
+            const rows = [];
+            for (let f = 0; f < frames; f++) {
+                const value = !bitmap || ((bitmap[f >> 3] >> (f & 7)) & 1) === 1;
+                const held = heldBitmap !== null && ((heldBitmap[f >> 3] >> (f & 7)) & 1) === 1;
+                if (value || held) rows.push({ f, value, held });
+            }
+            const prox = [];
+            let prev = 0;
+            for (const row of rows) {
+                if (row.value) prev = (prev + readVarint(end)) & 0xFFFF;
+                prox.push(prev);
+            }
+            prev = 0;
+            rows.forEach((row, k) => {
+                if ((flags & 0x02) && row.value) {
+                    prev = (prev + readVarint(end)) & 0xFFFF;
+                }
+                const reading = {
+                    ts: ts[row.f],
+                    pos: pos,
+                    pcb: Math.floor(pos / 2) + 1,
+                    side: (pos % 2) + 1,
+                    prox: prox[k],
+                    amb: prev
+                };
+                if (row.held) reading.held = true;
+                readings.push(reading);
+            });
+            if (off !== end) {
+                throw new Error(`col1 column size mismatch at position ${pos} in chunk ${c}`);
+            }
+        });
+    }
+
+    if (off !== buf.length) {
+        throw new Error(`col1 size mismatch: ${off}/${buf.length} bytes`);
+    }
+    return readings;
+}
+
 // ============================================================================
 // Binary-packed Live Debug capture (bin9 format)
 // Single message contains readings + session metadata + summary.
 // No settle delay needed — all data arrives atomically.
 // ============================================================================
 
+// bin9: 9 bytes per reading, little-endian
+//   u32 ts | u8 pos | u16 prox | u16 amb
+function decodeBin9Readings(b64, count) {
+    const buf = Buffer.from(b64, 'base64');
+    if (buf.length !== count * 9) {
+        throw new Error(`bin9 payload size mismatch: expected ${count * 9} bytes, got ${buf.length}`);
+    }
+
+    const readings = new Array(count);
+    for (let i = 0; i < count; i++) {
+        const off = i * 9;
+        const pos = buf[off + 4];
+        readings[i] = {
+            ts: buf.readUInt32LE(off),
+            pos: pos,
+            pcb: Math.floor(pos / 2) + 1,
+            side: (pos % 2) + 1,
+            prox: buf.readUInt16LE(off + 5),
+            amb: buf.readUInt16LE(off + 7)
+        };
+    }
+    return readings;
+}
+
+// dvz1: delta + zigzag varint frames (see infrastructure/WIRE_FORMATS.md).
+// Returns the valid readings as a bin9 buffer and the held ones as readings
+// ({ts, pos, pcb, side, prox, amb, held: true}).
+function decodeDvz1Frames(b64, frameCount, readingCount) {
+    const buf = Buffer.from(b64, 'base64');
+    const out = Buffer.alloc(readingCount * 9);
+    const held = [];
+    // Up to 8 sensor boards (SENSOR_MAX_BOARDS), two positions each; mask bit
+    // 16 + n = position n held
+    const MAX_POSITIONS = 16;
+    const HELD_SHIFT = 16;
+    const prevProx = new Array(MAX_POSITIONS).fill(0);
+    const prevAmb = new Array(MAX_POSITIONS).fill(0);
+    let prevTs = 0;
+    let prevDelta = 0;
+    let off = 0;
+    let written = 0;
+
+    const readUvarint = () => {
+        let value = 0;
+        for (let i = 0; i < 5; i++) {
+            if (off >= buf.length) break;
+            const b = buf[off++];
+            value += (b & 0x7F) * Math.pow(2, 7 * i);
+            if ((b & 0x80) === 0) return value;
+        }
+        throw new Error(`dvz1 varint truncated at byte ${off}`);
+    };
+    const readVarint = () => {
+        const value = readUvarint();
+        // zigzag -> signed
+        return (value % 2) ? -(value + 1) / 2 : value / 2;
+    };
+
+    for (let f = 0; f < frameCount; f++) {
+        if (off >= buf.length) {
+            throw new Error(`dvz1 payload truncated at frame ${f}/${frameCount}`);
+        }
+        // Varint mask: a single byte (the original u8) for 3-board firmware
+        // without held positions
+        const word = readUvarint();
+        if (word >= Math.pow(2, HELD_SHIFT + MAX_POSITIONS)) {
+            throw new Error(`dvz1 mask 0x${word.toString(16)} out of range at frame ${f}`);
+        }
+        const mask = word % Math.pow(2, HELD_SHIFT);
+        const heldMask = Math.floor(word / Math.pow(2, HELD_SHIFT));
+        prevDelta = (prevDelta + readVarint()) >>> 0;
+        prevTs = (prevTs + prevDelta) >>> 0;
+
+        for (let pos = 0; pos < MAX_POSITIONS; pos++) {
+            const hasValue = (mask >> pos) & 1;
+            const isHeld = (heldMask >> pos) & 1;
+            if (hasValue) {
+                prevProx[pos] = (prevProx[pos] + readVarint()) & 0xFFFF;
+                prevAmb[pos] = (prevAmb[pos] + readVarint()) & 0xFFFF;
+            }
+            if (isHeld) {
+                held.push({
+                    ts: prevTs,
+                    pos: pos,
+                    pcb: Math.floor(pos / 2) + 1,
+                    side: (pos % 2) + 1,
+                    prox: prevProx[pos],
+                    amb: prevAmb[pos],
+                    held: true
+                });
+                continue;
+            }
+            if (!hasValue) continue;
+
+            if (written >= readingCount) {
+                throw new Error(`dvz1 payload has more than ${readingCount} readings`);
+            }
+            const o = written * 9;
+            out.writeUInt32LE(prevTs, o);
+            out[o + 4] = pos;
+            out.writeUInt16LE(prevProx[pos], o + 5);
+            out.writeUInt16LE(prevAmb[pos], o + 7);
+            written++;
+        }
+    }
+
+    if (written !== readingCount || off !== buf.length) {
+        throw new Error(`dvz1 size mismatch: ${written}/${readingCount} readings, ${off}/${buf.length} bytes`);
+    }
+    return { bin9: out, held };
+}
+
+// ibin10: 10 bytes per interrupt event, little-endian
+//   u32 ts | u8 board | u8 sensor | u8 type (0=close, 1=away, 2=unknown) | u8 flags | u16 prox
+// ibin8 (older firmware) is the same record without prox
+const IBIN_EVENT_TYPES = ['close', 'away', 'unknown'];
+
+function decodeIbinEvents(b64, count, recordSize) {
+    const buf = Buffer.from(b64, 'base64');
+    if (buf.length !== count * recordSize) {
+        throw new Error(`ibin${recordSize} payload size mismatch: expected ${count * recordSize} bytes, got ${buf.length}`);
+    }
+
+    const events = new Array(count);
+    for (let i = 0; i < count; i++) {
+        const off = i * recordSize;
+        events[i] = {
+            ts: buf.readUInt32LE(off),
+            board: buf[off + 4],
+            sensor: buf[off + 5],
+            type: IBIN_EVENT_TYPES[buf[off + 6]] || 'unknown',
+            flags: buf[off + 7]
+        };
+        if (recordSize >= 10) {
+            events[i].prox = buf.readUInt16LE(off + 8);
+        }
+    }
+    return events;
+}
+
+function unpackRawCapture(rawB64) {
+    const raw = Buffer.from(rawB64, 'base64');
+    if (raw.length < 4) {
+        throw new Error('Raw capture too short for header length');
+    }
+
+    const headerLength = raw.readUInt32LE(0);
+    if (raw.length < 4 + headerLength) {
+        throw new Error(`Raw capture truncated: header ${headerLength} bytes, payload ${raw.length} bytes`);
+    }
+
+    const data = JSON.parse(raw.subarray(4, 4 + headerLength).toString('utf8'));
+    data.readings_b64 = raw.subarray(4 + headerLength).toString('base64');
+    return data;
+}
+
 async function processBinarySession(data) {
     if (!data.session_id || !data.device_id || !data.start_timestamp) {
         throw new Error('Binary session missing required fields (session_id, device_id, start_timestamp)');
@@ -604,6 +946,10 @@ async function processBinarySession(data) {
     if (data.detection_confidence !== undefined && Number.isFinite(data.detection_confidence)) {
         sessionItem.detection_confidence = data.detection_confidence;
     }
+    if (data.start_sync_us !== undefined) {
+        sessionItem.start_sync_us = String(data.start_sync_us);
+        sessionItem.clock_sync = data.clock || 'sntp';
+    }
 
     await docClient.send(new PutCommand({
         TableName: SESSIONS_TABLE,
@@ -681,6 +1027,16 @@ async function processBinarySession(data) {
 
     console.log(`Binary session: ${totalWritten} readings written to DynamoDB`);
 
+    // Held readings (dvz1 with duplicate_mode "suppress") are not in the bin9 buffer
+    if (data.held_readings && data.held_readings.length > 0) {
+        await storeReadings({
+            session_id: data.session_id,
+            start_timestamp: data.start_timestamp,
+            timestamp_unit: data.timestamp_unit,
+            held_readings: data.held_readings
+        });
+    }
+
     // 4. Process inline summary — no settle delay needed
     const summary = data.summary;
     const transmitted = summary ? (summary.total_readings_transmitted || readingCount) : readingCount;
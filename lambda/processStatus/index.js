@@ -24,21 +24,53 @@ exports.handler = async (event) => {
         }
         
         // Update device status
+        let updateExpression = 'SET #status = :status, last_seen = :lastSeen, current_mode = :mode, wifi_rssi = :rssi, free_heap = :heap, uptime_ms = :uptime';
+        const values = {
+            ':status': 'online',
+            ':lastSeen': new Date().toISOString(),
+            ':mode': status.mode || 'unknown',
+            ':rssi': status.wifi_rssi || 0,
+            ':heap': status.free_heap || 0,
+            ':uptime': status.uptime_ms || 0
+        };
+
+        // ML model / tensor arena info (sent while ML detection is active)
+        if (status.ml_arena_used_bytes !== undefined) {
+            updateExpression += ', ml_model = :ml';
+            values[':ml'] = {
+                version: status.ml_model_version || 'unknown',
+                source: status.ml_model_source || 'builtin',
+                model_bytes: status.ml_model_bytes || 0,
+                int8: !!status.ml_model_int8,
+                arena_used_bytes: status.ml_arena_used_bytes,
+                arena_size: status.ml_arena_size || 0,
+                arena_region: status.ml_arena_region || 'psram',
+                inference_mode: status.ml_inference_mode || 'triggered',
+                stride_ms: status.ml_stride_ms || 0,
+                inference_count: status.ml_inference_count || 0,
+                inference_avg_us: status.ml_inference_avg_us || 0,
+                inference_max_us: status.ml_inference_max_us || 0,
+                windows_skipped: status.ml_windows_skipped || 0
+            };
+            if (status.ensemble_heuristic !== undefined) {
+                values[':ml'].ensemble = {
+                    heuristic: status.ensemble_heuristic,
+                    ml_confirmed: status.ensemble_ml_confirmed || 0,
+                    ml_overruled: status.ensemble_ml_overruled || 0,
+                    ml_rejected: status.ensemble_ml_rejected || 0,
+                    ml_unavailable: status.ensemble_ml_unavailable || 0
+                };
+            }
+        }
+
         await docClient.send(new UpdateCommand({
             TableName: DEVICES_TABLE,
             Key: { device_id: status.device_id },
-            UpdateExpression: 'SET #status = :status, last_seen = :lastSeen, current_mode = :mode, wifi_rssi = :rssi, free_heap = :heap, uptime_ms = :uptime',
+            UpdateExpression: updateExpression,
             ExpressionAttributeNames: {
                 '#status': 'status'
             },
-            ExpressionAttributeValues: {
-                ':status': 'online',
-                ':lastSeen': new Date().toISOString(),
-                ':mode': status.mode || 'unknown',
-                ':rssi': status.wifi_rssi || 0,
-                ':heap': status.free_heap || 0,
-                ':uptime': status.uptime_ms || 0
-            }
+            ExpressionAttributeValues: values
         }));
         
         console.log(`Updated status for device ${status.device_id}`);
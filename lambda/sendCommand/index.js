@@ -51,6 +51,15 @@ exports.handler = async (event) => {
             payload.sensor_config = body.sensor_config;
         }
 
+        // fetch_range: re-send part of a session the device still holds on flash
+        if (command === 'fetch_range') {
+            payload.session_id = body.session_id;
+            payload.fetch_id = body.fetch_id || randomUUID();
+            for (const key of ['start_ms', 'end_ms', 'positions']) {
+                if (body[key] !== undefined) payload[key] = body[key];
+            }
+        }
+
         // capture_missed_event: no extra params needed, firmware handles it
         // (command name is sufficient — firmware extracts buffer on receipt)
         
@@ -75,7 +84,8 @@ exports.handler = async (event) => {
                 message: 'Command sent successfully',
                 device_id: deviceId,
                 command: command,
-                session_id: payload.session_id
+                session_id: payload.session_id,
+                fetch_id: payload.fetch_id
             })
         };
         
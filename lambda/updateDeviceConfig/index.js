@@ -23,7 +23,7 @@ function sanitizeConfig(config) {
     }
     
     // Validate sensor_mode
-    const validSensorModes = ["polling", "interrupt"];
+    const validSensorModes = ["polling", "interrupt", "hybrid"];
     const sensorMode = validSensorModes.includes(config.sensor_mode) ? config.sensor_mode : "polling";
     
     // Validate multi_pulse - handle both string and number types
@@ -36,8 +36,24 @@ function sanitizeConfig(config) {
     const validInterruptModes = ["normal", "logic"];
     const interruptMode = validInterruptModes.includes(config.interrupt_mode) ? config.interrupt_mode : "normal";
     
+    // Validate hybrid_idle_duty_cycle
+    const validDutyCycles = ["1/40", "1/80", "1/160", "1/320"];
+    const hybridIdleDuty = validDutyCycles.includes(config.hybrid_idle_duty_cycle) ? config.hybrid_idle_duty_cycle : "1/160";
+    
+    // Validate upload_format (session upload wire format, see infrastructure/WIRE_FORMATS.md)
+    const validUploadFormats = ["json", "binary", "delta"];
+    const uploadFormat = validUploadFormats.includes(config.upload_format) ? config.upload_format : "json";
+    
+    // Validate duplicate_mode (repeated sensor conversions: off, read at the conversion rate, or drop repeats)
+    const validDuplicateModes = ["off", "match", "suppress"];
+    const duplicateMode = validDuplicateModes.includes(config.duplicate_mode) ? config.duplicate_mode : "off";
+    
+    // Validate array_role (several units on one hoop: clock beacons and merged detections)
+    const validArrayRoles = ["off", "peer", "coordinator"];
+    const arrayRole = validArrayRoles.includes(config.array_role) ? config.array_role : "off";
+    
     // Validate detection_mode
-    const validDetectionModes = ["heuristic", "ml"];
+    const validDetectionModes = ["heuristic", "ml", "ml_sliding", "ensemble"];
     const detectionMode = validDetectionModes.includes(config.detection_mode) ? config.detection_mode : "heuristic";
     
     return {
@@ -45,6 +61,9 @@ function sanitizeConfig(config) {
         sensor_mode: sensorMode,
         // Detection algorithm mode
         detection_mode: detectionMode,
+        ml_stride_ms: Number.isFinite(config.ml_stride_ms) ? Math.min(Math.max(config.ml_stride_ms, 10), 200) : 40,
+        ensemble_confidence: Number.isFinite(config.ensemble_confidence) ? Math.min(Math.max(config.ensemble_confidence, 0), 1) : 0.7,
+        ensemble_min_gap_ms: Number.isFinite(config.ensemble_min_gap_ms) ? Math.min(Math.max(config.ensemble_min_gap_ms, 0), 200) : 10,
         // Polling mode settings
         sample_rate_hz: Number.isFinite(config.sample_rate_hz) ? config.sample_rate_hz : 1000,
         led_current: config.led_current || "200mA",
@@ -52,6 +71,9 @@ function sanitizeConfig(config) {
         duty_cycle: config.duty_cycle || "1/40",
         high_resolution: typeof config.high_resolution === 'boolean' ? config.high_resolution : true,
         read_ambient: typeof config.read_ambient === 'boolean' ? config.read_ambient : true,
+        active_force: typeof config.active_force === 'boolean' ? config.active_force : false,
+        skew_compensation: typeof config.skew_compensation === 'boolean' ? config.skew_compensation : false,
+        duplicate_mode: duplicateMode,
         i2c_clock_khz: Number.isFinite(config.i2c_clock_khz) ? config.i2c_clock_khz : 400,
         multi_pulse: multiPulse,
         // Interrupt mode settings (calibration-based)
@@ -62,11 +84,40 @@ function sanitizeConfig(config) {
         interrupt_persistence: Number.isFinite(config.interrupt_persistence) ? config.interrupt_persistence : 1,
         interrupt_smart_persistence: typeof config.interrupt_smart_persistence === 'boolean' ? config.interrupt_smart_persistence : true,
         interrupt_mode: interruptMode,
+        // Hybrid mode settings (interrupt idle, polling bursts)
+        hybrid_idle_duty_cycle: hybridIdleDuty,
+        hybrid_burst_window_ms: Number.isFinite(config.hybrid_burst_window_ms) ? Math.min(Math.max(config.hybrid_burst_window_ms, 100), 10000) : 1500,
+        hybrid_burst_max_ms: Number.isFinite(config.hybrid_burst_max_ms) ? Math.min(Math.max(config.hybrid_burst_max_ms, 500), 60000) : 10000,
+        hybrid_burst_all_boards: typeof config.hybrid_burst_all_boards === 'boolean' ? config.hybrid_burst_all_boards : true,
+        light_sleep_idle: typeof config.light_sleep_idle === 'boolean' ? config.light_sleep_idle : false,
+        light_sleep_max_ms: Number.isFinite(config.light_sleep_max_ms) ? Math.min(Math.max(config.light_sleep_max_ms, 10), 1000) : 200,
+        // Adaptive sample rate
+        adaptive_rate: typeof config.adaptive_rate === 'boolean' ? config.adaptive_rate : false,
+        adaptive_idle_rate_hz: Number.isFinite(config.adaptive_idle_rate_hz) ? Math.min(Math.max(config.adaptive_idle_rate_hz, 10), 1000) : 100,
+        adaptive_approach_fraction: Number.isFinite(config.adaptive_approach_fraction) ? Math.min(Math.max(config.adaptive_approach_fraction, 0), 1) : 0.5,
+        adaptive_hold_ms: Number.isFinite(config.adaptive_hold_ms) ? Math.min(Math.max(config.adaptive_hold_ms, 0), 10000) : 500,
+        // Background calibration from idle readings
+        auto_calibration: typeof config.auto_calibration === 'boolean' ? config.auto_calibration : true,
+        // Power profiles
+        power_profile: ['auto', 'performance', 'balanced', 'saver', 'off'].includes(config.power_profile) ? config.power_profile : 'auto',
+        power_balanced_below_v: Number.isFinite(config.power_balanced_below_v) ? Math.min(Math.max(config.power_balanced_below_v, 3.0), 4.5) : 3.7,
+        power_saver_below_v: Number.isFinite(config.power_saver_below_v) ? Math.min(Math.max(config.power_saver_below_v, 3.0), 4.5) : 3.5,
+        power_current_budget_ma: Number.isFinite(config.power_current_budget_ma) ? Math.min(Math.max(config.power_current_budget_ma, 0), 5000) : 0,
         // Detection algorithm parameters (heuristic mode)
         peak_multiplier: Number.isFinite(config.peak_multiplier) ? config.peak_multiplier : 1.5,
         min_rise: Number.isFinite(config.min_rise) ? config.min_rise : 10,
         min_wave_duration_ms: Number.isFinite(config.min_wave_duration_ms) ? config.min_wave_duration_ms : 8,
-        smoothing_window: Number.isFinite(config.smoothing_window) ? config.smoothing_window : 5
+        smoothing_window: Number.isFinite(config.smoothing_window) ? config.smoothing_window : 5,
+        multi_transit: typeof config.multi_transit === 'boolean' ? config.multi_transit : false,
+        // Upload settings
+        upload_format: uploadFormat,
+        spill_to_flash: typeof config.spill_to_flash === 'boolean' ? config.spill_to_flash : false,
+        lan_stream: typeof config.lan_stream === 'boolean' ? config.lan_stream : false,
+        lan_stream_frames: typeof config.lan_stream_frames === 'boolean' ? config.lan_stream_frames : false,
+        array_role: arrayRole,
+        // Live Debug capture window (pre + post stays within the 3 s capture ring)
+        capture_pre_trigger_ms: Number.isFinite(config.capture_pre_trigger_ms) ? Math.min(Math.max(config.capture_pre_trigger_ms, 50), 2500) : 500,
+        capture_post_trigger_ms: Number.isFinite(config.capture_post_trigger_ms) ? Math.min(Math.max(config.capture_post_trigger_ms, 0), 500) : 250
     };
 }
 
@@ -118,6 +169,9 @@ exports.handler = async (event) => {
                 sensor_mode: sensorConfig.sensor_mode,
                 // Detection algorithm
                 detection_mode: sensorConfig.detection_mode,
+                ml_stride_ms: sensorConfig.ml_stride_ms,
+                ensemble_confidence: sensorConfig.ensemble_confidence,
+                ensemble_min_gap_ms: sensorConfig.ensemble_min_gap_ms,
                 // Polling settings
                 sample_rate: sensorConfig.sample_rate_hz,
                 led_current: sensorConfig.led_current,
@@ -125,6 +179,9 @@ exports.handler = async (event) => {
                 duty_cycle: sensorConfig.duty_cycle,
                 high_resolution: sensorConfig.high_resolution,
                 read_ambient: sensorConfig.read_ambient,
+                active_force: sensorConfig.active_force,
+                skew_compensation: sensorConfig.skew_compensation,
+                duplicate_mode: sensorConfig.duplicate_mode,
                 multi_pulse: sensorConfig.multi_pulse,
                 // Interrupt settings (calibration-based)
                 interrupt_threshold_margin: sensorConfig.interrupt_threshold_margin,
@@ -134,11 +191,38 @@ exports.handler = async (event) => {
                 interrupt_persistence: sensorConfig.interrupt_persistence,
                 interrupt_smart_persistence: sensorConfig.interrupt_smart_persistence,
                 interrupt_mode: sensorConfig.interrupt_mode,
+                // Hybrid settings
+                hybrid_idle_duty_cycle: sensorConfig.hybrid_idle_duty_cycle,
+                hybrid_burst_window_ms: sensorConfig.hybrid_burst_window_ms,
+                hybrid_burst_max_ms: sensorConfig.hybrid_burst_max_ms,
+                hybrid_burst_all_boards: sensorConfig.hybrid_burst_all_boards,
+                light_sleep_idle: sensorConfig.light_sleep_idle,
+                light_sleep_max_ms: sensorConfig.light_sleep_max_ms,
+                // Adaptive rate settings
+                adaptive_rate: sensorConfig.adaptive_rate,
+                adaptive_idle_rate_hz: sensorConfig.adaptive_idle_rate_hz,
+                adaptive_approach_fraction: sensorConfig.adaptive_approach_fraction,
+                adaptive_hold_ms: sensorConfig.adaptive_hold_ms,
+                auto_calibration: sensorConfig.auto_calibration,
+                power_profile: sensorConfig.power_profile,
+                power_balanced_below_v: sensorConfig.power_balanced_below_v,
+                power_saver_below_v: sensorConfig.power_saver_below_v,
+                power_current_budget_ma: sensorConfig.power_current_budget_ma,
                 // Detection algorithm parameters
                 peak_multiplier: sensorConfig.peak_multiplier,
                 min_rise: sensorConfig.min_rise,
                 min_wave_duration_ms: sensorConfig.min_wave_duration_ms,
-                smoothing_window: sensorConfig.smoothing_window
+                smoothing_window: sensorConfig.smoothing_window,
+                multi_transit: sensorConfig.multi_transit,
+                // Upload settings
+                upload_format: sensorConfig.upload_format,
+                spill_to_flash: sensorConfig.spill_to_flash,
+                lan_stream: sensorConfig.lan_stream,
+                lan_stream_frames: sensorConfig.lan_stream_frames,
+                array_role: sensorConfig.array_role,
+                // Live Debug capture window
+                capture_pre_trigger_ms: sensorConfig.capture_pre_trigger_ms,
+                capture_post_trigger_ms: sensorConfig.capture_post_trigger_ms
             },
             timestamp: new Date().toISOString()
         };
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Compare two on-device benchmark runs (pio env "bench")
+
+Reads the "BENCH {json}" lines from two serial logs and prints every
+metric side by side with the change. Times, sizes and error counts are
+lower-is-better; rates (*_per_s) higher-is-better. A change worse than
+--threshold percent is marked and makes the exit status 1.
+
+Usage: python3 scripts/bench-compare.py old.log new.log [--threshold 10]
+"""
+
+import argparse
+import json
+import sys
+
+# Identify a result, not measure it
+KEY_FIELDS = {"bench", "case"}
+INFO_FIELDS = {"n", "frames", "iterations", "clock_hz", "simd_min", "suite"}
+
+
+def load(path):
+    results = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            pos = line.find("BENCH {")
+            if pos < 0:
+                continue
+            try:
+                record = json.loads(line[pos + len("BENCH "):])
+            except json.JSONDecodeError:
+                continue
+            results[(record.get("bench"), record.get("case"))] = record
+    return results
+
+
+def metrics(record, prefix=""):
+    """Numeric fields, nested objects flattened as parent.field"""
+    out = {}
+    for name, value in record.items():
+        if name in KEY_FIELDS or name in INFO_FIELDS:
+            continue
+        if isinstance(value, dict):
+            out.update(metrics(value, prefix + name + "."))
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            out[prefix + name] = value
+    return out
+
+
+def higher_is_better(name):
+    return name.endswith("_per_s")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("old")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent change counted as a regression (default 10)")
+    args = parser.parse_args()
+
+    old = load(args.old)
+    new = load(args.new)
+    if not old or not new:
+        print("No BENCH lines in %s" % (args.old if not old else args.new))
+        return 2
+
+    for log, results in (("old", old), ("new", new)):
+        meta = results.get(("meta", "device"), {})
+        print("%s: build %s, idf %s, suite %s" % (log, meta.get("build"), meta.get("idf"), meta.get("suite")))
+    if old.get(("meta", "device"), {}).get("suite") != new.get(("meta", "device"), {}).get("suite"):
+        print("WARNING: suite versions differ - methods changed between runs")
+    print()
+
+    regressions = 0
+    print("%-40s %-22s %12s %12s %8s" % ("bench/case", "metric", "old", "new", "change"))
+    for key in sorted(set(old) | set(new), key=lambda k: (str(k[0]), str(k[1]))):
+        if key[0] == "meta":
+            continue
+        name = "%s/%s" % key
+        if key not in old or key not in new:
+            print("%-40s %s" % (name, "only in " + ("new" if key in new else "old")))
+            continue
+        if "skipped" in old[key] or "skipped" in new[key]:
+            print("%-40s skipped (%s)" % (name, new[key].get("skipped") or old[key].get("skipped")))
+            continue
+
+        before = metrics(old[key])
+        after = metrics(new[key])
+        for metric in sorted(set(before) & set(after)):
+            a, b = before[metric], after[metric]
+            if a == 0:
+                change = "" if b == 0 else "new"
+                worse = b != 0 and not higher_is_better(metric)
+            else:
+                pct = (b - a) * 100.0 / abs(a)
+                change = "%+.1f%%" % pct
+                worse = (pct < -args.threshold) if higher_is_better(metric) else (pct > args.threshold)
+            mark = "  <-- regression" if worse else ""
+            regressions += worse
+            print("%-40s %-22s %12.6g %12.6g %8s%s" % (name, metric, a, b, change, mark))
+
+    print()
+    print("%d regression(s) beyond %.0f%%" % (regressions, args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -14,6 +14,7 @@ Usage:
     python train.py --norm-max 500           # Custom normalization constant
     python train.py --model-version "v2-test" # Custom version string
     python train.py --no-augment             # Disable channel-swap data augmentation
+    python train.py --resample linear --mask # Interpolated input with validity channels
 """
 
 import argparse
@@ -33,6 +34,17 @@ CLASS_TO_IDX = {c: i for i, c in enumerate(CLASSES)}
 # Value is based on observed practical maximum proximity at operating distance.
 DEFAULT_NORMALIZATION_MAX = 490.0
 
+NUM_POSITIONS = 6
+
+# Longest gap between two readings of a sensor that linear resampling bridges,
+# and how long a reading keeps its validity mask bit — MUST match
+# ML_RESAMPLE_MAX_GAP_MS in firmware (MLDetector.h).
+RESAMPLE_MAX_GAP_MS = 20
+
+# Model flags — MUST match ML_MODEL_FLAG_* in firmware (MLDetector.h). Stored
+# in the partition image header and as ML_MODEL_FLAGS in model_data.h.
+MODEL_FLAG_LINEAR = 1 << 0
+
 
 # ---------------------------------------------------------------------------
 # Data loading
@@ -69,17 +81,25 @@ def load_sessions(data_dir):
 # Preprocessing
 # ---------------------------------------------------------------------------
 
-def readings_to_matrix(readings, num_positions=6):
+def readings_to_matrix(readings, num_positions=NUM_POSITIONS, resample="hold", mask=False):
     """
-    Convert a list of sensor readings into a (T, 6) matrix.
+    Convert a list of sensor readings into a (T, 6) matrix, or (T, 12) with mask.
 
     Each row = 1 millisecond, each column = sensor position (0-5).
-    Values are proximity readings, forward-filled from the most recent reading.
+    Values are proximity readings resampled onto the 1 ms grid:
+        "hold"   — forward-filled from the most recent reading.
+        "linear" — interpolated between consecutive readings of the sensor
+                   when they are at most RESAMPLE_MAX_GAP_MS apart, held
+                   across longer gaps (matches MLResampling::LINEAR).
+    With mask=True, columns 6-11 are 1.0 where the sensor's most recent
+    reading is at most RESAMPLE_MAX_GAP_MS old, else 0.0.
     """
+    width = num_positions * 2 if mask else num_positions
+
     # Filter out readings with invalid timestamps
     valid = [r for r in readings if r.get("timestamp_offset", 0) >= 0]
     if not valid:
-        return np.zeros((1, num_positions), dtype=np.float32)
+        return np.zeros((1, width), dtype=np.float32)
 
     # Sort by timestamp
     valid.sort(key=lambda r: r["timestamp_offset"])
@@ -89,10 +109,11 @@ def readings_to_matrix(readings, num_positions=6):
     duration = max_ts - min_ts
 
     if duration <= 0:
-        return np.zeros((1, num_positions), dtype=np.float32)
+        return np.zeros((1, width), dtype=np.float32)
 
-    # Create matrix: (duration+1, 6), initialized to 0
-    matrix = np.zeros((duration + 1, num_positions), dtype=np.float32)
+    # Create matrix: (duration+1, width), initialized to 0
+    matrix = np.zeros((duration + 1, width), dtype=np.float32)
+    seen = [[] for _ in range(num_positions)]  # row of each reading, per column
 
     # Place readings
     for r in valid:
@@ -100,15 +121,35 @@ def readings_to_matrix(readings, num_positions=6):
         pos = r.get("position", 0)
         if 0 <= pos < num_positions and 0 <= t <= duration:
             matrix[t, pos] = float(r.get("proximity", 0))
-
-    # Forward-fill: for each column, propagate non-zero values forward
-    for col in range(num_positions):
-        last_val = 0.0
-        for row in range(matrix.shape[0]):
-            if matrix[row, col] != 0:
-                last_val = matrix[row, col]
-            else:
-                matrix[row, col] = last_val
+            if not seen[pos] or seen[pos][-1] != t:
+                seen[pos].append(t)
+
+    if resample == "linear":
+        # Interpolate between readings close enough together, hold across gaps
+        for col in range(num_positions):
+            rows = seen[col]
+            for a, b in zip(rows, rows[1:]):
+                if b - a <= RESAMPLE_MAX_GAP_MS:
+                    matrix[a:b + 1, col] = np.linspace(matrix[a, col], matrix[b, col], b - a + 1)
+                else:
+                    matrix[a + 1:b, col] = matrix[a, col]
+            if rows:
+                matrix[rows[-1] + 1:, col] = matrix[rows[-1], col]
+    else:
+        # Forward-fill: for each column, propagate non-zero values forward
+        for col in range(num_positions):
+            last_val = 0.0
+            for row in range(matrix.shape[0]):
+                if matrix[row, col] != 0:
+                    last_val = matrix[row, col]
+                else:
+                    matrix[row, col] = last_val
+
+    if mask:
+        # Valid from each reading until it is RESAMPLE_MAX_GAP_MS old
+        for col in range(num_positions):
+            for t in seen[col]:
+                matrix[t:t + RESAMPLE_MAX_GAP_MS + 1, num_positions + col] = 1.0
 
     return matrix
 
@@ -118,7 +159,7 @@ def find_event_center(matrix):
     Find the center of the event in a (T, 6) matrix.
     Uses the timestamp of peak total proximity across all sensors.
     """
-    total_signal = matrix.sum(axis=1)
+    total_signal = matrix[:, :NUM_POSITIONS].sum(axis=1)
     return int(np.argmax(total_signal))
 
 
@@ -161,8 +202,8 @@ def extract_window(matrix, window_ms, anchor=None, anchor_position=0.5):
     return window
 
 
-def preprocess_session(session, window_ms=300, alignment="trigger"):
-    """Convert a session to a (window_ms, 6) tensor.
+def preprocess_session(session, window_ms=300, alignment="trigger", resample="hold", mask=False):
+    """Convert a session to a (window_ms, 6) tensor, (window_ms, 12) with mask.
 
     Args:
         alignment: How to position the transit event in the window.
@@ -172,7 +213,7 @@ def preprocess_session(session, window_ms=300, alignment="trigger"):
                 places the peak in the latter portion of the captured window.
     """
     readings = session["readings"]
-    matrix = readings_to_matrix(readings)
+    matrix = readings_to_matrix(readings, resample=resample, mask=mask)
 
     if session["class"] == "no_transit":
         center = matrix.shape[0] // 2
@@ -197,14 +238,17 @@ def normalize(X, norm_max=DEFAULT_NORMALIZATION_MAX):
 
     Uses a fixed divisor rather than per-sample or per-dataset max to ensure
     training normalization matches on-device inference exactly.
-    Values exceeding norm_max are clipped to 1.0.
+    Values exceeding norm_max are clipped to 1.0. Mask channels (6-11) are
+    left as they are.
     """
     if norm_max <= 0:
         return X
-    X_norm = X / norm_max
-    clipped_count = int(np.sum(X_norm > 1.0))
+    prox = X[..., :NUM_POSITIONS]
+    X_norm = X.copy()
+    X_norm[..., :NUM_POSITIONS] = prox / norm_max
+    clipped_count = int(np.sum(prox > norm_max))
     if clipped_count > 0:
-        over_max = X[X > norm_max].max()
+        over_max = prox[prox > norm_max].max()
         print(f"  WARNING: {clipped_count} values exceed norm_max ({norm_max:.1f}), "
               f"max observed = {over_max:.1f}. Clipping to 1.0.")
         X_norm = np.clip(X_norm, 0.0, 1.0)
@@ -217,6 +261,7 @@ def channel_swap_augment(X, y):
     Sensor layout (6 channels):
         Positions [0, 2, 4] = Side B (S1 sensors)
         Positions [1, 3, 5] = Side A (S2 sensors)
+    Mask channels 6-11 follow the same layout and are swapped with them.
 
     Swapping Side A ↔ Side B and flipping the direction label produces a
     physically valid mirror of the transit event. This doubles directional
@@ -227,6 +272,8 @@ def channel_swap_augment(X, y):
     Returns augmented (X_aug, y_aug) concatenated with the originals.
     """
     SWAP_ORDER = [1, 0, 3, 2, 5, 4]  # swap within each module pair
+    if X.shape[2] == NUM_POSITIONS * 2:
+        SWAP_ORDER = SWAP_ORDER + [NUM_POSITIONS + c for c in SWAP_ORDER]
     DIRECTION_FLIP = {
         CLASS_TO_IDX["a_to_b"]: CLASS_TO_IDX["b_to_a"],
         CLASS_TO_IDX["b_to_a"]: CLASS_TO_IDX["a_to_b"],
@@ -248,7 +295,7 @@ def channel_swap_augment(X, y):
 
 
 def build_dataset(sessions, window_ms=300, norm_max=DEFAULT_NORMALIZATION_MAX,
-                   alignment="trigger", augment=True):
+                   alignment="trigger", augment=True, resample="hold", mask=False):
     """Build X (features) and y (labels) arrays from sessions."""
     X_list = []
     y_list = []
@@ -257,14 +304,15 @@ def build_dataset(sessions, window_ms=300, norm_max=DEFAULT_NORMALIZATION_MAX,
     for session in sessions:
         try:
             window = preprocess_session(session, window_ms=window_ms,
-                                        alignment=alignment)
+                                        alignment=alignment, resample=resample,
+                                        mask=mask)
             X_list.append(window)
             y_list.append(session["class_idx"])
             session_ids.append(session["session_id"])
         except Exception as e:
             print(f"  Warning: failed to preprocess {session['session_id']}: {e}")
 
-    X = np.stack(X_list, axis=0)  # (N, window_ms, 6)
+    X = np.stack(X_list, axis=0)  # (N, window_ms, 6 or 12)
     y = np.array(y_list, dtype=np.int32)  # (N,)
 
     print(f"Dataset (before augmentation): X={X.shape}, y={y.shape}")
@@ -278,7 +326,7 @@ def build_dataset(sessions, window_ms=300, norm_max=DEFAULT_NORMALIZATION_MAX,
         print(f"  Post-augmentation distribution: "
               + ", ".join(f"{CLASSES[i]}={np.sum(y==i)}" for i in range(len(CLASSES))))
 
-    print(f"  Raw value range: [{X.min():.1f}, {X.max():.1f}]")
+    print(f"  Raw value range: [{X[..., :NUM_POSITIONS].min():.1f}, {X[..., :NUM_POSITIONS].max():.1f}]")
     print(f"  Normalization: fixed constant = {norm_max:.1f} (must match firmware ML_NORMALIZATION_MAX)")
 
     X = normalize(X, norm_max=norm_max)
@@ -345,13 +393,15 @@ def evaluate_model(model, X_test, y_test):
 # Export
 # ---------------------------------------------------------------------------
 
-def export_tflite(model, X_train, output_path="model.tflite"):
-    """Export model as fully float32 TFLite (no quantization).
-    
+def export_tflite(model, X_train, output_path="model.tflite", int8=False):
+    """Export model as fully float32 TFLite, or fully int8 with --int8.
+
     Dynamic range quantization creates hybrid models (int8 weights, float32
-    activations) which TFLite Micro's Conv2D kernel does not support.
-    Exporting as pure float32 avoids this issue — the model is small enough
-    (~100KB) that quantization is unnecessary.
+    activations) which TFLite Micro's Conv2D kernel does not support, so it
+    is never used here. Full integer quantization (int8 weights, activations,
+    input and output) is calibrated on a sample of the training windows; the
+    firmware reads the input/output scale and zero point from the model and
+    picks the float or int8 path at init.
     """
     import tensorflow as tf
 
@@ -361,14 +411,34 @@ def export_tflite(model, X_train, output_path="model.tflite"):
     model.export(saved_model_dir)
 
     converter = tf.lite.TFLiteConverter.from_saved_model(saved_model_dir)
-    # No quantization — fully float32 for TFLite Micro compatibility
+    if int8:
+        calibration = X_train[np.random.default_rng(0).permutation(len(X_train))[:200]]
+
+        def representative_dataset():
+            for sample in calibration:
+                yield [sample[np.newaxis, ...].astype(np.float32)]
+
+        converter.optimizations = [tf.lite.Optimize.DEFAULT]
+        converter.representative_dataset = representative_dataset
+        converter.target_spec.supported_ops = [tf.lite.OpsSet.TFLITE_BUILTINS_INT8]
+        converter.inference_input_type = tf.int8
+        converter.inference_output_type = tf.int8
+    # Otherwise no quantization — fully float32 for TFLite Micro compatibility
 
     tflite_model = converter.convert()
 
     with open(output_path, "wb") as f:
         f.write(tflite_model)
 
-    print(f"\nTFLite model saved (float32, no quantization): {output_path} ({len(tflite_model)} bytes)")
+    kind = "int8, full integer" if int8 else "float32, no quantization"
+    print(f"\nTFLite model saved ({kind}): {output_path} ({len(tflite_model)} bytes)")
+
+    if int8:
+        interpreter = tf.lite.Interpreter(model_content=tflite_model)
+        inp = interpreter.get_input_details()[0]["quantization"]
+        out = interpreter.get_output_details()[0]["quantization"]
+        print(f"  Input  scale={inp[0]:.6f} zero_point={inp[1]}")
+        print(f"  Output scale={out[0]:.6f} zero_point={out[1]}")
 
     # Clean up
     import shutil
@@ -382,10 +452,18 @@ def generate_model_version(args, num_sessions):
     from datetime import datetime
     date_str = datetime.now().strftime("%Y%m%d")
     aug_tag = "aug" if not args.no_augment else "noaug"
-    return f"v{date_str}-{num_sessions}sess-{args.alignment}-norm{int(args.norm_max)}-{aug_tag}"
+    quant_tag = "-int8" if args.int8 else ""
+    input_tag = ("-lin" if args.resample == "linear" else "") + ("-mask" if args.mask else "")
+    return (f"v{date_str}-{num_sessions}sess-{args.alignment}-norm{int(args.norm_max)}-{aug_tag}"
+            f"{input_tag}{quant_tag}")
+
 
+def model_flags(args):
+    """MLModelImageHeader flags for the training options (see MLDetector.h)."""
+    return MODEL_FLAG_LINEAR if args.resample == "linear" else 0
 
-def export_c_header(tflite_path, header_path="model_data.h", model_version=None):
+
+def export_c_header(tflite_path, header_path="model_data.h", model_version=None, flags=0):
     """Convert TFLite model to a C header file with version metadata."""
     with open(tflite_path, "rb") as f:
         model_bytes = f.read()
@@ -403,6 +481,7 @@ def export_c_header(tflite_path, header_path="model_data.h", model_version=None)
         f"// Model version: {version_str}",
         "",
         f'#define ML_MODEL_VERSION "{version_str}"',
+        f"#define ML_MODEL_FLAGS 0x{flags:x}",
         "",
         f"const unsigned int {var_name}_len = {len(model_bytes)};",
         f"alignas(8) const unsigned char {var_name}[] = {{",
@@ -427,6 +506,28 @@ def export_c_header(tflite_path, header_path="model_data.h", model_version=None)
     print(f"  Model version: {version_str}")
 
 
+def export_partition_image(tflite_path, image_path="direction_model.bin", model_version=None, flags=0):
+    """Wrap a TFLite model in the MLModelImageHeader layout for the "model" partition.
+
+    Layout (little-endian, see MLDetector.h): "MPML", u32 length, u32 crc32,
+    u32 flags (ML_MODEL_FLAG_*), char version[48], then the flatbuffer.
+    """
+    import struct
+    import zlib
+
+    with open(tflite_path, "rb") as f:
+        model_bytes = f.read()
+
+    version = (model_version or "unknown").encode("ascii")[:47]
+    header = struct.pack("<4sIII48s", b"MPML", len(model_bytes),
+                         zlib.crc32(model_bytes) & 0xFFFFFFFF, flags, version)
+
+    with open(image_path, "wb") as f:
+        f.write(header + model_bytes)
+
+    print(f"Partition image saved: {image_path} ({len(header) + len(model_bytes)} bytes)")
+
+
 # ---------------------------------------------------------------------------
 # Main
 # ---------------------------------------------------------------------------
@@ -448,6 +549,13 @@ def main():
                         help="Model version string (auto-generated if not provided)")
     parser.add_argument("--no-augment", action="store_true",
                         help="Disable channel-swap data augmentation")
+    parser.add_argument("--int8", action="store_true",
+                        help="Export a fully int8-quantized model (int8 input/output)")
+    parser.add_argument("--resample", choices=["hold", "linear"], default="hold",
+                        help="Input resampling: 'hold' forward-fills (default), 'linear' interpolates "
+                             f"across gaps up to {RESAMPLE_MAX_GAP_MS} ms (sets the model's linear flag)")
+    parser.add_argument("--mask", action="store_true",
+                        help="Add 6 validity mask channels (12-channel input)")
     args = parser.parse_args()
 
     os.makedirs(args.output_dir, exist_ok=True)
@@ -462,6 +570,7 @@ def main():
     # Build dataset
     print("\n=== Preprocessing ===")
     print(f"  Window alignment: {args.alignment}")
+    print(f"  Resampling: {args.resample}" + (", validity mask channels" if args.mask else ""))
     augment = not args.no_augment
     if augment:
         print(f"  Channel-swap augmentation: ENABLED")
@@ -470,7 +579,9 @@ def main():
     X, y, session_ids = build_dataset(sessions, window_ms=args.window_ms,
                                       norm_max=args.norm_max,
                                       alignment=args.alignment,
-                                      augment=augment)
+                                      augment=augment,
+                                      resample=args.resample,
+                                      mask=args.mask)
 
     # Train/test split (stratified)
     from sklearn.model_selection import train_test_split
@@ -484,7 +595,7 @@ def main():
     import tensorflow as tf
     tf.get_logger().setLevel("ERROR")
 
-    input_shape = (args.window_ms, 6)
+    input_shape = (args.window_ms, NUM_POSITIONS * 2 if args.mask else NUM_POSITIONS)
     model = build_model(input_shape, num_classes=len(CLASSES))
     model.summary()
 
@@ -514,9 +625,12 @@ def main():
         model_version = args.model_version or generate_model_version(args, len(sessions))
         print(f"Model version: {model_version}")
 
-        export_tflite(model, X_train, output_path=tflite_path)
+        export_tflite(model, X_train, output_path=tflite_path, int8=args.int8)
         export_c_header(tflite_path, header_path=header_path,
-                        model_version=model_version)
+                        model_version=model_version, flags=model_flags(args))
+        export_partition_image(tflite_path,
+                               image_path=os.path.join(args.output_dir, "direction_model.bin"),
+                               model_version=model_version, flags=model_flags(args))
 
     print("\nDone!")
 